@@ -22,6 +22,13 @@
 
 #include "curlClient.h"
 #include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #include "experimental/logger.h"
 
 using namespace std;
@@ -31,6 +38,103 @@ using namespace OC::Bridging;
 
 #define DEFAULT_CURL_TIMEOUT_SECONDS     60L
 
+// Easy handles kept for synchronous requests; each keeps its connections alive
+#define CURL_EASY_HANDLE_POOL_SIZE       8
+
+// Longest wait of the event loop for activity, in milliseconds
+#define CURL_EVENT_LOOP_WAIT_MS          1000
+
+struct CurlClient::Transfer
+{
+    Transfer() : headers(NULL)
+    {
+    }
+
+    ~Transfer()
+    {
+        if (NULL != headers)
+        {
+            curl_slist_free_all(headers);
+        }
+    }
+
+    struct curl_slist *headers;
+    MemoryChunk body;
+    MemoryChunk header;
+};
+
+static std::mutex g_shareMutex[CURL_LOCK_DATA_LAST];
+static CURLSH *g_share = NULL;
+static std::once_flag g_shareOnce;
+
+static std::mutex g_easyHandlePoolMutex;
+static std::vector<CURL *> g_easyHandlePool;
+
+static void lockShare(CURL *, curl_lock_data data, curl_lock_access, void *)
+{
+    g_shareMutex[data].lock();
+}
+
+static void unlockShare(CURL *, curl_lock_data data, void *)
+{
+    g_shareMutex[data].unlock();
+}
+
+/**
+ * The DNS cache, TLS sessions and, where supported, the connections are shared by all
+ * the requests of the process.
+ */
+static CURLSH *getShare()
+{
+    std::call_once(g_shareOnce, []()
+    {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        g_share = curl_share_init();
+        if (NULL == g_share)
+        {
+            OIC_LOG(ERROR, TAG, "curl_share_init failed");
+            return;
+        }
+        curl_share_setopt(g_share, CURLSHOPT_LOCKFUNC, lockShare);
+        curl_share_setopt(g_share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+        curl_share_setopt(g_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(g_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+        curl_share_setopt(g_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    });
+    return g_share;
+}
+
+static CURL *acquireEasyHandle()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_easyHandlePoolMutex);
+        if (!g_easyHandlePool.empty())
+        {
+            CURL *curl = g_easyHandlePool.back();
+            g_easyHandlePool.pop_back();
+            return curl;
+        }
+    }
+    return curl_easy_init();
+}
+
+static void releaseEasyHandle(CURL *curl)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_easyHandlePoolMutex);
+        if (g_easyHandlePool.size() < CURL_EASY_HANDLE_POOL_SIZE)
+        {
+            // curl_easy_reset() keeps the connections of the handle alive
+            curl_easy_reset(curl);
+            g_easyHandlePool.push_back(curl);
+            return;
+        }
+    }
+    curl_easy_cleanup(curl);
+}
+
 
 size_t CurlClient::WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
 {
@@ -73,109 +177,421 @@ int CurlClient::decomposeHeader(const char *header, std::vector<std::string> &he
     return MPM_RESULT_OK;
 }
 
-int CurlClient::doInternalRequest(const std::string &url,
-                                  const std::string &method,
-                                  const std::vector<std::string> &inHeaders,
-                                  const std::string &request,
-                                  const std::string &username,
-                                  std::vector<std::string> &outHeaders,
-                                  std::string &response)
+int CurlClient::setupTransfer(CURL *curl, Transfer &transfer)
 {
-    int result = MPM_RESULT_OK;
-    CURL *curl = NULL;
-    CURLcode res = CURLE_OK;
-    struct curl_slist *headers = NULL;
-    MemoryChunk rsp_body;
-    MemoryChunk rsp_header;
     m_lastResponseCode = INVALID_RESPONSE_CODE; //initialize recorded code value in case of
     //early return
+    m_outHeaders.clear();
+    m_response.clear();
 
-    curl = curl_easy_init();
-    if (curl != NULL)
+    for (unsigned int i = 0; i < m_requestHeaders.size(); i++)
     {
-        curl_easy_reset(curl);
-
-        for (unsigned int i = 0; i < inHeaders.size(); i++)
+        struct curl_slist *headers = curl_slist_append(transfer.headers, m_requestHeaders[i].c_str());
+        if (NULL == headers)
         {
-            headers = curl_slist_append(headers, inHeaders[i].c_str());
-            if (NULL == headers)
-            {
-                OIC_LOG(ERROR, TAG, "curl_slist_append failed");
-                result = MPM_RESULT_OUT_OF_MEMORY;
-                goto CLEANUP;
-            }
+            OIC_LOG(ERROR, TAG, "curl_slist_append failed");
+            return MPM_RESULT_OUT_OF_MEMORY;
         }
+        transfer.headers = headers;
+    }
 
-        // Expect the transfer to complete within DEFAULT_CURL_TIMEOUT seconds
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT_SECONDS);
-
-        // Set CURLOPT_VERBOSE to 1L below to see detailed debugging
-        // information on curl operations.
-        curl_easy_setopt(curl, CURLOPT_VERBOSE, 0);
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, false);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &rsp_body);
-        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &rsp_header);
-        if (CURLUSESSL_NONE != m_useSsl)
-        {
-            curl_easy_setopt(curl, CURLOPT_USE_SSL, m_useSsl);
-        }
+    CURLSH *share = getShare();
+    if (NULL != share)
+    {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    }
 
-        if (!username.empty())
-        {
-            curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
-        }
+    // Expect the transfer to complete within DEFAULT_CURL_TIMEOUT seconds
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT_SECONDS);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
 
-        if (!method.empty())
-        {
-            // NOTE: The documentation for CURLOPT_CUSTOMREQUEST only lists HTTP, FTP, IMAP, POP3, and SMTP
-            //       as valid options, although it says all this option does is change the string used in
-            //       the request. (Basically, don't know whether this option has any effect as currently
-            //       used?
+    // Set CURLOPT_VERBOSE to 1L below to see detailed debugging
+    // information on curl operations.
+    curl_easy_setopt(curl, CURLOPT_VERBOSE, 0);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer.headers);
+    curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, false);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, m_requestBody.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer.header);
+    if (CURLUSESSL_NONE != m_useSsl)
+    {
+        curl_easy_setopt(curl, CURLOPT_USE_SSL, m_useSsl);
+    }
 
-            /// only required for GET, PUT, DELETE
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
-        }
+    if (!m_username.empty())
+    {
+        curl_easy_setopt(curl, CURLOPT_USERNAME, m_username.c_str());
+    }
 
-        res = curl_easy_perform(curl);
-        if (res != CURLE_OK)
-        {
-            OIC_LOG_V(ERROR, TAG, "curl_easy_perform failed with %lu", (unsigned long) res);
-            result = MPM_RESULT_NETWORK_ERROR;
-            goto CLEANUP;
-        }
+    if (!m_method.empty())
+    {
+        // NOTE: The documentation for CURLOPT_CUSTOMREQUEST only lists HTTP, FTP, IMAP, POP3, and SMTP
+        //       as valid options, although it says all this option does is change the string used in
+        //       the request. (Basically, don't know whether this option has any effect as currently
+        //       used?
 
-        if (CURLE_OK != curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &m_lastResponseCode))
-        {
-            OIC_LOG(WARNING, TAG, "curl_easy_getinfo(CURLINFO_RESPONSE_CODE) failed.");
-            m_lastResponseCode = INVALID_RESPONSE_CODE;
-        }
+        /// only required for GET, PUT, DELETE
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, m_method.c_str());
+    }
 
-        response = rsp_body.memory;
+    return MPM_RESULT_OK;
+}
 
-        decomposeHeader(rsp_header.memory, outHeaders);
+int CurlClient::completeTransfer(CURL *curl, CURLcode res, Transfer &transfer)
+{
+    if (res != CURLE_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "curl request failed with %lu", (unsigned long) res);
+        return MPM_RESULT_NETWORK_ERROR;
     }
-    else
+
+    if (CURLE_OK != curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &m_lastResponseCode))
     {
-        OIC_LOG(ERROR, TAG, "curl_easy_init failed");
-        result = MPM_RESULT_INTERNAL_ERROR;
+        OIC_LOG(WARNING, TAG, "curl_easy_getinfo(CURLINFO_RESPONSE_CODE) failed.");
+        m_lastResponseCode = INVALID_RESPONSE_CODE;
     }
 
-CLEANUP:
-    if (NULL != headers)
+    m_response = transfer.body.memory;
+
+    decomposeHeader(transfer.header.memory, m_outHeaders);
+
+    return MPM_RESULT_OK;
+}
+
+int CurlClient::doInternalRequest()
+{
+    Transfer transfer;
+    CURL *curl = acquireEasyHandle();
+    if (NULL == curl)
     {
-        curl_slist_free_all(headers);
+        OIC_LOG(ERROR, TAG, "curl_easy_init failed");
+        m_lastResponseCode = INVALID_RESPONSE_CODE;
+        return MPM_RESULT_INTERNAL_ERROR;
     }
 
-    if (NULL != curl)
+    int result = setupTransfer(curl, transfer);
+    if (MPM_RESULT_OK == result)
     {
-        curl_easy_cleanup(curl);
+        result = completeTransfer(curl, curl_easy_perform(curl), transfer);
     }
 
+    releaseEasyHandle(curl);
     return result;
 }
+
+namespace OC
+{
+    namespace Bridging
+    {
+        /**
+         * The event loop sending the asynchronous requests. A single thread drives all the
+         * requests through a curl multi handle, so that the requests to a bridge or a
+         * cloud service share a bounded number of kept-alive connections.
+         */
+        class CurlEventLoop
+        {
+            public:
+                static CurlEventLoop &getInstance()
+                {
+                    static CurlEventLoop instance;
+                    return instance;
+                }
+
+                int add(CurlClient &client, CurlCompletionCallback &callback)
+                {
+                    std::unique_ptr<Request> request(new Request(client, callback));
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        while (!m_running)
+                        {
+                            if (!m_thread.joinable())
+                            {
+                                if (MPM_RESULT_OK != start())
+                                {
+                                    return MPM_RESULT_INTERNAL_ERROR;
+                                }
+                            }
+                            else if (m_thread.get_id() != std::this_thread::get_id())
+                            {
+                                // A loop stopped from its own callback must leave m_multi first
+                                std::thread thread;
+                                thread.swap(m_thread);
+                                lock.unlock();
+                                thread.join();
+                                lock.lock();
+                            }
+                            else if (!m_exiting)
+                            {
+                                // Stopped and restarted from the same callback, the loop goes on
+                                m_running = true;
+                            }
+                            else
+                            {
+                                OIC_LOG(ERROR, TAG, "The event loop is cancelling its requests");
+                                return MPM_RESULT_INTERNAL_ERROR;
+                            }
+                        }
+                        m_queued.push_back(request.release());
+                    }
+                    wakeUp();
+                    return MPM_RESULT_OK;
+                }
+
+                void stop()
+                {
+                    std::thread thread;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_running = false;
+                        if (m_thread.get_id() == std::this_thread::get_id())
+                        {
+                            // Stopped from a completion callback, the loop leaves by itself
+                            // and is joined by the next add() or stop() from another thread
+                            return;
+                        }
+                        thread.swap(m_thread);
+                    }
+                    if (!thread.joinable())
+                    {
+                        return;
+                    }
+                    wakeUp();
+                    thread.join();
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_running && !m_thread.joinable())
+                    {
+                        curl_multi_cleanup(m_multi);
+                        m_multi = NULL;
+                        close(m_wakeupFds[0]);
+                        close(m_wakeupFds[1]);
+                        m_wakeupFds[0] = m_wakeupFds[1] = -1;
+                    }
+                }
+
+            private:
+                struct Request
+                {
+                    Request(CurlClient &client, CurlCompletionCallback &callback) :
+                        client(client), callback(callback), curl(NULL)
+                    {
+                    }
+
+                    CurlClient client;
+                    CurlCompletionCallback callback;
+                    CurlClient::Transfer transfer;
+                    CURL *curl;
+                };
+
+                CurlEventLoop() : m_multi(NULL), m_running(false), m_exiting(false)
+                {
+                    m_wakeupFds[0] = m_wakeupFds[1] = -1;
+                }
+
+                ~CurlEventLoop()
+                {
+                    stop();
+                }
+
+                // Called with m_mutex held
+                int start()
+                {
+                    if (NULL == m_multi)
+                    {
+                        if (pipe(m_wakeupFds) != 0)
+                        {
+                            OIC_LOG(ERROR, TAG, "Failed to create the wakeup pipe");
+                            return MPM_RESULT_INTERNAL_ERROR;
+                        }
+                        fcntl(m_wakeupFds[0], F_SETFL, O_NONBLOCK);
+                        fcntl(m_wakeupFds[1], F_SETFL, O_NONBLOCK);
+
+                        getShare();
+                        m_multi = curl_multi_init();
+                        if (NULL == m_multi)
+                        {
+                            OIC_LOG(ERROR, TAG, "curl_multi_init failed");
+                            return MPM_RESULT_INTERNAL_ERROR;
+                        }
+#if LIBCURL_VERSION_NUM >= 0x071e00
+                        curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                                          CURL_MAX_HOST_CONNECTIONS);
+                        curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                                          CURL_MAX_TOTAL_CONNECTIONS);
+#endif
+                    }
+
+                    m_running = true;
+                    m_exiting = false;
+                    m_thread = std::thread(&CurlEventLoop::run, this);
+                    return MPM_RESULT_OK;
+                }
+
+                void wakeUp()
+                {
+                    char c = 0;
+                    if (write(m_wakeupFds[1], &c, 1) < 0)
+                    {
+                        // The pipe is full, the loop is woken up already
+                    }
+                }
+
+                void addQueuedRequests()
+                {
+                    std::vector<Request *> queued;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        queued.swap(m_queued);
+                    }
+
+                    for (Request *request : queued)
+                    {
+                        int result = MPM_RESULT_INTERNAL_ERROR;
+                        request->curl = acquireEasyHandle();
+                        if (NULL != request->curl)
+                        {
+                            result = request->client.setupTransfer(request->curl, request->transfer);
+                        }
+                        if (MPM_RESULT_OK == result)
+                        {
+                            curl_easy_setopt(request->curl, CURLOPT_PRIVATE, request);
+                            if (CURLM_OK != curl_multi_add_handle(m_multi, request->curl))
+                            {
+                                result = MPM_RESULT_INTERNAL_ERROR;
+                            }
+                            else
+                            {
+                                m_active.insert(request);
+                            }
+                        }
+                        if (MPM_RESULT_OK != result)
+                        {
+                            complete(request, result);
+                        }
+                    }
+                }
+
+                void complete(Request *request, int result)
+                {
+                    request->callback(result, request->client);
+                    if (NULL != request->curl)
+                    {
+                        releaseEasyHandle(request->curl);
+                    }
+                    delete request;
+                }
+
+                void run()
+                {
+                    while (true)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(m_mutex);
+                            if (!m_running)
+                            {
+                                m_exiting = true;
+                                break;
+                            }
+                        }
+
+                        addQueuedRequests();
+
+                        int running = 0;
+                        curl_multi_perform(m_multi, &running);
+
+                        CURLMsg *msg = NULL;
+                        int remaining = 0;
+                        while ((msg = curl_multi_info_read(m_multi, &remaining)) != NULL)
+                        {
+                            if (CURLMSG_DONE != msg->msg)
+                            {
+                                continue;
+                            }
+                            Request *request = NULL;
+                            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&request);
+                            CURLcode res = msg->data.result;
+                            curl_multi_remove_handle(m_multi, request->curl);
+                            m_active.erase(request);
+                            complete(request, request->client.completeTransfer(request->curl, res,
+                                                                               request->transfer));
+                        }
+
+                        struct curl_waitfd wakeup;
+                        wakeup.fd = m_wakeupFds[0];
+                        wakeup.events = CURL_WAIT_POLLIN;
+                        wakeup.revents = 0;
+                        curl_multi_wait(m_multi, &wakeup, 1, CURL_EVENT_LOOP_WAIT_MS, NULL);
+
+                        char buffer[64];
+                        while (read(m_wakeupFds[0], buffer, sizeof(buffer)) > 0)
+                        {
+                            // Drain the wakeups
+                        }
+                    }
+
+                    cancelRequests();
+                }
+
+                void cancelRequests()
+                {
+                    std::set<Request *> active;
+                    active.swap(m_active);
+                    for (Request *request : active)
+                    {
+                        curl_multi_remove_handle(m_multi, request->curl);
+                        complete(request, MPM_RESULT_NETWORK_ERROR);
+                    }
+
+                    std::vector<Request *> queued;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        queued.swap(m_queued);
+                    }
+                    for (Request *request : queued)
+                    {
+                        complete(request, MPM_RESULT_NETWORK_ERROR);
+                    }
+                }
+
+                CURLM *m_multi;
+                int m_wakeupFds[2];
+                std::mutex m_mutex;
+                std::vector<Request *> m_queued;
+                // Requests added to the multi handle, used by the loop thread only
+                std::set<Request *> m_active;
+                std::thread m_thread;
+                bool m_running;
+                // Set once the loop has left and cancels the remaining requests
+                bool m_exiting;
+        };
+    } // namespace Bridging
+}  // namespace OC
+
+int CurlClient::sendAsync(CurlCompletionCallback callback)
+{
+    if (!callback)
+    {
+        return MPM_RESULT_INVALID_PARAMETER;
+    }
+    return CurlEventLoop::getInstance().add(*this, callback);
+}
+
+void CurlClient::stopEventLoop()
+{
+    CurlEventLoop::getInstance().stop();
+
+    std::vector<CURL *> pool;
+    {
+        std::lock_guard<std::mutex> lock(g_easyHandlePoolMutex);
+        pool.swap(g_easyHandlePool);
+    }
+    for (CURL *curl : pool)
+    {
+        curl_easy_cleanup(curl);
+    }
+}
@@ -27,53 +27,452 @@
 
 #include <string.h>
 #include <errno.h>
+#include <atomic>
+#include <mutex>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 #include "messageHandler.h"
 #include "iotivity_config.h"
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 #include "platform_features.h"
 #include "oic_malloc.h"
 #include "experimental/logger.h"
 
 #define TAG "PIPE_HANDLER"
 
-MPMResult MPMWritePipeMessage(int fd, const MPMPipeMessage *pipe_message)
+/* Size of the data of a shared memory ring */
+#define MPM_RING_SIZE               (1024 * 1024)
+
+/* Messages are framed at this alignment in a ring */
+#define MPM_RING_ALIGNMENT          8
+
+/* Type of the frame filling the end of the ring when a message wraps around */
+#define MPM_RING_PADDING            0xFFFFFFFFU
+
+/* Ends of the rings opened by a process */
+#define MPM_MAX_RING_ENDS           64
+
+/* Longest wait for room in a full ring, in milliseconds */
+#define MPM_RING_FULL_TIMEOUT_MS    5000
+
+/**
+ * A single producer, single consumer ring of framed messages in memory shared by the
+ * mpm library and a plugin process. The counters are in bytes and only increase; the
+ * producer owns head and the consumer owns tail.
+ */
+typedef struct
 {
-    ssize_t ret = 0;
-    OIC_LOG(DEBUG, TAG, "writing message over pipe");
+    std::atomic<uint64_t> head;
+    uint8_t headPadding[64 - sizeof(uint64_t)];
+    std::atomic<uint64_t> tail;
+    /* Set by a producer waiting for room, so that the consumer signals roomFd */
+    std::atomic<uint32_t> producerWaiting;
+    uint8_t tailPadding[64 - sizeof(uint64_t) - sizeof(uint32_t)];
+    uint8_t data[MPM_RING_SIZE];
+    /* Metadata parsers read up to MPM_MAX_METADATA_LEN bytes from a payload */
+    uint8_t guard[MPM_MAX_METADATA_LEN];
+} MPMRing;
 
-    OIC_LOG_V(DEBUG, TAG, "Message type = %d, payload size = %" PRIuPTR, pipe_message->msgType,
-              pipe_message->payloadSize);
+typedef struct
+{
+    uint32_t msgType;
+    uint32_t payloadSize;
+} MPMRingFrame;
 
-    ret = write(fd, &pipe_message->payloadSize, sizeof(size_t));
-    if (ret < 0)
+/**
+ * State of a ring in this process, shared by the ends of the ring opened here.
+ */
+typedef struct
+{
+    MPMRing *ring;
+    /* Eventfd signalled by the consumer when it makes room for a waiting producer */
+    int roomFd;
+    int ends;
+    /* Serializes the writers of this process */
+    std::mutex writeMutex;
+    /* Tail after the message read in place, until it is released */
+    uint64_t readTail;
+} MPMRingChannel;
+
+typedef struct
+{
+    int fd;
+    MPMRingChannel *channel;
+} MPMRingEnd;
+
+static std::mutex g_ringMutex;
+static MPMRingEnd g_ringEnds[MPM_MAX_RING_ENDS];
+static size_t g_ringEndCount = 0;
+
+static MPMRingChannel *getRingChannel(int fd)
+{
+    std::lock_guard<std::mutex> lock(g_ringMutex);
+    for (size_t i = 0; i < g_ringEndCount; i++)
     {
-        OIC_LOG_V(ERROR, TAG, "Error writing message over the pipe - [%s]", strerror(errno));
+        if (g_ringEnds[i].fd == fd)
+        {
+            return g_ringEnds[i].channel;
+        }
+    }
+    return NULL;
+}
+
+static size_t alignFrame(size_t size)
+{
+    return (size + MPM_RING_ALIGNMENT - 1) & ~((size_t)MPM_RING_ALIGNMENT - 1);
+}
+
+static MPMResult createRing(int fds[2])
+{
+#ifdef __linux__
+    {
+        std::lock_guard<std::mutex> lock(g_ringMutex);
+        if (g_ringEndCount + 2 > MPM_MAX_RING_ENDS)
+        {
+            return MPM_RESULT_INSUFFICIENT_BUFFER;
+        }
+    }
+
+    /* The anonymous shared mapping is inherited by the forked plugin process */
+    void *memory = mmap(NULL, sizeof(MPMRing), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == memory)
+    {
+        OIC_LOG_V(ERROR, TAG, "Error mapping the ring - [%s]", strerror(errno));
         return MPM_RESULT_INTERNAL_ERROR;
     }
 
-    ret = write(fd, &pipe_message->msgType, sizeof(MPMMessageType));
-    if (ret < 0)
+    /* A semaphore eventfd counts the messages in the ring, so that the read end
+     * can be waited on with select() like a pipe. Each end is its own descriptor
+     * so that the ends are closed independently.
+     */
+    fds[0] = eventfd(0, EFD_SEMAPHORE);
+    fds[1] = (fds[0] < 0) ? -1 : dup(fds[0]);
+    int roomFd = (fds[1] < 0) ? -1 : eventfd(0, EFD_NONBLOCK);
+    if (roomFd < 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Error creating the ring eventfd - [%s]", strerror(errno));
+        if (fds[1] >= 0)
+        {
+            close(fds[1]);
+        }
+        if (fds[0] >= 0)
+        {
+            close(fds[0]);
+        }
+        munmap(memory, sizeof(MPMRing));
+        return MPM_RESULT_INTERNAL_ERROR;
+    }
+
+    MPMRing *ring = new (memory) MPMRing;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->producerWaiting = 0;
+
+    MPMRingChannel *channel = new MPMRingChannel;
+    channel->ring = ring;
+    channel->roomFd = roomFd;
+    channel->ends = 2;
+    channel->readTail = 0;
+
+    std::lock_guard<std::mutex> lock(g_ringMutex);
+    g_ringEnds[g_ringEndCount].fd = fds[0];
+    g_ringEnds[g_ringEndCount++].channel = channel;
+    g_ringEnds[g_ringEndCount].fd = fds[1];
+    g_ringEnds[g_ringEndCount++].channel = channel;
+    return MPM_RESULT_OK;
+#else
+    (void) fds;
+    return MPM_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+MPMResult MPMCreatePipe(int fds[2], bool sharedMemory)
+{
+    if (sharedMemory && MPM_RESULT_OK == createRing(fds))
+    {
+        return MPM_RESULT_OK;
+    }
+
+    if (pipe(fds) != 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Error creating the pipe - [%s]", strerror(errno));
+        return MPM_RESULT_INTERNAL_ERROR;
+    }
+    return MPM_RESULT_OK;
+}
+
+void MPMClosePipe(int fd)
+{
+    MPMRingChannel *unused = NULL;
+    {
+        std::lock_guard<std::mutex> lock(g_ringMutex);
+        for (size_t i = 0; i < g_ringEndCount; i++)
+        {
+            if (g_ringEnds[i].fd == fd)
+            {
+                MPMRingChannel *channel = g_ringEnds[i].channel;
+                g_ringEnds[i] = g_ringEnds[--g_ringEndCount];
+                if (--channel->ends == 0)
+                {
+                    unused = channel;
+                }
+                break;
+            }
+        }
+    }
+
+    if (unused)
+    {
+        munmap(unused->ring, sizeof(MPMRing));
+        close(unused->roomFd);
+        delete unused;
+    }
+    close(fd);
+}
+
+static uint64_t getMonotonicMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* Blocks until the consumer has freed needed bytes after head, or the wait times out */
+static bool waitForRingRoom(MPMRingChannel *channel, uint64_t head, size_t needed)
+{
+    MPMRing *ring = channel->ring;
+    uint64_t deadline = getMonotonicMs() + MPM_RING_FULL_TIMEOUT_MS;
+    bool hasRoom = false;
+    while (!hasRoom)
+    {
+        /* The flag is raised before checking the tail again, so that the consumer
+         * either sees it after releasing a message or the release is seen here.
+         */
+        ring->producerWaiting.store(1);
+        if (MPM_RING_SIZE - (head - ring->tail.load()) >= needed)
+        {
+            hasRoom = true;
+            continue;
+        }
+
+        uint64_t now = getMonotonicMs();
+        if (now >= deadline)
+        {
+            break;
+        }
+        struct pollfd pfd = { channel->roomFd, POLLIN, 0 };
+        if (poll(&pfd, 1, (int)(deadline - now)) < 0 && errno != EINTR)
+        {
+            OIC_LOG_V(ERROR, TAG, "Error waiting for room in the ring - [%s]", strerror(errno));
+            break;
+        }
+
+        uint64_t count = 0;
+        if (read(channel->roomFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        {
+            OIC_LOG_V(ERROR, TAG, "Error reading the ring eventfd - [%s]", strerror(errno));
+            break;
+        }
+    }
+    ring->producerWaiting.store(0);
+    return hasRoom;
+}
+
+/* Frees the message read in place for the producer, waking it up if it waits for room */
+static void releaseRingMessage(MPMRingChannel *channel)
+{
+    MPMRing *ring = channel->ring;
+    ring->tail.store(channel->readTail);
+    if (ring->producerWaiting.load())
+    {
+        uint64_t one = 1;
+        if (write(channel->roomFd, &one, sizeof(one)) < 0)
+        {
+            OIC_LOG_V(ERROR, TAG, "Error signalling the ring - [%s]", strerror(errno));
+        }
+    }
+}
+
+static MPMResult writeRingMessage(int fd, MPMRingChannel *channel,
+                                  const MPMPipeMessage *pipe_message)
+{
+    /* Each payload is followed by a NUL, for the readers of string payloads */
+    size_t frameSize = alignFrame(sizeof(MPMRingFrame) + pipe_message->payloadSize + 1);
+    if (frameSize > MPM_RING_SIZE / 2)
     {
-        OIC_LOG_V(ERROR, TAG, "Error writing message over the pipe - [%s]", strerror(errno));
+        OIC_LOG_V(ERROR, TAG, "Message of %" PRIuPTR " bytes is too large for the ring",
+                  pipe_message->payloadSize);
+        return MPM_RESULT_INSUFFICIENT_BUFFER;
+    }
+
+    std::lock_guard<std::mutex> lock(channel->writeMutex);
+    MPMRing *ring = channel->ring;
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    size_t offset = head % MPM_RING_SIZE;
+    size_t contiguous = MPM_RING_SIZE - offset;
+    size_t needed = (contiguous < frameSize) ? contiguous + frameSize : frameSize;
+
+    if (MPM_RING_SIZE - (head - ring->tail.load(std::memory_order_acquire)) < needed
+        && !waitForRingRoom(channel, head, needed))
+    {
+        OIC_LOG(ERROR, TAG, "Timed out waiting for room in the ring");
         return MPM_RESULT_INTERNAL_ERROR;
     }
 
+    if (contiguous < frameSize)
+    {
+        MPMRingFrame *padding = (MPMRingFrame *)(ring->data + offset);
+        padding->msgType = MPM_RING_PADDING;
+        padding->payloadSize = 0;
+        head += contiguous;
+        offset = 0;
+    }
+
+    MPMRingFrame *frame = (MPMRingFrame *)(ring->data + offset);
+    frame->msgType = (uint32_t)pipe_message->msgType;
+    frame->payloadSize = (uint32_t)pipe_message->payloadSize;
+    uint8_t *payload = ring->data + offset + sizeof(MPMRingFrame);
     if (pipe_message->payloadSize > 0)
     {
-        ret = write(fd, pipe_message->payload, pipe_message->payloadSize);
+        memcpy(payload, pipe_message->payload, pipe_message->payloadSize);
+    }
+    payload[pipe_message->payloadSize] = '\0';
+    ring->head.store(head + frameSize, std::memory_order_release);
+
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) < 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Error signalling the ring - [%s]", strerror(errno));
+        return MPM_RESULT_INTERNAL_ERROR;
+    }
+    return MPM_RESULT_OK;
+}
+
+static ssize_t readRingMessage(int fd, MPMRingChannel *channel, MPMPipeMessage *pipe_message)
+{
+    uint64_t count = 0;
+    ssize_t ret = read(fd, &count, sizeof(count));
+    if (ret < 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Error Reading message from the ring - [%s]", strerror(errno));
+        return ret;
+    }
+
+    MPMRing *ring = channel->ring;
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    size_t offset = tail % MPM_RING_SIZE;
+    MPMRingFrame *frame = (MPMRingFrame *)(ring->data + offset);
+    if (head != tail && MPM_RING_PADDING == frame->msgType)
+    {
+        tail += MPM_RING_SIZE - offset;
+        offset = 0;
+        frame = (MPMRingFrame *)ring->data;
+    }
+    if (head == tail)
+    {
+        OIC_LOG(ERROR, TAG, "Ring signalled without a message");
+        return -1;
+    }
+
+    pipe_message->msgType = (MPMMessageType)frame->msgType;
+    pipe_message->payloadSize = frame->payloadSize;
+    pipe_message->payload = (frame->payloadSize > 0) ?
+                            ring->data + offset + sizeof(MPMRingFrame) : NULL;
+    channel->readTail = tail + alignFrame(sizeof(MPMRingFrame) + frame->payloadSize + 1);
+
+    if (pipe_message->msgType == MPM_NOMSG)
+    {
+        return 0;
+    }
+    return sizeof(size_t) + sizeof(MPMMessageType) + pipe_message->payloadSize;
+}
+
+MPMResult MPMWritePipeMessage(int fd, const MPMPipeMessage *pipe_message)
+{
+    ssize_t ret = 0;
+    OIC_LOG(DEBUG, TAG, "writing message over pipe");
+
+    OIC_LOG_V(DEBUG, TAG, "Message type = %d, payload size = %" PRIuPTR, pipe_message->msgType,
+              pipe_message->payloadSize);
+
+    MPMRingChannel *channel = getRingChannel(fd);
+    if (channel)
+    {
+        return writeRingMessage(fd, channel, pipe_message);
+    }
 
+    /* The size, type and payload are written at once */
+    struct iovec iov[3];
+    iov[0].iov_base = (void *)&pipe_message->payloadSize;
+    iov[0].iov_len = sizeof(size_t);
+    iov[1].iov_base = (void *)&pipe_message->msgType;
+    iov[1].iov_len = sizeof(MPMMessageType);
+    iov[2].iov_base = (void *)pipe_message->payload;
+    iov[2].iov_len = pipe_message->payloadSize;
+    int iovcnt = (pipe_message->payloadSize > 0) ? 3 : 2;
+
+    size_t total = iov[0].iov_len + iov[1].iov_len + ((iovcnt == 3) ? iov[2].iov_len : 0);
+    size_t written = 0;
+    struct iovec *next = iov;
+    while (written < total)
+    {
+        ret = writev(fd, next, iovcnt);
         if (ret < 0)
         {
+            if (errno == EINTR)
+            {
+                continue;
+            }
             OIC_LOG_V(ERROR, TAG, "Error writing message over the pipe - [%s]", strerror(errno));
             return MPM_RESULT_INTERNAL_ERROR;
         }
+        written += ret;
+
+        /* A large payload may be written in parts */
+        while (iovcnt > 0 && (size_t)ret >= next->iov_len)
+        {
+            ret -= next->iov_len;
+            next++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            next->iov_base = (uint8_t *)next->iov_base + ret;
+            next->iov_len -= ret;
+        }
     }
 
     return MPM_RESULT_OK;
 }
 
+/* Reads exactly size bytes from the pipe, unless it is closed or fails */
+static ssize_t readFully(int fd, void *buffer, size_t size)
+{
+    size_t bytesRead = 0;
+    while (bytesRead < size)
+    {
+        ssize_t ret = read(fd, (uint8_t *)buffer + bytesRead, size - bytesRead);
+        if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret <= 0)
+        {
+            return (bytesRead > 0 && ret == 0) ? (ssize_t)bytesRead : ret;
+        }
+        bytesRead += ret;
+    }
+    return bytesRead;
+}
 
 ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
 {
@@ -82,7 +481,32 @@ ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
     OIC_LOG_V(DEBUG, TAG, "Message type = %d, payload size = %" PRIuPTR , pipe_message->msgType,
                   pipe_message->payloadSize);
 
-    ret = read(fd, &pipe_message->payloadSize, sizeof(size_t));
+    MPMRingChannel *channel = getRingChannel(fd);
+    if (channel)
+    {
+        bytesRead = readRingMessage(fd, channel, pipe_message);
+        if (bytesRead >= 0 && pipe_message->payload)
+        {
+            const uint8_t *payload = pipe_message->payload;
+            pipe_message->payload = (uint8_t *) OICMalloc(pipe_message->payloadSize);
+            if (!pipe_message->payload)
+            {
+                /* The message is dropped, it cannot stay in the ring once signalled */
+                OIC_LOG(ERROR, TAG, "failed to allocate memory");
+                pipe_message->payloadSize = 0;
+                releaseRingMessage(channel);
+                return -1;
+            }
+            memcpy((void*)pipe_message->payload, payload, pipe_message->payloadSize);
+        }
+        if (bytesRead >= 0)
+        {
+            releaseRingMessage(channel);
+        }
+        return bytesRead;
+    }
+
+    ret = readFully(fd, &pipe_message->payloadSize, sizeof(size_t));
     if (ret < 0)
     {
         OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
@@ -90,7 +514,7 @@ ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
     }
     bytesRead = ret;
 
-    ret = read(fd, &pipe_message->msgType, sizeof(MPMMessageType));
+    ret = readFully(fd, &pipe_message->msgType, sizeof(MPMMessageType));
     if (ret < 0)
     {
         OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
@@ -113,7 +537,7 @@ ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
         }
         else
         {
-            ret = read(fd, (void*)pipe_message->payload, pipe_message->payloadSize);
+            ret = readFully(fd, (void*)pipe_message->payload, pipe_message->payloadSize);
             if (ret < 0)
             {
                 OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
@@ -129,3 +553,28 @@ ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
     }
     return bytesRead;
 }
+
+ssize_t MPMReadPipeMessageInPlace(int fd, MPMPipeMessage *pipe_message)
+{
+    MPMRingChannel *channel = getRingChannel(fd);
+    if (channel)
+    {
+        return readRingMessage(fd, channel, pipe_message);
+    }
+    return MPMReadPipeMessage(fd, pipe_message);
+}
+
+void MPMReleasePipeMessage(int fd, MPMPipeMessage *pipe_message)
+{
+    MPMRingChannel *channel = getRingChannel(fd);
+    if (channel)
+    {
+        releaseRingMessage(channel);
+    }
+    else
+    {
+        OICFree((void*)pipe_message->payload);
+    }
+    pipe_message->payload = NULL;
+    pipe_message->payloadSize = 0;
+}
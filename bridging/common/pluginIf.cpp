@@ -102,23 +102,23 @@ static int start(MPMCommonPluginCtx *ctx)
         pipe_message.msgType = MPM_NOMSG;
         pipe_message.payload = NULL;
 
-        /* Create unnamed pipes for IPC prior to the fork so that both
-         * parent and child have the same information on the unnamed
-         * pipes.
+        /* Create the channels (shared memory rings, or unnamed pipes) for IPC
+         * prior to the fork so that both parent and child have the same
+         * information on the channels.
          */
-        int parent_result = pipe(&(ctx->parent_reads_fds.read_fd));
-        if (parent_result == -1)
+        MPMResult parent_result = MPMCreatePipe(&(ctx->parent_reads_fds.read_fd), true);
+        if (parent_result != MPM_RESULT_OK)
         {
             OIC_LOG(ERROR, TAG, "Failed to create IPC unnamed pipe for parent.");
             return result;
         }
-        int child_result = pipe(&(ctx->child_reads_fds.read_fd));
+        MPMResult child_result = MPMCreatePipe(&(ctx->child_reads_fds.read_fd), true);
 
-        if (child_result == -1)
+        if (child_result != MPM_RESULT_OK)
         {
             OIC_LOG(ERROR, TAG, "Failed to create IPC unnamed pipe for child.");
-            close(ctx->parent_reads_fds.read_fd);
-            close(ctx->parent_reads_fds.write_fd);
+            MPMClosePipe(ctx->parent_reads_fds.read_fd);
+            MPMClosePipe(ctx->parent_reads_fds.write_fd);
             return result;
         }
 
@@ -131,8 +131,8 @@ static int start(MPMCommonPluginCtx *ctx)
                  * write to the child's read pipe nor is the child
                  * going to read from the parent's read pipe
                  */
-                close(ctx->child_reads_fds.write_fd);
-                close(ctx->parent_reads_fds.read_fd);
+                MPMClosePipe(ctx->child_reads_fds.write_fd);
+                MPMClosePipe(ctx->parent_reads_fds.read_fd);
 
                 /* Start the OCF server. This is a blocking call and will
                    return only when the plugin stops*/
@@ -143,8 +143,8 @@ static int start(MPMCommonPluginCtx *ctx)
                 /* Close the other sides of the pipes from
                  * the child's perspective
                  */
-                close(ctx->child_reads_fds.read_fd);
-                close(ctx->parent_reads_fds.write_fd);
+                MPMClosePipe(ctx->child_reads_fds.read_fd);
+                MPMClosePipe(ctx->parent_reads_fds.write_fd);
 
                 exit(0);
                 break;
@@ -158,8 +158,8 @@ static int start(MPMCommonPluginCtx *ctx)
                  * from the child's read pipe and the parent is not
                  * going to write the parents read pipe.
                  */
-                close(ctx->child_reads_fds.read_fd);
-                close(ctx->parent_reads_fds.write_fd);
+                MPMClosePipe(ctx->child_reads_fds.read_fd);
+                MPMClosePipe(ctx->parent_reads_fds.write_fd);
 
                 /* The plugin may fail to create or start.
                  * The parent must wait here for some time to
@@ -193,8 +193,8 @@ static int start(MPMCommonPluginCtx *ctx)
                     /* Let's close the rest of the pipe interfaces. Sides of the pipes
                      * from the parent's perspective
                      */
-                    close(ctx->child_reads_fds.write_fd);
-                    close(ctx->parent_reads_fds.read_fd);
+                    MPMClosePipe(ctx->child_reads_fds.write_fd);
+                    MPMClosePipe(ctx->parent_reads_fds.read_fd);
                 }
 
                 OICFree((void*)pipe_message.payload);
@@ -318,15 +318,15 @@ static void timedWaitForPipeWrite(int fd, MPMPipeMessage *msg, int32_t timeout)
         int32_t waittime = 0;
         ssize_t nbytes = 0;
 
-        /* wait for 1 second on each time through the loop for up to timeout */
-        tv.tv_sec = 0;
-        tv.tv_usec = 0;
-
         do
         {
+            /* wait for 1 second on each time through the loop for up to timeout;
+             * select() may modify the timeout, so it is set again each time
+             */
+            tv.tv_sec = 1;
+            tv.tv_usec = 0;
             FD_ZERO(&(fdset));
             FD_SET(fd, &(fdset));
-            sleep(1);  /* tried to set the timeout on select and it was not reliable */
             nfd = select(fd + 1, &(fdset), NULL, NULL, &tv);
             if (nfd == -1)
             {
@@ -41,7 +41,11 @@
 #include "experimental/logger.h"
 #include "WorkQueue.h"
 #include "ConcurrentIotivityUtils.h"
+#include "curlClient.h"
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <octypes.h>
 
 #define TAG "PLUGIN_SERVER"
@@ -92,6 +96,9 @@ const char *g_system_time = NULL;
 
 static pthread_t processMessageFromPipeThread;
 
+/* The mpm library process which forked this plugin process */
+static pid_t g_parent_pid;
+
 /* plugin specific context storage point.  the plugin owns the allocation
  * and freeing of its own context
  */
@@ -106,6 +113,11 @@ extern MPMCommonPluginCtx *g_com_ctx;
 
 std::unique_ptr<ConcurrentIotivityUtils> iotivityUtils = NULL;
 
+/* Wakes up the plugin worker threads waiting in MPMPluginWaitForEvent() on stop */
+static std::mutex g_eventMutex;
+static std::condition_variable g_eventCondition;
+static bool g_stopping = false;
+
 /**
  * This is a non blocking pipe read function
  *
@@ -142,9 +154,16 @@ bool processMessagesFromMPM(int fd, MPMCommonPluginCtx *com_ctx, MPMPluginCtx *c
     }
     else
     {
-        if (FD_ISSET(fd, &(fdset)))
+        if (nfd == 0 && getppid() != g_parent_pid)
+        {
+            /* A shared memory channel is not closed when the parent exits */
+            OIC_LOG(DEBUG, TAG, "Parent process has exited");
+            shutdown = true;
+        }
+        else if (FD_ISSET(fd, &(fdset)))
         {
-            nbytes = MPMReadPipeMessage(fd, &pipe_message);
+            /* The payload is handled in place, without a copy out of the channel */
+            nbytes = MPMReadPipeMessageInPlace(fd, &pipe_message);
             if (nbytes == 0)
             {
                 OIC_LOG(DEBUG, TAG, "EOF was read and file descriptor was found to be closed");
@@ -162,7 +181,7 @@ bool processMessagesFromMPM(int fd, MPMCommonPluginCtx *com_ctx, MPMPluginCtx *c
                 }
             }
 
-            OICFree((void*)pipe_message.payload);
+            MPMReleasePipeMessage(fd, &pipe_message);
 
         }
     }
@@ -172,6 +191,7 @@ bool processMessagesFromMPM(int fd, MPMCommonPluginCtx *com_ctx, MPMPluginCtx *c
 MPMResult MPMPluginService(MPMCommonPluginCtx *ctx)
 {
     MPMResult result = MPM_RESULT_INTERNAL_ERROR;
+    g_parent_pid = getppid();
     if (ctx == NULL)
     {
         OIC_LOG(ERROR, TAG, "Plugin context is NULL");
@@ -389,8 +409,17 @@ MPMResult maintainInfrastructure(MPMResult result, MPMCommonPluginCtx *ctx)
 
         OIC_LOG_V(INFO, TAG, "Stopping %s plugin", g_plugin_context->device_name);
 
+        {
+            std::lock_guard<std::mutex> lock(g_eventMutex);
+            g_stopping = true;
+        }
+        g_eventCondition.notify_all();
+
         result = pluginStop(g_plugin_context);
 
+        // Completes the pending device requests before the notifications stop
+        CurlClient::stopEventLoop();
+
         if (result != MPM_RESULT_OK)
         {
             OIC_LOG_V(ERROR, TAG, "Error(%d) stopping plugin %s", result, g_plugin_context->device_name);
@@ -419,6 +448,16 @@ MPMResult maintainInfrastructure(MPMResult result, MPMCommonPluginCtx *ctx)
     return (result);
 }
 
+bool MPMPluginWaitForEvent(MPMPluginCtx *ctx, uint32_t seconds)
+{
+    std::unique_lock<std::mutex> lock(g_eventMutex);
+    g_eventCondition.wait_for(lock, std::chrono::seconds(seconds), [ctx]()
+    {
+        return g_stopping || !ctx->stay_in_process_loop;
+    });
+    return !g_stopping && ctx->stay_in_process_loop;
+}
+
 MPMResult MPMExtractFiltersFromQuery(char *query, char **filterOne, char **filterTwo)
 {
 
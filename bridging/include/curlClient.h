@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
 #include <curl/curl.h>
 #include <stdexcept>
 #include "mpmErrorCode.h"
@@ -46,6 +47,23 @@ namespace OC
 
         const long INVALID_RESPONSE_CODE = 0;
 
+        /// Connections kept to a single host by the asynchronous requests.
+        const long CURL_MAX_HOST_CONNECTIONS = 8L;
+
+        /// Connections kept in total by the asynchronous requests.
+        const long CURL_MAX_TOTAL_CONNECTIONS = 32L;
+
+        class CurlClient;
+
+        /**
+         * Called on the thread of the shared curl event loop once an asynchronous
+         * request completes.
+         *
+         * @param[in] result   MPM_RESULT_OK, or the error send() would have returned.
+         * @param[in] client   The completed request, holding the response.
+         */
+        typedef std::function<void(int result, CurlClient &client)> CurlCompletionCallback;
+
         class CurlClient
         {
 
@@ -72,6 +90,7 @@ namespace OC
                     m_method = getCurlMethodString(method);
                     m_url = url;
                     m_useSsl = CURLUSESSL_TRY;
+                    m_lastResponseCode = INVALID_RESPONSE_CODE;
                 }
 
                 CurlClient &setRequestHeaders(std::vector<std::string> &requestHeaders)
@@ -106,10 +125,29 @@ namespace OC
 
                 int send()
                 {
-                    return doInternalRequest(m_url, m_method, m_requestHeaders, m_requestBody, m_username, m_outHeaders,
-                                             m_response);
+                    return doInternalRequest();
                 }
 
+                /**
+                 * Sends the request without blocking. A copy of the request is sent by the
+                 * shared curl event loop, which runs the requests concurrently and keeps
+                 * their connections alive. The callback must not block for long, as it
+                 * holds up the other requests.
+                 *
+                 * @param[in] callback   Called with the result once the request completes.
+                 *
+                 * @return MPM_RESULT_OK if the request is queued.
+                 */
+                int sendAsync(CurlCompletionCallback callback);
+
+                /**
+                 * Stops the shared curl event loop and closes the kept connections. The
+                 * pending asynchronous requests complete with MPM_RESULT_NETWORK_ERROR.
+                 * Called from a completion callback, it returns without waiting and a
+                 * sendAsync() from the same callback keeps the loop running.
+                 */
+                static void stopEventLoop();
+
                 std::string getResponseBody()
                 {
                     return m_response;
@@ -167,16 +205,19 @@ namespace OC
 
                 } MemoryChunk;
 
+                // Response buffers and header list of a request being sent.
+                struct Transfer;
+
+                friend class CurlEventLoop;
+
                 int decomposeHeader(const char *header, std::vector<std::string> &headers);
 
+                int setupTransfer(CURL *curl, Transfer &transfer);
+
+                int completeTransfer(CURL *curl, CURLcode res, Transfer &transfer);
+
 
-                int doInternalRequest(const std::string &url,
-                                      const std::string &method,
-                                      const std::vector<std::string> &inHeaders,
-                                      const std::string &request,
-                                      const std::string &username,
-                                      std::vector<std::string> &outHeaders,
-                                      std::string &response);
+                int doInternalRequest();
 
                 long m_lastResponseCode;
         };
@@ -27,8 +27,10 @@
 #ifndef _MESSAGEHANDLER_H
 #define _MESSAGEHANDLER_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/types.h>
 #include "mpmErrorCode.h"
 
 #ifdef __cplusplus
@@ -109,6 +111,26 @@ typedef struct
     char manufacturerName[MPM_MAX_LENGTH_256];
 } MPMDeviceSpecificData;
 
+/**
+ * This function creates a channel carrying the messages in one direction between
+ * the mpm library and a plugin process forked after its creation. With shared
+ * memory, the messages are framed in a ring in memory shared with the plugin
+ * process and counted by an eventfd; without, or where this is not supported, an
+ * unnamed pipe is used. Either way both ends are file descriptors that can be
+ * waited on with select().
+ * @param[out] fds          read end and write end of the channel, as with pipe()
+ * @param[in] sharedMemory  true to use a shared memory ring if supported
+ *
+ * @return MPM_RESULT_OK on success, MPM_RESULT_INTERNAL_ERROR on failure
+ */
+MPMResult MPMCreatePipe(int fds[2], bool sharedMemory);
+
+/**
+ * This function closes an end of a channel created with MPMCreatePipe()
+ * @param[in] fd            file descriptor
+ */
+void MPMClosePipe(int fd);
+
 /**
  * This function writes messages to the pipe
  * @param[in] fd            file descriptor
@@ -127,6 +149,24 @@ MPMResult MPMWritePipeMessage(int fd, const MPMPipeMessage *pipe_message);
 */
 ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message);
 
+/**
+ * This function reads a message from the pipe without copying the payload out of a
+ * shared memory ring. The payload stays valid until MPMReleasePipeMessage(), which
+ * must be called before the next message is read.
+ * @param[in] fd                file descriptor
+ * @param[in,out] pipe_message  for storing the read message.
+ *
+ * @return number of bytes read
+*/
+ssize_t MPMReadPipeMessageInPlace(int fd, MPMPipeMessage *pipe_message);
+
+/**
+ * This function releases a message read with MPMReadPipeMessageInPlace()
+ * @param[in] fd                file descriptor
+ * @param[in,out] pipe_message  the read message.
+*/
+void MPMReleasePipeMessage(int fd, MPMPipeMessage *pipe_message);
+
 
 /**
  * This function encodes the metadata received from the plugin
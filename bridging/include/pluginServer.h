@@ -112,6 +112,18 @@ MPMResult pluginReconnect(MPMPluginCtx *ctx, MPMPipeMessage *message);
  */
 void MPMPluginSpecificProcess(void);
 
+/**
+ * This function is called by the worker threads of a plugin between two polls of
+ * its devices, in place of sleep(). It returns as soon as the plugin is being
+ * stopped, so that a worker thread does not hold up the stop of the plugin.
+ *
+ * @param[in] ctx            Context of the plugin
+ * @param[in] seconds        Longest time to wait
+ *
+ * @return false if the plugin is being stopped, true otherwise
+ */
+bool MPMPluginWaitForEvent(MPMPluginCtx *ctx, uint32_t seconds);
+
 /**
  * This function handles the requests from mpm library to plugin
  * @param[in] message        The message to received over the pipe from the mpm library
@@ -115,9 +115,6 @@ static void *readResponse(void *)
 
     std::vector<MPMPluginContext> *loadedPlugins = &g_LoadedPlugins;
 
-    tv.tv_sec = 5;
-    tv.tv_usec = 0;
-
     while (true)
     {
         if (exitResponseThread == true)
@@ -145,9 +142,14 @@ static void *readResponse(void *)
             loadedPluginsItr++;
         }
 
+        /* select() may modify the timeout, so it is set on every pass */
+        tv.tv_sec = 1;
+        tv.tv_usec = 0;
+
         if (-1 == select(maxFd + 1, &(readfds), NULL, NULL, &tv))
         {
-            continue;
+            /* the plugins are still reaped below, but nothing is read */
+            FD_ZERO(&(readfds));
         }
 
         loadedPluginsItr = loadedPlugins->begin();
@@ -162,26 +164,31 @@ static void *readResponse(void *)
             }
             if (ctx->started)
             {
-                if (FD_ISSET(ctx->parent_reads_fds.read_fd, &(readfds)))
+                /*
+                 * The eventfd of the ring never reports end of file, so an exited
+                 * plugin is detected on every pass, whether or not it is readable.
+                 */
+                if (0 != waitpid(ctx->child_pid, &status, WNOHANG))
+                {
+                    OIC_LOG_V(DEBUG, TAG, "Plugin %s is exited",
+                              (*loadedPluginsItr).shared_object_name);
+                    ctx->started = false;
+                }
+                else if (FD_ISSET(ctx->parent_reads_fds.read_fd, &(readfds)))
                 {
-                    pid_t childStat = waitpid(ctx->child_pid, &status, WNOHANG);
                     MPMPipeMessage pipe_message;
                     ssize_t readbytes = 0;
 
                     pipe_message.payloadSize = 0;
                     pipe_message.msgType = MPM_NOMSG;
                     pipe_message.payload = NULL;
-                    readbytes = MPMReadPipeMessage(ctx->parent_reads_fds.read_fd, &pipe_message);
-                    if ((childStat != 0) || (readbytes <= 0))
+                    readbytes = MPMReadPipeMessageInPlace(ctx->parent_reads_fds.read_fd,
+                                                          &pipe_message);
+                    if (readbytes <= 0)
                     {
                         OIC_LOG_V(DEBUG, TAG, "Plugin %s is exited",
                                   (*loadedPluginsItr).shared_object_name);
-                        if (pipe_message.payloadSize > 0)
-                        {
-                            OICFree((void*)pipe_message.payload);
-                            pipe_message.payload = NULL;
-                            pipe_message.payloadSize = 0;
-                        }
+                        MPMReleasePipeMessage(ctx->parent_reads_fds.read_fd, &pipe_message);
                         ctx->started = false;
                     }
                     else
@@ -192,20 +199,13 @@ static void *readResponse(void *)
                                                            (*loadedPluginsItr).shared_object_name);
 
                         pipe_message.msgType = MPM_NOMSG;
-                        if (pipe_message.payloadSize > 0)
-                        {
-                            OICFree((void*)pipe_message.payload);
-                            pipe_message.payload = NULL;
-                            pipe_message.payloadSize = 0;
-                        }
+                        MPMReleasePipeMessage(ctx->parent_reads_fds.read_fd, &pipe_message);
 
                     }
                 }
             }
             loadedPluginsItr++;
         }
-
-        sleep(1);
     }
 
     return (void *)loadedPlugins;
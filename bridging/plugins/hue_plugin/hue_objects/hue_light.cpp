@@ -38,7 +38,7 @@ using namespace OC::Bridging;
 
 const std::string HUE_LIGHT_URI = "/light/";
 
-HueLight::HueLight()
+HueLight::HueLight() : m_refreshing(false)
 {
     m_initialized = true;
     m_uri.empty();
@@ -50,7 +50,8 @@ HueLight::HueLight()
 
 HueLight::HueLight(std::string uri, std::string bridge_ip, std::string bridge_mac,
                    std::string short_id, std::string json) :
-    m_uri(uri), m_bridge_ip(bridge_ip), m_short_id(short_id), m_initialized(false)
+    m_uri(uri), m_bridge_ip(bridge_ip), m_short_id(short_id), m_initialized(false),
+    m_refreshing(false)
 {
     m_initialized = true;
     m_bridge_mac = bridge_mac;
@@ -249,6 +250,46 @@ MPMResult HueLight::getState(light_state_t &state, bool refresh)
     return result;
 }
 
+MPMResult HueLight::refreshStateAsync(state_callback_t callback)
+{
+    if (!m_initialized)
+    {
+        return MPM_RESULT_INVALID_DATA;
+    }
+    if (m_refreshing.exchange(true))
+    {
+        return MPM_RESULT_ALREADY_STARTED;
+    }
+
+    CurlClient cc = CurlClient(CurlClient::CurlMethod::GET, m_uri)
+                    .addRequestHeader(CURL_HEADER_ACCEPT_JSON);
+
+    int curlCode = cc.sendAsync([this, callback](int result, CurlClient &client)
+    {
+        light_state_t oldState = m_state;
+        if (result == MPM_RESULT_OK)
+        {
+            result = parseJsonResponse(client.getResponseBody());
+        }
+        light_state_t newState = m_state;
+        m_refreshing = false;
+
+        if (result != MPM_RESULT_OK)
+        {
+            OIC_LOG_V(ERROR, TAG, "GET request for light failed with error %d", result);
+            return;
+        }
+        callback(oldState, newState);
+    });
+
+    if (curlCode != MPM_RESULT_OK)
+    {
+        m_refreshing = false;
+        return MPM_RESULT_INTERNAL_ERROR;
+    }
+    return MPM_RESULT_OK;
+}
+
 MPMResult HueLight::setState(light_state_t &state)
 {
     MPMResult result = MPM_RESULT_INVALID_DATA;
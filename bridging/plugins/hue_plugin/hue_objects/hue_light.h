@@ -29,6 +29,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <map>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <typeinfo>
 #include "mpmErrorCode.h"
@@ -138,6 +140,26 @@ class HueLight
          */
         MPMResult getState(light_state_t &state, bool refresh = false);
 
+        /**
+         * Called once the state of the light is refreshed by refreshStateAsync().
+         *
+         * @param[in] oldState is the light state before the refresh.
+         * @param[in] newState is the light state after the refresh.
+         */
+        typedef std::function<void(light_state_t &oldState, light_state_t &newState)>
+        state_callback_t;
+
+        /**
+         * Refreshes the light state without blocking. The light is not refreshed again
+         * until the pending refresh completes.
+         *
+         * @param[in] callback is called on success, from the shared curl event loop.
+         *
+         * @return MPM_RESULT_OK if the refresh is sent, MPM_RESULT_ALREADY_STARTED if a
+         *         refresh is pending, or another MPM_RESULT_XXX on error.
+         */
+        MPMResult refreshStateAsync(state_callback_t callback);
+
         /**
          * Sets the current light state of the Hue light.
          *
@@ -232,6 +254,7 @@ class HueLight
         light_state_t m_state;
         light_config_t m_config;
         bool m_initialized;
+        std::atomic<bool> m_refreshing;
 };
 
 typedef std::shared_ptr<HueLight> HueLightSharedPtr;
@@ -1037,6 +1037,30 @@ OCRepPayload *getCommonPayload(const char *uri, char *interfaceQuery,
     return payload;
 }
 
+/**
+ * Sends the notification of a light state change.
+ *
+ * @param[in] uri       resource uri of the light
+ * @param[in] oldState  state of the light before the refresh
+ * @param[in] newState  state of the light after the refresh
+ */
+static void notifyLightStateChange(const std::string &uri, HueLight::light_state_t &oldState,
+                                   HueLight::light_state_t &newState)
+{
+    if (oldState.power != newState.power)
+    {
+        ConcurrentIotivityUtils::queueNotifyObservers(uri + SWITCH_RELATIVE_URI);
+    }
+    else if (hasBrightnessChangedInOCFScale(oldState, newState))
+    {
+        ConcurrentIotivityUtils::queueNotifyObservers(uri + BRIGHTNESS_RELATIVE_URI);
+    }
+    else if ((oldState.hue != newState.hue) || (oldState.sat != newState.sat))
+    {
+        ConcurrentIotivityUtils::queueNotifyObservers(uri + CHROMA_RELATIVE_URI);
+    }
+}
+
 /**
  * Monitors the light state changes and sends notification if
  * any change. Also discovers new Bridges...!
@@ -1051,8 +1075,6 @@ static void *hueDiscoveryThread(void *pointer)
         return NULL;
     }
     OIC_LOG(INFO, TAG, "Plugin specific thread handler entered");
-    HueLight::light_config_t config;
-    std::string uniqueId, uri;
 
     while (true == ctx->stay_in_process_loop)
     {
@@ -1064,36 +1086,23 @@ static void *hueDiscoveryThread(void *pointer)
             {
                 continue;
             }
-            light->getConfig(config);
-
-            std::string uniqueId = createuniqueID(config.uniqueId);
-            uri = (HUE_LIGHT_URI + uniqueId ) ;
+            std::string uri = itr.first;
 
-            HueLight::light_state_t oldState, newState ;
-            light->getState(oldState);
-            light->getState(newState, true);
-
-            if (oldState.power != newState.power)
-            {
-                ConcurrentIotivityUtils::queueNotifyObservers(itr.first + SWITCH_RELATIVE_URI);
-            }
-            else if (hasBrightnessChangedInOCFScale(oldState, newState))
-            {
-                ConcurrentIotivityUtils::queueNotifyObservers(itr.first + BRIGHTNESS_RELATIVE_URI);
-            }
-            else if ((oldState.hue != newState.hue) || (oldState.sat != newState.sat))
+            // The lights are refreshed concurrently, and a change is notified as soon
+            // as the light answers. The callback keeps the light alive.
+            light->refreshStateAsync([uri, light](HueLight::light_state_t &oldState,
+                                                  HueLight::light_state_t &newState)
             {
-                ConcurrentIotivityUtils::queueNotifyObservers(itr.first + CHROMA_RELATIVE_URI);
-            }
-            else
-            {
-                ; //Do nothing here..
-            }
+                notifyLightStateChange(uri, oldState, newState);
+            });
         }
         addedLightsLock.unlock();
         /*start the periodic bridge discovery*/
         DiscoverHueBridges();
-        sleep(MPM_THREAD_PROCESS_SLEEPTIME);
+        if (!MPMPluginWaitForEvent(ctx, MPM_THREAD_PROCESS_SLEEPTIME))
+        {
+            break;
+        }
     }
     OIC_LOG(INFO, TAG, "Leaving plugin specific thread handler");
     pthread_exit(NULL);
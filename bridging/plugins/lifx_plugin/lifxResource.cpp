@@ -662,30 +662,36 @@ void *lightMonitorThread(void *pluginSpecificCtx)
                 {
                     continue;
                 }
-                LifxLight::lightState oldState = l->state;
+                std::string uri = itr.first;
 
-                l->refreshState();
-
-                LifxLight::lightState newState = l->state;
-
-                if (oldState.power != newState.power)
-                {
-                    ConcurrentIotivityUtils::queueNotifyObservers(itr.first + BINARY_SWITCH_RELATIVE_URI);
-                }
-                if (fabs(oldState.brightness - newState.brightness) >
-                    0.00001) // Lazy epsilon for double equals check.
-                {
-                    ConcurrentIotivityUtils::queueNotifyObservers(itr.first + BRIGHTNESS_RELATIVE_URI);
-                }
-                if (oldState.connected != newState.connected)
+                // The lights are refreshed concurrently, and a change is notified as soon
+                // as the light answers. The callback keeps the light alive.
+                l->refreshStateAsync([uri, l](const LifxLight::lightState &oldState)
                 {
-                    OIC_LOG_V(INFO, TAG, "%s is %s", l->config.id.c_str(),
-                              l->state.connected ? "ONLINE" : "OFFLINE");
-                }
+                    LifxLight::lightState newState = l->state;
+
+                    if (oldState.power != newState.power)
+                    {
+                        ConcurrentIotivityUtils::queueNotifyObservers(uri + BINARY_SWITCH_RELATIVE_URI);
+                    }
+                    if (fabs(oldState.brightness - newState.brightness) >
+                        0.00001) // Lazy epsilon for double equals check.
+                    {
+                        ConcurrentIotivityUtils::queueNotifyObservers(uri + BRIGHTNESS_RELATIVE_URI);
+                    }
+                    if (oldState.connected != newState.connected)
+                    {
+                        OIC_LOG_V(INFO, TAG, "%s is %s", l->config.id.c_str(),
+                                  newState.connected ? "ONLINE" : "OFFLINE");
+                    }
+                });
             }
 
             addedLightsLock.unlock();
-            sleep(MPM_THREAD_PROCESS_SLEEPTIME);
+            if (!MPMPluginWaitForEvent(ctx, MPM_THREAD_PROCESS_SLEEPTIME))
+            {
+                break;
+            }
         }
         OIC_LOG(INFO, TAG, "Leaving LIFX monitor thread");
     }
@@ -205,8 +205,51 @@ MPMResult LifxLight::refreshState()
         return MPM_RESULT_INTERNAL_ERROR;
     }
 
-    std::string response = cc.getResponseBody();
+    return updateState(cc.getResponseBody());
+}
 
+MPMResult LifxLight::refreshStateAsync(stateCallback callback)
+{
+    if (this->user.empty())
+    {
+        throw std::runtime_error("Light not created in valid state by constructor. No \"user\" found");
+    }
+    if (refreshing.exchange(true))
+    {
+        return MPM_RESULT_ALREADY_STARTED;
+    }
+
+    CurlClient cc = CurlClient(CurlClient::CurlMethod::GET, uri)
+                    .addRequestHeader(CURL_HEADER_ACCEPT_JSON)
+                    .setUserName(user);
+
+    int curlCode = cc.sendAsync([this, callback](int result, CurlClient &client)
+    {
+        lightState oldState = this->state;
+        if (result == MPM_RESULT_OK)
+        {
+            result = updateState(client.getResponseBody());
+        }
+        refreshing = false;
+
+        if (result != MPM_RESULT_OK)
+        {
+            OIC_LOG_V(ERROR, TAG, "GET request for light failed with error %d", result);
+            return;
+        }
+        callback(oldState);
+    });
+
+    if (curlCode != MPM_RESULT_OK)
+    {
+        refreshing = false;
+        return MPM_RESULT_INTERNAL_ERROR;
+    }
+    return MPM_RESULT_OK;
+}
+
+MPMResult LifxLight::updateState(const std::string &response)
+{
     std::vector<std::shared_ptr<LifxLight>> parsedLights;
     MPMResult parseResult = parseLightsFromCloudResponse(response, this->user, parsedLights);
 
@@ -24,6 +24,10 @@
 
 
 #include <vector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
 #include <typeinfo>
 #include <mpmErrorCode.h>
 
@@ -56,10 +60,10 @@ class LifxLight
             }
         } lightConfig;
 
-        LifxLight() {}
+        LifxLight() : refreshing(false) {}
         virtual ~LifxLight() {}
 
-        LifxLight(lightState &state, lightConfig &config, const std::string &user)
+        LifxLight(lightState &state, lightConfig &config, const std::string &user) : refreshing(false)
         {
             this->user = user;
             this->state = state;
@@ -73,6 +77,21 @@ class LifxLight
          */
         MPMResult refreshState();
 
+        /**
+         * Called once the state of the light is refreshed by refreshStateAsync().
+         * @param[in] oldState Is the light state before the refresh.
+         */
+        typedef std::function<void(const lightState &oldState)> stateCallback;
+
+        /**
+         * Refreshes the state without blocking. The light is not refreshed again until
+         * the pending refresh completes.
+         * @param[in] callback Is called on success, from the shared curl event loop.
+         * @return MPM_RESULT_OK if the refresh is sent, MPM_RESULT_ALREADY_STARTED if a
+         *         refresh is pending, else appropriate error code on error
+         */
+        MPMResult refreshStateAsync(stateCallback callback);
+
         MPMResult setPower(bool power);
 
         /**
@@ -97,6 +116,9 @@ class LifxLight
 
     private:
         std::string user;
+        std::atomic<bool> refreshing;
+
+        MPMResult updateState(const std::string &response);
 
         MPMResult setState(std::string &setPowerRequest);
 };
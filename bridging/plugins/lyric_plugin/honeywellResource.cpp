@@ -890,7 +890,10 @@ void *accessTokenMonitorThread(void *pointer)
                 // not time to refresh token yet, just decrement
                 reauthCountdown--;
             }
-            sleep(MPM_THREAD_PROCESS_SLEEPTIME);
+            if (!MPMPluginWaitForEvent(ctx, MPM_THREAD_PROCESS_SLEEPTIME))
+            {
+                break;
+            }
         }
         OIC_LOG(INFO, LOG_TAG,"Leaving LYRIC monitor thread");
     }
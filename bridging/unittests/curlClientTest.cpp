@@ -0,0 +1,330 @@
+//******************************************************************
+//
+// Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+
+#include "iotivity_config.h"
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "curlClient.h"
+
+using namespace OC::Bridging;
+
+// Bulbs bridged by the stub plugin
+#define STUB_NUM_OF_BULBS 30
+
+// Time the stub bridge takes to answer for a bulb, in milliseconds
+#define STUB_BULB_LATENCY_MS 5
+
+/**
+ * A bridge answering the state of its bulbs over HTTP/1.1 with keep-alive, one
+ * thread per connection, like the bridges and cloud services the plugins talk to.
+ */
+class StubBridge
+{
+    public:
+        StubBridge() : m_connections(0), m_requests(0), m_fd(-1), m_port(0), m_stop(false)
+        {
+        }
+
+        ~StubBridge()
+        {
+            stop();
+        }
+
+        bool start()
+        {
+            m_fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (m_fd < 0)
+            {
+                return false;
+            }
+            int on = 1;
+            setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            struct sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t len = sizeof(addr);
+            if (bind(m_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+                listen(m_fd, 64) != 0 ||
+                getsockname(m_fd, (struct sockaddr *)&addr, &len) != 0)
+            {
+                return false;
+            }
+            m_port = ntohs(addr.sin_port);
+            m_acceptThread = std::thread(&StubBridge::acceptConnections, this);
+            return true;
+        }
+
+        void stop()
+        {
+            if (m_fd < 0)
+            {
+                return;
+            }
+            m_stop = true;
+            m_acceptThread.join();
+            for (std::thread &thread : m_threads)
+            {
+                thread.join();
+            }
+            m_threads.clear();
+            close(m_fd);
+            m_fd = -1;
+        }
+
+        std::string uri(int bulb) const
+        {
+            return "http://127.0.0.1:" + std::to_string(m_port) + "/lights/" +
+                   std::to_string(bulb);
+        }
+
+        std::atomic<uint32_t> m_connections;
+        std::atomic<uint32_t> m_requests;
+
+    private:
+        void acceptConnections()
+        {
+            while (!m_stop)
+            {
+                struct pollfd pfd = {m_fd, POLLIN, 0};
+                if (poll(&pfd, 1, 50) <= 0)
+                {
+                    continue;
+                }
+                int client = accept(m_fd, NULL, NULL);
+                if (client >= 0)
+                {
+                    m_connections++;
+                    m_threads.push_back(std::thread(&StubBridge::serve, this, client));
+                }
+            }
+        }
+
+        void serve(int client)
+        {
+            std::string request;
+            char buffer[1024];
+            while (!m_stop)
+            {
+                size_t end = request.find("\r\n\r\n");
+                if (end == std::string::npos)
+                {
+                    struct pollfd pfd = {client, POLLIN, 0};
+                    if (poll(&pfd, 1, 50) <= 0)
+                    {
+                        continue;
+                    }
+                    ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+                    if (n <= 0)
+                    {
+                        break;
+                    }
+                    request.append(buffer, n);
+                    continue;
+                }
+
+                size_t path = request.find(' ') + 1;
+                std::string bulb = request.substr(path, request.find(' ', path) - path);
+                request.erase(0, end + 4);
+                m_requests++;
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(STUB_BULB_LATENCY_MS));
+                std::string body = "{\"uri\":\"" + bulb + "\",\"state\":{\"on\":true}}";
+                std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                                       "Content-Length: " + std::to_string(body.size()) +
+                                       "\r\n\r\n" + body;
+                if (send(client, response.c_str(), response.size(), MSG_NOSIGNAL) < 0)
+                {
+                    break;
+                }
+            }
+            close(client);
+        }
+
+        int m_fd;
+        uint16_t m_port;
+        std::atomic<bool> m_stop;
+        std::thread m_acceptThread;
+        std::vector<std::thread> m_threads;
+};
+
+TEST(CurlClientTest, SendReusesConnection)
+{
+    StubBridge bridge;
+    ASSERT_TRUE(bridge.start());
+
+    for (int i = 0; i < 20; i++)
+    {
+        CurlClient cc = CurlClient(CurlClient::CurlMethod::GET, bridge.uri(i))
+                        .addRequestHeader(CURL_HEADER_ACCEPT_JSON);
+        ASSERT_EQ(MPM_RESULT_OK, cc.send());
+        EXPECT_EQ(200, cc.getLastResponseCode());
+        EXPECT_EQ("{\"uri\":\"/lights/" + std::to_string(i) + "\",\"state\":{\"on\":true}}",
+                  cc.getResponseBody());
+        EXPECT_FALSE(cc.getResponseHeaders().empty());
+    }
+    EXPECT_EQ(20u, bridge.m_requests.load());
+    EXPECT_EQ(1u, bridge.m_connections.load());
+
+    CurlClient::stopEventLoop();
+}
+
+TEST(CurlClientTest, SendAsyncFailure)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool completed = false;
+    int result = MPM_RESULT_OK;
+
+    // Nothing listens on the discard port
+    CurlClient cc = CurlClient(CurlClient::CurlMethod::GET, "http://127.0.0.1:9/");
+    ASSERT_EQ(MPM_RESULT_OK, cc.sendAsync([&](int res, CurlClient &)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = res;
+        completed = true;
+        condition.notify_all();
+    }));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(condition.wait_for(lock, std::chrono::seconds(10), [&]() { return completed; }));
+    EXPECT_EQ(MPM_RESULT_NETWORK_ERROR, result);
+    lock.unlock();
+
+    CurlClient::stopEventLoop();
+}
+
+TEST(CurlClientTest, StubPluginPoll)
+{
+    StubBridge bridge;
+    ASSERT_TRUE(bridge.start());
+
+    // One poll of the bulbs, one request at a time, as the plugins did
+    for (int i = 0; i < STUB_NUM_OF_BULBS; i++)
+    {
+        CurlClient cc = CurlClient(CurlClient::CurlMethod::GET, bridge.uri(i));
+        EXPECT_EQ(MPM_RESULT_OK, cc.send());
+    }
+
+    // One poll of the bulbs through the event loop, notifying each state on arrival
+    std::mutex mutex;
+    std::condition_variable condition;
+    int completed = 0;
+    int succeeded = 0;
+    for (int i = 0; i < STUB_NUM_OF_BULBS; i++)
+    {
+        std::string expected = "/lights/" + std::to_string(i);
+        CurlClient cc = CurlClient(CurlClient::CurlMethod::GET, bridge.uri(i));
+        EXPECT_EQ(MPM_RESULT_OK, cc.sendAsync([&, expected](int result, CurlClient &client)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (MPM_RESULT_OK == result &&
+                client.getResponseBody().find(expected + "\"") != std::string::npos)
+            {
+                succeeded++;
+            }
+            completed++;
+            condition.notify_all();
+        }));
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(condition.wait_for(lock, std::chrono::seconds(60),
+                                   [&]() { return completed == STUB_NUM_OF_BULBS; }));
+    lock.unlock();
+
+    EXPECT_EQ(STUB_NUM_OF_BULBS, succeeded);
+    EXPECT_EQ(2u * STUB_NUM_OF_BULBS, bridge.m_requests.load());
+    // The synchronous requests share one connection, the concurrent ones a bounded set
+    EXPECT_GE((uint32_t)(1 + CURL_MAX_HOST_CONNECTIONS), bridge.m_connections.load());
+
+    CurlClient::stopEventLoop();
+}
+
+TEST(CurlClientTest, RestartAfterStopFromCallback)
+{
+    StubBridge bridge;
+    ASSERT_TRUE(bridge.start());
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    int completed = 0;
+    int succeeded = 0;
+    auto done = [&](int result, CurlClient &)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (MPM_RESULT_OK == result)
+        {
+            succeeded++;
+        }
+        completed++;
+        condition.notify_all();
+    };
+
+    // Stopped and restarted from the same callback, the loop carries on
+    CurlClient first = CurlClient(CurlClient::CurlMethod::GET, bridge.uri(0));
+    ASSERT_EQ(MPM_RESULT_OK, first.sendAsync([&](int result, CurlClient &client)
+    {
+        CurlClient::stopEventLoop();
+        CurlClient second = CurlClient(CurlClient::CurlMethod::GET, bridge.uri(1));
+        EXPECT_EQ(MPM_RESULT_OK, second.sendAsync(done));
+        done(result, client);
+    }));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(condition.wait_for(lock, std::chrono::seconds(10), [&]() { return completed == 2; }));
+    lock.unlock();
+
+    // Stopped from a callback and restarted from another thread, the old loop is joined first
+    CurlClient third = CurlClient(CurlClient::CurlMethod::GET, bridge.uri(2));
+    ASSERT_EQ(MPM_RESULT_OK, third.sendAsync([&](int result, CurlClient &client)
+    {
+        CurlClient::stopEventLoop();
+        done(result, client);
+    }));
+    lock.lock();
+    EXPECT_TRUE(condition.wait_for(lock, std::chrono::seconds(10), [&]() { return completed == 3; }));
+    lock.unlock();
+
+    CurlClient fourth = CurlClient(CurlClient::CurlMethod::GET, bridge.uri(3));
+    ASSERT_EQ(MPM_RESULT_OK, fourth.sendAsync(done));
+    lock.lock();
+    EXPECT_TRUE(condition.wait_for(lock, std::chrono::seconds(10), [&]() { return completed == 4; }));
+    lock.unlock();
+
+    EXPECT_EQ(4, succeeded);
+    EXPECT_EQ(4u, bridge.m_requests.load());
+
+    CurlClient::stopEventLoop();
+}
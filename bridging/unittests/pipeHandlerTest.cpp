@@ -0,0 +1,244 @@
+//******************************************************************
+//
+// Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+
+#include "iotivity_config.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <vector>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "messageHandler.h"
+
+// Messages exchanged with the stub plugin over each kind of channel
+#define ECHO_NUM_OF_MESSAGES 200
+
+// Size of the messages, about the size of a notification of a bridged light
+#define ECHO_MESSAGE_SIZE 256
+
+/**
+ * The two channels between the MPM and a plugin, as created by pluginCreate().
+ */
+class PluginChannels
+{
+    public:
+        PluginChannels(bool sharedMemory)
+        {
+            EXPECT_EQ(MPM_RESULT_OK, MPMCreatePipe(m_toPlugin, sharedMemory));
+            EXPECT_EQ(MPM_RESULT_OK, MPMCreatePipe(m_fromPlugin, sharedMemory));
+        }
+
+        ~PluginChannels()
+        {
+            MPMClosePipe(m_toPlugin[0]);
+            MPMClosePipe(m_toPlugin[1]);
+            MPMClosePipe(m_fromPlugin[0]);
+            MPMClosePipe(m_fromPlugin[1]);
+        }
+
+        /**
+         * Forks a plugin process answering every message with the same message,
+         * as the stub plugin does, until it receives MPM_STOP.
+         */
+        pid_t startEchoPlugin()
+        {
+            pid_t pid = fork();
+            if (0 == pid)
+            {
+                while (true)
+                {
+                    MPMPipeMessage message = { 0, MPM_NOMSG, NULL };
+                    if (MPMReadPipeMessageInPlace(m_toPlugin[0], &message) <= 0
+                        || MPM_STOP == message.msgType)
+                    {
+                        _exit(0);
+                    }
+                    if (MPM_RESULT_OK != MPMWritePipeMessage(m_fromPlugin[1], &message))
+                    {
+                        _exit(1);
+                    }
+                    MPMReleasePipeMessage(m_toPlugin[0], &message);
+                }
+            }
+            return pid;
+        }
+
+        void echo(size_t count, size_t size)
+        {
+            std::vector<uint8_t> payload(size, 'x');
+            for (size_t i = 0; i < count; i++)
+            {
+                payload[0] = (uint8_t)i;
+                MPMPipeMessage request = { payload.size(), MPM_ADD, payload.data() };
+                EXPECT_EQ(MPM_RESULT_OK, MPMWritePipeMessage(m_toPlugin[1], &request));
+
+                MPMPipeMessage response = { 0, MPM_NOMSG, NULL };
+                EXPECT_LT(0, MPMReadPipeMessageInPlace(m_fromPlugin[0], &response));
+                EXPECT_EQ(MPM_ADD, response.msgType);
+                EXPECT_EQ(size, response.payloadSize);
+                EXPECT_EQ((uint8_t)i, response.payload[0]);
+                MPMReleasePipeMessage(m_fromPlugin[0], &response);
+            }
+        }
+
+        void stopEchoPlugin(pid_t pid)
+        {
+            MPMPipeMessage stop = { 0, MPM_STOP, NULL };
+            EXPECT_EQ(MPM_RESULT_OK, MPMWritePipeMessage(m_toPlugin[1], &stop));
+            int status = 0;
+            EXPECT_EQ(pid, waitpid(pid, &status, 0));
+            EXPECT_TRUE(WIFEXITED(status));
+            EXPECT_EQ(0, WEXITSTATUS(status));
+        }
+
+        int m_toPlugin[2];
+        int m_fromPlugin[2];
+};
+
+TEST(PipeHandlerTest, RingMessagesAreReadInPlace)
+{
+    PluginChannels channels(true);
+    const std::string uri = "/hue/light/1";
+    MPMPipeMessage message = { uri.size(), MPM_ADD, (const uint8_t *)uri.c_str() };
+    ASSERT_EQ(MPM_RESULT_OK, MPMWritePipeMessage(channels.m_toPlugin[1], &message));
+    MPMPipeMessage empty = { 0, MPM_SCAN, NULL };
+    ASSERT_EQ(MPM_RESULT_OK, MPMWritePipeMessage(channels.m_toPlugin[1], &empty));
+
+    MPMPipeMessage read = { 0, MPM_NOMSG, NULL };
+    EXPECT_LT(0, MPMReadPipeMessageInPlace(channels.m_toPlugin[0], &read));
+    EXPECT_EQ(MPM_ADD, read.msgType);
+    ASSERT_EQ(uri.size(), read.payloadSize);
+    EXPECT_STREQ(uri.c_str(), (const char *)read.payload);
+    MPMReleasePipeMessage(channels.m_toPlugin[0], &read);
+    EXPECT_EQ(NULL, read.payload);
+
+    EXPECT_LT(0, MPMReadPipeMessage(channels.m_toPlugin[0], &read));
+    EXPECT_EQ(MPM_SCAN, read.msgType);
+    EXPECT_EQ(0u, read.payloadSize);
+}
+
+TEST(PipeHandlerTest, RingWrapsAround)
+{
+    PluginChannels channels(true);
+    std::vector<uint8_t> payload(100000);
+    for (size_t i = 0; i < 200; i++)
+    {
+        size_t size = (i * 7919) % payload.size();
+        for (size_t j = 0; j < size; j++)
+        {
+            payload[j] = (uint8_t)(i + j);
+        }
+        MPMPipeMessage message = { size, MPM_ADD, payload.data() };
+        ASSERT_EQ(MPM_RESULT_OK, MPMWritePipeMessage(channels.m_toPlugin[1], &message));
+
+        MPMPipeMessage read = { 0, MPM_NOMSG, NULL };
+        ASSERT_LT(0, MPMReadPipeMessageInPlace(channels.m_toPlugin[0], &read));
+        ASSERT_EQ(size, read.payloadSize);
+        for (size_t j = 0; j < size; j++)
+        {
+            ASSERT_EQ((uint8_t)(i + j), read.payload[j]);
+        }
+        MPMReleasePipeMessage(channels.m_toPlugin[0], &read);
+    }
+}
+
+TEST(PipeHandlerTest, RingRejectsLargeMessages)
+{
+    PluginChannels channels(true);
+    std::vector<uint8_t> payload(1024 * 1024);
+    MPMPipeMessage message = { payload.size(), MPM_ADD, payload.data() };
+    EXPECT_EQ(MPM_RESULT_INSUFFICIENT_BUFFER,
+              MPMWritePipeMessage(channels.m_toPlugin[1], &message));
+}
+
+TEST(PipeHandlerTest, RingWriterWaitsForRoom)
+{
+    PluginChannels channels(true);
+    std::vector<uint8_t> payload(100000, 'x');
+    MPMPipeMessage message = { payload.size(), MPM_ADD, payload.data() };
+
+    // Fill the ring until the next message does not fit.
+    size_t written = 0;
+    while ((written + 1) * (payload.size() + 64) < 1024 * 1024)
+    {
+        ASSERT_EQ(MPM_RESULT_OK, MPMWritePipeMessage(channels.m_toPlugin[1], &message));
+        written++;
+    }
+
+    std::atomic<bool> done(false);
+    MPMResult result = MPM_RESULT_INTERNAL_ERROR;
+    std::thread writer([&]()
+    {
+        result = MPMWritePipeMessage(channels.m_toPlugin[1], &message);
+        done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(done);
+
+    // Releasing a message wakes the writer up at once.
+    auto start = std::chrono::steady_clock::now();
+    MPMPipeMessage read = { 0, MPM_NOMSG, NULL };
+    EXPECT_LT(0, MPMReadPipeMessageInPlace(channels.m_toPlugin[0], &read));
+    MPMReleasePipeMessage(channels.m_toPlugin[0], &read);
+    writer.join();
+    EXPECT_EQ(MPM_RESULT_OK, result);
+    EXPECT_GT(std::chrono::seconds(1), std::chrono::steady_clock::now() - start);
+
+    for (size_t i = 0; i < written; i++)
+    {
+        EXPECT_LT(0, MPMReadPipeMessageInPlace(channels.m_toPlugin[0], &read));
+        EXPECT_EQ(payload.size(), read.payloadSize);
+        MPMReleasePipeMessage(channels.m_toPlugin[0], &read);
+    }
+}
+
+TEST(PipeHandlerTest, PipeMessagesAreReleased)
+{
+    PluginChannels channels(false);
+    const std::string uri = "/lifx/light/1";
+    MPMPipeMessage message = { uri.size() + 1, MPM_ADD, (const uint8_t *)uri.c_str() };
+    ASSERT_EQ(MPM_RESULT_OK, MPMWritePipeMessage(channels.m_toPlugin[1], &message));
+
+    MPMPipeMessage read = { 0, MPM_NOMSG, NULL };
+    EXPECT_LT(0, MPMReadPipeMessageInPlace(channels.m_toPlugin[0], &read));
+    EXPECT_EQ(MPM_ADD, read.msgType);
+    EXPECT_STREQ(uri.c_str(), (const char *)read.payload);
+    MPMReleasePipeMessage(channels.m_toPlugin[0], &read);
+    EXPECT_EQ(NULL, read.payload);
+}
+
+TEST(PipeHandlerTest, EchoPluginRoundTrips)
+{
+    for (int sharedMemory = 0; sharedMemory < 2; sharedMemory++)
+    {
+        PluginChannels channels(sharedMemory != 0);
+        pid_t pid = channels.startEchoPlugin();
+        ASSERT_LT(0, pid);
+        channels.echo(ECHO_NUM_OF_MESSAGES, ECHO_MESSAGE_SIZE);
+        channels.stopEchoPlugin(pid);
+    }
+}
@@ -93,6 +93,19 @@ OCThreadResult_t oc_thread_free(oc_thread t);
  */
 OCThreadResult_t oc_thread_wait(oc_thread t);
 
+/**
+ * Detach a thread, so that its resources are released when its execution completes
+ * without being waited on. The thread shall still be freed with oc_thread_free().
+ * A thread may detach itself.
+ *
+ * @param[in] t The thread to be detached
+ * @return OCThreadResult_t An enumeration of possible outcomes
+ * @retval OC_THREAD_SUCCESS If the thread was successfully detached
+ * @retval OC_THREAD_INVALID_PARAMETER If param t is NULL
+ *
+ */
+OCThreadResult_t oc_thread_detach(oc_thread t);
+
 /**
  * Creates new mutex.
  *
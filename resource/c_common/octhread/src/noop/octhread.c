@@ -82,6 +82,12 @@ OCThreadResult_t oc_thread_wait(oc_thread t)
     return OC_THREAD_INVALID;
 }
 
+OCThreadResult_t oc_thread_detach(oc_thread t)
+{
+    OC_UNUSED(t);
+    return OC_THREAD_INVALID;
+}
+
 oc_mutex oc_mutex_new(void)
 {
     return (oc_mutex)&g_mutexInfo;
@@ -179,6 +179,24 @@ OCThreadResult_t oc_thread_wait(oc_thread t)
     return res;
 }
 
+OCThreadResult_t oc_thread_detach(oc_thread t)
+{
+    oc_thread_internal *threadInfo = (oc_thread_internal*) t;
+    if (!threadInfo)
+    {
+        OIC_LOG_V(ERROR, TAG, "%s Invalid thread !", __func__);
+        return OC_THREAD_INVALID_PARAMETER;
+    }
+
+    int detachres = pthread_detach(threadInfo->thread);
+    if (0 != detachres)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to detach thread with error %d", detachres);
+        return OC_THREAD_INVALID;
+    }
+    return OC_THREAD_SUCCESS;
+}
+
 oc_mutex oc_mutex_new(void)
 {
     oc_mutex retVal = NULL;
@@ -131,6 +131,17 @@ OCThreadResult_t oc_thread_wait(oc_thread t)
     return res;
 }
 
+OCThreadResult_t oc_thread_detach(oc_thread t)
+{
+    // The resources of the thread are released once oc_thread_free() closes its handle.
+    if (!t)
+    {
+        OIC_LOG_V(ERROR, TAG, "%s Invalid thread !", __func__);
+        return OC_THREAD_INVALID_PARAMETER;
+    }
+    return OC_THREAD_SUCCESS;
+}
+
 oc_mutex oc_mutex_new(void)
 {
     oc_mutex retVal = NULL;
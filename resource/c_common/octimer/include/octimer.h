@@ -33,6 +33,9 @@
 #include <sys/time.h>
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -69,17 +72,74 @@ time_t timespec_diff(const time_t after, const time_t before);
  */
 void timespec_add(time_t *to, const time_t seconds);
 
+/**
+ * Run the callbacks of the expired timers.
+ */
 void checkTimeout(void);
 
 long int getSeconds(struct tm *tp);
 time_t getRelativeIntervalOfWeek(struct tm *tp);
 time_t getSecondsFromAbsTime(struct tm *tp);
 
+/**
+ * Start the timer thread, if it is not running.
+ *
+ * @return 0 on success, -1 if the thread could not be started.
+ */
 int initThread(void);
+
+/**
+ * Timer thread: waits until the earliest timer expires, then runs its callback.
+ */
 void *loop(void *threadid);
+
+/**
+ * Register a timer.
+ *
+ * The callback is called once from the timer thread, without any lock held, so it may
+ * register or unregister timers.
+ *
+ * @param[in] seconds delay before the callback is called, must be positive.
+ * @param[out] id handle of the timer.
+ * @param[in] cb callback to be called.
+ * @param[in] ctx context given to the callback.
+ * @return time at which the timer expires, or -1 on failure.
+ */
 time_t OC_CALL registerTimer(const time_t seconds, int *id, TimerCallback cb, void *ctx);
+
+/**
+ * Register a timer with a delay in milliseconds.
+ *
+ * @param[in] milliseconds delay before the callback is called.
+ * @param[out] id handle of the timer.
+ * @param[in] cb callback to be called.
+ * @param[in] ctx context given to the callback.
+ * @return true on success.
+ */
+bool OC_CALL registerTimerMs(uint64_t milliseconds, int *id, TimerCallback cb, void *ctx);
+
+/**
+ * Change the delay of a pending timer.
+ *
+ * @param[in] id handle of the timer.
+ * @param[in] milliseconds new delay before the callback is called, from now.
+ * @return true on success, false if the timer has already expired or was unregistered.
+ */
+bool OC_CALL rescheduleTimer(int id, uint64_t milliseconds);
+
+/**
+ * Cancel a pending timer. Handles of expired or unregistered timers are ignored.
+ *
+ * @param[in] id handle of the timer.
+ */
 void OC_CALL unregisterTimer(int id);
 
+/**
+ * Stop the timer thread and cancel all the pending timers.
+ * When called from a timer callback, the thread ends once the callback returns.
+ */
+void OC_CALL terminateTimerThread(void);
+
 
 #ifdef __cplusplus
 }
@@ -28,12 +28,6 @@
 #ifdef HAVE_WINDOWS_H
 #include <windows.h>
 #endif
-#ifdef HAVE_PTHREAD_H
-#include <pthread.h>
-#endif
-#ifdef HAVE_UNISTD_H
-#include <unistd.h>
-#endif
 #ifdef HAVE_MEMORY_H
 #include <memory.h>
 #endif
@@ -47,24 +41,70 @@
 #include <stdio.h>
 
 #include "octimer.h"
+#include "octhread.h"
+#include "ocatomic.h"
+#include "oic_malloc.h"
+#include "oic_time.h"
+#include "experimental/logger.h"
 
-#define SECOND (1)
+#define TAG "OIC_TIMER"
 
-#define TIMEOUTS 10
+#define SECOND (1)
 
-#define TIMEOUT_USED   1
-#define TIMEOUT_UNUSED  2
+/*
+ * A timer handle holds the slot of the timer in its low bits, and the generation of
+ * the slot in the high bits, so that the handle of an expired timer does not refer
+ * to the next timer using the same slot.
+ */
+#define TIMER_SLOT_BITS 22
+#define TIMER_MAX_SLOTS ((size_t)1 << TIMER_SLOT_BITS)
+#define TIMER_GENERATION_MASK ((1 << (31 - TIMER_SLOT_BITS)) - 1)
 
-pthread_t thread_id = 0; // 0: initial thread id (meaningless)
+#define TIMER_MIN_SLOTS 16
 
-struct timelist_t
+typedef struct
 {
-    int timeout_state;
-    time_t timeout_seconds;
-    time_t timeout_time;
+    uint64_t deadline;      /**< in milliseconds (OICGetCurrentTime() clock). */
     TimerCallback cb;
     void *ctx;
-} timeout_list[TIMEOUTS];
+    size_t heapIndex;       /**< position + 1 in g_timerHeap, 0 if the slot is free. */
+    int generation;
+    size_t nextFree;        /**< next free slot, if the slot is free. */
+} TimerSlot;
+
+/* Lazy initialization state of g_timerMutex and g_timerCond. */
+#define TIMER_LOCK_NONE 0
+#define TIMER_LOCK_CREATING 1
+#define TIMER_LOCK_READY 2
+
+static volatile int32_t g_timerLockState = TIMER_LOCK_NONE;
+static oc_mutex g_timerMutex = NULL;
+static oc_cond g_timerCond = NULL;
+
+#if defined(_MSC_VER)
+#define TIMER_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define TIMER_THREAD_LOCAL __thread
+#endif
+
+static oc_thread g_timerThread = NULL;
+
+/* The timer thread runs while this matches the generation it was started with. */
+static uintptr_t g_timerThreadGeneration = 0;
+
+#ifdef TIMER_THREAD_LOCAL
+/* Set on the timer thread, which cannot wait for itself when a callback terminates it. */
+static TIMER_THREAD_LOCAL bool t_onTimerThread = false;
+#endif
+
+static TimerSlot *g_timerSlots = NULL;
+static size_t g_timerCapacity = 0;
+static size_t g_timerFreeSlot = 0;      /* first free slot + 1, 0 if none. */
+static size_t g_timerUsedSlots = 0;     /* slots used at least once. */
+
+/* Min-heap of the slots of the pending timers, ordered by deadline. */
+static size_t *g_timerHeap = NULL;
+static size_t g_timerCount = 0;
 
 time_t timespec_diff(const time_t after, const time_t before)
 {
@@ -153,117 +193,411 @@ time_t getSecondsFromAbsTime(struct tm *tp)
     return delayed_time;
 }
 
-time_t OC_CALL registerTimer(const time_t seconds, int *id, TimerCallback cb, void *ctx)
+static bool lockTimers(void)
 {
-    time_t now, then;
-    time_t next;
-    int i, idx;
-
-    if (0 == thread_id)
+    if (TIMER_LOCK_READY != g_timerLockState)
     {
-        initThread();
+        if (oc_atomic_cmpxchg(&g_timerLockState, TIMER_LOCK_NONE, TIMER_LOCK_CREATING))
+        {
+            g_timerMutex = oc_mutex_new();
+            g_timerCond = oc_cond_new();
+            if (!g_timerMutex || !g_timerCond)
+            {
+                OIC_LOG(ERROR, TAG, "Failed to create the timer lock");
+                oc_cond_free(g_timerCond);
+                oc_mutex_free(g_timerMutex);
+                g_timerCond = NULL;
+                g_timerMutex = NULL;
+                oc_atomic_cmpxchg(&g_timerLockState, TIMER_LOCK_CREATING, TIMER_LOCK_NONE);
+                return false;
+            }
+            oc_atomic_cmpxchg(&g_timerLockState, TIMER_LOCK_CREATING, TIMER_LOCK_READY);
+        }
+        while (TIMER_LOCK_CREATING == oc_atomic_add(&g_timerLockState, 0))
+        {
+            // another thread is creating the lock.
+        }
+        if (TIMER_LOCK_READY != g_timerLockState)
+        {
+            return false;
+        }
     }
 
-    if (seconds <= 0)
-        return -1 ;
+    oc_mutex_lock(g_timerMutex);
+    return true;
+}
+
+static void placeTimer(size_t position, size_t slot)
+{
+    g_timerHeap[position] = slot;
+    g_timerSlots[slot].heapIndex = position + 1;
+}
 
-    // get the current time
-    time(&now);
+static bool isEarlier(size_t slot, size_t other)
+{
+    return g_timerSlots[slot].deadline < g_timerSlots[other].deadline;
+}
+
+static void siftUp(size_t position)
+{
+    size_t slot = g_timerHeap[position];
+    while (position > 0)
+    {
+        size_t parent = (position - 1) / 2;
+        if (!isEarlier(slot, g_timerHeap[parent]))
+        {
+            break;
+        }
+        placeTimer(position, g_timerHeap[parent]);
+        position = parent;
+    }
+    placeTimer(position, slot);
+}
 
-    for (idx = 0; idx < TIMEOUTS; ++idx)
-        if (!((timeout_list[idx].timeout_state & TIMEOUT_USED) & TIMEOUT_USED))
+static void siftDown(size_t position)
+{
+    size_t slot = g_timerHeap[position];
+    for (;;)
+    {
+        size_t child = 2 * position + 1;
+        if (child >= g_timerCount)
+        {
             break;
+        }
+        if ((child + 1 < g_timerCount) && isEarlier(g_timerHeap[child + 1], g_timerHeap[child]))
+        {
+            child++;
+        }
+        if (!isEarlier(g_timerHeap[child], slot))
+        {
+            break;
+        }
+        placeTimer(position, g_timerHeap[child]);
+        position = child;
+    }
+    placeTimer(position, slot);
+}
+
+static bool growTimers(void)
+{
+    if (g_timerCapacity >= TIMER_MAX_SLOTS)
+    {
+        OIC_LOG(ERROR, TAG, "Too many timers");
+        return false;
+    }
+
+    size_t capacity = g_timerCapacity ? (2 * g_timerCapacity) : TIMER_MIN_SLOTS;
+    TimerSlot *slots = (TimerSlot *)OICRealloc(g_timerSlots, capacity * sizeof(TimerSlot));
+    if (!slots)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate the timers");
+        return false;
+    }
+    g_timerSlots = slots;
+
+    size_t *heap = (size_t *)OICRealloc(g_timerHeap, capacity * sizeof(size_t));
+    if (!heap)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate the timers");
+        return false;
+    }
+    g_timerHeap = heap;
+    g_timerCapacity = capacity;
+    return true;
+}
+
+/* Must be called with g_timerMutex held. */
+static bool allocateTimer(size_t *slot)
+{
+    if (g_timerFreeSlot)
+    {
+        *slot = g_timerFreeSlot - 1;
+        g_timerFreeSlot = g_timerSlots[*slot].nextFree;
+        return true;
+    }
+
+    if ((g_timerUsedSlots == g_timerCapacity) && !growTimers())
+    {
+        return false;
+    }
+    *slot = g_timerUsedSlots++;
+    g_timerSlots[*slot].generation = 0;
+    return true;
+}
+
+/* Must be called with g_timerMutex held. */
+static void removeTimer(size_t slot)
+{
+    size_t position = g_timerSlots[slot].heapIndex - 1;
+    g_timerSlots[slot].heapIndex = 0;
+    g_timerSlots[slot].generation = (g_timerSlots[slot].generation + 1) & TIMER_GENERATION_MASK;
+    g_timerSlots[slot].nextFree = g_timerFreeSlot;
+    g_timerFreeSlot = slot + 1;
+
+    g_timerCount--;
+    if (position == g_timerCount)
+    {
+        return;
+    }
+
+    // Move the last timer into the hole, then restore the heap order around it.
+    size_t moved = g_timerHeap[g_timerCount];
+    placeTimer(position, moved);
+    siftDown(position);
+    siftUp(g_timerSlots[moved].heapIndex - 1);
+}
+
+/* Must be called with g_timerMutex held. */
+static bool findTimer(int id, size_t *slot)
+{
+    if (id < 0)
+    {
+        return false;
+    }
 
-    if (TIMEOUTS == idx) // reach to end of timer list
+    *slot = (size_t)id & (TIMER_MAX_SLOTS - 1);
+    return (*slot < g_timerUsedSlots)
+           && (0 != g_timerSlots[*slot].heapIndex)
+           && (g_timerSlots[*slot].generation == (id >> TIMER_SLOT_BITS));
+}
+
+/*
+ * Remove the earliest timer if it has expired. Must be called with g_timerMutex held.
+ */
+static bool popExpiredTimer(uint64_t now, TimerCallback *cb, void **ctx)
+{
+    if ((0 == g_timerCount) || (g_timerSlots[g_timerHeap[0]].deadline > now))
+    {
+        return false;
+    }
+
+    size_t slot = g_timerHeap[0];
+    *cb = g_timerSlots[slot].cb;
+    *ctx = g_timerSlots[slot].ctx;
+    removeTimer(slot);
+    return true;
+}
+
+time_t OC_CALL registerTimer(const time_t seconds, int *id, TimerCallback cb, void *ctx)
+{
+    if (seconds <= 0)
+    {
         return -1;
+    }
 
-    // idx th timeout will be used.
-    // Reset and set state of the timer
-    timeout_list[idx].timeout_state = 0;
-    timeout_list[idx].timeout_state |= TIMEOUT_USED;
+    time_t then;
+    time(&then);
+    if (!registerTimerMs((uint64_t)seconds * MS_PER_SEC, id, cb, ctx))
+    {
+        return -1;
+    }
 
-    // calculate when the timeout should fire
-    then = now;
     timespec_add(&then, seconds);
+    return then;
+}
 
-    timeout_list[idx].timeout_time = then;
-    timeout_list[idx].timeout_seconds = seconds;
-    timeout_list[idx].ctx = ctx;
+bool OC_CALL registerTimerMs(uint64_t milliseconds, int *id, TimerCallback cb, void *ctx)
+{
+    if (!id)
+    {
+        return false;
+    }
 
-    // printf( "\nbefore timeout_list[idx].cb = %X\n", timeout_list[idx].cb);
-    timeout_list[idx].cb = cb;
-    // printf( " after timeout_list[idx].cb = %X\n", timeout_list[idx].cb);
+    if (!lockTimers())
+    {
+        return false;
+    }
 
-    // How long till the next timeout?
-    next = seconds;
-    for (i = 0; i < TIMEOUTS; i++)
+    size_t slot = 0;
+    if (!allocateTimer(&slot))
     {
-        if ((timeout_list[i].timeout_state & (TIMEOUT_USED | TIMEOUT_UNUSED)) == TIMEOUT_USED)
-        {
-            const time_t secs = timespec_diff(timeout_list[i].timeout_time, now);
+        oc_mutex_unlock(g_timerMutex);
+        return false;
+    }
 
-            if (secs >= 0 && secs < next)
-                next = secs;
-        }
+    g_timerSlots[slot].deadline = OICGetCurrentTime(TIME_IN_MS) + milliseconds;
+    g_timerSlots[slot].cb = cb;
+    g_timerSlots[slot].ctx = ctx;
+    size_t position = g_timerCount++;
+    placeTimer(position, slot);
+    siftUp(position);
+
+    *id = (int)(((size_t)g_timerSlots[slot].generation << TIMER_SLOT_BITS) | slot);
+
+    // Wake up the timer thread if it waits for a later deadline.
+    if (g_timerHeap[0] == slot)
+    {
+        oc_cond_signal(g_timerCond);
     }
+    bool started = (NULL != g_timerThread);
+    oc_mutex_unlock(g_timerMutex);
 
-    *id = idx;
-    /* Return the timeout number. */
-    return timeout_list[idx].timeout_time;
+    if (!started && (0 != initThread()))
+    {
+        unregisterTimer(*id);
+        return false;
+    }
+    return true;
 }
 
-void OC_CALL unregisterTimer(int idx)
+bool OC_CALL rescheduleTimer(int id, uint64_t milliseconds)
 {
-    if (0 <= idx && idx < TIMEOUTS)
-        timeout_list[idx].timeout_state = TIMEOUT_UNUSED;
+    if (!lockTimers())
+    {
+        return false;
+    }
+
+    size_t slot = 0;
+    bool found = findTimer(id, &slot);
+    if (found)
+    {
+        uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + milliseconds;
+        size_t position = g_timerSlots[slot].heapIndex - 1;
+        bool earlier = (deadline < g_timerSlots[slot].deadline);
+        g_timerSlots[slot].deadline = deadline;
+        if (earlier)
+        {
+            siftUp(position);
+        }
+        else
+        {
+            siftDown(position);
+        }
+        oc_cond_signal(g_timerCond);
+    }
+    oc_mutex_unlock(g_timerMutex);
+    return found;
 }
 
-void checkTimeout()
+void OC_CALL unregisterTimer(int id)
 {
-    time_t now;
-    int i;
+    if (!lockTimers())
+    {
+        return;
+    }
 
-    time(&now);
+    size_t slot = 0;
+    if (findTimer(id, &slot))
+    {
+        removeTimer(slot);
+    }
+    oc_mutex_unlock(g_timerMutex);
+}
 
-    /* Check all timeouts that are used and armed, but not passed yet. */
-    for (i = 0; i < TIMEOUTS; i++)
+void checkTimeout()
+{
+    if (!lockTimers())
     {
-        if ((timeout_list[i].timeout_state & (TIMEOUT_USED | TIMEOUT_UNUSED)) == TIMEOUT_USED)
-        {
-            const time_t seconds = timespec_diff(timeout_list[i].timeout_time, now);
+        return;
+    }
 
-            if (seconds <= 0)
-            {
-                /* timeout [i] fires! */
-                timeout_list[i].timeout_state = TIMEOUT_UNUSED;
-                if (timeout_list[i].cb)
-                {
-                    timeout_list[i].cb(timeout_list[i].ctx);
-                }
-            }
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    TimerCallback cb = NULL;
+    void *ctx = NULL;
+    while (popExpiredTimer(now, &cb, &ctx))
+    {
+        // The callback may register or unregister timers.
+        oc_mutex_unlock(g_timerMutex);
+        if (cb)
+        {
+            cb(ctx);
         }
+        oc_mutex_lock(g_timerMutex);
     }
+    oc_mutex_unlock(g_timerMutex);
 }
 
 void *loop(void *threadid)
 {
-    (void)threadid;
-    for (;;)
+    uintptr_t generation = (uintptr_t)threadid;
+#ifdef TIMER_THREAD_LOCAL
+    t_onTimerThread = true;
+#endif
+
+    oc_mutex_lock(g_timerMutex);
+    while (generation == g_timerThreadGeneration)
     {
-        sleep(SECOND);
+        if (0 == g_timerCount)
+        {
+            oc_cond_wait(g_timerCond, g_timerMutex);
+            continue;
+        }
+
+        uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+        uint64_t deadline = g_timerSlots[g_timerHeap[0]].deadline;
+        if (deadline > now)
+        {
+            oc_cond_wait_for(g_timerCond, g_timerMutex, (deadline - now) * US_PER_MS);
+            continue;
+        }
+
+        oc_mutex_unlock(g_timerMutex);
         checkTimeout();
+        oc_mutex_lock(g_timerMutex);
     }
+    oc_mutex_unlock(g_timerMutex);
+    return NULL;
 }
 
 int initThread()
 {
-    int res = pthread_create(&thread_id, NULL, loop, NULL);
-
-    if (res)
+    if (!lockTimers())
     {
-        printf("ERROR; return code from pthread_create() is %d\n", res);
         return -1;
     }
 
-    return 0;
+    int res = 0;
+    if (!g_timerThread)
+    {
+        if (OC_THREAD_SUCCESS != oc_thread_new(&g_timerThread, loop,
+                                               (void *)g_timerThreadGeneration))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create the timer thread");
+            g_timerThread = NULL;
+            res = -1;
+        }
+    }
+    oc_mutex_unlock(g_timerMutex);
+    return res;
+}
+
+void OC_CALL terminateTimerThread(void)
+{
+    if (!lockTimers())
+    {
+        return;
+    }
+
+    oc_thread thread = g_timerThread;
+    g_timerThread = NULL;
+    g_timerThreadGeneration++;
+    oc_cond_signal(g_timerCond);
+    oc_mutex_unlock(g_timerMutex);
+
+    if (thread)
+    {
+#ifdef TIMER_THREAD_LOCAL
+        // From a callback, the thread ends once the callback returns.
+        if (t_onTimerThread)
+        {
+            oc_thread_detach(thread);
+        }
+        else
+#endif
+        {
+            oc_thread_wait(thread);
+        }
+        oc_thread_free(thread);
+    }
+
+    oc_mutex_lock(g_timerMutex);
+    OICFree(g_timerSlots);
+    OICFree(g_timerHeap);
+    g_timerSlots = NULL;
+    g_timerHeap = NULL;
+    g_timerCapacity = 0;
+    g_timerFreeSlot = 0;
+    g_timerUsedSlots = 0;
+    g_timerCount = 0;
+    oc_mutex_unlock(g_timerMutex);
 }
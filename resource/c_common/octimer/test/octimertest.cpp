@@ -0,0 +1,263 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file implement tests for the timer service.
+ */
+
+#include "octimer.h"
+#include "oic_time.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const uint64_t WAIT_LIMIT_MS = 10000;
+
+class TimerTester : public testing::Test
+{
+  protected:
+    virtual void TearDown()
+    {
+        terminateTimerThread();
+    }
+
+    static void Fired(void *ctx)
+    {
+        static_cast<std::atomic<int> *>(ctx)->fetch_add(1);
+    }
+
+    static bool WaitFor(const std::atomic<int> &counter, int value)
+    {
+        uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + WAIT_LIMIT_MS;
+        while ((counter.load() < value) && (OICGetCurrentTime(TIME_IN_MS) < deadline))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return counter.load() >= value;
+    }
+};
+
+TEST_F(TimerTester, FiresAfterDelay)
+{
+    std::atomic<int> fired(0);
+    int id = -1;
+    uint64_t start = OICGetCurrentTime(TIME_IN_MS);
+    ASSERT_TRUE(registerTimerMs(50, &id, Fired, &fired));
+    ASSERT_TRUE(WaitFor(fired, 1));
+    EXPECT_LE(start + 50, OICGetCurrentTime(TIME_IN_MS));
+    EXPECT_EQ(1, fired.load());
+}
+
+TEST_F(TimerTester, RegisterInSeconds)
+{
+    std::atomic<int> fired(0);
+    int id = -1;
+    time_t now = time(NULL);
+    EXPECT_EQ(-1, registerTimer(0, &id, Fired, &fired));
+    time_t then = registerTimer(1, &id, Fired, &fired);
+    EXPECT_LE(now + 1, then);
+    ASSERT_TRUE(WaitFor(fired, 1));
+    EXPECT_LE(then, time(NULL));
+}
+
+static std::mutex g_orderMutex;
+static std::vector<int> g_order;
+
+static void Record(void *ctx)
+{
+    std::lock_guard<std::mutex> lock(g_orderMutex);
+    g_order.push_back((int)(intptr_t)ctx);
+}
+
+TEST_F(TimerTester, EarliestFiresFirst)
+{
+    g_order.clear();
+    int id = -1;
+    ASSERT_TRUE(registerTimerMs(300, &id, Record, (void *)3));
+    ASSERT_TRUE(registerTimerMs(100, &id, Record, (void *)1));
+    ASSERT_TRUE(registerTimerMs(200, &id, Record, (void *)2));
+
+    uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + WAIT_LIMIT_MS;
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_orderMutex);
+            if ((3 == g_order.size()) || (OICGetCurrentTime(TIME_IN_MS) >= deadline))
+            {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::lock_guard<std::mutex> lock(g_orderMutex);
+    ASSERT_EQ(3u, g_order.size());
+    EXPECT_EQ(1, g_order[0]);
+    EXPECT_EQ(2, g_order[1]);
+    EXPECT_EQ(3, g_order[2]);
+}
+
+TEST_F(TimerTester, UnregisterCancels)
+{
+    std::atomic<int> cancelled(0);
+    std::atomic<int> fired(0);
+    int cancelledId = -1;
+    int id = -1;
+    ASSERT_TRUE(registerTimerMs(50, &cancelledId, Fired, &cancelled));
+    ASSERT_TRUE(registerTimerMs(100, &id, Fired, &fired));
+    unregisterTimer(cancelledId);
+
+    ASSERT_TRUE(WaitFor(fired, 1));
+    EXPECT_EQ(0, cancelled.load());
+}
+
+TEST_F(TimerTester, StaleHandleIsIgnored)
+{
+    std::atomic<int> fired(0);
+    int expiredId = -1;
+    ASSERT_TRUE(registerTimerMs(0, &expiredId, Fired, &fired));
+    ASSERT_TRUE(WaitFor(fired, 1));
+
+    // The new timer may reuse the slot of the expired one.
+    int id = -1;
+    ASSERT_TRUE(registerTimerMs(50, &id, Fired, &fired));
+    EXPECT_NE(expiredId, id);
+    unregisterTimer(expiredId);
+    EXPECT_FALSE(rescheduleTimer(expiredId, 0));
+
+    ASSERT_TRUE(WaitFor(fired, 2));
+}
+
+TEST_F(TimerTester, Reschedule)
+{
+    std::atomic<int> fired(0);
+    int id = -1;
+    uint64_t start = OICGetCurrentTime(TIME_IN_MS);
+    ASSERT_TRUE(registerTimerMs(WAIT_LIMIT_MS * 10, &id, Fired, &fired));
+    ASSERT_TRUE(rescheduleTimer(id, 10));
+    ASSERT_TRUE(WaitFor(fired, 1));
+    EXPECT_GT(start + WAIT_LIMIT_MS, OICGetCurrentTime(TIME_IN_MS));
+    EXPECT_FALSE(rescheduleTimer(id, 10));
+}
+
+static std::atomic<int> g_rearmed(0);
+
+static void Rearm(void *ctx)
+{
+    (void)ctx;
+    if (g_rearmed.fetch_add(1) < 4)
+    {
+        int id = -1;
+        EXPECT_TRUE(registerTimerMs(1, &id, Rearm, NULL));
+    }
+}
+
+TEST_F(TimerTester, CallbackRegistersTimer)
+{
+    g_rearmed = 0;
+    int id = -1;
+    ASSERT_TRUE(registerTimerMs(1, &id, Rearm, NULL));
+    ASSERT_TRUE(WaitFor(g_rearmed, 5));
+}
+
+static std::atomic<int> g_terminated(0);
+
+static void Terminate(void *ctx)
+{
+    (void)ctx;
+    terminateTimerThread();
+    g_terminated.fetch_add(1);
+}
+
+TEST_F(TimerTester, CallbackTerminatesTimerThread)
+{
+    g_terminated = 0;
+    std::atomic<int> fired(0);
+    int id = -1;
+    ASSERT_TRUE(registerTimerMs(1, &id, Terminate, NULL));
+    ASSERT_TRUE(registerTimerMs(200, &id, Fired, &fired));
+    ASSERT_TRUE(WaitFor(g_terminated, 1));
+
+    // The pending timer was canceled, and a new timer starts a new thread.
+    ASSERT_TRUE(registerTimerMs(1, &id, Fired, &fired));
+    ASSERT_TRUE(WaitFor(fired, 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    EXPECT_EQ(1, fired.load());
+}
+
+TEST_F(TimerTester, StressManyTimers)
+{
+    // Enough timers for a deep heap, few enough for the memcheck run.
+    const int count = 5000;
+    std::vector<std::atomic<int>> fired(count);
+    std::atomic<int> total(0);
+    std::vector<int> ids(count);
+
+    struct Context
+    {
+        std::atomic<int> *fired;
+        std::atomic<int> *total;
+    };
+    std::vector<Context> contexts(count);
+
+    auto callback = [](void *ctx)
+    {
+        Context *context = static_cast<Context *>(ctx);
+        context->fired->fetch_add(1);
+        context->total->fetch_add(1);
+    };
+
+    for (int i = 0; i < count; i++)
+    {
+        fired[i] = 0;
+        contexts[i].fired = &fired[i];
+        contexts[i].total = &total;
+        ASSERT_TRUE(registerTimerMs(WAIT_LIMIT_MS * 10, &ids[i], callback, &contexts[i]));
+    }
+
+    // Cancel a quarter of the timers, and bring the others forward in a shuffled order.
+    int expected = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (0 == i % 4)
+        {
+            unregisterTimer(ids[i]);
+        }
+        else
+        {
+            ASSERT_TRUE(rescheduleTimer(ids[i], (i * 7919) % 400));
+            expected++;
+        }
+    }
+
+    ASSERT_TRUE(WaitFor(total, expected));
+
+    // Let any wrongly pending timer expire before checking.
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    EXPECT_EQ(expected, total.load());
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_EQ((0 == i % 4) ? 0 : 1, fired[i].load()) << "timer " << i;
+    }
+}
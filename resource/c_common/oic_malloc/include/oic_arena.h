@@ -0,0 +1,243 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * Bump allocation arenas. The memory allocated from an arena is not freed one
+ * object at a time, but all at once when the arena is reset.
+ *
+ * Each thread also has a request arena, which serves the transient allocations
+ * made while the stack handles one request. The stack opens a request scope with
+ * OICRequestArenaBegin() before handling a request and closes it with
+ * OICRequestArenaEnd() afterwards, which resets the arena. OICRequestAlloc() and
+ * friends allocate from the request arena inside a scope and from the heap
+ * outside of it, and OICRequestFree() frees both kinds of memory, so the code
+ * using them does not need to know where it runs. Memory from the request arena
+ * must not be used after the end of the scope it was allocated in.
+ *
+ * Note that these functions are intended to be used ONLY within the TB
+ * stack and NOT by the application code.
+ */
+
+#ifndef OIC_ARENA_H_
+#define OIC_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * An arena.
+ */
+typedef struct OICArena OICArena;
+
+/**
+ * Counters of the request arena of a thread.
+ */
+typedef struct
+{
+    /** Number of request scopes closed. */
+    uint32_t requests;
+
+    /** Number of allocations served by the request arena. */
+    uint32_t arenaAllocations;
+
+    /** Number of allocations served by the heap, outside of a scope or with the arena disabled. */
+    uint32_t heapAllocations;
+
+    /** Number of heap allocations made by the request arena for its memory. */
+    uint32_t chunkAllocations;
+} OICRequestArenaStats;
+
+/**
+ * Create an arena.
+ *
+ * @param chunkSize     size of the blocks of memory the arena takes from the heap.
+ *                      Larger allocations get a block of their own.
+ *
+ * @return
+ *     on success, the arena
+ *     on failure, a null pointer is returned
+ */
+OICArena *OICArenaCreate(size_t chunkSize);
+
+/**
+ * Destroy an arena and all the memory allocated from it.
+ *
+ * @param arena - Arena to destroy, may be NULL.
+ */
+void OICArenaDestroy(OICArena *arena);
+
+/**
+ * Allocate memory from an arena. The memory is aligned for any type.
+ *
+ * @param arena - Arena to allocate from.
+ * @param size  - Size of the memory, where size > 0.
+ *
+ * @return
+ *     on success, a pointer to the memory
+ *     on failure, a null pointer is returned
+ */
+void *OICArenaAlloc(OICArena *arena, size_t size);
+
+/**
+ * Allocate memory for an array from an arena and set it to zero.
+ *
+ * @param arena - Arena to allocate from.
+ * @param num   - Number of elements, where num > 0.
+ * @param size  - Size of the elements, where size > 0.
+ *
+ * @return
+ *     on success, a pointer to the memory
+ *     on failure, a null pointer is returned
+ */
+void *OICArenaCalloc(OICArena *arena, size_t num, size_t size);
+
+/**
+ * Duplicate a string into an arena.
+ *
+ * @param arena - Arena to allocate from.
+ * @param str   - String to duplicate.
+ *
+ * @return
+ *     on success, the copy of the string
+ *     on failure, a null pointer is returned
+ */
+char *OICArenaStrdup(OICArena *arena, const char *str);
+
+/**
+ * Check whether memory was allocated from an arena.
+ *
+ * @param arena - Arena, may be NULL.
+ * @param ptr   - Memory, may be NULL.
+ *
+ * @return true if ptr points into the memory of the arena.
+ */
+bool OICArenaOwns(const OICArena *arena, const void *ptr);
+
+/**
+ * Free all the memory allocated from an arena. The arena keeps one block for
+ * the next allocations.
+ *
+ * @param arena - Arena to reset.
+ */
+void OICArenaReset(OICArena *arena);
+
+/**
+ * Get the number of heap allocations made by an arena since its creation.
+ *
+ * @param arena - Arena.
+ *
+ * @return number of blocks allocated by the arena.
+ */
+uint32_t OICArenaGetChunkAllocations(const OICArena *arena);
+
+/**
+ * Open a request scope on the calling thread, creating the request arena of the
+ * thread on first use. Scopes may nest, the arena is reset by the outermost one.
+ */
+void OICRequestArenaBegin(void);
+
+/**
+ * Close the request scope opened by OICRequestArenaBegin(). Closing the outermost
+ * scope frees all the memory allocated from the request arena of the thread.
+ */
+void OICRequestArenaEnd(void);
+
+/**
+ * Destroy the request arena of the calling thread. Must not be called inside a
+ * request scope.
+ */
+void OICRequestArenaRelease(void);
+
+/**
+ * Enable or disable the request arenas of all threads. While they are disabled,
+ * the request allocations are served by the heap. They are enabled by default.
+ *
+ * @param enabled   true to enable the request arenas.
+ */
+void OICRequestArenaSetEnabled(bool enabled);
+
+/**
+ * Get the counters of the request arena of the calling thread.
+ *
+ * @param stats     receives the counters.
+ */
+void OICRequestArenaGetStats(OICRequestArenaStats *stats);
+
+/**
+ * Clear the counters of the request arena of the calling thread.
+ */
+void OICRequestArenaResetStats(void);
+
+/**
+ * Allocate memory from the request arena inside a request scope, or from the heap.
+ *
+ * @param size  - Size of the memory, where size > 0.
+ *
+ * @return
+ *     on success, a pointer to the memory, to free with OICRequestFree()
+ *     on failure, a null pointer is returned
+ */
+void *OICRequestAlloc(size_t size);
+
+/**
+ * Allocate memory for an array from the request arena inside a request scope, or
+ * from the heap, and set it to zero.
+ *
+ * @param num   - Number of elements, where num > 0.
+ * @param size  - Size of the elements, where size > 0.
+ *
+ * @return
+ *     on success, a pointer to the memory, to free with OICRequestFree()
+ *     on failure, a null pointer is returned
+ */
+void *OICRequestCalloc(size_t num, size_t size);
+
+/**
+ * Duplicate a string into the request arena inside a request scope, or into the heap.
+ *
+ * @param str   - String to duplicate.
+ *
+ * @return
+ *     on success, the copy of the string, to free with OICRequestFree()
+ *     on failure or if str is NULL, a null pointer is returned
+ */
+char *OICRequestStrdup(const char *str);
+
+/**
+ * Free memory allocated by OICRequestAlloc() and friends, or by OICMalloc() and
+ * friends. Memory of the request arena is only reclaimed at the end of the scope.
+ *
+ * @param ptr - Memory to free. If NULL, no action occurs.
+ */
+void OICRequestFree(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OIC_ARENA_H_
@@ -0,0 +1,183 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * Pools of fixed size objects. A pool carves its objects out of slabs which are
+ * kept for reuse instead of being returned to the heap, so that the small objects
+ * allocated and freed for each message do not fragment the heap of a long running
+ * process. Each thread keeps a small cache of free objects per pool, so most
+ * allocations do not take the lock of the pool.
+ *
+ * Note that these functions are intended to be used ONLY within the TB
+ * stack and NOT by the application code.
+ */
+
+#ifndef OIC_POOL_H_
+#define OIC_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * Maximum length of the name of a pool, including the terminating NUL.
+ */
+#define OIC_POOL_NAME_LENGTH 32
+
+/**
+ * Maximum number of pools which exist at the same time.
+ */
+#define OIC_POOL_MAX_POOLS 32
+
+/**
+ * A pool of objects of the same size.
+ */
+typedef struct OICPool OICPool;
+
+/**
+ * Counters of a pool.
+ */
+typedef struct
+{
+    /** Name of the pool. */
+    char name[OIC_POOL_NAME_LENGTH];
+
+    /** Size of the objects. */
+    size_t objectSize;
+
+    /** Number of objects currently allocated. */
+    size_t liveObjects;
+
+    /** Highest number of objects allocated at the same time. */
+    size_t peakObjects;
+
+    /** Maximum number of objects allocated at the same time, 0 if unlimited. */
+    size_t limit;
+
+    /** Number of objects the slabs of the pool can hold. */
+    size_t capacity;
+
+    /** Number of allocations, wraps around. */
+    uint32_t allocations;
+
+    /** Number of allocations which failed, because of the limit or out of memory. */
+    uint32_t failures;
+
+    /** Allocations per second since the previous query of the counters. */
+    uint32_t allocationRate;
+} OICPoolStats;
+
+/**
+ * Create a pool.
+ *
+ * @param name          name of the pool, reported in its counters.
+ * @param objectSize    size of the objects, where objectSize > 0.
+ *
+ * @return
+ *     on success, the pool
+ *     on failure, a null pointer is returned
+ */
+OICPool *OICPoolCreate(const char *name, size_t objectSize);
+
+/**
+ * Get a pool shared by a module, creating it on first use. Pools obtained this
+ * way are never destroyed.
+ *
+ * @param pool          variable holding the pool of the module, initially NULL.
+ * @param name          name of the pool.
+ * @param objectSize    size of the objects.
+ *
+ * @return
+ *     on success, the pool
+ *     on failure, a null pointer is returned
+ */
+OICPool *OICPoolGet(OICPool **pool, const char *name, size_t objectSize);
+
+/**
+ * Destroy a pool. The memory of the pool is released once the objects which are
+ * still allocated from it have been freed.
+ *
+ * @param pool - Pool to destroy, may be NULL.
+ */
+void OICPoolDestroy(OICPool *pool);
+
+/**
+ * Allocate an object from a pool.
+ *
+ * @param pool - Pool to allocate from.
+ *
+ * @return
+ *     on success, a pointer to the object
+ *     on failure (NULL pool, limit reached or out of memory), a null pointer is returned
+ */
+void *OICPoolAlloc(OICPool *pool);
+
+/**
+ * Allocate an object from a pool and set it to zero.
+ *
+ * @param pool - Pool to allocate from.
+ *
+ * @return
+ *     on success, a pointer to the object
+ *     on failure, a null pointer is returned
+ */
+void *OICPoolCalloc(OICPool *pool);
+
+/**
+ * Free an object allocated by OICPoolAlloc() or OICPoolCalloc(). The object
+ * returns to the pool it was allocated from.
+ *
+ * @param ptr - Object to free. If NULL, no action occurs.
+ */
+void OICPoolFree(void *ptr);
+
+/**
+ * Limit the number of objects allocated at the same time from the pools of the
+ * given name. The limit also applies to the pools created later with this name.
+ *
+ * @param name  name of the pools.
+ * @param limit maximum number of objects, 0 for no limit.
+ *
+ * @return true on success, false if too many limits are set.
+ */
+bool OICPoolSetLimit(const char *name, size_t limit);
+
+/**
+ * Get the counters of the pools.
+ *
+ * @param stats     array receiving the counters, may be NULL if maxCount is 0.
+ * @param maxCount  number of entries of stats.
+ *
+ * @return number of pools, which may be larger than maxCount.
+ */
+size_t OICPoolGetStats(OICPoolStats *stats, size_t maxCount);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OIC_POOL_H_
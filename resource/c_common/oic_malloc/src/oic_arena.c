@@ -0,0 +1,385 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "iotivity_config.h"
+
+#include <string.h>
+
+#include "oic_arena.h"
+#include "oic_malloc.h"
+#include "experimental/logger.h"
+
+#define TAG "OIC_ARENA"
+
+/* Alignment of the allocations, and size of the header of a chunk. */
+#define ARENA_ALIGNMENT 16
+
+/* Size of the chunks of the request arenas, which hold the strings and buffers of a request. */
+#define REQUEST_ARENA_CHUNK_SIZE 4096
+
+#if defined(_MSC_VER)
+#define ARENA_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define ARENA_THREAD_LOCAL __thread
+#endif
+
+/*
+ * A chunk of memory of an arena. The allocations follow the header, which keeps
+ * them aligned for any type.
+ */
+typedef struct ArenaChunk
+{
+    struct ArenaChunk *next;
+    size_t size;                    /**< size of the memory after the header. */
+} ArenaChunk;
+
+struct OICArena
+{
+    ArenaChunk *chunks;             /**< chunks, the current one first and the oldest one last. */
+    ArenaChunk *largeChunks;        /**< chunks of the allocations larger than half a chunk. */
+    size_t chunkSize;
+    size_t used;                    /**< bytes allocated from the current chunk. */
+    uint32_t chunkAllocations;
+};
+
+static uint8_t *ChunkData(const ArenaChunk *chunk)
+{
+    return (uint8_t *)chunk + ARENA_ALIGNMENT;
+}
+
+static size_t AlignSize(size_t size)
+{
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static ArenaChunk *NewChunk(OICArena *arena, size_t size)
+{
+    ArenaChunk *chunk = (ArenaChunk *)OICMalloc(ARENA_ALIGNMENT + size);
+    if (chunk)
+    {
+        chunk->size = size;
+        arena->chunkAllocations++;
+    }
+    return chunk;
+}
+
+static void FreeChunks(ArenaChunk *chunks)
+{
+    while (chunks)
+    {
+        ArenaChunk *chunk = chunks;
+        chunks = chunk->next;
+        OICFree(chunk);
+    }
+}
+
+static bool ChunksOwn(const ArenaChunk *chunks, const uint8_t *ptr)
+{
+    for (const ArenaChunk *chunk = chunks; chunk; chunk = chunk->next)
+    {
+        const uint8_t *data = ChunkData(chunk);
+        if ((ptr >= data) && (ptr < data + chunk->size))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+OICArena *OICArenaCreate(size_t chunkSize)
+{
+    if (0 == chunkSize)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid chunk size");
+        return NULL;
+    }
+
+    OICArena *arena = (OICArena *)OICCalloc(1, sizeof(OICArena));
+    if (!arena)
+    {
+        return NULL;
+    }
+    arena->chunkSize = AlignSize(chunkSize);
+    arena->chunks = NewChunk(arena, arena->chunkSize);
+    if (!arena->chunks)
+    {
+        OICFree(arena);
+        return NULL;
+    }
+    arena->chunks->next = NULL;
+    return arena;
+}
+
+void OICArenaDestroy(OICArena *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+    FreeChunks(arena->largeChunks);
+    FreeChunks(arena->chunks);
+    OICFree(arena);
+}
+
+void *OICArenaAlloc(OICArena *arena, size_t size)
+{
+    if (!arena || (0 == size) || (size > SIZE_MAX - ARENA_ALIGNMENT * 2))
+    {
+        return NULL;
+    }
+
+    size = AlignSize(size);
+    ArenaChunk *current = arena->chunks;
+    if (size <= current->size - arena->used)
+    {
+        void *ptr = ChunkData(current) + arena->used;
+        arena->used += size;
+        return ptr;
+    }
+
+    if (size > arena->chunkSize / 2)
+    {
+        // A large allocation gets a chunk of its own, so that the room left in the
+        // current chunk is not lost.
+        ArenaChunk *chunk = NewChunk(arena, size);
+        if (!chunk)
+        {
+            return NULL;
+        }
+        chunk->next = arena->largeChunks;
+        arena->largeChunks = chunk;
+        return ChunkData(chunk);
+    }
+
+    ArenaChunk *chunk = NewChunk(arena, arena->chunkSize);
+    if (!chunk)
+    {
+        return NULL;
+    }
+    chunk->next = current;
+    arena->chunks = chunk;
+    arena->used = size;
+    return ChunkData(chunk);
+}
+
+void *OICArenaCalloc(OICArena *arena, size_t num, size_t size)
+{
+    if ((0 == num) || (0 == size) || (num > SIZE_MAX / size))
+    {
+        return NULL;
+    }
+    void *ptr = OICArenaAlloc(arena, num * size);
+    if (ptr)
+    {
+        memset(ptr, 0, num * size);
+    }
+    return ptr;
+}
+
+char *OICArenaStrdup(OICArena *arena, const char *str)
+{
+    if (!str)
+    {
+        return NULL;
+    }
+    size_t length = strlen(str);
+    char *dup = (char *)OICArenaAlloc(arena, length + 1);
+    if (dup)
+    {
+        memcpy(dup, str, length + 1);
+    }
+    return dup;
+}
+
+bool OICArenaOwns(const OICArena *arena, const void *ptr)
+{
+    if (!arena || !ptr)
+    {
+        return false;
+    }
+    return ChunksOwn(arena->chunks, (const uint8_t *)ptr)
+           || ChunksOwn(arena->largeChunks, (const uint8_t *)ptr);
+}
+
+void OICArenaReset(OICArena *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+    FreeChunks(arena->largeChunks);
+    arena->largeChunks = NULL;
+    // The oldest chunk is kept for the next allocations.
+    while (arena->chunks->next)
+    {
+        ArenaChunk *chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        OICFree(chunk);
+    }
+    arena->used = 0;
+}
+
+uint32_t OICArenaGetChunkAllocations(const OICArena *arena)
+{
+    return arena ? arena->chunkAllocations : 0;
+}
+
+static volatile bool g_requestArenaEnabled = true;
+
+#ifdef ARENA_THREAD_LOCAL
+static ARENA_THREAD_LOCAL OICArena *t_requestArena = NULL;
+static ARENA_THREAD_LOCAL uint32_t t_requestDepth = 0;
+static ARENA_THREAD_LOCAL OICRequestArenaStats t_requestStats;
+static ARENA_THREAD_LOCAL uint32_t t_chunkMark = 0;    /**< chunks of the arena when the scope began. */
+
+/**
+ * Get the request arena of the calling thread, or NULL if the calling thread is
+ * not inside a request scope.
+ */
+static OICArena *GetRequestArena(void)
+{
+    return (t_requestDepth && g_requestArenaEnabled) ? t_requestArena : NULL;
+}
+#endif
+
+void OICRequestArenaBegin(void)
+{
+#ifdef ARENA_THREAD_LOCAL
+    if (0 == t_requestDepth++)
+    {
+        t_chunkMark = OICArenaGetChunkAllocations(t_requestArena);
+        if (!t_requestArena && g_requestArenaEnabled)
+        {
+            // Without an arena, the allocations of the scope are served by the heap.
+            t_requestArena = OICArenaCreate(REQUEST_ARENA_CHUNK_SIZE);
+        }
+    }
+#endif
+}
+
+void OICRequestArenaEnd(void)
+{
+#ifdef ARENA_THREAD_LOCAL
+    if (0 == t_requestDepth)
+    {
+        OIC_LOG(ERROR, TAG, "No request scope to end");
+        return;
+    }
+    if (0 == --t_requestDepth)
+    {
+        t_requestStats.requests++;
+        t_requestStats.chunkAllocations += OICArenaGetChunkAllocations(t_requestArena) - t_chunkMark;
+        OICArenaReset(t_requestArena);
+    }
+#endif
+}
+
+void OICRequestArenaRelease(void)
+{
+#ifdef ARENA_THREAD_LOCAL
+    if (t_requestDepth)
+    {
+        OIC_LOG(ERROR, TAG, "Request arena released inside a request scope");
+        return;
+    }
+    OICArenaDestroy(t_requestArena);
+    t_requestArena = NULL;
+#endif
+}
+
+void OICRequestArenaSetEnabled(bool enabled)
+{
+    g_requestArenaEnabled = enabled;
+}
+
+void OICRequestArenaGetStats(OICRequestArenaStats *stats)
+{
+    if (!stats)
+    {
+        return;
+    }
+#ifdef ARENA_THREAD_LOCAL
+    *stats = t_requestStats;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+void OICRequestArenaResetStats(void)
+{
+#ifdef ARENA_THREAD_LOCAL
+    memset(&t_requestStats, 0, sizeof(t_requestStats));
+#endif
+}
+
+void *OICRequestAlloc(size_t size)
+{
+#ifdef ARENA_THREAD_LOCAL
+    OICArena *arena = GetRequestArena();
+    if (arena)
+    {
+        t_requestStats.arenaAllocations++;
+        return OICArenaAlloc(arena, size);
+    }
+    t_requestStats.heapAllocations++;
+#endif
+    return OICMalloc(size);
+}
+
+void *OICRequestCalloc(size_t num, size_t size)
+{
+#ifdef ARENA_THREAD_LOCAL
+    OICArena *arena = GetRequestArena();
+    if (arena)
+    {
+        t_requestStats.arenaAllocations++;
+        return OICArenaCalloc(arena, num, size);
+    }
+    t_requestStats.heapAllocations++;
+#endif
+    return OICCalloc(num, size);
+}
+
+char *OICRequestStrdup(const char *str)
+{
+    if (!str)
+    {
+        return NULL;
+    }
+    size_t length = strlen(str);
+    char *dup = (char *)OICRequestAlloc(length + 1);
+    if (dup)
+    {
+        memcpy(dup, str, length + 1);
+    }
+    return dup;
+}
+
+void OICRequestFree(void *ptr)
+{
+#ifdef ARENA_THREAD_LOCAL
+    if (OICArenaOwns(t_requestArena, ptr))
+    {
+        // Reclaimed at the end of the scope.
+        return;
+    }
+#endif
+    OICFree(ptr);
+}
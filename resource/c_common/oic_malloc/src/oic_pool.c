@@ -0,0 +1,600 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "iotivity_config.h"
+
+#include <string.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "oic_pool.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_time.h"
+#include "ocatomic.h"
+#include "octhread.h"
+#include "experimental/logger.h"
+
+#define TAG "OIC_POOL"
+
+/*
+ * Each object is preceded by a header holding its pool, so that OICPoolFree() does
+ * not need the pool. The header keeps the objects aligned for any type.
+ */
+#define POOL_HEADER_SIZE 16
+#define POOL_ALIGNMENT 16
+
+/* A slab holds at least POOL_MIN_SLAB_OBJECTS objects, and more if they fit in POOL_SLAB_SIZE. */
+#define POOL_SLAB_SIZE 4096
+#define POOL_MIN_SLAB_OBJECTS 8
+
+/* Number of free objects each thread caches per pool, half of them move at once. */
+#define POOL_CACHE_SIZE 32
+
+#if defined(_MSC_VER)
+#define POOL_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define POOL_THREAD_LOCAL __thread
+#endif
+
+/* The caches of exiting threads are given back to their pools by a thread-specific key. */
+#if defined(POOL_THREAD_LOCAL) && defined(HAVE_PTHREAD_H)
+#define POOL_FLUSH_ON_EXIT
+#endif
+
+/* Lazy initialization state of g_registryMutex. */
+#define POOL_LOCK_NONE 0
+#define POOL_LOCK_CREATING 1
+#define POOL_LOCK_READY 2
+
+struct OICPool
+{
+    char name[OIC_POOL_NAME_LENGTH];
+    size_t objectSize;
+    size_t stride;                  /**< size of an object with its header. */
+    size_t slabObjects;             /**< number of objects per slab. */
+    size_t index;                   /**< slot in g_pools. */
+    uint32_t id;                    /**< unique id, tells the thread caches apart. */
+    oc_mutex mutex;                 /**< protects freeList, slabs and the stats time. */
+    void *freeList;                 /**< free objects, linked through their first word. */
+    void *slabs;                    /**< slabs, linked through their first word. */
+    size_t slabCount;
+    volatile int32_t refs;          /**< live objects, plus one until the pool is destroyed. */
+    volatile int32_t owned;         /**< 1 until the pool is destroyed. */
+    volatile int32_t peak;
+    volatile int32_t limit;
+    volatile int32_t allocations;
+    volatile int32_t failures;
+    uint64_t statsTime;             /**< time of the previous query of the counters. */
+    uint32_t statsAllocations;      /**< allocations at the previous query of the counters. */
+};
+
+typedef struct
+{
+    OICPool *pool;
+} PoolHeader;
+
+typedef struct
+{
+    char *name;
+    size_t limit;
+} PoolLimit;
+
+static volatile int32_t g_registryLockState = POOL_LOCK_NONE;
+static oc_mutex g_registryMutex = NULL;
+static OICPool *g_pools[OIC_POOL_MAX_POOLS];
+static PoolLimit g_limits[OIC_POOL_MAX_POOLS];
+static uint32_t g_nextPoolId = 1;
+
+#ifdef POOL_THREAD_LOCAL
+typedef struct
+{
+    uint32_t id;                    /**< id of the pool of the cached objects. */
+    size_t count;
+    void *objects[POOL_CACHE_SIZE];
+} PoolCache;
+
+static POOL_THREAD_LOCAL PoolCache t_caches[OIC_POOL_MAX_POOLS];
+#endif
+
+#ifdef POOL_FLUSH_ON_EXIT
+static pthread_once_t g_cacheKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_cacheKey;
+static POOL_THREAD_LOCAL bool t_cacheRegistered = false;
+#endif
+
+static bool LockRegistry(void)
+{
+    if (POOL_LOCK_READY != g_registryLockState)
+    {
+        if (oc_atomic_cmpxchg(&g_registryLockState, POOL_LOCK_NONE, POOL_LOCK_CREATING))
+        {
+            g_registryMutex = oc_mutex_new();
+            if (!g_registryMutex)
+            {
+                oc_atomic_cmpxchg(&g_registryLockState, POOL_LOCK_CREATING, POOL_LOCK_NONE);
+                return false;
+            }
+            oc_atomic_cmpxchg(&g_registryLockState, POOL_LOCK_CREATING, POOL_LOCK_READY);
+        }
+        while (POOL_LOCK_CREATING == oc_atomic_add(&g_registryLockState, 0))
+        {
+            // another thread is creating the lock.
+        }
+        if (POOL_LOCK_READY != g_registryLockState)
+        {
+            return false;
+        }
+    }
+    oc_mutex_lock(g_registryMutex);
+    return true;
+}
+
+static void UnlockRegistry(void)
+{
+    oc_mutex_unlock(g_registryMutex);
+}
+
+static void **NextLink(void *object)
+{
+    return (void **)object;
+}
+
+static PoolHeader *HeaderOf(void *ptr)
+{
+    return (PoolHeader *)((uint8_t *)ptr - POOL_HEADER_SIZE);
+}
+
+static size_t FindLimit(const char *name)
+{
+    for (size_t i = 0; i < OIC_POOL_MAX_POOLS; i++)
+    {
+        if (g_limits[i].name && (0 == strcmp(g_limits[i].name, name)))
+        {
+            return g_limits[i].limit;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Create a pool. The registry is locked.
+ */
+static OICPool *CreatePoolLocked(const char *name, size_t objectSize)
+{
+    size_t index = 0;
+    while ((index < OIC_POOL_MAX_POOLS) && g_pools[index])
+    {
+        index++;
+    }
+    if (OIC_POOL_MAX_POOLS == index)
+    {
+        OIC_LOG_V(ERROR, TAG, "Too many pools to create %s", name);
+        return NULL;
+    }
+
+    OICPool *pool = (OICPool *)OICCalloc(1, sizeof(OICPool));
+    if (!pool)
+    {
+        return NULL;
+    }
+    pool->mutex = oc_mutex_new();
+    if (!pool->mutex)
+    {
+        OICFree(pool);
+        return NULL;
+    }
+
+    OICStrcpy(pool->name, sizeof(pool->name), name);
+    pool->objectSize = objectSize;
+    size_t alignedSize = (objectSize + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+    pool->stride = POOL_HEADER_SIZE + alignedSize;
+    pool->slabObjects = POOL_SLAB_SIZE / pool->stride;
+    if (pool->slabObjects < POOL_MIN_SLAB_OBJECTS)
+    {
+        pool->slabObjects = POOL_MIN_SLAB_OBJECTS;
+    }
+    pool->index = index;
+    pool->id = g_nextPoolId++;
+    pool->refs = 1;
+    pool->owned = 1;
+    pool->limit = (int32_t)FindLimit(name);
+    pool->statsTime = OICGetCurrentTime(TIME_IN_MS);
+    g_pools[index] = pool;
+    return pool;
+}
+
+/**
+ * Release the memory of a pool once it is destroyed and all its objects are freed.
+ */
+static void ReleasePool(OICPool *pool)
+{
+    if (LockRegistry())
+    {
+        g_pools[pool->index] = NULL;
+        UnlockRegistry();
+    }
+
+    while (pool->slabs)
+    {
+        void *slab = pool->slabs;
+        pool->slabs = *NextLink(slab);
+        OICFree(slab);
+    }
+    oc_mutex_free(pool->mutex);
+    OICFree(pool);
+}
+
+/**
+ * Add a slab to a pool. The pool is locked.
+ */
+static bool GrowPoolLocked(OICPool *pool)
+{
+    // The first POOL_ALIGNMENT bytes of the slab link it to the other slabs.
+    uint8_t *slab = (uint8_t *)OICMalloc(POOL_ALIGNMENT + pool->slabObjects * pool->stride);
+    if (!slab)
+    {
+        return false;
+    }
+    *NextLink(slab) = pool->slabs;
+    pool->slabs = slab;
+    pool->slabCount++;
+
+    uint8_t *base = slab + POOL_ALIGNMENT;
+    for (size_t i = pool->slabObjects; i > 0; i--)
+    {
+        PoolHeader *header = (PoolHeader *)(base + (i - 1) * pool->stride);
+        header->pool = pool;
+        void *object = (uint8_t *)header + POOL_HEADER_SIZE;
+        *NextLink(object) = pool->freeList;
+        pool->freeList = object;
+    }
+    return true;
+}
+
+/**
+ * Take up to count free objects of a pool.
+ *
+ * @return number of objects taken.
+ */
+static size_t TakeObjects(OICPool *pool, void **objects, size_t count)
+{
+    size_t taken = 0;
+    oc_mutex_lock(pool->mutex);
+    while (taken < count)
+    {
+        if (!pool->freeList && !GrowPoolLocked(pool))
+        {
+            break;
+        }
+        objects[taken] = pool->freeList;
+        pool->freeList = *NextLink(pool->freeList);
+        taken++;
+    }
+    oc_mutex_unlock(pool->mutex);
+    return taken;
+}
+
+static void GiveObjects(OICPool *pool, void **objects, size_t count)
+{
+    oc_mutex_lock(pool->mutex);
+    for (size_t i = 0; i < count; i++)
+    {
+        *NextLink(objects[i]) = pool->freeList;
+        pool->freeList = objects[i];
+    }
+    oc_mutex_unlock(pool->mutex);
+}
+
+#ifdef POOL_FLUSH_ON_EXIT
+/**
+ * Give the objects cached by an exiting thread back to their pools.
+ */
+static void FlushThreadCaches(void *data)
+{
+    PoolCache *caches = (PoolCache *)data;
+    t_cacheRegistered = false;
+    if (!LockRegistry())
+    {
+        return;
+    }
+    for (size_t i = 0; i < OIC_POOL_MAX_POOLS; i++)
+    {
+        // Holding the registry keeps the pool from being released meanwhile.
+        OICPool *pool = g_pools[i];
+        if (pool && (caches[i].id == pool->id) && caches[i].count)
+        {
+            GiveObjects(pool, caches[i].objects, caches[i].count);
+        }
+        caches[i].count = 0;
+    }
+    UnlockRegistry();
+}
+
+static void CreateCacheKey(void)
+{
+    pthread_key_create(&g_cacheKey, FlushThreadCaches);
+}
+
+/**
+ * Have the caches of the calling thread flushed when it exits.
+ */
+static void RegisterThreadCaches(void)
+{
+    if (!t_cacheRegistered)
+    {
+        pthread_once(&g_cacheKeyOnce, CreateCacheKey);
+        t_cacheRegistered = (0 == pthread_setspecific(g_cacheKey, t_caches));
+    }
+}
+#endif
+
+#ifdef POOL_THREAD_LOCAL
+/**
+ * Get the cache of the calling thread for a pool. Objects cached for a pool which
+ * has been released are dropped, their memory is gone with the pool.
+ */
+static PoolCache *GetCache(OICPool *pool)
+{
+#ifdef POOL_FLUSH_ON_EXIT
+    RegisterThreadCaches();
+#endif
+    PoolCache *cache = &t_caches[pool->index];
+    if (cache->id != pool->id)
+    {
+        cache->id = pool->id;
+        cache->count = 0;
+    }
+    return cache;
+}
+#endif
+
+static void *GetObject(OICPool *pool)
+{
+#ifdef POOL_THREAD_LOCAL
+    PoolCache *cache = GetCache(pool);
+    if (0 == cache->count)
+    {
+        cache->count = TakeObjects(pool, cache->objects, POOL_CACHE_SIZE / 2);
+        if (0 == cache->count)
+        {
+            return NULL;
+        }
+    }
+    return cache->objects[--cache->count];
+#else
+    void *object = NULL;
+    return TakeObjects(pool, &object, 1) ? object : NULL;
+#endif
+}
+
+static void PutObject(OICPool *pool, void *object)
+{
+#ifdef POOL_THREAD_LOCAL
+    PoolCache *cache = GetCache(pool);
+    if (POOL_CACHE_SIZE == cache->count)
+    {
+        cache->count -= POOL_CACHE_SIZE / 2;
+        GiveObjects(pool, &cache->objects[cache->count], POOL_CACHE_SIZE / 2);
+    }
+    cache->objects[cache->count++] = object;
+#else
+    GiveObjects(pool, &object, 1);
+#endif
+}
+
+static void UpdatePeak(OICPool *pool, int32_t live)
+{
+    int32_t peak = pool->peak;
+    while ((live > peak) && !oc_atomic_cmpxchg(&pool->peak, peak, live))
+    {
+        peak = pool->peak;
+    }
+}
+
+OICPool *OICPoolCreate(const char *name, size_t objectSize)
+{
+    if (!name || (0 == objectSize))
+    {
+        return NULL;
+    }
+    if (!LockRegistry())
+    {
+        return NULL;
+    }
+    OICPool *pool = CreatePoolLocked(name, objectSize);
+    UnlockRegistry();
+    return pool;
+}
+
+OICPool *OICPoolGet(OICPool **pool, const char *name, size_t objectSize)
+{
+    if (!pool || !name || (0 == objectSize))
+    {
+        return NULL;
+    }
+    if (*pool)
+    {
+        return *pool;
+    }
+    if (!LockRegistry())
+    {
+        return NULL;
+    }
+    if (!*pool)
+    {
+        *pool = CreatePoolLocked(name, objectSize);
+    }
+    UnlockRegistry();
+    return *pool;
+}
+
+void OICPoolDestroy(OICPool *pool)
+{
+    if (!pool || !oc_atomic_cmpxchg(&pool->owned, 1, 0))
+    {
+        return;
+    }
+    if (0 != pool->refs - 1)
+    {
+        OIC_LOG_V(INFO, TAG, "Pool %s destroyed with %d live objects",
+                  pool->name, pool->refs - 1);
+    }
+    if (0 == oc_atomic_decrement(&pool->refs))
+    {
+        ReleasePool(pool);
+    }
+}
+
+void *OICPoolAlloc(OICPool *pool)
+{
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    int32_t live = oc_atomic_increment(&pool->refs) - pool->owned;
+    int32_t limit = pool->limit;
+    void *object = NULL;
+    if ((0 == limit) || (live <= limit))
+    {
+        object = GetObject(pool);
+    }
+    if (!object)
+    {
+        oc_atomic_decrement(&pool->refs);
+        oc_atomic_increment(&pool->failures);
+        return NULL;
+    }
+
+    UpdatePeak(pool, live);
+    oc_atomic_increment(&pool->allocations);
+    return object;
+}
+
+void *OICPoolCalloc(OICPool *pool)
+{
+    void *object = OICPoolAlloc(pool);
+    if (object)
+    {
+        memset(object, 0, pool->objectSize);
+    }
+    return object;
+}
+
+void OICPoolFree(void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    OICPool *pool = HeaderOf(ptr)->pool;
+    PutObject(pool, ptr);
+    if (0 == oc_atomic_decrement(&pool->refs))
+    {
+        ReleasePool(pool);
+    }
+}
+
+bool OICPoolSetLimit(const char *name, size_t limit)
+{
+    if (!name || (limit > INT32_MAX) || !LockRegistry())
+    {
+        return false;
+    }
+
+    bool result = false;
+    PoolLimit *slot = NULL;
+    for (size_t i = 0; i < OIC_POOL_MAX_POOLS; i++)
+    {
+        if (g_limits[i].name && (0 == strcmp(g_limits[i].name, name)))
+        {
+            slot = &g_limits[i];
+            break;
+        }
+        if (!slot && !g_limits[i].name)
+        {
+            slot = &g_limits[i];
+        }
+    }
+    if (slot && !slot->name)
+    {
+        slot->name = OICStrdup(name);
+    }
+    if (slot && slot->name)
+    {
+        slot->limit = limit;
+        for (size_t i = 0; i < OIC_POOL_MAX_POOLS; i++)
+        {
+            if (g_pools[i] && (0 == strcmp(g_pools[i]->name, name)))
+            {
+                g_pools[i]->limit = (int32_t)limit;
+            }
+        }
+        result = true;
+    }
+    UnlockRegistry();
+    return result;
+}
+
+size_t OICPoolGetStats(OICPoolStats *stats, size_t maxCount)
+{
+    if ((!stats && maxCount) || !LockRegistry())
+    {
+        return 0;
+    }
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    size_t count = 0;
+    for (size_t i = 0; i < OIC_POOL_MAX_POOLS; i++)
+    {
+        OICPool *pool = g_pools[i];
+        if (!pool)
+        {
+            continue;
+        }
+        if (count < maxCount)
+        {
+            OICPoolStats *entry = &stats[count];
+            OICStrcpy(entry->name, sizeof(entry->name), pool->name);
+            entry->objectSize = pool->objectSize;
+            entry->liveObjects = (size_t)(oc_atomic_add(&pool->refs, 0) - pool->owned);
+            entry->peakObjects = (size_t)oc_atomic_add(&pool->peak, 0);
+            entry->limit = (size_t)pool->limit;
+            entry->allocations = (uint32_t)oc_atomic_add(&pool->allocations, 0);
+            entry->failures = (uint32_t)oc_atomic_add(&pool->failures, 0);
+
+            oc_mutex_lock(pool->mutex);
+            entry->capacity = pool->slabCount * pool->slabObjects;
+            uint64_t elapsed = now - pool->statsTime;
+            uint32_t allocated = entry->allocations - pool->statsAllocations;
+            entry->allocationRate = elapsed ? (uint32_t)((allocated * 1000ULL) / elapsed)
+                                            : 0;
+            pool->statsTime = now;
+            pool->statsAllocations = entry->allocations;
+            oc_mutex_unlock(pool->mutex);
+        }
+        count++;
+    }
+    UnlockRegistry();
+    return count;
+}
@@ -0,0 +1,223 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "iotivity_config.h"
+
+extern "C" {
+    #include "oic_malloc.h"
+    #include "oic_arena.h"
+}
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#define REUSE_NUM_OF_REQUESTS 1000
+#define REUSE_PAYLOAD_SIZE 120
+
+TEST(OICArena, AllocAndReset)
+{
+    OICArena *arena = OICArenaCreate(256);
+    ASSERT_TRUE(NULL != arena);
+    EXPECT_EQ(1u, OICArenaGetChunkAllocations(arena));
+
+    uint8_t *first = (uint8_t *)OICArenaCalloc(arena, 3, 8);
+    ASSERT_TRUE(NULL != first);
+    for (size_t i = 0; i < 24; i++)
+    {
+        EXPECT_EQ(0, first[i]);
+    }
+    char *second = OICArenaStrdup(arena, "oic.if.baseline");
+    ASSERT_TRUE(NULL != second);
+    EXPECT_STREQ("oic.if.baseline", second);
+    EXPECT_EQ(0u, (uintptr_t)second % sizeof(void *));
+    EXPECT_TRUE(OICArenaOwns(arena, first));
+    EXPECT_TRUE(OICArenaOwns(arena, second + 3));
+
+    // The allocations fill the chunk before another one is taken.
+    EXPECT_EQ(1u, OICArenaGetChunkAllocations(arena));
+    void *third = OICArenaAlloc(arena, 200);
+    ASSERT_TRUE(NULL != third);
+    EXPECT_TRUE(OICArenaOwns(arena, third));
+
+    // The memory is reused after a reset.
+    OICArenaReset(arena);
+    uint32_t chunks = OICArenaGetChunkAllocations(arena);
+    EXPECT_EQ(first, OICArenaAlloc(arena, 8));
+    EXPECT_EQ(chunks, OICArenaGetChunkAllocations(arena));
+
+    void *heap = OICMalloc(8);
+    EXPECT_FALSE(OICArenaOwns(arena, heap));
+    OICFree(heap);
+    OICArenaDestroy(arena);
+}
+
+TEST(OICArena, LargeAllocation)
+{
+    OICArena *arena = OICArenaCreate(256);
+    ASSERT_TRUE(NULL != arena);
+    void *small = OICArenaAlloc(arena, 16);
+    uint8_t *large = (uint8_t *)OICArenaAlloc(arena, 1000);
+    ASSERT_TRUE(NULL != large);
+    memset(large, 0xFF, 1000);
+    EXPECT_TRUE(OICArenaOwns(arena, large + 999));
+
+    // The room left in the current chunk is still used.
+    uint8_t *next = (uint8_t *)OICArenaAlloc(arena, 16);
+    EXPECT_EQ((uint8_t *)small + 16, next);
+
+    OICArenaReset(arena);
+    EXPECT_FALSE(OICArenaOwns(arena, large));
+    EXPECT_TRUE(OICArenaOwns(arena, small));
+    OICArenaDestroy(arena);
+}
+
+TEST(OICArena, InvalidParams)
+{
+    EXPECT_TRUE(NULL == OICArenaCreate(0));
+    EXPECT_TRUE(NULL == OICArenaAlloc(NULL, 8));
+    OICArena *arena = OICArenaCreate(64);
+    ASSERT_TRUE(NULL != arena);
+    EXPECT_TRUE(NULL == OICArenaAlloc(arena, 0));
+    EXPECT_TRUE(NULL == OICArenaCalloc(arena, SIZE_MAX, 2));
+    EXPECT_TRUE(NULL == OICArenaStrdup(arena, NULL));
+    EXPECT_FALSE(OICArenaOwns(arena, NULL));
+    OICArenaDestroy(arena);
+    OICArenaDestroy(NULL);
+}
+
+TEST(OICRequestArena, Scope)
+{
+    OICRequestArenaResetStats();
+
+    // Outside of a scope, the memory comes from the heap.
+    char *heap = OICRequestStrdup("/a/light");
+    ASSERT_TRUE(NULL != heap);
+
+    OICRequestArenaBegin();
+    char *first = OICRequestStrdup("if=oic.if.baseline");
+    ASSERT_TRUE(NULL != first);
+    OICRequestArenaBegin();
+    uint8_t *second = (uint8_t *)OICRequestCalloc(4, 4);
+    ASSERT_TRUE(NULL != second);
+    OICRequestFree(second);
+    OICRequestArenaEnd();
+
+    // The nested scope does not reset the arena.
+    EXPECT_STREQ("if=oic.if.baseline", first);
+    OICRequestFree(first);
+    OICRequestFree(heap);
+    OICRequestArenaEnd();
+
+    OICRequestArenaStats stats;
+    OICRequestArenaGetStats(&stats);
+    EXPECT_EQ(1u, stats.requests);
+    EXPECT_EQ(2u, stats.arenaAllocations);
+    EXPECT_EQ(1u, stats.heapAllocations);
+
+    // The scope reuses its memory.
+    OICRequestArenaBegin();
+    EXPECT_EQ(first, OICRequestAlloc(8));
+    OICRequestArenaEnd();
+    OICRequestArenaRelease();
+}
+
+TEST(OICRequestArena, Disabled)
+{
+    OICRequestArenaRelease();
+    OICRequestArenaResetStats();
+    OICRequestArenaSetEnabled(false);
+
+    OICRequestArenaBegin();
+    char *str = OICRequestStrdup("rt=core.light");
+    ASSERT_TRUE(NULL != str);
+    OICRequestArenaEnd();
+    OICRequestFree(str);
+
+    OICRequestArenaStats stats;
+    OICRequestArenaGetStats(&stats);
+    EXPECT_EQ(0u, stats.arenaAllocations);
+    EXPECT_EQ(1u, stats.heapAllocations);
+    EXPECT_EQ(0u, stats.chunkAllocations);
+    OICRequestArenaSetEnabled(true);
+}
+
+/*
+ * The transient allocations made while the stack handles a discovery request: the
+ * URI split from its query, the copies of the payload and token, and the filters
+ * extracted from the query.
+ */
+static void HandleRequest(const uint8_t *payload)
+{
+    char *uri = (char *)OICRequestCalloc(sizeof("/oic/res"), 1);
+    char *query = (char *)OICRequestCalloc(sizeof("if=oic.if.ll&rt=core.light"), 1);
+    uint8_t *payloadCopy = (uint8_t *)OICRequestAlloc(REUSE_PAYLOAD_SIZE);
+    uint8_t *token = (uint8_t *)OICRequestAlloc(8);
+    ASSERT_TRUE(uri && query && payloadCopy && token);
+    strcpy(uri, "/oic/res");
+    strcpy(query, "if=oic.if.ll&rt=core.light");
+    memcpy(payloadCopy, payload, REUSE_PAYLOAD_SIZE);
+
+    char *queryDup = OICRequestStrdup(query);
+    char *interfaceFilter = OICRequestStrdup("oic.if.ll");
+    char *typeFilter = OICRequestStrdup("core.light");
+    ASSERT_TRUE(queryDup && interfaceFilter && typeFilter);
+    OICRequestFree(queryDup);
+
+    OICRequestFree(typeFilter);
+    OICRequestFree(interfaceFilter);
+    OICRequestFree(token);
+    OICRequestFree(payloadCopy);
+    OICRequestFree(query);
+    OICRequestFree(uri);
+}
+
+static uint32_t RunRequests(const uint8_t *payload)
+{
+    OICRequestArenaRelease();
+    OICRequestArenaResetStats();
+    for (int i = 0; i < REUSE_NUM_OF_REQUESTS; i++)
+    {
+        OICRequestArenaBegin();
+        HandleRequest(payload);
+        OICRequestArenaEnd();
+    }
+
+    OICRequestArenaStats stats;
+    OICRequestArenaGetStats(&stats);
+    EXPECT_EQ((uint32_t)REUSE_NUM_OF_REQUESTS, stats.requests);
+    return stats.heapAllocations + stats.chunkAllocations;
+}
+
+TEST(OICRequestArena, ReusesChunkAcrossRequests)
+{
+    uint8_t payload[REUSE_PAYLOAD_SIZE];
+    memset(payload, 0xA5, sizeof(payload));
+
+    OICRequestArenaSetEnabled(false);
+    uint32_t heapMallocs = RunRequests(payload);
+    OICRequestArenaSetEnabled(true);
+    uint32_t arenaMallocs = RunRequests(payload);
+    OICRequestArenaRelease();
+
+    // Without the arena each request allocates from the heap, with it a single chunk is
+    // allocated for all the requests.
+    EXPECT_EQ(7u * REUSE_NUM_OF_REQUESTS, heapMallocs);
+    EXPECT_EQ(1u, arenaMallocs);
+}
@@ -0,0 +1,255 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "iotivity_config.h"
+
+extern "C" {
+    #include "oic_malloc.h"
+    #include "oic_pool.h"
+}
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define REUSE_NUM_OF_OBJECTS 64
+#define REUSE_NUM_OF_ROUNDS 100
+#define REUSE_OBJECT_SIZE 200
+
+static bool GetPoolStats(const char *name, OICPoolStats *stats)
+{
+    OICPoolStats all[OIC_POOL_MAX_POOLS];
+    size_t count = OICPoolGetStats(all, OIC_POOL_MAX_POOLS);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (0 == strcmp(name, all[i].name))
+        {
+            *stats = all[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST(OICPool, AllocAndFree)
+{
+    OICPool *pool = OICPoolCreate("test.alloc", 24);
+    ASSERT_TRUE(NULL != pool);
+
+    uint8_t *first = (uint8_t *)OICPoolCalloc(pool);
+    ASSERT_TRUE(NULL != first);
+    for (size_t i = 0; i < 24; i++)
+    {
+        EXPECT_EQ(0, first[i]);
+    }
+    EXPECT_EQ(0u, (uintptr_t)first % sizeof(void *));
+    memset(first, 0xFF, 24);
+
+    uint8_t *second = (uint8_t *)OICPoolAlloc(pool);
+    ASSERT_TRUE(NULL != second);
+    EXPECT_NE(first, second);
+
+    OICPoolStats stats;
+    ASSERT_TRUE(GetPoolStats("test.alloc", &stats));
+    EXPECT_EQ(24u, stats.objectSize);
+    EXPECT_EQ(2u, stats.liveObjects);
+    EXPECT_EQ(2u, stats.peakObjects);
+    EXPECT_EQ(2u, stats.allocations);
+    EXPECT_LE(2u, stats.capacity);
+
+    // A freed object is reused.
+    OICPoolFree(second);
+    EXPECT_EQ(second, OICPoolAlloc(pool));
+    OICPoolFree(second);
+    OICPoolFree(first);
+    OICPoolFree(NULL);
+
+    ASSERT_TRUE(GetPoolStats("test.alloc", &stats));
+    EXPECT_EQ(0u, stats.liveObjects);
+    EXPECT_EQ(2u, stats.peakObjects);
+    EXPECT_EQ(3u, stats.allocations);
+
+    OICPoolDestroy(pool);
+    EXPECT_FALSE(GetPoolStats("test.alloc", &stats));
+}
+
+TEST(OICPool, InvalidParams)
+{
+    EXPECT_TRUE(NULL == OICPoolCreate(NULL, 8));
+    EXPECT_TRUE(NULL == OICPoolCreate("test.invalid", 0));
+    EXPECT_TRUE(NULL == OICPoolAlloc(NULL));
+    EXPECT_TRUE(NULL == OICPoolCalloc(NULL));
+    EXPECT_FALSE(OICPoolSetLimit(NULL, 1));
+    OICPoolDestroy(NULL);
+}
+
+TEST(OICPool, Limit)
+{
+    EXPECT_TRUE(OICPoolSetLimit("test.limit", 2));
+    OICPool *pool = OICPoolCreate("test.limit", 8);
+    ASSERT_TRUE(NULL != pool);
+
+    void *first = OICPoolAlloc(pool);
+    void *second = OICPoolAlloc(pool);
+    EXPECT_TRUE(NULL != first);
+    EXPECT_TRUE(NULL != second);
+    EXPECT_TRUE(NULL == OICPoolAlloc(pool));
+
+    OICPoolStats stats;
+    ASSERT_TRUE(GetPoolStats("test.limit", &stats));
+    EXPECT_EQ(2u, stats.limit);
+    EXPECT_EQ(2u, stats.liveObjects);
+    EXPECT_EQ(1u, stats.failures);
+
+    // Raising the limit applies to the existing pool.
+    EXPECT_TRUE(OICPoolSetLimit("test.limit", 0));
+    void *third = OICPoolAlloc(pool);
+    EXPECT_TRUE(NULL != third);
+
+    OICPoolFree(first);
+    OICPoolFree(second);
+    OICPoolFree(third);
+    OICPoolDestroy(pool);
+}
+
+TEST(OICPool, DestroyWithLiveObjects)
+{
+    OICPool *pool = OICPoolCreate("test.destroy", 8);
+    ASSERT_TRUE(NULL != pool);
+    void *object = OICPoolAlloc(pool);
+    ASSERT_TRUE(NULL != object);
+
+    // The pool is released with its last object.
+    OICPoolDestroy(pool);
+    OICPoolStats stats;
+    EXPECT_TRUE(GetPoolStats("test.destroy", &stats));
+    OICPoolFree(object);
+    EXPECT_FALSE(GetPoolStats("test.destroy", &stats));
+}
+
+TEST(OICPool, GetSharedPool)
+{
+    static OICPool *s_pool = NULL;
+    OICPool *pool = OICPoolGet(&s_pool, "test.shared", 16);
+    ASSERT_TRUE(NULL != pool);
+    EXPECT_EQ(pool, s_pool);
+    EXPECT_EQ(pool, OICPoolGet(&s_pool, "test.shared", 16));
+}
+
+TEST(OICPool, FreeOnOtherThreads)
+{
+    OICPool *pool = OICPoolCreate("test.threads", 32);
+    ASSERT_TRUE(NULL != pool);
+
+    // Objects allocated on one thread are freed on another one.
+    std::vector<void *> objects(1000);
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        objects[i] = OICPoolAlloc(pool);
+        ASSERT_TRUE(NULL != objects[i]);
+    }
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&objects, t, pool]()
+        {
+            for (size_t i = t; i < objects.size(); i += 4)
+            {
+                OICPoolFree(objects[i]);
+            }
+            for (size_t round = 0; round < 1000; round++)
+            {
+                OICPoolFree(OICPoolAlloc(pool));
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    OICPoolStats stats;
+    ASSERT_TRUE(GetPoolStats("test.threads", &stats));
+    EXPECT_EQ(0u, stats.liveObjects);
+    EXPECT_EQ(5000u, stats.allocations);
+    OICPoolDestroy(pool);
+}
+
+TEST(OICPool, ThreadCachesFlushedOnExit)
+{
+    // 16 objects per slab.
+    OICPool *pool = OICPoolCreate("test.exit", 240);
+    ASSERT_TRUE(NULL != pool);
+
+    std::thread thread([pool]()
+    {
+        OICPoolFree(OICPoolAlloc(pool));
+    });
+    thread.join();
+
+    OICPoolStats stats;
+    ASSERT_TRUE(GetPoolStats("test.exit", &stats));
+    size_t capacity = stats.capacity;
+
+    // The objects cached by the thread are allocated again, rather than another slab.
+    void *objects[16];
+    for (size_t i = 0; i < 16; i++)
+    {
+        objects[i] = OICPoolAlloc(pool);
+        ASSERT_TRUE(NULL != objects[i]);
+    }
+    ASSERT_TRUE(GetPoolStats("test.exit", &stats));
+    EXPECT_EQ(capacity, stats.capacity);
+    for (size_t i = 0; i < 16; i++)
+    {
+        OICPoolFree(objects[i]);
+    }
+    OICPoolDestroy(pool);
+}
+
+TEST(OICPool, ReusesFreedObjects)
+{
+    OICPool *pool = OICPoolCreate("test.reuse", REUSE_OBJECT_SIZE);
+    ASSERT_TRUE(NULL != pool);
+    void *objects[REUSE_NUM_OF_OBJECTS];
+
+    for (size_t round = 0; round < REUSE_NUM_OF_ROUNDS; round++)
+    {
+        for (size_t i = 0; i < REUSE_NUM_OF_OBJECTS; i++)
+        {
+            objects[i] = OICPoolAlloc(pool);
+            ASSERT_TRUE(NULL != objects[i]);
+        }
+        for (size_t i = 0; i < REUSE_NUM_OF_OBJECTS; i++)
+        {
+            OICPoolFree(objects[i]);
+        }
+    }
+
+    // The freed objects are allocated again rather than new slabs.
+    OICPoolStats stats;
+    ASSERT_TRUE(GetPoolStats("test.reuse", &stats));
+    EXPECT_EQ((size_t)REUSE_NUM_OF_OBJECTS, stats.peakObjects);
+    EXPECT_EQ((uint32_t)(REUSE_NUM_OF_ROUNDS * REUSE_NUM_OF_OBJECTS), stats.allocations);
+    EXPECT_GE(stats.capacity, (size_t)REUSE_NUM_OF_OBJECTS);
+    EXPECT_LE(stats.capacity, (size_t)(2 * REUSE_NUM_OF_OBJECTS));
+    OICPoolDestroy(pool);
+}
@@ -498,6 +498,45 @@ typedef struct
     char optionData[CA_MAX_HEADER_OPTION_DATA_LENGTH];      /**< Optional data values**/
 } CAHeaderOption_t;
 
+/**
+ * Callback to fill one block of a streamed payload.
+ *
+ * Blocks may be requested again (e.g. after retransmission), so the producer has to
+ * support random access by offset.
+ *
+ * @param[in]   context     context given to ::CACreateBlockProducer.
+ * @param[in]   offset      offset of the block within the whole payload.
+ * @param[out]  buffer      buffer to be filled.
+ * @param[in]   bufferSize  number of bytes to be written to @p buffer.
+ * @return ::CA_STATUS_OK if @p bufferSize bytes were written, otherwise an error code.
+ */
+typedef CAResult_t (*CABlockProducer_t)(void *context, size_t offset,
+                                        uint8_t *buffer, size_t bufferSize);
+
+/**
+ * Callback to consume one received block of a streamed payload.
+ *
+ * Blocks are delivered in order, each of them exactly once.
+ *
+ * @param[in]   context     context given to ::CACreateBlockConsumer.
+ * @param[in]   offset      offset of the block within the whole payload.
+ * @param[in]   data        received block data.
+ * @param[in]   dataSize    size of @p data.
+ * @return ::CA_STATUS_OK to continue the transfer, otherwise an error code to abort it.
+ */
+typedef CAResult_t (*CABlockConsumer_t)(void *context, size_t offset,
+                                        const uint8_t *data, size_t dataSize);
+
+/**
+ * Callback to delete the context of a block stream when its last reference is released.
+ */
+typedef void (*CABlockStreamContextDeleter_t)(void *context);
+
+/**
+ * Reference counted block stream, either a producer or a consumer of payload blocks.
+ */
+typedef struct CABlockStream CABlockStream_t;
+
 /**
  * Base Information received.
  *
@@ -526,6 +565,8 @@ typedef struct
     CAURI_t resourceUri;        /**< Resource URI information **/
     CARemoteId_t identity;      /**< endpoint identity */
     CADataType_t dataType;      /**< data type */
+    CABlockStream_t *blockStream; /**< producer of the payload (in place of payload) or
+                                       consumer of the blockwise response payload */
 } CAInfo_t;
 
 /**
@@ -585,23 +626,6 @@ typedef struct
     uint16_t port;      /**< socket port */
 } CASocket_t;
 
-#define HISTORYSIZE (4)
-
-typedef struct
-{
-    CATransportFlags_t flags;
-    uint16_t messageId;
-    char token[CA_MAX_TOKEN_LEN];
-    uint8_t tokenLength;
-    uint32_t ifindex;
-} CAHistoryItem_t;
-
-typedef struct
-{
-    int nextIndex;
-    CAHistoryItem_t items[HISTORYSIZE];
-} CAHistory_t;
-
 /**
  * Hold interface index for keeping track of comings and goings.
  */
@@ -680,11 +704,6 @@ typedef struct
         } nm;
     } ip;
 
-    struct calayer
-    {
-        CAHistory_t requestHistory;  /**< filter IP family in requests */
-    } ca;
-
 #ifdef TCP_ADAPTER
     /**
      * Hold global variables for TCP Adapter.
@@ -762,6 +781,14 @@ typedef CAResult_t (*CAHandshakeErrorCallback)(const CAEndpoint_t *object,
  */
 typedef void (*CANetworkMonitorCallback)(const CAEndpoint_t *info, CANetworkStatus_t status);
 
+/**
+ * Callback function type to notify that received data is waiting for
+ * CAHandleRequestResponse(). It is called from the thread which has received the data,
+ * so it should only wake up the thread which calls CAHandleRequestResponse().
+ * @param[in]   context     Context given with the callback.
+ */
+typedef void (*CAReceivedDataCallback)(void *context);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -192,6 +192,38 @@ CAResult_t CASendRequest(const CAEndpoint_t *object, const CARequestInfo_t *requ
  */
 CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo);
 
+/**
+ * Create a block stream which produces a payload block by block.
+ * Set it as CAInfo_t::blockStream (with a NULL payload) so that a blockwise
+ * transfer only keeps one block of the payload in memory at a time.
+ * @param[in]   totalLength   total length of the payload to be produced.
+ * @param[in]   producer      callback filling each block.
+ * @param[in]   context       context passed to @p producer.
+ * @param[in]   deleter       optional deleter of @p context, called on the last release.
+ * @return  block stream holding one reference, or NULL on error.
+ */
+CABlockStream_t *CACreateBlockProducer(size_t totalLength, CABlockProducer_t producer,
+                                       void *context, CABlockStreamContextDeleter_t deleter);
+
+/**
+ * Create a block stream which consumes a blockwise response payload block by block.
+ * Set it as CAInfo_t::blockStream of a request; the blocks of the response are then
+ * handed to @p consumer instead of being reassembled, and the final response is
+ * delivered without payload.
+ * @param[in]   consumer      callback receiving each block.
+ * @param[in]   context       context passed to @p consumer.
+ * @param[in]   deleter       optional deleter of @p context, called on the last release.
+ * @return  block stream holding one reference, or NULL on error.
+ */
+CABlockStream_t *CACreateBlockConsumer(CABlockConsumer_t consumer, void *context,
+                                       CABlockStreamContextDeleter_t deleter);
+
+/**
+ * Release a reference of a block stream.
+ * @param[in]   stream        block stream to release.
+ */
+void CAReleaseBlockStream(CABlockStream_t *stream);
+
 /**
  * Select network to use.
  * @param[in]   interestedNetwork    Connectivity Type enum.
@@ -231,6 +263,22 @@ CATransportAdapter_t CAGetSelectedNetwork(void);
  */
 CAResult_t CAHandleRequestResponse(void);
 
+/**
+ * Register the callback to be notified when received data is waiting for
+ * CAHandleRequestResponse(), so that the caller does not need to poll.
+ * The callback must not register another one; it is not running any longer once
+ * this function returns.
+ * @param[in]   handler     Received data callback, or NULL to unregister.
+ * @param[in]   context     Context passed to the callback.
+ */
+void CARegisterReceivedDataHandler(CAReceivedDataCallback handler, void *context);
+
+/**
+ * Check whether received data is waiting for CAHandleRequestResponse().
+ * @return  true if CAHandleRequestResponse() has data to handle.
+ */
+bool CAHasPendingRequestResponse(void);
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
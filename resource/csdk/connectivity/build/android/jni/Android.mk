@@ -140,7 +140,7 @@ LOCAL_CFLAGS += $(BUILD_FLAG)
 LOCAL_CFLAGS += -std=c99 -DWITH_POSIX -DWITH_BWT
 
 LOCAL_SRC_FILES = \
-                caconnectivitymanager.c cainterfacecontroller.c \
+                caconnectivitymanager.c cadeduplication.c cainterfacecontroller.c \
                 camessagehandler.c canetworkconfigurator.c caprotocolmessage.c \
                 caretransmission.c caqueueingthread.c cablockwisetransfer.c \
                 $(ADAPTER_UTILS)/caadapternetdtls.c $(ADAPTER_UTILS)/caadapterutils.c \
@@ -0,0 +1,100 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the internal APIs of block streams which let a blockwise
+ * transfer produce or consume its payload one block at a time.
+ */
+
+#ifndef CA_BLOCK_STREAM_H_
+#define CA_BLOCK_STREAM_H_
+
+#include "cacommon.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Add a reference to a block stream.
+ * @param[in]   stream      block stream, may be NULL.
+ * @return  @p stream.
+ */
+CABlockStream_t *CARetainBlockStream(CABlockStream_t *stream);
+
+/**
+ * Check whether the block stream produces a payload.
+ * @param[in]   stream      block stream, may be NULL.
+ * @return  true if @p stream is a producer.
+ */
+bool CAIsBlockProducer(const CABlockStream_t *stream);
+
+/**
+ * Check whether the block stream consumes a payload.
+ * @param[in]   stream      block stream, may be NULL.
+ * @return  true if @p stream is a consumer.
+ */
+bool CAIsBlockConsumer(const CABlockStream_t *stream);
+
+/**
+ * Get the total length of the payload of a producer.
+ * @param[in]   stream      block stream, may be NULL.
+ * @return  total payload length, or 0 if @p stream is not a producer.
+ */
+size_t CAGetBlockStreamLength(const CABlockStream_t *stream);
+
+/**
+ * Read a part of the payload of a producer.
+ * @param[in]   stream      block stream.
+ * @param[in]   offset      offset of the part within the payload.
+ * @param[out]  buffer      buffer to be filled.
+ * @param[in]   size        size of the part, must not cross the total length.
+ * @return ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAReadBlockStream(CABlockStream_t *stream, size_t offset,
+                             uint8_t *buffer, size_t size);
+
+/**
+ * Hand a received part of the payload to a consumer.
+ * @param[in]   stream      block stream.
+ * @param[in]   offset      offset of the part within the payload.
+ * @param[in]   data        received data.
+ * @param[in]   size        size of @p data.
+ * @return ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAWriteBlockStream(CABlockStream_t *stream, size_t offset,
+                              const uint8_t *data, size_t size);
+
+/**
+ * Replace the producer of the given information with the whole produced payload.
+ * This is used when the message is not sent by blockwise transfer.
+ * @param[in,out]   info    information of the request/response.
+ * @return ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAMaterializeBlockStream(CAInfo_t *info);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* CA_BLOCK_STREAM_H_ */
@@ -0,0 +1,210 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "oic_malloc.h"
+#include "ocatomic.h"
+#include "cainterface.h"
+#include "cablockstream.h"
+#include "experimental/logger.h"
+
+#define TAG "OIC_CA_BLOCK_STREAM"
+
+struct CABlockStream
+{
+    volatile int32_t refCount;              /**< number of references. */
+    size_t totalLength;                     /**< total payload length of a producer. */
+    CABlockProducer_t producer;             /**< producer callback, or NULL. */
+    CABlockConsumer_t consumer;             /**< consumer callback, or NULL. */
+    void *context;                          /**< context of the callback. */
+    CABlockStreamContextDeleter_t deleter;  /**< deleter of the context. */
+};
+
+static CABlockStream_t *CACreateBlockStream(void *context,
+                                            CABlockStreamContextDeleter_t deleter)
+{
+    CABlockStream_t *stream = (CABlockStream_t *) OICCalloc(1, sizeof(CABlockStream_t));
+    if (!stream)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return NULL;
+    }
+
+    stream->refCount = 1;
+    stream->context = context;
+    stream->deleter = deleter;
+    return stream;
+}
+
+CABlockStream_t *CACreateBlockProducer(size_t totalLength, CABlockProducer_t producer,
+                                       void *context, CABlockStreamContextDeleter_t deleter)
+{
+    if (!producer)
+    {
+        OIC_LOG(ERROR, TAG, "producer is null");
+        return NULL;
+    }
+
+    CABlockStream_t *stream = CACreateBlockStream(context, deleter);
+    if (stream)
+    {
+        stream->totalLength = totalLength;
+        stream->producer = producer;
+    }
+    return stream;
+}
+
+CABlockStream_t *CACreateBlockConsumer(CABlockConsumer_t consumer, void *context,
+                                       CABlockStreamContextDeleter_t deleter)
+{
+    if (!consumer)
+    {
+        OIC_LOG(ERROR, TAG, "consumer is null");
+        return NULL;
+    }
+
+    CABlockStream_t *stream = CACreateBlockStream(context, deleter);
+    if (stream)
+    {
+        stream->consumer = consumer;
+    }
+    return stream;
+}
+
+CABlockStream_t *CARetainBlockStream(CABlockStream_t *stream)
+{
+    if (stream)
+    {
+        oc_atomic_increment(&stream->refCount);
+    }
+    return stream;
+}
+
+void CAReleaseBlockStream(CABlockStream_t *stream)
+{
+    if (!stream)
+    {
+        return;
+    }
+
+    if (0 == oc_atomic_decrement(&stream->refCount))
+    {
+        if (stream->deleter)
+        {
+            stream->deleter(stream->context);
+        }
+        OICFree(stream);
+    }
+}
+
+bool CAIsBlockProducer(const CABlockStream_t *stream)
+{
+    return stream && stream->producer;
+}
+
+bool CAIsBlockConsumer(const CABlockStream_t *stream)
+{
+    return stream && stream->consumer;
+}
+
+size_t CAGetBlockStreamLength(const CABlockStream_t *stream)
+{
+    return CAIsBlockProducer(stream) ? stream->totalLength : 0;
+}
+
+CAResult_t CAReadBlockStream(CABlockStream_t *stream, size_t offset,
+                             uint8_t *buffer, size_t size)
+{
+    if (!CAIsBlockProducer(stream) || !buffer)
+    {
+        OIC_LOG(ERROR, TAG, "invalid producer read");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (offset > stream->totalLength || size > stream->totalLength - offset)
+    {
+        OIC_LOG_V(ERROR, TAG, "read [%" PRIuPTR ", +%" PRIuPTR "] is out of range",
+                  offset, size);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (0 == size)
+    {
+        return CA_STATUS_OK;
+    }
+
+    return stream->producer(stream->context, offset, buffer, size);
+}
+
+CAResult_t CAWriteBlockStream(CABlockStream_t *stream, size_t offset,
+                              const uint8_t *data, size_t size)
+{
+    if (!CAIsBlockConsumer(stream) || (!data && size))
+    {
+        OIC_LOG(ERROR, TAG, "invalid consumer write");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    return stream->consumer(stream->context, offset, data, size);
+}
+
+CAResult_t CAMaterializeBlockStream(CAInfo_t *info)
+{
+    if (!info)
+    {
+        OIC_LOG(ERROR, TAG, "info is null");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (!CAIsBlockProducer(info->blockStream))
+    {
+        return CA_STATUS_OK;
+    }
+
+    size_t length = info->blockStream->totalLength;
+    uint8_t *payload = NULL;
+    if (length)
+    {
+        payload = (uint8_t *) OICMalloc(length);
+        if (!payload)
+        {
+            OIC_LOG(ERROR, TAG, "out of memory");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+
+        CAResult_t res = CAReadBlockStream(info->blockStream, 0, payload, length);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "producer has failed");
+            OICFree(payload);
+            return res;
+        }
+    }
+
+    OICFree(info->payload);
+    info->payload = payload;
+    info->payloadSize = length;
+
+    CAReleaseBlockStream(info->blockStream);
+    info->blockStream = NULL;
+    return CA_STATUS_OK;
+}
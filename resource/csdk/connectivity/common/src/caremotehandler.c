@@ -23,6 +23,8 @@
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "caremotehandler.h"
+#include "cablockstream.h"
+#include "cainterface.h"
 #include "experimental/logger.h"
 
 #define TAG "OIC_CA_REMOTE_HANDLER"
@@ -243,6 +245,10 @@ static void CADestroyInfoInternal(CAInfo_t *info)
     // free uri
     OICFree(info->resourceUri);
     info->resourceUri = NULL;
+
+    // release block stream
+    CAReleaseBlockStream(info->blockStream);
+    info->blockStream = NULL;
 }
 
 void CADestroyRequestInfoInternal(CARequestInfo_t *rep)
@@ -355,6 +361,7 @@ CAResult_t CACloneInfo(const CAInfo_t *info, CAInfo_t *clone)
         clone->payloadSize = info->payloadSize;
     }
     clone->payloadFormat = info->payloadFormat;
+    clone->blockStream = CARetainBlockStream(info->blockStream);
     clone->acceptFormat = info->acceptFormat;
     clone->payloadVersion = info->payloadVersion;
     clone->acceptVersion = info->acceptVersion;
@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include "experimental/logger.h"
 #include "oic_malloc.h"
+#include "oic_pool.h"
 
 /**
  * @def NO_MESSAGES
@@ -37,6 +38,11 @@
  */
 #define TAG "OIC_UQUEUE"
 
+/**
+ * Pool of the queue elements, shared by all the queues.
+ */
+static OICPool *g_elementPool = NULL;
+
 u_queue_t *u_queue_create(void)
 {
     u_queue_t *queuePtr = (u_queue_t *) OICMalloc(sizeof(u_queue_t));
@@ -69,7 +75,8 @@ CAResult_t u_queue_add_element(u_queue_t *queue, u_queue_message_t *message)
         return CA_STATUS_FAILED;
     }
 
-    element = (u_queue_element *) OICMalloc(sizeof(u_queue_element));
+    element = (u_queue_element *) OICPoolAlloc(OICPoolGet(&g_elementPool, "u_queue_element",
+                                                          sizeof(u_queue_element)));
     if (NULL == element)
     {
         OIC_LOG(DEBUG, TAG, "QueueAddElement FAIL, memory allocation failed");
@@ -100,7 +107,7 @@ CAResult_t u_queue_add_element(u_queue_t *queue, u_queue_message_t *message)
             OIC_LOG(DEBUG, TAG, "QueueAddElement : FAIL, count is not zero");
 
             /* error in queue, free the allocated memory*/
-            OICFree(element);
+            OICPoolFree(element);
             return CA_STATUS_FAILED;
         }
 
@@ -134,7 +141,7 @@ u_queue_message_t *u_queue_get_element(u_queue_t *queue)
     queue->count--;
 
     message = element->message;
-    OICFree(element);
+    OICPoolFree(element);
     return message;
 }
 
@@ -160,7 +167,7 @@ CAResult_t u_queue_remove_element(u_queue_t *queue)
     next = remove->next;
 
     OICFree(remove->message);
-    OICFree(remove);
+    OICPoolFree(remove);
 
     queue->element = next;
     queue->count--;
@@ -0,0 +1,170 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the deduplication of received messages (RFC 7252, 4.5).
+ *
+ * The messages received from an endpoint are remembered by message ID for
+ * EXCHANGE_LIFETIME. A request received again, because its CON retransmission
+ * crossed our response or because it arrived on more than one interface, is not
+ * handled a second time: the response sent to the first copy is sent again if it
+ * was a piggybacked one, otherwise the duplicate is dropped.
+ */
+
+#ifndef CA_DEDUPLICATION_H_
+#define CA_DEDUPLICATION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "octhread.h"
+#include "cacommon.h"
+
+/** EXCHANGE_LIFETIME of CoAP, 247 sec. **/
+#define DEFAULT_EXCHANGE_LIFETIME_SEC     247
+
+/** default number of messages remembered. **/
+#define DEFAULT_DEDUPLICATION_CAPACITY    512
+
+/** default total size of the responses kept for the duplicates. **/
+#define DEFAULT_DEDUPLICATION_RESPONSE_SIZE   (64 * 1024)
+
+typedef struct
+{
+    /** maximum number of messages remembered, the oldest ones are forgotten first. **/
+    uint32_t capacity;
+
+    /** maximum total size of the responses kept. **/
+    uint32_t responseSize;
+
+    /** time a message is remembered. microseconds **/
+    uint64_t lifetime;
+
+} CADeduplicationConfig_t;
+
+/** a message remembered. **/
+typedef struct CADeduplicationEntry CADeduplicationEntry_t;
+
+typedef struct
+{
+    /** mutex for synchronization. **/
+    oc_mutex mutex;
+
+    /** deduplication configure data. **/
+    CADeduplicationConfig_t config;
+
+    /** messages remembered, in the order they were received. **/
+    CADeduplicationEntry_t *entries;
+
+    /** index of the oldest message. **/
+    uint32_t first;
+
+    /** number of messages remembered. **/
+    uint32_t count;
+
+    /** hash index of the messages, chains of entry indexes. **/
+    int32_t *buckets;
+
+    /** number of buckets, a power of 2. **/
+    uint32_t bucketCount;
+
+    /** total size of the responses kept. **/
+    uint32_t responseSize;
+
+    /** number of duplicates received. **/
+    uint32_t duplicates;
+
+} CADeduplication_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Initializes the deduplication context.
+ * @param[in]   context      context for deduplication.
+ * @param[in]   config       configuration for deduplication.
+ *                           if NULL is coming, it will set default values.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CADeduplicationInitialize(CADeduplication_t *context,
+                                     const CADeduplicationConfig_t *config);
+
+/**
+ * Check whether a message was received already from the endpoint, and remember it
+ * if it was not.
+ * @param[in]   context         context for deduplication.
+ * @param[in]   endpoint        endpoint the message was received from.
+ * @param[in]   messageId       message ID of the message.
+ * @param[in]   currentTime     current time. microseconds
+ * @param[out]  response        copy of the response sent to the first copy of a
+ *                              duplicate, to free with OICFree(), or NULL.
+ * @param[out]  responseSize    size of the response.
+ * @return  true if the message is a duplicate.
+ */
+bool CADeduplicationReceivedData(CADeduplication_t *context, const CAEndpoint_t *endpoint,
+                                 uint16_t messageId, uint64_t currentTime,
+                                 void **response, uint32_t *responseSize);
+
+/**
+ * Check whether a message with the same message ID and token was received already on
+ * the interface of the endpoint, from any address, and remember it if it was not. A
+ * multicast request arrives once per IP family, from the two addresses of the sender.
+ * @param[in]   context         context for deduplication.
+ * @param[in]   endpoint        endpoint the message was received from.
+ * @param[in]   messageId       message ID of the message.
+ * @param[in]   token           token of the message.
+ * @param[in]   tokenLength     length of the token, only the first
+ *                              ::CA_MAX_TOKEN_LEN bytes are compared.
+ * @param[in]   currentTime     current time. microseconds
+ * @return  true if the message is a duplicate.
+ */
+bool CADeduplicationReceivedToken(CADeduplication_t *context, const CAEndpoint_t *endpoint,
+                                  uint16_t messageId, const CAToken_t token,
+                                  uint8_t tokenLength, uint64_t currentTime);
+
+/**
+ * Keep the response to a message remembered, for its duplicates. Only piggybacked
+ * responses, with the message ID of the request, can be kept.
+ * @param[in]   context         context for deduplication.
+ * @param[in]   endpoint        endpoint the response was sent to.
+ * @param[in]   messageId       message ID of the request and the response.
+ * @param[in]   pdu             sent pdu binary data.
+ * @param[in]   size            sent pdu binary data size.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CADeduplicationSentResponse(CADeduplication_t *context,
+                                       const CAEndpoint_t *endpoint, uint16_t messageId,
+                                       const void *pdu, uint32_t size);
+
+/**
+ * Terminating the deduplication context.
+ * @param[in]   context         context for deduplication.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CADeduplicationDestroy(CADeduplication_t *context);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* CA_DEDUPLICATION_H_ */
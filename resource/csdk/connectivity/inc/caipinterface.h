@@ -136,6 +136,42 @@ void CAIPSendData(CAEndpoint_t *endpoint,
                   size_t dataLength,
                   bool isMulticast);
 
+/**
+ * Unicast UDP data to be sent by CAIPSendUnicastDataBatch().
+ */
+typedef struct
+{
+    CAEndpoint_t *endpoint;     /**< complete network address to send to. */
+    const void *data;           /**< Data to be send. */
+    size_t dataLength;          /**< Length of data in bytes. */
+} CAIPUnicastData_t;
+
+/**
+ * API to send several unicast UDP data, with as few system calls as possible.
+ * The data sent to the same socket are given to one sendmmsg() call where it is
+ * available, otherwise each data is sent by CAIPSendData().
+ *
+ * @param[in]  batch             data to send, in order.
+ * @param[in]  count             number of data in batch.
+ */
+void CAIPSendUnicastDataBatch(CAIPUnicastData_t *batch, size_t count);
+
+/**
+ * Number of datagrams sent by the IP adapter, and of system calls used to send them.
+ */
+typedef struct
+{
+    uint32_t datagrams;         /**< datagrams sent. */
+    uint32_t sendCalls;         /**< send system calls. */
+} CAIPSendStatistics_t;
+
+/**
+ * Get the send statistics of the IP adapter, since it was started.
+ *
+ * @param[out] statistics        send statistics.
+ */
+void CAIPGetSendStatistics(CAIPSendStatistics_t *statistics);
+
 /**
  * Get IP adapter connection state.
  *
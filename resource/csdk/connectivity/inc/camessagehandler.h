@@ -98,6 +98,19 @@ void CAHandleRequestResponseCallbacks(void);
  */
 void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler);
 
+/**
+ * Setting the Callback function to be notified of the data added to the receive queue.
+ * @param[in] handler     callback for received data, or NULL.
+ * @param[in] context     context passed to the callback.
+ */
+void CASetReceivedDataCallback(CAReceivedDataCallback handler, void *context);
+
+/**
+ * Check whether the receive queue holds data for CAHandleRequestResponseCallbacks().
+ * @return true if there is received data to handle.
+ */
+bool CAHasReceivedData(void);
+
 #if defined(WITH_BWT) || defined(TCP_ADAPTER)
 /**
  * Add the data to the send queue thread.
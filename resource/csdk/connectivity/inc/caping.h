@@ -109,6 +109,14 @@ CAResult_t CASendPongMessage(const CAEndpoint_t *endpoint, bool withCustody,
  */
 void CAProcessPing();
 
+/**
+ * Gets the time at which the oldest ping message times out, so that
+ * CAProcessPing() only needs to be called when a ping is due.
+ * @return  time in milliseconds (OICGetCurrentTime(TIME_IN_MS) clock), or
+ *          UINT64_MAX if no ping message is waiting for a pong.
+ */
+uint64_t CAGetNextPingDeadline();
+
 /**
  * Sets the timeout for a ping message
  * @param[in] timeout   the timeout for the ping message (in ms). If this
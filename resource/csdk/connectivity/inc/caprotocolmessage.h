@@ -52,11 +52,27 @@ static const uint8_t PAYLOAD_MARKER = 1;
  * @param[in]   code                 code of the pdu packet.
  * @param[in]   info                 pdu information.
  * @param[in]   endpoint             endpoint information.
+ * @param[in]   optlist              options list of the block-wise transfer. The
+ *                                   options are encoded into the pdu, the block-wise
+ *                                   transfer moves them to the list when it needs
+ *                                   to, see CAMovePDUOptionsToList().
+ * @param[out]  transport            transport type of the pdu.
  * @return  generated pdu.
  */
 coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
                           coap_list_t **optlist, coap_transport_t *transport);
 
+/**
+ * moves the options of a UDP pdu without payload back into an options list, so that
+ * more options, such as the block options, can be inserted in order before the pdu
+ * is encoded again with CAGeneratePDUImpl().
+ * @param[in,out]   pdu              pdu generated by CAGeneratePDU(). Its options
+ *                                   are removed.
+ * @param[in,out]   optlist          options list receiving the options.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAMovePDUOptionsToList(coap_pdu_t *pdu, coap_list_t **optlist);
+
 /**
  * extracts request information from received pdu.
  * @param[in]   pdu                   received pdu.
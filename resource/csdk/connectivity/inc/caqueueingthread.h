@@ -44,6 +44,9 @@ typedef void (*CAThreadTask)(void *threadData);
 /** Data destroy function. **/
 typedef void (*CADataDestroyFunction)(void *data, uint32_t size);
 
+/** Thread function to be invoked with several data at once. **/
+typedef void (*CAThreadBatchTask)(void **threadData, size_t count);
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -60,6 +63,10 @@ typedef struct
     bool isStop;
     /** Que on which the thread is operating. **/
     u_queue_t *dataQueue;
+    /** Thread function to be invoked with several data, or NULL. **/
+    CAThreadBatchTask batchTask;
+    /** Maximum number of data given to batchTask. **/
+    size_t maxBatchSize;
 } CAQueueingThread_t;
 
 /**
@@ -73,6 +80,18 @@ typedef struct
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy);
 
+/**
+ * Let the queuing thread give all the queued data (up to maxBatchSize) to one call
+ * of the batch task, instead of one data per call of the thread task.
+ * Must be called before the thread is started.
+ * @param[in]   thread       thread data for each thread.
+ * @param[in]   task         function to be called for several data, or NULL.
+ * @param[in]   maxBatchSize maximum number of data given to one call of task.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadSetBatchTask(CAQueueingThread_t *thread, CAThreadBatchTask task,
+                                        size_t maxBatchSize);
+
 /**
  * Start the queuing thread.
  * @param[in]   thread        thread data that needs to be started.
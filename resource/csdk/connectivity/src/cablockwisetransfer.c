@@ -40,6 +40,7 @@
 #include "camessagehandler.h"
 #include "caremotehandler.h"
 #include "cablockwisetransfer.h"
+#include "cablockstream.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "octhread.h"
@@ -60,10 +61,90 @@ static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .dataList = NULL,
                                           .multicastDataList = NULL };
 
+static size_t CAGetSendPayloadLength(const CAInfo_t *info)
+{
+    if (CAIsBlockProducer(info->blockStream))
+    {
+        return CAGetBlockStreamLength(info->blockStream);
+    }
+    return info->payload ? info->payloadSize : 0;
+}
+
+static CABlockStream_t *CAGetBlockConsumer(const CABlockData_t *currData)
+{
+    // only the response to a request which carries a consumer is streamed
+    if (currData->sentData && currData->sentData->requestInfo
+        && CAIsBlockConsumer(currData->sentData->requestInfo->info.blockStream))
+    {
+        return currData->sentData->requestInfo->info.blockStream;
+    }
+    return NULL;
+}
+
+static CAResult_t CAAddBlockPayload(coap_pdu_t *pdu, const CAInfo_t *info, size_t dataLength,
+                                    unsigned int num, unsigned int szx)
+{
+    if (!CAIsBlockProducer(info->blockStream))
+    {
+        assert(szx <= UINT8_MAX);
+        if (!coap_add_block(pdu, (unsigned int)dataLength,
+                            (const unsigned char *) info->payload, num, (unsigned char)szx))
+        {
+            OIC_LOG(ERROR, TAG, "Data length is smaller than the start index");
+            return CA_STATUS_FAILED;
+        }
+        return CA_STATUS_OK;
+    }
+
+    // produce only the requested block
+    size_t start = (size_t) num << (szx + 4);
+    if (dataLength <= start)
+    {
+        OIC_LOG(ERROR, TAG, "Data length is smaller than the start index");
+        return CA_STATUS_FAILED;
+    }
+
+    size_t blockLen = dataLength - start;
+    if (blockLen > (size_t) BLOCK_SIZE(szx))
+    {
+        blockLen = BLOCK_SIZE(szx);
+    }
+
+    uint8_t *buffer = (uint8_t *) OICMalloc(blockLen);
+    if (!buffer)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    CAResult_t res = CAReadBlockStream(info->blockStream, start, buffer, blockLen);
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "producer has failed");
+        OICFree(buffer);
+        return res;
+    }
+
+    if (!coap_add_data(pdu, (unsigned int)blockLen, buffer))
+    {
+        OIC_LOG(ERROR, TAG, "failed to add payload");
+        res = CA_STATUS_FAILED;
+    }
+    OICFree(buffer);
+    return res;
+}
+
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
     size_t payloadLen = 0;
-    CAGetPayloadInfo(sendData, &payloadLen);
+    if (sendData->requestInfo)
+    {
+        payloadLen = CAGetSendPayloadLength(&sendData->requestInfo->info);
+    }
+    else if (sendData->responseInfo)
+    {
+        payloadLen = CAGetSendPayloadLength(&sendData->responseInfo->info);
+    }
 
     // check if message has to be transfered to a block
     size_t maxBlockSize = BLOCK_SIZE(CA_DEFAULT_BLOCK_SIZE);
@@ -846,7 +927,15 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
     // update payload
     size_t fullPayloadLen = 0;
     CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
-    if (fullPayload)
+    CABlockData_t *blockData = CAGetBlockDataFromBlockDataList(blockID);
+    if (cloneData->responseInfo && blockData && CAGetBlockConsumer(blockData))
+    {
+        // the payload was already handed to the consumer block by block
+        OICFree(cloneData->responseInfo->info.payload);
+        cloneData->responseInfo->info.payload = NULL;
+        cloneData->responseInfo->info.payloadSize = 0;
+    }
+    else if (fullPayload)
     {
         CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
         if (CA_STATUS_OK != res)
@@ -1471,12 +1560,8 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
     VERIFY_TRUE((info->payloadSize <= UINT_MAX), TAG, "info->payloadSize");
 
     CAResult_t res = CA_STATUS_OK;
-    unsigned int dataLength = 0;
-    if (info->payload)
-    {
-        dataLength = (unsigned int)info->payloadSize;
-        OIC_LOG_V(DEBUG, TAG, "dataLength - %u", dataLength);
-    }
+    unsigned int dataLength = (unsigned int)CAGetSendPayloadLength(info);
+    OIC_LOG_V(DEBUG, TAG, "dataLength - %u", dataLength);
 
     CABlockDataID_t* blockDataID = CACreateBlockDatablockId(
             (CAToken_t)(*pdu)->transport_hdr->udp.token,
@@ -1493,7 +1578,7 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
     if (CA_REQUEST_ENTITY_INCOMPLETE == repCode)
     {
         OIC_LOG(INFO, TAG, "don't use option");
-        res = CA_STATUS_OK;
+        res = CAMovePDUOptionsToList(*pdu, options);
         goto exit;
     }
 
@@ -1523,6 +1608,12 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
         // in case it is not large data, add option list to pdu.
         if (*options)
         {
+            // the options of the pdu are added again, in order with those of the list.
+            res = CAMovePDUOptionsToList(*pdu, options);
+            if (CA_STATUS_OK != res)
+            {
+                goto exit;
+            }
             for (coap_list_t *opt = *options; opt; opt = opt->next)
             {
                 OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
@@ -1589,6 +1680,13 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
     VERIFY_NON_NULL(options, TAG, "options");
     VERIFY_TRUE((dataLength <= UINT_MAX), TAG, "dataLength");
 
+    // the block options are inserted in order with the options of the pdu.
+    if (CA_STATUS_OK != CAMovePDUOptionsToList(*pdu, options))
+    {
+        OIC_LOG(ERROR, TAG, "failed to move the options");
+        return CA_STATUS_FAILED;
+    }
+
     // get set block data from CABlock list-set.
     coap_block_t *block1 = CAGetBlockOption(blockID, COAP_OPTION_BLOCK1);
     coap_block_t *block2 = CAGetBlockOption(blockID, COAP_OPTION_BLOCK2);
@@ -1642,13 +1740,10 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
             goto exit;
         }
 
-        assert(block2->szx <= UINT8_MAX);
-        if (!coap_add_block(*pdu, (unsigned int)dataLength,
-                            (const unsigned char *) info->payload,
-                            block2->num, (unsigned char)block2->szx))
+        res = CAAddBlockPayload(*pdu, info, dataLength, block2->num, block2->szx);
+        if (CA_STATUS_OK != res)
         {
-            OIC_LOG(ERROR, TAG, "Data length is smaller than the start index");
-            return CA_STATUS_FAILED;
+            return res;
         }
 
         CALogBlockInfo(block2);
@@ -1697,6 +1792,13 @@ CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
     VERIFY_NON_NULL(options, TAG, "options");
     VERIFY_TRUE((dataLength <= UINT_MAX), TAG, "dataLength");
 
+    // the block options are inserted in order with the options of the pdu.
+    if (CA_STATUS_OK != CAMovePDUOptionsToList(*pdu, options))
+    {
+        OIC_LOG(ERROR, TAG, "failed to move the options");
+        return CA_STATUS_FAILED;
+    }
+
     // get set block data from CABlock list-set.
     coap_block_t *block1 = CAGetBlockOption(blockID, COAP_OPTION_BLOCK1);
     if (!block1)
@@ -1740,13 +1842,10 @@ CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
         }
 
         // add the payload data as the block size.
-        assert(block1->szx <= UINT8_MAX);
-        if (!coap_add_block(*pdu, (unsigned int)dataLength,
-                            (const unsigned char *) info->payload, block1->num,
-                            (unsigned char)block1->szx))
+        res = CAAddBlockPayload(*pdu, info, dataLength, block1->num, block1->szx);
+        if (CA_STATUS_OK != res)
         {
-            OIC_LOG(ERROR, TAG, "Data length is smaller than the start index");
-            return CA_STATUS_FAILED;
+            return res;
         }
     }
     else
@@ -2057,7 +2156,23 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
 
     // memory allocation for the received block payload
     size_t prePayloadLen = currData->receivedPayloadLen;
-    if (blockPayload)
+    CABlockStream_t *consumer = (COAP_OPTION_BLOCK2 == blockType) ?
+                                CAGetBlockConsumer(currData) : NULL;
+    if (blockPayload && consumer)
+    {
+        // hand the block over instead of merging it into the total payload
+        CAResult_t res = CAWriteBlockStream(consumer, prePayloadLen,
+                                            (const uint8_t *) blockPayload, blockPayloadLen);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "consumer has failed");
+            return res;
+        }
+
+        currData->receivedPayloadLen += blockPayloadLen;
+        OIC_LOG_V(DEBUG, TAG, "streamed payload len: %" PRIuPTR, currData->receivedPayloadLen);
+    }
+    else if (blockPayload)
     {
         if (currData->payloadLength)
         {
@@ -502,6 +502,23 @@ CAResult_t CAHandleRequestResponse(void)
     return CA_STATUS_OK;
 }
 
+void CARegisterReceivedDataHandler(CAReceivedDataCallback handler, void *context)
+{
+    OIC_LOG(DEBUG, TAG, "CARegisterReceivedDataHandler");
+
+    CASetReceivedDataCallback(handler, context);
+}
+
+bool CAHasPendingRequestResponse(void)
+{
+    if (!g_isInitialized)
+    {
+        return false;
+    }
+
+    return CAHasReceivedData();
+}
+
 CAResult_t CASelectCipherSuite(const uint16_t cipher, CATransportAdapter_t adapter)
 {
     (void)(adapter); // prevent unused-parameter warning when building release variant
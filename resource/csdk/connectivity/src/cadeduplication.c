@@ -0,0 +1,382 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "iotivity_config.h"
+#include <string.h>
+
+#include "cadeduplication.h"
+#include "cacommonutil.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "experimental/logger.h"
+
+#define TAG "OIC_CA_DEDUP"
+
+#define NO_ENTRY (-1)
+
+#define MAX_DEDUPLICATION_CAPACITY (1u << 24)
+
+/*
+ * The key of a message. The keys are zeroed before they are filled, so that they
+ * can be compared and hashed as bytes.
+ */
+typedef struct
+{
+    CATransportAdapter_t adapter;
+    uint32_t ifindex;
+    uint16_t port;
+    uint16_t messageId;
+    uint8_t tokenLength;                /**< 0 for the keys of CADeduplicationReceivedData(). */
+    char token[CA_MAX_TOKEN_LEN];
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< empty for the keys of CADeduplicationReceivedToken(). */
+} CADeduplicationKey_t;
+
+struct CADeduplicationEntry
+{
+    CADeduplicationKey_t key;
+    uint32_t hash;
+    int32_t next;                       /**< next entry of the bucket. */
+    uint64_t expiry;                    /**< microseconds */
+    void *response;
+    uint32_t responseSize;
+};
+
+static uint32_t CAHashKey(const CADeduplicationKey_t *key)
+{
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *) key;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(*key); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static CADeduplicationEntry_t *CAGetEntry(const CADeduplication_t *context, int32_t index)
+{
+    return &context->entries[index];
+}
+
+static void CAFreeResponse(CADeduplication_t *context, CADeduplicationEntry_t *entry)
+{
+    if (entry->response)
+    {
+        context->responseSize -= entry->responseSize;
+        OICFree(entry->response);
+        entry->response = NULL;
+        entry->responseSize = 0;
+    }
+}
+
+/*
+ * Forget the oldest message.
+ */
+static void CARemoveOldestEntry(CADeduplication_t *context)
+{
+    int32_t index = (int32_t) context->first;
+    CADeduplicationEntry_t *entry = CAGetEntry(context, index);
+
+    int32_t *link = &context->buckets[entry->hash & (context->bucketCount - 1)];
+    while (*link != index)
+    {
+        link = &CAGetEntry(context, *link)->next;
+    }
+    *link = entry->next;
+
+    CAFreeResponse(context, entry);
+    context->first = (context->first + 1) % context->config.capacity;
+    context->count--;
+}
+
+static void CARemoveExpiredEntries(CADeduplication_t *context, uint64_t currentTime)
+{
+    while (context->count && CAGetEntry(context, context->first)->expiry <= currentTime)
+    {
+        CARemoveOldestEntry(context);
+    }
+}
+
+static CADeduplicationEntry_t *CAFindEntry(const CADeduplication_t *context,
+                                           const CADeduplicationKey_t *key, uint32_t hash)
+{
+    int32_t index = context->buckets[hash & (context->bucketCount - 1)];
+    while (NO_ENTRY != index)
+    {
+        CADeduplicationEntry_t *entry = CAGetEntry(context, index);
+        if (entry->hash == hash && 0 == memcmp(&entry->key, key, sizeof(*key)))
+        {
+            return entry;
+        }
+        index = entry->next;
+    }
+    return NULL;
+}
+
+static void CAAddEntry(CADeduplication_t *context, const CADeduplicationKey_t *key,
+                       uint32_t hash, uint64_t currentTime)
+{
+    if (context->count == context->config.capacity)
+    {
+        // Bounded: the oldest message is forgotten before it expires.
+        CARemoveOldestEntry(context);
+    }
+
+    int32_t index = (int32_t) ((context->first + context->count) % context->config.capacity);
+    CADeduplicationEntry_t *entry = CAGetEntry(context, index);
+    memcpy(&entry->key, key, sizeof(*key));
+    entry->hash = hash;
+    entry->expiry = currentTime + context->config.lifetime;
+    entry->response = NULL;
+    entry->responseSize = 0;
+
+    int32_t *bucket = &context->buckets[hash & (context->bucketCount - 1)];
+    entry->next = *bucket;
+    *bucket = index;
+    context->count++;
+}
+
+/*
+ * Look for the message of the key, remember it if it is new.
+ */
+static CADeduplicationEntry_t *CACheckKey(CADeduplication_t *context,
+                                          const CADeduplicationKey_t *key,
+                                          uint64_t currentTime)
+{
+    CARemoveExpiredEntries(context, currentTime);
+
+    uint32_t hash = CAHashKey(key);
+    CADeduplicationEntry_t *entry = CAFindEntry(context, key, hash);
+    if (entry)
+    {
+        context->duplicates++;
+        return entry;
+    }
+    CAAddEntry(context, key, hash, currentTime);
+    return NULL;
+}
+
+static void CASetEndpointKey(CADeduplicationKey_t *key, const CAEndpoint_t *endpoint,
+                             uint16_t messageId)
+{
+    memset(key, 0, sizeof(*key));
+    key->adapter = endpoint->adapter;
+    key->ifindex = endpoint->ifindex;
+    key->port = endpoint->port;
+    key->messageId = messageId;
+    OICStrcpy(key->addr, sizeof(key->addr), endpoint->addr);
+}
+
+CAResult_t CADeduplicationInitialize(CADeduplication_t *context,
+                                     const CADeduplicationConfig_t *config)
+{
+    VERIFY_NON_NULL(context, TAG, "context");
+
+    memset(context, 0, sizeof(*context));
+    if (config)
+    {
+        if (0 == config->capacity || MAX_DEDUPLICATION_CAPACITY < config->capacity)
+        {
+            OIC_LOG(ERROR, TAG, "invalid capacity");
+            return CA_STATUS_INVALID_PARAM;
+        }
+        context->config = *config;
+    }
+    else
+    {
+        context->config.capacity = DEFAULT_DEDUPLICATION_CAPACITY;
+        context->config.responseSize = DEFAULT_DEDUPLICATION_RESPONSE_SIZE;
+        context->config.lifetime = (uint64_t) DEFAULT_EXCHANGE_LIFETIME_SEC * 1000000;
+    }
+
+    // Twice as many buckets as entries keeps the chains short.
+    context->bucketCount = 1;
+    while (context->bucketCount < context->config.capacity * 2)
+    {
+        context->bucketCount <<= 1;
+    }
+
+    context->mutex = oc_mutex_new();
+    context->entries = (CADeduplicationEntry_t *) OICCalloc(context->config.capacity,
+                                                            sizeof(CADeduplicationEntry_t));
+    context->buckets = (int32_t *) OICMalloc(context->bucketCount * sizeof(int32_t));
+    if (!context->mutex || !context->entries || !context->buckets)
+    {
+        OIC_LOG(ERROR, TAG, "memory allocation failed");
+        CADeduplicationDestroy(context);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    for (uint32_t i = 0; i < context->bucketCount; i++)
+    {
+        context->buckets[i] = NO_ENTRY;
+    }
+    return CA_STATUS_OK;
+}
+
+bool CADeduplicationReceivedData(CADeduplication_t *context, const CAEndpoint_t *endpoint,
+                                 uint16_t messageId, uint64_t currentTime,
+                                 void **response, uint32_t *responseSize)
+{
+    VERIFY_NON_NULL_RET(context, TAG, "context", false);
+    VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", false);
+    VERIFY_NON_NULL_RET(response, TAG, "response", false);
+    VERIFY_NON_NULL_RET(responseSize, TAG, "responseSize", false);
+
+    *response = NULL;
+    *responseSize = 0;
+    if (!context->mutex)
+    {
+        return false;
+    }
+
+    CADeduplicationKey_t key;
+    CASetEndpointKey(&key, endpoint, messageId);
+
+    oc_mutex_lock(context->mutex);
+    CADeduplicationEntry_t *entry = CACheckKey(context, &key, currentTime);
+    if (entry && entry->response)
+    {
+        *response = OICMalloc(entry->responseSize);
+        if (*response)
+        {
+            memcpy(*response, entry->response, entry->responseSize);
+            *responseSize = entry->responseSize;
+        }
+    }
+    oc_mutex_unlock(context->mutex);
+
+    if (entry)
+    {
+        OIC_LOG_V(INFO, TAG, "duplicate message [%u] from %s:%u", messageId,
+                  endpoint->addr, endpoint->port);
+    }
+    return (NULL != entry);
+}
+
+bool CADeduplicationReceivedToken(CADeduplication_t *context, const CAEndpoint_t *endpoint,
+                                  uint16_t messageId, const CAToken_t token,
+                                  uint8_t tokenLength, uint64_t currentTime)
+{
+    VERIFY_NON_NULL_RET(context, TAG, "context", false);
+    VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", false);
+
+    if (!context->mutex)
+    {
+        return false;
+    }
+
+    if (tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        /*
+         * If token length is more than CA_MAX_TOKEN_LEN,
+         * we compare the first CA_MAX_TOKEN_LEN bytes only.
+         */
+        tokenLength = CA_MAX_TOKEN_LEN;
+    }
+
+    CADeduplicationKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.adapter = endpoint->adapter;
+    key.ifindex = endpoint->ifindex;
+    key.messageId = messageId;
+    if (token && tokenLength)
+    {
+        memcpy(key.token, token, tokenLength);
+        key.tokenLength = tokenLength;
+    }
+
+    oc_mutex_lock(context->mutex);
+    bool duplicate = (NULL != CACheckKey(context, &key, currentTime));
+    oc_mutex_unlock(context->mutex);
+    return duplicate;
+}
+
+CAResult_t CADeduplicationSentResponse(CADeduplication_t *context,
+                                       const CAEndpoint_t *endpoint, uint16_t messageId,
+                                       const void *pdu, uint32_t size)
+{
+    VERIFY_NON_NULL(context, TAG, "context");
+    VERIFY_NON_NULL(endpoint, TAG, "endpoint");
+    VERIFY_NON_NULL(pdu, TAG, "pdu");
+
+    if (!context->mutex || size > context->config.responseSize)
+    {
+        return CA_NOT_SUPPORTED;
+    }
+
+    CADeduplicationKey_t key;
+    CASetEndpointKey(&key, endpoint, messageId);
+
+    CAResult_t res = CA_STATUS_OK;
+    oc_mutex_lock(context->mutex);
+    CADeduplicationEntry_t *entry = CAFindEntry(context, &key, CAHashKey(&key));
+    if (!entry)
+    {
+        // The request is forgotten already, or it is not a piggybacked response.
+        res = CA_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    CAFreeResponse(context, entry);
+
+    // Bounded: the responses of the oldest messages are dropped first.
+    for (uint32_t i = 0; i < context->count
+         && context->responseSize + size > context->config.responseSize; i++)
+    {
+        CAFreeResponse(context, CAGetEntry(context,
+                       (int32_t) ((context->first + i) % context->config.capacity)));
+    }
+
+    entry->response = OICMalloc(size);
+    if (!entry->response)
+    {
+        res = CA_MEMORY_ALLOC_FAILED;
+        goto exit;
+    }
+    memcpy(entry->response, pdu, size);
+    entry->responseSize = size;
+    context->responseSize += size;
+
+exit:
+    oc_mutex_unlock(context->mutex);
+    return res;
+}
+
+CAResult_t CADeduplicationDestroy(CADeduplication_t *context)
+{
+    VERIFY_NON_NULL(context, TAG, "context");
+
+    if (context->entries)
+    {
+        for (uint32_t i = 0; i < context->count; i++)
+        {
+            OICFree(CAGetEntry(context,
+                    (int32_t) ((context->first + i) % context->config.capacity))->response);
+        }
+    }
+    OICFree(context->entries);
+    OICFree(context->buckets);
+    if (context->mutex)
+    {
+        oc_mutex_free(context->mutex);
+    }
+    memset(context, 0, sizeof(*context));
+    return CA_STATUS_OK;
+}
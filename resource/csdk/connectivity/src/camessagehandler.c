@@ -34,10 +34,12 @@
 #include "coap/config.h"
 #endif
 #include "oic_malloc.h"
+#include "oic_time.h"
 #include "canetworkconfigurator.h"
 #include "caadapterutils.h"
 #include "cainterfacecontroller.h"
 #include "caretransmission.h"
+#include "cadeduplication.h"
 #include "oic_string.h"
 #include "caping.h"
 
@@ -50,6 +52,7 @@
 #endif
 
 #include "uqueue.h"
+#include "cablockstream.h"
 #include "cathreadpool.h" /* for thread pool */
 #include "caqueueingthread.h"
 
@@ -70,12 +73,17 @@ static CAQueueingThread_t g_receiveThread;
 #define TAG "OIC_CA_MSG_HANDLE"
 
 static CARetransmission_t g_retransmissionContext;
+static CADeduplication_t g_deduplicationContext;
 
 // handler field
 static CARequestCallback g_requestHandler = NULL;
 static CAResponseCallback g_responseHandler = NULL;
 static CAErrorCallback g_errorHandler = NULL;
 static CANetworkMonitorCallback g_nwMonitorHandler = NULL;
+static CAReceivedDataCallback g_receivedDataHandler = NULL;
+static void *g_receivedDataContext = NULL;
+// Protects the received data handler, which is called with it held
+static oc_mutex g_receivedDataMutex = NULL;
 
 static void CAErrorHandler(const CAEndpoint_t *endpoint,
                            const void *data, size_t dataLen,
@@ -89,8 +97,9 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
                             CAResult_t result);
 
 static void CADestroyData(void *data, uint32_t size);
+static void CAPushReceivedData(CAData_t *data);
 static void CALogPayloadInfo(CAInfo_t *info);
-static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoint, uint16_t id,
+static bool CADropSecondMessage(const CAEndpoint_t *endpoint, uint16_t id,
                                 CAToken_t token, uint8_t tokenLength);
 
 /**
@@ -114,10 +123,73 @@ void CAAddDataToReceiveThread(CAData_t *data)
     VERIFY_NON_NULL_VOID(data, TAG, "data");
 
     // add thread
-    CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+    CAPushReceivedData(data);
 }
 #endif
 
+/**
+ * Add the data to the receive queue and notify the received data handler.
+ * @param[in] data    received data.
+ */
+static void CAPushReceivedData(CAData_t *data)
+{
+    CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+
+    // The handler is called with the lock held, so that its context is not released
+    // by a concurrent unregistration while it runs.
+    oc_mutex_lock(g_receivedDataMutex);
+    if (g_receivedDataHandler)
+    {
+        g_receivedDataHandler(g_receivedDataContext);
+    }
+    oc_mutex_unlock(g_receivedDataMutex);
+}
+
+void CASetReceivedDataCallback(CAReceivedDataCallback handler, void *context)
+{
+    // Before the message handler is initialized, nothing can call the handler.
+    if (g_receivedDataMutex)
+    {
+        oc_mutex_lock(g_receivedDataMutex);
+    }
+    g_receivedDataContext = context;
+    g_receivedDataHandler = handler;
+    if (g_receivedDataMutex)
+    {
+        oc_mutex_unlock(g_receivedDataMutex);
+    }
+}
+
+bool CAHasReceivedData(void)
+{
+    if (NULL == g_receiveThread.threadMutex)
+    {
+        return false;
+    }
+
+    oc_mutex_lock(g_receiveThread.threadMutex);
+    bool pending = (0 != u_queue_get_size(g_receiveThread.dataQueue));
+    oc_mutex_unlock(g_receiveThread.threadMutex);
+    return pending;
+}
+
+/**
+ * Replace a block producer of the data by its whole payload,
+ * for messages which are not sent by blockwise transfer.
+ */
+static CAResult_t CAMaterializeSendData(CAData_t *data)
+{
+    if (data->requestInfo)
+    {
+        return CAMaterializeBlockStream(&data->requestInfo->info);
+    }
+    if (data->responseInfo)
+    {
+        return CAMaterializeBlockStream(&data->responseInfo->info);
+    }
+    return CA_STATUS_OK;
+}
+
 static bool CAIsSelectedNetworkAvailable(void)
 {
     u_arraylist_t *list = CAGetSelectedNetworkList();
@@ -198,7 +270,7 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
         }
 
         if ((reqInfo->info.type != CA_MSG_CONFIRM) &&
-            CADropSecondMessage(&caglobals.ca.requestHistory, endpoint, reqInfo->info.messageId,
+            CADropSecondMessage(endpoint, reqInfo->info.messageId,
                                 reqInfo->info.token, reqInfo->info.tokenLength))
         {
             OIC_LOG(INFO, TAG, "Second Request with same Token, Drop it");
@@ -358,7 +430,7 @@ static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uin
     }
 #endif // WITH_BWT
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAPushReceivedData(cadata);
 }
 
 static void CADestroyData(void *data, uint32_t size)
@@ -593,6 +665,18 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                 return res;
             }
 
+            if (data->responseInfo
+#ifdef WITH_TCP
+                && !CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter)
+#endif
+                && CA_MSG_ACKNOWLEDGE == pdu->transport_hdr->udp.type)
+            {
+                // kept for the duplicates of the request
+                CADeduplicationSentResponse(&g_deduplicationContext, data->remoteEndpoint,
+                                            pdu->transport_hdr->udp.id,
+                                            pdu->transport_hdr, pdu->length);
+            }
+
 #ifdef WITH_TCP
             if (CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter))
             {
@@ -679,7 +763,7 @@ static void CASendThreadProcess(void *threadData)
  * If a second message arrives with the same message ID, token and the other address
  * family, drop it.  Typically, IPv6 beats IPv4, so the IPv4 message is dropped.
  */
-static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, uint16_t id,
+static bool CADropSecondMessage(const CAEndpoint_t *ep, uint16_t id,
                                 CAToken_t token, uint8_t tokenLength)
 {
     if (!ep)
@@ -691,46 +775,69 @@ static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, ui
         return false;
     }
 
-    if (tokenLength > CA_MAX_TOKEN_LEN)
+    if (CADeduplicationReceivedToken(&g_deduplicationContext, ep, id, token, tokenLength,
+                                     OICGetCurrentTime(TIME_IN_US)))
     {
-        /*
-         * If token length is more than CA_MAX_TOKEN_LEN,
-         * we compare the first CA_MAX_TOKEN_LEN bytes only.
-         */
-        tokenLength = CA_MAX_TOKEN_LEN;
+        OIC_LOG_V(INFO, TAG, "IPv%c duplicate message ignored",
+                  ep->flags & CA_IPV6 ? '6' : '4');
+        return true;
     }
+    return false;
+}
 
-    bool ret = false;
-    CATransportFlags_t familyFlags = ep->flags & CA_IPFAMILY_MASK;
-
-    for (size_t i = 0; i < sizeof(history->items) / sizeof(history->items[0]); i++)
+/*
+ * If a request arrives again from the same endpoint with the same message ID, it is a
+ * duplicate (RFC 7252, 4.5). It is not handled again, the piggybacked response sent
+ * to the first copy is sent again. Without one, a confirmable duplicate gets an empty
+ * acknowledgement, so that the client stops retransmitting it.
+ */
+static bool CADropDuplicateRequest(const CAEndpoint_t *ep, const coap_pdu_t *pdu)
+{
+#ifdef WITH_TCP
+    if (CAIsSupportedCoAPOverTCP(ep->adapter))
     {
-        CAHistoryItem_t *item = &(history->items[i]);
-        if (id == item->messageId && tokenLength == item->tokenLength
-            && ep->ifindex == item->ifindex && memcmp(item->token, token, tokenLength) == 0)
-        {
-            OIC_LOG_V(INFO, TAG, "IPv%c duplicate message ignored",
-                      familyFlags & CA_IPV6 ? '6' : '4');
-            ret = true;
-            break;
-        }
+        return false;
     }
+#endif
 
-    history->items[history->nextIndex].flags = familyFlags;
-    history->items[history->nextIndex].messageId = id;
-    history->items[history->nextIndex].ifindex = ep->ifindex;
-    if (token && tokenLength)
+    void *response = NULL;
+    uint32_t responseSize = 0;
+    if (!CADeduplicationReceivedData(&g_deduplicationContext, ep, pdu->transport_hdr->udp.id,
+                                     OICGetCurrentTime(TIME_IN_US), &response, &responseSize))
     {
-        memcpy(history->items[history->nextIndex].token, token, tokenLength);
-        history->items[history->nextIndex].tokenLength = tokenLength;
+        return false;
     }
 
-    if (++history->nextIndex >= HISTORYSIZE)
+    if (response)
+    {
+        OIC_LOG(INFO, TAG, "Duplicate request, send the response again");
+        CAResult_t res = CASendUnicastData(ep, response, responseSize, CA_RESPONSE_DATA);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
+        }
+        OICFree(response);
+    }
+    else if (CA_MSG_CONFIRM == pdu->transport_hdr->udp.type)
+    {
+        OIC_LOG(INFO, TAG, "Duplicate request, acknowledge it");
+        coap_hdr_udp_t ack;
+        memset(&ack, 0, sizeof(ack));
+        ack.version = COAP_DEFAULT_VERSION;
+        ack.type = CA_MSG_ACKNOWLEDGE;
+        ack.code = CA_EMPTY;
+        ack.id = pdu->transport_hdr->udp.id;
+        CAResult_t res = CASendUnicastData(ep, &ack, sizeof(ack), CA_RESPONSE_DATA);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
+        }
+    }
+    else
     {
-        history->nextIndex = 0;
+        OIC_LOG(INFO, TAG, "Duplicate request, drop it");
     }
-
-    return ret;
+    return true;
 }
 
 static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
@@ -774,6 +881,12 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
 
     if (CA_GET == code || CA_POST == code || CA_PUT == code || CA_DELETE == code)
     {
+        if (CADropDuplicateRequest(&(sep->endpoint), pdu))
+        {
+            coap_delete_pdu(pdu);
+            goto exit;
+        }
+
         cadata = CAGenerateHandlerData(&(sep->endpoint), &(sep->identity), pdu, CA_REQUEST_DATA);
         if (!cadata)
         {
@@ -881,7 +994,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         if (CA_NOT_SUPPORTED == res || CA_REQUEST_TIMEOUT == res)
         {
             OIC_LOG(DEBUG, TAG, "this message does not have block option");
-            CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+            CAPushReceivedData(cadata);
         }
         else
         {
@@ -891,7 +1004,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     else
 #endif
     {
-        CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+        CAPushReceivedData(cadata);
     }
 
     coap_delete_pdu(pdu);
@@ -1086,7 +1199,12 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     {
         OIC_LOG(DEBUG, TAG,
                 "This is a loopback message. Transfer it to the receive queue directly");
-        CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+        if (CA_STATUS_OK != CAMaterializeSendData(data))
+        {
+            CADestroyData(data, sizeof(CAData_t));
+            return CA_STATUS_FAILED;
+        }
+        CAPushReceivedData(data);
         return CA_STATUS_OK;
     }
 #ifdef WITH_BWT
@@ -1097,6 +1215,12 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
         if (CA_NOT_SUPPORTED == res)
         {
             OIC_LOG(DEBUG, TAG, "normal msg will be sent");
+            res = CAMaterializeSendData(data);
+            if (CA_STATUS_OK != res)
+            {
+                CADestroyData(data, sizeof(CAData_t));
+                return res;
+            }
             CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
             return CA_STATUS_OK;
         }
@@ -1109,6 +1233,12 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     else
 #endif // WITH_BWT
     {
+        CAResult_t res = CAMaterializeSendData(data);
+        if (CA_STATUS_OK != res)
+        {
+            CADestroyData(data, sizeof(CAData_t));
+            return res;
+        }
         CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
     }
 
@@ -1133,6 +1263,16 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
     CASetErrorHandleCallback(CAErrorHandler);
 
+    if (NULL == g_receivedDataMutex)
+    {
+        g_receivedDataMutex = oc_mutex_new();
+        if (NULL == g_receivedDataMutex)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create received data mutex");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+    }
+
     // create thread pool
     CAResult_t res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
     if (CA_STATUS_OK != res)
@@ -1177,6 +1317,14 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     }
 #endif // SINGLE_HANDLE
 
+    // deduplication initialize
+    res = CADeduplicationInitialize(&g_deduplicationContext, NULL);
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to Initialize Deduplication.");
+        return res;
+    }
+
     // retransmission initialize
     res = CARetransmissionInitialize(&g_retransmissionContext, g_threadPoolHandle,
                                      CASendUnicastData, CATimeoutCallback, NULL);
@@ -1253,11 +1401,16 @@ void CATerminateMessageHandler(void)
     CATerminateBlockWiseTransfer();
 #endif
     CARetransmissionDestroy(&g_retransmissionContext);
+    CADeduplicationDestroy(&g_deduplicationContext);
     CAQueueingThreadDestroy(&g_sendThread);
     CAQueueingThreadDestroy(&g_receiveThread);
 
     // terminate interface adapters by controller
     CATerminateAdapters();
+
+    // Nothing receives data any longer.
+    oc_mutex_free(g_receivedDataMutex);
+    g_receivedDataMutex = NULL;
 }
 
 static void CALogPayloadInfo(CAInfo_t *info)
@@ -1362,7 +1515,7 @@ void CAErrorHandler(const CAEndpoint_t *endpoint,
 
     cadata->errorInfo->result = result;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAPushReceivedData(cadata);
     coap_delete_pdu(pdu);
 
     OIC_LOG(DEBUG, TAG, "CAErrorHandler OUT");
@@ -1411,7 +1564,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     cadata->errorInfo = errorInfo;
     cadata->dataType = CA_ERROR_DATA;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAPushReceivedData(cadata);
     OIC_LOG(DEBUG, TAG, "CASendErrorInfo OUT");
 }
 
@@ -226,6 +226,25 @@ void CAProcessPing()
     oc_mutex_unlock(g_pingInfoListMutex);
 }
 
+uint64_t CAGetNextPingDeadline()
+{
+    if (!g_pingInfoListMutex)
+    {
+        return UINT64_MAX;
+    }
+
+    oc_mutex_lock(g_pingInfoListMutex);
+    // The list is reverse sorted, so the oldest ping message is the last one.
+    PingInfo *oldest = g_pingInfoList;
+    while (oldest && oldest->next)
+    {
+        oldest = oldest->next;
+    }
+    uint64_t deadline = oldest ? oldest->timeStamp + g_timeout : UINT64_MAX;
+    oc_mutex_unlock(g_pingInfoListMutex);
+    return deadline;
+}
+
 void CAPongReceivedCallback(const CAEndpoint_t *endpoint, const CAToken_t token, uint8_t tokenLength)
 {
     OIC_LOG(DEBUG, TAG, "CAPongReceivedCallback IN");
@@ -50,10 +50,78 @@
 #define CA_PDU_MIN_SIZE (4)
 #define CA_ENCODE_BUFFER_SIZE (4)
 
+/* Maximum number of options of a PDU made by CAGeneratePDU(). */
+#define CA_PDU_MAX_OPTIONS (64)
+
+/* Number of options kept on the stack while a PDU is generated, before they are allocated. */
+#define CA_PDU_INLINE_OPTIONS (16)
+
+/* Number of URIs whose options each thread keeps, and their maximum length. */
+#define CA_URI_CACHE_SIZE (16)
+#define CA_URI_CACHE_URI_LENGTH (96)
+#define CA_URI_CACHE_BUFFER_SIZE (160)
+
+#if defined(_MSC_VER)
+#define CA_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define CA_THREAD_LOCAL __thread
+#endif
+
 static const char COAP_URI_HEADER[] = "coap://[::]/";
 
 static char g_chproxyUri[CA_MAX_URI_LENGTH];
 
+/*
+ * An option of a PDU being generated. The value is referenced, except for the
+ * integers encoded into the option itself.
+ */
+typedef struct
+{
+    uint16_t key;
+    uint16_t length;
+    const uint8_t *value;           /**< value, or NULL if it is in encoded. */
+    uint8_t encoded[CA_ENCODE_BUFFER_SIZE];
+} CAPduOption;
+
+/*
+ * The options of a PDU being generated, sorted by key. The options of the same key
+ * keep the order they were added in. The few options of most PDUs and the URI options
+ * of the short URIs are kept inline, so that generating a PDU uses little stack.
+ */
+typedef struct
+{
+    size_t count;
+    size_t capacity;
+    CAPduOption *options;           /**< inlineOptions, or an allocated array. */
+    uint8_t *allocatedUriBuffer;    /**< URI options of a long URI, or NULL. */
+    CAPduOption inlineOptions[CA_PDU_INLINE_OPTIONS];
+    uint8_t inlineUriBuffer[CA_URI_CACHE_BUFFER_SIZE];
+} CAPduOptions;
+
+/*
+ * The URI-Port, URI-Path and URI-Query options of a URI. The URI-Path and URI-Query
+ * options are kept in a buffer in the format of coap_split_path().
+ */
+typedef struct
+{
+    uint16_t port;                  /**< URI-Port, COAP_DEFAULT_PORT if there is none. */
+    uint16_t pathCount;             /**< number of URI-Path options at the start of the buffer. */
+    uint16_t queryCount;            /**< number of URI-Query options after them. */
+    uint16_t size;                  /**< bytes used in the buffer. */
+} CAUriOptions;
+
+#ifdef CA_THREAD_LOCAL
+typedef struct
+{
+    char uri[CA_URI_CACHE_URI_LENGTH];  /**< empty if the entry is unused. */
+    CAUriOptions uriOptions;
+    uint8_t buffer[CA_URI_CACHE_BUFFER_SIZE];
+} CAUriCacheEntry;
+
+/* Options of the URIs the thread sent messages to, indexed by a hash of the URI. */
+static CA_THREAD_LOCAL CAUriCacheEntry t_uriCache[CA_URI_CACHE_SIZE];
+#endif
+
 CAResult_t CASetProxyUri(const char *uri)
 {
     VERIFY_NON_NULL(uri, TAG, "uri");
@@ -112,165 +180,389 @@ CAResult_t CAGetSignalingInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *
     return ret;
 }
 
-coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
-                          coap_list_t **optlist, coap_transport_t *transport)
+static void CAInitPduOptions(CAPduOptions *options)
 {
-    VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
-    VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
-    VERIFY_NON_NULL_RET(optlist, TAG, "optlist", NULL);
-
-    OIC_LOG_V(DEBUG, TAG, "generate pdu for [%d]adapter, [%d]flags",
-              endpoint->adapter, endpoint->flags);
+    options->count = 0;
+    options->capacity = CA_PDU_INLINE_OPTIONS;
+    options->options = options->inlineOptions;
+    options->allocatedUriBuffer = NULL;
+}
 
-    coap_pdu_t *pdu = NULL;
+static void CADestroyPduOptions(CAPduOptions *options)
+{
+    if (options->options != options->inlineOptions)
+    {
+        OICFree(options->options);
+    }
+    OICFree(options->allocatedUriBuffer);
+}
 
-    // RESET have to use only 4byte (empty message)
-    // and ACKNOWLEDGE can use empty message when code is empty.
-    if (CA_MSG_RESET == info->type || (CA_EMPTY == code && CA_MSG_ACKNOWLEDGE == info->type))
+/**
+ * Insert an option of the given key in the options of a PDU, after the options of the
+ * same key.
+ */
+static CAPduOption *CAInsertPduOption(CAPduOptions *options, uint16_t key)
+{
+    if (options->capacity == options->count)
     {
-        if (CA_EMPTY != code)
+        if (CA_PDU_MAX_OPTIONS <= options->capacity)
         {
-            OIC_LOG(ERROR, TAG, "reset is not empty message");
+            OIC_LOG(ERROR, TAG, "too many options");
             return NULL;
         }
 
-        if (info->payloadSize > 0 || info->payload || info->token || info->tokenLength > 0)
+        size_t capacity = options->capacity * 2;
+        if (CA_PDU_MAX_OPTIONS < capacity)
         {
-            OIC_LOG(ERROR, TAG, "Empty message has unnecessary data after messageID");
+            capacity = CA_PDU_MAX_OPTIONS;
+        }
+        CAPduOption *grown = (CAPduOption *) OICMalloc(capacity * sizeof(CAPduOption));
+        if (NULL == grown)
+        {
+            OIC_LOG(ERROR, TAG, "out of memory");
             return NULL;
         }
+        memcpy(grown, options->options, options->count * sizeof(CAPduOption));
+        if (options->options != options->inlineOptions)
+        {
+            OICFree(options->options);
+        }
+        options->options = grown;
+        options->capacity = capacity;
+    }
 
-        OIC_LOG(DEBUG, TAG, "code is empty");
-        if (!(pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, NULL, transport)))
+    size_t index = options->count;
+    while (index > 0 && options->options[index - 1].key > key)
+    {
+        options->options[index] = options->options[index - 1];
+        index--;
+    }
+    options->count++;
+
+    CAPduOption *option = &options->options[index];
+    option->key = key;
+    return option;
+}
+
+/**
+ * Add an option referencing value. Integer values are shrunk to their shortest
+ * encoding, as CACreateNewOptionNode() does.
+ */
+static CAResult_t CAAddPduOption(CAPduOptions *options, uint16_t key, uint32_t length,
+                                 const uint8_t *value)
+{
+    if (UINT16_MAX < length || (length && !value))
+    {
+        OIC_LOG_V(ERROR, TAG, "invalid option [%d]", key);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    CAPduOption *option = CAInsertPduOption(options, key);
+    if (NULL == option)
+    {
+        return CA_STATUS_FAILED;
+    }
+
+    coap_option_def_t *def = coap_opt_def(key);
+    if (NULL != def && coap_is_var_bytes(def))
+    {
+        if (length > def->max)
         {
-            OIC_LOG(ERROR, TAG, "pdu NULL");
-            return NULL;
+            value = &value[length - def->max];
+            length = def->max;
         }
+        option->length = (uint16_t) coap_encode_var_bytes(option->encoded,
+                coap_decode_var_bytes((unsigned char *) value, length));
+        option->value = NULL;
     }
     else
     {
-        if (info->resourceUri)
-        {
-            OIC_LOG_V(DEBUG, TAG, "uri : %s", info->resourceUri);
+        option->length = (uint16_t) length;
+        option->value = value;
+    }
+    return CA_STATUS_OK;
+}
 
-            size_t length = strlen(info->resourceUri);
-            if (CA_MAX_URI_LENGTH < length)
-            {
-                OIC_LOG(ERROR, TAG, "URI len err");
-                return NULL;
-            }
+static CAResult_t CAAddPduUintOption(CAPduOptions *options, uint16_t key, unsigned int value)
+{
+    CAPduOption *option = CAInsertPduOption(options, key);
+    if (NULL == option)
+    {
+        return CA_STATUS_FAILED;
+    }
+    option->length = (uint16_t) coap_encode_var_bytes(option->encoded, value);
+    option->value = NULL;
+    return CA_STATUS_OK;
+}
 
-            size_t uriLength = length + sizeof(COAP_URI_HEADER);
-            char *coapUri = (char *) OICCalloc(1, uriLength);
-            if (NULL == coapUri)
-            {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return NULL;
-            }
-            OICStrcat(coapUri, uriLength, COAP_URI_HEADER);
-            OICStrcat(coapUri, uriLength, info->resourceUri);
+/**
+ * Split a URI of at most CA_MAX_URI_LENGTH into its URI-Port, URI-Path and URI-Query options.
+ */
+static CAResult_t CASplitUri(const char *resourceUri, CAUriOptions *uriOptions,
+                             uint8_t *buffer, size_t bufferSize)
+{
+    // Only the long URIs are copied to the heap.
+    size_t length = strlen(resourceUri);
+    char shortUri[sizeof(COAP_URI_HEADER) + CA_URI_CACHE_URI_LENGTH];
+    size_t coapUriSize = sizeof(COAP_URI_HEADER) + length;
+    char *coapUri = (coapUriSize <= sizeof(shortUri)) ? shortUri : (char *) OICMalloc(coapUriSize);
+    if (NULL == coapUri)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    OICStrcpy(coapUri, coapUriSize, COAP_URI_HEADER);
+    OICStrcat(coapUri, coapUriSize, resourceUri);
 
-            // parsing options in URI
-            CAResult_t res = CAParseURI(coapUri, optlist);
-            if (CA_STATUS_OK != res)
-            {
-                OICFree(coapUri);
-                return NULL;
-            }
+    coap_uri_t uri;
+    coap_split_uri((unsigned char *) coapUri, coapUriSize - 1, &uri);
 
-            OICFree(coapUri);
+    CAResult_t ret = CA_STATUS_FAILED;
+    memset(uriOptions, 0, sizeof(*uriOptions));
+    uriOptions->port = uri.port;
+
+    size_t usedSize = 0;
+    if (uri.path.s && uri.path.length)
+    {
+        // coap_split_path() returns the used size of the buffer in usedSize.
+        usedSize = bufferSize;
+        int res = coap_split_path(uri.path.s, uri.path.length, buffer, &usedSize);
+        if (res <= 0)
+        {
+            OIC_LOG_V(ERROR, TAG, "Problem parsing URI : %d for %d", res, COAP_OPTION_URI_PATH);
+            goto exit;
         }
-        // parsing options in HeadOption
-        CAResult_t ret = CAParseHeadOption(code, info, optlist);
-        if (CA_STATUS_OK != ret)
+        uriOptions->pathCount = (uint16_t) res;
+    }
+
+    if (uri.query.s && uri.query.length)
+    {
+        // coap_split_query() returns the unused size of the buffer in unusedSize.
+        size_t unusedSize = bufferSize - usedSize;
+        int res = coap_split_query(uri.query.s, uri.query.length, buffer + usedSize, &unusedSize);
+        if (res <= 0)
         {
-            return NULL;
+            OIC_LOG_V(ERROR, TAG, "Problem parsing URI : %d for %d", res, COAP_OPTION_URI_QUERY);
+            goto exit;
         }
+        uriOptions->queryCount = (uint16_t) res;
+        usedSize = bufferSize - unusedSize;
+    }
 
-        pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, *optlist, transport);
-        if (NULL == pdu)
+    uriOptions->size = (uint16_t) usedSize;
+    ret = CA_STATUS_OK;
+
+exit:
+    if (coapUri != shortUri)
+    {
+        OICFree(coapUri);
+    }
+    return ret;
+}
+
+static CAResult_t CAAddSplitUriOptions(CAPduOptions *options, const CAUriOptions *uriOptions,
+                                       const uint8_t *buffer)
+{
+    if (COAP_DEFAULT_PORT != uriOptions->port)
+    {
+        CAResult_t res = CAAddPduUintOption(options, COAP_OPTION_URI_PORT, uriOptions->port);
+        if (CA_STATUS_OK != res)
         {
-            OIC_LOG(ERROR, TAG, "pdu NULL");
-            return NULL;
+            return res;
         }
     }
 
-    // pdu print method : coap_show_pdu(pdu);
-    return pdu;
+    size_t offset = 0;
+    for (size_t i = 0; i < (size_t) uriOptions->pathCount + uriOptions->queryCount; i++)
+    {
+        coap_opt_t *opt = (coap_opt_t *) (buffer + offset);
+        size_t optSize = COAP_OPT_SIZE(opt);
+        if (offset + optSize > uriOptions->size)
+        {
+            OIC_LOG(ERROR, TAG, "URI options overflow");
+            return CA_STATUS_INVALID_PARAM;
+        }
+        uint16_t key = (i < uriOptions->pathCount) ? COAP_OPTION_URI_PATH : COAP_OPTION_URI_QUERY;
+        CAResult_t res = CAAddPduOption(options, key, COAP_OPT_LENGTH(opt), COAP_OPT_VALUE(opt));
+        if (CA_STATUS_OK != res)
+        {
+            return res;
+        }
+        offset += optSize;
+    }
+    return CA_STATUS_OK;
 }
 
-coap_pdu_t *CAParsePDU(const char *data, size_t length, uint32_t *outCode,
-                       const CAEndpoint_t *endpoint)
+#ifdef CA_THREAD_LOCAL
+static CAUriCacheEntry *CAGetUriCacheEntry(const char *resourceUri)
 {
-    VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
-    VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const char *c = resourceUri; *c; c++)
+    {
+        hash = (hash ^ (uint8_t) *c) * 16777619u;
+    }
+    return &t_uriCache[hash % CA_URI_CACHE_SIZE];
+}
+#endif
 
-    coap_transport_t transport = COAP_UDP;
-#ifdef WITH_TCP
-    if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
+/**
+ * Add the options of a URI. The options of the short URIs are cached by the calling
+ * thread, the options of the others are split into a buffer of the options.
+ */
+static CAResult_t CAAddUriOptions(CAPduOptions *options, const char *resourceUri)
+{
+    size_t length = strlen(resourceUri);
+#ifdef CA_THREAD_LOCAL
+    CAUriCacheEntry *entry = NULL;
+    if (length < CA_URI_CACHE_URI_LENGTH)
     {
-        transport = coap_get_tcp_header_type_from_initbyte(((unsigned char *)data)[0] >> 4);
+        entry = CAGetUriCacheEntry(resourceUri);
+        if (0 == strcmp(entry->uri, resourceUri))
+        {
+            return CAAddSplitUriOptions(options, &entry->uriOptions, entry->buffer);
+        }
     }
 #endif
 
-    coap_pdu_t *outpdu =
-        coap_pdu_init2(0, 0, ntohs((unsigned short)COAP_INVALID_TID), length, transport);
-    if (NULL == outpdu)
+    if (CA_MAX_URI_LENGTH < length)
     {
-        OIC_LOG(ERROR, TAG, "outpdu is null");
-        OIC_LOG_V(DEBUG, TAG, "data length: %" PRIuPTR, length);
-        return NULL;
+        OIC_LOG(ERROR, TAG, "URI len err");
+        return CA_STATUS_INVALID_PARAM;
     }
 
-    OIC_LOG_V(DEBUG, TAG, "pdu parse-transport type : %d", transport);
+    // The split options take at most twice the length of the URI.
+    uint8_t *buffer = options->inlineUriBuffer;
+    size_t bufferSize = sizeof(options->inlineUriBuffer);
+    if (2 * length > bufferSize)
+    {
+        bufferSize = 2 * length;
+        buffer = (uint8_t *) OICMalloc(bufferSize);
+        if (NULL == buffer)
+        {
+            OIC_LOG(ERROR, TAG, "out of memory");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        options->allocatedUriBuffer = buffer;
+    }
 
-    int ret = coap_pdu_parse2((unsigned char *) data, length, outpdu, transport);
-    OIC_LOG_V(DEBUG, TAG, "pdu parse ret: %d", ret);
-    if (0 >= ret)
+    CAUriOptions uriOptions;
+    CAResult_t res = CASplitUri(resourceUri, &uriOptions, buffer, bufferSize);
+    if (CA_STATUS_OK != res)
     {
-        OIC_LOG(ERROR, TAG, "pdu parse failed");
-        goto exit;
+        return res;
     }
 
-#ifdef WITH_TCP
-    if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
+#ifdef CA_THREAD_LOCAL
+    if (entry && (uriOptions.size <= sizeof(entry->buffer)))
     {
-        OIC_LOG(INFO, TAG, "there is no version info in coap header");
+        OICStrcpy(entry->uri, sizeof(entry->uri), resourceUri);
+        entry->uriOptions = uriOptions;
+        memcpy(entry->buffer, buffer, uriOptions.size);
     }
-    else
 #endif
+    return CAAddSplitUriOptions(options, &uriOptions, buffer);
+}
+
+static void CAAddFormatOptions(CAPduOptions *options, uint16_t formatOption,
+                               CAPayloadFormat_t format, uint16_t versionOption, uint16_t version)
+{
+    unsigned int mediaType = 0;
+    switch (format)
     {
-        if (outpdu->transport_hdr->udp.version != COAP_DEFAULT_VERSION)
-        {
-            OIC_LOG_V(ERROR, TAG, "coap version is not available : %d",
-                      outpdu->transport_hdr->udp.version);
-            goto exit;
-        }
-        if (outpdu->transport_hdr->udp.token_length > CA_MAX_TOKEN_LEN)
+        case CA_FORMAT_APPLICATION_CBOR:
+            mediaType = COAP_MEDIATYPE_APPLICATION_CBOR;
+            break;
+        case CA_FORMAT_APPLICATION_VND_OCF_CBOR:
+            mediaType = COAP_MEDIATYPE_APPLICATION_VND_OCF_CBOR;
+            break;
+        default:
+            OIC_LOG_V(ERROR, TAG, "Format option:[%d] not supported", format);
+            return;
+    }
+    if (CA_STATUS_OK != CAAddPduUintOption(options, formatOption, mediaType))
+    {
+        OIC_LOG(ERROR, TAG, "Format option not inserted in header");
+        return;
+    }
+    if (CA_FORMAT_APPLICATION_VND_OCF_CBOR == format
+        && CA_STATUS_OK != CAAddPduUintOption(options, versionOption, version))
+    {
+        OIC_LOG(ERROR, TAG, "Content version option not inserted in header");
+    }
+}
+
+/**
+ * Add the header options of the info, as CAParseHeadOption() does.
+ */
+static CAResult_t CAAddHeadOptions(CAPduOptions *options, const CAInfo_t *info)
+{
+    OIC_LOG_V(DEBUG, TAG, "parse Head Opt: %d", info->numOptions);
+
+    if (info->numOptions && !info->options)
+    {
+        OIC_LOG(ERROR, TAG, "options is not available");
+        return CA_STATUS_FAILED;
+    }
+
+    for (uint32_t i = 0; i < info->numOptions; i++)
+    {
+        const CAHeaderOption_t *option = &info->options[i];
+        switch (option->optionID)
         {
-            OIC_LOG_V(ERROR, TAG, "token length has been exceed : %d",
-                      outpdu->transport_hdr->udp.token_length);
-            goto exit;
+            case COAP_OPTION_URI_PATH:
+            case COAP_OPTION_URI_QUERY:
+            case COAP_OPTION_ACCEPT:
+            case CA_OPTION_ACCEPT_VERSION:
+            case COAP_OPTION_CONTENT_FORMAT:
+            case CA_OPTION_CONTENT_VERSION:
+                // added from the URI and the formats of the info
+                break;
+            default:
+            {
+                CAResult_t res = CAAddPduOption(options, option->optionID, option->optionLength,
+                                                (const uint8_t *) option->optionData);
+                if (CA_STATUS_OK != res)
+                {
+                    return res;
+                }
+            }
         }
     }
 
-    if (outCode)
+    if (CA_FORMAT_UNDEFINED != info->payloadFormat)
     {
-        (*outCode) = (uint32_t) CA_RESPONSE_CODE(coap_get_code(outpdu, transport));
+        CAAddFormatOptions(options, COAP_OPTION_CONTENT_FORMAT, info->payloadFormat,
+                           CA_OPTION_CONTENT_VERSION, info->payloadVersion);
     }
 
-    return outpdu;
+    if (CA_FORMAT_UNDEFINED != info->acceptFormat)
+    {
+        CAAddFormatOptions(options, COAP_OPTION_ACCEPT, info->acceptFormat,
+                           CA_OPTION_ACCEPT_VERSION, info->acceptVersion);
+    }
 
-exit:
-    OIC_LOG(DEBUG, TAG, "data :");
-    OIC_LOG_BUFFER(DEBUG, TAG,  (const uint8_t *)data, length);
-    coap_delete_pdu(outpdu);
-    return NULL;
+    return CA_STATUS_OK;
 }
 
-coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
-                              const CAEndpoint_t *endpoint, coap_list_t *options,
-                              coap_transport_t *transport)
+/**
+ * Length of the encoded option header and value, RFC 7252 section 3.1. The option
+ * delta and length are followed by 1 extended byte from 13 and 2 from 269.
+ */
+static size_t CAGetOptionEncodedLength(uint16_t delta, uint16_t length)
+{
+    size_t headerLength = 1;
+    headerLength += (delta < 13) ? 0 : ((delta < 269) ? 1 : 2);
+    headerLength += (length < 13) ? 0 : ((length < 269) ? 1 : 2);
+    return headerLength + length;
+}
+
+/**
+ * Encode a PDU with the given options in a single pass. The PDU is allocated with
+ * its exact size, except for the UDP messages which may get their payload in blocks.
+ */
+static coap_pdu_t *CAEncodePDU(code_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
+                               const CAPduOptions *options, coap_transport_t *transport)
 {
     VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
     VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
@@ -278,38 +570,22 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
     VERIFY_TRUE_RET((info->payloadSize <= UINT_MAX), TAG,
                     "info->payloadSize", NULL);
 
+    size_t optionsLength = 0;
+    unsigned short prevOptNumber = 0;
+    for (size_t i = 0; i < options->count; i++)
+    {
+        unsigned short curOptNumber = options->options[i].key;
+        optionsLength += CAGetOptionEncodedLength(curOptNumber - prevOptNumber,
+                                                  options->options[i].length);
+        prevOptNumber = curOptNumber;
+    }
+
+    size_t tokenLength = (info->token && CA_EMPTY != code) ? info->tokenLength : 0;
     size_t length = COAP_MAX_PDU_SIZE;
 #ifdef WITH_TCP
-    size_t msgLength = 0;
+    size_t msgLength = optionsLength;
     if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
     {
-        if (options)
-        {
-            unsigned short prevOptNumber = 0;
-            for (coap_list_t *opt = options; opt; opt = opt->next)
-            {
-                unsigned short curOptNumber = COAP_OPTION_KEY(*(coap_option *) opt->data);
-                if (prevOptNumber > curOptNumber)
-                {
-                    OIC_LOG(ERROR, TAG, "option list is wrong");
-                    return NULL;
-                }
-
-                size_t optValueLen = COAP_OPTION_LENGTH(*(coap_option *) opt->data);
-                size_t optLength = coap_get_opt_header_length(curOptNumber - prevOptNumber, optValueLen);
-                if (0 == optLength)
-                {
-                    OIC_LOG(ERROR, TAG, "Reserved for the Payload marker for the option");
-                    return NULL;
-                }
-                msgLength += optLength;
-                prevOptNumber = curOptNumber;
-                OIC_LOG_V(DEBUG, TAG, "curOptNumber[%d], prevOptNumber[%d], optValueLen[%" PRIuPTR "], "
-                        "optLength[%" PRIuPTR "], msgLength[%" PRIuPTR "]",
-                          curOptNumber, prevOptNumber, optValueLen, optLength, msgLength);
-            }
-        }
-
         if (info->payloadSize > 0)
         {
             msgLength = msgLength + info->payloadSize + PAYLOAD_MARKER;
@@ -317,12 +593,27 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
 
         *transport = coap_get_tcp_header_type_from_size((unsigned int)msgLength);
         length = msgLength + coap_get_tcp_header_length_for_transport(*transport)
-                + info->tokenLength;
+                + tokenLength;
     }
     else
 #endif
     {
         *transport = COAP_UDP;
+#ifdef WITH_BWT
+        // The block-wise transfer adds the payload, possibly a block of it.
+        if (CA_ADAPTER_GATT_BTLE == endpoint->adapter)
+#endif
+        {
+            length = CA_PDU_MIN_SIZE + tokenLength + optionsLength;
+            if ((NULL != info->payload) && (0 < info->payloadSize))
+            {
+                length += 1 + info->payloadSize;
+            }
+            if (COAP_MAX_PDU_SIZE < length)
+            {
+                length = COAP_MAX_PDU_SIZE;
+            }
+        }
     }
 
     coap_pdu_t *pdu = coap_pdu_init2(0, 0,
@@ -368,10 +659,9 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
 
     coap_add_code(pdu, *transport, code);
 
-    if (info->token && CA_EMPTY != code)
+    if (tokenLength)
     {
-        uint32_t tokenLength = info->tokenLength;
-        OIC_LOG_V(DEBUG, TAG, "token info token length: %d, token :", tokenLength);
+        OIC_LOG_V(DEBUG, TAG, "token info token length: %d, token :", (int)tokenLength);
         OIC_LOG_BUFFER(DEBUG, TAG, (const uint8_t *)info->token, tokenLength);
 
         int32_t ret = coap_add_token2(pdu, tokenLength, (unsigned char *)info->token, *transport);
@@ -381,6 +671,20 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
         }
     }
 
+    for (size_t i = 0; i < options->count; i++)
+    {
+        const CAPduOption *option = &options->options[i];
+        if (0 == coap_add_option2(pdu, option->key, option->length,
+                                  option->value ? option->value : option->encoded, *transport))
+        {
+            OIC_LOG(ERROR, TAG, "coap_add_option2 has failed");
+            coap_delete_pdu(pdu);
+            return NULL;
+        }
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "[%d] pdu length after option", pdu->length);
+
 #ifdef WITH_BWT
     if (CA_ADAPTER_GATT_BTLE != endpoint->adapter
 #ifdef WITH_TCP
@@ -388,42 +692,221 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
 #endif
             )
     {
-        // option list will be added in blockwise-transfer
+        // payload will be added in blockwise-transfer
         return pdu;
     }
 #endif
 
-    if (options)
+    if ((NULL != info->payload) && (0 < info->payloadSize))
+    {
+        OIC_LOG(DEBUG, TAG, "payload is added");
+        coap_add_data(pdu, (unsigned int)info->payloadSize,
+                      (const unsigned char*)info->payload);
+    }
+
+    return pdu;
+}
+
+coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
+                          coap_list_t **optlist, coap_transport_t *transport)
+{
+    VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
+    VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
+    VERIFY_NON_NULL_RET(optlist, TAG, "optlist", NULL);
+
+    OIC_LOG_V(DEBUG, TAG, "generate pdu for [%d]adapter, [%d]flags",
+              endpoint->adapter, endpoint->flags);
+
+    coap_pdu_t *pdu = NULL;
+
+    // RESET have to use only 4byte (empty message)
+    // and ACKNOWLEDGE can use empty message when code is empty.
+    if (CA_MSG_RESET == info->type || (CA_EMPTY == code && CA_MSG_ACKNOWLEDGE == info->type))
     {
-        for (coap_list_t *opt = options; opt; opt = opt->next)
+        if (CA_EMPTY != code)
         {
-            OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
-                      COAP_OPTION_DATA(*(coap_option *) opt->data));
+            OIC_LOG(ERROR, TAG, "reset is not empty message");
+            return NULL;
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "[%d] pdu length", pdu->length);
-            if (0 == coap_add_option2(pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
-                                      COAP_OPTION_LENGTH(*(coap_option *) opt->data),
-                                      COAP_OPTION_DATA(*(coap_option *) opt->data), *transport))
-            {
-                OIC_LOG(ERROR, TAG, "coap_add_option2 has failed");
-                coap_delete_pdu(pdu);
-                return NULL;
-            }
+        if (info->payloadSize > 0 || info->payload || info->token || info->tokenLength > 0)
+        {
+            OIC_LOG(ERROR, TAG, "Empty message has unnecessary data after messageID");
+            return NULL;
+        }
+
+        OIC_LOG(DEBUG, TAG, "code is empty");
+        if (!(pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, NULL, transport)))
+        {
+            OIC_LOG(ERROR, TAG, "pdu NULL");
+            return NULL;
         }
     }
+    else
+    {
+        // The options are collected in order, and referenced until the PDU is encoded.
+        // The URI options of the thread's cache or of the options themselves are referenced.
+        CAPduOptions options;
+        CAInitPduOptions(&options);
 
-    OIC_LOG_V(DEBUG, TAG, "[%d] pdu length after option", pdu->length);
+        CAResult_t ret = CA_STATUS_OK;
+        if (info->resourceUri)
+        {
+            OIC_LOG_V(DEBUG, TAG, "uri : %s", info->resourceUri);
+            ret = CAAddUriOptions(&options, info->resourceUri);
+        }
+        // parsing options in HeadOption
+        if (CA_STATUS_OK == ret)
+        {
+            ret = CAAddHeadOptions(&options, info);
+        }
+        if (CA_STATUS_OK == ret)
+        {
+            pdu = CAEncodePDU((code_t) code, info, endpoint, &options, transport);
+        }
+        CADestroyPduOptions(&options);
+        if (NULL == pdu)
+        {
+            OIC_LOG(ERROR, TAG, "pdu NULL");
+            return NULL;
+        }
+    }
 
-    if ((NULL != info->payload) && (0 < info->payloadSize))
+    // pdu print method : coap_show_pdu(pdu);
+    return pdu;
+}
+
+coap_pdu_t *CAParsePDU(const char *data, size_t length, uint32_t *outCode,
+                       const CAEndpoint_t *endpoint)
+{
+    VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
+    VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
+
+    coap_transport_t transport = COAP_UDP;
+#ifdef WITH_TCP
+    if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
     {
-        OIC_LOG(DEBUG, TAG, "payload is added");
-        coap_add_data(pdu, (unsigned int)info->payloadSize,
-                      (const unsigned char*)info->payload);
+        transport = coap_get_tcp_header_type_from_initbyte(((unsigned char *)data)[0] >> 4);
+    }
+#endif
+
+    coap_pdu_t *outpdu =
+        coap_pdu_init2(0, 0, ntohs((unsigned short)COAP_INVALID_TID), length, transport);
+    if (NULL == outpdu)
+    {
+        OIC_LOG(ERROR, TAG, "outpdu is null");
+        OIC_LOG_V(DEBUG, TAG, "data length: %" PRIuPTR, length);
+        return NULL;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "pdu parse-transport type : %d", transport);
+
+    int ret = coap_pdu_parse2((unsigned char *) data, length, outpdu, transport);
+    OIC_LOG_V(DEBUG, TAG, "pdu parse ret: %d", ret);
+    if (0 >= ret)
+    {
+        OIC_LOG(ERROR, TAG, "pdu parse failed");
+        goto exit;
+    }
+
+#ifdef WITH_TCP
+    if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
+    {
+        OIC_LOG(INFO, TAG, "there is no version info in coap header");
+    }
+    else
+#endif
+    {
+        if (outpdu->transport_hdr->udp.version != COAP_DEFAULT_VERSION)
+        {
+            OIC_LOG_V(ERROR, TAG, "coap version is not available : %d",
+                      outpdu->transport_hdr->udp.version);
+            goto exit;
+        }
+        if (outpdu->transport_hdr->udp.token_length > CA_MAX_TOKEN_LEN)
+        {
+            OIC_LOG_V(ERROR, TAG, "token length has been exceed : %d",
+                      outpdu->transport_hdr->udp.token_length);
+            goto exit;
+        }
+    }
+
+    if (outCode)
+    {
+        (*outCode) = (uint32_t) CA_RESPONSE_CODE(coap_get_code(outpdu, transport));
     }
 
+    return outpdu;
+
+exit:
+    OIC_LOG(DEBUG, TAG, "data :");
+    OIC_LOG_BUFFER(DEBUG, TAG,  (const uint8_t *)data, length);
+    coap_delete_pdu(outpdu);
+    return NULL;
+}
+
+coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
+                              const CAEndpoint_t *endpoint, coap_list_t *options,
+                              coap_transport_t *transport)
+{
+    CAPduOptions pduOptions;
+    CAInitPduOptions(&pduOptions);
+    for (coap_list_t *opt = options; opt; opt = opt->next)
+    {
+        // The list is sorted already, so each option is appended. Its value is encoded already.
+        coap_option *option = (coap_option *) opt->data;
+        CAPduOption *pduOption = CAInsertPduOption(&pduOptions, COAP_OPTION_KEY(*option));
+        if (NULL == pduOption)
+        {
+            CADestroyPduOptions(&pduOptions);
+            return NULL;
+        }
+        pduOption->length = (uint16_t) COAP_OPTION_LENGTH(*option);
+        pduOption->value = COAP_OPTION_DATA(*option);
+    }
+    coap_pdu_t *pdu = CAEncodePDU(code, info, endpoint, &pduOptions, transport);
+    CADestroyPduOptions(&pduOptions);
     return pdu;
 }
 
+CAResult_t CAMovePDUOptionsToList(coap_pdu_t *pdu, coap_list_t **optlist)
+{
+    VERIFY_NON_NULL(pdu, TAG, "pdu");
+    VERIFY_NON_NULL(pdu->transport_hdr, TAG, "pdu->transport_hdr");
+    VERIFY_NON_NULL(optlist, TAG, "optlist");
+
+    unsigned int headerLength = CA_PDU_MIN_SIZE + pdu->transport_hdr->udp.token_length;
+    if (pdu->length <= headerLength)
+    {
+        return CA_STATUS_OK;
+    }
+    if (pdu->data)
+    {
+        OIC_LOG(ERROR, TAG, "pdu has a payload");
+        return CA_STATUS_FAILED;
+    }
+
+    coap_opt_iterator_t iter;
+    coap_option_iterator_init(pdu, &iter, COAP_OPT_ALL);
+    coap_opt_t *opt = NULL;
+    while ((opt = coap_option_next(&iter)))
+    {
+        int ret = coap_insert(optlist,
+                              CACreateNewOptionNode(iter.type, coap_opt_length(opt),
+                                                    (const char *) coap_opt_value(opt)),
+                              CAOrderOpts);
+        if (ret <= 0)
+        {
+            return CA_STATUS_INVALID_PARAM;
+        }
+    }
+
+    pdu->length = headerLength;
+    pdu->max_delta = 0;
+    pdu->data = NULL;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
 {
     VERIFY_NON_NULL(uriInfo, TAG, "uriInfo");
@@ -734,7 +1217,6 @@ CAResult_t CAGetOptionCount(coap_opt_iterator_t opt_iter, uint8_t *optionCount)
             && COAP_OPTION_BLOCK1 != opt_iter.type && COAP_OPTION_BLOCK2 != opt_iter.type
             && COAP_OPTION_SIZE1 != opt_iter.type && COAP_OPTION_SIZE2 != opt_iter.type
             && COAP_OPTION_URI_HOST != opt_iter.type && COAP_OPTION_URI_PORT != opt_iter.type
-            && COAP_OPTION_ETAG != opt_iter.type && COAP_OPTION_MAXAGE != opt_iter.type
             && COAP_OPTION_PROXY_SCHEME != opt_iter.type)
         {
             if (*optionCount < UINT8_MAX)
@@ -939,8 +1421,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             }
             else if (COAP_OPTION_URI_PORT == opt_iter.type ||
                     COAP_OPTION_URI_HOST == opt_iter.type ||
-                    COAP_OPTION_ETAG == opt_iter.type ||
-                    COAP_OPTION_MAXAGE == opt_iter.type ||
                     COAP_OPTION_PROXY_SCHEME== opt_iter.type)
             {
                 OIC_LOG_V(INFO, TAG, "option[%d] has an unsupported format [%d]",
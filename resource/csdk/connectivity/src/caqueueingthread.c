@@ -35,6 +35,75 @@
 
 #define TAG PCF("OIC_CA_QING")
 
+static void CAQueueingThreadDestroyMessage(CAQueueingThread_t *thread,
+                                           u_queue_message_t *message)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(message->msg, message->size);
+    }
+    else
+    {
+        OICFree(message->msg);
+    }
+
+    OICFree(message);
+}
+
+/*
+ * Give the queued data to the batch task. Called with the thread mutex locked,
+ * returns with it unlocked.
+ */
+static void CAQueueingThreadProcessBatch(CAQueueingThread_t *thread)
+{
+    size_t count = u_queue_get_size(thread->dataQueue);
+    if (count > thread->maxBatchSize)
+    {
+        count = thread->maxBatchSize;
+    }
+
+    u_queue_message_t **messages =
+        (u_queue_message_t **) OICMalloc(count * (sizeof(u_queue_message_t *) + sizeof(void *)));
+    if (NULL == messages)
+    {
+        // Process one data at a time until memory is available again.
+        count = 1;
+    }
+
+    u_queue_message_t *single = NULL;
+    u_queue_message_t **batch = messages ? messages : &single;
+    void **data = messages ? (void **)(messages + count) : NULL;
+    size_t received = 0;
+    for (; received < count; received++)
+    {
+        batch[received] = u_queue_get_element(thread->dataQueue);
+        if (NULL == batch[received])
+        {
+            break;
+        }
+    }
+    oc_mutex_unlock(thread->threadMutex);
+
+    if (data)
+    {
+        for (size_t i = 0; i < received; i++)
+        {
+            data[i] = batch[i]->msg;
+        }
+        thread->batchTask(data, received);
+    }
+    else if (received)
+    {
+        thread->batchTask(&single->msg, 1);
+    }
+
+    for (size_t i = 0; i < received; i++)
+    {
+        CAQueueingThreadDestroyMessage(thread, batch[i]);
+    }
+    OICFree(messages);
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -71,6 +140,12 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
             continue;
         }
 
+        if (thread->batchTask)
+        {
+            CAQueueingThreadProcessBatch(thread);
+            continue;
+        }
+
         // get data
         u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
         // mutex unlock
@@ -84,16 +159,7 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         thread->threadTask(message->msg);
 
         // free
-        if (NULL != thread->destroy)
-        {
-            thread->destroy(message->msg, message->size);
-        }
-        else
-        {
-            OICFree(message->msg);
-        }
-
-        OICFree(message);
+        CAQueueingThreadDestroyMessage(thread, message);
     }
 
     oc_mutex_lock(thread->threadMutex);
@@ -128,6 +194,8 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     thread->isStop = true;
     thread->threadTask = task;
     thread->destroy = destroy;
+    thread->batchTask = NULL;
+    thread->maxBatchSize = 1;
     if (NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
     {
         goto ERROR_MEM_FAILURE;
@@ -154,6 +222,20 @@ ERROR_MEM_FAILURE:
     return CA_MEMORY_ALLOC_FAILED;
 }
 
+CAResult_t CAQueueingThreadSetBatchTask(CAQueueingThread_t *thread, CAThreadBatchTask task,
+                                        size_t maxBatchSize)
+{
+    if (NULL == thread || 0 == maxBatchSize)
+    {
+        OIC_LOG(ERROR, TAG, "invalid batch parameters..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    thread->batchTask = task;
+    thread->maxBatchSize = maxBatchSize;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -258,16 +340,7 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
         // free
         if (NULL != message)
         {
-            if (NULL != thread->destroy)
-            {
-                thread->destroy(message->msg, message->size);
-            }
-            else
-            {
-                OICFree(message->msg);
-            }
-
-            OICFree(message);
+            CAQueueingThreadDestroyMessage(thread, message);
         }
     }
 
@@ -67,6 +67,7 @@
 #include "caremotehandler.h"
 #include "caprotocolmessage.h"
 #include "oic_malloc.h"
+#include "oic_pool.h"
 #include "oic_time.h"
 #include "experimental/ocrandom.h"
 #include "experimental/logger.h"
@@ -85,6 +86,11 @@ typedef struct
     uint32_t size;                      /**< coap PDU size */
 } CARetransmissionData_t;
 
+/**
+ * Pool of the retransmission data, shared by all the retransmission contexts.
+ */
+static OICPool *g_retransmissionDataPool = NULL;
+
 static const uint64_t USECS_PER_SEC = 1000000;
 static const uint64_t USECS_PER_MSEC = 1000;
 static const uint64_t MSECS_PER_SEC = 1000;
@@ -219,7 +225,7 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
             CAFreeEndpoint(removedData->endpoint);
             OICFree(removedData->pdu);
 
-            OICFree(removedData);
+            OICPoolFree(removedData);
 
             // modify loop value.
             len = u_arraylist_length(context->dataList);
@@ -367,8 +373,9 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     }
 
     // create retransmission data
-    CARetransmissionData_t *retData = (CARetransmissionData_t *) OICCalloc(
-                                          1, sizeof(CARetransmissionData_t));
+    CARetransmissionData_t *retData = (CARetransmissionData_t *) OICPoolCalloc(
+            OICPoolGet(&g_retransmissionDataPool, "CARetransmissionData_t",
+                       sizeof(CARetransmissionData_t)));
 
     if (NULL == retData)
     {
@@ -380,7 +387,7 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     void *pduData = (void *) OICMalloc(size);
     if (NULL == pduData)
     {
-        OICFree(retData);
+        OICPoolFree(retData);
         OIC_LOG(ERROR, TAG, "memory error");
         return CA_MEMORY_ALLOC_FAILED;
     }
@@ -390,7 +397,7 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     CAEndpoint_t *remoteEndpoint = CACloneEndpoint(endpoint);
     if (NULL == remoteEndpoint)
     {
-        OICFree(retData);
+        OICPoolFree(retData);
         OICFree(pduData);
         OIC_LOG(ERROR, TAG, "memory error");
         return CA_MEMORY_ALLOC_FAILED;
@@ -429,7 +436,7 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
             // mutex unlock
             oc_mutex_unlock(context->threadMutex);
 
-            OICFree(retData);
+            OICPoolFree(retData);
             OICFree(pduData);
             OICFree(remoteEndpoint);
             return CA_STATUS_FAILED;
@@ -507,7 +514,7 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
                 if (NULL == retData->pdu)
                 {
                     OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
+                    OICPoolFree(retData);
                     // mutex unlock
                     oc_mutex_unlock(context->threadMutex);
 
@@ -518,7 +525,7 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
                 (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
                 if ((*retransmissionPdu) == NULL)
                 {
-                    OICFree(retData);
+                    OICPoolFree(retData);
                     OIC_LOG(ERROR, TAG, "memory error");
 
                     // mutex unlock
@@ -545,7 +552,7 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
 
             CAFreeEndpoint(removedData->endpoint);
             OICFree(removedData->pdu);
-            OICFree(removedData);
+            OICPoolFree(removedData);
 
             break;
         }
@@ -606,7 +613,7 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
         }
         CAFreeEndpoint(data->endpoint);
         OICFree(data->pdu);
-        OICFree(data);
+        OICPoolFree(data);
     }
     oc_mutex_unlock(context->threadMutex);
 
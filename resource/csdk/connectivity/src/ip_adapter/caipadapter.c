@@ -55,6 +55,11 @@ typedef struct
     bool isMulticast;
 } CAIPData_t;
 
+/**
+ * Maximum number of data given to one call of CAIPSendDataBatch().
+ */
+#define CA_IP_SEND_BATCH_SIZE 32
+
 /**
  * Queue handle for Send Data.
  */
@@ -96,6 +101,8 @@ static void CAIPDeinitializeQueueHandles(void);
 
 static void CAIPSendDataThread(void *threadData);
 
+static void CAIPSendDataBatch(void **threadData, size_t count);
+
 static CAIPData_t *CACreateIPData(const CAEndpoint_t *remoteEndpoint,
                                   const void *data, uint32_t dataLength,
                                   bool isMulticast);
@@ -142,6 +149,9 @@ CAResult_t CAIPInitializeQueueHandles(void)
         return CA_STATUS_FAILED;
     }
 
+    // Send the queued unicast data together, with as few system calls as possible.
+    CAQueueingThreadSetBatchTask(g_sendQueueHandle, CAIPSendDataBatch, CA_IP_SEND_BATCH_SIZE);
+
     return CA_STATUS_OK;
 }
 
@@ -568,6 +578,41 @@ void CAIPSendDataThread(void *threadData)
     }
 }
 
+void CAIPSendDataBatch(void **threadData, size_t count)
+{
+    CAIPUnicastData_t batch[CA_IP_SEND_BATCH_SIZE];
+    size_t batchCount = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CAIPData_t *ipData = (CAIPData_t *) threadData[i];
+        bool isPlainUnicast = ipData && ipData->remoteEndpoint && !ipData->isMulticast;
+#ifdef __WITH_DTLS__
+        isPlainUnicast = isPlainUnicast && !(ipData->remoteEndpoint->flags & CA_SECURE);
+#endif
+        if (!isPlainUnicast || (CA_IP_SEND_BATCH_SIZE == batchCount))
+        {
+            // Keep the order of the data: send the pending unicast data first.
+            CAIPSendUnicastDataBatch(batch, batchCount);
+            batchCount = 0;
+        }
+        if (!isPlainUnicast)
+        {
+            CAIPSendDataThread(ipData);
+            continue;
+        }
+
+        batch[batchCount].endpoint = ipData->remoteEndpoint;
+        batch[batchCount].data = ipData->data;
+        batch[batchCount].dataLength = ipData->dataLen;
+        batchCount++;
+    }
+
+    if (batchCount)
+    {
+        CAIPSendUnicastDataBatch(batch, batchCount);
+    }
+}
 
 CAIPData_t *CACreateIPData(const CAEndpoint_t *remoteEndpoint, const void *data,
                            uint32_t dataLength, bool isMulticast)
@@ -70,6 +70,7 @@
 #include "ca_adapter_net_ssl.h"
 #endif
 #include "octhread.h"
+#include "ocatomic.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 
@@ -114,6 +115,21 @@ static struct in6_addr IPv6MulticastAddressGlb;
  */
 #define RECV_MSG_BUF_LEN 16384
 
+/*
+ * Send several datagrams with one sendmmsg() call, and select the interface of
+ * each multicast datagram with a packet info control message.
+ */
+#if defined(__linux__) && !defined(__ANDROID__) && defined(IP_PKTINFO) && defined(IPV6_PKTINFO)
+#define CA_IP_SENDMMSG
+#endif
+
+#ifdef CA_IP_SENDMMSG
+/*
+ * Maximum number of datagrams given to one sendmmsg() call
+ */
+#define SEND_BATCH_SIZE 32
+#endif
+
 static char *ipv6mcnames[IPv6_DOMAINS] = {
     NULL,
     IPv6_MULTICAST_INT,
@@ -153,6 +169,26 @@ static CAIPErrorHandleCallback g_ipErrorHandler = NULL;
 
 static CAIPPacketReceivedCallback g_packetReceivedCallback = NULL;
 
+/*
+ * Interfaces used to send multicast data. The list is only used by the thread
+ * which sends the data, and is enumerated again after an address change.
+ */
+static u_arraylist_t *g_sendInterfaces = NULL;
+static int32_t g_sendInterfacesGeneration = 0;
+
+/*
+ * Incremented on each address change notification.
+ */
+static volatile int32_t g_interfacesGeneration = 0;
+
+/*
+ * Send statistics since the server was started.
+ */
+static volatile int32_t g_sentDatagrams = 0;
+static volatile int32_t g_sendCalls = 0;
+
+static void CAInvalidateSendInterfaces(void);
+
 static void CAFindReadyMessage(void);
 #if !defined(WSA_WAIT_EVENT_0)
 static void CASelectReturned(fd_set *readFds, int ret);
@@ -280,6 +316,7 @@ static void CASelectReturned(fd_set *readFds, int ret)
 #if NETWORK_INTERFACE_CHANGED_LOGGING
             OIC_LOG_V(DEBUG, TAG, "Netlink event detected");
 #endif
+            CAInvalidateSendInterfaces();
             u_arraylist_t *iflist = CAFindInterfaceChange();
             if (iflist)
             {
@@ -447,6 +484,7 @@ static void CAFindReadyMessage(void)
                     if ((caglobals.ip.addressChangeEvent != WSA_INVALID_EVENT) &&
                         (caglobals.ip.addressChangeEvent == eventArray[eventIndex]))
                     {
+                        CAInvalidateSendInterfaces();
                         u_arraylist_t *iflist = CAFindInterfaceChange();
                         if (iflist)
                         {
@@ -1009,6 +1047,10 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
 
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
+    CAInvalidateSendInterfaces();
+    g_sentDatagrams = 0;
+    g_sendCalls = 0;
+
     res = CAIPStartListenServer();
     if (CA_STATUS_OK != res)
     {
@@ -1057,10 +1099,20 @@ void CAIPStopServer(void)
         CACloseFDs();
     }
     caglobals.ip.started = false;
+
+    // The send queue has been stopped, so the interfaces are no longer used.
+    u_arraylist_destroy(g_sendInterfaces);
+    g_sendInterfaces = NULL;
+
+    CAIPSendStatistics_t statistics;
+    CAIPGetSendStatistics(&statistics);
+    OIC_LOG_V(INFO, TAG, "%" PRIu32 " datagrams sent with %" PRIu32 " system calls",
+              statistics.datagrams, statistics.sendCalls);
 }
 
 void CAWakeUpForChange(void)
 {
+    CAInvalidateSendInterfaces();
 #if !defined(WSA_WAIT_EVENT_0)
     if (caglobals.ip.shutdownFds[1] != -1)
     {
@@ -1343,6 +1395,7 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
 #endif
 #if !defined(_WIN32)
     ssize_t len = sendto(fd, data, dlen, 0, (struct sockaddr *)&sock, socklen);
+    oc_atomic_increment(&g_sendCalls);
     if (OC_SOCKET_ERROR == len)
     {
          // If logging is not defined/enabled.
@@ -1356,6 +1409,7 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
     }
     else
     {
+        oc_atomic_increment(&g_sentDatagrams);
         OIC_LOG_V(INFO, TAG, "%s%s %s sendTo is successful: %zd bytes", secure, cast, fam, len);
         CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
                            len, true, NULL);
@@ -1367,6 +1421,7 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
     do {
         int dataToSend = ((dlen - sent) > INT_MAX) ? INT_MAX : (int)(dlen - sent);
         len = sendto(fd, ((char*)data) + sent, dataToSend, 0, (struct sockaddr *)&sock, socklen);
+        oc_atomic_increment(&g_sendCalls);
         if (OC_SOCKET_ERROR == len)
         {
             err = WSAGetLastError();
@@ -1384,6 +1439,10 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
         else
         {
             sent += len;
+            if (sent == dlen)
+            {
+                oc_atomic_increment(&g_sentDatagrams);
+            }
             if (sent != (size_t)len)
             {
                 OIC_LOG_V(DEBUG, TAG, "%s%s %s sendTo (Partial Send) is successful: "
@@ -1402,6 +1461,141 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
 #endif
 }
 
+#ifdef CA_IP_SENDMMSG
+/*
+ * Datagrams to be sent to one socket by one sendmmsg() call.
+ */
+typedef struct
+{
+    CASocketFd_t fd;
+    const char *cast;
+    const char *fam;
+    size_t count;
+    struct mmsghdr msgs[SEND_BATCH_SIZE];
+    struct iovec iov[SEND_BATCH_SIZE];
+    struct sockaddr_storage addr[SEND_BATCH_SIZE];
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+    } control[SEND_BATCH_SIZE];
+    const CAEndpoint_t *endpoints[SEND_BATCH_SIZE];
+} CASendBatch_t;
+
+static void initSendBatch(CASendBatch_t *batch, CASocketFd_t fd,
+                          const char *cast, const char *fam)
+{
+    batch->fd = fd;
+    batch->cast = cast;
+    batch->fam = fam;
+    batch->count = 0;
+}
+
+static void flushSendBatch(CASendBatch_t *batch)
+{
+    (void)batch->cast;  // eliminates release warning
+    (void)batch->fam;
+
+    if (0 == batch->count)
+    {
+        return;
+    }
+
+    size_t done = 0;
+    while (done < batch->count)
+    {
+        int sent = sendmmsg(batch->fd, batch->msgs + done,
+                            (unsigned int)(batch->count - done), 0);
+        oc_atomic_increment(&g_sendCalls);
+        if (sent <= 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            // Report the datagram which has failed, then send the following ones.
+            const CAEndpoint_t *endpoint = batch->endpoints[done];
+            const struct iovec *iov = &batch->iov[done];
+            if (g_ipErrorHandler)
+            {
+                g_ipErrorHandler(endpoint, iov->iov_base, iov->iov_len, CA_SEND_FAILED);
+            }
+            OIC_LOG_V(ERROR, TAG, "%s %s sendmmsg failed: %s",
+                      batch->cast, batch->fam, strerror(errno));
+            CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                               -1, false, strerror(errno));
+            done++;
+            continue;
+        }
+
+        oc_atomic_add(&g_sentDatagrams, sent);
+        for (int i = 0; i < sent; i++, done++)
+        {
+            const CAEndpoint_t *endpoint = batch->endpoints[done];
+            OIC_LOG_V(INFO, TAG, "%s %s sendmmsg is successful: %u bytes",
+                      batch->cast, batch->fam, batch->msgs[done].msg_len);
+            CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                               batch->msgs[done].msg_len, true, NULL);
+        }
+    }
+    OIC_LOG_V(DEBUG, TAG, "%" PRIuPTR " %s %s datagrams sent", done, batch->cast, batch->fam);
+    batch->count = 0;
+}
+
+/*
+ * Add a datagram to the batch, sent from the interface ifindex if it is not 0.
+ */
+static void addToSendBatch(CASendBatch_t *batch, const CAEndpoint_t *endpoint,
+                           const struct sockaddr_storage *sock,
+                           const void *data, size_t dlen, int ifindex)
+{
+    size_t i = batch->count;
+    memcpy(&batch->addr[i], sock, sizeof(batch->addr[i]));
+    batch->iov[i].iov_base = (void *)data;
+    batch->iov[i].iov_len = dlen;
+    batch->endpoints[i] = endpoint;
+
+    struct msghdr *msg = &batch->msgs[i].msg_hdr;
+    memset(msg, 0, sizeof(*msg));
+    msg->msg_name = &batch->addr[i];
+    msg->msg_namelen = (AF_INET6 == sock->ss_family) ? sizeof(struct sockaddr_in6)
+                                                      : sizeof(struct sockaddr_in);
+    msg->msg_iov = &batch->iov[i];
+    msg->msg_iovlen = 1;
+
+    if (ifindex)
+    {
+        memset(&batch->control[i], 0, sizeof(batch->control[i]));
+        msg->msg_control = batch->control[i].buf;
+        struct cmsghdr *cmsg = &batch->control[i].align;
+        if (AF_INET6 == sock->ss_family)
+        {
+            struct in6_pktinfo info = { .ipi6_ifindex = (unsigned int)ifindex };
+            msg->msg_controllen = CMSG_SPACE(sizeof(info));
+            cmsg->cmsg_level = IPPROTO_IPV6;
+            cmsg->cmsg_type = IPV6_PKTINFO;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(info));
+            memcpy(CMSG_DATA(cmsg), &info, sizeof(info));
+        }
+        else
+        {
+            struct in_pktinfo info = { .ipi_ifindex = ifindex };
+            msg->msg_controllen = CMSG_SPACE(sizeof(info));
+            cmsg->cmsg_level = IPPROTO_IP;
+            cmsg->cmsg_type = IP_PKTINFO;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(info));
+            memcpy(CMSG_DATA(cmsg), &info, sizeof(info));
+        }
+    }
+
+    if (++batch->count == SEND_BATCH_SIZE)
+    {
+        flushSendBatch(batch);
+    }
+}
+#endif // CA_IP_SENDMMSG
+
 static void sendMulticastData6(const u_arraylist_t *iflist,
                                CAEndpoint_t *endpoint,
                                const void *data, size_t datalen)
@@ -1422,6 +1616,13 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), ipv6mcname);
     CASocketFd_t fd = caglobals.ip.u6.fd;
 
+#ifdef CA_IP_SENDMMSG
+    struct sockaddr_storage sock = { .ss_family = 0 };
+    CAConvertNameToAddr(endpoint->addr, endpoint->port, &sock);
+    CASendBatch_t batch;
+    initSendBatch(&batch, fd, "multicast", "ipv6");
+#endif
+
     size_t len = u_arraylist_length(iflist);
     for (size_t i = 0; i < len; i++)
     {
@@ -1440,13 +1641,20 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
         }
 
         int index = ifitem->index;
+#ifdef CA_IP_SENDMMSG
+        addToSendBatch(&batch, endpoint, &sock, data, datalen, index);
+#else
         if (setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, OPTVAL_T(&index), sizeof (index)))
         {
             OIC_LOG_V(ERROR, TAG, "setsockopt6 failed: %s", CAIPS_GET_ERROR);
             return;
         }
         sendData(fd, endpoint, data, datalen, "multicast", "ipv6");
+#endif
     }
+#ifdef CA_IP_SENDMMSG
+    flushSendBatch(&batch);
+#endif
 }
 
 static void sendMulticastData4(const u_arraylist_t *iflist,
@@ -1455,7 +1663,15 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
 {
     VERIFY_NON_NULL_VOID(endpoint, TAG, "endpoint is NULL");
 
-#if defined(USE_IP_MREQN)
+    OICStrcpy(endpoint->addr, sizeof(endpoint->addr), IPv4_MULTICAST);
+    CASocketFd_t fd = caglobals.ip.u4.fd;
+
+#ifdef CA_IP_SENDMMSG
+    struct sockaddr_storage sock = { .ss_family = 0 };
+    CAConvertNameToAddr(endpoint->addr, endpoint->port, &sock);
+    CASendBatch_t batch;
+    initSendBatch(&batch, fd, "multicast", "ipv4");
+#elif defined(USE_IP_MREQN)
     struct ip_mreqn mreq = { .imr_multiaddr = IPv4MulticastAddress,
                              .imr_address.s_addr = htonl(INADDR_ANY),
                              .imr_ifindex = 0};
@@ -1464,9 +1680,6 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
                              .imr_interface = {0}};
 #endif
 
-    OICStrcpy(endpoint->addr, sizeof(endpoint->addr), IPv4_MULTICAST);
-    CASocketFd_t fd = caglobals.ip.u4.fd;
-
     size_t len = u_arraylist_length(iflist);
     for (size_t i = 0; i < len; i++)
     {
@@ -1483,6 +1696,9 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
         {
             continue;
         }
+#ifdef CA_IP_SENDMMSG
+        addToSendBatch(&batch, endpoint, &sock, data, datalen, ifitem->index);
+#else
 #if defined(USE_IP_MREQN)
         mreq.imr_ifindex = ifitem->index;
 #else
@@ -1494,7 +1710,46 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
                     CAIPS_GET_ERROR);
         }
         sendData(fd, endpoint, data, datalen, "multicast", "ipv4");
+#endif
+    }
+#ifdef CA_IP_SENDMMSG
+    flushSendBatch(&batch);
+#endif
+}
+
+static void CAInvalidateSendInterfaces(void)
+{
+    oc_atomic_increment(&g_interfacesGeneration);
+}
+
+/*
+ * Get the interfaces to send multicast data. Unless the list is cached, *owned is
+ * set and the caller must destroy the list.
+ */
+static u_arraylist_t *CAGetSendInterfaces(bool *owned)
+{
+#ifdef _WIN32
+    bool notified = (WSA_INVALID_EVENT != caglobals.ip.addressChangeEvent);
+#else
+    bool notified = (OC_INVALID_SOCKET != caglobals.ip.netlinkFd);
+#endif
+    if (!notified)
+    {
+        // Without address change notifications, the list could silently become stale.
+        *owned = true;
+        return CAIPGetInterfaceInformation(0);
+    }
+
+    // Read the generation first, so that a change during the enumeration is not lost.
+    int32_t generation = oc_atomic_add(&g_interfacesGeneration, 0);
+    if (!g_sendInterfaces || (generation != g_sendInterfacesGeneration))
+    {
+        u_arraylist_destroy(g_sendInterfaces);
+        g_sendInterfaces = CAIPGetInterfaceInformation(0);
+        g_sendInterfacesGeneration = generation;
     }
+    *owned = false;
+    return g_sendInterfaces;
 }
 
 void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
@@ -1509,7 +1764,8 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
     {
         endpoint->port = isSecure ? CA_SECURE_COAP : CA_COAP;
 
-        u_arraylist_t *iflist = CAIPGetInterfaceInformation(0);
+        bool owned = false;
+        u_arraylist_t *iflist = CAGetSendInterfaces(&owned);
         if (!iflist)
         {
             OIC_LOG_V(ERROR, TAG, "get interface info failed: %s", strerror(errno));
@@ -1525,7 +1781,10 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
             sendMulticastData4(iflist, endpoint, data, datalen);
         }
 
-        u_arraylist_destroy(iflist);
+        if (owned)
+        {
+            u_arraylist_destroy(iflist);
+        }
     }
     else
     {
@@ -1554,6 +1813,88 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
     }
 }
 
+void CAIPSendUnicastDataBatch(CAIPUnicastData_t *batch, size_t count)
+{
+    VERIFY_NON_NULL_VOID(batch, TAG, "batch is NULL");
+
+#ifdef CA_IP_SENDMMSG
+    // Consecutive datagrams to the same socket share a sendmmsg() call, and the
+    // datagrams are sent in the order of the caller.
+    CASendBatch_t sendBatch;
+    initSendBatch(&sendBatch, OC_INVALID_SOCKET, "unicast", "ipv6");
+    const struct
+    {
+        CATransportFlags_t flag;
+        bool enabled;
+        CASocketFd_t fd;
+        CASocketFd_t secureFd;
+        const char *fam;
+    } families[] = {
+        { CA_IPV6, caglobals.ip.ipv6enabled, caglobals.ip.u6.fd, caglobals.ip.u6s.fd, "ipv6" },
+        { CA_IPV4, caglobals.ip.ipv4enabled, caglobals.ip.u4.fd, caglobals.ip.u4s.fd, "ipv4" }
+    };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CAEndpoint_t *endpoint = batch[i].endpoint;
+        if (!endpoint || !batch[i].data)
+        {
+            if (g_ipErrorHandler)
+            {
+                g_ipErrorHandler(endpoint, batch[i].data, batch[i].dataLength,
+                                 CA_STATUS_INVALID_PARAM);
+            }
+            continue;
+        }
+
+        bool isSecure = (endpoint->flags & CA_SECURE) != 0;
+        if (!endpoint->port)    // unicast discovery
+        {
+            endpoint->port = isSecure ? CA_SECURE_COAP : CA_COAP;
+        }
+
+        struct sockaddr_storage sock = { .ss_family = 0 };
+        CAConvertNameToAddr(endpoint->addr, endpoint->port, &sock);
+
+        for (size_t f = 0; f < sizeof(families) / sizeof(families[0]); f++)
+        {
+            if (!families[f].enabled || !(endpoint->flags & families[f].flag))
+            {
+                continue;
+            }
+
+            CASocketFd_t fd = families[f].fd;
+#ifdef __WITH_DTLS__
+            if (isSecure)
+            {
+                fd = families[f].secureFd;
+            }
+#endif
+            if (fd != sendBatch.fd)
+            {
+                flushSendBatch(&sendBatch);
+                initSendBatch(&sendBatch, fd, "unicast", families[f].fam);
+            }
+            addToSendBatch(&sendBatch, endpoint, &sock, batch[i].data, batch[i].dataLength, 0);
+        }
+    }
+    flushSendBatch(&sendBatch);
+#else
+    for (size_t i = 0; i < count; i++)
+    {
+        CAIPSendData(batch[i].endpoint, batch[i].data, batch[i].dataLength, false);
+    }
+#endif
+}
+
+void CAIPGetSendStatistics(CAIPSendStatistics_t *statistics)
+{
+    VERIFY_NON_NULL_VOID(statistics, TAG, "statistics is NULL");
+
+    statistics->datagrams = (uint32_t)oc_atomic_add(&g_sentDatagrams, 0);
+    statistics->sendCalls = (uint32_t)oc_atomic_add(&g_sendCalls, 0);
+}
+
 CAResult_t CAGetIPInterfaceInformation(CAEndpoint_t **info, size_t *size)
 {
     VERIFY_NON_NULL(info, TAG, "info is NULL");
@@ -28,8 +28,58 @@
 #include "cautilinterface.h"
 #include "cacommon.h"
 #include "cablockwisetransfer.h"
+#include "cablockstream.h"
 
 #define LARGE_PAYLOAD_LENGTH    1024
+#define STREAM_PAYLOAD_LENGTH   (2 * LARGE_PAYLOAD_LENGTH + 100)
+
+typedef struct
+{
+    size_t producedLength;
+    size_t consumedLength;
+    size_t nextOffset;
+    bool deleted;
+} BlockStreamTestContext;
+
+static uint8_t StreamByteAt(size_t offset)
+{
+    return (uint8_t) (offset % 251);
+}
+
+static CAResult_t TestBlockProducer(void *context, size_t offset, uint8_t *buffer, size_t size)
+{
+    BlockStreamTestContext *ctx = (BlockStreamTestContext *) context;
+    for (size_t i = 0; i < size; i++)
+    {
+        buffer[i] = StreamByteAt(offset + i);
+    }
+    ctx->producedLength += size;
+    return CA_STATUS_OK;
+}
+
+static CAResult_t TestBlockConsumer(void *context, size_t offset, const uint8_t *data, size_t size)
+{
+    BlockStreamTestContext *ctx = (BlockStreamTestContext *) context;
+    if (offset != ctx->nextOffset)
+    {
+        return CA_STATUS_FAILED;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        if (data[i] != StreamByteAt(offset + i))
+        {
+            return CA_STATUS_FAILED;
+        }
+    }
+    ctx->nextOffset += size;
+    ctx->consumedLength += size;
+    return CA_STATUS_OK;
+}
+
+static void TestBlockStreamDeleter(void *context)
+{
+    ((BlockStreamTestContext *) context)->deleted = true;
+}
 
 class CABlockTransferTests : public testing::Test {
     protected:
@@ -770,3 +820,174 @@ TEST_F(CABlockTransferTests, CAUpdatePayloadToCADataWithResponse)
     CADestroyToken(tempToken);
     CADestroyEndpoint(tempRep);
 }
+
+TEST_F(CABlockTransferTests, CABlockProducerReadAndRelease)
+{
+    BlockStreamTestContext ctx = { 0, 0, 0, false };
+    CABlockStream_t *stream = CACreateBlockProducer(STREAM_PAYLOAD_LENGTH, TestBlockProducer,
+                                                    &ctx, TestBlockStreamDeleter);
+    ASSERT_TRUE(stream != NULL);
+    EXPECT_TRUE(CAIsBlockProducer(stream));
+    EXPECT_FALSE(CAIsBlockConsumer(stream));
+    EXPECT_EQ((size_t) STREAM_PAYLOAD_LENGTH, CAGetBlockStreamLength(stream));
+
+    uint8_t buffer[16];
+    EXPECT_EQ(CA_STATUS_OK, CAReadBlockStream(stream, 100, buffer, sizeof(buffer)));
+    EXPECT_EQ(StreamByteAt(100), buffer[0]);
+    EXPECT_EQ(StreamByteAt(115), buffer[15]);
+
+    // reading past the end of the payload is refused
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM,
+              CAReadBlockStream(stream, STREAM_PAYLOAD_LENGTH - 8, buffer, sizeof(buffer)));
+
+    CARetainBlockStream(stream);
+    CAReleaseBlockStream(stream);
+    EXPECT_FALSE(ctx.deleted);
+    CAReleaseBlockStream(stream);
+    EXPECT_TRUE(ctx.deleted);
+}
+
+TEST_F(CABlockTransferTests, CAMaterializeBlockStreamTest)
+{
+    BlockStreamTestContext ctx = { 0, 0, 0, false };
+
+    CAInfo_t info;
+    memset(&info, 0, sizeof(CAInfo_t));
+    info.blockStream = CACreateBlockProducer(STREAM_PAYLOAD_LENGTH, TestBlockProducer,
+                                             &ctx, TestBlockStreamDeleter);
+    ASSERT_TRUE(info.blockStream != NULL);
+
+    EXPECT_EQ(CA_STATUS_OK, CAMaterializeBlockStream(&info));
+    EXPECT_TRUE(info.blockStream == NULL);
+    EXPECT_TRUE(ctx.deleted);
+    ASSERT_EQ((size_t) STREAM_PAYLOAD_LENGTH, info.payloadSize);
+    EXPECT_EQ(StreamByteAt(STREAM_PAYLOAD_LENGTH - 1), info.payload[STREAM_PAYLOAD_LENGTH - 1]);
+
+    free(info.payload);
+}
+
+// response and block option2 with a producer
+TEST_F(CABlockTransferTests, CAAddBlockOption2WithProducer)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    BlockStreamTestContext ctx = { 0, 0, 0, false };
+
+    CAInfo_t responseData;
+    memset(&responseData, 0, sizeof(CAInfo_t));
+    responseData.token = tempToken;
+    responseData.tokenLength = CA_MAX_TOKEN_LEN;
+    responseData.type = CA_MSG_NONCONFIRM;
+    responseData.messageId = 1;
+    responseData.blockStream = CACreateBlockProducer(STREAM_PAYLOAD_LENGTH, TestBlockProducer,
+                                                     &ctx, TestBlockStreamDeleter);
+    ASSERT_TRUE(responseData.blockStream != NULL);
+
+    pdu = CAGeneratePDU(CA_CONTENT, &responseData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    EXPECT_TRUE(cadata != NULL);
+
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(currData != NULL);
+
+    if (currData)
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAUpdateBlockOptionType(currData->blockDataId,
+                                                        COAP_OPTION_BLOCK2));
+
+        EXPECT_EQ(CA_STATUS_OK, CAAddBlockOption2(&pdu, &responseData,
+                                                  STREAM_PAYLOAD_LENGTH,
+                                                  currData->blockDataId, &options));
+
+        // only the first block is produced
+        EXPECT_EQ((size_t) LARGE_PAYLOAD_LENGTH, ctx.producedLength);
+
+        size_t dataSize = 0;
+        uint8_t *data = NULL;
+        EXPECT_TRUE(coap_get_data(pdu, &dataSize, &data));
+        EXPECT_EQ((size_t) LARGE_PAYLOAD_LENGTH, dataSize);
+        EXPECT_EQ(StreamByteAt(LARGE_PAYLOAD_LENGTH - 1), data[LARGE_PAYLOAD_LENGTH - 1]);
+
+        CARemoveBlockDataFromList(currData->blockDataId);
+    }
+
+    CADestroyDataSet(cadata);
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CAReleaseBlockStream(responseData.blockStream);
+    EXPECT_TRUE(ctx.deleted);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+// received block option2 response handed over to a consumer
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataWithConsumer)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    BlockStreamTestContext ctx = { 0, 0, 0, false };
+
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = CA_GET;
+    requestInfo.info.type = CA_MSG_CONFIRM;
+    requestInfo.info.blockStream = CACreateBlockConsumer(TestBlockConsumer, &ctx,
+                                                         TestBlockStreamDeleter);
+    ASSERT_TRUE(requestInfo.info.blockStream != NULL);
+
+    CAData_t sentData;
+    memset(&sentData, 0, sizeof(CAData_t));
+    sentData.type = SEND_TYPE_UNICAST;
+    sentData.remoteEndpoint = tempRep;
+    sentData.requestInfo = &requestInfo;
+    sentData.dataType = CA_REQUEST_DATA;
+
+    CABlockData_t currData;
+    memset(&currData, 0, sizeof(CABlockData_t));
+    currData.sentData = &sentData;
+    currData.block2.szx = CA_DEFAULT_BLOCK_SIZE;
+
+    uint8_t block[LARGE_PAYLOAD_LENGTH];
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.payload = block;
+    responseInfo.info.payloadSize = sizeof(block);
+
+    CAData_t receivedData;
+    memset(&receivedData, 0, sizeof(CAData_t));
+    receivedData.remoteEndpoint = tempRep;
+    receivedData.responseInfo = &responseInfo;
+    receivedData.dataType = CA_RESPONSE_DATA;
+
+    for (size_t num = 0; num < 2; num++)
+    {
+        for (size_t i = 0; i < sizeof(block); i++)
+        {
+            block[i] = StreamByteAt(num * sizeof(block) + i);
+        }
+        EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(&currData, &receivedData, CA_BLOCK_UNKNOWN,
+                                                    false, COAP_OPTION_BLOCK2));
+    }
+
+    // the blocks were streamed, not reassembled
+    EXPECT_TRUE(currData.payload == NULL);
+    EXPECT_EQ(2 * sizeof(block), currData.receivedPayloadLen);
+    EXPECT_EQ(2 * sizeof(block), ctx.consumedLength);
+
+    CAReleaseBlockStream(requestInfo.info.blockStream);
+    EXPECT_TRUE(ctx.deleted);
+    CADestroyEndpoint(tempRep);
+}
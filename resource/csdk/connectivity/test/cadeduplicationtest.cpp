@@ -0,0 +1,251 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "cadeduplication.h"
+#include "oic_malloc.h"
+
+#define STORM_ENDPOINTS 200
+#define STORM_MESSAGES 50
+#define STORM_COPIES 5
+#define STORM_THREADS 4
+
+static void InitEndpoint(CAEndpoint_t *endpoint, const char *addr, uint16_t port)
+{
+    memset(endpoint, 0, sizeof(CAEndpoint_t));
+    endpoint->adapter = CA_ADAPTER_IP;
+    endpoint->flags = CA_IPV4;
+    endpoint->port = port;
+    endpoint->ifindex = 2;
+    strncpy(endpoint->addr, addr, sizeof(endpoint->addr) - 1);
+}
+
+static bool Received(CADeduplication_t *context, const CAEndpoint_t *endpoint,
+                     uint16_t messageId, uint64_t currentTime)
+{
+    void *response = NULL;
+    uint32_t responseSize = 0;
+    bool duplicate = CADeduplicationReceivedData(context, endpoint, messageId, currentTime,
+                                                 &response, &responseSize);
+    OICFree(response);
+    return duplicate;
+}
+
+TEST(CADeduplication, SameEndpointAndMessageId)
+{
+    CADeduplication_t context;
+    ASSERT_EQ(CA_STATUS_OK, CADeduplicationInitialize(&context, NULL));
+
+    CAEndpoint_t endpoint;
+    InitEndpoint(&endpoint, "192.168.1.10", 5683);
+    EXPECT_FALSE(Received(&context, &endpoint, 100, 0));
+    EXPECT_TRUE(Received(&context, &endpoint, 100, 1000));
+    EXPECT_FALSE(Received(&context, &endpoint, 101, 1000));
+
+    CAEndpoint_t other;
+    InitEndpoint(&other, "192.168.1.10", 5684);
+    EXPECT_FALSE(Received(&context, &other, 100, 1000));
+    InitEndpoint(&other, "192.168.1.11", 5683);
+    EXPECT_FALSE(Received(&context, &other, 100, 1000));
+    other.adapter = CA_ADAPTER_GATT_BTLE;
+    EXPECT_FALSE(Received(&context, &other, 100, 1000));
+
+    EXPECT_EQ(1u, context.duplicates);
+    EXPECT_EQ(CA_STATUS_OK, CADeduplicationDestroy(&context));
+}
+
+TEST(CADeduplication, Expiry)
+{
+    CADeduplicationConfig_t config = { 16, 1024, 1000 };
+    CADeduplication_t context;
+    ASSERT_EQ(CA_STATUS_OK, CADeduplicationInitialize(&context, &config));
+
+    CAEndpoint_t endpoint;
+    InitEndpoint(&endpoint, "fe80::1", 5683);
+    EXPECT_FALSE(Received(&context, &endpoint, 7, 0));
+    EXPECT_TRUE(Received(&context, &endpoint, 7, 999));
+
+    // The message is forgotten after its lifetime, and remembered again.
+    EXPECT_FALSE(Received(&context, &endpoint, 7, 1000));
+    EXPECT_TRUE(Received(&context, &endpoint, 7, 1500));
+    EXPECT_EQ(1u, context.count);
+
+    CADeduplicationDestroy(&context);
+}
+
+TEST(CADeduplication, Capacity)
+{
+    CADeduplicationConfig_t config = { 8, 1024, 1000000 };
+    CADeduplication_t context;
+    ASSERT_EQ(CA_STATUS_OK, CADeduplicationInitialize(&context, &config));
+
+    CAEndpoint_t endpoint;
+    InitEndpoint(&endpoint, "192.168.1.10", 5683);
+    for (uint16_t id = 0; id < 9; id++)
+    {
+        EXPECT_FALSE(Received(&context, &endpoint, id, 0));
+    }
+    EXPECT_EQ(8u, context.count);
+
+    // The oldest message is forgotten first.
+    EXPECT_TRUE(Received(&context, &endpoint, 8, 0));
+    EXPECT_TRUE(Received(&context, &endpoint, 1, 0));
+    EXPECT_FALSE(Received(&context, &endpoint, 0, 0));
+
+    CADeduplicationDestroy(&context);
+
+    config.capacity = 0;
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CADeduplicationInitialize(&context, &config));
+}
+
+TEST(CADeduplication, CachedResponse)
+{
+    CADeduplicationConfig_t config = { 16, 100, 1000000 };
+    CADeduplication_t context;
+    ASSERT_EQ(CA_STATUS_OK, CADeduplicationInitialize(&context, &config));
+
+    CAEndpoint_t endpoint;
+    InitEndpoint(&endpoint, "192.168.1.10", 5683);
+    uint8_t first[60];
+    memset(first, 1, sizeof(first));
+    uint8_t second[60];
+    memset(second, 2, sizeof(second));
+
+    // Only the responses to remembered requests are kept.
+    EXPECT_EQ(CA_NOT_SUPPORTED, CADeduplicationSentResponse(&context, &endpoint, 1,
+                                                            first, sizeof(first)));
+
+    EXPECT_FALSE(Received(&context, &endpoint, 1, 0));
+    EXPECT_EQ(CA_STATUS_OK, CADeduplicationSentResponse(&context, &endpoint, 1,
+                                                        first, sizeof(first)));
+    void *response = NULL;
+    uint32_t responseSize = 0;
+    EXPECT_TRUE(CADeduplicationReceivedData(&context, &endpoint, 1, 10,
+                                            &response, &responseSize));
+    ASSERT_TRUE(NULL != response);
+    EXPECT_EQ(sizeof(first), responseSize);
+    EXPECT_EQ(0, memcmp(first, response, sizeof(first)));
+    OICFree(response);
+
+    // The responses fit in the configured size, the oldest ones are dropped.
+    EXPECT_FALSE(Received(&context, &endpoint, 2, 20));
+    EXPECT_EQ(CA_STATUS_OK, CADeduplicationSentResponse(&context, &endpoint, 2,
+                                                        second, sizeof(second)));
+    EXPECT_EQ(sizeof(second), context.responseSize);
+    EXPECT_TRUE(CADeduplicationReceivedData(&context, &endpoint, 1, 30,
+                                            &response, &responseSize));
+    EXPECT_TRUE(NULL == response);
+    EXPECT_TRUE(CADeduplicationReceivedData(&context, &endpoint, 2, 30,
+                                            &response, &responseSize));
+    ASSERT_TRUE(NULL != response);
+    EXPECT_EQ(0, memcmp(second, response, sizeof(second)));
+    OICFree(response);
+
+    uint8_t large[101] = { 0 };
+    EXPECT_FALSE(Received(&context, &endpoint, 3, 40));
+    EXPECT_EQ(CA_NOT_SUPPORTED, CADeduplicationSentResponse(&context, &endpoint, 3,
+                                                            large, sizeof(large)));
+
+    CADeduplicationDestroy(&context);
+}
+
+TEST(CADeduplication, TokenFromOtherFamily)
+{
+    CADeduplication_t context;
+    ASSERT_EQ(CA_STATUS_OK, CADeduplicationInitialize(&context, NULL));
+
+    CAEndpoint_t ipv6;
+    InitEndpoint(&ipv6, "fe80::1", 5683);
+    ipv6.flags = CA_IPV6;
+    CAEndpoint_t ipv4;
+    InitEndpoint(&ipv4, "192.168.1.10", 5683);
+    char token[] = "12345678";
+
+    EXPECT_FALSE(CADeduplicationReceivedToken(&context, &ipv6, 42, token, 8, 0));
+    EXPECT_TRUE(CADeduplicationReceivedToken(&context, &ipv4, 42, token, 8, 0));
+
+    // Another token, or another interface.
+    char otherToken[] = "87654321";
+    EXPECT_FALSE(CADeduplicationReceivedToken(&context, &ipv4, 42, otherToken, 8, 0));
+    ipv4.ifindex = 3;
+    EXPECT_FALSE(CADeduplicationReceivedToken(&context, &ipv4, 42, token, 8, 0));
+
+    CADeduplicationDestroy(&context);
+}
+
+/*
+ * Each message of many endpoints arrives several times, from several threads. Each
+ * message is handled once.
+ */
+TEST(CADeduplication, DuplicateStorm)
+{
+    // Enough messages are remembered to catch the copies however the threads interleave.
+    CADeduplicationConfig_t config = { STORM_ENDPOINTS * STORM_MESSAGES, 1024, 1000000 };
+    CADeduplication_t context;
+    ASSERT_EQ(CA_STATUS_OK, CADeduplicationInitialize(&context, &config));
+
+    std::vector<CAEndpoint_t> endpoints(STORM_ENDPOINTS);
+    for (size_t i = 0; i < endpoints.size(); i++)
+    {
+        char addr[32];
+        snprintf(addr, sizeof(addr), "10.0.%u.%u", (unsigned) (i / 250), (unsigned) (i % 250));
+        InitEndpoint(&endpoints[i], addr, 5683);
+    }
+
+    std::atomic<uint32_t> handled(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < STORM_THREADS; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            for (int m = 0; m < STORM_MESSAGES; m++)
+            {
+                for (int copy = 0; copy < STORM_COPIES; copy++)
+                {
+                    for (size_t e = t; e < endpoints.size() + t; e++)
+                    {
+                        const CAEndpoint_t *endpoint = &endpoints[e % endpoints.size()];
+                        if (!Received(&context, endpoint, (uint16_t) m, 0))
+                        {
+                            handled++;
+                        }
+                    }
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    EXPECT_EQ((uint32_t) (STORM_ENDPOINTS * STORM_MESSAGES), handled.load());
+    EXPECT_EQ((uint32_t) (STORM_ENDPOINTS * STORM_MESSAGES * (STORM_COPIES * STORM_THREADS - 1)),
+              context.duplicates);
+
+    CADeduplicationDestroy(&context);
+}
@@ -24,6 +24,8 @@
 #endif
 
 #include <stdio.h>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -261,3 +263,226 @@ TEST(CAProtocolMessage, CAGetInfoFromPDU)
     coap_delete_list(options);
     coap_delete_pdu(pdu);
 }
+
+/**
+ * Append a CoAP option (RFC 7252, section 3.1) of the given delta to the expected bytes.
+ */
+static void AppendOption(std::vector<uint8_t> &bytes, uint16_t delta, const std::string &value)
+{
+    uint8_t header = 0;
+    std::vector<uint8_t> extended;
+    if (delta < 13)
+    {
+        header = (uint8_t)(delta << 4);
+    }
+    else if (delta < 269)
+    {
+        header = 13 << 4;
+        extended.push_back((uint8_t)(delta - 13));
+    }
+    else
+    {
+        header = 14 << 4;
+        extended.push_back((uint8_t)((delta - 269) >> 8));
+        extended.push_back((uint8_t)(delta - 269));
+    }
+    if (value.size() < 13)
+    {
+        header |= (uint8_t)value.size();
+    }
+    else
+    {
+        header |= 13;
+        extended.push_back((uint8_t)(value.size() - 13));
+    }
+    bytes.push_back(header);
+    bytes.insert(bytes.end(), extended.begin(), extended.end());
+    bytes.insert(bytes.end(), value.begin(), value.end());
+}
+
+/**
+ * Expect CAGeneratePDU() to encode exactly the given bytes. The message ID of a UDP pdu
+ * is compared apart, as it is kept in host order.
+ */
+static void ExpectPDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
+                      std::vector<uint8_t> expected)
+{
+    coap_list_t *options = NULL;
+    coap_transport_t transport = COAP_UDP;
+    coap_pdu_t *pdu = CAGeneratePDU(code, info, endpoint, &options, &transport);
+    ASSERT_TRUE(NULL != pdu);
+    EXPECT_TRUE(NULL == options);
+
+    if (COAP_UDP == transport)
+    {
+        EXPECT_EQ(info->messageId, pdu->transport_hdr->udp.id);
+        memcpy(&expected[2], (uint8_t *)pdu->transport_hdr + 2, 2);
+    }
+    ASSERT_EQ(expected.size(), pdu->length);
+    EXPECT_EQ(0, memcmp(expected.data(), pdu->transport_hdr, pdu->length));
+
+    coap_delete_pdu(pdu);
+}
+
+static void InitPDUInfo(CAInfo_t *info, CAHeaderOption_t *headerOption)
+{
+    memset(info, 0, sizeof(CAInfo_t));
+    info->type = CA_MSG_CONFIRM;
+    info->messageId = 0x1234;
+    info->token = (CAToken_t)"token";
+    info->tokenLength = (uint8_t)strlen(info->token);
+    info->resourceUri = (CAURI_t)"/a/light/0?if=oic.if.baseline&rt=core.light";
+    info->payload = (CAPayload_t)"requestPayload";
+    info->payloadSize = strlen((const char *)info->payload);
+    info->payloadFormat = CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    info->payloadVersion = 2048;
+    info->acceptFormat = CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    info->acceptVersion = 2048;
+
+    memset(headerOption, 0, sizeof(CAHeaderOption_t));
+    headerOption->protocolID = CA_COAP_ID;
+    headerOption->optionID = COAP_OPTION_OBSERVE;
+    headerOption->optionLength = 1;
+    headerOption->optionData[0] = 0;
+    info->options = headerOption;
+    info->numOptions = 1;
+}
+
+TEST(CAProtocolMessage, CAGeneratePDUEncoding)
+{
+    CAEndpoint_t tempRep;
+    memset(&tempRep, 0, sizeof(CAEndpoint_t));
+    tempRep.flags = CA_DEFAULT_FLAGS;
+    tempRep.adapter = CA_ADAPTER_IP;
+    tempRep.port = 5683;
+
+    CAInfo_t info;
+    CAHeaderOption_t headerOption;
+    InitPDUInfo(&info, &headerOption);
+    // The payload of a UDP pdu may be added by the block-wise transfer.
+    info.payload = NULL;
+    info.payloadSize = 0;
+
+    // Confirmable GET, token "token".
+    const uint8_t udpHeader[] = { 0x45, 0x01, 0x00, 0x00, 't', 'o', 'k', 'e', 'n' };
+    const std::string ocfCbor("\x27\x10", 2);
+    const std::string version("\x08\x00", 2);
+
+    std::vector<uint8_t> expected(udpHeader, udpHeader + sizeof(udpHeader));
+    AppendOption(expected, COAP_OPTION_OBSERVE, "");                            // 6
+    AppendOption(expected, 5, "a");                                             // 11
+    AppendOption(expected, 0, "light");
+    AppendOption(expected, 0, "0");
+    AppendOption(expected, 1, ocfCbor);                                         // 12
+    AppendOption(expected, 3, "if=oic.if.baseline");                            // 15
+    AppendOption(expected, 0, "rt=core.light");
+    AppendOption(expected, 2, ocfCbor);                                         // 17
+    AppendOption(expected, CA_OPTION_ACCEPT_VERSION - 17, version);             // 2049
+    AppendOption(expected, 4, version);                                         // 2053
+    ExpectPDU(CA_GET, &info, &tempRep, expected);
+
+    // Cached URI options give the same pdu.
+    ExpectPDU(CA_GET, &info, &tempRep, expected);
+
+    // A URI too long to be cached, with more options than are kept inline.
+    std::string longUri = "/a/light/0?if=oic.if.baseline";
+    expected.assign(udpHeader, udpHeader + sizeof(udpHeader));
+    AppendOption(expected, COAP_OPTION_OBSERVE, "");
+    AppendOption(expected, 5, "a");
+    AppendOption(expected, 0, "light");
+    AppendOption(expected, 0, "0");
+    AppendOption(expected, 1, ocfCbor);
+    AppendOption(expected, 3, "if=oic.if.baseline");
+    for (int i = 0; i < 20; i++)
+    {
+        longUri += "&rt=core.light";
+        AppendOption(expected, 0, "rt=core.light");
+    }
+    AppendOption(expected, 2, ocfCbor);
+    AppendOption(expected, CA_OPTION_ACCEPT_VERSION - 17, version);
+    AppendOption(expected, 4, version);
+    info.resourceUri = (CAURI_t)longUri.c_str();
+    ExpectPDU(CA_GET, &info, &tempRep, expected);
+    ExpectPDU(CA_GET, &info, &tempRep, expected);
+
+    // No query, no format, no header option.
+    info.resourceUri = (CAURI_t)"/oic/d";
+    info.payloadFormat = CA_FORMAT_UNDEFINED;
+    info.acceptFormat = CA_FORMAT_UNDEFINED;
+    info.numOptions = 0;
+    expected.assign(udpHeader, udpHeader + sizeof(udpHeader));
+    AppendOption(expected, COAP_OPTION_URI_PATH, "oic");
+    AppendOption(expected, 0, "d");
+    ExpectPDU(CA_GET, &info, &tempRep, expected);
+
+#ifdef WITH_TCP
+    // Over TCP the pdu has its exact size, payload included. The 75 bytes following
+    // the token take an extended length byte.
+    InitPDUInfo(&info, &headerOption);
+    tempRep.adapter = CA_ADAPTER_TCP;
+    const uint8_t tcpHeader[] = { 0xD5, 75 - 13, 0x45, 't', 'o', 'k', 'e', 'n' };
+    expected.assign(tcpHeader, tcpHeader + sizeof(tcpHeader));
+    AppendOption(expected, COAP_OPTION_OBSERVE, "");
+    AppendOption(expected, 5, "a");
+    AppendOption(expected, 0, "light");
+    AppendOption(expected, 0, "0");
+    AppendOption(expected, 1, ocfCbor);
+    AppendOption(expected, 3, "if=oic.if.baseline");
+    AppendOption(expected, 0, "rt=core.light");
+    AppendOption(expected, 2, ocfCbor);
+    AppendOption(expected, CA_OPTION_ACCEPT_VERSION - 17, version);
+    AppendOption(expected, 4, version);
+    expected.push_back(0xFF);
+    expected.insert(expected.end(), info.payload, info.payload + info.payloadSize);
+    ExpectPDU(CA_CONTENT, &info, &tempRep, expected);
+#endif
+}
+
+TEST(CAProtocolMessage, CAMovePDUOptionsToList)
+{
+    CAEndpoint_t tempRep;
+    memset(&tempRep, 0, sizeof(CAEndpoint_t));
+    tempRep.flags = CA_DEFAULT_FLAGS;
+    tempRep.adapter = CA_ADAPTER_IP;
+    tempRep.port = 5683;
+
+    CAInfo_t info;
+    CAHeaderOption_t headerOption;
+    InitPDUInfo(&info, &headerOption);
+    info.payload = NULL;
+    info.payloadSize = 0;
+
+    coap_list_t *options = NULL;
+    coap_transport_t transport = COAP_UDP;
+    coap_pdu_t *pdu = CAGeneratePDU(CA_GET, &info, &tempRep, &options, &transport);
+    ASSERT_TRUE(NULL != pdu);
+    unsigned int headerLength = 4 + info.tokenLength;
+    EXPECT_LT(headerLength, pdu->length);
+
+    EXPECT_EQ(CA_STATUS_OK, CAMovePDUOptionsToList(pdu, &options));
+    EXPECT_EQ(headerLength, pdu->length);
+
+    coap_list_t *expected = NULL;
+    EXPECT_EQ(CA_STATUS_OK, CAParseURI("coap://[::]/a/light/0?if=oic.if.baseline&rt=core.light",
+                                       &expected));
+    EXPECT_EQ(CA_STATUS_OK, CAParseHeadOption(CA_GET, &info, &expected));
+    coap_list_t *opt = options;
+    for (coap_list_t *exp = expected; exp; exp = exp->next, opt = opt->next)
+    {
+        ASSERT_TRUE(NULL != opt);
+        coap_option *option = (coap_option *) opt->data;
+        coap_option *expectedOption = (coap_option *) exp->data;
+        EXPECT_EQ(COAP_OPTION_KEY(*expectedOption), COAP_OPTION_KEY(*option));
+        ASSERT_EQ(COAP_OPTION_LENGTH(*expectedOption), COAP_OPTION_LENGTH(*option));
+        EXPECT_EQ(0, memcmp(COAP_OPTION_DATA(*expectedOption), COAP_OPTION_DATA(*option),
+                            COAP_OPTION_LENGTH(*option)));
+    }
+    EXPECT_TRUE(NULL == opt);
+
+    // Nothing is left to move.
+    EXPECT_EQ(CA_STATUS_OK, CAMovePDUOptionsToList(pdu, &options));
+
+    coap_delete_list(expected);
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+}
@@ -0,0 +1,160 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "iotivity_config.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "caqueueingthread.h"
+#include "cathreadpool.h"
+#include "oic_malloc.h"
+#include "oic_time.h"
+#include "octhread.h"
+
+static const size_t DATA_COUNT = 100;
+static const size_t MAX_BATCH_SIZE = 8;
+
+static std::vector<int> g_received;
+static std::vector<size_t> g_batchSizes;
+static size_t g_destroyed = 0;
+static size_t g_singleTasks = 0;
+static oc_mutex g_destroyedMutex = NULL;
+static oc_cond g_destroyedCond = NULL;
+
+static void SingleTask(void *data)
+{
+    (void)data;
+    g_singleTasks++;
+}
+
+static void BatchTask(void **data, size_t count)
+{
+    g_batchSizes.push_back(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        g_received.push_back(*(int *)data[i]);
+    }
+}
+
+static void DestroyData(void *data, uint32_t size)
+{
+    (void)size;
+    OICFree(data);
+
+    oc_mutex_lock(g_destroyedMutex);
+    g_destroyed++;
+    oc_cond_signal(g_destroyedCond);
+    oc_mutex_unlock(g_destroyedMutex);
+}
+
+class CAQueueingThreadF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_received.clear();
+        g_batchSizes.clear();
+        g_destroyed = 0;
+        g_singleTasks = 0;
+        g_destroyedMutex = oc_mutex_new();
+        g_destroyedCond = oc_cond_new();
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &m_threadPool));
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&m_thread, m_threadPool,
+                                                           SingleTask, DestroyData));
+    }
+
+    virtual void TearDown()
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadStop(&m_thread));
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&m_thread));
+        ca_thread_pool_free(m_threadPool);
+        oc_cond_free(g_destroyedCond);
+        oc_mutex_free(g_destroyedMutex);
+    }
+
+    void AddData(size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            int *data = (int *)OICMalloc(sizeof(int));
+            ASSERT_TRUE(NULL != data);
+            *data = (int)i;
+            ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, data, sizeof(int)));
+        }
+    }
+
+    bool WaitForDestroyed(size_t count)
+    {
+        uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + 5000;
+        oc_mutex_lock(g_destroyedMutex);
+        while ((g_destroyed < count) && (OICGetCurrentTime(TIME_IN_MS) < deadline))
+        {
+            oc_cond_wait_for(g_destroyedCond, g_destroyedMutex, 100 * 1000);
+        }
+        bool done = (g_destroyed >= count);
+        oc_mutex_unlock(g_destroyedMutex);
+        return done;
+    }
+
+    ca_thread_pool_t m_threadPool;
+    CAQueueingThread_t m_thread;
+};
+
+TEST_F(CAQueueingThreadF, SetBatchTaskInvalidParams)
+{
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadSetBatchTask(NULL, BatchTask, 1));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadSetBatchTask(&m_thread, BatchTask, 0));
+}
+
+TEST_F(CAQueueingThreadF, SingleTaskWithoutBatchTask)
+{
+    AddData(DATA_COUNT);
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&m_thread));
+    ASSERT_TRUE(WaitForDestroyed(DATA_COUNT));
+
+    EXPECT_EQ(DATA_COUNT, g_singleTasks);
+    EXPECT_TRUE(g_batchSizes.empty());
+}
+
+TEST_F(CAQueueingThreadF, BatchTaskReceivesQueuedDataInOrder)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetBatchTask(&m_thread, BatchTask, MAX_BATCH_SIZE));
+
+    // Queue the data before the thread starts, so that it is given in full batches.
+    AddData(DATA_COUNT);
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&m_thread));
+    ASSERT_TRUE(WaitForDestroyed(DATA_COUNT));
+
+    EXPECT_EQ(0u, g_singleTasks);
+    ASSERT_EQ(DATA_COUNT, g_received.size());
+    for (size_t i = 0; i < DATA_COUNT; i++)
+    {
+        EXPECT_EQ((int)i, g_received[i]);
+    }
+
+    ASSERT_EQ((DATA_COUNT + MAX_BATCH_SIZE - 1) / MAX_BATCH_SIZE, g_batchSizes.size());
+    for (size_t i = 0; i < g_batchSizes.size(); i++)
+    {
+        EXPECT_GE(MAX_BATCH_SIZE, g_batchSizes[i]);
+        EXPECT_LT(0u, g_batchSizes[i]);
+    }
+}
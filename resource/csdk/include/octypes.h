@@ -147,6 +147,9 @@ extern "C" {
 /** For representation.*/
 #define OC_RSRVD_REPRESENTATION         "rep"
 
+/** For the result of a child in a batch response.*/
+#define OC_RSRVD_BATCH_STATUS           "status"
+
 /** To represent content type.*/
 #define OC_RSRVD_CONTENT_TYPE           "ct"
 
@@ -1292,6 +1295,21 @@ typedef struct OCHeaderOption
 #endif // __cplusplus
 } OCHeaderOption;
 
+/**
+ * This structure holds the counters of the response cache of the server or of the client.
+ */
+typedef struct
+{
+    /** GET requests answered from the cache.*/
+    uint32_t hits;
+
+    /** GET requests which could not be answered from the cache.*/
+    uint32_t misses;
+
+    /** Cached representations validated with an ETag (2.03 Valid responses).*/
+    uint32_t validated;
+} OCResponseCacheStats;
+
 /**
  * This structure describes the platform properties. All non-Null properties will be
  * included in a platform discovery request.
@@ -1800,6 +1818,13 @@ typedef OCStackApplicationResult (* OCClientResponseHandler)(void *context, OCDo
  */
 typedef void (* OCClientContextDeleter)(void *context);
 
+/**
+ * Applications which sleep between calls to OCProcess() implement this callback to be
+ * woken up when the stack has received a message. It is called from a thread of the
+ * stack, so it should only signal the thread which calls OCProcess().
+ */
+typedef void (* OCProcessWakeupHandler)(void *context);
+
 /**
  * This info is passed from application to OC Stack when initiating a request to Server.
  */
@@ -1821,6 +1846,41 @@ typedef struct OCCallbackData
 #endif // __cplusplus
 } OCCallbackData;
 
+/**
+ * Callback to fill one block of a streamed response payload.
+ * The stack asks for each block when the client requests it, so blocks may be asked for
+ * more than once and in any order.
+ *
+ * @param context       Context given with the producer.
+ * @param offset        Offset of the block within the whole payload.
+ * @param buffer        Buffer to be filled.
+ * @param size          Number of bytes to write to buffer.
+ *
+ * @return ::OC_STACK_OK if size bytes were written, some other value to abort the transfer.
+ */
+typedef OCStackResult (* OCBlockProducer)(void *context, size_t offset,
+                                          uint8_t *buffer, size_t size);
+
+/**
+ * Callback to consume one block of a streamed response payload.
+ * Blocks are delivered in order, each of them once, before the response callback is invoked.
+ *
+ * @param context       Context given with the consumer.
+ * @param offset        Offset of the block within the whole payload.
+ * @param data          Received block data.
+ * @param size          Size of data.
+ *
+ * @return ::OC_STACK_OK to continue the transfer, some other value to abort it.
+ */
+typedef OCStackResult (* OCBlockConsumer)(void *context, size_t offset,
+                                          const uint8_t *data, size_t size);
+
+/**
+ * Callback to delete the context of a block producer or consumer once the transfer
+ * does not need it anymore.
+ */
+typedef void (* OCBlockContextDeleter)(void *context);
+
 /**
  * Application server implementations must implement this callback to consume requests OTA.
  * Entity handler callback needs to fill the resPayload of the entityHandlerRequest.
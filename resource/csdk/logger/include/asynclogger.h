@@ -0,0 +1,131 @@
+//******************************************************************
+//
+// Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Internal interface between the logger and its asynchronous backend.
+ *
+ * The asynchronous backend captures a log record (level, tag, format pointer and the
+ * raw arguments) into a ring buffer owned by the calling thread. A background thread
+ * drains the rings, formats the records and writes them with OCLogOutput().
+ */
+
+#ifndef ASYNC_LOGGER_H_
+#define ASYNC_LOGGER_H_
+
+#include "experimental/logger.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Time of a log record, as printed by the default console output.
+ */
+typedef struct
+{
+    int min;
+    int sec;
+    int ms;
+} OCLogTimestamp;
+
+/**
+ * Get the current time of a log record.
+ *
+ * @param[out] when - current time.
+ */
+void OCLogGetTimestamp(OCLogTimestamp *when);
+
+/**
+ * Write a formatted log string.
+ *
+ * @param sink   - custom logging context, or NULL for the default platform output
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL, DEBUG_LITE or INFO_LITE
+ * @param tag    - Module name
+ * @param logStr - log string
+ * @param when   - time of the log record, or NULL for the current time
+ */
+void OCLogOutput(oc_log_ctx_t *sink, int level, const char *tag, const char *logStr,
+                 const OCLogTimestamp *when);
+
+/**
+ * Check whether the context has been created by OCLogMakeAsyncContext().
+ *
+ * @param ctx - logging context, may be NULL
+ *
+ * @return true if ctx is the asynchronous logging context
+ */
+bool OCIsAsyncLogContext(const oc_log_ctx_t *ctx);
+
+/**
+ * Get the sink of the asynchronous logging context, to which a record which cannot
+ * be captured is written synchronously.
+ *
+ * @param ctx - asynchronous logging context
+ *
+ * @return the sink passed to OCLogMakeAsyncContext(), or NULL for the default output
+ */
+oc_log_ctx_t *OCGetAsyncLogSink(const oc_log_ctx_t *ctx);
+
+/**
+ * Capture a variable argument list log record.
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL (already verified)
+ * @param tag    - Module name
+ * @param format - log format string
+ * @param args   - arguments of the format string
+ *
+ * @return true if the record was captured or dropped, false if it must be
+ *         written synchronously
+ */
+bool OCAsyncLogv(int level, const char *tag, const char *format, va_list args);
+
+/**
+ * Capture a log string.
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL (already verified)
+ * @param tag    - Module name
+ * @param logStr - log string
+ *
+ * @return true if the record was captured or dropped, false if it must be
+ *         written synchronously
+ */
+bool OCAsyncLog(int level, const char *tag, const char *logStr);
+
+/**
+ * Capture the contents of a buffer, to be dumped in hex.
+ *
+ * @param level      - DEBUG, INFO, WARNING, ERROR, FATAL (already verified)
+ * @param tag        - Module name
+ * @param buffer     - pointer to buffer of bytes
+ * @param bufferSize - number of bytes in buffer
+ *
+ * @return true if the buffer was captured or dropped, false if it must be
+ *         written synchronously
+ */
+bool OCAsyncLogBuffer(int level, const char *tag, const uint8_t *buffer, size_t bufferSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASYNC_LOGGER_H_ */
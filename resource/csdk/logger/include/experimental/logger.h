@@ -110,6 +110,28 @@ typedef enum {
  */
 void OCSetLogLevel(LogLevel level, bool hidePrivateLogEntries);
 
+/**
+ * Set the log level of one module, overriding the level set by OCSetLogLevel().
+ * Like OCSetLogLevel(), this is meant to be called while configuring the logger.
+ *
+ * @param tag     - Module name.
+ * @param level   - log level of the module.
+ *
+ * @return true on success, false if the tag is invalid or too many modules have a level.
+ */
+bool OCSetTagLogLevel(const char *tag, LogLevel level);
+
+/**
+ * Check whether a log message of the given level and module would be logged.
+ * The OIC_LOG macros check it before evaluating their arguments.
+ *
+ * @param level   - DEBUG, INFO, WARNING, ERROR, FATAL plus possibly OC_LOG_PRIVATE_DATA.
+ * @param tag     - Module name.
+ *
+ * @return true if the message would be logged.
+ */
+bool OCLogIsEnabled(int level, const char *tag);
+
 #ifdef __TIZEN__
 /**
  * Output the contents of the specified buffer (in hex) with the specified priority level.
@@ -131,6 +153,34 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
      */
     void OCLogConfig(oc_log_ctx_t *ctx);
 
+    /**
+     * Create a logging context which makes logging asynchronous.  Once it is passed
+     * to OCLogConfig(), each thread stores its log records (format pointer and raw
+     * arguments) into its own ring buffer, and a background thread formats them and
+     * writes them to the sink.  Records which do not fit into a full ring buffer are
+     * dropped and counted.  Format strings are referenced rather than copied, so
+     * they must be string literals, as they are with the OIC_LOG macros.
+     * OCLogShutdown() flushes the remaining records and destroys the context,
+     * but not its sink, which still belongs to the caller.
+     * Only available where pthreads are supported; NULL is returned elsewhere.
+     *
+     * @param sink     - context receiving the formatted log strings, or NULL for the
+     *                   default output
+     * @param ringSize - size in bytes of the ring buffer of each thread, or 0 for the
+     *                   default size
+     *
+     * @return the asynchronous logging context, or NULL on error or if one already exists
+     */
+    oc_log_ctx_t *OCLogMakeAsyncContext(oc_log_ctx_t *sink, size_t ringSize);
+
+    /**
+     * Get the number of log records dropped by the asynchronous logging context
+     * because the ring buffer of the logging thread was full.
+     *
+     * @return number of dropped log records
+     */
+    uint64_t OCLogGetDroppedCount(void);
+
     /**
      * Initialize the logger.  Optional on Android and Linux.
      */
@@ -211,13 +261,15 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
 #define OIC_LOG_BUFFER(level, tag, buffer, bufferSize) \
     do { \
         IF_OC_PRINT_LOG_LEVEL((level)) \
-            OCLogBuffer((level), (tag), (buffer), (bufferSize)); \
+            if (OCLogIsEnabled((level), (tag))) \
+                OCLogBuffer((level), (tag), (buffer), (bufferSize)); \
     } while(0)
 
 #define OIC_LOG_CA_BUFFER(level, tag, buffer, bufferSize, isHeader) \
     do { \
         IF_OC_PRINT_LOG_LEVEL((level)) \
-            OCPrintCALogBuffer((level), (tag), (buffer), (bufferSize), (isHeader)); \
+            if (OCLogIsEnabled((level), (tag))) \
+                OCPrintCALogBuffer((level), (tag), (buffer), (bufferSize), (isHeader)); \
     } while(0)
 
 #define OIC_LOG_CONFIG(ctx)    OCLogConfig((ctx))
@@ -225,14 +277,16 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
 #define OIC_LOG(level, tag, logStr) \
     do { \
         IF_OC_PRINT_LOG_LEVEL((level)) \
-            OCLog((level), (tag), (logStr)); \
+            if (OCLogIsEnabled((level), (tag))) \
+                OCLog((level), (tag), (logStr)); \
     } while(0)
 
 // Define variable argument log function for Linux, Android, and Win32
 #define OIC_LOG_V(level, tag, ...) \
     do { \
         IF_OC_PRINT_LOG_LEVEL((level)) \
-            OCLogv((level), (tag), __VA_ARGS__); \
+            if (OCLogIsEnabled((level), (tag))) \
+                OCLogv((level), (tag), __VA_ARGS__); \
     } while(0)
 
 #endif // __TIZEN__
@@ -0,0 +1,1284 @@
+//******************************************************************
+//
+// Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Defining _POSIX_C_SOURCE macro with 200809L as value causes header files
+// to expose clock_gettime().
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "iotivity_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asynclogger.h"
+
+// The logger is linked below c_common, so this file only relies on pthreads
+// and on the GCC atomic builtins.
+#if defined(HAVE_PTHREAD_H) && !defined(_WIN32) && !defined(__TIZEN__) && \
+    (defined(__GNUC__) || defined(__clang__))
+
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+// Default size of the ring buffer of a thread
+#define DEFAULT_RING_SIZE (16 * 1024)
+
+// Interval of the drain thread when the rings are empty
+#define DRAIN_INTERVAL_MS (10)
+
+// Maximum number of arguments of a captured log record
+#define MAX_RECORD_ARGS (16)
+
+// Maximum length of a single conversion specification, e.g. "%-08.3lld"
+#define MAX_SPEC_LENGTH (32)
+
+// Maximum length of the tag of a captured log record, including the terminator
+#define MAX_RECORD_TAG (64)
+
+// Number of bytes of a buffer captured by one record (a multiple of 16 bytes per line)
+#define MAX_RECORD_BUFFER (256)
+
+// Records are aligned on 8 bytes within the ring
+#define RECORD_ALIGN(size) (((size) + 7) & ~((size_t)7))
+
+#define LOG_TAG "OIC_LOG_ASYNC"
+
+typedef enum
+{
+    RECORD_WRAP = 0,   // filler up to the end of the ring
+    RECORD_FORMAT,     // format pointer and raw arguments
+    RECORD_TEXT,       // preformatted string
+    RECORD_BUFFER      // bytes to be dumped in hex
+} RecordKind;
+
+typedef enum
+{
+    ARG_NONE = 0,
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_INTMAX,
+    ARG_SIZE,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_LDOUBLE,
+    ARG_POINTER,
+    ARG_STRING,
+    ARG_UNSUPPORTED
+} ArgType;
+
+/**
+ * One conversion specification of a format string.
+ */
+typedef struct
+{
+    const char *start;      // '%' of the specification
+    size_t length;          // length of the specification
+    int stars;              // number of '*' (int) arguments before the value
+    bool starPrecision;     // whether the precision is given by the last '*' argument
+    int precision;          // precision given in the format, or -1
+    ArgType type;           // type of the value
+} FormatSpec;
+
+/**
+ * Raw value of an argument.  Strings are stored as an offset into the data of the record.
+ */
+typedef union
+{
+    int i;
+    long l;
+    long long ll;
+    intmax_t j;
+    size_t z;
+    ptrdiff_t t;
+    double d;
+    long double ld;
+    const void *p;
+    size_t s;
+} ArgValue;
+
+// Offset of a NULL string argument
+#define NULL_STRING_OFFSET ((size_t)-1)
+
+/**
+ * Header of a record in a ring.  The first two fields are shared by the wrap marker.
+ * The header is followed by the arguments, the tag and the data.
+ */
+typedef struct
+{
+    uint32_t size;          // size of the record including the header, aligned
+    uint8_t kind;           // RecordKind
+    uint8_t argCount;       // number of ArgValue after the header
+    uint16_t tagLength;     // length of the tag, including the terminator
+    int level;              // verified log level
+    OCLogTimestamp when;    // time of the log call
+    const char *format;     // format string of a RECORD_FORMAT record
+    size_t dataLength;      // length of the strings, text or buffer bytes
+} RecordHeader;
+
+// Offset of the arguments, which keeps them aligned within a record
+#define ARGS_OFFSET (((sizeof(RecordHeader) + sizeof(ArgValue) - 1) / sizeof(ArgValue)) * \
+                     sizeof(ArgValue))
+
+#define MAX_RECORD_SIZE RECORD_ALIGN(ARGS_OFFSET + MAX_RECORD_ARGS * sizeof(ArgValue) + \
+                                     MAX_RECORD_TAG + MAX_LOG_V_BUFFER_SIZE)
+
+/**
+ * Ring buffer of a thread.  It has a single producer (the owning thread) and a single
+ * consumer (whoever holds g_drainLock).
+ */
+typedef struct LogRing
+{
+    struct LogRing *next;
+    uint8_t *buffer;
+    size_t size;
+    size_t head;            // written by the producer
+    size_t tail;            // written by the consumer
+    uint32_t dropped;       // records dropped since the last drain
+    bool orphaned;          // the owning thread has exited
+} LogRing;
+
+/**
+ * The asynchronous logging context.
+ */
+typedef struct
+{
+    oc_log_ctx_t ctx;
+    oc_log_ctx_t *sink;
+    pthread_t thread;
+    bool running;           // protected by g_waitLock
+} AsyncLogger;
+
+static pthread_once_t g_ringKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_ringKey;
+
+// Protects the links of g_rings and g_asyncLogger
+static pthread_mutex_t g_ringsLock = PTHREAD_MUTEX_INITIALIZER;
+// Serializes the consumers of the rings, and whoever frees them.
+// It is always taken before g_ringsLock.
+static pthread_mutex_t g_drainLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Wakes up the drain thread
+static pthread_mutex_t g_waitLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_waitCond = PTHREAD_COND_INITIALIZER;
+
+static LogRing *g_rings = NULL;
+static AsyncLogger *g_asyncLogger = NULL;
+static size_t g_ringSize = DEFAULT_RING_SIZE;
+static uint64_t g_droppedCount = 0;
+// Number of threads between GetActiveRing() and PutActiveRing()
+static uint32_t g_activeProducers = 0;
+
+static void FreeRing(LogRing *ring)
+{
+    free(ring->buffer);
+    free(ring);
+}
+
+static void UnlinkRing(LogRing *ring)
+{
+    for (LogRing **link = &g_rings; *link; link = &(*link)->next)
+    {
+        if (*link == ring)
+        {
+            *link = ring->next;
+            return;
+        }
+    }
+}
+
+static void ReleaseThreadRing(void *data)
+{
+    LogRing *ring = (LogRing *)data;
+
+    pthread_mutex_lock(&g_drainLock);
+    pthread_mutex_lock(&g_ringsLock);
+    if (g_asyncLogger)
+    {
+        // The drain thread frees the ring once it has consumed the last records.
+        __atomic_store_n(&ring->orphaned, true, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        UnlinkRing(ring);
+        FreeRing(ring);
+    }
+    pthread_mutex_unlock(&g_ringsLock);
+    pthread_mutex_unlock(&g_drainLock);
+}
+
+static void CreateRingKey(void)
+{
+    pthread_key_create(&g_ringKey, ReleaseThreadRing);
+}
+
+static LogRing *GetThreadRing(void)
+{
+    pthread_once(&g_ringKeyOnce, CreateRingKey);
+
+    LogRing *ring = (LogRing *)pthread_getspecific(g_ringKey);
+    if (ring)
+    {
+        return ring;
+    }
+
+    ring = (LogRing *)calloc(1, sizeof(LogRing));
+    if (!ring)
+    {
+        return NULL;
+    }
+    ring->size = __atomic_load_n(&g_ringSize, __ATOMIC_RELAXED);
+    ring->buffer = (uint8_t *)malloc(ring->size);
+    if (!ring->buffer)
+    {
+        free(ring);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_ringsLock);
+    ring->next = g_rings;
+    g_rings = ring;
+    pthread_mutex_unlock(&g_ringsLock);
+
+    pthread_setspecific(g_ringKey, ring);
+    return ring;
+}
+
+/**
+ * Find where a record of the given (aligned) size would start in a ring.
+ *
+ * @return the head past the end of the ring if the record does not fit there,
+ *         or SIZE_MAX if the ring has no room for the record
+ */
+static size_t PlaceRecord(const LogRing *ring, size_t head, size_t tail, size_t size)
+{
+    size_t available = ring->size - (head - tail);
+    size_t contiguous = ring->size - head % ring->size;
+
+    if (contiguous < size)
+    {
+        // Fill the end of the ring and start over from its beginning.
+        return (available < contiguous + size) ? SIZE_MAX : head + contiguous;
+    }
+    return (available < size) ? SIZE_MAX : head;
+}
+
+/**
+ * Reserve space for a record of the given (aligned) size in the ring of the calling thread.
+ *
+ * @return pointer to the reserved space, or NULL if the ring is full
+ */
+static uint8_t *ReserveRecord(LogRing *ring, size_t size)
+{
+    size_t head = ring->head;
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t start = PlaceRecord(ring, head, tail, size);
+    if (SIZE_MAX == start)
+    {
+        return NULL;
+    }
+
+    if (start != head)
+    {
+        RecordHeader *wrap = (RecordHeader *)(ring->buffer + head % ring->size);
+        wrap->size = (uint32_t)(start - head);
+        wrap->kind = RECORD_WRAP;
+        __atomic_store_n(&ring->head, start, __ATOMIC_RELEASE);
+    }
+
+    return ring->buffer + start % ring->size;
+}
+
+static void CommitRecord(LogRing *ring, size_t size)
+{
+    size_t head = ring->head;
+    __atomic_store_n(&ring->head, head + size, __ATOMIC_RELEASE);
+
+    // Wake up the drain thread when the ring becomes half full, rather than
+    // letting it fill up until the next drain interval.
+    size_t used = head + size - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if ((used >= ring->size / 2) && (used < ring->size / 2 + size))
+    {
+        pthread_cond_signal(&g_waitCond);
+    }
+}
+
+/**
+ * Get the ring of the calling thread, if the asynchronous logger is running.
+ * A ring which is returned must be given back with PutActiveRing() once the
+ * records are committed, so that the logger is not destroyed in between.
+ */
+static LogRing *GetActiveRing(void)
+{
+    // Sequentially consistent, so that either the destroyer waits for this thread
+    // or this thread sees that the logger is gone.
+    __atomic_add_fetch(&g_activeProducers, 1, __ATOMIC_SEQ_CST);
+    LogRing *ring = NULL;
+    if (__atomic_load_n(&g_asyncLogger, __ATOMIC_SEQ_CST))
+    {
+        ring = GetThreadRing();
+    }
+    if (!ring)
+    {
+        __atomic_sub_fetch(&g_activeProducers, 1, __ATOMIC_SEQ_CST);
+    }
+    return ring;
+}
+
+static void PutActiveRing(void)
+{
+    __atomic_sub_fetch(&g_activeProducers, 1, __ATOMIC_SEQ_CST);
+}
+
+static void CountDropped(LogRing *ring)
+{
+    __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_droppedCount, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Copy a complete record into a ring, or count it as dropped.
+ */
+static void PushToRing(LogRing *ring, const uint8_t *record, size_t size)
+{
+    uint8_t *space = ReserveRecord(ring, size);
+    if (!space)
+    {
+        CountDropped(ring);
+        return;
+    }
+
+    memcpy(space, record, size);
+    CommitRecord(ring, size);
+}
+
+/**
+ * Copy a complete record into the ring of the calling thread, or count it as dropped.
+ */
+static bool PushRecord(const uint8_t *record, size_t size)
+{
+    LogRing *ring = GetActiveRing();
+    if (!ring)
+    {
+        return false;
+    }
+
+    PushToRing(ring, record, size);
+    PutActiveRing();
+    return true;
+}
+
+/**
+ * Parse the conversion specification starting at the '%' pointed to by format.
+ *
+ * @return pointer past the specification
+ */
+static const char *ParseFormatSpec(const char *format, FormatSpec *spec)
+{
+    const char *p = format + 1;
+
+    spec->start = format;
+    spec->stars = 0;
+    spec->starPrecision = false;
+    spec->precision = -1;
+    spec->type = ARG_UNSUPPORTED;
+
+    while (*p && strchr("-+ #0'", *p))
+    {
+        p++;
+    }
+
+    if ('*' == *p)
+    {
+        spec->stars++;
+        p++;
+    }
+    else
+    {
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+        if ('$' == *p)
+        {
+            // Positional arguments are not supported.
+            spec->length = (size_t)(p - format);
+            return p;
+        }
+    }
+
+    if ('.' == *p)
+    {
+        p++;
+        if ('*' == *p)
+        {
+            spec->stars++;
+            spec->starPrecision = true;
+            p++;
+        }
+        else
+        {
+            spec->precision = 0;
+            while (*p >= '0' && *p <= '9')
+            {
+                spec->precision = spec->precision * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+
+    ArgType integer = ARG_INT;
+    bool longDouble = false;
+    bool wide = false;
+    switch (*p)
+    {
+        case 'h':
+            p += ('h' == p[1]) ? 2 : 1;
+            break;
+        case 'l':
+            if ('l' == p[1])
+            {
+                integer = ARG_LLONG;
+                p += 2;
+            }
+            else
+            {
+                integer = ARG_LONG;
+                wide = true;
+                p++;
+            }
+            break;
+        case 'j':
+            integer = ARG_INTMAX;
+            p++;
+            break;
+        case 'z':
+            integer = ARG_SIZE;
+            p++;
+            break;
+        case 't':
+            integer = ARG_PTRDIFF;
+            p++;
+            break;
+        case 'L':
+            longDouble = true;
+            p++;
+            break;
+        default:
+            break;
+    }
+
+    char conversion = *p;
+    if (conversion)
+    {
+        p++;
+    }
+
+    switch (conversion)
+    {
+        case '%':
+            spec->type = (0 == spec->stars) ? ARG_NONE : ARG_UNSUPPORTED;
+            break;
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            spec->type = integer;
+            break;
+        case 'c':
+            spec->type = wide ? ARG_UNSUPPORTED : ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->type = longDouble ? ARG_LDOUBLE : ARG_DOUBLE;
+            break;
+        case 'p':
+            spec->type = ARG_POINTER;
+            break;
+        case 's':
+            spec->type = wide ? ARG_UNSUPPORTED : ARG_STRING;
+            break;
+        default:
+            // Including %n, which must never be deferred.
+            spec->type = ARG_UNSUPPORTED;
+            break;
+    }
+
+    spec->length = (size_t)(p - format);
+    if (spec->length >= MAX_SPEC_LENGTH)
+    {
+        spec->type = ARG_UNSUPPORTED;
+    }
+    return p;
+}
+
+static size_t GetRecordTagLength(const char *tag)
+{
+    size_t tagLength = strlen(tag) + 1;
+    return (tagLength > MAX_RECORD_TAG) ? MAX_RECORD_TAG : tagLength;
+}
+
+static size_t GetRecordSize(size_t argCount, size_t tagLength, size_t dataLength)
+{
+    return RECORD_ALIGN(ARGS_OFFSET + argCount * sizeof(ArgValue) + tagLength + dataLength);
+}
+
+static size_t StartRecord(uint8_t *record, RecordKind kind, int level, const char *tag,
+                          size_t argCount)
+{
+    RecordHeader *header = (RecordHeader *)record;
+    memset(header, 0, sizeof(RecordHeader));
+    header->kind = (uint8_t)kind;
+    header->argCount = (uint8_t)argCount;
+    header->level = level;
+    OCLogGetTimestamp(&header->when);
+
+    size_t tagLength = GetRecordTagLength(tag);
+    header->tagLength = (uint16_t)tagLength;
+
+    size_t offset = ARGS_OFFSET + argCount * sizeof(ArgValue);
+    memcpy(record + offset, tag, tagLength - 1);
+    record[offset + tagLength - 1] = '\0';
+    return offset + tagLength;
+}
+
+/**
+ * Complete the header of a record.
+ *
+ * @return size of the record
+ */
+static size_t SealRecord(uint8_t *record, size_t dataLength)
+{
+    RecordHeader *header = (RecordHeader *)record;
+    header->dataLength = dataLength;
+    header->size = (uint32_t)GetRecordSize(header->argCount, header->tagLength, dataLength);
+    return header->size;
+}
+
+static bool FinishRecord(uint8_t *record, size_t dataLength)
+{
+    return PushRecord(record, SealRecord(record, dataLength));
+}
+
+bool OCAsyncLogv(int level, const char *tag, const char *format, va_list args)
+{
+    // Count the arguments first, so that the record can be laid out in one pass.
+    size_t argCount = 0;
+    for (const char *p = format; *p; )
+    {
+        if ('%' != *p)
+        {
+            p++;
+            continue;
+        }
+        FormatSpec spec;
+        p = ParseFormatSpec(p, &spec);
+        if (ARG_UNSUPPORTED == spec.type)
+        {
+            return false;
+        }
+        argCount += spec.stars + ((ARG_NONE == spec.type) ? 0 : 1);
+    }
+    if (argCount > MAX_RECORD_ARGS)
+    {
+        return false;
+    }
+
+    union
+    {
+        uint8_t bytes[MAX_RECORD_SIZE];
+        long double align;
+    } record;
+
+    size_t dataOffset = StartRecord(record.bytes, RECORD_FORMAT, level, tag, argCount);
+    ((RecordHeader *)record.bytes)->format = format;
+
+    ArgValue *values = (ArgValue *)(record.bytes + ARGS_OFFSET);
+    size_t dataLength = 0;
+    size_t argIndex = 0;
+
+    va_list ap;
+    va_copy(ap, args);
+    for (const char *p = format; *p; )
+    {
+        if ('%' != *p)
+        {
+            p++;
+            continue;
+        }
+
+        FormatSpec spec;
+        p = ParseFormatSpec(p, &spec);
+
+        int precision = spec.precision;
+        for (int i = 0; i < spec.stars; i++)
+        {
+            values[argIndex].i = va_arg(ap, int);
+            if (spec.starPrecision && (i == spec.stars - 1))
+            {
+                precision = values[argIndex].i;
+            }
+            argIndex++;
+        }
+
+        ArgValue *value = &values[argIndex];
+        switch (spec.type)
+        {
+            case ARG_NONE:
+                continue;
+            case ARG_INT:
+                value->i = va_arg(ap, int);
+                break;
+            case ARG_LONG:
+                value->l = va_arg(ap, long);
+                break;
+            case ARG_LLONG:
+                value->ll = va_arg(ap, long long);
+                break;
+            case ARG_INTMAX:
+                value->j = va_arg(ap, intmax_t);
+                break;
+            case ARG_SIZE:
+                value->z = va_arg(ap, size_t);
+                break;
+            case ARG_PTRDIFF:
+                value->t = va_arg(ap, ptrdiff_t);
+                break;
+            case ARG_DOUBLE:
+                value->d = va_arg(ap, double);
+                break;
+            case ARG_LDOUBLE:
+                value->ld = va_arg(ap, long double);
+                break;
+            case ARG_POINTER:
+                value->p = va_arg(ap, void *);
+                break;
+            case ARG_STRING:
+            {
+                // The string may not outlive the call, so it is copied into the record.
+                // A precision may bound strings which are not terminated.
+                const char *str = va_arg(ap, const char *);
+                if (!str)
+                {
+                    value->s = NULL_STRING_OFFSET;
+                    break;
+                }
+                size_t room = MAX_LOG_V_BUFFER_SIZE - dataLength;
+                size_t maxLength = (precision >= 0 && (size_t)precision < room) ?
+                                   (size_t)precision : room;
+                const char *end = (const char *)memchr(str, '\0', maxLength);
+                size_t length = end ? (size_t)(end - str) : maxLength;
+                if (length >= room)
+                {
+                    va_end(ap);
+                    return false;
+                }
+                value->s = dataLength;
+                memcpy(record.bytes + dataOffset + dataLength, str, length);
+                record.bytes[dataOffset + dataLength + length] = '\0';
+                dataLength += length + 1;
+                break;
+            }
+            default:
+                va_end(ap);
+                return false;
+        }
+        argIndex++;
+    }
+    va_end(ap);
+
+    return FinishRecord(record.bytes, dataLength);
+}
+
+bool OCAsyncLog(int level, const char *tag, const char *logStr)
+{
+    union
+    {
+        uint8_t bytes[MAX_RECORD_SIZE];
+        long double align;
+    } record;
+
+    size_t dataOffset = StartRecord(record.bytes, RECORD_TEXT, level, tag, 0);
+    size_t length = strlen(logStr);
+    if (length > MAX_LOG_V_BUFFER_SIZE - 1)
+    {
+        length = MAX_LOG_V_BUFFER_SIZE - 1;
+    }
+    memcpy(record.bytes + dataOffset, logStr, length);
+    record.bytes[dataOffset + length] = '\0';
+
+    return FinishRecord(record.bytes, length + 1);
+}
+
+/**
+ * Check whether a ring has room for all the records of a buffer.
+ *
+ * Only the owning thread adds records, and the drain thread only frees space, so the
+ * records are sure to fit when they are pushed afterwards.
+ */
+static bool HasRoomForBuffer(const LogRing *ring, size_t tagLength, size_t bufferSize)
+{
+    size_t head = ring->head;
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    for (size_t offset = 0; offset < bufferSize; offset += MAX_RECORD_BUFFER)
+    {
+        size_t length = bufferSize - offset;
+        if (length > MAX_RECORD_BUFFER)
+        {
+            length = MAX_RECORD_BUFFER;
+        }
+        size_t size = GetRecordSize(0, tagLength, length);
+        head = PlaceRecord(ring, head, tail, size);
+        if (SIZE_MAX == head)
+        {
+            return false;
+        }
+        head += size;
+    }
+    return true;
+}
+
+bool OCAsyncLogBuffer(int level, const char *tag, const uint8_t *buffer, size_t bufferSize)
+{
+    union
+    {
+        uint8_t bytes[MAX_RECORD_SIZE];
+        long double align;
+    } record;
+
+    // A buffer is either captured whole or dropped whole, so that the caller never
+    // logs it again after a part of it was captured.
+    LogRing *ring = GetActiveRing();
+    if (!ring)
+    {
+        return false;
+    }
+    if (!HasRoomForBuffer(ring, GetRecordTagLength(tag), bufferSize))
+    {
+        CountDropped(ring);
+        PutActiveRing();
+        return true;
+    }
+
+    for (size_t offset = 0; offset < bufferSize; offset += MAX_RECORD_BUFFER)
+    {
+        size_t length = bufferSize - offset;
+        if (length > MAX_RECORD_BUFFER)
+        {
+            length = MAX_RECORD_BUFFER;
+        }
+
+        size_t dataOffset = StartRecord(record.bytes, RECORD_BUFFER, level, tag, 0);
+        memcpy(record.bytes + dataOffset, buffer + offset, length);
+        PushToRing(ring, record.bytes, SealRecord(record.bytes, length));
+    }
+    PutActiveRing();
+    return true;
+}
+
+static size_t AppendFormatted(size_t size, size_t position, int written)
+{
+    if (written < 0)
+    {
+        return position;
+    }
+    position += (size_t)written;
+    return (position < size) ? position : size - 1;
+}
+
+#define FORMAT_SPEC(value) \
+    ((0 == spec.stars) ? snprintf(out + position, size - position, specStr, (value)) : \
+     (1 == spec.stars) ? snprintf(out + position, size - position, specStr, \
+                                  stars[0], (value)) : \
+                         snprintf(out + position, size - position, specStr, \
+                                  stars[0], stars[1], (value)))
+
+/**
+ * Format a RECORD_FORMAT record, the same way vsnprintf() would have done in the caller.
+ */
+static void FormatRecord(const RecordHeader *header, const ArgValue *values, const char *data,
+                         char *out, size_t size)
+{
+    size_t position = 0;
+    size_t argIndex = 0;
+    const char *p = header->format;
+
+    out[0] = '\0';
+    while (*p && (position < size - 1))
+    {
+        const char *percent = strchr(p, '%');
+        size_t literal = percent ? (size_t)(percent - p) : strlen(p);
+        if (literal)
+        {
+            size_t copy = (literal < size - 1 - position) ? literal : size - 1 - position;
+            memcpy(out + position, p, copy);
+            position += copy;
+            out[position] = '\0';
+            p += literal;
+            continue;
+        }
+
+        FormatSpec spec;
+        p = ParseFormatSpec(p, &spec);
+
+        if (ARG_NONE == spec.type)
+        {
+            out[position++] = '%';
+            out[position] = '\0';
+            continue;
+        }
+
+        char specStr[MAX_SPEC_LENGTH];
+        memcpy(specStr, spec.start, spec.length);
+        specStr[spec.length] = '\0';
+
+        int stars[2] = { 0, 0 };
+        for (int i = 0; i < spec.stars; i++)
+        {
+            stars[i] = values[argIndex++].i;
+        }
+
+        const ArgValue *value = &values[argIndex++];
+        int written = -1;
+        switch (spec.type)
+        {
+            case ARG_INT:
+                written = FORMAT_SPEC(value->i);
+                break;
+            case ARG_LONG:
+                written = FORMAT_SPEC(value->l);
+                break;
+            case ARG_LLONG:
+                written = FORMAT_SPEC(value->ll);
+                break;
+            case ARG_INTMAX:
+                written = FORMAT_SPEC(value->j);
+                break;
+            case ARG_SIZE:
+                written = FORMAT_SPEC(value->z);
+                break;
+            case ARG_PTRDIFF:
+                written = FORMAT_SPEC(value->t);
+                break;
+            case ARG_DOUBLE:
+                written = FORMAT_SPEC(value->d);
+                break;
+            case ARG_LDOUBLE:
+                written = FORMAT_SPEC(value->ld);
+                break;
+            case ARG_POINTER:
+                written = FORMAT_SPEC(value->p);
+                break;
+            case ARG_STRING:
+                written = FORMAT_SPEC((NULL_STRING_OFFSET == value->s) ?
+                                      (const char *)NULL : data + value->s);
+                break;
+            default:
+                break;
+        }
+        position = AppendFormatted(size, position, written);
+    }
+}
+
+#undef FORMAT_SPEC
+
+static void WriteRecord(oc_log_ctx_t *sink, const uint8_t *record)
+{
+    const RecordHeader *header = (const RecordHeader *)record;
+    const ArgValue *values = (const ArgValue *)(record + ARGS_OFFSET);
+    const char *tag = (const char *)(values + header->argCount);
+    const char *data = tag + header->tagLength;
+
+    switch (header->kind)
+    {
+        case RECORD_FORMAT:
+        {
+            char buffer[MAX_LOG_V_BUFFER_SIZE];
+            FormatRecord(header, values, data, buffer, sizeof(buffer));
+            OCLogOutput(sink, header->level, tag, buffer, &header->when);
+            break;
+        }
+        case RECORD_TEXT:
+            OCLogOutput(sink, header->level, tag, data, &header->when);
+            break;
+        case RECORD_BUFFER:
+        {
+            // Same layout as OCLogBuffer(): 16 values per line.
+            char line[(16 * 3) + 1];
+            size_t lineIndex = 0;
+            for (size_t i = 0; i < header->dataLength; i++)
+            {
+                snprintf(&line[lineIndex * 3], sizeof(line) - lineIndex * 3, "%02X ",
+                         (uint8_t)data[i]);
+                lineIndex++;
+                if ((16 == lineIndex) || (i + 1 == header->dataLength))
+                {
+                    OCLogOutput(sink, header->level, tag, line, &header->when);
+                    lineIndex = 0;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * Consume the records of one ring.
+ *
+ * @return true if the ring had records
+ */
+static bool DrainRing(oc_log_ctx_t *sink, LogRing *ring)
+{
+    union
+    {
+        uint8_t bytes[MAX_RECORD_SIZE];
+        long double align;
+    } record;
+
+    bool drained = false;
+    size_t tail = ring->tail;
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    while (tail != head)
+    {
+        const RecordHeader *header = (const RecordHeader *)(ring->buffer + tail % ring->size);
+        size_t size = header->size;
+        bool wrap = (RECORD_WRAP == header->kind);
+        if (!wrap)
+        {
+            // Copy the record out so that the producer can reuse its space right away.
+            memcpy(record.bytes, header, size);
+        }
+        tail += size;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+        if (!wrap)
+        {
+            WriteRecord(sink, record.bytes);
+            drained = true;
+        }
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    }
+
+    uint32_t dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+    if (dropped)
+    {
+        char message[64];
+        snprintf(message, sizeof(message), "%u log records dropped", (unsigned)dropped);
+        OCLogOutput(sink, WARNING, LOG_TAG, message, NULL);
+    }
+    return drained;
+}
+
+/**
+ * Consume the records of all rings, and free the rings of the threads which have exited.
+ *
+ * @return true if any ring had records
+ */
+static bool DrainRings(oc_log_ctx_t *sink)
+{
+    bool drained = false;
+
+    // New rings are only ever prepended, and only drainers remove rings, so the
+    // list can be walked without g_ringsLock. The sink may then log by itself.
+    pthread_mutex_lock(&g_drainLock);
+    pthread_mutex_lock(&g_ringsLock);
+    LogRing *ring = g_rings;
+    pthread_mutex_unlock(&g_ringsLock);
+
+    while (ring)
+    {
+        LogRing *next = ring->next;
+        bool orphaned = __atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE);
+        drained |= DrainRing(sink, ring);
+        if (orphaned)
+        {
+            pthread_mutex_lock(&g_ringsLock);
+            UnlinkRing(ring);
+            pthread_mutex_unlock(&g_ringsLock);
+            FreeRing(ring);
+        }
+        ring = next;
+    }
+    pthread_mutex_unlock(&g_drainLock);
+
+    return drained;
+}
+
+static void *DrainThread(void *data)
+{
+    AsyncLogger *logger = (AsyncLogger *)data;
+
+    pthread_mutex_lock(&g_waitLock);
+    while (logger->running)
+    {
+        pthread_mutex_unlock(&g_waitLock);
+        bool drained = DrainRings(logger->sink);
+        pthread_mutex_lock(&g_waitLock);
+
+        if (!drained && logger->running)
+        {
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_nsec += DRAIN_INTERVAL_MS * 1000000L;
+            if (timeout.tv_nsec >= 1000000000L)
+            {
+                timeout.tv_sec++;
+                timeout.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_waitCond, &g_waitLock, &timeout);
+        }
+    }
+    pthread_mutex_unlock(&g_waitLock);
+    return NULL;
+}
+
+static int AsyncLoggerInit(oc_log_ctx_t *ctx, void *world)
+{
+    AsyncLogger *logger = (AsyncLogger *)ctx->ctx;
+    if (logger->sink && logger->sink->init)
+    {
+        return logger->sink->init(logger->sink, world);
+    }
+    return 0;
+}
+
+static void AsyncLoggerFlush(oc_log_ctx_t *ctx)
+{
+    AsyncLogger *logger = (AsyncLogger *)ctx->ctx;
+    DrainRings(logger->sink);
+    if (logger->sink && logger->sink->flush)
+    {
+        logger->sink->flush(logger->sink);
+    }
+}
+
+static void AsyncLoggerSetLevel(oc_log_ctx_t *ctx, const int level)
+{
+    AsyncLogger *logger = (AsyncLogger *)ctx->ctx;
+    ctx->log_level = (oc_log_level)level;
+    if (logger->sink && logger->sink->set_level)
+    {
+        logger->sink->set_level(logger->sink, level);
+    }
+}
+
+/**
+ * Convert the level of a log context back to the LogLevel the records keep.
+ */
+static int ToLogLevel(int level)
+{
+    switch (level)
+    {
+        case OC_LOG_FATAL:
+            return FATAL;
+        case OC_LOG_ERROR:
+            return ERROR;
+        case OC_LOG_WARNING:
+            return WARNING;
+        case OC_LOG_INFO:
+            return INFO;
+        default:
+            return DEBUG;
+    }
+}
+
+static size_t AsyncLoggerWrite(oc_log_ctx_t *ctx, const int level, const char *msg)
+{
+    AsyncLogger *logger = (AsyncLogger *)ctx->ctx;
+    if (OCAsyncLog(ToLogLevel(level), LOG_TAG, msg))
+    {
+        return strlen(msg);
+    }
+    if (logger->sink && logger->sink->write_level)
+    {
+        return logger->sink->write_level(logger->sink, level, msg);
+    }
+    return 0;
+}
+
+static int AsyncLoggerSetModule(oc_log_ctx_t *ctx, const char *moduleName)
+{
+    AsyncLogger *logger = (AsyncLogger *)ctx->ctx;
+    ctx->module_name = (char *)moduleName;
+    if (logger->sink && logger->sink->set_module)
+    {
+        return logger->sink->set_module(logger->sink, moduleName);
+    }
+    return 0;
+}
+
+static void AsyncLoggerDestroy(oc_log_ctx_t *ctx)
+{
+    AsyncLogger *logger = (AsyncLogger *)ctx->ctx;
+
+    pthread_mutex_lock(&g_waitLock);
+    logger->running = false;
+    pthread_cond_signal(&g_waitCond);
+    pthread_mutex_unlock(&g_waitLock);
+    pthread_join(logger->thread, NULL);
+
+    // Stop capturing, wait for the records being captured, then write what is left.
+    pthread_mutex_lock(&g_ringsLock);
+    __atomic_store_n(&g_asyncLogger, NULL, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&g_ringsLock);
+    while (__atomic_load_n(&g_activeProducers, __ATOMIC_SEQ_CST))
+    {
+        sched_yield();
+    }
+    while (DrainRings(logger->sink))
+    {
+    }
+
+    // The sink belongs to the caller of OCLogMakeAsyncContext().
+    if (logger->sink && logger->sink->flush)
+    {
+        logger->sink->flush(logger->sink);
+    }
+
+    free(logger);
+}
+
+bool OCIsAsyncLogContext(const oc_log_ctx_t *ctx)
+{
+    return ctx && (ctx->write_level == AsyncLoggerWrite);
+}
+
+oc_log_ctx_t *OCGetAsyncLogSink(const oc_log_ctx_t *ctx)
+{
+    return ((AsyncLogger *)ctx->ctx)->sink;
+}
+
+oc_log_ctx_t *OCLogMakeAsyncContext(oc_log_ctx_t *sink, size_t ringSize)
+{
+    if (0 == ringSize)
+    {
+        ringSize = DEFAULT_RING_SIZE;
+    }
+    ringSize = RECORD_ALIGN(ringSize);
+    if (ringSize < 2 * MAX_RECORD_SIZE)
+    {
+        ringSize = 2 * MAX_RECORD_SIZE;
+    }
+
+    AsyncLogger *logger = (AsyncLogger *)calloc(1, sizeof(AsyncLogger));
+    if (!logger)
+    {
+        return NULL;
+    }
+
+    logger->sink = sink;
+    logger->running = true;
+    logger->ctx.ctx = logger;
+    logger->ctx.log_level = sink ? sink->log_level : OC_LOG_ALL;
+    logger->ctx.init = AsyncLoggerInit;
+    logger->ctx.destroy = AsyncLoggerDestroy;
+    logger->ctx.flush = AsyncLoggerFlush;
+    logger->ctx.set_level = AsyncLoggerSetLevel;
+    logger->ctx.write_level = AsyncLoggerWrite;
+    logger->ctx.set_module = AsyncLoggerSetModule;
+
+    pthread_mutex_lock(&g_ringsLock);
+    bool exists = (NULL != g_asyncLogger);
+    if (!exists)
+    {
+        // Rings which already exist keep their size.
+        __atomic_store_n(&g_ringSize, ringSize, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_asyncLogger, logger, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_ringsLock);
+
+    if (exists || (0 != pthread_create(&logger->thread, NULL, DrainThread, logger)))
+    {
+        if (!exists)
+        {
+            pthread_mutex_lock(&g_ringsLock);
+            __atomic_store_n(&g_asyncLogger, NULL, __ATOMIC_RELEASE);
+            pthread_mutex_unlock(&g_ringsLock);
+        }
+        free(logger);
+        return NULL;
+    }
+
+    return &logger->ctx;
+}
+
+uint64_t OCLogGetDroppedCount(void)
+{
+    return __atomic_load_n(&g_droppedCount, __ATOMIC_RELAXED);
+}
+
+#else // Asynchronous logging is not supported
+
+bool OCIsAsyncLogContext(const oc_log_ctx_t *ctx)
+{
+    (void)ctx;
+    return false;
+}
+
+oc_log_ctx_t *OCGetAsyncLogSink(const oc_log_ctx_t *ctx)
+{
+    (void)ctx;
+    return NULL;
+}
+
+bool OCAsyncLogv(int level, const char *tag, const char *format, va_list args)
+{
+    (void)level;
+    (void)tag;
+    (void)format;
+    (void)args;
+    return false;
+}
+
+bool OCAsyncLog(int level, const char *tag, const char *logStr)
+{
+    (void)level;
+    (void)tag;
+    (void)logStr;
+    return false;
+}
+
+bool OCAsyncLogBuffer(int level, const char *tag, const uint8_t *buffer, size_t bufferSize)
+{
+    (void)level;
+    (void)tag;
+    (void)buffer;
+    (void)bufferSize;
+    return false;
+}
+
+#ifndef __TIZEN__
+oc_log_ctx_t *OCLogMakeAsyncContext(oc_log_ctx_t *sink, size_t ringSize)
+{
+    (void)sink;
+    (void)ringSize;
+    return NULL;
+}
+
+uint64_t OCLogGetDroppedCount(void)
+{
+    return 0;
+}
+#endif
+
+#endif
@@ -54,12 +54,56 @@
 #include "experimental/logger.h"
 #include "string.h"
 #include "experimental/logger_types.h"
+#include "asynclogger.h"
 
 // log level
 static int g_level = DEBUG;
 // private log messages are not logged unless they have been explicitly enabled by calling OCSetLogLevel().
 static bool g_hidePrivateLogEntries = true;
 
+// Maximum number of modules with their own log level, and maximum length of their tag
+#define MAX_TAG_LOG_LEVELS (32)
+#define MAX_TAG_LENGTH (64)
+
+typedef struct
+{
+    char tag[MAX_TAG_LENGTH];
+    int level;
+} TagLogLevel;
+
+// log levels set by OCSetTagLogLevel()
+static TagLogLevel g_tagLevels[MAX_TAG_LOG_LEVELS];
+static size_t g_tagLevelCount = 0;
+
+// The log levels are read without a lock: an entry is written before the count which
+// publishes it, and OCSetTagLogLevel() callers are serialized by g_tagLevelLock.
+#if defined(ARDUINO)
+#define LOAD_TAG_LEVEL_COUNT() (g_tagLevelCount)
+#define PUBLISH_TAG_LEVEL_COUNT(count) (g_tagLevelCount = (count))
+#define LOAD_TAG_LEVEL(entry) ((entry)->level)
+#define STORE_TAG_LEVEL(entry, value) ((entry)->level = (value))
+#define LOCK_TAG_LEVELS()
+#define UNLOCK_TAG_LEVELS()
+#elif defined(_MSC_VER)
+// Volatile accesses have acquire and release semantics with /volatile:ms, the default.
+static volatile LONG g_tagLevelLock = 0;
+#define LOAD_TAG_LEVEL_COUNT() (*(volatile size_t *)&g_tagLevelCount)
+#define PUBLISH_TAG_LEVEL_COUNT(count) (*(volatile size_t *)&g_tagLevelCount = (count))
+#define LOAD_TAG_LEVEL(entry) (*(volatile int *)&(entry)->level)
+#define STORE_TAG_LEVEL(entry, value) (*(volatile int *)&(entry)->level = (value))
+#define LOCK_TAG_LEVELS() while (InterlockedExchange(&g_tagLevelLock, 1)) { SwitchToThread(); }
+#define UNLOCK_TAG_LEVELS() InterlockedExchange(&g_tagLevelLock, 0)
+#else
+static bool g_tagLevelLock = false;
+#define LOAD_TAG_LEVEL_COUNT() __atomic_load_n(&g_tagLevelCount, __ATOMIC_ACQUIRE)
+#define PUBLISH_TAG_LEVEL_COUNT(count) \
+    __atomic_store_n(&g_tagLevelCount, (count), __ATOMIC_RELEASE)
+#define LOAD_TAG_LEVEL(entry) __atomic_load_n(&(entry)->level, __ATOMIC_RELAXED)
+#define STORE_TAG_LEVEL(entry, value) __atomic_store_n(&(entry)->level, (value), __ATOMIC_RELAXED)
+#define LOCK_TAG_LEVELS() while (__atomic_test_and_set(&g_tagLevelLock, __ATOMIC_ACQUIRE)) {}
+#define UNLOCK_TAG_LEVELS() __atomic_clear(&g_tagLevelLock, __ATOMIC_RELEASE)
+#endif
+
 #ifndef __TIZEN__
 static oc_log_ctx_t *logCtx = 0;
 #endif
@@ -118,15 +162,43 @@ static oc_log_level LEVEL_XTABLE[] = {OC_LOG_DEBUG, OC_LOG_INFO,
     {"DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
 #endif
 
+/**
+ * Get the log level of a module.
+ *
+ * @param tag[in] - Module name, may be NULL
+ *
+ * @return the level set by OCSetTagLogLevel() for the module, or the global level
+ */
+static int GetTagLogLevel(const char *tag)
+{
+#ifndef ARDUINO
+    if (tag)
+    {
+        size_t count = LOAD_TAG_LEVEL_COUNT();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (0 == strcmp(g_tagLevels[i].tag, tag))
+            {
+                return LOAD_TAG_LEVEL(&g_tagLevels[i]);
+            }
+        }
+    }
+#else
+    (void)tag;
+#endif
+    return g_level;
+}
+
 /**
  * Checks if a message should be logged, based on its priority level, and removes
  * the OC_LOG_PRIVATE_DATA bit if the message should be logged.
  *
  * @param level[in] - One of DEBUG, INFO, WARNING, ERROR, or FATAL plus possibly the OC_LOG_PRIVATE_DATA bit
+ * @param tag[in]   - Module name, may be NULL
  *
  * @return true if the message should be logged, false otherwise
  */
-static bool AdjustAndVerifyLogLevel(int* level)
+static bool AdjustAndVerifyLogLevel(int* level, const char *tag)
 {
     int localLevel = *level;
 
@@ -140,7 +212,7 @@ static bool AdjustAndVerifyLogLevel(int* level)
         localLevel &= ~OC_LOG_PRIVATE_DATA;
     }
 
-    if (g_level > localLevel)
+    if (GetTagLogLevel(tag) > localLevel)
     {
         return false;
     }
@@ -149,6 +221,43 @@ static bool AdjustAndVerifyLogLevel(int* level)
     return true;
 }
 
+bool OCLogIsEnabled(int level, const char *tag)
+{
+    return AdjustAndVerifyLogLevel(&level, tag);
+}
+
+bool OCSetTagLogLevel(const char *tag, LogLevel level)
+{
+    if (!tag || (strlen(tag) >= MAX_TAG_LENGTH))
+    {
+        return false;
+    }
+
+    bool result = false;
+    LOCK_TAG_LEVELS();
+    size_t count = g_tagLevelCount;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (0 == strcmp(g_tagLevels[i].tag, tag))
+        {
+            STORE_TAG_LEVEL(&g_tagLevels[i], (int)level);
+            result = true;
+            break;
+        }
+    }
+
+    if (!result && (count < MAX_TAG_LOG_LEVELS))
+    {
+        TagLogLevel *tagLevel = &g_tagLevels[count];
+        strcpy(tagLevel->tag, tag);
+        tagLevel->level = level;
+        PUBLISH_TAG_LEVEL_COUNT(count + 1);
+        result = true;
+    }
+    UNLOCK_TAG_LEVELS();
+    return result;
+}
+
 #ifndef ARDUINO
 
 /**
@@ -166,10 +275,17 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
+    {
+        return;
+    }
+
+#ifndef __TIZEN__
+    if (OCIsAsyncLogContext(logCtx) && OCAsyncLogBuffer(level, tag, buffer, bufferSize))
     {
         return;
     }
+#endif
 
     // No idea why the static initialization won't work here, it seems the compiler is convinced
     // that this is a variable-sized object.
@@ -216,9 +332,13 @@ void OCLogInit(void)
 void OCLogShutdown(void)
 {
 #if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
-    if (logCtx && logCtx->destroy)
+    // Log calls made from now on, including those of the sink, write to the default
+    // output rather than to a context which is being destroyed.
+    oc_log_ctx_t *ctx = logCtx;
+    logCtx = NULL;
+    if (ctx && ctx->destroy)
     {
-        logCtx->destroy(logCtx);
+        ctx->destroy(ctx);
     }
 #endif
 }
@@ -237,13 +357,24 @@ void OCLogv(int level, const char * tag, const char * format, ...)
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
 
-    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
     va_list args;
+    if (OCIsAsyncLogContext(logCtx))
+    {
+        va_start(args, format);
+        bool captured = OCAsyncLogv(level, tag, format, args);
+        va_end(args);
+        if (captured)
+        {
+            return;
+        }
+    }
+
+    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
     va_start(args, format);
     vsnprintf(buffer, sizeof buffer - 1, format, args);
     va_end(args);
@@ -265,11 +396,62 @@ void OCLog(int level, const char * tag, const char * logStr)
        return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
 
+    oc_log_ctx_t *ctx = logCtx;
+    if (OCIsAsyncLogContext(ctx))
+    {
+        if (OCAsyncLog(level, tag, logStr))
+        {
+            return;
+        }
+        // A record which cannot be captured is written synchronously to the sink.
+        ctx = OCGetAsyncLogSink(ctx);
+    }
+
+    OCLogOutput(ctx, level, tag, logStr, NULL);
+}
+
+void OCLogGetTimestamp(OCLogTimestamp *when)
+{
+    when->min = 0;
+    when->sec = 0;
+    when->ms = 0;
+#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
+    struct timespec now = { .tv_sec = 0, .tv_nsec = 0 };
+    clockid_t clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    clk = CLOCK_REALTIME_COARSE;
+#endif
+    if (!clock_gettime(clk, &now))
+    {
+        when->min = (now.tv_sec / 60) % 60;
+        when->sec = now.tv_sec % 60;
+        when->ms = now.tv_nsec / 1000000;
+    }
+#elif defined(_WIN32)
+    SYSTEMTIME systemTime = {0};
+    GetLocalTime(&systemTime);
+    when->min = (int)systemTime.wMinute;
+    when->sec = (int)systemTime.wSecond;
+    when->ms  = (int)systemTime.wMilliseconds;
+#else
+    struct timeval now;
+    if (!gettimeofday(&now, NULL))
+    {
+        when->min = (now.tv_sec / 60) % 60;
+        when->sec = now.tv_sec % 60;
+        when->ms = now.tv_usec * 1000;
+    }
+#endif
+}
+
+void OCLogOutput(oc_log_ctx_t *sink, int level, const char *tag, const char *logStr,
+                 const OCLogTimestamp *when)
+{
     switch(level)
     {
         case DEBUG_LITE:
@@ -283,6 +465,8 @@ void OCLog(int level, const char * tag, const char * logStr)
     }
 
    #ifdef __ANDROID__
+       (void)sink;
+       (void)when;
 
    #ifdef ADB_SHELL
        printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
@@ -291,44 +475,21 @@ void OCLog(int level, const char * tag, const char * logStr)
    #endif
 
    #else
-       if (logCtx && logCtx->write_level)
+       if (sink && sink->write_level)
        {
-           logCtx->write_level(logCtx, LEVEL_XTABLE[level], logStr);
+           sink->write_level(sink, LEVEL_XTABLE[level], logStr);
 
        }
        else
        {
-           int min = 0;
-           int sec = 0;
-           int ms = 0;
-   #if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-           struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
-           clockid_t clk = CLOCK_REALTIME;
-   #ifdef CLOCK_REALTIME_COARSE
-           clk = CLOCK_REALTIME_COARSE;
-   #endif
-           if (!clock_gettime(clk, &when))
+           OCLogTimestamp now;
+           if (!when)
            {
-               min = (when.tv_sec / 60) % 60;
-               sec = when.tv_sec % 60;
-               ms = when.tv_nsec / 1000000;
+               OCLogGetTimestamp(&now);
+               when = &now;
            }
-   #elif defined(_WIN32)
-           SYSTEMTIME systemTime = {0};
-           GetLocalTime(&systemTime);
-           min = (int)systemTime.wMinute;
-           sec = (int)systemTime.wSecond;
-           ms  = (int)systemTime.wMilliseconds;
-   #else
-           struct timeval now;
-           if (!gettimeofday(&now, NULL))
-           {
-               min = (now.tv_sec / 60) % 60;
-               sec = now.tv_sec % 60;
-               ms = now.tv_usec * 1000;
-           }
-   #endif
-           printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
+           printf("%02d:%02d.%03d %s: %s: %s\n", when->min, when->sec, when->ms,
+                  LEVEL[level], tag, logStr);
        }
    #endif
    }
@@ -360,7 +521,7 @@ void OCLogString(int level, PROGMEM const char * tag, const char * logStr)
       return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -398,7 +559,7 @@ void OCLogBuffer(int level, PROGMEM const char * tag,
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -442,7 +603,7 @@ void OCLog(int level, PROGMEM const char *tag, const int lineNum,
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -479,7 +640,7 @@ void OCLog(int level, PROGMEM const char *tag, const int lineNum,
 void OCLogv(int level, PROGMEM const char *tag, const int lineNum,
                 PROGMEM const char *format, ...)
 {
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -528,7 +689,7 @@ void OCLogv(int level, PROGMEM const char *tag, const int lineNum,
  */
 void OCLogv(int level, const char *tag, const __FlashStringHelper *format, ...)
 {
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
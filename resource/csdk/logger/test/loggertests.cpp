@@ -35,6 +35,9 @@ extern "C" {
 #include <string.h>
 
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 #include <stdint.h>
 using namespace std;
 
@@ -364,3 +367,96 @@ TEST(LoggerTest, LogBuffer) {
         EXPECT_STREQ(stdFileMD5, testFileMD5);
     }
 }
+
+//-----------------------------------------------------------------------------
+// Sink capturing the log strings written by the asynchronous logging context
+//-----------------------------------------------------------------------------
+static std::vector<std::string> capturedLogs;
+
+static size_t captureLogWrite(oc_log_ctx_t *ctx, const int level, const char *msg) {
+    (void)ctx;
+    (void)level;
+    capturedLogs.push_back(msg);
+    return strlen(msg);
+}
+
+static int sinkDestroyCount = 0;
+
+static void countSinkDestroy(oc_log_ctx_t *ctx) {
+    (void)ctx;
+    sinkDestroyCount++;
+}
+
+TEST(LoggerTest, TagLogLevel) {
+    const char *tag = "TagLogLevel";
+
+    EXPECT_TRUE(OCLogIsEnabled(INFO, tag));
+    EXPECT_TRUE(OCSetTagLogLevel(tag, ERROR));
+    EXPECT_FALSE(OCLogIsEnabled(INFO, tag));
+    EXPECT_TRUE(OCLogIsEnabled(ERROR, tag));
+    EXPECT_TRUE(OCLogIsEnabled(INFO, "OtherTag"));
+
+    EXPECT_TRUE(OCSetTagLogLevel(tag, DEBUG));
+    EXPECT_TRUE(OCLogIsEnabled(DEBUG, tag));
+    EXPECT_FALSE(OCSetTagLogLevel(NULL, DEBUG));
+}
+
+TEST(LoggerTest, TagLogLevelWhileLogging) {
+    // Levels are set by one thread while another one checks them.
+    const char *tags[] = { "TagA", "TagB", "TagC", "TagD" };
+    std::thread setter([&tags]() {
+        for (int i = 0; i < 1000; i++) {
+            OCSetTagLogLevel(tags[i % 4], (i % 2) ? ERROR : DEBUG);
+        }
+        for (int i = 0; i < 4; i++) {
+            OCSetTagLogLevel(tags[i], ERROR);
+        }
+    });
+    for (int i = 0; i < 1000; i++) {
+        OCLogIsEnabled(INFO, tags[i % 4]);
+    }
+    setter.join();
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_FALSE(OCLogIsEnabled(INFO, tags[i]));
+    }
+}
+
+TEST(LoggerTest, AsyncContext) {
+    const char *tag = "AsyncContext";
+
+    oc_log_ctx_t sink;
+    memset(&sink, 0, sizeof sink);
+    sink.write_level = captureLogWrite;
+    sink.destroy = countSinkDestroy;
+    capturedLogs.clear();
+    sinkDestroyCount = 0;
+
+    oc_log_ctx_t *ctx = OCLogMakeAsyncContext(&sink, 0);
+    ASSERT_TRUE(NULL != ctx);
+    EXPECT_TRUE(NULL == OCLogMakeAsyncContext(&sink, 0));
+    OCLogConfig(ctx);
+
+    char str[] = "string";
+    OIC_LOG_V(INFO, tag, "%d %5.2f %s %.*s %zu %%", 42, 3.14159, str, 3, "abcdef", (size_t)7);
+    // The string argument has been copied when the record was captured.
+    str[0] = 'X';
+    OIC_LOG(INFO, tag, "fixed string");
+    uint8_t buffer[20];
+    for (int i = 0; i < (int)(sizeof buffer); i++) {
+        buffer[i] = i;
+    }
+    OIC_LOG_BUFFER(INFO, tag, buffer, sizeof buffer);
+
+    OCLogShutdown();
+    OCLogConfig(NULL);
+
+    ASSERT_EQ(4u, capturedLogs.size());
+    EXPECT_EQ("42  3.14 string abc 7 %", capturedLogs[0]);
+    EXPECT_EQ("fixed string", capturedLogs[1]);
+    EXPECT_EQ("00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F ", capturedLogs[2]);
+    EXPECT_EQ("10 11 12 13 ", capturedLogs[3]);
+    EXPECT_EQ(0u, OCLogGetDroppedCount());
+    // The sink still belongs to the test.
+    EXPECT_EQ(0, sinkDestroyCount);
+}
@@ -116,6 +116,8 @@ typedef struct
 
 /**
  * Initialize the Routing Table Manager.
+ * The given tables are indexed by gateway id, endpoint id and address. They must be
+ * modified only through this module and released with ::RTMTerminate.
  * @param[in,out] gatewayTable      Gateway Routing Table.
  * @param[in,out] endpointTable     Endpoint Routing Table.
  * @return  ::OC_STACK_OK or Appropriate error code.
@@ -36,6 +36,784 @@
  */
 #define RM_TAG "OIC_RM_RAP"
 
+/**
+ * Initial number of buckets of an index, as a power of 2.
+ */
+#define RTM_INDEX_INITIAL_BITS 4
+
+/**
+ * Number of entries of the route cache, as a power of 2.
+ */
+#define RTM_ROUTE_CACHE_BITS 6
+#define RTM_ROUTE_CACHE_SIZE (1 << RTM_ROUTE_CACHE_BITS)
+
+/**
+ * Bucket of a hash among (1 << bits) buckets, taken from the high bits of the hash,
+ * which are the best mixed ones.
+ */
+#define RTM_HASH_BUCKET(hash, bits) ((0 == (bits)) ? 0 : ((uint32_t)(hash) >> (32 - (bits))))
+
+/**
+ * Node of an index, refers to an entry of a routing table.
+ */
+typedef struct RTMIndexNode
+{
+    uint32_t hash;                  /**< hash of the key of the entry. */
+    void *data;                     /**< indexed entry. */
+    size_t expiryPosition;          /**< position + 1 in the expiry heap, 0 if not in it. */
+    struct RTMIndexNode *next;      /**< next node of the bucket. */
+} RTMIndexNode_t;
+
+/**
+ * Hash index of the entries of a routing table.
+ */
+typedef struct
+{
+    RTMIndexNode_t **buckets;       /**< chained buckets. */
+    size_t size;                    /**< number of buckets. */
+    uint32_t bits;                  /**< log2 of the number of buckets. */
+    size_t count;                   /**< number of nodes. */
+} RTMIndex_t;
+
+/**
+ * Next hop resolved by RTMGetNextHop().
+ */
+typedef struct
+{
+    uint32_t generation;            /**< generation of the routes, 0 if unused. */
+    uint32_t gatewayId;             /**< destination gateway. */
+    RTMGatewayId_t *nextHop;        /**< next hop, or NULL if there is no route. */
+} RTMRouteCache_t;
+
+/**
+ * Indexes of the gateway table given to RTMInitialize().
+ */
+typedef struct
+{
+    const u_linklist_t *table;      /**< indexed gateway table, NULL if not indexed. */
+    RTMIndex_t gateways;            /**< RTMGatewayEntry_t by destination gateway id. */
+    RTMIndex_t interfaces;          /**< RTMDestIntfInfo_t by address and port. */
+    RTMIndexNode_t **expiry;        /**< min-heap of the interfaces by timeElapsed. */
+    size_t expiryCount;             /**< number of interfaces in the heap. */
+    size_t expirySize;              /**< capacity of the heap. */
+    uint32_t generation;            /**< incremented on each change of the routes. */
+    RTMRouteCache_t routeCache[RTM_ROUTE_CACHE_SIZE];
+} RTMGatewayIndex_t;
+
+/**
+ * Indexes of the endpoint table given to RTMInitialize().
+ */
+typedef struct
+{
+    const u_linklist_t *table;      /**< indexed endpoint table, NULL if not indexed. */
+    RTMIndex_t endpoints;           /**< RTMEndpointEntry_t by endpoint id. */
+    RTMIndex_t addresses;           /**< RTMEndpointEntry_t by address and port. */
+} RTMEndpointIndex_t;
+
+/**
+ * The routing tables are walked on each forwarded packet, so the tables given to
+ * RTMInitialize() are indexed. Other lists (payloads, removed entries) are walked.
+ */
+static RTMGatewayIndex_t g_gatewayIndex = { .generation = 1 };
+static RTMEndpointIndex_t g_endpointIndex;
+
+static uint32_t RTMHashId(uint32_t id)
+{
+    // Fibonacci hashing spreads sequential ids over the high bits, RTM_HASH_BUCKET()
+    // selects the buckets from them.
+    return id * 2654435761u;
+}
+
+static uint32_t RTMHashAddress(const CAEndpoint_t *address)
+{
+    // FNV-1a of the address string and the port.
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(address->addr) && '\0' != address->addr[i]; i++)
+    {
+        hash = (hash ^ (uint8_t)address->addr[i]) * 16777619u;
+    }
+    hash = (hash ^ (address->port & 0xFF)) * 16777619u;
+    hash = (hash ^ (address->port >> 8)) * 16777619u;
+    return hash;
+}
+
+static bool RTMIsSameAddress(const CAEndpoint_t *first, const CAEndpoint_t *second)
+{
+    return first->port == second->port &&
+           0 == strncmp(first->addr, second->addr, sizeof(first->addr));
+}
+
+static RTMIndexNode_t *RTMIndexFirst(const RTMIndex_t *index, uint32_t hash)
+{
+    if (0 == index->size)
+    {
+        return NULL;
+    }
+    return index->buckets[RTM_HASH_BUCKET(hash, index->bits)];
+}
+
+static RTMIndexNode_t *RTMIndexFind(const RTMIndex_t *index, uint32_t hash, const void *data)
+{
+    for (RTMIndexNode_t *node = RTMIndexFirst(index, hash); NULL != node; node = node->next)
+    {
+        if (data == node->data)
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+static void RTMIndexGrow(RTMIndex_t *index)
+{
+    uint32_t bits = index->size ? index->bits + 1 : RTM_INDEX_INITIAL_BITS;
+    size_t size = (size_t)1 << bits;
+    RTMIndexNode_t **buckets = (RTMIndexNode_t **) OICCalloc(size, sizeof(RTMIndexNode_t *));
+    if (NULL == buckets)
+    {
+        // Not fatal, the buckets only get longer.
+        OIC_LOG(WARNING, TAG, "Growing index failed");
+        return;
+    }
+
+    for (size_t i = 0; i < index->size; i++)
+    {
+        RTMIndexNode_t *node = index->buckets[i];
+        while (NULL != node)
+        {
+            RTMIndexNode_t *next = node->next;
+            node->next = buckets[RTM_HASH_BUCKET(node->hash, bits)];
+            buckets[RTM_HASH_BUCKET(node->hash, bits)] = node;
+            node = next;
+        }
+    }
+    OICFree(index->buckets);
+    index->buckets = buckets;
+    index->size = size;
+    index->bits = bits;
+}
+
+static RTMIndexNode_t *RTMIndexInsert(RTMIndex_t *index, uint32_t hash, void *data)
+{
+    if (index->count >= index->size)
+    {
+        RTMIndexGrow(index);
+        if (0 == index->size)
+        {
+            return NULL;
+        }
+    }
+
+    RTMIndexNode_t *node = (RTMIndexNode_t *) OICCalloc(1, sizeof(RTMIndexNode_t));
+    if (NULL == node)
+    {
+        OIC_LOG(ERROR, TAG, "Calloc failed for index node");
+        return NULL;
+    }
+    node->hash = hash;
+    node->data = data;
+    node->next = index->buckets[RTM_HASH_BUCKET(hash, index->bits)];
+    index->buckets[RTM_HASH_BUCKET(hash, index->bits)] = node;
+    index->count++;
+    return node;
+}
+
+static void RTMIndexRemove(RTMIndex_t *index, RTMIndexNode_t *node)
+{
+    RTMIndexNode_t **link = &index->buckets[RTM_HASH_BUCKET(node->hash, index->bits)];
+    while (*link != node)
+    {
+        link = &(*link)->next;
+    }
+    *link = node->next;
+    index->count--;
+    OICFree(node);
+}
+
+static void RTMIndexClear(RTMIndex_t *index)
+{
+    for (size_t i = 0; i < index->size; i++)
+    {
+        RTMIndexNode_t *node = index->buckets[i];
+        while (NULL != node)
+        {
+            RTMIndexNode_t *next = node->next;
+            OICFree(node);
+            node = next;
+        }
+    }
+    OICFree(index->buckets);
+    index->buckets = NULL;
+    index->size = 0;
+    index->bits = 0;
+    index->count = 0;
+}
+
+static uint64_t RTMExpiryTime(const RTMIndexNode_t *node)
+{
+    return ((const RTMDestIntfInfo_t *) node->data)->timeElapsed;
+}
+
+static void RTMPlaceExpiry(size_t position, RTMIndexNode_t *node)
+{
+    g_gatewayIndex.expiry[position] = node;
+    node->expiryPosition = position + 1;
+}
+
+static void RTMSiftUpExpiry(size_t position)
+{
+    RTMIndexNode_t *node = g_gatewayIndex.expiry[position];
+    while (position > 0)
+    {
+        size_t parent = (position - 1) / 2;
+        if (RTMExpiryTime(g_gatewayIndex.expiry[parent]) <= RTMExpiryTime(node))
+        {
+            break;
+        }
+        RTMPlaceExpiry(position, g_gatewayIndex.expiry[parent]);
+        position = parent;
+    }
+    RTMPlaceExpiry(position, node);
+}
+
+static void RTMSiftDownExpiry(size_t position)
+{
+    RTMIndexNode_t *node = g_gatewayIndex.expiry[position];
+    for (;;)
+    {
+        size_t child = 2 * position + 1;
+        if (child >= g_gatewayIndex.expiryCount)
+        {
+            break;
+        }
+        if ((child + 1 < g_gatewayIndex.expiryCount) &&
+            (RTMExpiryTime(g_gatewayIndex.expiry[child + 1]) <
+             RTMExpiryTime(g_gatewayIndex.expiry[child])))
+        {
+            child++;
+        }
+        if (RTMExpiryTime(node) <= RTMExpiryTime(g_gatewayIndex.expiry[child]))
+        {
+            break;
+        }
+        RTMPlaceExpiry(position, g_gatewayIndex.expiry[child]);
+        position = child;
+    }
+    RTMPlaceExpiry(position, node);
+}
+
+static bool RTMPushExpiry(RTMIndexNode_t *node)
+{
+    if (g_gatewayIndex.expiryCount == g_gatewayIndex.expirySize)
+    {
+        size_t size = g_gatewayIndex.expirySize ? g_gatewayIndex.expirySize * 2 :
+                      ((size_t)1 << RTM_INDEX_INITIAL_BITS);
+        RTMIndexNode_t **expiry =
+            (RTMIndexNode_t **) OICRealloc(g_gatewayIndex.expiry, size * sizeof(RTMIndexNode_t *));
+        if (NULL == expiry)
+        {
+            OIC_LOG(ERROR, TAG, "Growing expiry heap failed");
+            return false;
+        }
+        g_gatewayIndex.expiry = expiry;
+        g_gatewayIndex.expirySize = size;
+    }
+
+    size_t position = g_gatewayIndex.expiryCount++;
+    RTMPlaceExpiry(position, node);
+    RTMSiftUpExpiry(position);
+    return true;
+}
+
+static void RTMRemoveExpiry(RTMIndexNode_t *node)
+{
+    if (0 == node->expiryPosition)
+    {
+        return;
+    }
+
+    size_t position = node->expiryPosition - 1;
+    node->expiryPosition = 0;
+    g_gatewayIndex.expiryCount--;
+    if (position == g_gatewayIndex.expiryCount)
+    {
+        return;
+    }
+
+    // Move the last interface into the hole, then restore the heap order around it.
+    RTMIndexNode_t *moved = g_gatewayIndex.expiry[g_gatewayIndex.expiryCount];
+    RTMPlaceExpiry(position, moved);
+    RTMSiftDownExpiry(position);
+    RTMSiftUpExpiry(moved->expiryPosition - 1);
+}
+
+/*
+ * Adds the interfaces which are not refreshed since GATEWAY_ALIVE_TIMEOUT to the list,
+ * visiting only the expired part of the heap.
+ */
+static void RTMCollectExpired(size_t position, uint64_t presentTime, u_linklist_t *invalidTable)
+{
+    if (position >= g_gatewayIndex.expiryCount)
+    {
+        return;
+    }
+
+    RTMDestIntfInfo_t *destCheck = g_gatewayIndex.expiry[position]->data;
+    if (GATEWAY_ALIVE_TIMEOUT >= (presentTime - destCheck->timeElapsed))
+    {
+        return;
+    }
+
+    destCheck->isValid = false;
+    u_linklist_add(invalidTable, (void *)destCheck);
+    RTMCollectExpired(2 * position + 1, presentTime, invalidTable);
+    RTMCollectExpired(2 * position + 2, presentTime, invalidTable);
+}
+
+static bool RTMIsGatewayTableIndexed(const u_linklist_t *gatewayTable)
+{
+    return NULL != gatewayTable && gatewayTable == g_gatewayIndex.table;
+}
+
+static bool RTMIsEndpointTableIndexed(const u_linklist_t *endpointTable)
+{
+    return NULL != endpointTable && endpointTable == g_endpointIndex.table;
+}
+
+/*
+ * Drops the indexes of the gateway table, which is walked from then on.
+ */
+static void RTMResetGatewayIndex()
+{
+    RTMIndexClear(&g_gatewayIndex.gateways);
+    RTMIndexClear(&g_gatewayIndex.interfaces);
+    OICFree(g_gatewayIndex.expiry);
+    g_gatewayIndex.expiry = NULL;
+    g_gatewayIndex.expiryCount = 0;
+    g_gatewayIndex.expirySize = 0;
+    g_gatewayIndex.table = NULL;
+    g_gatewayIndex.generation++;
+}
+
+static void RTMResetEndpointIndex()
+{
+    RTMIndexClear(&g_endpointIndex.endpoints);
+    RTMIndexClear(&g_endpointIndex.addresses);
+    g_endpointIndex.table = NULL;
+}
+
+static bool RTMAttachDestIntf(RTMDestIntfInfo_t *destIntf)
+{
+    RTMIndexNode_t *node = RTMIndexInsert(&g_gatewayIndex.interfaces,
+                                          RTMHashAddress(&destIntf->destIntfAddr), destIntf);
+    if (NULL == node)
+    {
+        return false;
+    }
+    if (!RTMPushExpiry(node))
+    {
+        RTMIndexRemove(&g_gatewayIndex.interfaces, node);
+        return false;
+    }
+    return true;
+}
+
+static void RTMDetachDestIntf(RTMDestIntfInfo_t *destIntf)
+{
+    RTMIndexNode_t *node = RTMIndexFind(&g_gatewayIndex.interfaces,
+                                        RTMHashAddress(&destIntf->destIntfAddr), destIntf);
+    if (NULL != node)
+    {
+        RTMRemoveExpiry(node);
+        RTMIndexRemove(&g_gatewayIndex.interfaces, node);
+    }
+}
+
+static bool RTMAttachGatewayEntry(RTMGatewayEntry_t *entry)
+{
+    if (NULL == entry || NULL == entry->destination)
+    {
+        return true;
+    }
+
+    if (NULL == RTMIndexInsert(&g_gatewayIndex.gateways,
+                               RTMHashId(entry->destination->gatewayId), entry))
+    {
+        return false;
+    }
+    g_gatewayIndex.generation++;
+
+    for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
+    {
+        RTMDestIntfInfo_t *destIntf = u_arraylist_get(entry->destination->destIntfAddr, i);
+        if (NULL != destIntf && !RTMAttachDestIntf(destIntf))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void RTMDetachGatewayEntry(RTMGatewayEntry_t *entry)
+{
+    if (NULL == entry || NULL == entry->destination)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
+    {
+        RTMDestIntfInfo_t *destIntf = u_arraylist_get(entry->destination->destIntfAddr, i);
+        if (NULL != destIntf)
+        {
+            RTMDetachDestIntf(destIntf);
+        }
+    }
+
+    RTMIndexNode_t *node = RTMIndexFind(&g_gatewayIndex.gateways,
+                                        RTMHashId(entry->destination->gatewayId), entry);
+    if (NULL != node)
+    {
+        RTMIndexRemove(&g_gatewayIndex.gateways, node);
+    }
+    g_gatewayIndex.generation++;
+}
+
+static bool RTMAttachEndpointEntry(RTMEndpointEntry_t *entry)
+{
+    RTMIndexNode_t *node = RTMIndexInsert(&g_endpointIndex.endpoints,
+                                          RTMHashId(entry->endpointId), entry);
+    if (NULL == node)
+    {
+        return false;
+    }
+    if (NULL == RTMIndexInsert(&g_endpointIndex.addresses,
+                               RTMHashAddress(&entry->destIntfAddr), entry))
+    {
+        RTMIndexRemove(&g_endpointIndex.endpoints, node);
+        return false;
+    }
+    return true;
+}
+
+static void RTMDetachEndpointEntry(RTMEndpointEntry_t *entry)
+{
+    RTMIndexNode_t *node = RTMIndexFind(&g_endpointIndex.endpoints,
+                                        RTMHashId(entry->endpointId), entry);
+    if (NULL != node)
+    {
+        RTMIndexRemove(&g_endpointIndex.endpoints, node);
+    }
+    node = RTMIndexFind(&g_endpointIndex.addresses, RTMHashAddress(&entry->destIntfAddr), entry);
+    if (NULL != node)
+    {
+        RTMIndexRemove(&g_endpointIndex.addresses, node);
+    }
+}
+
+/*
+ * Indexes the entries of the gateway table, or leaves it to be walked if memory is short.
+ */
+static void RTMIndexGatewayTable(const u_linklist_t *gatewayTable)
+{
+    RTMResetGatewayIndex();
+    g_gatewayIndex.table = gatewayTable;
+
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(gatewayTable, &iterTable);
+    while (NULL != iterTable)
+    {
+        if (!RTMAttachGatewayEntry(u_linklist_get_data(iterTable)))
+        {
+            OIC_LOG(ERROR, TAG, "Indexing gateway table failed, it will be walked");
+            RTMResetGatewayIndex();
+            return;
+        }
+        u_linklist_get_next(&iterTable);
+    }
+}
+
+static void RTMIndexEndpointTable(const u_linklist_t *endpointTable)
+{
+    RTMResetEndpointIndex();
+    g_endpointIndex.table = endpointTable;
+
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(endpointTable, &iterTable);
+    while (NULL != iterTable)
+    {
+        RTMEndpointEntry_t *entry = u_linklist_get_data(iterTable);
+        if (NULL != entry && !RTMAttachEndpointEntry(entry))
+        {
+            OIC_LOG(ERROR, TAG, "Indexing endpoint table failed, it will be walked");
+            RTMResetEndpointIndex();
+            return;
+        }
+        u_linklist_get_next(&iterTable);
+    }
+}
+
+/*
+ * Keeps the indexes in sync with an entry added to the gateway table.
+ */
+static void RTMGatewayEntryAdded(RTMGatewayEntry_t *entry, const u_linklist_t *gatewayTable)
+{
+    if (RTMIsGatewayTableIndexed(gatewayTable) && !RTMAttachGatewayEntry(entry))
+    {
+        OIC_LOG(ERROR, TAG, "Indexing gateway entry failed, table will be walked");
+        RTMResetGatewayIndex();
+    }
+}
+
+static void RTMGatewayEntryRemoved(RTMGatewayEntry_t *entry, const u_linklist_t *gatewayTable)
+{
+    if (RTMIsGatewayTableIndexed(gatewayTable))
+    {
+        RTMDetachGatewayEntry(entry);
+    }
+}
+
+static void RTMDestIntfAdded(RTMDestIntfInfo_t *destIntf, const u_linklist_t *gatewayTable)
+{
+    if (RTMIsGatewayTableIndexed(gatewayTable) && !RTMAttachDestIntf(destIntf))
+    {
+        OIC_LOG(ERROR, TAG, "Indexing interface failed, table will be walked");
+        RTMResetGatewayIndex();
+    }
+}
+
+/*
+ * Frees an interface address, removing it from the indexes if it is indexed.
+ */
+static void RTMFreeDestIntf(RTMDestIntfInfo_t *destIntf)
+{
+    if (NULL != destIntf && NULL != g_gatewayIndex.table)
+    {
+        RTMDetachDestIntf(destIntf);
+    }
+    OICFree(destIntf);
+}
+
+/*
+ * Frees the interface addresses of a gateway, which has no interface address afterwards.
+ */
+static void RTMFreeDestIntfList(RTMGatewayId_t *gateway)
+{
+    while (u_arraylist_length(gateway->destIntfAddr) > 0)
+    {
+        RTMFreeDestIntf(u_arraylist_remove(gateway->destIntfAddr, 0));
+    }
+    u_arraylist_free(&(gateway->destIntfAddr));
+}
+
+/*
+ * Allocates an interface address refreshed now.
+ */
+static RTMDestIntfInfo_t *RTMCreateDestIntf(const RTMDestIntfInfo_t *destInterfaces)
+{
+    RTMDestIntfInfo_t *destAdr = (RTMDestIntfInfo_t *) OICCalloc(1, sizeof(RTMDestIntfInfo_t));
+    if (NULL == destAdr)
+    {
+        return NULL;
+    }
+    *destAdr = *destInterfaces;
+    destAdr->timeElapsed = RTMGetCurrentTime();
+    destAdr->isValid = true;
+    return destAdr;
+}
+
+/*
+ * Refreshes the time of an interface address, which moves it down in the expiry heap.
+ */
+static void RTMRefreshDestIntf(RTMDestIntfInfo_t *destIntf)
+{
+    destIntf->timeElapsed = RTMGetCurrentTime();
+    if (NULL == g_gatewayIndex.table)
+    {
+        return;
+    }
+    RTMIndexNode_t *node = RTMIndexFind(&g_gatewayIndex.interfaces,
+                                        RTMHashAddress(&destIntf->destIntfAddr), destIntf);
+    if (NULL != node && 0 != node->expiryPosition)
+    {
+        RTMSiftDownExpiry(node->expiryPosition - 1);
+    }
+}
+
+static RTMDestIntfInfo_t *RTMFindDestIntf(const RTMGatewayId_t *gateway,
+                                          const CAEndpoint_t *address)
+{
+    for (size_t i = 0; i < u_arraylist_length(gateway->destIntfAddr); i++)
+    {
+        RTMDestIntfInfo_t *destCheck = u_arraylist_get(gateway->destIntfAddr, i);
+        if (NULL != destCheck && RTMIsSameAddress(&destCheck->destIntfAddr, address))
+        {
+            return destCheck;
+        }
+    }
+    return NULL;
+}
+
+static RTMGatewayEntry_t *RTMFindGatewayEntry(uint32_t gatewayId,
+                                              const u_linklist_t *gatewayTable)
+{
+    if (RTMIsGatewayTableIndexed(gatewayTable))
+    {
+        uint32_t hash = RTMHashId(gatewayId);
+        for (RTMIndexNode_t *node = RTMIndexFirst(&g_gatewayIndex.gateways, hash);
+             NULL != node; node = node->next)
+        {
+            RTMGatewayEntry_t *entry = node->data;
+            if (hash == node->hash && gatewayId == entry->destination->gatewayId)
+            {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(gatewayTable, &iterTable);
+    while (NULL != iterTable)
+    {
+        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
+        if (NULL != entry && NULL != entry->destination &&
+            gatewayId == entry->destination->gatewayId)
+        {
+            return entry;
+        }
+        u_linklist_get_next(&iterTable);
+    }
+    return NULL;
+}
+
+static RTMEndpointEntry_t *RTMFindEndpointEntry(uint16_t endpointId,
+                                                const u_linklist_t *endpointTable)
+{
+    if (RTMIsEndpointTableIndexed(endpointTable))
+    {
+        uint32_t hash = RTMHashId(endpointId);
+        for (RTMIndexNode_t *node = RTMIndexFirst(&g_endpointIndex.endpoints, hash);
+             NULL != node; node = node->next)
+        {
+            RTMEndpointEntry_t *entry = node->data;
+            if (hash == node->hash && endpointId == entry->endpointId)
+            {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(endpointTable, &iterTable);
+    while (NULL != iterTable)
+    {
+        RTMEndpointEntry_t *entry = u_linklist_get_data(iterTable);
+        if (NULL != entry && endpointId == entry->endpointId)
+        {
+            return entry;
+        }
+        u_linklist_get_next(&iterTable);
+    }
+    return NULL;
+}
+
+static RTMEndpointEntry_t *RTMFindEndpointByAddress(const CAEndpoint_t *address,
+                                                    const u_linklist_t *endpointTable)
+{
+    if (RTMIsEndpointTableIndexed(endpointTable))
+    {
+        uint32_t hash = RTMHashAddress(address);
+        for (RTMIndexNode_t *node = RTMIndexFirst(&g_endpointIndex.addresses, hash);
+             NULL != node; node = node->next)
+        {
+            RTMEndpointEntry_t *entry = node->data;
+            if (hash == node->hash && RTMIsSameAddress(&entry->destIntfAddr, address))
+            {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(endpointTable, &iterTable);
+    while (NULL != iterTable)
+    {
+        RTMEndpointEntry_t *entry = u_linklist_get_data(iterTable);
+        if (NULL != entry && RTMIsSameAddress(&entry->destIntfAddr, address))
+        {
+            return entry;
+        }
+        u_linklist_get_next(&iterTable);
+    }
+    return NULL;
+}
+
+/*
+ * Finds the interface address of a neighbour gateway, with an observer if requested.
+ */
+static RTMDestIntfInfo_t *RTMFindNeighbourIntf(const CAEndpoint_t *address, bool observed,
+                                               const u_linklist_t *gatewayTable)
+{
+    if (RTMIsGatewayTableIndexed(gatewayTable))
+    {
+        uint32_t hash = RTMHashAddress(address);
+        for (RTMIndexNode_t *node = RTMIndexFirst(&g_gatewayIndex.interfaces, hash);
+             NULL != node; node = node->next)
+        {
+            RTMDestIntfInfo_t *destCheck = node->data;
+            if (hash == node->hash && RTMIsSameAddress(&destCheck->destIntfAddr, address) &&
+                (!observed || 0 != destCheck->observerId))
+            {
+                return destCheck;
+            }
+        }
+        return NULL;
+    }
+
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(gatewayTable, &iterTable);
+    while (NULL != iterTable)
+    {
+        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
+        if (NULL != entry && NULL != entry->destination)
+        {
+            for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
+            {
+                RTMDestIntfInfo_t *destCheck =
+                    u_arraylist_get(entry->destination->destIntfAddr, i);
+                if (NULL != destCheck && RTMIsSameAddress(&destCheck->destIntfAddr, address) &&
+                    (!observed || 0 != destCheck->observerId))
+                {
+                    return destCheck;
+                }
+            }
+        }
+        u_linklist_get_next(&iterTable);
+    }
+    return NULL;
+}
+
+/*
+ * Removes the node of an entry from a table.
+ */
+static OCStackResult RTMRemoveTableEntry(const void *data, u_linklist_t *table)
+{
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(table, &iterTable);
+    while (NULL != iterTable)
+    {
+        if (data == u_linklist_get_data(iterTable))
+        {
+            return u_linklist_remove(table, &iterTable);
+        }
+        u_linklist_get_next(&iterTable);
+    }
+    return OC_STACK_ERROR;
+}
+
 OCStackResult RTMInitialize(u_linklist_t **gatewayTable, u_linklist_t **endpointTable)
 {
     OIC_LOG(DEBUG, TAG, "RTMInitialize IN");
@@ -62,6 +840,9 @@ OCStackResult RTMInitialize(u_linklist_t **gatewayTable, u_linklist_t **endpoint
            return OC_STACK_ERROR;
         }
     }
+
+    RTMIndexGatewayTable(*gatewayTable);
+    RTMIndexEndpointTable(*endpointTable);
     OIC_LOG(DEBUG, TAG, "RTMInitialize OUT");
     return OC_STACK_OK;
 }
@@ -77,6 +858,11 @@ OCStackResult RTMFreeGatewayRouteTable(u_linklist_t **gatewayTable)
         return OC_STACK_OK;
     }
 
+    if (RTMIsGatewayTableIndexed(*gatewayTable))
+    {
+        RTMResetGatewayIndex();
+    }
+
     u_linklist_iterator_t *iterTable = NULL;
     u_linklist_init_iterator(*gatewayTable, &iterTable);
     while (NULL != iterTable)
@@ -84,15 +870,7 @@ OCStackResult RTMFreeGatewayRouteTable(u_linklist_t **gatewayTable)
         RTMGatewayEntry_t *hop = u_linklist_get_data(iterTable);
         if (NULL != hop && NULL != hop->destination)
         {
-            while (u_arraylist_length(hop->destination->destIntfAddr) > 0)
-            {
-                if (NULL != hop->destination)
-                {
-                    RTMDestIntfInfo_t *data = u_arraylist_remove(hop->destination->destIntfAddr, 0);
-                    OICFree(data);
-                }
-            }
-            u_arraylist_free(&(hop->destination->destIntfAddr));
+            RTMFreeDestIntfList(hop->destination);
             OICFree(hop->destination);
             // No need to free next hop as it is already freed during it's gateway free
             OICFree(hop);
@@ -121,6 +899,11 @@ OCStackResult RTMFreeEndpointRouteTable(u_linklist_t **endpointTable)
         return OC_STACK_OK;
     }
 
+    if (RTMIsEndpointTableIndexed(*endpointTable))
+    {
+        RTMResetEndpointIndex();
+    }
+
     u_linklist_iterator_t *iterTable = NULL;
     u_linklist_init_iterator(*endpointTable, &iterTable);
     while (NULL != iterTable)
@@ -158,12 +941,7 @@ OCStackResult RTMFreeGatewayIdList(u_linklist_t **gatewayIdTable)
         RTMGatewayId_t *hop = u_linklist_get_data(iterTable);
         if (NULL != hop)
         {
-            while (u_arraylist_length(hop->destIntfAddr) > 0)
-            {
-               RTMDestIntfInfo_t *data = u_arraylist_remove(hop->destIntfAddr, 0);
-               OICFree(data);
-            }
-            u_arraylist_free(&(hop->destIntfAddr));
+            RTMFreeDestIntfList(hop);
             OICFree(hop);
 
             OCStackResult ret = u_linklist_remove(*gatewayIdTable, &iterTable);
@@ -237,6 +1015,10 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
             OIC_LOG(ERROR, TAG, "u_linklist_create failed");
             return OC_STACK_NO_MEMORY;
         }
+        if (NULL == g_gatewayIndex.table)
+        {
+            RTMIndexGatewayTable(*gatewayTable);
+        }
     }
 
     if (1 == routeCost && 0 != nextHop)
@@ -251,40 +1033,19 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
         return OC_STACK_ERROR;
     }
 
-    u_linklist_iterator_t *destNode = NULL;
-    RTMGatewayId_t *gatewayNodeMap = NULL;   // Gateway id ponter can be mapped to NextHop of entry.
+    // Gateway id pointer can be mapped to NextHop of entry.
+    RTMGatewayId_t *gatewayNodeMap = NULL;
+    // Entry with this gateway id (To update entry instead of add new entry).
+    RTMGatewayEntry_t *entry = RTMFindGatewayEntry(gatewayId, *gatewayTable);
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(*gatewayTable, &iterTable);
-    // Iterate over gateway list to find if already entry with this gatewayid is present.
-    while (NULL != iterTable)
+    // To find pointer of gateway id for a node provided next hop equals to existing gateway id.
+    if (0 != nextHop)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
-        if (NULL == entry)
-        {
-            break;
-        }
-
-        // To save node with same gateway id (To update entry instead of add new entry).
-        if (NULL == destNode && NULL != entry->destination &&
-            (gatewayId == entry->destination->gatewayId))
-        {
-            destNode = iterTable;
-        }
-
-        // To find pointer of gateway id for a node provided next hop equals to existing gateway id.
-        if (0 != nextHop && NULL != entry->destination &&
-            nextHop == entry->destination->gatewayId)
-        {
-            gatewayNodeMap = entry->destination;
-        }
-
-        if (NULL != destNode && NULL != gatewayNodeMap)
+        RTMGatewayEntry_t *nextHopEntry = RTMFindGatewayEntry(nextHop, *gatewayTable);
+        if (NULL != nextHopEntry)
         {
-            break;
+            gatewayNodeMap = nextHopEntry->destination;
         }
-
-        u_linklist_get_next(&iterTable);
     }
 
     if (1 < routeCost && NULL == gatewayNodeMap)
@@ -294,11 +1055,9 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
     }
 
     //Logic to update entry if it is already destination present or to add new entry.
-    if (NULL != destNode)
+    if (NULL != entry)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(destNode);
-
-        if (NULL != entry  && 1 == entry->routeCost && 0 == nextHop)
+        if (1 == entry->routeCost && 0 == nextHop)
         {
             if (NULL == destInterfaces)
             {
@@ -313,7 +1072,7 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
             }
             return update;
         }
-        else if (NULL != entry  && entry->routeCost >= routeCost)
+        else if (entry->routeCost >= routeCost)
         {
             if (entry->routeCost == routeCost && NULL != entry->nextHop &&
                 (nextHop == entry->nextHop->gatewayId))
@@ -325,13 +1084,17 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
             //Mapped nextHop gateway to another entries having gateway as destination.
             if (NULL != gatewayNodeMap)
             {
+                // The route changes, the interfaces of the previous route are dropped.
+                RTMFreeDestIntfList(entry->destination);
+                g_gatewayIndex.generation++;
                 entry->destination->gatewayId = gatewayId;
                 entry->nextHop = gatewayNodeMap;
-                entry->destination->destIntfAddr = NULL;
                 entry->routeCost = routeCost;
             }
             else if (0 == nextHop)
             {
+                RTMFreeDestIntfList(entry->destination);
+                g_gatewayIndex.generation++;
                 entry->routeCost = 1;
                 // Entry can't be updated if Next hop is not same as existing Destinations of Table.
                 OIC_LOG(DEBUG, TAG, "Updating the gateway");
@@ -343,17 +1106,13 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
                     return OC_STACK_ERROR;
                 }
 
-                RTMDestIntfInfo_t *destAdr =
-                    (RTMDestIntfInfo_t *) OICCalloc(1, sizeof(RTMDestIntfInfo_t));
+                RTMDestIntfInfo_t *destAdr = RTMCreateDestIntf(destInterfaces);
                 if (NULL == destAdr)
                 {
                     OIC_LOG(ERROR, TAG, "Failed to Calloc destAdr");
                     return OC_STACK_ERROR;
                 }
 
-                *destAdr = *destInterfaces;
-                destAdr->timeElapsed = RTMGetCurrentTime();
-                destAdr->isValid = true;
                 bool result =
                     u_arraylist_add(entry->destination->destIntfAddr, (void *)destAdr);
                 if (!result)
@@ -362,6 +1121,7 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
                     OICFree(destAdr);
                     return OC_STACK_ERROR;
                 }
+                RTMDestIntfAdded(destAdr, *gatewayTable);
             }
             else
             {
@@ -370,16 +1130,16 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
             }
 
         }
-        else if (NULL != entry  && entry->routeCost < routeCost)
+        else
         {
             OIC_LOG(ERROR, TAG, "Adding Gateway Failed as Route cost is more than old");
             return OC_STACK_ERROR;
         }
 
         // Logic to add updated node to Head of list as route cost is 1.
-        if (1 == routeCost && NULL != entry)
+        if (1 == routeCost)
         {
-            OCStackResult res = u_linklist_remove(*gatewayTable, &destNode);
+            OCStackResult res = RTMRemoveTableEntry(entry, *gatewayTable);
             if (OC_STACK_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "Removing node failed");
@@ -416,8 +1176,7 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
         if (NULL != destInterfaces && strlen((*destInterfaces).destIntfAddr.addr) > 0)
         {
             hopEntry->destination->destIntfAddr = u_arraylist_create();
-            RTMDestIntfInfo_t *destAdr =
-                (RTMDestIntfInfo_t *) OICCalloc(1, sizeof(RTMDestIntfInfo_t));
+            RTMDestIntfInfo_t *destAdr = RTMCreateDestIntf(destInterfaces);
             if (NULL == destAdr)
             {
                 OIC_LOG(ERROR, TAG, "Calloc failed for destAdr");
@@ -427,9 +1186,6 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
                 return OC_STACK_ERROR;
             }
 
-            *destAdr = *destInterfaces;
-            destAdr->timeElapsed = RTMGetCurrentTime();
-            destAdr->isValid = true;
             u_arraylist_add(hopEntry->destination->destIntfAddr, (void *)destAdr);
         }
         else
@@ -450,13 +1206,7 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
         else
         {
             OIC_LOG(ERROR, TAG, "Adding Gateway Failed as Next Hop is invalid");
-            while (u_arraylist_length(hopEntry->destination->destIntfAddr) > 0)
-            {
-                RTMDestIntfInfo_t *data =
-                    u_arraylist_remove(hopEntry->destination->destIntfAddr, 0);
-                OICFree(data);
-            }
-            u_arraylist_free(&(hopEntry->destination->destIntfAddr));
+            RTMFreeDestIntfList(hopEntry->destination);
             OICFree(hopEntry->destination);
             OICFree(hopEntry);
 
@@ -476,16 +1226,12 @@ OCStackResult RTMAddGatewayEntry(uint32_t gatewayId, uint32_t nextHop, uint32_t
         if (OC_STACK_OK != ret)
         {
             OIC_LOG(ERROR, TAG, "Adding Gateway Entry to Routing Table failed");
-            while (u_arraylist_length(hopEntry->destination->destIntfAddr) > 0)
-            {
-                RTMDestIntfInfo_t *data = u_arraylist_remove(hopEntry->destination->destIntfAddr, 0);
-                OICFree(data);
-            }
-            u_arraylist_free(&(hopEntry->destination->destIntfAddr));
+            RTMFreeDestIntfList(hopEntry->destination);
             OICFree(hopEntry->destination);
             OICFree(hopEntry);
             return OC_STACK_ERROR;
         }
+        RTMGatewayEntryAdded(hopEntry, *gatewayTable);
     }
     OIC_LOG(DEBUG, TAG, "OUT");
     return OC_STACK_OK;
@@ -506,25 +1252,19 @@ OCStackResult RTMAddEndpointEntry(uint16_t *endpointId, const CAEndpoint_t *dest
             OIC_LOG(ERROR, TAG, "u_linklist_create failed");
             return OC_STACK_NO_MEMORY;
         }
+        if (NULL == g_endpointIndex.table)
+        {
+            RTMIndexEndpointTable(*endpointTable);
+        }
     }
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(*endpointTable, &iterTable);
-    // Iterate over gateway list to find if already entry with this gatewayid is present.
-    while (NULL != iterTable)
+    // Find if already entry with this address is present.
+    RTMEndpointEntry_t *entry = RTMFindEndpointByAddress(destAddr, *endpointTable);
+    if (NULL != entry)
     {
-        RTMEndpointEntry_t *entry =
-            (RTMEndpointEntry_t *) u_linklist_get_data(iterTable);
-
-        if (NULL != entry && (0 == memcmp(destAddr->addr, entry->destIntfAddr.addr,
-                              strlen(entry->destIntfAddr.addr)))
-            && destAddr->port == entry->destIntfAddr.port)
-        {
-            *endpointId = entry->endpointId;
-            OIC_LOG(ERROR, TAG, "Adding failed as Enpoint Entry Already present in Table");
-            return OC_STACK_DUPLICATE_REQUEST;
-        }
-        u_linklist_get_next(&iterTable);
+        *endpointId = entry->endpointId;
+        OIC_LOG(ERROR, TAG, "Adding failed as Enpoint Entry Already present in Table");
+        return OC_STACK_DUPLICATE_REQUEST;
     }
 
     // Filling Entry.
@@ -546,6 +1286,12 @@ OCStackResult RTMAddEndpointEntry(uint16_t *endpointId, const CAEndpoint_t *dest
        OICFree(hopEntry);
        return OC_STACK_ERROR;
     }
+
+    if (RTMIsEndpointTableIndexed(*endpointTable) && !RTMAttachEndpointEntry(hopEntry))
+    {
+        OIC_LOG(ERROR, TAG, "Indexing endpoint entry failed, table will be walked");
+        RTMResetEndpointIndex();
+    }
     OIC_LOG(DEBUG, TAG, "OUT");
     return OC_STACK_OK;
 }
@@ -556,25 +1302,12 @@ OCStackResult RTMAddObserver(uint32_t obsID, CAEndpoint_t devAddr, u_linklist_t
     RM_NULL_CHECK_WITH_RET(gatewayTable, TAG, "gatewayTable");
     RM_NULL_CHECK_WITH_RET(*gatewayTable, TAG, "*gatewayTable");
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(*gatewayTable, &iterTable);
-    while (NULL != iterTable)
+    RTMDestIntfInfo_t *destCheck = RTMFindNeighbourIntf(&devAddr, false, *gatewayTable);
+    if (NULL != destCheck)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
-
-        for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
-        {
-            RTMDestIntfInfo_t *destCheck = u_arraylist_get(entry->destination->destIntfAddr, i);
-            if (NULL != destCheck &&
-                (0 == memcmp(destCheck->destIntfAddr.addr, devAddr.addr, strlen(devAddr.addr)))
-                && devAddr.port == destCheck->destIntfAddr.port)
-            {
-                destCheck->observerId = obsID;
-                OIC_LOG(DEBUG, TAG, "OUT");
-                return OC_STACK_OK;
-            }
-        }
-        u_linklist_get_next(&iterTable);
+        destCheck->observerId = obsID;
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return OC_STACK_OK;
     }
     OIC_LOG(DEBUG, TAG, "OUT");
     return OC_STACK_ERROR;
@@ -596,30 +1329,12 @@ bool RTMIsObserverPresent(CAEndpoint_t devAddr, OCObservationId *obsID,
         return false;
     }
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(gatewayTable, &iterTable);
-    while (NULL != iterTable)
+    RTMDestIntfInfo_t *destCheck = RTMFindNeighbourIntf(&devAddr, true, gatewayTable);
+    if (NULL != destCheck)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
-        if (NULL == entry || NULL == entry->destination)
-        {
-            OIC_LOG(ERROR, TAG, "entry is NULL");
-            return false;
-        }
-        for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
-        {
-            RTMDestIntfInfo_t *destCheck =
-                u_arraylist_get(entry->destination->destIntfAddr, i);
-            if (NULL != destCheck && (0 == memcmp(destCheck->destIntfAddr.addr, devAddr.addr,
-                                      strlen(devAddr.addr)))
-                && devAddr.port == destCheck->destIntfAddr.port && 0 != destCheck->observerId)
-            {
-                *obsID = destCheck->observerId;
-                OIC_LOG(DEBUG, TAG, "OUT");
-                return true;
-            }
-        }
-        u_linklist_get_next(&iterTable);
+        *obsID = destCheck->observerId;
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return true;
     }
     OIC_LOG(DEBUG, TAG, "OUT");
     return false;
@@ -667,6 +1382,7 @@ OCStackResult RTMRemoveGatewayEntry(uint32_t gatewayId, u_linklist_t **removedGa
             }
             else
             {
+                RTMGatewayEntryRemoved(entry, *gatewayTable);
                 u_linklist_add(*removedGatewayNodes, (void *)entry);
             }
         }
@@ -688,61 +1404,39 @@ OCStackResult RTMRemoveGatewayDestEntry(uint32_t gatewayId, uint32_t nextHop,
     RM_NULL_CHECK_WITH_RET(*gatewayTable, TAG, "*gatewayTable");
     RM_NULL_CHECK_WITH_RET(destInfAdr, TAG, "destInfAdr");
 
-    u_linklist_iterator_t *iterTable = NULL;
-
-    OCStackResult ret = -1;
-    u_linklist_init_iterator(*gatewayTable, &iterTable);
-    while (NULL != iterTable)
+    // Update the time for NextHop entry.
+    RTMGatewayEntry_t *hopEntry = RTMFindGatewayEntry(nextHop, *gatewayTable);
+    if (NULL != hopEntry)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
-        if (NULL == entry)
+        RTMDestIntfInfo_t *destCheck = RTMFindDestIntf(hopEntry->destination,
+                                                       &destInfAdr->destIntfAddr);
+        if (NULL != destCheck)
         {
-            u_linklist_get_next(&iterTable);
-            continue;
-        }
-
-        // Update the time for NextHop entry.
-        if (NULL != entry->destination && nextHop == entry->destination->gatewayId)
-        {
-            for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
-            {
-                RTMDestIntfInfo_t *destCheck = u_arraylist_get(entry->destination->destIntfAddr, i);
-                if(!destCheck)
-                {
-                    continue;
-                }
-                if (0 == memcmp(destCheck->destIntfAddr.addr, destInfAdr->destIntfAddr.addr,
-                    strlen(destInfAdr->destIntfAddr.addr))
-                    && destInfAdr->destIntfAddr.port == destCheck->destIntfAddr.port)
-                {
-                    destCheck->timeElapsed =  RTMGetCurrentTime();
-                    break;
-                }
-            }
+            RTMRefreshDestIntf(destCheck);
         }
+    }
 
-        // Remove node with given gatewayid and nextHop if not found update exist entry.
-        if (NULL != entry->destination && (gatewayId == entry->destination->gatewayId))
+    // Remove node with given gatewayid and nextHop if not found update exist entry.
+    RTMGatewayEntry_t *entry = RTMFindGatewayEntry(gatewayId, *gatewayTable);
+    if (NULL != entry)
+    {
+        OIC_LOG_V(INFO, TAG, "Remove the gateway ID: %u", entry->destination->gatewayId);
+        if (NULL != entry->nextHop && nextHop == entry->nextHop->gatewayId)
         {
-            OIC_LOG_V(INFO, TAG, "Remove the gateway ID: %u", entry->destination->gatewayId);
-            if (NULL != entry->nextHop && nextHop == entry->nextHop->gatewayId)
+            OCStackResult ret = RTMRemoveTableEntry(entry, *gatewayTable);
+            if (OC_STACK_OK != ret)
             {
-                ret = u_linklist_remove(*gatewayTable, &iterTable);
-                if (OC_STACK_OK != ret)
-                {
-                   OIC_LOG(ERROR, TAG, "Deleting Entry from Routing Table failed");
-                   return OC_STACK_ERROR;
-                }
-                OICFree(entry);
-                return OC_STACK_OK;
+               OIC_LOG(ERROR, TAG, "Deleting Entry from Routing Table failed");
+               return OC_STACK_ERROR;
             }
-
-            *existEntry = entry;
-            OIC_LOG(DEBUG, TAG, "OUT");
-            return OC_STACK_ERROR;
+            RTMGatewayEntryRemoved(entry, *gatewayTable);
+            OICFree(entry);
+            return OC_STACK_OK;
         }
 
-        u_linklist_get_next(&iterTable);
+        *existEntry = entry;
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return OC_STACK_ERROR;
     }
     OIC_LOG(DEBUG, TAG, "OUT");
     return OC_STACK_ERROR;
@@ -767,6 +1461,10 @@ OCStackResult RTMRemoveEndpointEntry(uint16_t endpointId, u_linklist_t **endpoin
                OIC_LOG(ERROR, TAG, "Deleting Entry from Routing Table failed");
                return OC_STACK_ERROR;
             }
+            if (RTMIsEndpointTableIndexed(*endpointTable))
+            {
+                RTMDetachEndpointEntry(entry);
+            }
             OICFree(entry);
         }
         else
@@ -823,12 +1521,7 @@ void RTMFreeGateway(RTMGatewayId_t *gateway, u_linklist_t **gatewayTable)
     RM_NULL_CHECK_VOID(gateway, TAG, "gateway");
     RM_NULL_CHECK_VOID(gatewayTable, TAG, "gatewayTable");
     RM_NULL_CHECK_VOID(*gatewayTable, TAG, "*gatewayTable");
-    while (0 < u_arraylist_length(gateway->destIntfAddr))
-    {
-        void *data = u_arraylist_remove(gateway->destIntfAddr, 0);
-        OICFree(data);
-    }
-    u_arraylist_free(&(gateway->destIntfAddr));
+    RTMFreeDestIntfList(gateway);
     OICFree(gateway);
     OIC_LOG(DEBUG, TAG, "OUT");
 }
@@ -880,25 +1573,32 @@ RTMGatewayId_t *RTMGetNextHop(uint32_t gatewayId, const u_linklist_t *gatewayTab
         return NULL;
     }
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(gatewayTable, &iterTable);
-    while (NULL != iterTable)
+    // The routes of the indexed table are cached until the table changes.
+    bool indexed = RTMIsGatewayTableIndexed(gatewayTable);
+    RTMRouteCache_t *route =
+        &g_gatewayIndex.routeCache[RTM_HASH_BUCKET(RTMHashId(gatewayId), RTM_ROUTE_CACHE_BITS)];
+    if (indexed && g_gatewayIndex.generation == route->generation &&
+        gatewayId == route->gatewayId)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
-        if (NULL != entry && gatewayId == entry->destination->gatewayId)
-        {
-            if (1 == entry->routeCost)
-            {
-                OIC_LOG(DEBUG, TAG, "OUT");
-                return entry->destination;
-            }
-            OIC_LOG(DEBUG, TAG, "OUT");
-            return entry->nextHop;
-        }
-        u_linklist_get_next(&iterTable);
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return route->nextHop;
+    }
+
+    RTMGatewayId_t *nextHop = NULL;
+    RTMGatewayEntry_t *entry = RTMFindGatewayEntry(gatewayId, gatewayTable);
+    if (NULL != entry)
+    {
+        nextHop = (1 == entry->routeCost) ? entry->destination : entry->nextHop;
+    }
+
+    if (indexed)
+    {
+        route->generation = g_gatewayIndex.generation;
+        route->gatewayId = gatewayId;
+        route->nextHop = nextHop;
     }
     OIC_LOG(DEBUG, TAG, "OUT");
-    return NULL;
+    return nextHop;
 }
 
 CAEndpoint_t *RTMGetEndpointEntry(uint16_t endpointId, const u_linklist_t *endpointTable)
@@ -910,21 +1610,9 @@ CAEndpoint_t *RTMGetEndpointEntry(uint16_t endpointId, const u_linklist_t *endpo
         return NULL;
     }
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(endpointTable, &iterTable);
-
-    while (NULL != iterTable)
-    {
-        RTMEndpointEntry_t *entry = u_linklist_get_data(iterTable);
-        if (NULL != entry && (endpointId == entry->endpointId))
-        {
-            OIC_LOG(DEBUG, TAG, "OUT");
-            return &(entry->destIntfAddr);
-        }
-        u_linklist_get_next(&iterTable);
-    }
+    RTMEndpointEntry_t *entry = RTMFindEndpointEntry(endpointId, endpointTable);
     OIC_LOG(DEBUG, TAG, "OUT");
-    return NULL;
+    return (NULL != entry) ? &(entry->destIntfAddr) : NULL;
 }
 
 void RTMGetObserverList(OCObservationId **obsList, uint32_t *obsListLen,
@@ -978,79 +1666,54 @@ OCStackResult RTMUpdateDestinationIntfAdr(uint32_t gatewayId, RTMDestIntfInfo_t
     RM_NULL_CHECK_WITH_RET(gatewayTable, TAG, "gatewayTable");
     RM_NULL_CHECK_WITH_RET(*gatewayTable, TAG, "*gatewayTable");
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(*gatewayTable, &iterTable);
-    while (NULL != iterTable)
+    RTMGatewayEntry_t *entry = RTMFindGatewayEntry(gatewayId, *gatewayTable);
+    if (NULL == entry)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
-        if (NULL != entry && NULL != entry->destination &&
-            gatewayId == entry->destination->gatewayId)
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return OC_STACK_OK;
+    }
+
+    RTMDestIntfInfo_t *destCheck = RTMFindDestIntf(entry->destination,
+                                                   &destInterfaces.destIntfAddr);
+    if (addAdr)
+    {
+        if (NULL != destCheck)
         {
-            if (addAdr)
-            {
-                for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
-                {
-                    RTMDestIntfInfo_t *destCheck =
-                        u_arraylist_get(entry->destination->destIntfAddr, i);
-                    if (NULL == destCheck)
-                    {
-                        OIC_LOG(ERROR, TAG, "Destination adr get failed");
-                        continue;
-                    }
-
-                    if (0 == memcmp(destCheck->destIntfAddr.addr, destInterfaces.destIntfAddr.addr,
-                        strlen(destInterfaces.destIntfAddr.addr))
-                        && destInterfaces.destIntfAddr.port == destCheck->destIntfAddr.port)
-                    {
-                        destCheck->timeElapsed = RTMGetCurrentTime();
-                        destCheck->isValid = true;
-                        OIC_LOG(ERROR, TAG, "destInterfaces already present");
-                        return OC_STACK_ERROR;
-                    }
-                }
+            RTMRefreshDestIntf(destCheck);
+            destCheck->isValid = true;
+            OIC_LOG(ERROR, TAG, "destInterfaces already present");
+            return OC_STACK_ERROR;
+        }
 
-                RTMDestIntfInfo_t *destAdr =
-                        (RTMDestIntfInfo_t *) OICCalloc(1, sizeof(RTMDestIntfInfo_t));
-                if (NULL == destAdr)
-                {
-                    OIC_LOG(ERROR, TAG, "Calloc destAdr failed");
-                    return OC_STACK_ERROR;
-                }
-                *destAdr = destInterfaces;
-                destAdr->timeElapsed = RTMGetCurrentTime();
-                destAdr->isValid = true;
-                bool result =
-                    u_arraylist_add(entry->destination->destIntfAddr, (void *)destAdr);
-                if (!result)
-                {
-                    OIC_LOG(ERROR, TAG, "Updating Destinterface address failed");
-                    OICFree(destAdr);
-                    return OC_STACK_ERROR;
-                }
-                OIC_LOG(DEBUG, TAG, "OUT");
-                return OC_STACK_DUPLICATE_REQUEST;
-            }
+        RTMDestIntfInfo_t *destAdr = RTMCreateDestIntf(&destInterfaces);
+        if (NULL == destAdr)
+        {
+            OIC_LOG(ERROR, TAG, "Calloc destAdr failed");
+            return OC_STACK_ERROR;
+        }
+        bool result =
+            u_arraylist_add(entry->destination->destIntfAddr, (void *)destAdr);
+        if (!result)
+        {
+            OIC_LOG(ERROR, TAG, "Updating Destinterface address failed");
+            OICFree(destAdr);
+            return OC_STACK_ERROR;
+        }
+        RTMDestIntfAdded(destAdr, *gatewayTable);
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return OC_STACK_DUPLICATE_REQUEST;
+    }
 
-            for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
+    if (NULL != destCheck)
+    {
+        for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
+        {
+            if (destCheck == u_arraylist_get(entry->destination->destIntfAddr, i))
             {
-                RTMDestIntfInfo_t *removeAdr =
-                    u_arraylist_get(entry->destination->destIntfAddr, i);
-                if (!removeAdr)
-                {
-                    continue;
-                }
-                if (0 == memcmp(removeAdr->destIntfAddr.addr, destInterfaces.destIntfAddr.addr,
-                    strlen(destInterfaces.destIntfAddr.addr))
-                    && destInterfaces.destIntfAddr.port == removeAdr->destIntfAddr.port)
-                {
-                    RTMDestIntfInfo_t *data =
-                        u_arraylist_remove(entry->destination->destIntfAddr, i);
-                    OICFree(data);
-                    break;
-                }
+                RTMFreeDestIntf(u_arraylist_remove(entry->destination->destIntfAddr, i));
+                break;
             }
         }
-        u_linklist_get_next(&iterTable);
     }
     OIC_LOG(DEBUG, TAG, "OUT");
     return OC_STACK_OK;
@@ -1063,29 +1726,22 @@ OCStackResult RTMUpdateMcastSeqNumber(uint32_t gatewayId, uint16_t seqNum,
     RM_NULL_CHECK_WITH_RET(gatewayTable, TAG, "gatewayTable");
     RM_NULL_CHECK_WITH_RET(*gatewayTable, TAG, "*gatewayTable");
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(*gatewayTable, &iterTable);
-    while (NULL != iterTable)
+    RTMGatewayEntry_t *entry = RTMFindGatewayEntry(gatewayId, *gatewayTable);
+    if (NULL != entry)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
-        if (NULL != entry && NULL != entry->destination &&
-            gatewayId == entry->destination->gatewayId)
+        if (0 == entry->mcastMessageSeqNum || entry->mcastMessageSeqNum < seqNum)
         {
-            if (0 == entry->mcastMessageSeqNum || entry->mcastMessageSeqNum < seqNum)
-            {
-                entry->mcastMessageSeqNum = seqNum;
-                return OC_STACK_OK;
-            }
-            else if (entry->mcastMessageSeqNum == seqNum)
-            {
-                return OC_STACK_DUPLICATE_REQUEST;
-            }
-            else
-            {
-                return OC_STACK_COMM_ERROR;
-            }
+            entry->mcastMessageSeqNum = seqNum;
+            return OC_STACK_OK;
+        }
+        else if (entry->mcastMessageSeqNum == seqNum)
+        {
+            return OC_STACK_DUPLICATE_REQUEST;
+        }
+        else
+        {
+            return OC_STACK_COMM_ERROR;
         }
-        u_linklist_get_next(&iterTable);
     }
     OIC_LOG(DEBUG, TAG, "OUT");
     return OC_STACK_OK;
@@ -1132,6 +1788,13 @@ OCStackResult RTMUpdateDestAddrValidity(u_linklist_t **invalidTable, u_linklist_
     u_linklist_iterator_t *iterTable = NULL;
     uint64_t presentTime = RTMGetCurrentTime();
 
+    if (RTMIsGatewayTableIndexed(*gatewayTable))
+    {
+        RTMCollectExpired(0, presentTime, *invalidTable);
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return OC_STACK_OK;
+    }
+
     u_linklist_init_iterator(*gatewayTable, &iterTable);
     while (NULL != iterTable)
     {
@@ -1199,8 +1862,7 @@ OCStackResult RTMRemoveInvalidGateways(u_linklist_t **invalidTable, u_linklist_t
                 RTMDestIntfInfo_t *destCheck = u_arraylist_get(entry->destination->destIntfAddr, i);
                 if (!destCheck && !destCheck->isValid)
                 {
-                    void *data = u_arraylist_remove(entry->destination->destIntfAddr, i);
-                    OICFree(data);
+                    RTMFreeDestIntf(u_arraylist_remove(entry->destination->destIntfAddr, i));
                     i--;
                 }
             }
@@ -1244,49 +1906,31 @@ OCStackResult RTMUpdateEntryParameters(uint32_t gatewayId, uint32_t seqNum,
     RM_NULL_CHECK_WITH_RET(*gatewayTable, TAG, "*gatewayTable");
     RM_NULL_CHECK_WITH_RET(destAdr, TAG, "destAdr");
 
-    u_linklist_iterator_t *iterTable = NULL;
-    u_linklist_init_iterator(*gatewayTable, &iterTable);
-    while (NULL != iterTable)
+    RTMGatewayEntry_t *entry = RTMFindGatewayEntry(gatewayId, *gatewayTable);
+    if (NULL != entry)
     {
-        RTMGatewayEntry_t *entry = u_linklist_get_data(iterTable);
+        RTMDestIntfInfo_t *destCheck = RTMFindDestIntf(entry->destination,
+                                                       &destAdr->destIntfAddr);
+        if (NULL != destCheck)
+        {
+            RTMRefreshDestIntf(destCheck);
+            destCheck->isValid = true;
+        }
 
-        if (NULL == entry)
+        if (0 != entry->seqNum && seqNum == entry->seqNum)
         {
-            u_linklist_get_next(&iterTable);
-            continue;
+            return OC_STACK_DUPLICATE_REQUEST;
         }
-        if (NULL != entry->destination && gatewayId == entry->destination->gatewayId)
+        else if (0 != entry->seqNum && seqNum != ((entry->seqNum) + 1) && !forceUpdate)
         {
-            for (size_t i = 0; i < u_arraylist_length(entry->destination->destIntfAddr); i++)
-            {
-                RTMDestIntfInfo_t *destCheck =
-                    u_arraylist_get(entry->destination->destIntfAddr, i);
-                if (NULL != destCheck &&
-                    (0 == memcmp(destCheck->destIntfAddr.addr, destAdr->destIntfAddr.addr,
-                     strlen(destAdr->destIntfAddr.addr)))
-                     && destAdr->destIntfAddr.port == destCheck->destIntfAddr.port)
-                {
-                    destCheck->timeElapsed = RTMGetCurrentTime();
-                    destCheck->isValid = true;
-                }
-            }
-
-            if (0 != entry->seqNum && seqNum == entry->seqNum)
-            {
-                return OC_STACK_DUPLICATE_REQUEST;
-            }
-            else if (0 != entry->seqNum && seqNum != ((entry->seqNum) + 1) && !forceUpdate)
-            {
-                return OC_STACK_COMM_ERROR;
-            }
-            else
-            {
-                entry->seqNum = seqNum;
-                OIC_LOG(DEBUG, TAG, "OUT");
-                return OC_STACK_OK;
-            }
+            return OC_STACK_COMM_ERROR;
+        }
+        else
+        {
+            entry->seqNum = seqNum;
+            OIC_LOG(DEBUG, TAG, "OUT");
+            return OC_STACK_OK;
         }
-        u_linklist_get_next(&iterTable);
     }
     OIC_LOG(DEBUG, TAG, "OUT");
     return OC_STACK_OK;
@@ -0,0 +1,205 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * *****************************************************************/
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include "routingtablemanager.h"
+
+#define MANY_NUM_OF_NEIGHBOURS 10
+#define MANY_NUM_OF_GATEWAYS 200
+#define MANY_NUM_OF_ENDPOINTS 200
+
+class RoutingTableManagerTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        m_gatewayTable = NULL;
+        m_endpointTable = NULL;
+        ASSERT_EQ(OC_STACK_OK, RTMInitialize(&m_gatewayTable, &m_endpointTable));
+    }
+
+    virtual void TearDown()
+    {
+        EXPECT_EQ(OC_STACK_OK, RTMTerminate(&m_gatewayTable, &m_endpointTable));
+    }
+
+    static RTMDestIntfInfo_t MakeInterface(uint32_t host)
+    {
+        RTMDestIntfInfo_t destInterfaces;
+        memset(&destInterfaces, 0, sizeof(destInterfaces));
+        destInterfaces.destIntfAddr.adapter = CA_ADAPTER_IP;
+        snprintf(destInterfaces.destIntfAddr.addr, sizeof(destInterfaces.destIntfAddr.addr),
+                 "10.%u.%u.%u", (host >> 16) & 0xFF, (host >> 8) & 0xFF, host & 0xFF);
+        destInterfaces.destIntfAddr.port = 5683;
+        return destInterfaces;
+    }
+
+    void AddNeighbour(uint32_t gatewayId)
+    {
+        RTMDestIntfInfo_t destInterfaces = MakeInterface(gatewayId);
+        ASSERT_EQ(OC_STACK_OK, RTMAddGatewayEntry(gatewayId, 0, 1, &destInterfaces,
+                                                  &m_gatewayTable));
+    }
+
+    u_linklist_t *m_gatewayTable;
+    u_linklist_t *m_endpointTable;
+};
+
+TEST_F(RoutingTableManagerTest, GetNextHop)
+{
+    AddNeighbour(1);
+    EXPECT_EQ(OC_STACK_OK, RTMAddGatewayEntry(2, 1, 2, NULL, &m_gatewayTable));
+
+    RTMGatewayId_t *nextHop = RTMGetNextHop(1, m_gatewayTable);
+    ASSERT_TRUE(NULL != nextHop);
+    EXPECT_EQ(1u, nextHop->gatewayId);
+    EXPECT_EQ(nextHop, RTMGetNextHop(2, m_gatewayTable));
+    EXPECT_TRUE(NULL == RTMGetNextHop(3, m_gatewayTable));
+    EXPECT_EQ(OC_STACK_DUPLICATE_REQUEST,
+              RTMAddGatewayEntry(2, 1, 2, NULL, &m_gatewayTable));
+
+    // Removing the next hop removes the routes through it.
+    u_linklist_t *removedGateways = NULL;
+    EXPECT_EQ(OC_STACK_OK, RTMRemoveGatewayEntry(1, &removedGateways, &m_gatewayTable));
+    EXPECT_EQ(2u, u_linklist_length(removedGateways));
+    EXPECT_TRUE(NULL == RTMGetNextHop(1, m_gatewayTable));
+    EXPECT_TRUE(NULL == RTMGetNextHop(2, m_gatewayTable));
+    EXPECT_EQ(OC_STACK_OK, RTMFreeGatewayRouteTable(&removedGateways));
+}
+
+TEST_F(RoutingTableManagerTest, GetEndpointEntry)
+{
+    CAEndpoint_t destAddr = MakeInterface(7).destIntfAddr;
+    uint16_t endpointId = 7;
+    EXPECT_EQ(OC_STACK_OK, RTMAddEndpointEntry(&endpointId, &destAddr, &m_endpointTable));
+
+    uint16_t duplicateId = 8;
+    EXPECT_EQ(OC_STACK_DUPLICATE_REQUEST,
+              RTMAddEndpointEntry(&duplicateId, &destAddr, &m_endpointTable));
+    EXPECT_EQ(7, duplicateId);
+
+    CAEndpoint_t *entry = RTMGetEndpointEntry(7, m_endpointTable);
+    ASSERT_TRUE(NULL != entry);
+    EXPECT_STREQ(destAddr.addr, entry->addr);
+
+    EXPECT_EQ(OC_STACK_OK, RTMRemoveEndpointEntry(7, &m_endpointTable));
+    EXPECT_TRUE(NULL == RTMGetEndpointEntry(7, m_endpointTable));
+}
+
+TEST_F(RoutingTableManagerTest, Observer)
+{
+    AddNeighbour(1);
+    AddNeighbour(2);
+    RTMDestIntfInfo_t destInterfaces = MakeInterface(2);
+
+    OCObservationId obsID = 0;
+    EXPECT_FALSE(RTMIsObserverPresent(destInterfaces.destIntfAddr, &obsID, m_gatewayTable));
+    EXPECT_EQ(OC_STACK_OK, RTMAddObserver(5, destInterfaces.destIntfAddr, &m_gatewayTable));
+    EXPECT_TRUE(RTMIsObserverPresent(destInterfaces.destIntfAddr, &obsID, m_gatewayTable));
+    EXPECT_EQ(5, obsID);
+
+    // A longer address with the same prefix is another gateway.
+    destInterfaces = MakeInterface(20);
+    EXPECT_FALSE(RTMIsObserverPresent(destInterfaces.destIntfAddr, &obsID, m_gatewayTable));
+}
+
+TEST_F(RoutingTableManagerTest, UpdateDestAddrValidity)
+{
+    for (uint32_t gatewayId = 1; gatewayId <= 3; gatewayId++)
+    {
+        AddNeighbour(gatewayId);
+    }
+
+    u_linklist_t *invalidInterfaces = NULL;
+    EXPECT_EQ(OC_STACK_OK, RTMUpdateDestAddrValidity(&invalidInterfaces, &m_gatewayTable));
+    EXPECT_EQ(0u, u_linklist_length(invalidInterfaces));
+    u_linklist_free(&invalidInterfaces);
+
+    // Age every interface, which keeps their order.
+    for (uint32_t gatewayId = 1; gatewayId <= 3; gatewayId++)
+    {
+        RTMGatewayId_t *gateway = RTMGetNextHop(gatewayId, m_gatewayTable);
+        ASSERT_TRUE(NULL != gateway);
+        RTMDestIntfInfo_t *destIntf = (RTMDestIntfInfo_t *) u_arraylist_get(gateway->destIntfAddr, 0);
+        ASSERT_TRUE(NULL != destIntf);
+        destIntf->timeElapsed -= GATEWAY_ALIVE_TIMEOUT + 1;
+    }
+
+    // A notification refreshes the interface of its gateway.
+    RTMDestIntfInfo_t destInterfaces = MakeInterface(2);
+    EXPECT_EQ(OC_STACK_OK, RTMUpdateEntryParameters(2, 1, &destInterfaces, &m_gatewayTable, false));
+
+    EXPECT_EQ(OC_STACK_OK, RTMUpdateDestAddrValidity(&invalidInterfaces, &m_gatewayTable));
+    EXPECT_EQ(2u, u_linklist_length(invalidInterfaces));
+    u_linklist_iterator_t *iterTable = NULL;
+    u_linklist_init_iterator(invalidInterfaces, &iterTable);
+    while (NULL != iterTable)
+    {
+        RTMDestIntfInfo_t *destIntf = (RTMDestIntfInfo_t *) u_linklist_get_data(iterTable);
+        EXPECT_FALSE(destIntf->isValid);
+        EXPECT_STRNE(destInterfaces.destIntfAddr.addr, destIntf->destIntfAddr.addr);
+        u_linklist_get_next(&iterTable);
+    }
+    u_linklist_free(&invalidInterfaces);
+}
+
+TEST_F(RoutingTableManagerTest, ManyEntries)
+{
+    for (uint32_t gatewayId = 1; gatewayId <= MANY_NUM_OF_NEIGHBOURS; gatewayId++)
+    {
+        AddNeighbour(gatewayId);
+    }
+    for (uint32_t gatewayId = MANY_NUM_OF_NEIGHBOURS + 1; gatewayId <= MANY_NUM_OF_GATEWAYS;
+         gatewayId++)
+    {
+        uint32_t nextHop = 1 + gatewayId % MANY_NUM_OF_NEIGHBOURS;
+        ASSERT_EQ(OC_STACK_OK, RTMAddGatewayEntry(gatewayId, nextHop, 2, NULL,
+                                                  &m_gatewayTable));
+    }
+    for (uint16_t endpointId = 1; endpointId <= MANY_NUM_OF_ENDPOINTS; endpointId++)
+    {
+        CAEndpoint_t destAddr = MakeInterface(0x10000 + endpointId).destIntfAddr;
+        uint16_t id = endpointId;
+        ASSERT_EQ(OC_STACK_OK, RTMAddEndpointEntry(&id, &destAddr, &m_endpointTable));
+    }
+
+    // Each gateway is routed through its next hop, twice to go through the route cache.
+    for (uint32_t i = 0; i < 2 * MANY_NUM_OF_GATEWAYS; i++)
+    {
+        uint32_t gatewayId = 1 + i % MANY_NUM_OF_GATEWAYS;
+        RTMGatewayId_t *nextHop = RTMGetNextHop(gatewayId, m_gatewayTable);
+        ASSERT_TRUE(NULL != nextHop);
+        ASSERT_EQ((gatewayId > MANY_NUM_OF_NEIGHBOURS) ?
+                  1 + gatewayId % MANY_NUM_OF_NEIGHBOURS : gatewayId, nextHop->gatewayId);
+    }
+    EXPECT_TRUE(NULL == RTMGetNextHop(MANY_NUM_OF_GATEWAYS + 1, m_gatewayTable));
+
+    for (uint16_t endpointId = 1; endpointId <= MANY_NUM_OF_ENDPOINTS; endpointId++)
+    {
+        ASSERT_TRUE(NULL != RTMGetEndpointEntry(endpointId, m_endpointTable));
+    }
+    EXPECT_TRUE(NULL == RTMGetEndpointEntry(MANY_NUM_OF_ENDPOINTS + 1, m_endpointTable));
+
+    u_linklist_t *invalidInterfaces = NULL;
+    EXPECT_EQ(OC_STACK_OK, RTMUpdateDestAddrValidity(&invalidInterfaces, &m_gatewayTable));
+    EXPECT_EQ(0u, u_linklist_length(invalidInterfaces));
+    u_linklist_free(&invalidInterfaces);
+}
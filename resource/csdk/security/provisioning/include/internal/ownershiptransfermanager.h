@@ -57,6 +57,18 @@ OCStackResult OTMDoOwnershipTransfer(void* ctx,
  */
 OCStackResult OTMSetOxmAllowStatus(const OicSecOxm_t oxm, const bool allowStatus);
 
+/**
+ * API to set the number of devices OTMDoOwnershipTransfer transfers in parallel.
+ *
+ * @param[in] maxConcurrentDevices max number of devices transferred at the same time (default 1)
+ * @param[in] deviceResultCallback callback invoked when the ownership transfer of each device
+ *                                 is finished, or NULL
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OTMSetConcurrency(size_t maxConcurrentDevices,
+                                OCProvisionResultCB deviceResultCallback);
+
 
 /**
  *Callback for load secret for temporal secure session
@@ -77,6 +89,11 @@ typedef OCStackResult (*OTMCreateSecureSession)(OTMContext_t* otmCtx);
 typedef OCStackResult (*OTMCreatePayloadCallback)(OTMContext_t* otmCtx, uint8_t **payload,
                                                   size_t *size);
 
+/**
+ * Step of the ownership transfer which needs the secure session setup for itself.
+ */
+typedef void (*OTMSecureSessionStep)(OTMContext_t* otmCtx);
+
 /**
  * Required callback for performing ownership transfer
  */
@@ -88,6 +105,23 @@ struct OTMCallbackData
     OTMCreatePayloadCallback createOwnerTransferPayloadCB;
 };
 
+/**
+ * Devices of an ownership transfer request, transferred up to maxInProgress at a time.
+ */
+typedef struct OTMBatch
+{
+    void* userCtx;                            /**< Context for user.*/
+    OCProvisionDev_t* nextDevice;             /**< Next device to start the OT with. */
+    size_t inProgress;                        /**< No of devices being transferred. */
+    size_t maxInProgress;                     /**< Max no of devices transferred in parallel. */
+    bool dispatching;                         /**< Are devices being started. */
+    OCProvisionResultCB resultCallback;       /**< Result callback of the whole request. */
+    OCProvisionResultCB deviceResultCallback; /**< Result callback of each device, or NULL. */
+    OCProvisionResult_t* resultArray;         /**< Result array having result of all device. */
+    size_t resultArraySize;                   /**< No of elements in result array. */
+    bool hasError;                            /**< Does any OT process have any error. */
+} OTMBatch_t;
+
 /**
  * Context for ownership transfer(OT)
  */
@@ -106,6 +140,9 @@ struct OTMContext{
     OicSecCred_t* cred;                       /**< Credential data. */
 #endif // MULTIPLE_OWNER
     int attemptCnt;
+    OTMBatch_t* batch;                        /**< Request of the OT, NULL for MOT. */
+    OTMSecureSessionStep secureSessionStep;   /**< Step waiting for the secure session setup. */
+    OTMContext_t* nextWaiting;                /**< Next context waiting for the setup. */
 };
 
 // TODO: Remove this OTMSetOwnershipTransferCallbackData, Please see the jira ticket IOT-1484
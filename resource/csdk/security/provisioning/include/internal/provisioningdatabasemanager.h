@@ -46,6 +46,17 @@ typedef enum PdmDeviceState {
  */
 OCStackResult PDMInit(const char* dbPath);
 
+/**
+ * This method is used by provisioning manager to select the journal of provisioning database.
+ * The write-ahead log does not sync each transaction to the storage, which makes updates
+ * much faster, while a power loss may revert the last transactions.
+ *
+ * @param[in] enable true to use the write-ahead log, false to use the default rollback journal.
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult PDMSetWriteAheadLogging(bool enable);
+
 /**
  * This method is used by provisioning manager to check device status.
  *
@@ -66,6 +77,18 @@ OCStackResult PDMGetDeviceState(const OicUuid_t* uuid, PdmDeviceState_t* result)
  */
 OCStackResult PDMSetDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state);
 
+/**
+ * This method is used by provisioning manager to update the status of several devices
+ * in a single transaction.
+ *
+ * @param[in] uuidList ids of the devices.
+ * @param[in] state device state. (ref. PdmDeviceState_t)
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise, in which case no
+ *         device is updated.
+ */
+OCStackResult PDMSetDeviceStateList(const OCUuidList_t* uuidList, PdmDeviceState_t state);
+
 /**
  * This method is used by provisioning manager to check duplication of device's Device ID with
  * provisioning database.
@@ -96,6 +119,18 @@ OCStackResult PDMAddDevice(const OicUuid_t* uuidOfDevice);
  */
 OCStackResult PDMLinkDevices(const OicUuid_t *uuidOfDevice1, const OicUuid_t *uuidOfDevice2);
 
+/**
+ * This method is used by provisioning manager to link a device with several devices
+ * in a single transaction.
+ *
+ * @param[in] uuidOfDevice DeviceID which is going to be linked with the devices of the list.
+ * @param[in] uuidList DeviceIDs which are going to be linked with uuidOfDevice.
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise, in which case no
+ *         link is added.
+ */
+OCStackResult PDMLinkDeviceList(const OicUuid_t *uuidOfDevice, const OCUuidList_t *uuidList);
+
 /**
  * This method is used by provisioning manager to unlink pairwise devices.
  *
@@ -128,6 +128,20 @@ OCStackResult OC_CALL OCDoOwnershipTransfer(void* ctx,
  */
 OCStackResult OC_CALL OCSetOxmAllowStatus(const OicSecOxm_t oxm, const bool allowStatus);
 
+/**
+ * API to set the number of devices OCDoOwnershipTransfer transfers in parallel.
+ * The secure session setups of the devices still happen one at a time, the other
+ * requests of the ownership transfers are performed in parallel.
+ *
+ * @param[in] maxConcurrentDevices max number of devices transferred at the same time (default 1)
+ * @param[in] deviceResultCallback callback invoked with the result of each device as soon as
+ *                                 its ownership transfer is finished, or NULL
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OC_CALL OCSetOwnershipTransferConcurrency(size_t maxConcurrentDevices,
+                                                        OCProvisionResultCB deviceResultCallback);
+
 #ifdef MULTIPLE_OWNER
 /**
  * API to perfrom multiple ownership transfer for MOT enabled device.
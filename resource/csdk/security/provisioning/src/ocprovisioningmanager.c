@@ -325,6 +325,20 @@ OCStackResult OC_CALL OCSetOxmAllowStatus(const OicSecOxm_t oxm, const bool allo
     return OTMSetOxmAllowStatus(oxm, allowStatus);
 }
 
+/**
+ * API to set the number of devices OCDoOwnershipTransfer transfers in parallel.
+ *
+ * @param[in] maxConcurrentDevices max number of devices transferred at the same time (default 1)
+ * @param[in] deviceResultCallback callback invoked with the result of each device, or NULL
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OC_CALL OCSetOwnershipTransferConcurrency(size_t maxConcurrentDevices,
+                                                        OCProvisionResultCB deviceResultCallback)
+{
+    return OTMSetConcurrency(maxConcurrentDevices, deviceResultCallback);
+}
+
 OCStackResult OC_CALL OCDoOwnershipTransfer(void* ctx,
                                             OCProvisionDev_t *targetDevices,
                                             OCProvisionResultCB resultCallback)
@@ -31,6 +31,7 @@
 #endif
 
 #include "iotivity_config.h"
+#include <inttypes.h>
 #ifdef HAVE_TIME_H
 #include <time.h>
 #endif
@@ -473,23 +474,249 @@ static OCStackResult PostRownerUuid(OTMContext_t* otmCtx);
  */
 static OCStackResult PostNormalOperationStatus(OTMContext_t* otmCtx);
 
-static bool IsComplete(OTMContext_t* otmCtx)
+/**
+ * Max number of devices transferred in parallel by OTMDoOwnershipTransfer.
+ */
+static size_t g_otmConcurrency = 1;
+
+/**
+ * Callback invoked when the ownership transfer of each device is finished.
+ */
+static OCProvisionResultCB g_otmDeviceResultCallback = NULL;
+
+/**
+ * The SSL adapter has a single cipher suite selection and a single set of credential
+ * handlers, which are read when a handshake is initiated. Hence only one ownership
+ * transfer at a time may set up a secure session, the others wait in a FIFO list.
+ * Like the OTM context list, the list is only used from the callbacks of the stack.
+ */
+static OTMContext_t* g_secureSessionOwner = NULL;
+static OTMContext_t* g_secureSessionWaitHead = NULL;
+static OTMContext_t* g_secureSessionWaitTail = NULL;
+
+/**
+ * Function to start the secure session setup of an ownership transfer, or to wait
+ * until the other ownership transfers are done with theirs.
+ *
+ * @param[in] otmCtx   Context value of ownership transfer.
+ * @param[in] step     step to call later if the setup has to wait.
+ * @return  true if the setup can be done now, false if step will be called later.
+ */
+static bool AcquireSecureSession(OTMContext_t* otmCtx, OTMSecureSessionStep step)
+{
+    if (otmCtx == g_secureSessionOwner)
+    {
+        return true;
+    }
+    if ((NULL == g_secureSessionOwner) && (NULL == g_secureSessionWaitHead))
+    {
+        g_secureSessionOwner = otmCtx;
+        return true;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "%s:%d waits for the secure session setup",
+              otmCtx->selectedDeviceInfo->endpoint.addr, getSecurePort(otmCtx->selectedDeviceInfo));
+    otmCtx->secureSessionStep = step;
+    otmCtx->nextWaiting = NULL;
+    if (g_secureSessionWaitTail)
+    {
+        g_secureSessionWaitTail->nextWaiting = otmCtx;
+    }
+    else
+    {
+        g_secureSessionWaitHead = otmCtx;
+    }
+    g_secureSessionWaitTail = otmCtx;
+    return false;
+}
+
+/**
+ * Function to give the secure session setup to the first waiting ownership transfer.
+ *
+ * @return  true if a waiting step has been called.
+ */
+static bool ResumeSecureSession(void)
 {
-    for(size_t i = 0; i < otmCtx->ctxResultArraySize; i++)
+    if ((NULL != g_secureSessionOwner) || (NULL == g_secureSessionWaitHead))
     {
-        if(OC_STACK_CONTINUE == otmCtx->ctxResultArray[i].res)
+        return false;
+    }
+
+    OTMContext_t* otmCtx = g_secureSessionWaitHead;
+    g_secureSessionWaitHead = otmCtx->nextWaiting;
+    if (NULL == g_secureSessionWaitHead)
+    {
+        g_secureSessionWaitTail = NULL;
+    }
+    otmCtx->nextWaiting = NULL;
+
+    g_secureSessionOwner = otmCtx;
+    otmCtx->secureSessionStep(otmCtx);
+    return true;
+}
+
+/**
+ * Function to remove an ownership transfer from the secure session setup, without
+ * resuming the waiting ones.
+ *
+ * @param[in] otmCtx   Context value of ownership transfer.
+ */
+static void DetachSecureSession(OTMContext_t* otmCtx)
+{
+    if (otmCtx == g_secureSessionOwner)
+    {
+        g_secureSessionOwner = NULL;
+        return;
+    }
+
+    OTMContext_t* prev = NULL;
+    for (OTMContext_t* cur = g_secureSessionWaitHead; NULL != cur; cur = cur->nextWaiting)
+    {
+        if (cur == otmCtx)
         {
-            return false;
+            if (prev)
+            {
+                prev->nextWaiting = cur->nextWaiting;
+            }
+            else
+            {
+                g_secureSessionWaitHead = cur->nextWaiting;
+            }
+            if (g_secureSessionWaitTail == cur)
+            {
+                g_secureSessionWaitTail = prev;
+            }
+            return;
         }
+        prev = cur;
     }
+}
 
-    return true;
+/**
+ * Function to end the secure session setup once its handshake is over.
+ * Only Just-Works uses nothing but the cipher suite selection; the other OxMs keep the
+ * setup until SetResult because their credential handlers stay registered until then.
+ *
+ * @param[in] otmCtx   Context value of ownership transfer.
+ */
+static void ReleaseSecureSession(OTMContext_t* otmCtx)
+{
+    if ((otmCtx != g_secureSessionOwner) ||
+        (OIC_JUST_WORKS != otmCtx->selectedDeviceInfo->doxm->oxmSel))
+    {
+        return;
+    }
+
+    g_secureSessionOwner = NULL;
+    while (ResumeSecureSession())
+    {
+    }
+}
+
+/**
+ * Function to save the result of a device and report it to the device result callback.
+ *
+ * @param[in,out] batch   Devices of the ownership transfer request.
+ * @param[in] selectedDevice   Device whose ownership transfer is over.
+ * @param[in] res   result of provisioning
+ */
+static void SetDeviceResult(OTMBatch_t* batch, OCProvisionDev_t* selectedDevice,
+                            const OCStackResult res)
+{
+    for(size_t i = 0; i < batch->resultArraySize; i++)
+    {
+        if(memcmp(selectedDevice->doxm->deviceID.id,
+                  batch->resultArray[i].deviceId.id, UUID_LENGTH) == 0)
+        {
+            bool hasError = false;
+            batch->resultArray[i].res = res;
+            if(OC_STACK_OK != res && OC_STACK_CONTINUE != res && OC_STACK_DUPLICATE_REQUEST != res)
+            {
+                hasError = true;
+                batch->hasError = true;
+                if (OC_STACK_OK != PDMDeleteDevice(&batch->resultArray[i].deviceId))
+                {
+                    OIC_LOG(WARNING, TAG, "Internal error in PDMDeleteDevice");
+                }
+                CloseSslConnection(selectedDevice);
+            }
+            if (batch->deviceResultCallback)
+            {
+                batch->deviceResultCallback(batch->userCtx, 1, &batch->resultArray[i], hasError);
+            }
+        }
+    }
+}
+
+/**
+ * Function to start the ownership transfer of the next devices of a request, as long as
+ * fewer than maxInProgress devices are being transferred, and to invoke the result
+ * callback once all the devices are done.
+ *
+ * @param[in,out] batch   Devices of the ownership transfer request.
+ */
+static void DispatchOwnershipTransfer(OTMBatch_t* batch)
+{
+    //A SetResult called while devices are being started only updates the counters.
+    if (batch->dispatching)
+    {
+        return;
+    }
+    batch->dispatching = true;
+
+    for (;;)
+    {
+        if ((NULL != batch->nextDevice) && (batch->inProgress < batch->maxInProgress))
+        {
+            OCProvisionDev_t* selectedDevice = batch->nextDevice;
+            batch->nextDevice = selectedDevice->next;
+
+            OTMContext_t* otmCtx = (OTMContext_t*)OICCalloc(1, sizeof(OTMContext_t));
+            if (NULL == otmCtx)
+            {
+                OIC_LOG(ERROR, TAG, "Failed to create OTM Context");
+                SetDeviceResult(batch, selectedDevice, OC_STACK_NO_MEMORY);
+                continue;
+            }
+            otmCtx->userCtx = batch->userCtx;
+            otmCtx->ctxResultCallback = batch->resultCallback;
+            otmCtx->ctxResultArray = batch->resultArray;
+            otmCtx->ctxResultArraySize = batch->resultArraySize;
+            otmCtx->batch = batch;
+
+            batch->inProgress++;
+            if (OC_STACK_OK != StartOwnershipTransfer(otmCtx, selectedDevice))
+            {
+                OIC_LOG(ERROR, TAG, "Failed to StartOwnershipTransfer");
+            }
+            continue;
+        }
+
+        //Transfers which have waited for a failed one can go on.
+        if (ResumeSecureSession())
+        {
+            continue;
+        }
+        break;
+    }
+
+    batch->dispatching = false;
+
+    //If all OTM process is complete, invoke the user callback.
+    if ((0 == batch->inProgress) && (NULL == batch->nextDevice))
+    {
+        SetDosState(DOS_RFNOP);
+        batch->resultCallback(batch->userCtx, batch->resultArraySize,
+                              batch->resultArray, batch->hasError);
+        OICFree(batch->resultArray);
+        OICFree(batch);
+    }
 }
 
 /**
  * Function to save the result of provisioning.
  *
- * @param[in,out] otmCtx   Context value of ownership transfer.
+ * @param[in,out] otmCtx   Context value of ownership transfer, freed by this function.
  * @param[in] res   result of provisioning
  */
 static void SetResult(OTMContext_t* otmCtx, const OCStackResult res)
@@ -497,7 +724,16 @@ static void SetResult(OTMContext_t* otmCtx, const OCStackResult res)
     OIC_LOG_V(DEBUG, TAG, "IN SetResult : %d ", res);
 
     VERIFY_NOT_NULL(TAG, otmCtx, ERROR);
-    VERIFY_NOT_NULL(TAG, otmCtx->selectedDeviceInfo, ERROR);
+    OTMBatch_t* batch = otmCtx->batch;
+    VERIFY_NOT_NULL(TAG, batch, ERROR);
+
+    //A transfer which failed before its device was validated only releases its context.
+    if ((NULL == otmCtx->selectedDeviceInfo) || (NULL == otmCtx->selectedDeviceInfo->doxm))
+    {
+        OIC_LOG(ERROR, TAG, "Ownership transfer failed without a valid device");
+        batch->hasError = true;
+        goto release;
+    }
 
     //If OTM Context was removed from previous response handler, just exit the current OTM process.
     if(NULL != GetOTMContext(otmCtx->selectedDeviceInfo->endpoint.addr,
@@ -506,8 +742,6 @@ static void SetResult(OTMContext_t* otmCtx, const OCStackResult res)
         OIC_LOG(WARNING, TAG, "Current OTM Process has already ended.");
     }
 
-    VERIFY_NOT_NULL(TAG, otmCtx->selectedDeviceInfo->doxm, ERROR);
-
     //Revert psk_info callback and new deivce uuid in case of random PIN OxM
     if(OIC_RANDOM_DEVICE_PIN == otmCtx->selectedDeviceInfo->doxm->oxmSel)
     {
@@ -532,23 +766,7 @@ static void SetResult(OTMContext_t* otmCtx, const OCStackResult res)
         }
     }
 
-    for(size_t i = 0; i < otmCtx->ctxResultArraySize; i++)
-    {
-        if(memcmp(otmCtx->selectedDeviceInfo->doxm->deviceID.id,
-                  otmCtx->ctxResultArray[i].deviceId.id, UUID_LENGTH) == 0)
-        {
-            otmCtx->ctxResultArray[i].res = res;
-            if(OC_STACK_OK != res && OC_STACK_CONTINUE != res && OC_STACK_DUPLICATE_REQUEST != res)
-            {
-                otmCtx->ctxHasError = true;
-                if (OC_STACK_OK != PDMDeleteDevice(&otmCtx->ctxResultArray[i].deviceId))
-                {
-                    OIC_LOG(WARNING, TAG, "Internal error in PDMDeleteDevice");
-                }
-                CloseSslConnection(otmCtx->selectedDeviceInfo);
-            }
-        }
-    }
+    SetDeviceResult(batch, otmCtx->selectedDeviceInfo, res);
 
     //In case of duplicated OTM process, OTMContext and OCDoHandle should not be removed.
     if(OC_STACK_DUPLICATE_REQUEST != res)
@@ -574,23 +792,12 @@ static void SetResult(OTMContext_t* otmCtx, const OCStackResult res)
         }
     }
 
-    //If all OTM process is complete, invoke the user callback.
-    if(IsComplete(otmCtx))
-    {
-        SetDosState(DOS_RFNOP);
-        otmCtx->ctxResultCallback(otmCtx->userCtx, otmCtx->ctxResultArraySize,
-                                   otmCtx->ctxResultArray, otmCtx->ctxHasError);
-        OICFree(otmCtx->ctxResultArray);
-        OICFree(otmCtx);
-    }
-    else
-    {
-        if(OC_STACK_OK != StartOwnershipTransfer(otmCtx,
-                                                 otmCtx->selectedDeviceInfo->next))
-        {
-            OIC_LOG(ERROR, TAG, "Failed to StartOwnershipTransfer");
-        }
-    }
+release:
+    DetachSecureSession(otmCtx);
+    OICFree(otmCtx);
+
+    batch->inProgress--;
+    DispatchOwnershipTransfer(batch);
 exit:
     OIC_LOG(DEBUG, TAG, "OUT SetResult");
 }
@@ -933,6 +1140,50 @@ exit:
     return res;
 }
 
+/**
+ * Function to create the temporal secure session of the ownership transfer and to
+ * send the first request over it.
+ *
+ * @param[in]  otmCtx  Context value of ownership transfer.
+ */
+static void CreateSecureSession(OTMContext_t* otmCtx)
+{
+    OCStackResult res = OC_STACK_ERROR;
+
+    if(otmCtx->otmCallback.loadSecretCB)
+    {
+        res = otmCtx->otmCallback.loadSecretCB(otmCtx);
+        if(OC_STACK_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "CreateSecureSession : Failed to load secret");
+            SetResult(otmCtx, res);
+            return;
+        }
+    }
+    if(otmCtx->otmCallback.createSecureSessionCB)
+    {
+        res = otmCtx->otmCallback.createSecureSessionCB(otmCtx);
+        if(OC_STACK_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "CreateSecureSession : Failed to create DTLS session");
+            SetResult(otmCtx, res);
+            return;
+        }
+
+        //This is a secure session.
+        otmCtx->selectedDeviceInfo->connType |= CT_FLAG_SECURE;
+
+        //Send request : GET /oic/sec/doxm. Then verify that the property values obtained this way
+        //are the same as those already-stored in the otmCtx.
+        res = GetAndVerifyDoxmResource(otmCtx);
+        if(OC_STACK_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to get doxm information after establishing secure connection");
+            SetResult(otmCtx, res);
+        }
+    }
+}
+
 /**
  * Callback handler for OwnerShipTransferModeHandler API.
  *
@@ -967,38 +1218,10 @@ static OCStackApplicationResult OwnerTransferModeHandler(void *ctx, OCDoHandle U
             return OC_STACK_DELETE_TRANSACTION;
         }
 
-        //Create DTLS secure session
-        if(otmCtx->otmCallback.loadSecretCB)
+        //Create DTLS secure session, once no other OTM process is setting up one.
+        if(AcquireSecureSession(otmCtx, CreateSecureSession))
         {
-            res = otmCtx->otmCallback.loadSecretCB(otmCtx);
-            if(OC_STACK_OK != res)
-            {
-                OIC_LOG(ERROR, TAG, "OwnerTransferModeHandler : Failed to load secret");
-                SetResult(otmCtx, res);
-                return  OC_STACK_DELETE_TRANSACTION;
-            }
-        }
-        if(otmCtx->otmCallback.createSecureSessionCB)
-        {
-            res = otmCtx->otmCallback.createSecureSessionCB(otmCtx);
-            if(OC_STACK_OK != res)
-            {
-                OIC_LOG(ERROR, TAG, "OwnerTransferModeHandler : Failed to create DTLS session");
-                SetResult(otmCtx, res);
-                return OC_STACK_DELETE_TRANSACTION;
-            }
-
-            //This is a secure session.
-            otmCtx->selectedDeviceInfo->connType |= CT_FLAG_SECURE;
-
-            //Send request : GET /oic/sec/doxm. Then verify that the property values obtained this way
-            //are the same as those already-stored in the otmCtx.
-            res = GetAndVerifyDoxmResource(otmCtx);
-            if(OC_STACK_OK != res)
-            {
-                OIC_LOG(ERROR, TAG, "Failed to get doxm information after establishing secure connection");
-                SetResult(otmCtx, res);
-            }
+            CreateSecureSession(otmCtx);
         }
     }
     else
@@ -1214,6 +1437,74 @@ exit:
     return  OC_STACK_DELETE_TRANSACTION;
 }
 
+/**
+ * Function to get ready to use the owner credential for the secure sessions and to
+ * update the owner ACL of the new device.
+ *
+ * @param[in]  otmCtx  Context value of ownership transfer.
+ */
+static void CreateOwnerCredentialSession(OTMContext_t* otmCtx)
+{
+    //For Servers based on OCF 1.0, PostOwnerAcl can be executed using
+    //the already-existing session. However, get ready here to use the
+    //Owner Credential for establishing future secure sessions.
+    //
+    //For Servers based on OIC 1.1, PostOwnerAcl might fail with status
+    //OC_STACK_UNAUTHORIZED_REQ. After such a failure, OwnerAclHandler
+    //will close the current session and re-establish a new session,
+    //using the Owner Credential.
+    CAEndpoint_t *endpoint = (CAEndpoint_t *)&otmCtx->selectedDeviceInfo->endpoint;
+
+    if (IS_OIC(otmCtx->selectedDeviceInfo->specVer))
+    {
+        endpoint->port = getSecurePort(otmCtx->selectedDeviceInfo);
+        if(CA_STATUS_OK != CAcloseSslConnection(endpoint))
+        {
+            OIC_LOG_V(WARNING, TAG, "%s: failed to close DTLS session", __func__);
+        }
+    }
+
+    /**
+      * If we select NULL cipher,
+      * client will select appropriate cipher suite according to server's cipher-suite list.
+      */
+    // TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA_256 = 0xC037, /**< see RFC 5489 */
+    CAResult_t caResult = CASelectCipherSuite(0xC037, endpoint->adapter);
+    if(CA_STATUS_OK != caResult)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to select TLS_NULL_WITH_NULL_NULL");
+        SetResult(otmCtx, CAResultToOCResult(caResult));
+        return;
+    }
+
+    /**
+      * in case of random PIN based OxM,
+      * revert get_psk_info callback of tinyDTLS to use owner credential.
+      */
+    if(OIC_RANDOM_DEVICE_PIN == otmCtx->selectedDeviceInfo->doxm->oxmSel)
+    {
+        OicUuid_t emptyUuid = { .id={0}};
+        SetUuidForPinBasedOxm(&emptyUuid);
+
+        caResult = CAregisterPskCredentialsHandler(GetDtlsPskCredentials);
+        if(CA_STATUS_OK != caResult)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to revert DTLS credential handler.");
+            SetResult(otmCtx, OC_STACK_INVALID_CALLBACK);
+            return;
+        }
+    }
+#ifdef __WITH_TLS__
+    otmCtx->selectedDeviceInfo->connType |= CT_FLAG_SECURE;
+#endif
+    OCStackResult res = PostOwnerAcl(otmCtx, GET_ACL_VER(otmCtx->selectedDeviceInfo->specVer));
+    if(OC_STACK_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to update owner ACL to new device");
+        SetResult(otmCtx, res);
+    }
+}
+
 /**
  * Response handler for update owner crendetial request.
  *
@@ -1239,79 +1530,26 @@ static OCStackApplicationResult OwnerCredentialHandler(void *ctx, OCDoHandle UNU
     {
         if(otmCtx->selectedDeviceInfo)
         {
-            //For Servers based on OCF 1.0, PostOwnerAcl can be executed using
-            //the already-existing session. However, get ready here to use the
-            //Owner Credential for establishing future secure sessions.
-            //
-            //For Servers based on OIC 1.1, PostOwnerAcl might fail with status
-            //OC_STACK_UNAUTHORIZED_REQ. After such a failure, OwnerAclHandler
-            //will close the current session and re-establish a new session,
-            //using the Owner Credential.
-            CAEndpoint_t *endpoint = (CAEndpoint_t *)&otmCtx->selectedDeviceInfo->endpoint;
-
-            if (IS_OIC(otmCtx->selectedDeviceInfo->specVer))
+            //Selecting the cipher suite of the owner credential session has to wait
+            //until no other OTM process is setting up a secure session.
+            if(AcquireSecureSession(otmCtx, CreateOwnerCredentialSession))
             {
-                endpoint->port = getSecurePort(otmCtx->selectedDeviceInfo);
-                if(CA_STATUS_OK != CAcloseSslConnection(endpoint))
-                {
-                    OIC_LOG_V(WARNING, TAG, "%s: failed to close DTLS session", __func__);
-                }
-            }
-
-            /**
-              * If we select NULL cipher,
-              * client will select appropriate cipher suite according to server's cipher-suite list.
-              */
-            // TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA_256 = 0xC037, /**< see RFC 5489 */
-                CAResult_t caResult = CASelectCipherSuite(0xC037, endpoint->adapter);
-                if(CA_STATUS_OK != caResult)
-                {
-                    OIC_LOG(ERROR, TAG, "Failed to select TLS_NULL_WITH_NULL_NULL");
-                    SetResult(otmCtx, CAResultToOCResult(caResult));
-                    return OC_STACK_DELETE_TRANSACTION;
-                }
-
-                /**
-                  * in case of random PIN based OxM,
-                  * revert get_psk_info callback of tinyDTLS to use owner credential.
-                  */
-                if(OIC_RANDOM_DEVICE_PIN == otmCtx->selectedDeviceInfo->doxm->oxmSel)
-                {
-                    OicUuid_t emptyUuid = { .id={0}};
-                    SetUuidForPinBasedOxm(&emptyUuid);
-
-                    caResult = CAregisterPskCredentialsHandler(GetDtlsPskCredentials);
-                    if(CA_STATUS_OK != caResult)
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed to revert DTLS credential handler.");
-                        SetResult(otmCtx, OC_STACK_INVALID_CALLBACK);
-                        return OC_STACK_DELETE_TRANSACTION;
-                    }
-                }
-    #ifdef __WITH_TLS__
-                otmCtx->selectedDeviceInfo->connType |= CT_FLAG_SECURE;
-    #endif
-                res = PostOwnerAcl(otmCtx, GET_ACL_VER(otmCtx->selectedDeviceInfo->specVer));
-                if(OC_STACK_OK != res)
-                {
-                    OIC_LOG(ERROR, TAG, "Failed to update owner ACL to new device");
-                    SetResult(otmCtx, res);
-                    return OC_STACK_DELETE_TRANSACTION;
-                }
+                CreateOwnerCredentialSession(otmCtx);
             }
         }
-        else
-        {
-            res = clientResponse->result;
-            OIC_LOG_V(ERROR, TAG, "OwnerCredentialHandler : Unexpected result %d", res);
-            SetResult(otmCtx, res);
-        }
+    }
+    else
+    {
+        res = clientResponse->result;
+        OIC_LOG_V(ERROR, TAG, "OwnerCredentialHandler : Unexpected result %d", res);
+        SetResult(otmCtx, res);
+    }
 
-        OIC_LOG(DEBUG, TAG, "OUT OwnerCredentialHandler");
+    OIC_LOG(DEBUG, TAG, "OUT OwnerCredentialHandler");
 
-    exit:
-        return  OC_STACK_DELETE_TRANSACTION;
-    }
+exit:
+    return  OC_STACK_DELETE_TRANSACTION;
+}
 
     static void SetAclVer2(char specVer[]){specVer[0]='o'; specVer[1]='c'; specVer[2]='f';}
 
@@ -1339,6 +1577,9 @@ static OCStackApplicationResult OwnerCredentialHandler(void *ctx, OCDoHandle UNU
 
         otmCtx->ocDoHandle = NULL;
 
+        //The handshake of the owner credential session is over.
+        ReleaseSecureSession(otmCtx);
+
         OCStackResult res = clientResponse->result;
         if(OC_STACK_RESOURCE_CHANGED == res)
         {
@@ -1544,6 +1785,12 @@ static OCStackApplicationResult OwnerCredentialHandler(void *ctx, OCDoHandle UNU
         otmCtx->ocDoHandle = NULL;
         (void)UNUSED;
 
+        //The handshake of the temporal secure session is over.
+        if (OC_STACK_CONTINUE_OPERATION != clientResponse->result)
+        {
+            ReleaseSecureSession(otmCtx);
+        }
+
         if (OC_STACK_CONTINUE_OPERATION == clientResponse->result)
         {
             OIC_LOG(INFO, TAG, "Skipping error handling until pass all random pin tries");
@@ -2404,19 +2651,19 @@ static OCStackResult StartOwnershipTransfer(void* ctx, OCProvisionDev_t* selecte
     OIC_LOG(INFO, TAG, "IN StartOwnershipTransfer");
     OCStackResult res = OC_STACK_INVALID_PARAM;
 
-    VERIFY_NOT_NULL(TAG, selectedDevice, ERROR);
-    VERIFY_NOT_NULL(TAG, selectedDevice->doxm, ERROR);
-
+    //Every failure goes through SetResult, which releases the context and its batch slot.
     OTMContext_t* otmCtx = (OTMContext_t*)ctx;
     otmCtx->selectedDeviceInfo = selectedDevice;
 
+    VERIFY_NOT_NULL(TAG, selectedDevice, ERROR);
+    VERIFY_NOT_NULL(TAG, selectedDevice->doxm, ERROR);
+
     //Setup PDM to perform the OTM, PDM will be cleanup if necessary.
     res = SetupPDM(selectedDevice);
     if(OC_STACK_OK != res)
     {
         OIC_LOG_V(ERROR, TAG, "SetupPDM error : %d", res);
-        SetResult(otmCtx, res);
-        return res;
+        goto exit;
     }
 
     //Select the OxM to performing ownership transfer
@@ -2427,8 +2674,7 @@ static OCStackResult StartOwnershipTransfer(void* ctx, OCProvisionDev_t* selecte
     if(OC_STACK_OK != res)
     {
         OIC_LOG_V(ERROR, TAG, "Failed to select the provisioning method : %d", res);
-        SetResult(otmCtx, res);
-        return res;
+        goto exit;
     }
     OIC_LOG_V(DEBUG, TAG, "Selected provisoning method = %d", selectedDevice->doxm->oxmSel);
 
@@ -2436,7 +2682,7 @@ static OCStackResult StartOwnershipTransfer(void* ctx, OCProvisionDev_t* selecte
     if(OC_STACK_OK != res)
     {
         OIC_LOG_V(ERROR, TAG, "Error in OTMSetOTCallback : %d", res);
-        return res;
+        goto exit;
     }
 
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
@@ -2452,13 +2698,16 @@ static OCStackResult StartOwnershipTransfer(void* ctx, OCProvisionDev_t* selecte
     if(OC_STACK_OK != res)
     {
         OIC_LOG_V(WARNING, TAG, "Failed to select the provisioning method : %d", res);
-        SetResult(otmCtx, res);
-        return res;
+        goto exit;
     }
 
     OIC_LOG(INFO, TAG, "OUT StartOwnershipTransfer");
 
 exit:
+    if(OC_STACK_OK != res)
+    {
+        SetResult(otmCtx, res);
+    }
     return res;
 }
 
@@ -2502,52 +2751,77 @@ OCStackResult OTMDoOwnershipTransfer(void* ctx,
         return OC_STACK_INVALID_CALLBACK;
     }
 
-    OTMContext_t* otmCtx = (OTMContext_t*)OICCalloc(1,sizeof(OTMContext_t));
-    if(!otmCtx)
+    OTMBatch_t* batch = (OTMBatch_t*)OICCalloc(1, sizeof(OTMBatch_t));
+    if(!batch)
     {
         OIC_LOG(ERROR, TAG, "Failed to create OTM Context");
         return OC_STACK_NO_MEMORY;
     }
 
-    otmCtx->ctxResultCallback = resultCallback;
-    otmCtx->ctxHasError = false;
-    otmCtx->userCtx = ctx;
+    batch->resultCallback = resultCallback;
+    batch->deviceResultCallback = g_otmDeviceResultCallback;
+    batch->maxInProgress = g_otmConcurrency;
+    batch->hasError = false;
+    batch->userCtx = ctx;
+    batch->nextDevice = selectedDevicelist;
     OCProvisionDev_t* pCurDev = selectedDevicelist;
 
     //Counting number of selected devices.
-    otmCtx->ctxResultArraySize = 0;
+    batch->resultArraySize = 0;
     while(NULL != pCurDev)
     {
-        otmCtx->ctxResultArraySize++;
+        batch->resultArraySize++;
         pCurDev = pCurDev->next;
     }
 
-    otmCtx->ctxResultArray =
-        (OCProvisionResult_t*)OICCalloc(otmCtx->ctxResultArraySize, sizeof(OCProvisionResult_t));
-    if(NULL == otmCtx->ctxResultArray)
+    batch->resultArray =
+        (OCProvisionResult_t*)OICCalloc(batch->resultArraySize, sizeof(OCProvisionResult_t));
+    if(NULL == batch->resultArray)
     {
         OIC_LOG(ERROR, TAG, "OTMDoOwnershipTransfer : Failed to memory allocation");
-        OICFree(otmCtx);
+        OICFree(batch);
         return OC_STACK_NO_MEMORY;
     }
     pCurDev = selectedDevicelist;
 
     //Fill the device UUID for result array.
-    for(size_t devIdx = 0; devIdx < otmCtx->ctxResultArraySize; devIdx++)
+    for(size_t devIdx = 0; devIdx < batch->resultArraySize; devIdx++)
     {
-        memcpy(otmCtx->ctxResultArray[devIdx].deviceId.id,
+        memcpy(batch->resultArray[devIdx].deviceId.id,
                pCurDev->doxm->deviceID.id,
                UUID_LENGTH);
-        otmCtx->ctxResultArray[devIdx].res = OC_STACK_CONTINUE;
+        batch->resultArray[devIdx].res = OC_STACK_CONTINUE;
         pCurDev = pCurDev->next;
     }
 
+    OIC_LOG_V(INFO, TAG, "Transferring ownership of %" PRIuPTR " devices, %" PRIuPTR " at a time",
+              batch->resultArraySize, batch->maxInProgress);
+
     SetDosState(DOS_RFPRO);
-    OCStackResult res = StartOwnershipTransfer(otmCtx, selectedDevicelist);
+    DispatchOwnershipTransfer(batch);
 
     OIC_LOG(DEBUG, TAG, "OUT OTMDoOwnershipTransfer");
 
-    return res;
+    return OC_STACK_OK;
+}
+
+OCStackResult OTMSetConcurrency(size_t maxConcurrentDevices,
+                                OCProvisionResultCB deviceResultCallback)
+{
+    OIC_LOG_V(INFO, TAG, "IN %s : max concurrent devices=%" PRIuPTR,
+              __func__, maxConcurrentDevices);
+
+    if (0 == maxConcurrentDevices)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    g_otmConcurrency = maxConcurrentDevices;
+    g_otmDeviceResultCallback = deviceResultCallback;
+
+    OIC_LOG_V(INFO, TAG, "OUT %s", __func__);
+
+    return OC_STACK_OK;
 }
 
 OCStackResult OTMSetOxmAllowStatus(const OicSecOxm_t oxm, const bool allowStatus)
@@ -49,6 +49,9 @@
 
 #define PDM_CREATE_T_DEVICE_LINK  "create table T_DEVICE_LINK_STATE(ID INT NOT NULL, ID2 INT NOT \
                                    NULL,STATE INT NOT NULL, PRIMARY KEY (ID, ID2));"
+
+#define PDM_CREATE_I_DEVICE_LINK_ID2 "create index if not exists I_DEVICE_LINK_ID2 on \
+                                      T_DEVICE_LINK_STATE(ID2);"
 /**
  * Macro to verify sqlite success.
  * eg: VERIFY_NON_NULL(TAG, ptrData, ERROR,OC_STACK_ERROR);
@@ -57,10 +60,22 @@
             { OIC_LOG_V((logLevel), tag, "Error in " #arg ", Error Message: %s", \
                sqlite3_errmsg(g_db)); return retValue; }}while(0)
 
+/**
+ * Macro to verify sqlite success on a statement from prepareStatement().
+ * The exit label of the function releases the statement and returns OC_STACK_ERROR.
+ */
+#define PDM_VERIFY_STATEMENT_OK(tag, arg, logLevel) do{ if (SQLITE_OK != (arg)) \
+            { OIC_LOG_V((logLevel), tag, "Error in " #arg ", Error Message: %s", \
+               sqlite3_errmsg(g_db)); goto exit; }}while(0)
+
 #define PDM_SQLITE_TRANSACTION_BEGIN "BEGIN TRANSACTION;"
 #define PDM_SQLITE_TRANSACTION_COMMIT "COMMIT;"
 #define PDM_SQLITE_TRANSACTION_ROLLBACK "ROLLBACK;"
 
+/* In WAL mode, a commit only needs to reach the log; it is synced at checkpoints. */
+#define PDM_SQLITE_JOURNAL_MODE_WAL "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;"
+#define PDM_SQLITE_JOURNAL_MODE_DELETE "PRAGMA journal_mode=DELETE; PRAGMA synchronous=FULL;"
+
 #ifdef __GNUC__
 #if ((__GNUC__ >= 4) && (__GNUC_MINOR__ >= 6))
 #define static_assert(value, message) _Static_assert((value) ? 1 : 0, message)
@@ -79,7 +94,7 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_STALE_INFO);
 #define PDM_SQLITE_INSERT_T_DEVICE_LIST_SIZE (int)sizeof(PDM_SQLITE_INSERT_T_DEVICE_LIST)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_INSERT_T_DEVICE_LIST);
 
-#define PDM_SQLITE_GET_ID "SELECT ID FROM T_DEVICE_LIST WHERE UUID like ?"
+#define PDM_SQLITE_GET_ID "SELECT ID FROM T_DEVICE_LIST WHERE UUID = ?"
 #define PDM_SQLITE_GET_ID_SIZE (int)sizeof(PDM_SQLITE_GET_ID)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_ID);
 
@@ -95,6 +110,9 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_DELETE_LINK);
 #define PDM_SQLITE_DELETE_DEVICE_SIZE (int)sizeof(PDM_SQLITE_DELETE_DEVICE)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_DELETE_DEVICE);
 #define PDM_SQLITE_DELETE_DEVICE_WITH_STATE "DELETE FROM T_DEVICE_LIST  WHERE STATE= ?"
+#define PDM_SQLITE_DELETE_DEVICE_WITH_STATE_SIZE (int)sizeof(PDM_SQLITE_DELETE_DEVICE_WITH_STATE)
+PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_DELETE_DEVICE_WITH_STATE);
+
 #define PDM_SQLITE_UPDATE_LINK "UPDATE T_DEVICE_LINK_STATE SET STATE = ?  WHERE ID = ? and ID2 = ?"
 #define PDM_SQLITE_UPDATE_LINK_SIZE (int)sizeof(PDM_SQLITE_UPDATE_LINK)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_UPDATE_LINK);
@@ -117,11 +135,11 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_LINKED_DEVICES);
 #define PDM_SQLITE_GET_DEVICE_LINKS_SIZE (int)sizeof(PDM_SQLITE_GET_DEVICE_LINKS)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_DEVICE_LINKS);
 
-#define PDM_SQLITE_UPDATE_DEVICE "UPDATE T_DEVICE_LIST SET STATE = ?  WHERE UUID like ?"
+#define PDM_SQLITE_UPDATE_DEVICE "UPDATE T_DEVICE_LIST SET STATE = ?  WHERE UUID = ?"
 #define PDM_SQLITE_UPDATE_DEVICE_SIZE (int)sizeof(PDM_SQLITE_UPDATE_DEVICE)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_UPDATE_DEVICE);
 
-#define PDM_SQLITE_GET_DEVICE_STATUS "SELECT STATE FROM T_DEVICE_LIST WHERE UUID like ?"
+#define PDM_SQLITE_GET_DEVICE_STATUS "SELECT STATE FROM T_DEVICE_LIST WHERE UUID = ?"
 #define PDM_SQLITE_GET_DEVICE_STATUS_SIZE (int)sizeof(PDM_SQLITE_GET_DEVICE_STATUS)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_DEVICE_STATUS);
 
@@ -141,6 +159,98 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE);
 static sqlite3 *g_db = NULL;
 static bool gInit = false;  /* Only if we can open sqlite db successfully, gInit is true. */
 
+/**
+ * Statements of the PDM, prepared on first use and kept until PDMClose().
+ */
+typedef enum
+{
+    PDM_STMT_GET_STALE_INFO = 0,
+    PDM_STMT_INSERT_T_DEVICE_LIST,
+    PDM_STMT_GET_ID,
+    PDM_STMT_INSERT_LINK_DATA,
+    PDM_STMT_DELETE_LINK,
+    PDM_STMT_DELETE_DEVICE,
+    PDM_STMT_DELETE_DEVICE_WITH_STATE,
+    PDM_STMT_UPDATE_LINK,
+    PDM_STMT_LIST_ALL_UUID,
+    PDM_STMT_GET_UUID,
+    PDM_STMT_GET_LINKED_DEVICES,
+    PDM_STMT_GET_DEVICE_LINKS,
+    PDM_STMT_UPDATE_DEVICE,
+    PDM_STMT_GET_DEVICE_STATUS,
+    PDM_STMT_UPDATE_LINK_STALE_FOR_STALE_DEVICE,
+    PDM_STMT_COUNT
+} PdmStatement_t;
+
+#define PDM_STATEMENT(name) { PDM_SQLITE_##name, PDM_SQLITE_##name##_SIZE }
+
+static const struct
+{
+    const char *sql;
+    int size;
+} g_statementSql[PDM_STMT_COUNT] =
+{
+    PDM_STATEMENT(GET_STALE_INFO),
+    PDM_STATEMENT(INSERT_T_DEVICE_LIST),
+    PDM_STATEMENT(GET_ID),
+    PDM_STATEMENT(INSERT_LINK_DATA),
+    PDM_STATEMENT(DELETE_LINK),
+    PDM_STATEMENT(DELETE_DEVICE),
+    PDM_STATEMENT(DELETE_DEVICE_WITH_STATE),
+    PDM_STATEMENT(UPDATE_LINK),
+    PDM_STATEMENT(LIST_ALL_UUID),
+    PDM_STATEMENT(GET_UUID),
+    PDM_STATEMENT(GET_LINKED_DEVICES),
+    PDM_STATEMENT(GET_DEVICE_LINKS),
+    PDM_STATEMENT(UPDATE_DEVICE),
+    PDM_STATEMENT(GET_DEVICE_STATUS),
+    PDM_STATEMENT(UPDATE_LINK_STALE_FOR_STALE_DEVICE)
+};
+
+static sqlite3_stmt *g_statements[PDM_STMT_COUNT] = { NULL };
+
+/**
+ * Function to get a prepared statement, the caller must give it back with releaseStatement()
+ */
+static int prepareStatement(PdmStatement_t index, sqlite3_stmt **stmt)
+{
+    if (NULL == g_statements[index])
+    {
+        int res = sqlite3_prepare_v2(g_db, g_statementSql[index].sql, g_statementSql[index].size,
+                                     &g_statements[index], NULL);
+        if (SQLITE_OK != res)
+        {
+            return res;
+        }
+    }
+    *stmt = g_statements[index];
+    return SQLITE_OK;
+}
+
+/**
+ * Function to reset a statement from prepareStatement(), so that it can be used again
+ */
+static void releaseStatement(sqlite3_stmt *stmt)
+{
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+/**
+ * Function to finalize the prepared statements before closing the DB
+ */
+static void finalizeStatements(void)
+{
+    for (size_t i = 0; i < PDM_STMT_COUNT; i++)
+    {
+        if (g_statements[i])
+        {
+            sqlite3_finalize(g_statements[i]);
+            g_statements[i] = NULL;
+        }
+    }
+}
+
 /**
  * function to create DB in case DB doesn't exists
  */
@@ -160,6 +270,9 @@ static OCStackResult createDB(const char* path)
     PDM_VERIFY_SQLITE_OK(TAG, result, ERROR, OC_STACK_ERROR);
 
     OIC_LOG(INFO, TAG, "Created T_DEVICE_LINK_STATE");
+    result = sqlite3_exec(g_db, PDM_CREATE_I_DEVICE_LINK_ID2, NULL, NULL, NULL);
+    PDM_VERIFY_SQLITE_OK(TAG, result, ERROR, OC_STACK_ERROR);
+
     gInit = true;
 
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
@@ -235,10 +348,18 @@ OCStackResult PDMInit(const char *path)
     if (SQLITE_OK != rc)
     {
         OIC_LOG_V(INFO, TAG, "ERROR: Can't open database: %s", sqlite3_errmsg(g_db));
+        sqlite3_close(g_db);
+        g_db = NULL;
         return createDB(dbPath);
     }
     gInit = true;
 
+    //Links are looked up by either of their devices, DBs created by older versions lack the index.
+    if (SQLITE_OK != sqlite3_exec(g_db, PDM_CREATE_I_DEVICE_LINK_ID2, NULL, NULL, NULL))
+    {
+        OIC_LOG_V(WARNING, TAG, "Failed to create link index: %s", sqlite3_errmsg(g_db));
+    }
+
     /*
      * Remove PDM_DEVICE_INIT status devices.
      * PDM_DEVICE_INIT means that the OTM process is in progress.
@@ -256,6 +377,20 @@ OCStackResult PDMInit(const char *path)
 }
 
 
+OCStackResult PDMSetWriteAheadLogging(bool enable)
+{
+    OIC_LOG_V(DEBUG, TAG, "IN %s : %s", __func__, enable ? "WAL" : "rollback journal");
+
+    CHECK_PDM_INIT(TAG);
+
+    int res = sqlite3_exec(g_db, enable ? PDM_SQLITE_JOURNAL_MODE_WAL : PDM_SQLITE_JOURNAL_MODE_DELETE,
+                           NULL, NULL, NULL);
+    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+
+    OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
+    return OC_STACK_OK;
+}
+
 OCStackResult PDMAddDevice(const OicUuid_t *UUID)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
@@ -268,15 +403,14 @@ OCStackResult PDMAddDevice(const OicUuid_t *UUID)
 
     sqlite3_stmt *stmt = 0;
     int res =0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_INSERT_T_DEVICE_LIST,
-                              PDM_SQLITE_INSERT_T_DEVICE_LIST_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_INSERT_T_DEVICE_LIST, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_SECOND, UUID, UUID_LENGTH, SQLITE_STATIC);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_THIRD, PDM_DEVICE_INIT);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
@@ -285,17 +419,21 @@ OCStackResult PDMAddDevice(const OicUuid_t *UUID)
         {
             //new OCStack result code
             OIC_LOG_V(ERROR, TAG, "Error Occured: %s",sqlite3_errmsg(g_db));
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_DUPLICATE_UUID;
         }
         OIC_LOG_V(ERROR, TAG, "Error Occured: %s",sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 /**
@@ -307,12 +445,11 @@ static OCStackResult getIdForUUID(const OicUuid_t *UUID , int *id)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_ID, PDM_SQLITE_GET_ID_SIZE,
-                             &stmt, NULL);
+    res = prepareStatement(PDM_STMT_GET_ID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_FIRST, UUID, UUID_LENGTH, SQLITE_STATIC);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     OIC_LOG(DEBUG, TAG, "Binding Done");
     while (SQLITE_ROW == sqlite3_step(stmt))
@@ -320,12 +457,16 @@ static OCStackResult getIdForUUID(const OicUuid_t *UUID , int *id)
         int tempId = sqlite3_column_int(stmt, PDM_FIRST_INDEX);
         OIC_LOG_V(DEBUG, TAG, "ID is %d", tempId);
         *id = tempId;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
         return OC_STACK_OK;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return OC_STACK_INVALID_PARAM;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 /**
@@ -343,12 +484,11 @@ OCStackResult PDMIsDuplicateDevice(const OicUuid_t* UUID, bool *result)
     }
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_ID, PDM_SQLITE_GET_ID_SIZE,
-                             &stmt, NULL);
+    res = prepareStatement(PDM_STMT_GET_ID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_FIRST, UUID, UUID_LENGTH, SQLITE_STATIC);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     OIC_LOG(DEBUG, TAG, "Binding Done");
     bool retValue = false;
@@ -358,11 +498,15 @@ OCStackResult PDMIsDuplicateDevice(const OicUuid_t* UUID, bool *result)
         retValue = true;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     *result = retValue;
 
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 /**
@@ -374,28 +518,31 @@ static OCStackResult addlink(int id1, int id2)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_INSERT_LINK_DATA,
-                              PDM_SQLITE_INSERT_LINK_DATA_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_INSERT_LINK_DATA, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id1);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_SECOND, id2);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_THIRD, PDM_DEVICE_ACTIVE);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
     {
         OIC_LOG_V(ERROR, TAG, "Error Occured: %s",sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMLinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
@@ -451,6 +598,80 @@ OCStackResult PDMLinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
     return addlink(id1, id2);
 }
 
+OCStackResult PDMLinkDeviceList(const OicUuid_t *uuidOfDevice, const OCUuidList_t *uuidList)
+{
+    OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
+
+    CHECK_PDM_INIT(TAG);
+    if (NULL == uuidOfDevice || NULL == uuidList)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid PARAM");
+        return  OC_STACK_INVALID_PARAM;
+    }
+
+    PdmDeviceState_t state = PDM_DEVICE_UNKNOWN;
+    if (OC_STACK_OK != PDMGetDeviceState(uuidOfDevice, &state))
+    {
+        OIC_LOG(ERROR, TAG, "Internal error occured");
+        return OC_STACK_ERROR;
+    }
+    if (PDM_DEVICE_ACTIVE != state)
+    {
+        OIC_LOG_V(ERROR, TAG, "Device state is not active : %d", state);
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    int id = 0;
+    if (OC_STACK_OK != getIdForUUID(uuidOfDevice, &id))
+    {
+        OIC_LOG(ERROR, TAG, "Requested value not found");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCStackResult res = OC_STACK_OK;
+    begin();
+    for (const OCUuidList_t *cur = uuidList; NULL != cur; cur = cur->next)
+    {
+        state = PDM_DEVICE_UNKNOWN;
+        if (OC_STACK_OK != PDMGetDeviceState(&cur->dev, &state))
+        {
+            OIC_LOG(ERROR, TAG, "Internal error occured");
+            res = OC_STACK_ERROR;
+            break;
+        }
+        if (PDM_DEVICE_ACTIVE != state)
+        {
+            OIC_LOG_V(ERROR, TAG, "Linked device state is not active : %d", state);
+            res = OC_STACK_INVALID_PARAM;
+            break;
+        }
+
+        int id1 = id;
+        int id2 = 0;
+        if (OC_STACK_OK != getIdForUUID(&cur->dev, &id2))
+        {
+            OIC_LOG(ERROR, TAG, "Requested value not found");
+            res = OC_STACK_INVALID_PARAM;
+            break;
+        }
+        ASCENDING_ORDER(id1, id2);
+
+        res = addlink(id1, id2);
+        if (OC_STACK_OK != res)
+        {
+            break;
+        }
+    }
+
+    if ((OC_STACK_OK != res) || (OC_STACK_OK != commit()))
+    {
+        rollback();
+        return (OC_STACK_OK != res) ? res : OC_STACK_ERROR;
+    }
+    OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
+    return OC_STACK_OK;
+}
+
 /**
  * Function to remove created link
  */
@@ -460,25 +681,28 @@ static OCStackResult removeLink(int id1, int id2)
 
     int res = 0;
     sqlite3_stmt *stmt = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_DELETE_LINK,
-                             PDM_SQLITE_DELETE_LINK_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_DELETE_LINK, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id1);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_SECOND, id2);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMUnlinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
@@ -516,22 +740,25 @@ static OCStackResult removeFromDeviceList(int id)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_DELETE_DEVICE,
-                              PDM_SQLITE_DELETE_DEVICE_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_DELETE_DEVICE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMDeleteDevice(const OicUuid_t *UUID)
@@ -568,28 +795,31 @@ static OCStackResult updateLinkState(int id1, int id2, int state)
 
     sqlite3_stmt *stmt = 0;
     int res = 0 ;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_UPDATE_LINK,
-                              PDM_SQLITE_UPDATE_LINK_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_UPDATE_LINK, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, state);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_SECOND, id1);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_THIRD, id2);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMSetLinkStale(const OicUuid_t* uuidOfDevice1, const OicUuid_t* uuidOfDevice2)
@@ -633,8 +863,7 @@ OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
     }
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_LIST_ALL_UUID,
-                              PDM_SQLITE_LIST_ALL_UUID_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_LIST_ALL_UUID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     size_t counter  = 0;
@@ -646,7 +875,7 @@ OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
         if (NULL == temp)
         {
             OIC_LOG_V(ERROR, TAG, "Memory allocation problem");
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_NO_MEMORY;
         }
         memcpy(&temp->dev.id, uid->id, UUID_LENGTH);
@@ -654,7 +883,7 @@ OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
         ++counter;
     }
     *numOfDevices = counter;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
@@ -665,12 +894,11 @@ static OCStackResult getUUIDforId(int id, OicUuid_t *uid, bool *result)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_UUID,
-                              PDM_SQLITE_GET_UUID_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_GET_UUID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     while (SQLITE_ROW == sqlite3_step(stmt))
     {
@@ -692,12 +920,16 @@ static OCStackResult getUUIDforId(int id, OicUuid_t *uid, bool *result)
                 *result = false;
             }
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_OK;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_INVALID_PARAM;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST, size_t *numOfDevices)
@@ -736,15 +968,14 @@ OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_LINKED_DEVICES,
-                              PDM_SQLITE_GET_LINKED_DEVICES_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_GET_LINKED_DEVICES, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_SECOND, id);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     size_t counter  = 0;
     while (SQLITE_ROW == sqlite3_step(stmt))
@@ -766,7 +997,7 @@ OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST
         if (NULL == tempNode)
         {
             OIC_LOG(ERROR, TAG, "No Memory");
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_NO_MEMORY;
         }
         memcpy(&tempNode->dev.id, &temp.id, UUID_LENGTH);
@@ -774,9 +1005,13 @@ OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST
         ++counter;
     }
     *numOfDevices = counter;
-     sqlite3_finalize(stmt);
+     releaseStatement(stmt);
      OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
      return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *numOfDevices)
@@ -792,12 +1027,11 @@ OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *num
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_STALE_INFO,
-                              PDM_SQLITE_GET_STALE_INFO_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_GET_STALE_INFO, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, PDM_DEVICE_STALE);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     size_t counter  = 0;
     while (SQLITE_ROW == sqlite3_step(stmt))
@@ -813,7 +1047,7 @@ OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *num
         if (NULL == tempNode)
         {
             OIC_LOG(ERROR, TAG, "No Memory");
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_NO_MEMORY;
         }
         memcpy(&tempNode->dev.id, &temp1.id, UUID_LENGTH);
@@ -822,9 +1056,13 @@ OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *num
         ++counter;
     }
     *numOfDevices = counter;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMClose(void)
@@ -835,6 +1073,7 @@ OCStackResult PDMClose(void)
     int res = 0;
     if (g_db)
     {
+        finalizeStatements();
         res = sqlite3_close(g_db);
         g_db = NULL;
     }
@@ -929,15 +1168,14 @@ OCStackResult PDMIsLinkExists(const OicUuid_t* uuidOfDevice1, const OicUuid_t* u
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_DEVICE_LINKS,
-                              PDM_SQLITE_GET_DEVICE_LINKS_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_GET_DEVICE_LINKS, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id1);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_SECOND, id2);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     bool ret = false;
     while(SQLITE_ROW == sqlite3_step(stmt))
@@ -945,10 +1183,14 @@ OCStackResult PDMIsLinkExists(const OicUuid_t* uuidOfDevice1, const OicUuid_t* u
         OIC_LOG(INFO, TAG, "Link already exists between devices");
         ret = true;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     *result = ret;
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 static OCStackResult updateDeviceState(const OicUuid_t *uuid, PdmDeviceState_t state)
@@ -957,25 +1199,28 @@ static OCStackResult updateDeviceState(const OicUuid_t *uuid, PdmDeviceState_t s
 
     sqlite3_stmt *stmt = 0;
     int res = 0 ;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_UPDATE_DEVICE,
-                              PDM_SQLITE_UPDATE_DEVICE_SIZE, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_UPDATE_DEVICE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, state);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_SECOND, uuid, UUID_LENGTH, SQLITE_STATIC);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 static OCStackResult updateLinkForStaleDevice(const OicUuid_t *devUuid)
@@ -992,34 +1237,61 @@ static OCStackResult updateLinkForStaleDevice(const OicUuid_t *devUuid)
         return OC_STACK_INVALID_PARAM;
     }
 
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE,
-                              PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE_SIZE,
-                               &stmt, NULL);
+    res = prepareStatement(PDM_STMT_UPDATE_LINK_STALE_FOR_STALE_DEVICE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_SECOND, id);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
+}
+
+/**
+ * Function to update the state of a device, and of its links if it becomes stale,
+ * within the current transaction
+ */
+static OCStackResult setDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state)
+{
+    OCStackResult res = OC_STACK_ERROR;
+
+    if(PDM_DEVICE_STALE == state)
+    {
+        res = updateLinkForStaleDevice(uuid);
+        if (OC_STACK_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "unable to update links");
+            return res;
+        }
+    }
+
+    res = updateDeviceState(uuid, state);
+    if (OC_STACK_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "unable to update device state");
+        return res;
+    }
+    return OC_STACK_OK;
 }
 
 OCStackResult PDMSetDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
-    OCStackResult res = OC_STACK_ERROR;
-
     CHECK_PDM_INIT(TAG);
     if (NULL == uuid)
     {
@@ -1028,25 +1300,43 @@ OCStackResult PDMSetDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state)
     }
     begin();
 
-    if(PDM_DEVICE_STALE == state)
+    OCStackResult res = setDeviceState(uuid, state);
+    if (OC_STACK_OK != res)
     {
-        res = updateLinkForStaleDevice(uuid);
+        rollback();
+        return res;
+    }
+    commit();
+    OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
+    return OC_STACK_OK;
+}
+
+OCStackResult PDMSetDeviceStateList(const OCUuidList_t* uuidList, PdmDeviceState_t state)
+{
+    OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
+
+    CHECK_PDM_INIT(TAG);
+    if (NULL == uuidList)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid PARAM");
+        return  OC_STACK_INVALID_PARAM;
+    }
+    begin();
+
+    for (const OCUuidList_t *cur = uuidList; NULL != cur; cur = cur->next)
+    {
+        OCStackResult res = setDeviceState(&cur->dev, state);
         if (OC_STACK_OK != res)
         {
             rollback();
-            OIC_LOG(ERROR, TAG, "unable to update links");
             return res;
         }
     }
-
-    res = updateDeviceState(uuid, state);
-    if (OC_STACK_OK != res)
+    if (OC_STACK_OK != commit())
     {
         rollback();
-        OIC_LOG(ERROR, TAG, "unable to update device state");
-        return res;
+        return OC_STACK_ERROR;
     }
-    commit();
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
@@ -1063,12 +1353,11 @@ OCStackResult PDMGetDeviceState(const OicUuid_t *uuid, PdmDeviceState_t* result)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_DEVICE_STATUS, PDM_SQLITE_GET_DEVICE_STATUS_SIZE,
-                              &stmt, NULL);
+    res = prepareStatement(PDM_STMT_GET_DEVICE_STATUS, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_FIRST, uuid, UUID_LENGTH, SQLITE_STATIC);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     *result = PDM_DEVICE_UNKNOWN;
     while(SQLITE_ROW == sqlite3_step(stmt))
@@ -1077,9 +1366,13 @@ OCStackResult PDMGetDeviceState(const OicUuid_t *uuid, PdmDeviceState_t* result)
         OIC_LOG_V(DEBUG, TAG, "Device state is %d", tempStaleStateFromDb);
         *result = (PdmDeviceState_t)tempStaleStateFromDb;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
 
 OCStackResult PDMDeleteDeviceWithState(const PdmDeviceState_t state)
@@ -1095,20 +1388,23 @@ OCStackResult PDMDeleteDeviceWithState(const PdmDeviceState_t state)
 
     sqlite3_stmt *stmt = 0;
     int res =0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_DELETE_DEVICE_WITH_STATE,
-                              (int)strlen(PDM_SQLITE_DELETE_DEVICE_WITH_STATE) + 1, &stmt, NULL);
+    res = prepareStatement(PDM_STMT_DELETE_DEVICE_WITH_STATE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, state);
-    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    PDM_VERIFY_STATEMENT_OK(TAG, res, ERROR);
 
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
+
+exit:
+    releaseStatement(stmt);
+    return OC_STACK_ERROR;
 }
@@ -52,6 +52,8 @@ static const char *g_otmCtx = "Test User Context";
 static OCProvisionDev_t *g_unownedDevices = NULL;
 static OCProvisionDev_t *g_ownedDevices = NULL;
 static size_t gNumOfUnownDevice = 0;
+static size_t g_numOfDeviceCB = 0;
+static size_t g_numOfDeviceSucceeded = 0;
 static size_t gNumOfOwnDevice = 0;
 
 using namespace std;
@@ -202,6 +204,20 @@ static void ownershipTransferCB(void *ctx, size_t UNUSED1, OCProvisionResult_t *
     OIC_LOG_V(DEBUG, TAG, "%s: done(has erro: %s)", __func__, hasError ? "yes" : "no");
 }
 
+static void deviceOwnershipTransferCB(void *ctx, size_t nOfRes, OCProvisionResult_t *arr,
+                                      bool hasError)
+{
+    OC_UNUSED(ctx);
+    OC_UNUSED(arr);
+
+    EXPECT_EQ(1U, nOfRes);
+    g_numOfDeviceCB++;
+    if (!hasError)
+    {
+        g_numOfDeviceSucceeded++;
+    }
+}
+
 // callback function(s) for provisioning client using C-level provisioning API
 static void removeDeviceCB(void *ctx, size_t UNUSED1, OCProvisionResult_t *UNUSED2, bool hasError)
 {
@@ -343,11 +359,23 @@ TEST(OCDiscoverUnownedDevices, Simple)
     EXPECT_EQ(OC_STACK_OK, OCClosePM());
 }
 
-TEST(OCDoOwnershipTransfer, Simple)
+TEST(OCSetOwnershipTransferConcurrency, NullParam)
+{
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetOwnershipTransferConcurrency(0, NULL));
+    EXPECT_EQ(OC_STACK_OK, OCSetOwnershipTransferConcurrency(1, NULL));
+}
+
+TEST(OCDoOwnershipTransfer, Concurrent)
 {
     //initialize Provisioning DB Manager
     EXPECT_EQ(OC_STACK_OK, OCInitPM(PM_DB_FILE_NAME));
-    ASSERT_EQ(true, gNumOfUnownDevice > 0);
+    // Both sample servers shall be found, for their secure sessions to overlap
+    ASSERT_LE(2U, gNumOfUnownDevice);
+
+    //transfer the ownership of the devices two at a time
+    g_numOfDeviceCB = 0;
+    g_numOfDeviceSucceeded = 0;
+    EXPECT_EQ(OC_STACK_OK, OCSetOwnershipTransferConcurrency(2, deviceOwnershipTransferCB));
 
     g_doneCB = false;
     EXPECT_EQ(OC_STACK_OK, OCDoOwnershipTransfer((void *)g_otmCtx, g_unownedDevices,
@@ -356,11 +384,15 @@ TEST(OCDoOwnershipTransfer, Simple)
     if (waitCallbackRet()) // input |g_doneCB| flag implicitly
     {
         OIC_LOG(FATAL, TAG, "OCProvisionCredentials callback error");
+        EXPECT_EQ(OC_STACK_OK, OCSetOwnershipTransferConcurrency(1, NULL));
         return;
     }
 
     EXPECT_EQ(true, g_callbackResult);
     EXPECT_EQ(true, g_doneCB);
+    EXPECT_EQ(gNumOfUnownDevice, g_numOfDeviceCB);
+    EXPECT_EQ(gNumOfUnownDevice, g_numOfDeviceSucceeded);
+    EXPECT_EQ(OC_STACK_OK, OCSetOwnershipTransferConcurrency(1, NULL));
     // close Provisioning DB
     EXPECT_EQ(OC_STACK_OK, OCClosePM());
 }
@@ -381,7 +413,7 @@ TEST(OCDiscoverOwnedDevices, Simple)
         tempDev = tempDev->next;
     }
 
-    EXPECT_EQ(true, gNumOfOwnDevice > 0);
+    EXPECT_LE(gNumOfUnownDevice, gNumOfOwnDevice);
     // close Provisioning DB
     EXPECT_EQ(OC_STACK_OK, OCClosePM());
 }
@@ -19,6 +19,7 @@
  * *****************************************************************/
 #include "iotivity_config.h"
 #include <gtest/gtest.h>
+#include <vector>
 #include "provisioningdatabasemanager.h"
 
 #ifdef _MSC_VER
@@ -42,6 +43,13 @@ const char ID_10[] = "1222222222222222";
 const char ID_11[] = "2222222222222222";
 const char ID_12[] = "3222222222222222";
 const char ID_13[] = "4222222222222222";
+const char ID_14[] = "5222222222222222";
+const char ID_15[] = "6222222222222222";
+const char ID_16[] = "7222222222222222";
+const char ID_17[] = "8222222222222222";
+
+#define MANY_DB_FILE "PDM_MANY.db"
+#define MANY_NUM_OF_DEVICES 500
 
 
 TEST(CallPDMAPIbeforeInit, BeforeInit)
@@ -437,3 +445,106 @@ TEST(PDMSetDeviceStaleTest, StaleDeviceNotinLinkedDevice)
     }
     EXPECT_EQ(OC_STACK_OK, PDMClose());
 }
+
+TEST(PDMLinkDeviceListTest, NULLParam)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    OicUuid_t uid1 = {{0,}};
+    memcpy(&uid1.id, ID_14, sizeof(uid1.id));
+    OCUuidList_t node;
+    memset(&node, 0, sizeof(node));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, PDMLinkDeviceList(NULL, &node));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, PDMLinkDeviceList(&uid1, NULL));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, PDMSetDeviceStateList(NULL, PDM_DEVICE_ACTIVE));
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
+
+TEST(PDMLinkDeviceListTest, ValidCase)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    OCUuidList_t nodes[4];
+    memset(nodes, 0, sizeof(nodes));
+    memcpy(&nodes[0].dev.id, ID_14, sizeof(nodes[0].dev.id));
+    memcpy(&nodes[1].dev.id, ID_15, sizeof(nodes[1].dev.id));
+    memcpy(&nodes[2].dev.id, ID_16, sizeof(nodes[2].dev.id));
+    memcpy(&nodes[3].dev.id, ID_17, sizeof(nodes[3].dev.id));
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, PDMAddDevice(&nodes[i].dev));
+    }
+    nodes[0].next = &nodes[1];
+    nodes[1].next = &nodes[2];
+    EXPECT_EQ(OC_STACK_OK, PDMSetDeviceStateList(&nodes[0], PDM_DEVICE_ACTIVE));
+
+    // ID_17 is not active, none of the links may be added.
+    nodes[2].next = &nodes[3];
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, PDMLinkDeviceList(&nodes[0].dev, &nodes[1]));
+    bool linked = true;
+    EXPECT_EQ(OC_STACK_OK, PDMIsLinkExists(&nodes[0].dev, &nodes[1].dev, &linked));
+    EXPECT_FALSE(linked);
+
+    nodes[2].next = NULL;
+    EXPECT_EQ(OC_STACK_OK, PDMLinkDeviceList(&nodes[0].dev, &nodes[1]));
+
+    OCUuidList_t *list = NULL;
+    size_t noOfDevices = 0;
+    EXPECT_EQ(OC_STACK_OK, PDMGetLinkedDevices(&nodes[0].dev, &list, &noOfDevices));
+    EXPECT_EQ(2U, noOfDevices);
+    PDMDestoryOicUuidLinkList(list);
+
+    nodes[0].next = NULL;
+    EXPECT_EQ(OC_STACK_OK, PDMSetDeviceStateList(&nodes[0], PDM_DEVICE_STALE));
+    OCPairList_t *staleList = NULL;
+    EXPECT_EQ(OC_STACK_OK, PDMGetToBeUnlinkedDevices(&staleList, &noOfDevices));
+    EXPECT_LE(2U, noOfDevices);
+    PDMDestoryStaleLinkList(staleList);
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
+
+TEST(PDMSetWriteAheadLoggingTest, ValidCase)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    EXPECT_EQ(OC_STACK_OK, PDMSetWriteAheadLogging(true));
+    EXPECT_EQ(OC_STACK_OK, PDMSetWriteAheadLogging(false));
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
+
+TEST(PDMLinkDeviceListTest, ManyDevices)
+{
+    if (0 == access(MANY_DB_FILE, F_OK))
+    {
+        EXPECT_EQ(0, remove(MANY_DB_FILE));
+    }
+    EXPECT_EQ(OC_STACK_OK, PDMInit(MANY_DB_FILE));
+    EXPECT_EQ(OC_STACK_OK, PDMSetWriteAheadLogging(true));
+
+    std::vector<OCUuidList_t> nodes(MANY_NUM_OF_DEVICES);
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        memset(&nodes[i], 0, sizeof(nodes[i]));
+        nodes[i].dev.id[0] = 0xBE;
+        memcpy(&nodes[i].dev.id[1], &i, sizeof(i));
+        nodes[i].next = (i + 1 < nodes.size()) ? &nodes[i + 1] : NULL;
+    }
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, PDMAddDevice(&nodes[i].dev));
+    }
+    EXPECT_EQ(OC_STACK_OK, PDMSetDeviceStateList(&nodes[0], PDM_DEVICE_ACTIVE));
+    EXPECT_EQ(OC_STACK_OK, PDMLinkDeviceList(&nodes[0].dev, &nodes[1]));
+
+    OCUuidList_t *list = NULL;
+    size_t noOfDevices = 0;
+    EXPECT_EQ(OC_STACK_OK, PDMGetLinkedDevices(&nodes[0].dev, &list, &noOfDevices));
+    EXPECT_EQ(nodes.size() - 1, noOfDevices);
+    PDMDestoryOicUuidLinkList(list);
+
+    bool linked = false;
+    EXPECT_EQ(OC_STACK_OK, PDMIsLinkExists(&nodes[0].dev, &nodes[nodes.size() - 1].dev,
+                                           &linked));
+    EXPECT_TRUE(linked);
+
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+    EXPECT_EQ(0, remove(MANY_DB_FILE));
+}
@@ -194,6 +194,12 @@ void DeleteClientCB(ClientCB *cbNode);
  */
 void DeleteClientCBList(void);
 
+/**
+ * This method is used to delete the timed-out nodes of cbList and to schedule
+ * ::OC_STACK_TIMER_CLIENT_CB at the time-out of the earliest remaining node.
+ */
+void DeleteTimedOutClientCBs(void);
+
 /**
  * This method is used to search and retrieve a cb node in cbList using token.
  *
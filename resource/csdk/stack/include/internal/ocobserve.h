@@ -161,6 +161,12 @@ OCStackResult SendListObserverNotification (OCResource * resource,
  */
 void DeleteObserverList(OCResource *resource);
 
+/**
+ * Send a confirmable notification to the observers of all resources whose TTL has
+ * expired, and schedule ::OC_STACK_TIMER_OBSERVER at the earliest remaining TTL.
+ */
+void CheckTimedOutObservers(void);
+
 /**
  * Create a unique observation ID.
  *
@@ -32,6 +32,7 @@
 #include "ocstackconfig.h"
 #include "occlientcb.h"
 #include "ocobserve.h"
+#include "ocresponsecache.h"
 
 /** Macro Definitions for observers */
 
@@ -250,6 +251,9 @@ typedef struct OCResource {
 
     /** Resource endpoint type(s). */
     OCTpsSchemeFlags endpointType;
+
+    /** Cached representations, NULL if the resource does not cache them. */
+    OCResourceCache *cache;
 } OCResource;
 
 /**
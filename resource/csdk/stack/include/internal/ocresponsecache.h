@@ -0,0 +1,285 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the caching of the responses to GET requests (RFC 7252, 5.6).
+ *
+ * On the server, a resource may opt in to keep the encoded representations returned by
+ * its entity handler, one per query and accepted format. A GET request with a cached
+ * representation is answered without calling the entity handler, until the cache is
+ * invalidated by OCNotifyAllObservers() or OCInvalidateResourceCache(). The responses of
+ * such a resource carry an ETag, so that a client presenting the ETag of the current
+ * representation is answered with 2.03 Valid and no payload, and a Max-Age.
+ *
+ * On the client, the responses to GET requests carrying a Max-Age are kept for that
+ * long, and a GET request of a fresh response is answered from the cache on the next
+ * OCProcess(). A stale response with an ETag is revalidated by the server.
+ */
+
+#ifndef OC_RESPONSE_CACHE_H_
+#define OC_RESPONSE_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform_features.h"
+#include "octypes.h"
+#include "cacommon.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Length of the ETags of the cached representations. */
+#define OC_ETAG_LENGTH 8
+
+/** Max-Age of a response without the option, in seconds (RFC 7252, 5.10.5). */
+#define OC_DEFAULT_MAX_AGE 60
+
+/** Number of representations (queries and formats) cached for a resource. */
+#define OC_RESOURCE_CACHE_MAX_REPRESENTATIONS 4
+
+/** Number of ETags of a request checked against the cached representations. */
+#define OC_MAX_REQUEST_ETAGS 2
+
+/**
+ * An encoded representation of a resource.
+ */
+typedef struct OCCachedRepresentation
+{
+    /** Next representation, more recent first. */
+    struct OCCachedRepresentation *next;
+
+    /** Query of the requests which returned the representation. */
+    char *query;
+
+    /** Accept format of the requests. */
+    OCPayloadFormat acceptFormat;
+
+    /** Accept version of the requests. */
+    uint16_t acceptVersion;
+
+    /** Encoded representation. */
+    uint8_t *payload;
+
+    /** Size of the encoded representation. */
+    size_t payloadSize;
+
+    /** Content format of the representation. */
+    CAPayloadFormat_t payloadFormat;
+
+    /** Content version of the representation. */
+    uint16_t payloadVersion;
+
+    /** ETag of the representation. */
+    uint8_t etag[OC_ETAG_LENGTH];
+} OCCachedRepresentation;
+
+/**
+ * Cache of the representations of a resource.
+ */
+typedef struct OCResourceCache
+{
+    /** Max-Age of the responses, in seconds. */
+    uint32_t maxAge;
+
+    /** Cached representations. */
+    OCCachedRepresentation *representations;
+} OCResourceCache;
+
+/**
+ * Compute the ETag of an encoded representation.
+ *
+ * @param[in]  payload      encoded representation.
+ * @param[in]  payloadSize  size of the representation.
+ * @param[out] etag         ETag, ::OC_ETAG_LENGTH bytes.
+ */
+void OCComputeETag(const uint8_t *payload, size_t payloadSize, uint8_t *etag);
+
+/**
+ * Find the representation cached for a request.
+ *
+ * @param[in] cache          cache of the resource, may be NULL.
+ * @param[in] query          query of the request.
+ * @param[in] acceptFormat   accept format of the request.
+ * @param[in] acceptVersion  accept version of the request.
+ *
+ * @return the representation, or NULL.
+ */
+const OCCachedRepresentation *OCGetCachedRepresentation(const OCResourceCache *cache,
+                                                        const char *query,
+                                                        OCPayloadFormat acceptFormat,
+                                                        uint16_t acceptVersion);
+
+/**
+ * Cache the representation returned for a request. The oldest representation is
+ * dropped when the resource has ::OC_RESOURCE_CACHE_MAX_REPRESENTATIONS already.
+ *
+ * @param[in]  cache           cache of the resource.
+ * @param[in]  query           query of the request.
+ * @param[in]  acceptFormat    accept format of the request.
+ * @param[in]  acceptVersion   accept version of the request.
+ * @param[in]  info            response holding the encoded representation.
+ * @param[out] representation  cached representation.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCCacheRepresentation(OCResourceCache *cache, const char *query,
+                                    OCPayloadFormat acceptFormat, uint16_t acceptVersion,
+                                    const CAInfo_t *info,
+                                    const OCCachedRepresentation **representation);
+
+/**
+ * Drop the representations cached for a resource.
+ *
+ * @param[in] cache  cache of the resource, may be NULL.
+ */
+void OCClearResourceCache(OCResourceCache *cache);
+
+/**
+ * Drop the representations and free the cache of a resource.
+ *
+ * @param[in] cache  cache of the resource, may be NULL.
+ */
+void OCDeleteResourceCache(OCResourceCache *cache);
+
+/**
+ * Check whether the options of a request carry an ETag.
+ *
+ * @param[in] options     options of the request.
+ * @param[in] numOptions  number of options.
+ * @param[in] etag        ETag, ::OC_ETAG_LENGTH bytes.
+ *
+ * @return true if one of the ETag options of the request is @p etag.
+ */
+bool OCHasETagOption(const OCHeaderOption *options, uint8_t numOptions, const uint8_t *etag);
+
+/**
+ * Check whether an option is one of the cache options the stack handles itself.
+ *
+ * The ETag and Max-Age options are not passed to the applications.
+ *
+ * @param[in] optionID  ID of the option.
+ *
+ * @return true for the ETag and Max-Age options.
+ */
+bool OCIsCacheHeaderOption(uint16_t optionID);
+
+/**
+ * Fill the ETag and Max-Age options of a response.
+ *
+ * @param[out] options  two options.
+ * @param[in]  etag     ETag, ::OC_ETAG_LENGTH bytes.
+ * @param[in]  maxAge   Max-Age, in seconds.
+ */
+void OCSetCacheOptions(CAHeaderOption_t *options, const uint8_t *etag, uint32_t maxAge);
+
+/**
+ * Count a GET request of a resource with a cache, answered from the cache or not.
+ *
+ * @param[in] hit  true if the request was answered from the cache.
+ */
+void OCCountServerCacheRequest(bool hit);
+
+/**
+ * Count a 2.03 Valid response sent by a server.
+ */
+void OCCountServerCacheValidation(void);
+
+/**
+ * State of the response cached by a client for a request.
+ */
+typedef enum
+{
+    OC_CLIENT_CACHE_MISS = 0,   /**< no response is cached. */
+    OC_CLIENT_CACHE_FRESH,      /**< the cached response can be used. */
+    OC_CLIENT_CACHE_STALE       /**< the cached response has to be revalidated. */
+} OCClientCacheState;
+
+/**
+ * Look up the response cached for a GET request.
+ *
+ * @param[in]  devAddr     destination of the request.
+ * @param[in]  uri         URI and query of the request.
+ * @param[out] etagOption  ETag option to revalidate a stale response.
+ *
+ * @return state of the cached response.
+ */
+OCClientCacheState OCLookupClientCache(const OCDevAddr *devAddr, const char *uri,
+                                       CAHeaderOption_t *etagOption);
+
+/**
+ * Queue the fresh cached response of a GET request, to be delivered by
+ * OCDeliverCachedResponses() on the next OCProcess().
+ *
+ * @param[in] devAddr      destination of the request.
+ * @param[in] uri          URI and query of the request.
+ * @param[in] endpoint     endpoint of the destination.
+ * @param[in] token        token of the request.
+ * @param[in] tokenLength  length of the token.
+ *
+ * @return ::OC_STACK_OK if the response is queued, ::OC_STACK_NO_RESOURCE if there is
+ *         no fresh response.
+ */
+OCStackResult OCQueueCachedResponse(const OCDevAddr *devAddr, const char *uri,
+                                    const CAEndpoint_t *endpoint,
+                                    const CAToken_t token, uint8_t tokenLength);
+
+/**
+ * Handler of the queued cached responses.
+ */
+typedef void (OC_CALL *OCCachedResponseHandler)(const CAEndpoint_t *endpoint,
+                                                const CAResponseInfo_t *responseInfo);
+
+/**
+ * Deliver the queued cached responses.
+ *
+ * @param[in] handler  handler of the responses.
+ */
+void OCDeliverCachedResponses(OCCachedResponseHandler handler);
+
+/**
+ * Keep the response to a GET request, or complete a 2.03 Valid response with the
+ * cached representation.
+ *
+ * @param[in]  devAddr       destination of the request.
+ * @param[in]  uri           URI and query of the request.
+ * @param[in]  responseInfo  received response.
+ * @param[out] validated     storage of the completed response.
+ *
+ * @return the response to handle, @p responseInfo or @p validated.
+ */
+const CAResponseInfo_t *OCHandleClientCacheResponse(const OCDevAddr *devAddr, const char *uri,
+                                                    const CAResponseInfo_t *responseInfo,
+                                                    CAResponseInfo_t *validated);
+
+/**
+ * Drop the responses kept and queued by the client cache.
+ */
+void OCTerminateClientCache(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* OC_RESPONSE_CACHE_H_ */
@@ -31,6 +31,7 @@
 
 #include "cacommon.h"
 #include "cainterface.h"
+#include "ocresponsecache.h"
 
 #include "tree.h"
 
@@ -46,6 +47,18 @@ extern "C"
  */
 typedef OCStackResult (* OCEHResponseHandler)(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Child of a batch request which has not responded yet.
+ */
+typedef struct
+{
+    /** Resource handle of the child.*/
+    OCResourceHandle resource;
+
+    /** URI of the child, reported if it does not respond before the batch deadline.*/
+    char *uri;
+} OCBatchChild;
+
 /**
  * following structure will be created in occoap and passed up the stack on the server side.
  */
@@ -106,21 +119,58 @@ typedef struct OCServerRequest
     /** An Array  of received vendor specific header options.*/
     OCHeaderOption rcvdVendorSpecificHeaderOptions[MAX_HEADER_OPTIONS];
 
+    /** Number of received ETag options.*/
+    uint8_t numETagOptions;
+
+    /** ETag options of the request, kept from the vendor specific header options.*/
+    OCHeaderOption etagOptions[OC_MAX_REQUEST_ETAGS];
+
     /** Request to complete.*/
     uint8_t requestComplete;
 
     /** Node entry in red-black tree of linked lists.*/
     RBL_ENTRY(OCServerRequest) entry;
 
+    /** Node entry in red-black tree of the live request handles.*/
+    RB_ENTRY(OCServerRequest) handleEntry;
+
     /** Flag indicating slow response.*/
     uint8_t slowFlag;
 
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /** Producer of a streamed response payload, released with the request.*/
+    CABlockStream_t *blockStream;
+
+    /** Content format of the streamed response payload.*/
+    OCPayloadFormat blockStreamFormat;
+
     /** Payload format retrieved from the received request PDU. */
     OCPayloadFormat payloadFormat;
 
+    /** Children of a batch request which have not responded yet, NULL without deadline.*/
+    OCBatchChild *batchChildren;
+
+    /** Number of entries in batchChildren.*/
+    uint8_t numBatchChildren;
+
+    /** Time in milliseconds at which a partial batch response is sent, then at which the
+     *  request is deleted if some children still have not responded.*/
+    uint64_t batchDeadline;
+
+    /** Flag indicating the partial batch response was sent, later responses are discarded.*/
+    uint8_t batchClosed;
+
+    /** Next batch request waiting for its deadline.*/
+    struct OCServerRequest *nextBatch;
+
+    /** Flag indicating the request is allocated from the pool of small requests.*/
+    uint8_t pooled;
+
+    /** Flag indicating the response is kept by the cache of the resource.*/
+    uint8_t cacheable;
+
     /** Payload Size.*/
     size_t payloadSize;
 
@@ -210,6 +260,16 @@ OCStackResult AddServerRequest (OCServerRequest ** request,
  */
 OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tokenLength);
 
+/**
+ * Get a server request from the server request list using its handle, without accessing
+ * the handle, which may be the one of a deleted request.
+ *
+ * @param[in]  handle           handle of server request.
+ *
+ * @return the server request if it is live, otherwise NULL
+ */
+OCServerRequest * GetServerRequestUsingHandle (OCRequestHandle handle);
+
 /**
  * Find a server request in the server request list and delete
  *
@@ -230,9 +290,9 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
- * concatenated response
- *
- * TODO: Need to add a timeout in case a (remote?) resource does not respond
+ * concatenated response. With a batch response timeout (see SetBatchResponseTimeout) each
+ * entry also carries the result of its child, and the children which have not responded by the
+ * deadline are reported as timed out.
  *
  * @param[in]  ehResponse      Pointer to the response from the resource.
  *
@@ -241,6 +301,64 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
  */
 OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Set how long a batch request waits for the responses of its children.
+ *
+ * @param[in]  timeoutMs    timeout in milliseconds, 0 to wait for all the children.
+ */
+void SetBatchResponseTimeout(uint32_t timeoutMs);
+
+/**
+ * Prepare a batch request for the responses of its children. Called before the entity
+ * handlers of the children are called.
+ *
+ * @param[in]  request          batch request.
+ * @param[in]  numChildren      number of children of the collection.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult StartBatchRequest(OCServerRequest *request, uint8_t numChildren);
+
+/**
+ * Register a child of a batch request before its entity handler is called, so that it is
+ * reported as timed out if it does not respond before the batch deadline.
+ * Does nothing unless a batch response timeout is set.
+ *
+ * @param[in]  request      batch request.
+ * @param[in]  resource     resource handle of the child.
+ * @param[in]  uri          URI of the child.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult AddBatchChild(OCServerRequest *request, OCResourceHandle resource,
+                            const char *uri);
+
+/**
+ * Send a partial response for the batch requests whose deadline has passed, with the
+ * children which have not responded reported as timed out. Delete the batch requests whose
+ * children still have not responded a while after their partial response.
+ * Reschedules ::OC_STACK_TIMER_BATCH at the next deadline.
+ */
+void CheckTimedOutBatchRequests(void);
+
+/**
+ * Answer a GET request with the representation cached by its resource, or with 2.03 Valid
+ * and no payload if the request presents the ETag of the representation. The request is
+ * deleted.
+ *
+ * @param[in]  request          GET request.
+ * @param[in]  representation   cached representation.
+ * @param[in]  maxAge           Max-Age of the response, in seconds.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult SendCachedResponse(OCServerRequest *request,
+                                 const OCCachedRepresentation *representation,
+                                 uint32_t maxAge);
+
 /**
  * Form the OCEntityHandlerRequest struct that is passed to a resource's entity handler
  *
@@ -306,6 +306,8 @@ uint32_t GetTicks(uint32_t milliSeconds);
  * @param filterOne will include result if the interface is included in the query.
  * @param filterTwo will include result if the resource type is included in the query.
  *
+ * The filters are allocated with OICRequestStrdup() and must be freed with OICRequestFree().
+ *
  * @return ::OC_STACK_OK on success, some other value upon failure
  */
 OCStackResult ExtractFiltersFromQuery(const char *query, char **filterOne, char **filterTwo);
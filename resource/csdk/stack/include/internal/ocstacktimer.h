@@ -0,0 +1,115 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the timer queue of the stack. Each time based mechanism of the
+ * stack keeps the deadline of its earliest pending work in a min-heap, so OCProcess()
+ * only runs the mechanisms which are due and OCGetNextTimeout() can tell the
+ * application how long it may sleep.
+ */
+
+#ifndef OC_STACK_TIMER_H_
+#define OC_STACK_TIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Time based mechanisms of the stack.
+ */
+typedef enum
+{
+    OC_STACK_TIMER_PRESENCE = 0,    /**< presence TTL of the client callbacks. */
+    OC_STACK_TIMER_CLIENT_CB,       /**< time-out of the client callbacks. */
+    OC_STACK_TIMER_OBSERVER,        /**< TTL of the observers. */
+    OC_STACK_TIMER_KEEPALIVE,       /**< keepalive pings of TCP connections. */
+    OC_STACK_TIMER_BATCH,           /**< deadline of the batch requests of collections. */
+    OC_STACK_TIMER_RESPONSE_CACHE,  /**< delivery of the responses from the client cache. */
+    OC_STACK_TIMER_COUNT            /**< number of timers. */
+} OCStackTimerKind;
+
+/**
+ * Deadline of a timer which is not scheduled.
+ */
+#define OC_STACK_TIMER_NEVER UINT64_MAX
+
+/**
+ * Schedule a timer, unless it is already scheduled to expire earlier.
+ * Use this when new work is added to a mechanism.
+ *
+ * @param[in] kind      timer to schedule.
+ * @param[in] deadline  time in milliseconds (OICGetCurrentTime(TIME_IN_MS) clock).
+ */
+void OCScheduleStackTimer(OCStackTimerKind kind, uint64_t deadline);
+
+/**
+ * Set the deadline of a timer, or cancel it with ::OC_STACK_TIMER_NEVER.
+ * Use this when a mechanism has computed the exact deadline of its earliest work.
+ *
+ * @param[in] kind      timer to set.
+ * @param[in] deadline  time in milliseconds, or ::OC_STACK_TIMER_NEVER.
+ */
+void OCSetStackTimer(OCStackTimerKind kind, uint64_t deadline);
+
+/**
+ * Remove the earliest timer if it has expired.
+ * The mechanism of the timer is expected to do its work and to set its next deadline.
+ *
+ * @param[in]  now      current time in milliseconds.
+ * @param[out] kind     expired timer.
+ *
+ * @return true if a timer has expired.
+ */
+bool OCPopExpiredStackTimer(uint64_t now, OCStackTimerKind *kind);
+
+/**
+ * Get the deadline of the earliest timer.
+ *
+ * @return time in milliseconds, or ::OC_STACK_TIMER_NEVER if no timer is scheduled.
+ */
+uint64_t OCGetStackTimerDeadline(void);
+
+/**
+ * Convert a deadline in CoAP ticks (as used by the TTL of client callbacks,
+ * observers and presence) to a stack timer deadline.
+ *
+ * @param[in] ticks     deadline in CoAP ticks.
+ *
+ * @return time in milliseconds.
+ */
+uint64_t OCTicksToStackTimerDeadline(uint32_t ticks);
+
+/**
+ * Cancel all the timers.
+ */
+void OCResetStackTimers(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* OC_STACK_TIMER_H_ */
@@ -81,6 +81,53 @@ void ProcessKeepAlive(void);
 OCStackResult HandleKeepAliveRequest(OCServerRequest *request,
                                      const OCResource *resource);
 
+/**
+ * KeepAlive table entry.
+ */
+typedef struct KeepAliveEntry KeepAliveEntry_t;
+
+/**
+ * Gets keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference URI and transport type) to
+ *                          which the ping message has to be sent.
+ * @return  KeepAlive entry to send ping message.
+ */
+KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint);
+
+/**
+ * Add keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference URI and transport type).
+ * @param[in]   mode        Whether it is OIC Server or OIC Client.
+ * @param[in]   intervalArray   Received interval values from cloud server.
+ * @return  The KeepAlive entry added in KeepAlive Table.
+ */
+KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
+                                    int64_t *intervalArray);
+
+/**
+ * Remove keepalive entry.
+ * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
+ *                          port, reference URI and transport type).
+ * @return  ::OC_STACK_OK or Appropriate error code.
+ */
+OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint);
+
+/**
+ * Get the entry which is due first.
+ * @return  KeepAlive entry with the earliest deadline, NULL if the table is empty.
+ */
+KeepAliveEntry_t *GetNextKeepAliveEntry(void);
+
+/**
+ * Move the entry in the deadline heap after its time stamp or state has changed.
+ *
+ * @param[in]   entry       KeepAlive entry.
+ * @param[in]   deadline    new deadline of the entry. in milliseconds.
+ */
+void UpdateKeepAliveDeadline(KeepAliveEntry_t *entry, uint64_t deadline);
+
 /**
  * API to handle the connected device for KeepAlive.
  * @param[in]   endpoint        Remote endpoint information.
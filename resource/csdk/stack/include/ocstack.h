@@ -144,6 +144,31 @@ OCStackResult OC_CALL OCStopMulticastServer(void);
  */
 OCStackResult OC_CALL OCProcess(void);
 
+/**
+ * This function returns how long the main loop may wait before it calls OCProcess()
+ * again. The main loop should wait for this time or until the handler registered with
+ * OCRegisterProcessWakeupHandler() is called, whichever comes first.
+ *
+ * @return time in milliseconds, 0 if OCProcess() has work to do now, or UINT32_MAX if
+ *         OCProcess() has nothing to do until a message is received.
+ */
+uint32_t OC_CALL OCGetNextTimeout(void);
+
+/**
+ * This function registers the handler which is called when a message has been
+ * received and is waiting for OCProcess().
+ * The handler is called from a connectivity thread and must not register another
+ * handler. Once a new handler is registered, the previous one is no longer running.
+ * OCStop() unregisters the handler.
+ *
+ * @param handler   Wake-up handler, or NULL to unregister it.
+ * @param context   Context passed to the handler.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCRegisterProcessWakeupHandler(OCProcessWakeupHandler handler,
+                                                     void *context);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -236,6 +261,44 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
                           OCHeaderOption *options,
                           uint8_t numOptions);
 
+/**
+ * This function performs a request like ::OCDoRequest, but hands the payload of a
+ * blockwise response to a consumer block by block instead of reassembling it, so that
+ * memory use stays bounded by the block size. The response callback is invoked with no
+ * payload once the last block has been consumed. Responses which fit in a single message
+ * are delivered to the response callback as usual.
+ *
+ * @param handle            See ::OCDoRequest.
+ * @param method            See ::OCDoRequest.
+ * @param requestUri        See ::OCDoRequest.
+ * @param destination       See ::OCDoRequest.
+ * @param payload           See ::OCDoRequest.
+ * @param connectivityType  See ::OCDoRequest.
+ * @param qos               See ::OCDoRequest.
+ * @param cbData            See ::OCDoRequest.
+ * @param options           See ::OCDoRequest.
+ * @param numOptions        See ::OCDoRequest.
+ * @param consumer          Callback receiving each block of the response payload.
+ * @param consumerContext   Context passed to consumer.
+ * @param deleter           Optional deleter of consumerContext. It is called once the
+ *                          transfer is over, also when this function fails.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCDoStreamingRequest(OCDoHandle *handle,
+                          OCMethod method,
+                          const char *requestUri,
+                          const OCDevAddr *destination,
+                          OCPayload* payload,
+                          OCConnectivityType connectivityType,
+                          OCQualityOfService qos,
+                          OCCallbackData *cbData,
+                          OCHeaderOption *options,
+                          uint8_t numOptions,
+                          OCBlockConsumer consumer,
+                          void *consumerContext,
+                          OCBlockContextDeleter deleter);
+
 /**
  * This function cancels a request associated with a specific @ref OCDoResource invocation.
  *
@@ -655,6 +718,92 @@ OCStackResult OC_CALL OCNotifyListOfObservers (OCResourceHandle handle,
  */
 OCStackResult OC_CALL OCDoResponse(OCEntityHandlerResponse *response);
 
+/**
+ * This function sends a response whose payload is produced block by block, so that the
+ * whole encoded payload never has to be held in memory. The payload member of response
+ * is ignored. Responses which are not sent by blockwise transfer (e.g. over TCP, or when
+ * the payload fits in a single message) are produced at once.
+ *
+ * @param response      Pointer to structure that contains response parameters.
+ * @param format        Content format of the produced payload.
+ * @param totalLength   Total length of the payload.
+ * @param producer      Callback filling each block of the payload.
+ * @param context       Context passed to producer.
+ * @param deleter       Optional deleter of context. It is called once the transfer is
+ *                      over, also when this function fails.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCDoStreamingResponse(OCEntityHandlerResponse *response,
+                                            OCPayloadFormat format,
+                                            size_t totalLength,
+                                            OCBlockProducer producer,
+                                            void *context,
+                                            OCBlockContextDeleter deleter);
+
+/**
+ * This function sets how long a request to the batch interface of a collection waits for the
+ * responses of the children. Children returning ::OC_EH_SLOW respond concurrently; once the
+ * timeout expires the response is sent with the children which have responded, and the others
+ * are reported with ::OC_EH_RETRANSMIT_TIMEOUT. With a timeout, each entry of the batch
+ * response carries the result of its child in the ::OC_RSRVD_BATCH_STATUS property, and a
+ * child may respond with an error and no payload.
+ *
+ * @param timeoutMs  Timeout in milliseconds, 0 (the default) to wait for all the children.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCSetBatchResponseTimeout(uint32_t timeoutMs);
+
+/**
+ * This function enables the caching of the representations of a resource. The encoded
+ * response to a GET request without observation is kept, per query and accepted format, and
+ * the following identical requests are answered without calling the entity handler, until
+ * ::OCNotifyAllObservers or ::OCInvalidateResourceCache is called for the resource. The
+ * responses carry an ETag and a Max-Age option; a client presenting the ETag of the current
+ * representation is answered with 2.03 Valid and no payload.
+ *
+ * Only enable it for resources whose representation does not depend on the client.
+ *
+ * @param handle   Handle of resource.
+ * @param enable   true to cache the representations, false to stop and drop them.
+ * @param maxAge   Max-Age of the responses in seconds, how long the clients may use them.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCSetResourceCaching(OCResourceHandle handle, bool enable, uint32_t maxAge);
+
+/**
+ * This function drops the cached representations of a resource, after a change which is
+ * not notified with ::OCNotifyAllObservers.
+ *
+ * @param handle   Handle of resource.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCInvalidateResourceCache(OCResourceHandle handle);
+
+/**
+ * This function sets how many responses to GET requests the client keeps. A response with a
+ * Max-Age option is kept for that long, and a GET request of the same URI on the same
+ * endpoint is answered from the cache on the next ::OCProcess. A stale response with an ETag
+ * is revalidated with the server.
+ *
+ * @param capacity  Number of responses kept, 0 (the default) to disable the cache.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCSetClientCacheCapacity(uint32_t capacity);
+
+/**
+ * This function gets the counters of the response caches.
+ *
+ * @param serverStats   Counters of the representations cached by the resources, or NULL.
+ * @param clientStats   Counters of the responses cached by the client, or NULL.
+ */
+void OC_CALL OCGetResponseCacheStats(OCResponseCacheStats *serverStats,
+                                     OCResponseCacheStats *clientStats);
+
 /**
  * This function sets URI being used for proxy.
  *
@@ -24,6 +24,8 @@
 #include "experimental/logger.h"
 #include "trace.h"
 #include "oic_malloc.h"
+#include "oic_pool.h"
+#include "ocstacktimer.h"
 #include <string.h>
 
 #ifdef HAVE_SYS_TIME_H
@@ -43,6 +45,9 @@
 //      This should be static variable after we make a presence feature separately.
 struct ClientCB *g_cbList = NULL;
 
+/** Pool of the client callbacks.*/
+static OICPool *g_cbPool = NULL;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
@@ -99,7 +104,7 @@ static void DeleteClientCBInternal(ClientCB * cbNode)
         cbNode->deleteCallback(cbNode->context);
     }
 
-    OICFree(cbNode);
+    OICPoolFree(cbNode);
     cbNode = NULL;
 
     OIC_TRACE_END();
@@ -187,7 +192,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
     if (!cbNode)// If it does not already exist, create new node.
 #endif // WITH_PRESENCE
     {
-        cbNode = (ClientCB*) OICMalloc(sizeof(ClientCB));
+        cbNode = (ClientCB*) OICPoolAlloc(OICPoolGet(&g_cbPool, "ClientCB", sizeof(ClientCB)));
         if (!cbNode)
         {
             *clientCB = NULL;
@@ -214,7 +219,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
             if (!cbNode->options)
             {
                 OIC_LOG(ERROR, TAG, "Out of memory");
-                OICFree(cbNode);
+                OICPoolFree(cbNode);
                 return OC_STACK_NO_MEMORY;
             }
             memcpy(cbNode->options, options, sizeof(CAHeaderOption_t) * numOptions);
@@ -237,7 +242,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
                 {
                     OICFree(cbNode->options);
                 }
-                OICFree(cbNode);
+                OICPoolFree(cbNode);
                 return OC_STACK_NO_MEMORY;
             }
             memcpy(cbNode->payload, payload, payloadSize);
@@ -267,6 +272,10 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
         else
         {
             cbNode->TTL = ttl;
+            if (ttl)
+            {
+                OCScheduleStackTimer(OC_STACK_TIMER_CLIENT_CB, OCTicksToStackTimerDeadline(ttl));
+            }
         }
         cbNode->requestUri = requestUri;    // I own it now
         cbNode->devAddr = devAddr;          // I own it now
@@ -345,6 +354,33 @@ void DeleteClientCBList(void)
     g_cbList = NULL;
 }
 
+void DeleteTimedOutClientCBs(void)
+{
+    ClientCB* out = NULL;
+    ClientCB* tmp = NULL;
+    bool scheduled = false;
+    uint32_t earliest = 0;
+
+    LL_FOREACH_SAFE(g_cbList, out, tmp)
+    {
+        CheckAndDeleteTimedOutCB(out);
+    }
+
+    // The surviving nodes are either not timed (TTL 0) or due later.
+    // CheckAndDeleteTimedOutCB() deletes a node once its TTL is in the past.
+    LL_FOREACH(g_cbList, out)
+    {
+        if (out->TTL && (!scheduled || out->TTL < earliest))
+        {
+            earliest = out->TTL;
+            scheduled = true;
+        }
+    }
+
+    OCSetStackTimer(OC_STACK_TIMER_CLIENT_CB,
+                    scheduled ? OCTicksToStackTimerDeadline(earliest + 1) : OC_STACK_TIMER_NEVER);
+}
+
 ClientCB* GetClientCBUsingToken(const CAToken_t token,
                                 const uint8_t tokenLength)
 {
@@ -32,6 +32,7 @@
 #include "ocstack.h"
 #include "ocstackinternal.h"
 #include "oicgroup.h"
+#include "oic_arena.h"
 #include "oic_string.h"
 #include "experimental/payload_logging.h"
 #include "cainterface.h"
@@ -238,6 +239,9 @@ static OCStackResult HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
                 // will get the same pointer to ehRequest, the only difference
                 // is ehRequest->resource
                 ehRequest->resource = (OCResourceHandle) tempRsrcResource;
+                // Registered first, as the child may respond from its entity handler.
+                AddBatchChild((OCServerRequest *)ehRequest->requestHandle,
+                              (OCResourceHandle) tempRsrcResource, tempRsrcResource->uri);
                 OCEntityHandlerResult ehResult = tempRsrcResource->entityHandler(OC_REQUEST_FLAG,
                                            ehRequest, tempRsrcResource->entityHandlerCallbackParam);
 
@@ -289,7 +293,7 @@ OCStackResult DefaultCollectionEntityHandler(OCEntityHandlerFlag flag, OCEntityH
     }
     if (!ifQueryParam)
     {
-        ifQueryParam = OICStrdup(OC_RSRVD_INTERFACE_LL);
+        ifQueryParam = OICRequestStrdup(OC_RSRVD_INTERFACE_LL);
     }
 
     VERIFY_PARAM_NON_NULL(TAG, ifQueryParam, "Invalid Parameter ifQueryParam");
@@ -310,9 +314,13 @@ OCStackResult DefaultCollectionEntityHandler(OCEntityHandlerFlag flag, OCEntityH
         OCServerRequest *request = (OCServerRequest *)ehRequest->requestHandle;
         if (request)
         {
-            request->numResponses = GetNumOfResourcesInCollection((OCResource *)ehRequest->resource);
             request->ehResponseHandler = HandleAggregateResponse;
-            result = HandleBatchInterface(ehRequest);
+            result = StartBatchRequest(request,
+                        GetNumOfResourcesInCollection((OCResource *)ehRequest->resource));
+            if (result == OC_STACK_OK)
+            {
+                result = HandleBatchInterface(ehRequest);
+            }
         }
     }
     else if (0 == strcmp(ifQueryParam, OC_RSRVD_INTERFACE_GROUP))
@@ -326,8 +334,8 @@ exit:
     {
         result = SendResponse(NULL, ehRequest, OC_EH_BAD_REQ);
     }
-    OICFree(ifQueryParam);
-    OICFree(rtQueryParam);
+    OICRequestFree(ifQueryParam);
+    OICRequestFree(rtQueryParam);
     return result;
 }
 
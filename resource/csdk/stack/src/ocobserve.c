@@ -30,6 +30,7 @@
 #include "ocpayload.h"
 #include "ocserverrequest.h"
 #include "experimental/logger.h"
+#include "ocstacktimer.h"
 
 #include <coap/utlist.h>
 #include <coap/pdu.h>
@@ -42,6 +43,19 @@
 
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
+extern OCResource *headResource;
+
+/**
+ * Reset the TTL of an observer and make sure the observer timer expires no later than it.
+ *
+ * @param observer Observer.
+ */
+static void ResetObserverTTL(ResourceObserver *observer)
+{
+    observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+    OCScheduleStackTimer(OC_STACK_TIMER_OBSERVER, OCTicksToStackTimerDeadline(observer->TTL + 1));
+}
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -129,7 +143,7 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
             {
                 result = ProcessRequest(resHandling, resource, request);
                 // Reset Observer TTL.
-                observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                ResetObserverTTL(observer);
             }
         }
     }
@@ -298,8 +312,7 @@ OCStackResult SendListObserverNotification (OCResource * resource,
                         OIC_LOG_V(INFO, TAG, "Error notifying observer id %d.", *obsIdList);
                     }
                     // Reset Observer TTL.
-                    observer->TTL =
-                            GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                    ResetObserverTTL(observer);
                 }
                 else
                 {
@@ -410,7 +423,7 @@ OCStackResult AddObserver (const char         *resUri,
         }
         else
         {
-            obsNode->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+            ResetObserverTTL(obsNode);
         }
 
         LL_APPEND (resHandle->observersHead, obsNode);
@@ -453,6 +466,39 @@ static void CheckTimedOutObserver(ResourceObserver* observer, OCResource *resour
     }
 }
 
+void CheckTimedOutObservers(void)
+{
+    bool scheduled = false;
+    uint32_t earliest = 0;
+    OCResource *resource = NULL;
+
+    LL_FOREACH(headResource, resource)
+    {
+        ResourceObserver *out = NULL;
+        ResourceObserver *tmp = NULL;
+        LL_FOREACH_SAFE(resource->observersHead, out, tmp)
+        {
+            CheckTimedOutObserver(out, resource);
+        }
+
+        coap_tick_t now = 0;
+        coap_ticks(&now);
+        LL_FOREACH(resource->observersHead, out)
+        {
+            // An observer whose notification has failed keeps its past TTL; it is
+            // checked again when it is looked up rather than on every OCProcess().
+            if (out->TTL && (out->TTL >= now) && (!scheduled || out->TTL < earliest))
+            {
+                earliest = out->TTL;
+                scheduled = true;
+            }
+        }
+    }
+
+    OCSetStackTimer(OC_STACK_TIMER_OBSERVER,
+                    scheduled ? OCTicksToStackTimerDeadline(earliest + 1) : OC_STACK_TIMER_NEVER);
+}
+
 ResourceObserver* GetObserverUsingId(OCResource *resource,
                                      const OCObservationId observeId)
 {
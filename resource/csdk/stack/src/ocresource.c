@@ -44,6 +44,7 @@
 #include "ocobserve.h"
 #include "occollection.h"
 #include "oic_malloc.h"
+#include "oic_arena.h"
 #include "oic_string.h"
 #include "experimental/logger.h"
 #include "ocpayload.h"
@@ -194,7 +195,7 @@ OCStackResult ExtractFiltersFromQuery(const char *query, char **filterOne, char
     *filterOne = NULL;
     *filterTwo = NULL;
 
-    queryDup = OICStrdup(query);
+    queryDup = OICRequestStrdup(query);
     if (NULL == queryDup)
     {
         OIC_LOG(ERROR, TAG, "Creating duplicate string failed!");
@@ -246,7 +247,7 @@ OCStackResult ExtractFiltersFromQuery(const char *query, char **filterOne, char
 
     if (*filterOne)
     {
-        *filterOne = OICStrdup(*filterOne);
+        *filterOne = OICRequestStrdup(*filterOne);
         if (NULL == *filterOne)
         {
             OIC_LOG(ERROR, TAG, "Creating duplicate string failed!");
@@ -257,24 +258,24 @@ OCStackResult ExtractFiltersFromQuery(const char *query, char **filterOne, char
 
     if (*filterTwo)
     {
-        *filterTwo = OICStrdup(*filterTwo);
+        *filterTwo = OICRequestStrdup(*filterTwo);
         if (NULL == *filterTwo)
         {
             OIC_LOG(ERROR, TAG, "Creating duplicate string failed!");
-            OICFree(*filterOne);
+            OICRequestFree(*filterOne);
             eCode = OC_STACK_NO_MEMORY;
             goto exit;
         }
     }
 
-    OICFree(queryDup);
+    OICRequestFree(queryDup);
     OIC_LOG_V(INFO, TAG, "Extracted params if: %s and rt: %s.", *filterOne, *filterTwo);
     return OC_STACK_OK;
 
 exit:
     *filterOne = NULL;
     *filterTwo = NULL;
-    OICFree(queryDup);
+    OICRequestFree(queryDup);
     return eCode;
 }
 
@@ -1965,7 +1966,7 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
         if (!interfaceQuery && !resourceTypeQuery)
         {
             // If no query is sent, default interface is used i.e. oic.if.ll.
-            interfaceQuery = OICStrdup(OC_RSRVD_INTERFACE_LL);
+            interfaceQuery = OICRequestStrdup(OC_RSRVD_INTERFACE_LL);
         }
 
         discoveryResult = discoveryPayloadCreateAndAddDeviceId(&payload);
@@ -2141,12 +2142,12 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 exit:
     if (interfaceQuery)
     {
-        OICFree(interfaceQuery);
+        OICRequestFree(interfaceQuery);
     }
 
     if (resourceTypeQuery)
     {
-        OICFree(resourceTypeQuery);
+        OICRequestFree(resourceTypeQuery);
     }
     OCPayloadDestroy(payload);
 
@@ -2203,6 +2204,23 @@ HandleResourceWithEntityHandler(OCServerRequest *request,
     OCEntityHandlerRequest ehRequest = {0};
 
     OIC_LOG(INFO, TAG, "Entering HandleResourceWithEntityHandler");
+
+    // A GET request of a resource which caches its representations is answered from the
+    // cache, without calling the entity handler.
+    if (resource->cache && (OC_REST_GET == request->method)
+        && (OC_OBSERVE_NO_OPTION == request->observationOption))
+    {
+        const OCCachedRepresentation *representation = OCGetCachedRepresentation(
+                resource->cache, request->query, request->acceptFormat, request->acceptVersion);
+        OCCountServerCacheRequest(NULL != representation);
+        if (representation)
+        {
+            return SendCachedResponse(request, representation, resource->cache->maxAge);
+        }
+        // The response of the entity handler is kept by the cache.
+        request->cacheable = 1;
+    }
+
     OCPayloadType type = PAYLOAD_TYPE_REPRESENTATION;
     // check the security resource
     if (request && request->resourceUrl && SRMIsSecurityResourceURI(request->resourceUrl))
@@ -0,0 +1,696 @@
+/* *****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ocstack.h"
+#include "ocresponsecache.h"
+#include "ocstacktimer.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_time.h"
+#include "experimental/logger.h"
+#include <coap/pdu.h>
+
+#define TAG "OIC_RI_RESPONSECACHE"
+
+/** FNV-1a parameters of the ETags. */
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+#define MILLISECONDS_PER_SECOND   (1000)
+
+/** Longest ETag option (RFC 7252, 5.10). */
+#define MAX_ETAG_OPTION_LENGTH 8
+
+/**
+ * A response kept by the client.
+ */
+typedef struct OCClientCacheEntry
+{
+    /** Next entry, the most recently used first. */
+    struct OCClientCacheEntry *next;
+
+    /** Destination of the request. */
+    OCDevAddr devAddr;
+
+    /** URI and query of the request. */
+    char *uri;
+
+    /** Encoded representation. */
+    uint8_t *payload;
+
+    /** Size of the encoded representation. */
+    size_t payloadSize;
+
+    /** Content format of the representation. */
+    CAPayloadFormat_t payloadFormat;
+
+    /** Content version of the representation. */
+    uint16_t payloadVersion;
+
+    /** ETag of the representation, if the server sent one. */
+    uint8_t etag[MAX_ETAG_OPTION_LENGTH];
+
+    /** Length of the ETag, 0 without ETag. */
+    uint8_t etagLength;
+
+    /** Time at which the response becomes stale, in milliseconds. */
+    uint64_t expiry;
+} OCClientCacheEntry;
+
+/**
+ * A cached response waiting to be delivered.
+ */
+typedef struct OCPendingCachedResponse
+{
+    /** Next response, in the order of the requests. */
+    struct OCPendingCachedResponse *next;
+
+    /** Endpoint of the destination of the request. */
+    CAEndpoint_t endpoint;
+
+    /** Token of the request. */
+    uint8_t token[CA_MAX_TOKEN_LEN];
+
+    /** Length of the token. */
+    uint8_t tokenLength;
+
+    /** Copy of the response. */
+    OCClientCacheEntry response;
+} OCPendingCachedResponse;
+
+static OCResponseCacheStats g_serverCacheStats;
+static OCResponseCacheStats g_clientCacheStats;
+
+static OCClientCacheEntry *g_clientCache = NULL;
+static uint32_t g_clientCacheCapacity = 0;
+
+static OCPendingCachedResponse *g_pendingHead = NULL;
+static OCPendingCachedResponse *g_pendingTail = NULL;
+
+void OCComputeETag(const uint8_t *payload, size_t payloadSize, uint8_t *etag)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < payloadSize; i++)
+    {
+        hash = (hash ^ payload[i]) * FNV_PRIME;
+    }
+    for (size_t i = 0; i < OC_ETAG_LENGTH; i++)
+    {
+        etag[i] = (uint8_t)(hash >> (8 * (OC_ETAG_LENGTH - 1 - i)));
+    }
+}
+
+static bool IsSameQuery(const char *query1, const char *query2)
+{
+    return 0 == strcmp(query1 ? query1 : "", query2 ? query2 : "");
+}
+
+static void FreeRepresentation(OCCachedRepresentation *representation)
+{
+    OICFree(representation->query);
+    OICFree(representation->payload);
+    OICFree(representation);
+}
+
+const OCCachedRepresentation *OCGetCachedRepresentation(const OCResourceCache *cache,
+                                                        const char *query,
+                                                        OCPayloadFormat acceptFormat,
+                                                        uint16_t acceptVersion)
+{
+    if (!cache)
+    {
+        return NULL;
+    }
+    for (const OCCachedRepresentation *representation = cache->representations;
+         representation; representation = representation->next)
+    {
+        if ((representation->acceptFormat == acceptFormat)
+            && (representation->acceptVersion == acceptVersion)
+            && IsSameQuery(representation->query, query))
+        {
+            return representation;
+        }
+    }
+    return NULL;
+}
+
+OCStackResult OCCacheRepresentation(OCResourceCache *cache, const char *query,
+                                    OCPayloadFormat acceptFormat, uint16_t acceptVersion,
+                                    const CAInfo_t *info,
+                                    const OCCachedRepresentation **representation)
+{
+    if (!cache || !info || !info->payload || !info->payloadSize)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCCachedRepresentation *entry = (OCCachedRepresentation *)
+            OICCalloc(1, sizeof(OCCachedRepresentation));
+    if (!entry)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    entry->query = OICStrdup(query ? query : "");
+    entry->payload = (uint8_t *)OICMalloc(info->payloadSize);
+    if (!entry->query || !entry->payload)
+    {
+        FreeRepresentation(entry);
+        return OC_STACK_NO_MEMORY;
+    }
+    memcpy(entry->payload, info->payload, info->payloadSize);
+    entry->payloadSize = info->payloadSize;
+    entry->payloadFormat = info->payloadFormat;
+    entry->payloadVersion = info->payloadVersion;
+    entry->acceptFormat = acceptFormat;
+    entry->acceptVersion = acceptVersion;
+    OCComputeETag(entry->payload, entry->payloadSize, entry->etag);
+
+    // The new representation replaces the one of the same request, or the oldest one.
+    OCCachedRepresentation **link = &cache->representations;
+    size_t count = 0;
+    while (*link)
+    {
+        OCCachedRepresentation *current = *link;
+        if (((current->acceptFormat == acceptFormat)
+             && (current->acceptVersion == acceptVersion)
+             && IsSameQuery(current->query, query))
+            || (++count >= OC_RESOURCE_CACHE_MAX_REPRESENTATIONS))
+        {
+            *link = current->next;
+            FreeRepresentation(current);
+            continue;
+        }
+        link = &current->next;
+    }
+    entry->next = cache->representations;
+    cache->representations = entry;
+
+    if (representation)
+    {
+        *representation = entry;
+    }
+    return OC_STACK_OK;
+}
+
+void OCClearResourceCache(OCResourceCache *cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+    while (cache->representations)
+    {
+        OCCachedRepresentation *representation = cache->representations;
+        cache->representations = representation->next;
+        FreeRepresentation(representation);
+    }
+}
+
+void OCDeleteResourceCache(OCResourceCache *cache)
+{
+    OCClearResourceCache(cache);
+    OICFree(cache);
+}
+
+bool OCHasETagOption(const OCHeaderOption *options, uint8_t numOptions, const uint8_t *etag)
+{
+    if (!options || !etag)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < numOptions; i++)
+    {
+        // A request may present the ETags of several representations.
+        if ((COAP_OPTION_ETAG == options[i].optionID)
+            && (OC_ETAG_LENGTH == options[i].optionLength)
+            && (0 == memcmp(options[i].optionData, etag, OC_ETAG_LENGTH)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OCIsCacheHeaderOption(uint16_t optionID)
+{
+    return (COAP_OPTION_ETAG == optionID) || (COAP_OPTION_MAXAGE == optionID);
+}
+
+static void SetETagOption(CAHeaderOption_t *option, const uint8_t *etag, uint8_t etagLength)
+{
+    option->protocolID = CA_COAP_ID;
+    option->optionID = COAP_OPTION_ETAG;
+    option->optionLength = etagLength;
+    memcpy(option->optionData, etag, etagLength);
+}
+
+static void SetMaxAgeOption(CAHeaderOption_t *option, uint32_t maxAge)
+{
+    // A CoAP uint, in network byte order without leading zero bytes.
+    uint8_t length = 0;
+    for (uint32_t value = maxAge; value; value >>= 8)
+    {
+        length++;
+    }
+    option->protocolID = CA_COAP_ID;
+    option->optionID = COAP_OPTION_MAXAGE;
+    option->optionLength = length;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        option->optionData[i] = (char)(maxAge >> (8 * (length - 1 - i)));
+    }
+}
+
+void OCSetCacheOptions(CAHeaderOption_t *options, const uint8_t *etag, uint32_t maxAge)
+{
+    SetETagOption(&options[0], etag, OC_ETAG_LENGTH);
+    SetMaxAgeOption(&options[1], maxAge);
+}
+
+void OCCountServerCacheRequest(bool hit)
+{
+    if (hit)
+    {
+        g_serverCacheStats.hits++;
+    }
+    else
+    {
+        g_serverCacheStats.misses++;
+    }
+}
+
+void OCCountServerCacheValidation(void)
+{
+    g_serverCacheStats.validated++;
+}
+
+void OC_CALL OCGetResponseCacheStats(OCResponseCacheStats *serverStats,
+                                     OCResponseCacheStats *clientStats)
+{
+    if (serverStats)
+    {
+        *serverStats = g_serverCacheStats;
+    }
+    if (clientStats)
+    {
+        *clientStats = g_clientCacheStats;
+    }
+}
+
+static bool IsSameDestination(const OCDevAddr *devAddr1, const OCDevAddr *devAddr2)
+{
+    return (devAddr1->adapter == devAddr2->adapter)
+        && ((devAddr1->flags & OC_FLAG_SECURE) == (devAddr2->flags & OC_FLAG_SECURE))
+        && (devAddr1->port == devAddr2->port)
+        && (0 == strcmp(devAddr1->addr, devAddr2->addr));
+}
+
+/**
+ * Check whether a request goes to a group of servers.
+ *
+ * The responses of several servers to a multicast request would share one entry, so these
+ * requests are not answered from the cache.
+ */
+static bool IsMulticastDestination(const OCDevAddr *devAddr)
+{
+    if (devAddr->flags & OC_MULTICAST)
+    {
+        return true;
+    }
+    if (strchr(devAddr->addr, ':'))
+    {
+        // IPv6 multicast addresses start with ff.
+        return (('f' == tolower((unsigned char)devAddr->addr[0]))
+                && ('f' == tolower((unsigned char)devAddr->addr[1])));
+    }
+    long firstOctet = strtol(devAddr->addr, NULL, 10);
+    return (firstOctet >= 224) && (firstOctet <= 239);
+}
+
+static void FreeClientCacheEntry(OCClientCacheEntry *entry)
+{
+    OICFree(entry->uri);
+    OICFree(entry->payload);
+    OICFree(entry);
+}
+
+/**
+ * Find the response kept for a request, and move it first.
+ *
+ * @return the response, or NULL.
+ */
+static OCClientCacheEntry *FindClientCacheEntry(const OCDevAddr *devAddr, const char *uri)
+{
+    for (OCClientCacheEntry **link = &g_clientCache; *link; link = &(*link)->next)
+    {
+        OCClientCacheEntry *entry = *link;
+        if (IsSameDestination(&entry->devAddr, devAddr) && (0 == strcmp(entry->uri, uri)))
+        {
+            *link = entry->next;
+            entry->next = g_clientCache;
+            g_clientCache = entry;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Drop the responses used the least long ago which do not fit in the cache.
+ */
+static void TrimClientCache(uint32_t capacity)
+{
+    OCClientCacheEntry **link = &g_clientCache;
+    for (uint32_t i = 0; *link && (i < capacity); i++)
+    {
+        link = &(*link)->next;
+    }
+    while (*link)
+    {
+        OCClientCacheEntry *entry = *link;
+        *link = entry->next;
+        FreeClientCacheEntry(entry);
+    }
+}
+
+static void RemoveClientCacheEntry(OCClientCacheEntry *entry)
+{
+    for (OCClientCacheEntry **link = &g_clientCache; *link; link = &(*link)->next)
+    {
+        if (*link == entry)
+        {
+            *link = entry->next;
+            FreeClientCacheEntry(entry);
+            return;
+        }
+    }
+}
+
+OCStackResult OC_CALL OCSetClientCacheCapacity(uint32_t capacity)
+{
+    OIC_LOG_V(INFO, TAG, "Client cache capacity set to %u", capacity);
+    g_clientCacheCapacity = capacity;
+    TrimClientCache(capacity);
+    return OC_STACK_OK;
+}
+
+OCClientCacheState OCLookupClientCache(const OCDevAddr *devAddr, const char *uri,
+                                       CAHeaderOption_t *etagOption)
+{
+    if (!g_clientCacheCapacity || !devAddr || !uri || IsMulticastDestination(devAddr))
+    {
+        return OC_CLIENT_CACHE_MISS;
+    }
+
+    OCClientCacheEntry *entry = FindClientCacheEntry(devAddr, uri);
+    if (!entry)
+    {
+        g_clientCacheStats.misses++;
+        return OC_CLIENT_CACHE_MISS;
+    }
+    if (OICGetCurrentTime(TIME_IN_MS) < entry->expiry)
+    {
+        g_clientCacheStats.hits++;
+        return OC_CLIENT_CACHE_FRESH;
+    }
+
+    g_clientCacheStats.misses++;
+    if (!entry->etagLength || !etagOption)
+    {
+        RemoveClientCacheEntry(entry);
+        return OC_CLIENT_CACHE_MISS;
+    }
+    SetETagOption(etagOption, entry->etag, entry->etagLength);
+    return OC_CLIENT_CACHE_STALE;
+}
+
+OCStackResult OCQueueCachedResponse(const OCDevAddr *devAddr, const char *uri,
+                                    const CAEndpoint_t *endpoint,
+                                    const CAToken_t token, uint8_t tokenLength)
+{
+    if (!devAddr || !uri || !endpoint || (tokenLength > CA_MAX_TOKEN_LEN))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    OCClientCacheEntry *entry = (g_clientCacheCapacity && !IsMulticastDestination(devAddr)) ?
+                                FindClientCacheEntry(devAddr, uri) : NULL;
+    if (!entry || (now >= entry->expiry))
+    {
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    OCPendingCachedResponse *pending = (OCPendingCachedResponse *)
+            OICCalloc(1, sizeof(OCPendingCachedResponse));
+    if (!pending)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    pending->endpoint = *endpoint;
+    memcpy(pending->token, token, tokenLength);
+    pending->tokenLength = tokenLength;
+    pending->response = *entry;
+    pending->response.next = NULL;
+    pending->response.uri = OICStrdup(entry->uri);
+    pending->response.payload = (uint8_t *)OICMalloc(entry->payloadSize);
+    if (!pending->response.uri || !pending->response.payload)
+    {
+        OICFree(pending->response.uri);
+        OICFree(pending->response.payload);
+        OICFree(pending);
+        return OC_STACK_NO_MEMORY;
+    }
+    memcpy(pending->response.payload, entry->payload, entry->payloadSize);
+
+    if (g_pendingTail)
+    {
+        g_pendingTail->next = pending;
+    }
+    else
+    {
+        g_pendingHead = pending;
+    }
+    g_pendingTail = pending;
+    OCScheduleStackTimer(OC_STACK_TIMER_RESPONSE_CACHE, now);
+    return OC_STACK_OK;
+}
+
+void OCDeliverCachedResponses(OCCachedResponseHandler handler)
+{
+    // The responses queued by the handlers are delivered by the next OCProcess().
+    OCPendingCachedResponse *pending = g_pendingHead;
+    g_pendingHead = NULL;
+    g_pendingTail = NULL;
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    while (pending)
+    {
+        OCPendingCachedResponse *next = pending->next;
+        OCClientCacheEntry *response = &pending->response;
+
+        // The Max-Age left, as a proxy would forward it.
+        CAHeaderOption_t options[2];
+        uint8_t numOptions = 0;
+        if (response->etagLength)
+        {
+            SetETagOption(&options[numOptions++], response->etag, response->etagLength);
+        }
+        uint64_t maxAge = (response->expiry > now) ?
+                          (response->expiry - now) / MILLISECONDS_PER_SECOND : 0;
+        SetMaxAgeOption(&options[numOptions++], (uint32_t)maxAge);
+
+        CAResponseInfo_t responseInfo = {.result = CA_CONTENT};
+        responseInfo.info.type = CA_MSG_NONCONFIRM;
+        responseInfo.info.token = (CAToken_t)pending->token;
+        responseInfo.info.tokenLength = pending->tokenLength;
+        responseInfo.info.options = options;
+        responseInfo.info.numOptions = numOptions;
+        responseInfo.info.payload = response->payload;
+        responseInfo.info.payloadSize = response->payloadSize;
+        responseInfo.info.payloadFormat = response->payloadFormat;
+        responseInfo.info.payloadVersion = response->payloadVersion;
+        responseInfo.info.resourceUri = response->uri;
+        responseInfo.info.dataType = CA_RESPONSE_DATA;
+        handler(&pending->endpoint, &responseInfo);
+
+        OICFree(response->uri);
+        OICFree(response->payload);
+        OICFree(pending);
+        pending = next;
+    }
+}
+
+/**
+ * Find an option of a response.
+ *
+ * @return the option, or NULL.
+ */
+static const CAHeaderOption_t *GetResponseOption(const CAResponseInfo_t *responseInfo,
+                                                 uint16_t optionID)
+{
+    for (uint8_t i = 0; responseInfo->info.options && (i < responseInfo->info.numOptions); i++)
+    {
+        if (optionID == responseInfo->info.options[i].optionID)
+        {
+            return &responseInfo->info.options[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t GetMaxAge(const CAHeaderOption_t *option)
+{
+    uint32_t maxAge = 0;
+    for (uint16_t i = 0; (i < option->optionLength) && (i < sizeof(uint32_t)); i++)
+    {
+        maxAge = (maxAge << 8) | (uint8_t)option->optionData[i];
+    }
+    return maxAge;
+}
+
+/**
+ * Keep a response with a representation and a Max-Age.
+ */
+static void KeepClientCacheResponse(const OCDevAddr *devAddr, const char *uri,
+                                    const CAResponseInfo_t *responseInfo,
+                                    const CAHeaderOption_t *etag, uint64_t expiry)
+{
+    const CAInfo_t *info = &responseInfo->info;
+    OCClientCacheEntry *entry = FindClientCacheEntry(devAddr, uri);
+    if (entry && (entry->payloadSize == info->payloadSize)
+        && (0 == memcmp(entry->payload, info->payload, info->payloadSize)))
+    {
+        // The same representation, delivered again from the cache or sent again.
+        if (expiry > entry->expiry)
+        {
+            entry->expiry = expiry;
+        }
+        return;
+    }
+
+    uint8_t *payload = (uint8_t *)OICMalloc(info->payloadSize);
+    if (!payload)
+    {
+        return;
+    }
+    memcpy(payload, info->payload, info->payloadSize);
+
+    if (!entry)
+    {
+        entry = (OCClientCacheEntry *)OICCalloc(1, sizeof(OCClientCacheEntry));
+        if (!entry || !(entry->uri = OICStrdup(uri)))
+        {
+            OICFree(entry);
+            OICFree(payload);
+            return;
+        }
+        entry->devAddr = *devAddr;
+        entry->next = g_clientCache;
+        g_clientCache = entry;
+    }
+    OICFree(entry->payload);
+    entry->payload = payload;
+    entry->payloadSize = info->payloadSize;
+    entry->payloadFormat = info->payloadFormat;
+    entry->payloadVersion = info->payloadVersion;
+    entry->etagLength = 0;
+    if (etag && etag->optionLength && (etag->optionLength <= MAX_ETAG_OPTION_LENGTH))
+    {
+        entry->etagLength = (uint8_t)etag->optionLength;
+        memcpy(entry->etag, etag->optionData, entry->etagLength);
+    }
+    entry->expiry = expiry;
+
+    TrimClientCache(g_clientCacheCapacity);
+}
+
+const CAResponseInfo_t *OCHandleClientCacheResponse(const OCDevAddr *devAddr, const char *uri,
+                                                    const CAResponseInfo_t *responseInfo,
+                                                    CAResponseInfo_t *validated)
+{
+    if (!g_clientCacheCapacity || !devAddr || !uri || !responseInfo
+        || IsMulticastDestination(devAddr))
+    {
+        return responseInfo;
+    }
+
+    const CAHeaderOption_t *maxAgeOption = GetResponseOption(responseInfo, COAP_OPTION_MAXAGE);
+    const CAHeaderOption_t *etag = GetResponseOption(responseInfo, COAP_OPTION_ETAG);
+    uint32_t maxAge = maxAgeOption ? GetMaxAge(maxAgeOption) : OC_DEFAULT_MAX_AGE;
+    uint64_t expiry = OICGetCurrentTime(TIME_IN_MS) + (uint64_t)maxAge * MILLISECONDS_PER_SECOND;
+
+    if (CA_CONTENT == responseInfo->result)
+    {
+        // Only the servers which opt in send a Max-Age, the other responses are not kept.
+        if (maxAgeOption && responseInfo->info.payload && responseInfo->info.payloadSize)
+        {
+            KeepClientCacheResponse(devAddr, uri, responseInfo, etag, expiry);
+        }
+        else
+        {
+            OCClientCacheEntry *entry = FindClientCacheEntry(devAddr, uri);
+            if (entry)
+            {
+                RemoveClientCacheEntry(entry);
+            }
+        }
+        return responseInfo;
+    }
+
+    if ((CA_VALID == responseInfo->result) && etag && validated)
+    {
+        OCClientCacheEntry *entry = FindClientCacheEntry(devAddr, uri);
+        if (entry && (entry->etagLength == etag->optionLength)
+            && (0 == memcmp(entry->etag, etag->optionData, entry->etagLength)))
+        {
+            // The kept representation is still current, it completes the response.
+            OIC_LOG_V(DEBUG, TAG, "Cached response of %s validated", uri);
+            g_clientCacheStats.validated++;
+            entry->expiry = expiry;
+            *validated = *responseInfo;
+            validated->result = CA_CONTENT;
+            validated->info.payload = entry->payload;
+            validated->info.payloadSize = entry->payloadSize;
+            validated->info.payloadFormat = entry->payloadFormat;
+            validated->info.payloadVersion = entry->payloadVersion;
+            return validated;
+        }
+    }
+    return responseInfo;
+}
+
+void OCTerminateClientCache(void)
+{
+    TrimClientCache(0);
+    while (g_pendingHead)
+    {
+        OCPendingCachedResponse *pending = g_pendingHead;
+        g_pendingHead = pending->next;
+        OICFree(pending->response.uri);
+        OICFree(pending->response.payload);
+        OICFree(pending);
+    }
+    g_pendingTail = NULL;
+}
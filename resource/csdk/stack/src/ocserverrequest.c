@@ -24,8 +24,11 @@
 #include "ocserverrequest.h"
 #include "ocresourcehandler.h"
 #include "ocobserve.h"
+#include "ocstacktimer.h"
 #include "oic_malloc.h"
+#include "oic_pool.h"
 #include "oic_string.h"
+#include "oic_time.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
 #include "experimental/logger.h"
@@ -47,6 +50,9 @@
 // Module Name
 #define TAG "OIC_RI_SERVERREQUEST"
 
+// Requests with a payload up to this size are allocated from g_serverRequestPool
+#define POOLED_REQUEST_PAYLOAD_SIZE 256
+
 //-------------------------------------------------------------------------------------------------
 // Local functions for RB tree
 //-------------------------------------------------------------------------------------------------
@@ -55,6 +61,13 @@ static int RBRequestTokenCmp(OCServerRequest *target, OCServerRequest *treeNode)
     return memcmp(target->requestToken, treeNode->requestToken, target->tokenLength);
 }
 
+static int RBRequestHandleCmp(OCServerRequest *target, OCServerRequest *treeNode)
+{
+    uintptr_t targetAddress = (uintptr_t)target;
+    uintptr_t nodeAddress = (uintptr_t)treeNode;
+    return (targetAddress > nodeAddress) - (targetAddress < nodeAddress);
+}
+
 static int RBResponseTokenCmp(OCServerResponse *target, OCServerResponse *treeNode)
 {
     return memcmp(((OCServerRequest*)target->requestHandle)->requestToken,
@@ -69,10 +82,37 @@ RB_HEAD(ServerRequestTree, OCServerRequest) g_serverRequestTree =
                                                             RB_INITIALIZER(&g_serverRequestTree);
 RBL_GENERATE(ServerRequestTree, OCServerRequest, entry, RBRequestTokenCmp)
 
+/* The live requests by handle, to reject the handles of deleted requests. */
+static RB_HEAD(ServerRequestHandleTree, OCServerRequest) g_serverRequestHandleTree =
+                                                        RB_INITIALIZER(&g_serverRequestHandleTree);
+RB_GENERATE_STATIC(ServerRequestHandleTree, OCServerRequest, handleEntry, RBRequestHandleCmp)
+
 RB_HEAD(ServerResponseTree, OCServerResponse) g_serverResponseTree =
                                                             RB_INITIALIZER(&g_serverResponseTree);
 RB_GENERATE(ServerResponseTree, OCServerResponse, entry, RBResponseTokenCmp)
 
+/**
+ * Pools of the server requests with small payloads and of the server responses.
+ */
+static OICPool *g_serverRequestPool = NULL;
+static OICPool *g_serverResponsePool = NULL;
+
+/**
+ * How long a batch request waits for its children in milliseconds, 0 to wait for all of them.
+ */
+static uint32_t g_batchResponseTimeout = 0;
+
+/**
+ * How long a batch request is kept after its partial response for the children which have
+ * not responded yet, in milliseconds. It is deleted afterwards.
+ */
+#define BATCH_LATE_RESPONSE_TIMEOUT_MS (60 * 1000)
+
+/**
+ * Batch requests waiting for their deadline.
+ */
+static OCServerRequest *g_batchRequests = NULL;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
@@ -92,7 +132,9 @@ static OCStackResult AddServerResponse (OCServerResponse ** response, OCRequestH
 
     OCServerResponse * serverResponse = NULL;
 
-    serverResponse = (OCServerResponse *) OICCalloc(1, sizeof(OCServerResponse));
+    serverResponse = (OCServerResponse *) OICPoolCalloc(OICPoolGet(&g_serverResponsePool,
+                                                                   "OCServerResponse",
+                                                                   sizeof(OCServerResponse)));
     VERIFY_NON_NULL(serverResponse);
 
     serverResponse->payload = NULL;
@@ -150,7 +192,7 @@ static void DeleteServerResponse (OCServerResponse * serverResponse)
     if (serverResponse)
     {
         RB_REMOVE(ServerResponseTree, &g_serverResponseTree, serverResponse);
-        OICFree(serverResponse);
+        OICPoolFree(serverResponse);
         serverResponse = NULL;
         OIC_LOG(INFO, TAG, "Server Response Removed!!");
     }
@@ -198,6 +240,8 @@ static CAPayloadFormat_t OCToCAPayloadFormat (OCPayloadFormat ocFormat)
         return CA_FORMAT_APPLICATION_CBOR;
     case OC_FORMAT_VND_OCF_CBOR:
         return CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    case OC_FORMAT_JSON:
+        return CA_FORMAT_APPLICATION_JSON;
     default:
         return CA_FORMAT_UNSUPPORTED;
     }
@@ -274,6 +318,139 @@ static CAResponseResult_t ConvertEHResultToCAResult (OCEntityHandlerResult resul
     return caResult;
 }
 
+/**
+ * Release the memory of a server request.
+ *
+ * @param[in] serverRequest     server request to release.
+ */
+static void FreeServerRequestMemory(OCServerRequest *serverRequest)
+{
+    if (serverRequest->pooled)
+    {
+        OICPoolFree(serverRequest);
+    }
+    else
+    {
+        OICFree(serverRequest);
+    }
+}
+
+/**
+ * Unlink a batch request from the batch requests waiting for their deadline.
+ *
+ * @param[in] request   batch request.
+ */
+static void UnlinkBatchRequest(OCServerRequest *request)
+{
+    for (OCServerRequest **link = &g_batchRequests; *link; link = &(*link)->nextBatch)
+    {
+        if (*link == request)
+        {
+            *link = request->nextBatch;
+            request->nextBatch = NULL;
+            return;
+        }
+    }
+}
+
+/**
+ * Release the children of a batch request.
+ *
+ * @param[in] request   batch request.
+ */
+static void FreeBatchChildren(OCServerRequest *request)
+{
+    UnlinkBatchRequest(request);
+    for (uint8_t i = 0; i < request->numBatchChildren; i++)
+    {
+        OICFree(request->batchChildren[i].uri);
+    }
+    OICFree(request->batchChildren);
+    request->batchChildren = NULL;
+    request->numBatchChildren = 0;
+    request->batchClosed = 0;
+}
+
+/**
+ * Remove the child which has responded from the children of a batch request.
+ *
+ * @param[in]  request      batch request.
+ * @param[in]  resource     resource handle of the response, may be NULL.
+ * @param[in]  uri          URI of the response payload, may be NULL.
+ * @param[out] childUri     URI of the child to be freed by the caller, may be NULL.
+ *
+ * @return true if the child was pending, false if it is unknown or has already responded.
+ */
+static bool RemoveBatchChild(OCServerRequest *request, OCResourceHandle resource,
+                             const char *uri, char **childUri)
+{
+    for (uint8_t i = 0; i < request->numBatchChildren; i++)
+    {
+        OCBatchChild *child = &request->batchChildren[i];
+        if ((resource && (child->resource == resource))
+            || (!resource && uri && child->uri && (0 == strcmp(child->uri, uri))))
+        {
+            *childUri = child->uri;
+            request->batchChildren[i] = request->batchChildren[--request->numBatchChildren];
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Create the entry of a batch response for a child without representation.
+ *
+ * @param[in] uri       URI of the child.
+ * @param[in] status    result of the child.
+ *
+ * @return entry of the batch response, or NULL if out of memory.
+ */
+static OCRepPayload *CreateBatchStatusEntry(const char *uri, OCEntityHandlerResult status)
+{
+    OCRepPayload *entry = OCRepPayloadCreate();
+    OCRepPayload *rep = OCRepPayloadCreate();
+    if (!entry || !rep)
+    {
+        OCRepPayloadDestroy(entry);
+        OCRepPayloadDestroy(rep);
+        return NULL;
+    }
+
+    entry->uri = OICStrdup(uri);
+    if ((uri && !entry->uri)
+        || !OCRepPayloadSetPropObjectAsOwner(entry, OC_RSRVD_REPRESENTATION, rep))
+    {
+        OCRepPayloadDestroy(entry);
+        OCRepPayloadDestroy(rep);
+        return NULL;
+    }
+    if (!OCRepPayloadSetPropInt(entry, OC_RSRVD_BATCH_STATUS, status))
+    {
+        OCRepPayloadDestroy(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+/**
+ * Append an entry to the aggregated payload of a batch response.
+ *
+ * @param[in] serverResponse    aggregated response.
+ * @param[in] entry             entry to append, owned by the aggregated payload afterwards.
+ */
+static void AppendBatchEntry(OCServerResponse *serverResponse, OCRepPayload *entry)
+{
+    if (!serverResponse->payload)
+    {
+        serverResponse->payload = (OCPayload *)entry;
+    }
+    else
+    {
+        OCRepPayloadAppend((OCRepPayload *)serverResponse->payload, entry);
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 // Internal APIs
 //-------------------------------------------------------------------------------------------------
@@ -304,15 +481,26 @@ OCStackResult AddServerRequest (OCServerRequest ** request,
 
     OIC_LOG_V(INFO, TAG, "AddServerRequest entry [%s:%u]", devAddr->addr, devAddr->port);
 
-    OCServerRequest * serverRequest = (OCServerRequest *) OICCalloc(1, sizeof(OCServerRequest) +
-                                                            (payloadSize ? payloadSize : 1) - 1);
-    VERIFY_NON_NULL(serverRequest);
+    OCServerRequest * serverRequest = NULL;
+    if (payloadSize <= POOLED_REQUEST_PAYLOAD_SIZE)
+    {
+        serverRequest = (OCServerRequest *) OICPoolCalloc(OICPoolGet(&g_serverRequestPool,
+                            "OCServerRequest",
+                            sizeof(OCServerRequest) + POOLED_REQUEST_PAYLOAD_SIZE - 1));
+        VERIFY_NON_NULL(serverRequest);
+        serverRequest->pooled = 1;
+    }
+    else
+    {
+        serverRequest = (OCServerRequest *) OICCalloc(1, sizeof(OCServerRequest) +
+                                                      payloadSize - 1);
+        VERIFY_NON_NULL(serverRequest);
+    }
 
     serverRequest->coapID = coapMessageID;
     serverRequest->delayedResNeeded = delayedResNeeded;
     serverRequest->notificationFlag = notificationFlag;
     serverRequest->method = method;
-    serverRequest->numRcvdVendorSpecificHeaderOptions = numRcvdVendorSpecificHeaderOptions;
     serverRequest->observationOption = observationOption;
     serverRequest->observeResult = OC_STACK_ERROR;
     serverRequest->qos = qos;
@@ -327,8 +515,22 @@ OCStackResult AddServerRequest (OCServerRequest ** request,
     }
     if (rcvdVendorSpecificHeaderOptions)
     {
-        memcpy(serverRequest->rcvdVendorSpecificHeaderOptions, rcvdVendorSpecificHeaderOptions,
-            MAX_HEADER_OPTIONS * sizeof(OCHeaderOption));
+        // The cache options are handled by the stack, the entity handlers do not see them.
+        for (uint8_t i = 0; (i < numRcvdVendorSpecificHeaderOptions) && (i < MAX_HEADER_OPTIONS);
+             i++)
+        {
+            const OCHeaderOption *option = &rcvdVendorSpecificHeaderOptions[i];
+            if (!OCIsCacheHeaderOption(option->optionID))
+            {
+                serverRequest->rcvdVendorSpecificHeaderOptions[
+                    serverRequest->numRcvdVendorSpecificHeaderOptions++] = *option;
+            }
+            else if ((COAP_OPTION_ETAG == option->optionID)
+                     && (serverRequest->numETagOptions < OC_MAX_REQUEST_ETAGS))
+            {
+                serverRequest->etagOptions[serverRequest->numETagOptions++] = *option;
+            }
+        }
     }
     if (payload && payloadSize)
     {
@@ -364,13 +566,14 @@ OCStackResult AddServerRequest (OCServerRequest ** request,
     *request = serverRequest;
 
     RBL_INSERT(ServerRequestTree, &g_serverRequestTree, serverRequest);
+    RB_INSERT(ServerRequestHandleTree, &g_serverRequestHandleTree, serverRequest);
     OIC_LOG(INFO, TAG, "Server Request Added");
     return OC_STACK_OK;
 
 exit:
     if (serverRequest)
     {
-        OICFree(serverRequest);
+        FreeServerRequestMemory(serverRequest);
         serverRequest = NULL;
     }
     *request = NULL;
@@ -404,18 +607,31 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
     return out;
 }
 
+OCServerRequest * GetServerRequestUsingHandle (OCRequestHandle handle)
+{
+    if (!handle)
+    {
+        return NULL;
+    }
+    return RB_FIND(ServerRequestHandleTree, &g_serverRequestHandleTree,
+                   (OCServerRequest *)handle);
+}
+
 void DeleteServerRequest(OCServerRequest * serverRequest)
 {
     if (serverRequest)
     {
-        if (!RBL_FIND(ServerRequestTree, &g_serverRequestTree, serverRequest))
+        if (!GetServerRequestUsingHandle((OCRequestHandle)serverRequest))
         {
             return;
         }
 
         RBL_REMOVE(ServerRequestTree, &g_serverRequestTree, serverRequest);
+        RB_REMOVE(ServerRequestHandleTree, &g_serverRequestHandleTree, serverRequest);
+        FreeBatchChildren(serverRequest);
+        CAReleaseBlockStream(serverRequest->blockStream);
         OICFree(serverRequest->requestToken);
-        OICFree(serverRequest);
+        FreeServerRequestMemory(serverRequest);
         serverRequest = NULL;
         OIC_LOG(INFO, TAG, "Server Request Removed");
     }
@@ -471,14 +687,71 @@ OCStackResult FormOCEntityHandlerRequest(OCEntityHandlerRequest * entityHandlerR
 }
 
 /**
- * Handler function for sending a response from a single resource
+ * Keep the representation of a response in the cache of its resource, and add the ETag
+ * and Max-Age options to the response. The response becomes 2.03 Valid without payload if
+ * the request presents the ETag of the representation.
+ *
+ * @param[in]     serverRequest     GET request of a resource which caches its representations.
+ * @param[in,out] responseInfo      response holding the encoded representation.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult CacheServerResponse(OCServerRequest *serverRequest,
+                                         CAResponseInfo_t *responseInfo)
+{
+    OCResource *resource = FindResourceByUri(serverRequest->resourceUrl);
+    if (!resource || !resource->cache)
+    {
+        // The caching was disabled while the entity handler was running.
+        return OC_STACK_OK;
+    }
+
+    const OCCachedRepresentation *representation = NULL;
+    if (OC_STACK_OK != OCCacheRepresentation(resource->cache, serverRequest->query,
+                                             serverRequest->acceptFormat,
+                                             serverRequest->acceptVersion,
+                                             &responseInfo->info, &representation))
+    {
+        OIC_LOG(ERROR, TAG, "Representation not cached");
+        return OC_STACK_OK;
+    }
+
+    CAHeaderOption_t *options = (CAHeaderOption_t *) OICRealloc(responseInfo->info.options,
+            (responseInfo->info.numOptions + 2) * sizeof(CAHeaderOption_t));
+    if (!options)
+    {
+        OIC_LOG(FATAL, TAG, "Memory alloc for options failed");
+        return OC_STACK_NO_MEMORY;
+    }
+    OCSetCacheOptions(&options[responseInfo->info.numOptions], representation->etag,
+                      resource->cache->maxAge);
+    responseInfo->info.options = options;
+    responseInfo->info.numOptions += 2;
+
+    if (OCHasETagOption(serverRequest->etagOptions, serverRequest->numETagOptions,
+                        representation->etag))
+    {
+        // The client has the current representation.
+        OCCountServerCacheValidation();
+        responseInfo->result = CA_VALID;
+        OICFree(responseInfo->info.payload);
+        responseInfo->info.payload = NULL;
+        responseInfo->info.payloadSize = 0;
+        responseInfo->info.payloadFormat = CA_FORMAT_UNDEFINED;
+    }
+    return OC_STACK_OK;
+}
+
+/**
+ * Send a response for a server request
  *
  * @param ehResponse - pointer to the response from the resource
+ * @param deleteRequest - whether the request is deleted once the response is sent
  *
  * @return
  *     OCStackResult
  */
-OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+static OCStackResult SendServerResponse(OCEntityHandlerResponse * ehResponse, bool deleteRequest)
 {
     OCStackResult result = OC_STACK_ERROR;
     CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
@@ -769,6 +1042,41 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
             default:
                 responseInfo.result = CA_NOT_ACCEPTABLE;
         }
+
+        // A response carrying its own ETag is not cached.
+        bool hasETag = false;
+        for (uint8_t i = 0; i < ehResponse->numSendVendorSpecificHeaderOptions; i++)
+        {
+            if (COAP_OPTION_ETAG == ehResponse->sendVendorSpecificHeaderOptions[i].optionID)
+            {
+                hasETag = true;
+            }
+        }
+        if (serverRequest->cacheable && !hasETag && (CA_CONTENT == responseInfo.result)
+            && responseInfo.info.payload)
+        {
+            result = CacheServerResponse(serverRequest, &responseInfo);
+            if (OC_STACK_OK != result)
+            {
+                OICFree(responseInfo.info.payload);
+                OICFree(responseInfo.info.options);
+                return result;
+            }
+        }
+    }
+    else if (serverRequest->blockStream)
+    {
+        // The payload is produced block by block while the response is being sent.
+        responseInfo.info.blockStream = serverRequest->blockStream;
+        responseInfo.info.payloadFormat = OCToCAPayloadFormat(serverRequest->blockStreamFormat);
+        if (CA_FORMAT_APPLICATION_VND_OCF_CBOR == responseInfo.info.payloadFormat)
+        {
+            responseInfo.info.payloadVersion = serverRequest->acceptVersion;
+            if (!responseInfo.info.payloadVersion)
+            {
+                responseInfo.info.payloadVersion = DEFAULT_VERSION_VALUE;
+            }
+        }
     }
 
 #ifdef WITH_PRESENCE
@@ -833,13 +1141,82 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     OICFree(responseInfo.info.payload);
     OICFree(responseInfo.info.options);
     //Delete the request
-    DeleteServerRequest(serverRequest);
+    if (deleteRequest)
+    {
+        DeleteServerRequest(serverRequest);
+    }
+    return result;
+}
+
+/**
+ * Handler function for sending a response from a single resource
+ *
+ * @param ehResponse - pointer to the response from the resource
+ *
+ * @return
+ *     OCStackResult
+ */
+OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+{
+    return SendServerResponse(ehResponse, true);
+}
+
+OCStackResult SendCachedResponse(OCServerRequest *request,
+                                 const OCCachedRepresentation *representation,
+                                 uint32_t maxAge)
+{
+    if (!request || !representation)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
+    CopyDevAddrToEndpoint(&request->devAddr, &responseEndpoint);
+
+    CAResponseInfo_t responseInfo = {.result = CA_CONTENT};
+    responseInfo.info.messageId = request->coapID;
+    responseInfo.info.resourceUri = request->resourceUrl;
+    responseInfo.info.dataType = CA_RESPONSE_DATA;
+    responseInfo.info.type = (OC_HIGH_QOS == request->qos) ? CA_MSG_ACKNOWLEDGE
+                                                           : CA_MSG_NONCONFIRM;
+    responseInfo.info.token = request->requestToken;
+    responseInfo.info.tokenLength = request->tokenLength;
+
+    // The routing layer may add its option to the array.
+    responseInfo.info.options = (CAHeaderOption_t *) OICCalloc(2, sizeof(CAHeaderOption_t));
+    if (!responseInfo.info.options)
+    {
+        OIC_LOG(FATAL, TAG, "Memory alloc for options failed");
+        DeleteServerRequest(request);
+        return OC_STACK_NO_MEMORY;
+    }
+    OCSetCacheOptions(responseInfo.info.options, representation->etag, maxAge);
+    responseInfo.info.numOptions = 2;
+
+    if (OCHasETagOption(request->etagOptions, request->numETagOptions, representation->etag))
+    {
+        OIC_LOG_V(INFO, TAG, "Cached representation of %s validated", request->resourceUrl);
+        OCCountServerCacheValidation();
+        responseInfo.result = CA_VALID;
+    }
+    else
+    {
+        OIC_LOG_V(INFO, TAG, "Cached representation of %s sent", request->resourceUrl);
+        responseInfo.info.payload = representation->payload;
+        responseInfo.info.payloadSize = representation->payloadSize;
+        responseInfo.info.payloadFormat = representation->payloadFormat;
+        responseInfo.info.payloadVersion = representation->payloadVersion;
+    }
+
+    OCStackResult result = OCSendResponse(&responseEndpoint, &responseInfo);
+    OICFree(responseInfo.info.options);
+    DeleteServerRequest(request);
     return result;
 }
 
 OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
 {
-    if(!ehResponse || !ehResponse->payload)
+    if(!ehResponse || !ehResponse->requestHandle)
     {
         OIC_LOG(ERROR, TAG, "HandleAggregateResponse invalid parameters");
         return OC_STACK_INVALID_PARAM;
@@ -848,62 +1225,257 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
     OIC_LOG(INFO, TAG, "Inside HandleAggregateResponse");
 
     OCServerRequest *serverRequest = (OCServerRequest *)ehResponse->requestHandle;
+    if(ehResponse->payload && ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
+    {
+        OIC_LOG(ERROR, TAG, "Error adding payload, as it was the incorrect type");
+        return OC_STACK_ERROR;
+    }
+
+    const char *uri = ehResponse->payload ? ((OCRepPayload *)ehResponse->payload)->uri : NULL;
+    char *childUri = NULL;
+    if (serverRequest->batchChildren
+        && !RemoveBatchChild(serverRequest, ehResponse->resourceHandle, uri, &childUri))
+    {
+        // Each child is counted once, a duplicate must not complete the batch early.
+        OIC_LOG(ERROR, TAG, "Discarding a response fragment of no pending child");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    if (serverRequest->batchClosed)
+    {
+        // The partial response was sent at the deadline, the request is only kept
+        // until its remaining children have responded.
+        OIC_LOG(INFO, TAG, "Discarding a response fragment received after the deadline");
+        OICFree(childUri);
+        if (0 == --serverRequest->numResponses)
+        {
+            DeleteServerRequest(serverRequest);
+        }
+        return OC_STACK_OK;
+    }
+
+    // With a deadline, a child may report an error without representation.
+    if(!ehResponse->payload && !serverRequest->batchChildren)
+    {
+        OIC_LOG(ERROR, TAG, "HandleAggregateResponse invalid parameters");
+        OICFree(childUri);
+        return OC_STACK_INVALID_PARAM;
+    }
+
     OCServerResponse *serverResponse = GetServerResponseUsingHandle((OCServerRequest *)
                                                                     ehResponse->requestHandle);
 
     OCStackResult stackRet = OC_STACK_ERROR;
-    if(serverRequest)
+    if(!serverResponse)
     {
-        if(!serverResponse)
+        OIC_LOG(INFO, TAG, "This is the first response fragment");
+        stackRet = AddServerResponse(&serverResponse, ehResponse->requestHandle);
+        if (OC_STACK_OK != stackRet)
         {
-            OIC_LOG(INFO, TAG, "This is the first response fragment");
-            stackRet = AddServerResponse(&serverResponse, ehResponse->requestHandle);
-            if (OC_STACK_OK != stackRet)
+            OIC_LOG(ERROR, TAG, "Error adding server response");
+            OICFree(childUri);
+            return stackRet;
+        }
+        VERIFY_NON_NULL(serverResponse);
+    }
+
+    OCRepPayload *newPayload = NULL;
+    if (serverRequest->batchChildren)
+    {
+        if (ehResponse->payload)
+        {
+            newPayload = OCRepPayloadBatchClone((OCRepPayload *)ehResponse->payload);
+            if (newPayload
+                && !OCRepPayloadSetPropInt(newPayload, OC_RSRVD_BATCH_STATUS,
+                                           ehResponse->ehResult))
             {
-                OIC_LOG(ERROR, TAG, "Error adding server response");
-                return stackRet;
+                OCRepPayloadDestroy(newPayload);
+                newPayload = NULL;
             }
-            VERIFY_NON_NULL(serverResponse);
         }
-
-        if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
+        else
         {
-            stackRet = OC_STACK_ERROR;
-            OIC_LOG(ERROR, TAG, "Error adding payload, as it was the incorrect type");
+            newPayload = CreateBatchStatusEntry(childUri ? childUri : ehResponse->resourceUri,
+                                                ehResponse->ehResult);
+        }
+        if (!newPayload)
+        {
+            stackRet = OC_STACK_NO_MEMORY;
             goto exit;
         }
+    }
+    else
+    {
+        newPayload = OCRepPayloadBatchClone((OCRepPayload *)ehResponse->payload);
+    }
 
-        OCRepPayload *newPayload = OCRepPayloadBatchClone((OCRepPayload *)ehResponse->payload);
+    AppendBatchEntry(serverResponse, newPayload);
 
-        if(!serverResponse->payload)
-        {
-            serverResponse->payload = (OCPayload *)newPayload;
-        }
-        else
+    (serverRequest->numResponses)--;
+
+    if(serverRequest->numResponses == 0)
+    {
+        OIC_LOG(INFO, TAG, "This is the last response fragment");
+        // The payload of the last fragment is given back to the caller
+        OCPayload *fragment = ehResponse->payload;
+        ehResponse->payload = serverResponse->payload;
+        ehResponse->ehResult = OC_EH_OK;
+        // Sending the response deletes the request
+        stackRet = HandleSingleResponse(ehResponse);
+        OCPayloadDestroy(serverResponse->payload);
+        DeleteServerResponse(serverResponse);
+        ehResponse->payload = fragment;
+    }
+    else
+    {
+        OIC_LOG(INFO, TAG, "More response fragments to come");
+        stackRet = OC_STACK_OK;
+    }
+exit:
+    OICFree(childUri);
+    return stackRet;
+}
+
+void SetBatchResponseTimeout(uint32_t timeoutMs)
+{
+    g_batchResponseTimeout = timeoutMs;
+}
+
+OCStackResult StartBatchRequest(OCServerRequest *request, uint8_t numChildren)
+{
+    if (!request)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    // A repeated request starts over.
+    FreeBatchChildren(request);
+    request->numResponses = numChildren;
+    if (0 == g_batchResponseTimeout || 0 == numChildren)
+    {
+        return OC_STACK_OK;
+    }
+
+    request->batchChildren = (OCBatchChild *)OICCalloc(numChildren, sizeof(OCBatchChild));
+    if (!request->batchChildren)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory, waiting for all the children");
+        return OC_STACK_OK;
+    }
+    request->batchDeadline = OICGetCurrentTime(TIME_IN_MS) + g_batchResponseTimeout;
+    request->nextBatch = g_batchRequests;
+    g_batchRequests = request;
+    OCScheduleStackTimer(OC_STACK_TIMER_BATCH, request->batchDeadline);
+    return OC_STACK_OK;
+}
+
+OCStackResult AddBatchChild(OCServerRequest *request, OCResourceHandle resource,
+                            const char *uri)
+{
+    if (!request || !resource)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+    if (!request->batchChildren)
+    {
+        return OC_STACK_OK;
+    }
+    if (request->numBatchChildren >= request->numResponses)
+    {
+        OIC_LOG(ERROR, TAG, "More children than expected");
+        return OC_STACK_ERROR;
+    }
+
+    OCBatchChild *child = &request->batchChildren[request->numBatchChildren];
+    child->resource = resource;
+    child->uri = OICStrdup(uri);
+    if (uri && !child->uri)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    request->numBatchChildren++;
+    return OC_STACK_OK;
+}
+
+/**
+ * Send the partial response of a batch request whose deadline has passed.
+ *
+ * @param[in] request   batch request.
+ *
+ * @return true if the request is kept for its late children until its new deadline.
+ */
+static bool SendPartialBatchResponse(OCServerRequest *request)
+{
+    OIC_LOG_V(INFO, TAG, "Batch deadline passed, %u children did not respond",
+              request->numBatchChildren);
+
+    OCServerResponse *serverResponse = GetServerResponseUsingHandle(request);
+    if (!serverResponse && (OC_STACK_OK != AddServerResponse(&serverResponse, request)))
+    {
+        OIC_LOG(ERROR, TAG, "Error adding server response");
+        UnlinkBatchRequest(request);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < request->numBatchChildren; i++)
+    {
+        OCRepPayload *entry = CreateBatchStatusEntry(request->batchChildren[i].uri,
+                                                     OC_EH_RETRANSMIT_TIMEOUT);
+        if (entry)
         {
-            OCRepPayloadAppend((OCRepPayload*)serverResponse->payload,
-                    (OCRepPayload*)newPayload);
+            AppendBatchEntry(serverResponse, entry);
         }
+    }
 
-        (serverRequest->numResponses)--;
+    OCEntityHandlerResponse ehResponse = { .requestHandle = request };
+    ehResponse.ehResult = OC_EH_OK;
+    ehResponse.payload = serverResponse->payload;
+    if (OC_STACK_OK != SendServerResponse(&ehResponse, false))
+    {
+        OIC_LOG(ERROR, TAG, "Error sending the partial batch response");
+    }
+    OCPayloadDestroy(serverResponse->payload);
+    DeleteServerResponse(serverResponse);
 
-        if(serverRequest->numResponses == 0)
+    // Keep the request for the children which may still respond, but not forever.
+    request->batchClosed = 1;
+    request->numResponses = request->numBatchChildren;
+    if (0 == request->numResponses)
+    {
+        DeleteServerRequest(request);
+        return false;
+    }
+    request->batchDeadline = OICGetCurrentTime(TIME_IN_MS) + BATCH_LATE_RESPONSE_TIMEOUT_MS;
+    return true;
+}
+
+void CheckTimedOutBatchRequests(void)
+{
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    uint64_t earliest = OC_STACK_TIMER_NEVER;
+
+    OCServerRequest *request = g_batchRequests;
+    while (request)
+    {
+        OCServerRequest *next = request->nextBatch;
+        if (request->batchDeadline <= now && request->batchClosed)
         {
-            OIC_LOG(INFO, TAG, "This is the last response fragment");
-            ehResponse->payload = serverResponse->payload;
-            ehResponse->ehResult = OC_EH_OK;
-            stackRet = HandleSingleResponse(ehResponse);
-            //Delete the request and response
-            DeleteServerRequest(serverRequest);
-            DeleteServerResponse(serverResponse);
+            OIC_LOG_V(WARNING, TAG, "Deleting a batch request, %u children never responded",
+                      request->numBatchChildren);
+            DeleteServerRequest(request);
         }
-        else
+        else if (request->batchDeadline <= now)
         {
-            OIC_LOG(INFO, TAG, "More response fragments to come");
-            stackRet = OC_STACK_OK;
+            if (SendPartialBatchResponse(request) && request->batchDeadline < earliest)
+            {
+                earliest = request->batchDeadline;
+            }
         }
+        else if (request->batchDeadline < earliest)
+        {
+            earliest = request->batchDeadline;
+        }
+        request = next;
     }
-exit:
-
-    return stackRet;
+    OCSetStackTimer(OC_STACK_TIMER_BATCH, earliest);
 }
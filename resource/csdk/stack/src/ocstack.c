@@ -52,6 +52,7 @@
 #include "ocobserve.h"
 #include "experimental/ocrandom.h"
 #include "oic_malloc.h"
+#include "oic_arena.h"
 #include "oic_string.h"
 #include "experimental/logger.h"
 #include "trace.h"
@@ -73,6 +74,9 @@
 #include "platform_features.h"
 #include "oic_platform.h"
 #include "caping.h"
+#include "ocstacktimer.h"
+#include "ocresponsecache.h"
+#include "oic_time.h"
 
 #ifdef UWP_APP
 #include "ocsqlite3helper.h"
@@ -193,6 +197,13 @@ bool g_multicastServerStopped = false;
 
 #define MILLISECONDS_PER_SECOND   (1000)
 
+#ifdef ROUTING_GATEWAY
+/**
+ * Longest time OCGetNextTimeout() lets the application wait before RMProcess() runs again.
+ */
+#define ROUTING_PROCESS_INTERVAL_MS   (1000)
+#endif
+
 //-----------------------------------------------------------------------------
 // Private internal function prototypes
 //-----------------------------------------------------------------------------
@@ -993,6 +1004,11 @@ static OCStackResult ResetPresenceTTL(ClientCB *cbNode, uint32_t maxAgeSeconds)
     }
 
     cbNode->presence->TTLlevel = 0;
+    if (PresenceTimeOutSize)
+    {
+        OCScheduleStackTimer(OC_STACK_TIMER_PRESENCE,
+                             OCTicksToStackTimerDeadline(cbNode->presence->timeOut[0]));
+    }
 
     OIC_LOG_V(DEBUG, TAG, "this TTL level %d", cbNode->presence->TTLlevel);
     return OC_STACK_OK;
@@ -1410,10 +1426,10 @@ OCStackResult HandleBatchResponse(char *requestUri, OCRepPayload **payload)
             }
         }
 
-        OICFree(interfaceName);
-        OICFree(rtTypeName);
-        OICFree(uriQuery);
-        OICFree(uriWithoutQuery);
+        OICRequestFree(interfaceName);
+        OICRequestFree(rtTypeName);
+        OICRequestFree(uriQuery);
+        OICRequestFree(uriWithoutQuery);
         return OC_STACK_OK;
     }
     return OC_STACK_INVALID_PARAM;
@@ -1699,6 +1715,15 @@ void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo
             OIC_LOG(INFO, TAG, "This is a regular response, A client call back is found");
             OIC_LOG(INFO, TAG, "Calling into application address space");
 
+            // The response to a GET is kept by the client cache, or completed with the
+            // representation it has kept if it is 2.03 Valid.
+            CAResponseInfo_t validatedInfo;
+            if (OC_REST_GET == cbNode->method)
+            {
+                responseInfo = OCHandleClientCacheResponse(cbNode->devAddr, cbNode->requestUri,
+                                                           responseInfo, &validatedInfo);
+            }
+
             OCClientResponse *response = NULL;
             OCPayloadType type = PAYLOAD_TYPE_INVALID;
 
@@ -1877,25 +1902,26 @@ void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo
                             (observationOption << 8) | optionData[i];
                     }
                     response->sequenceNumber = observationOption;
-                    response->numRcvdVendorSpecificHeaderOptions = responseInfo->info.numOptions - 1;
                     start = 1;
                 }
-                else
-                {
-                    response->numRcvdVendorSpecificHeaderOptions = responseInfo->info.numOptions;
-                }
-
-                if(response->numRcvdVendorSpecificHeaderOptions > MAX_HEADER_OPTIONS)
-                {
-                    OIC_LOG(ERROR, TAG, "#header options are more than MAX_HEADER_OPTIONS");
-                    OCPayloadDestroy(response->payload);
-                    OICFree(response);
-                    return;
-                }
 
                 for (uint8_t i = start; i < responseInfo->info.numOptions; i++)
                 {
-                    memcpy (&(response->rcvdVendorSpecificHeaderOptions[i - start]),
+                    // The cache options are handled by the stack, the applications do not
+                    // see them.
+                    if (OCIsCacheHeaderOption(responseInfo->info.options[i].optionID))
+                    {
+                        continue;
+                    }
+                    if (response->numRcvdVendorSpecificHeaderOptions >= MAX_HEADER_OPTIONS)
+                    {
+                        OIC_LOG(ERROR, TAG, "#header options are more than MAX_HEADER_OPTIONS");
+                        OCPayloadDestroy(response->payload);
+                        OICFree(response);
+                        return;
+                    }
+                    memcpy (&(response->rcvdVendorSpecificHeaderOptions[
+                                response->numRcvdVendorSpecificHeaderOptions++]),
                             &(responseInfo->info.options[i]), sizeof(OCHeaderOption));
                 }
             }
@@ -2365,13 +2391,13 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     if (strlen(uriWithoutQuery) < MAX_URI_LENGTH)
     {
         OICStrcpy(serverRequest.resourceUrl, sizeof(serverRequest.resourceUrl), uriWithoutQuery);
-        OICFree(uriWithoutQuery);
+        OICRequestFree(uriWithoutQuery);
     }
     else
     {
         OIC_LOG(ERROR, TAG, "URI length exceeds MAX_URI_LENGTH.");
-        OICFree(uriWithoutQuery);
-        OICFree(query);
+        OICRequestFree(uriWithoutQuery);
+        OICRequestFree(query);
         return;
     }
 
@@ -2380,12 +2406,12 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
         if (strlen(query) < MAX_QUERY_LENGTH)
         {
             OICStrcpy(serverRequest.query, sizeof(serverRequest.query), query);
-            OICFree(query);
+            OICRequestFree(query);
         }
         else
         {
             OIC_LOG(ERROR, TAG, "Query length exceeds MAX_QUERY_LENGTH.");
-            OICFree(query);
+            OICRequestFree(query);
             return;
         }
     }
@@ -2394,7 +2420,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     {
         serverRequest.payloadFormat = CAToOCPayloadFormat(requestInfo->info.payloadFormat);
         serverRequest.reqTotalSize = requestInfo->info.payloadSize;
-        serverRequest.payload = (uint8_t *) OICMalloc(requestInfo->info.payloadSize);
+        serverRequest.payload = (uint8_t *) OICRequestAlloc(requestInfo->info.payloadSize);
         if (!serverRequest.payload)
         {
             OIC_LOG(ERROR, TAG, "Allocation for payload failed.");
@@ -2429,7 +2455,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                                     requestInfo->info.options, requestInfo->info.token,
                                     requestInfo->info.tokenLength, requestInfo->info.resourceUri,
                                     CA_RESPONSE_DATA);
-            OICFree(serverRequest.payload);
+            OICRequestFree(serverRequest.payload);
             return;
     }
 
@@ -2440,7 +2466,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     if (serverRequest.tokenLength)
     {
         // Non empty token
-        serverRequest.requestToken = (CAToken_t)OICMalloc(requestInfo->info.tokenLength);
+        serverRequest.requestToken = (CAToken_t)OICRequestAlloc(requestInfo->info.tokenLength);
 
         if (!serverRequest.requestToken)
         {
@@ -2450,7 +2476,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                                     requestInfo->info.options, requestInfo->info.token,
                                     requestInfo->info.tokenLength, requestInfo->info.resourceUri,
                                     CA_RESPONSE_DATA);
-            OICFree(serverRequest.payload);
+            OICRequestFree(serverRequest.payload);
             return;
         }
         memcpy(serverRequest.requestToken, requestInfo->info.token, requestInfo->info.tokenLength);
@@ -2496,8 +2522,8 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                                 requestInfo->info.options, requestInfo->info.token,
                                 requestInfo->info.tokenLength, requestInfo->info.resourceUri,
                                 CA_RESPONSE_DATA);
-        OICFree(serverRequest.payload);
-        OICFree(serverRequest.requestToken);
+        OICRequestFree(serverRequest.payload);
+        OICRequestFree(serverRequest.requestToken);
         return;
     }
     serverRequest.numRcvdVendorSpecificHeaderOptions = tempNum;
@@ -2538,8 +2564,9 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     }
     // requestToken is fed to HandleStackRequests, which then goes to AddServerRequest.
     // The token is copied in there, and is thus still owned by this function.
-    OICFree(serverRequest.payload);
-    OICFree(serverRequest.requestToken);
+    // Both copies come from the request arena when called from HandleCARequests.
+    OICRequestFree(serverRequest.payload);
+    OICRequestFree(serverRequest.requestToken);
     OIC_LOG(INFO, TAG, "Exit OCHandleRequests");
 }
 
@@ -2610,8 +2637,11 @@ void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
 #endif
 #endif
     {
-        // Normal handling of the packet
+        // Normal handling of the packet. The transient allocations made while handling
+        // the request come from the request arena of this thread, reset at once at the end.
+        OICRequestArenaBegin();
         OCHandleRequests(endPoint, requestInfo);
+        OICRequestArenaEnd();
     }
     OIC_LOG(INFO, TAG, "Exit HandleCARequests");
     OIC_TRACE_END();
@@ -2903,8 +2933,15 @@ OCStackResult OCDeInitializeInternal(void)
     deleteAllResources();
     // Remove all the client callbacks
     DeleteClientCBList();
+    OCTerminateClientCache();
+    // The wakeup handler of the application must not outlive the stack.
+    CARegisterReceivedDataHandler(NULL, NULL);
     // Terminate connectivity-abstraction layer.
     CATerminate();
+    // Nothing is left to time out.
+    OCResetStackTimers();
+    // Requests are usually handled by the thread which stops the stack.
+    OICRequestArenaRelease();
 
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
     // Terminate the Connection Manager
@@ -3240,6 +3277,90 @@ static void assertRolesCB(void* ctx, bool hasError)
 }
 #endif // __WITH_DTLS__ || __WITH_TLS__
 
+/**
+ * Adapts a block producer or consumer given through the public API to the CA block
+ * stream callbacks. Exactly one of producer and consumer is set; deleter, when given,
+ * releases context once CA has finished with the stream.
+ */
+typedef struct
+{
+    OCBlockProducer producer;
+    OCBlockConsumer consumer;
+    void *context;
+    OCBlockContextDeleter deleter;
+} OCBlockStreamContext;
+
+static CAResult_t OCProduceBlock(void *context, size_t offset, uint8_t *buffer, size_t size)
+{
+    OCBlockStreamContext *streamContext = (OCBlockStreamContext *) context;
+    return (OC_STACK_OK == streamContext->producer(streamContext->context, offset, buffer, size))
+            ? CA_STATUS_OK : CA_STATUS_FAILED;
+}
+
+static CAResult_t OCConsumeBlock(void *context, size_t offset, const uint8_t *data, size_t size)
+{
+    OCBlockStreamContext *streamContext = (OCBlockStreamContext *) context;
+    return (OC_STACK_OK == streamContext->consumer(streamContext->context, offset, data, size))
+            ? CA_STATUS_OK : CA_STATUS_FAILED;
+}
+
+static void OCDeleteBlockStreamContext(void *context)
+{
+    OCBlockStreamContext *streamContext = (OCBlockStreamContext *) context;
+    if (streamContext->deleter)
+    {
+        streamContext->deleter(streamContext->context);
+    }
+    OICFree(streamContext);
+}
+
+/**
+ * Create a CA block stream for a producer or a consumer given through the public API.
+ * The deleter of the application context is called on failure.
+ */
+static CABlockStream_t *OCCreateBlockStream(OCBlockProducer producer, size_t totalLength,
+                                            OCBlockConsumer consumer, void *context,
+                                            OCBlockContextDeleter deleter)
+{
+    OCBlockStreamContext *streamContext =
+        (OCBlockStreamContext *) OICCalloc(1, sizeof(OCBlockStreamContext));
+    if (!streamContext)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate block stream context");
+        if (deleter)
+        {
+            deleter(context);
+        }
+        return NULL;
+    }
+    streamContext->producer = producer;
+    streamContext->consumer = consumer;
+    streamContext->context = context;
+    streamContext->deleter = deleter;
+
+    CABlockStream_t *stream = producer ?
+        CACreateBlockProducer(totalLength, OCProduceBlock, streamContext,
+                              OCDeleteBlockStreamContext) :
+        CACreateBlockConsumer(OCConsumeBlock, streamContext, OCDeleteBlockStreamContext);
+    if (!stream)
+    {
+        OCDeleteBlockStreamContext(streamContext);
+    }
+    return stream;
+}
+
+static OCStackResult OCDoRequestInternal(OCDoHandle *handle,
+                                         OCMethod method,
+                                         const char *requestUri,
+                                         const OCDevAddr *destination,
+                                         OCPayload* payload,
+                                         OCConnectivityType connectivityType,
+                                         OCQualityOfService qos,
+                                         OCCallbackData *cbData,
+                                         OCHeaderOption *options,
+                                         uint8_t numOptions,
+                                         CABlockStream_t *blockStream);
+
 /**
  * Discover or Perform requests on a specified resource
  */
@@ -3253,6 +3374,62 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
                                   OCCallbackData *cbData,
                                   OCHeaderOption *options,
                                   uint8_t numOptions)
+{
+    return OCDoRequestInternal(handle, method, requestUri, destination, payload,
+                               connectivityType, qos, cbData, options, numOptions, NULL);
+}
+
+OCStackResult OC_CALL OCDoStreamingRequest(OCDoHandle *handle,
+                                           OCMethod method,
+                                           const char *requestUri,
+                                           const OCDevAddr *destination,
+                                           OCPayload* payload,
+                                           OCConnectivityType connectivityType,
+                                           OCQualityOfService qos,
+                                           OCCallbackData *cbData,
+                                           OCHeaderOption *options,
+                                           uint8_t numOptions,
+                                           OCBlockConsumer consumer,
+                                           void *consumerContext,
+                                           OCBlockContextDeleter deleter)
+{
+    if (!consumer)
+    {
+        OIC_LOG(ERROR, TAG, "consumer is NULL");
+        if (deleter)
+        {
+            deleter(consumerContext);
+        }
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    CABlockStream_t *blockStream = OCCreateBlockStream(NULL, 0, consumer, consumerContext,
+                                                       deleter);
+    if (!blockStream)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OCStackResult result = OCDoRequestInternal(handle, method, requestUri, destination, payload,
+                                               connectivityType, qos, cbData, options,
+                                               numOptions, blockStream);
+
+    // The pending blockwise transfer holds its own reference.
+    CAReleaseBlockStream(blockStream);
+    return result;
+}
+
+static OCStackResult OCDoRequestInternal(OCDoHandle *handle,
+                                         OCMethod method,
+                                         const char *requestUri,
+                                         const OCDevAddr *destination,
+                                         OCPayload* payload,
+                                         OCConnectivityType connectivityType,
+                                         OCQualityOfService qos,
+                                         OCCallbackData *cbData,
+                                         OCHeaderOption *options,
+                                         uint8_t numOptions,
+                                         CABlockStream_t *blockStream)
 {
     OIC_LOG(INFO, TAG, "Entering OCDoResource");
 
@@ -3503,6 +3680,30 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
 
     CopyDevAddrToEndpoint(devAddr, &endpoint);
 
+    // A fresh response kept by the client cache answers the request, a stale one is
+    // revalidated with its ETag.
+    bool fromCache = false;
+    if ((OC_REST_GET == method) && !payload && !blockStream)
+    {
+        CAHeaderOption_t etagOption;
+        OCClientCacheState cacheState = OCLookupClientCache(devAddr, resourceUri, &etagOption);
+        if (OC_CLIENT_CACHE_FRESH == cacheState)
+        {
+            fromCache = true;
+        }
+        else if (OC_CLIENT_CACHE_STALE == cacheState)
+        {
+            CAHeaderOption_t *cacheOptions = (CAHeaderOption_t *) OICRealloc(
+                    requestInfo.info.options,
+                    (requestInfo.info.numOptions + 1) * sizeof(CAHeaderOption_t));
+            if (cacheOptions)
+            {
+                cacheOptions[requestInfo.info.numOptions++] = etagOption;
+                requestInfo.info.options = cacheOptions;
+            }
+        }
+    }
+
     if (payload)
     {
         uint16_t payloadVersion = OC_SPEC_VERSION_VALUE;
@@ -3616,6 +3817,18 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
     }
 #endif
 
+    if (fromCache && (OC_STACK_OK == OCQueueCachedResponse(clientCB->devAddr,
+                                                           clientCB->requestUri, &endpoint,
+                                                           token, tokenLength)))
+    {
+        OIC_LOG(INFO, TAG, "Request answered from the client cache");
+        if (handle)
+        {
+            *handle = resHandle;
+        }
+        goto exit;
+    }
+
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
     /* Check whether we should assert role certificates before making this request. */
     bool isEndpointSecure = ((endpoint.flags & CA_SECURE) != 0);
@@ -3675,6 +3888,7 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
 
 
     // send request
+    requestInfo.info.blockStream = blockStream;
     result = OCSendRequest(&endpoint, &requestInfo);
     if (OC_STACK_OK != result)
     {
@@ -3847,6 +4061,36 @@ OCPersistentStorage *OC_CALL OCGetPersistentStorageHandler(void)
 
 #ifdef WITH_PRESENCE
 
+/**
+ * Schedule ::OC_STACK_TIMER_PRESENCE at the earliest presence time-out of the
+ * client callbacks, or cancel it if no presence callback is waiting.
+ */
+static void SchedulePresenceTimer(void)
+{
+    uint64_t earliest = OC_STACK_TIMER_NEVER;
+    ClientCB *cbNode = NULL;
+
+    LL_FOREACH(g_cbList, cbNode)
+    {
+        if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence ||
+            cbNode->presence->TTLlevel > PresenceTimeOutSize)
+        {
+            continue;
+        }
+
+        // The last level reports OC_STACK_PRESENCE_TIMEOUT at the next OCProcess().
+        uint64_t deadline = (cbNode->presence->TTLlevel < PresenceTimeOutSize) ?
+            OCTicksToStackTimerDeadline(cbNode->presence->timeOut[cbNode->presence->TTLlevel]) :
+            OICGetCurrentTime(TIME_IN_MS);
+        if (deadline < earliest)
+        {
+            earliest = deadline;
+        }
+    }
+
+    OCSetStackTimer(OC_STACK_TIMER_PRESENCE, earliest);
+}
+
 OCStackResult OCProcessPresence(void)
 {
     OCStackResult result = OC_STACK_OK;
@@ -3939,6 +4183,7 @@ exit:
         OIC_LOG(ERROR, TAG, "OCProcessPresence error");
     }
 
+    SchedulePresenceTimer();
     return result;
 }
 #endif // WITH_PRESENCE
@@ -3950,9 +4195,41 @@ OCStackResult OC_CALL OCProcess(void)
         OIC_LOG(ERROR, TAG, "OCProcess has failed. ocstack is not initialized");
         return OC_STACK_ERROR;
     }
+
+    // Each mechanism runs at most once, even if it sets a deadline which is already due.
+    OCStackTimerKind expired = OC_STACK_TIMER_COUNT;
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    for (int i = 0; (i < OC_STACK_TIMER_COUNT) && OCPopExpiredStackTimer(now, &expired); i++)
+    {
+        switch (expired)
+        {
 #ifdef WITH_PRESENCE
-    OCProcessPresence();
+            case OC_STACK_TIMER_PRESENCE:
+                OCProcessPresence();
+                break;
 #endif
+            case OC_STACK_TIMER_CLIENT_CB:
+                DeleteTimedOutClientCBs();
+                break;
+            case OC_STACK_TIMER_OBSERVER:
+                CheckTimedOutObservers();
+                break;
+#ifdef TCP_ADAPTER
+            case OC_STACK_TIMER_KEEPALIVE:
+                ProcessKeepAlive();
+                break;
+#endif
+            case OC_STACK_TIMER_BATCH:
+                CheckTimedOutBatchRequests();
+                break;
+            case OC_STACK_TIMER_RESPONSE_CACHE:
+                OCDeliverCachedResponses(OCHandleResponse);
+                break;
+            default:
+                break;
+        }
+    }
+
     CAHandleRequestResponse();
 
 #ifdef ROUTING_GATEWAY
@@ -3960,9 +4237,56 @@ OCStackResult OC_CALL OCProcess(void)
 #endif
 
 #ifdef TCP_ADAPTER
-    ProcessKeepAlive();
-    CAProcessPing();
+    if (CAGetNextPingDeadline() <= now)
+    {
+        CAProcessPing();
+    }
+#endif
+    return OC_STACK_OK;
+}
+
+uint32_t OC_CALL OCGetNextTimeout(void)
+{
+    if (stackState != OC_STACK_INITIALIZED)
+    {
+        return UINT32_MAX;
+    }
+
+    if (CAHasPendingRequestResponse())
+    {
+        return 0;
+    }
+
+    uint64_t deadline = OCGetStackTimerDeadline();
+#ifdef TCP_ADAPTER
+    uint64_t pingDeadline = CAGetNextPingDeadline();
+    if (pingDeadline < deadline)
+    {
+        deadline = pingDeadline;
+    }
+#endif
+
+    uint64_t timeout = UINT32_MAX;
+    if (OC_STACK_TIMER_NEVER != deadline)
+    {
+        uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+        timeout = (deadline > now) ? (deadline - now) : 0;
+    }
+
+#ifdef ROUTING_GATEWAY
+    // The routing manager has no deadline of its own, so it is polled.
+    if (timeout > ROUTING_PROCESS_INTERVAL_MS)
+    {
+        timeout = ROUTING_PROCESS_INTERVAL_MS;
+    }
 #endif
+    return (timeout < UINT32_MAX) ? (uint32_t)timeout : UINT32_MAX;
+}
+
+OCStackResult OC_CALL OCRegisterProcessWakeupHandler(OCProcessWakeupHandler handler,
+                                                     void *context)
+{
+    CARegisterReceivedDataHandler(handler, context);
     return OC_STACK_OK;
 }
 
@@ -4983,6 +5307,9 @@ OCStackResult OC_CALL OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfS
     }
     else
     {
+        // The representation has changed, the GET requests call the entity handler again.
+        OCClearResourceCache(resPtr->cache);
+
         //only increment in the case of regular observing (not presence)
         incrementSequenceNumber(resPtr);
         method = OC_REST_OBSERVE;
@@ -5040,9 +5367,14 @@ OCStackResult OC_CALL OCDoResponse(OCEntityHandlerResponse *ehResponse)
     VERIFY_NON_NULL(ehResponse->requestHandle, ERROR, OC_STACK_INVALID_PARAM);
 
     // Normal response
-    // Get pointer to request info
-    serverRequest = (OCServerRequest *)ehResponse->requestHandle;
-    if(serverRequest)
+    // Get pointer to request info, the handle may be the one of a deleted request
+    serverRequest = GetServerRequestUsingHandle(ehResponse->requestHandle);
+    if(!serverRequest)
+    {
+        OIC_LOG(ERROR, TAG, "Request handle is not the one of a pending request");
+        result = OC_STACK_INVALID_PARAM;
+    }
+    else
     {
         // response handler in ocserverrequest.c. Usually HandleSingleResponse.
         result = serverRequest->ehResponseHandler(ehResponse);
@@ -5052,6 +5384,117 @@ OCStackResult OC_CALL OCDoResponse(OCEntityHandlerResponse *ehResponse)
     return result;
 }
 
+OCStackResult OC_CALL OCDoStreamingResponse(OCEntityHandlerResponse *ehResponse,
+                                            OCPayloadFormat format,
+                                            size_t totalLength,
+                                            OCBlockProducer producer,
+                                            void *context,
+                                            OCBlockContextDeleter deleter)
+{
+    OIC_LOG(INFO, TAG, "Entering OCDoStreamingResponse");
+
+    if (!ehResponse || !ehResponse->requestHandle || !producer)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid streaming response");
+        if (deleter)
+        {
+            deleter(context);
+        }
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCServerRequest *serverRequest = GetServerRequestUsingHandle(ehResponse->requestHandle);
+    if (!serverRequest)
+    {
+        OIC_LOG(ERROR, TAG, "Request handle is not the one of a pending request");
+        if (deleter)
+        {
+            deleter(context);
+        }
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    if (HandleSingleResponse != serverRequest->ehResponseHandler)
+    {
+        // Aggregated (collection) responses are merged into a single payload.
+        OIC_LOG(ERROR, TAG, "Streaming is only supported for single responses");
+        if (deleter)
+        {
+            deleter(context);
+        }
+        return OC_STACK_NOTIMPL;
+    }
+
+    CABlockStream_t *blockStream = OCCreateBlockStream(producer, totalLength, NULL, context,
+                                                       deleter);
+    if (!blockStream)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    // The server request owns the stream; it is released when the request is deleted.
+    CAReleaseBlockStream(serverRequest->blockStream);
+    serverRequest->blockStream = blockStream;
+    serverRequest->blockStreamFormat = format;
+
+    OCEntityHandlerResponse streamResponse = *ehResponse;
+    streamResponse.payload = NULL;
+    return HandleSingleResponse(&streamResponse);
+}
+
+OCStackResult OC_CALL OCSetBatchResponseTimeout(uint32_t timeoutMs)
+{
+    OIC_LOG_V(INFO, TAG, "Batch response timeout set to %u ms", timeoutMs);
+    SetBatchResponseTimeout(timeoutMs);
+    return OC_STACK_OK;
+}
+
+OCStackResult OC_CALL OCSetResourceCaching(OCResourceHandle handle, bool enable, uint32_t maxAge)
+{
+    OCResource *resource = findResource((OCResource *) handle);
+    if (!resource)
+    {
+        OIC_LOG(ERROR, TAG, "Resource not found");
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    if (!enable)
+    {
+        OCDeleteResourceCache(resource->cache);
+        resource->cache = NULL;
+        return OC_STACK_OK;
+    }
+
+    if (!resource->cache)
+    {
+        resource->cache = (OCResourceCache *) OICCalloc(1, sizeof(OCResourceCache));
+        if (!resource->cache)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+    else
+    {
+        // The cached responses carry the previous Max-Age.
+        OCClearResourceCache(resource->cache);
+    }
+    resource->cache->maxAge = maxAge;
+    OIC_LOG_V(INFO, TAG, "Caching representations of %s, Max-Age %u", resource->uri, maxAge);
+    return OC_STACK_OK;
+}
+
+OCStackResult OC_CALL OCInvalidateResourceCache(OCResourceHandle handle)
+{
+    OCResource *resource = findResource((OCResource *) handle);
+    if (!resource)
+    {
+        OIC_LOG(ERROR, TAG, "Resource not found");
+        return OC_STACK_NO_RESOURCE;
+    }
+    OCClearResourceCache(resource->cache);
+    return OC_STACK_OK;
+}
+
 //-----------------------------------------------------------------------------
 // Private internal function definitions
 //-----------------------------------------------------------------------------
@@ -5408,6 +5851,7 @@ void deleteResourceElements(OCResource *resource)
     }
 
     DeleteObserverList(resource);
+    OCDeleteResourceCache(resource->cache);
 }
 
 void deleteResourceType(OCResourceType *resourceType)
@@ -5661,7 +6105,8 @@ OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
  * till the delimiter or '\0' which ever comes first.
  * "query" is whatever is to the right of the delimiter if present.
  * No delimiter sets the query to NULL.
- * If either are present, they will be malloc'ed into the params 2, 3.
+ * If either are present, they will be allocated into the params 2, 3 with
+ * OICRequestCalloc(), to free with OICRequestFree().
  * The first param, *uri is left untouched.
 
  * NOTE: This function does not account for whitespace at the end of the URI NOR
@@ -5693,7 +6138,7 @@ OCStackResult getQueryFromUri(const char * uri, char** query, char ** uriWithout
 
     if (uriWithoutQueryLen)
     {
-        *uriWithoutQuery =  (char *) OICCalloc(uriWithoutQueryLen + 1, 1);
+        *uriWithoutQuery =  (char *) OICRequestCalloc(uriWithoutQueryLen + 1, 1);
         if (!*uriWithoutQuery)
         {
             goto exit;
@@ -5702,10 +6147,10 @@ OCStackResult getQueryFromUri(const char * uri, char** query, char ** uriWithout
     }
     if (queryLen)
     {
-        *query = (char *) OICCalloc(queryLen + 1, 1);
+        *query = (char *) OICRequestCalloc(queryLen + 1, 1);
         if (!*query)
         {
-            OICFree(*uriWithoutQuery);
+            OICRequestFree(*uriWithoutQuery);
             *uriWithoutQuery = NULL;
             goto exit;
         }
@@ -0,0 +1,216 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "iotivity_config.h"
+#include <coap/coap.h>
+#include "ocstacktimer.h"
+#include "ocstackinternal.h"
+#include "oic_time.h"
+#include "experimental/logger.h"
+
+/// Module Name
+#define TAG "OIC_RI_STACKTIMER"
+
+typedef struct
+{
+    OCStackTimerKind kind;
+    uint64_t deadline;
+} OCStackTimer;
+
+/**
+ * Min-heap of the scheduled timers, ordered by deadline.
+ */
+static OCStackTimer g_timerHeap[OC_STACK_TIMER_COUNT];
+
+/**
+ * Number of scheduled timers.
+ */
+static size_t g_timerCount = 0;
+
+/**
+ * Position + 1 of each timer in g_timerHeap, or 0 if it is not scheduled.
+ */
+static size_t g_timerSlot[OC_STACK_TIMER_COUNT];
+
+static void PlaceTimer(size_t position, OCStackTimer timer)
+{
+    g_timerHeap[position] = timer;
+    g_timerSlot[timer.kind] = position + 1;
+}
+
+static bool IsTimerScheduled(OCStackTimerKind kind, size_t *position)
+{
+    if (0 == g_timerSlot[kind])
+    {
+        return false;
+    }
+    *position = g_timerSlot[kind] - 1;
+    return true;
+}
+
+static void SiftUp(size_t position)
+{
+    OCStackTimer timer = g_timerHeap[position];
+    while (position > 0)
+    {
+        size_t parent = (position - 1) / 2;
+        if (g_timerHeap[parent].deadline <= timer.deadline)
+        {
+            break;
+        }
+        PlaceTimer(position, g_timerHeap[parent]);
+        position = parent;
+    }
+    PlaceTimer(position, timer);
+}
+
+static void SiftDown(size_t position)
+{
+    OCStackTimer timer = g_timerHeap[position];
+    for (;;)
+    {
+        size_t child = 2 * position + 1;
+        if (child >= g_timerCount)
+        {
+            break;
+        }
+        if ((child + 1 < g_timerCount)
+            && (g_timerHeap[child + 1].deadline < g_timerHeap[child].deadline))
+        {
+            child++;
+        }
+        if (timer.deadline <= g_timerHeap[child].deadline)
+        {
+            break;
+        }
+        PlaceTimer(position, g_timerHeap[child]);
+        position = child;
+    }
+    PlaceTimer(position, timer);
+}
+
+static void RemoveTimer(OCStackTimerKind kind)
+{
+    size_t position = 0;
+    if (!IsTimerScheduled(kind, &position))
+    {
+        return;
+    }
+
+    g_timerSlot[kind] = 0;
+    g_timerCount--;
+    if (position == g_timerCount)
+    {
+        return;
+    }
+
+    // Move the last timer into the hole, then restore the heap order around it.
+    OCStackTimerKind moved = g_timerHeap[g_timerCount].kind;
+    PlaceTimer(position, g_timerHeap[g_timerCount]);
+    SiftDown(position);
+    SiftUp(g_timerSlot[moved] - 1);
+}
+
+void OCSetStackTimer(OCStackTimerKind kind, uint64_t deadline)
+{
+    if (kind >= OC_STACK_TIMER_COUNT)
+    {
+        OIC_LOG_V(ERROR, TAG, "Invalid timer %d", kind);
+        return;
+    }
+
+    if (OC_STACK_TIMER_NEVER == deadline)
+    {
+        RemoveTimer(kind);
+        return;
+    }
+
+    size_t position = 0;
+    if (!IsTimerScheduled(kind, &position))
+    {
+        OCStackTimer timer = { .kind = kind, .deadline = deadline };
+        position = g_timerCount++;
+        PlaceTimer(position, timer);
+        SiftUp(position);
+    }
+    else if (deadline < g_timerHeap[position].deadline)
+    {
+        g_timerHeap[position].deadline = deadline;
+        SiftUp(position);
+    }
+    else
+    {
+        g_timerHeap[position].deadline = deadline;
+        SiftDown(position);
+    }
+}
+
+void OCScheduleStackTimer(OCStackTimerKind kind, uint64_t deadline)
+{
+    if (kind >= OC_STACK_TIMER_COUNT)
+    {
+        OIC_LOG_V(ERROR, TAG, "Invalid timer %d", kind);
+        return;
+    }
+
+    size_t position = 0;
+    if (IsTimerScheduled(kind, &position) && (g_timerHeap[position].deadline <= deadline))
+    {
+        return;
+    }
+    OCSetStackTimer(kind, deadline);
+}
+
+bool OCPopExpiredStackTimer(uint64_t now, OCStackTimerKind *kind)
+{
+    if (!kind || (0 == g_timerCount) || (g_timerHeap[0].deadline > now))
+    {
+        return false;
+    }
+
+    *kind = g_timerHeap[0].kind;
+    RemoveTimer(*kind);
+    return true;
+}
+
+uint64_t OCGetStackTimerDeadline(void)
+{
+    return g_timerCount ? g_timerHeap[0].deadline : OC_STACK_TIMER_NEVER;
+}
+
+uint64_t OCTicksToStackTimerDeadline(uint32_t ticks)
+{
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    uint32_t nowTicks = GetTicks(0);
+    if (ticks <= nowTicks)
+    {
+        return now;
+    }
+    return now + ((uint64_t)(ticks - nowTicks) * MS_PER_SEC) / COAP_TICKS_PER_SECOND;
+}
+
+void OCResetStackTimers(void)
+{
+    for (size_t i = 0; i < OC_STACK_TIMER_COUNT; i++)
+    {
+        g_timerSlot[i] = 0;
+    }
+    g_timerCount = 0;
+}
@@ -26,12 +26,12 @@
 #include "oic_string.h"
 #include "oic_time.h"
 #include "experimental/ocrandom.h"
-#include "uarraylist.h"
 #include "ocstackinternal.h"
 #include "ocpayloadcbor.h"
 #include "ocpayload.h"
 #include "ocresourcehandler.h"
 #include "experimental/logger.h"
+#include "ocstacktimer.h"
 
 /**
  * Logging tag for module name.
@@ -40,6 +40,8 @@
 
 static const uint64_t USECS_PER_SEC = 1000000;
 
+static const uint64_t USECS_PER_MSEC = 1000;
+
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
@@ -77,6 +79,22 @@ static const uint64_t USECS_PER_SEC = 1000000;
  */
 #define DEFAULT_INTERVAL_COUNT  6
 
+/**
+ * Time to wait before an entry whose message could not be sent is checked again.
+ * in milliseconds.
+ */
+#define KEEPALIVE_RETRY_MS 1000
+
+/**
+ * The initial number of buckets of the KeepAlive table. Must be a power of 2.
+ */
+#define KEEPALIVE_MIN_BUCKETS 64
+
+/**
+ * The initial capacity of the deadline heap of the KeepAlive entries.
+ */
+#define KEEPALIVE_MIN_DEADLINES 16
+
 /**
  * KeepAlive key to parser Payload Table.
  */
@@ -97,15 +115,10 @@ static bool g_isKeepAliveInitialized = false;
  */
 static OCResourceHandle g_keepAliveHandle = NULL;
 
-/**
- * KeepAlive table which holds connection interval.
- */
-static u_arraylist_t *g_keepAliveConnectionTable = NULL;
-
 /**
  * KeepAlive table entries.
  */
-typedef struct
+struct KeepAliveEntry
 {
     OCMode mode;                    /**< host Mode of Operation. */
     CAEndpoint_t remoteAddr;        /**< destination Address. */
@@ -115,10 +128,41 @@ typedef struct
     int64_t *intervalInfo;          /**< interval values for KeepAlive. */
     bool sentPingMsg;               /**< if oic client already sent ping message. */
     uint64_t timeStamp;             /**< last sent or received ping message. in microseconds. */
-} KeepAliveEntry_t;
+    uint64_t deadline;              /**< next time the entry is due. in milliseconds. */
+    size_t heapIndex;               /**< position in g_keepAliveDeadlines. */
+    uint32_t hash;                  /**< hash of remoteAddr. */
+    struct KeepAliveEntry *next;    /**< next entry of the same bucket. */
+};
+
+/**
+ * KeepAlive table which holds connection interval, hashed by address and port.
+ */
+static KeepAliveEntry_t **g_keepAliveBuckets = NULL;
+
+/**
+ * Number of buckets of the KeepAlive table.
+ */
+static size_t g_keepAliveBucketCount = 0;
+
+/**
+ * Min-heap of the KeepAlive entries ordered by deadline.
+ * It holds every entry of the KeepAlive table.
+ */
+static KeepAliveEntry_t **g_keepAliveDeadlines = NULL;
+
+/**
+ * Number of KeepAlive entries.
+ */
+static size_t g_keepAliveCount = 0;
+
+/**
+ * Capacity of g_keepAliveDeadlines.
+ */
+static size_t g_keepAliveCapacity = 0;
 
 /**
  * Send disconnect message to remove connection.
+ * The entry is removed from the KeepAlive table and freed.
  */
 static OCStackResult SendDisconnectMessage(const KeepAliveEntry_t *entry);
 
@@ -132,6 +176,14 @@ static OCStackResult SendPingMessage(KeepAliveEntry_t *entry);
  */
 static void IncreaseInterval(KeepAliveEntry_t *entry);
 
+/**
+ * Get the time at which ProcessKeepAlive() has to check the entry.
+ *
+ * @param[in]   entry   KeepAlive entry.
+ * @return  deadline in milliseconds.
+ */
+static uint64_t GetKeepAliveDeadline(const KeepAliveEntry_t *entry);
+
 /**
  * Ping Message callback registered with RI for KeepAlive Request.
  */
@@ -178,35 +230,6 @@ static OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request
 OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
                                       OCStackResult responseCode,
                                       const OCRepPayload *respPayload);
-/**
- * Gets keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference URI and transport type) to
- *                          which the ping message has to be sent.
- * @param[out]  index       index of array list.
- * @return  KeepAlive entry to send ping message.
- */
-static KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, size_t *index);
-
-/**
- * Add keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference URI and transport type).
- * @param[in]   mode        Whether it is OIC Server or OIC Client.
- * @param[in]   intervalArray   Received interval values from cloud server.
- * @return  The KeepAlive entry added in KeepAlive Table.
- */
-KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
-                                    int64_t *intervalArray);
-
-/**
- * Remove keepalive entry.
- * @param[in]   endpoint    Remote Endpoint information (like ipaddress,
- *                          port, reference URI and transport type).
- * @return  The KeepAlive entry removed in KeepAlive Table.
- */
-static OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint);
-
 /**
  * Create KeepAlive paylaod to send message.
  * @param[in]   interval   The interval value to be sent.
@@ -257,15 +280,17 @@ OCStackResult InitializeKeepAlive(OCMode mode)
         }
     }
 
-    if (!g_keepAliveConnectionTable)
+    if (!g_keepAliveBuckets)
     {
-        g_keepAliveConnectionTable = u_arraylist_create();
-        if (NULL == g_keepAliveConnectionTable)
+        g_keepAliveBuckets = (KeepAliveEntry_t **) OICCalloc(KEEPALIVE_MIN_BUCKETS,
+                                                             sizeof(KeepAliveEntry_t *));
+        if (NULL == g_keepAliveBuckets)
         {
             OIC_LOG(ERROR, TAG, "Creating KeepAlive Table failed");
             TerminateKeepAlive(mode);
             return OC_STACK_ERROR;
         }
+        g_keepAliveBucketCount = KEEPALIVE_MIN_BUCKETS;
     }
 
     g_isKeepAliveInitialized = true;
@@ -294,11 +319,20 @@ OCStackResult TerminateKeepAlive(OCMode mode)
         }
     }
 
-    if (NULL != g_keepAliveConnectionTable)
+    for (size_t i = 0; i < g_keepAliveCount; i++)
     {
-        u_arraylist_destroy(g_keepAliveConnectionTable);
-        g_keepAliveConnectionTable = NULL;
+        OICFree(g_keepAliveDeadlines[i]->intervalInfo);
+        OICFree(g_keepAliveDeadlines[i]);
     }
+    OICFree(g_keepAliveDeadlines);
+    g_keepAliveDeadlines = NULL;
+    g_keepAliveCount = 0;
+    g_keepAliveCapacity = 0;
+
+    OICFree(g_keepAliveBuckets);
+    g_keepAliveBuckets = NULL;
+    g_keepAliveBucketCount = 0;
+    OCSetStackTimer(OC_STACK_TIMER_KEEPALIVE, OC_STACK_TIMER_NEVER);
 
     g_isKeepAliveInitialized = false;
 
@@ -405,8 +439,7 @@ OCStackResult SendKeepAliveResponse(OCServerRequest *request,
     CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
     CopyDevAddrToEndpoint(&request->devAddr, &endpoint);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint);
     int64_t interval = (entry) ? entry->interval : 0;
 
     // Create KeepAlive payload to send response message.
@@ -457,8 +490,7 @@ OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request,
     CAEndpoint_t endpoint = { .adapter = CA_DEFAULT_ADAPTER };
     CopyDevAddrToEndpoint(&request->devAddr, &endpoint);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(&endpoint);
     if (!entry)
     {
         OIC_LOG(ERROR, TAG, "Received the first keepalive message from client");
@@ -480,6 +512,7 @@ OCEntityHandlerResult HandleKeepAlivePOSTRequest(OCServerRequest *request,
     entry->interval = interval;
     OIC_LOG_V(DEBUG, TAG, "Received interval is [%" PRId64 "]", entry->interval);
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
+    UpdateKeepAliveDeadline(entry, GetKeepAliveDeadline(entry));
 
     OCPayloadDestroy(ocPayload);
 
@@ -495,8 +528,7 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     OIC_LOG(DEBUG, TAG, "HandleKeepAliveResponse IN");
 
     // Get entry from KeepAlive table.
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endPoint);
     if (!entry)
     {
         // Receive response message about find /oic/ping request.
@@ -535,6 +567,7 @@ OCStackResult HandleKeepAliveResponse(const CAEndpoint_t *endPoint,
     {
         // Set sentPingMsg values with false.
         entry->sentPingMsg = false;
+        UpdateKeepAliveDeadline(entry, GetKeepAliveDeadline(entry));
 
         // Check the received interval value.
         int64_t interval = 0;
@@ -554,16 +587,11 @@ void ProcessKeepAlive()
         return;
     }
 
-    size_t len = u_arraylist_length(g_keepAliveConnectionTable);
-
-    for (size_t i = 0; i < len; i++)
+    // Only the entries which are due are visited, in deadline order.
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    while (g_keepAliveCount && g_keepAliveDeadlines[0]->deadline <= now)
     {
-        KeepAliveEntry_t *entry = (KeepAliveEntry_t *)u_arraylist_get(g_keepAliveConnectionTable,
-                                                                      i);
-        if (NULL == entry)
-        {
-            continue;
-        }
+        KeepAliveEntry_t *entry = g_keepAliveDeadlines[0];
 
         uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
         if (OC_CLIENT == entry->mode)
@@ -579,8 +607,9 @@ void ProcessKeepAlive()
                 {
                     OIC_LOG(DEBUG, TAG, "Client does not receive the response within 1 minutes.");
 
-                    // Send message to disconnect session.
+                    // Send message to disconnect session. This removes the entry.
                     SendDisconnectMessage(entry);
+                    continue;
                 }
             }
             else
@@ -595,7 +624,6 @@ void ProcessKeepAlive()
                     if (OC_STACK_OK != result)
                     {
                         OIC_LOG(ERROR, TAG, "Failed to send ping request");
-                        continue;
                     }
                 }
             }
@@ -612,9 +640,93 @@ void ProcessKeepAlive()
             {
                 OIC_LOG(DEBUG, TAG, "Server does not receive a PUT request.");
                 SendDisconnectMessage(entry);
+                continue;
             }
         }
+
+        // An entry whose message has failed is checked again later, not on every OCProcess().
+        uint64_t deadline = GetKeepAliveDeadline(entry);
+        UpdateKeepAliveDeadline(entry, (deadline <= now) ? now + KEEPALIVE_RETRY_MS : deadline);
     }
+
+    OCSetStackTimer(OC_STACK_TIMER_KEEPALIVE,
+                    g_keepAliveCount ? g_keepAliveDeadlines[0]->deadline : OC_STACK_TIMER_NEVER);
+}
+
+uint64_t GetKeepAliveDeadline(const KeepAliveEntry_t *entry)
+{
+    uint64_t timeout = (OC_CLIENT == entry->mode && entry->sentPingMsg) ?
+                       KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC :
+                       (uint64_t)entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+    // Round up, so that the entry is really due when the deadline is reached.
+    return (entry->timeStamp + timeout + USECS_PER_MSEC - 1) / USECS_PER_MSEC;
+}
+
+static void PlaceKeepAliveEntry(size_t position, KeepAliveEntry_t *entry)
+{
+    g_keepAliveDeadlines[position] = entry;
+    entry->heapIndex = position;
+}
+
+static void SiftUpKeepAliveEntry(size_t position)
+{
+    KeepAliveEntry_t *entry = g_keepAliveDeadlines[position];
+    while (position > 0)
+    {
+        size_t parent = (position - 1) / 2;
+        if (g_keepAliveDeadlines[parent]->deadline <= entry->deadline)
+        {
+            break;
+        }
+        PlaceKeepAliveEntry(position, g_keepAliveDeadlines[parent]);
+        position = parent;
+    }
+    PlaceKeepAliveEntry(position, entry);
+}
+
+static void SiftDownKeepAliveEntry(size_t position)
+{
+    KeepAliveEntry_t *entry = g_keepAliveDeadlines[position];
+    for (;;)
+    {
+        size_t child = 2 * position + 1;
+        if (child >= g_keepAliveCount)
+        {
+            break;
+        }
+        if ((child + 1 < g_keepAliveCount)
+            && (g_keepAliveDeadlines[child + 1]->deadline < g_keepAliveDeadlines[child]->deadline))
+        {
+            child++;
+        }
+        if (entry->deadline <= g_keepAliveDeadlines[child]->deadline)
+        {
+            break;
+        }
+        PlaceKeepAliveEntry(position, g_keepAliveDeadlines[child]);
+        position = child;
+    }
+    PlaceKeepAliveEntry(position, entry);
+}
+
+KeepAliveEntry_t *GetNextKeepAliveEntry(void)
+{
+    return g_keepAliveCount ? g_keepAliveDeadlines[0] : NULL;
+}
+
+void UpdateKeepAliveDeadline(KeepAliveEntry_t *entry, uint64_t deadline)
+{
+    uint64_t previous = entry->deadline;
+    entry->deadline = deadline;
+    if (deadline < previous)
+    {
+        SiftUpKeepAliveEntry(entry->heapIndex);
+    }
+    else
+    {
+        SiftDownKeepAliveEntry(entry->heapIndex);
+    }
+    OCScheduleStackTimer(OC_STACK_TIMER_KEEPALIVE, g_keepAliveDeadlines[0]->deadline);
 }
 
 void IncreaseInterval(KeepAliveEntry_t *entry)
@@ -639,14 +751,16 @@ OCStackResult SendDisconnectMessage(const KeepAliveEntry_t *entry)
      * If CA get the empty message from RI, CA will disconnect a connection.
      */
 
-    OCStackResult result = RemoveKeepAliveEntry(&entry->remoteAddr);
+    // The entry is freed when it is removed from the table.
+    CAEndpoint_t remoteAddr = entry->remoteAddr;
+    OCStackResult result = RemoveKeepAliveEntry(&remoteAddr);
     if (result != OC_STACK_OK)
     {
         return result;
     }
 
     CARequestInfo_t requestInfo = { .method = CA_POST };
-    result = CASendRequest(&entry->remoteAddr, &requestInfo);
+    result = CASendRequest(&remoteAddr, &requestInfo);
     return CAResultToOCResult(result);
 }
 
@@ -672,6 +786,7 @@ OCStackResult SendPingMessage(KeepAliveEntry_t *entry)
     // Update timeStamp with time sent ping message for next ping message.
     entry->timeStamp = OICGetCurrentTime(TIME_IN_US);
     entry->sentPingMsg = true;
+    UpdateKeepAliveDeadline(entry, GetKeepAliveDeadline(entry));
 
     OIC_LOG_V(DEBUG, TAG, "Client sent ping message, interval [%" PRId64 "]", entry->interval);
 
@@ -698,30 +813,71 @@ OCStackApplicationResult PingRequestCallback(void* ctx, OCDoHandle handle,
     return OC_STACK_DELETE_TRANSACTION;
 }
 
-KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint, size_t *index)
+/**
+ * Hash the address and the port of an endpoint (FNV-1a).
+ */
+static uint32_t HashEndpoint(const CAEndpoint_t *endpoint)
 {
-    if (!g_keepAliveConnectionTable)
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; (i < sizeof(endpoint->addr)) && endpoint->addr[i]; i++)
     {
-        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
-        return NULL;
+        hash = (hash ^ (uint8_t)endpoint->addr[i]) * 16777619u;
     }
+    hash = (hash ^ (endpoint->port & 0xFF)) * 16777619u;
+    hash = (hash ^ (endpoint->port >> 8)) * 16777619u;
+    return hash;
+}
 
-    size_t len = u_arraylist_length(g_keepAliveConnectionTable);
+/**
+ * Double the number of buckets of the KeepAlive table.
+ * The table keeps working with its current buckets if memory is short.
+ */
+static void GrowKeepAliveBuckets(void)
+{
+    size_t bucketCount = g_keepAliveBucketCount * 2;
+    KeepAliveEntry_t **buckets = (KeepAliveEntry_t **) OICCalloc(bucketCount,
+                                                                 sizeof(KeepAliveEntry_t *));
+    if (!buckets)
+    {
+        OIC_LOG(WARNING, TAG, "Failed to grow KeepAlive table");
+        return;
+    }
 
-    for (size_t i = 0; i < len; i++)
+    for (size_t i = 0; i < g_keepAliveBucketCount; i++)
     {
-        KeepAliveEntry_t *entry = (KeepAliveEntry_t *)u_arraylist_get(g_keepAliveConnectionTable,
-                                                                      i);
-        if (NULL == entry)
+        KeepAliveEntry_t *entry = g_keepAliveBuckets[i];
+        while (entry)
         {
-            continue;
+            KeepAliveEntry_t *next = entry->next;
+            KeepAliveEntry_t **bucket = &buckets[entry->hash & (bucketCount - 1)];
+            entry->next = *bucket;
+            *bucket = entry;
+            entry = next;
         }
+    }
+
+    OICFree(g_keepAliveBuckets);
+    g_keepAliveBuckets = buckets;
+    g_keepAliveBucketCount = bucketCount;
+}
+
+KeepAliveEntry_t *GetEntryFromEndpoint(const CAEndpoint_t *endpoint)
+{
+    if (!g_keepAliveBuckets)
+    {
+        OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
+        return NULL;
+    }
 
-        if (!strncmp(entry->remoteAddr.addr, endpoint->addr, sizeof(entry->remoteAddr.addr))
+    uint32_t hash = HashEndpoint(endpoint);
+    for (KeepAliveEntry_t *entry = g_keepAliveBuckets[hash & (g_keepAliveBucketCount - 1)];
+         entry; entry = entry->next)
+    {
+        if ((entry->hash == hash)
+                && !strncmp(entry->remoteAddr.addr, endpoint->addr, sizeof(entry->remoteAddr.addr))
                 && (entry->remoteAddr.port == endpoint->port))
         {
             OIC_LOG(DEBUG, TAG, "Connection Info found in KeepAlive table");
-            *index = i;
             return entry;
         }
     }
@@ -738,12 +894,26 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
         return NULL;
     }
 
-    if (!g_keepAliveConnectionTable)
+    if (!g_keepAliveBuckets)
     {
         OIC_LOG(ERROR, TAG, "KeepAlive Table was not Created.");
         return NULL;
     }
 
+    if (g_keepAliveCount == g_keepAliveCapacity)
+    {
+        size_t capacity = g_keepAliveCapacity ? g_keepAliveCapacity * 2 : KEEPALIVE_MIN_DEADLINES;
+        KeepAliveEntry_t **deadlines = (KeepAliveEntry_t **) OICRealloc(g_keepAliveDeadlines,
+                                                    capacity * sizeof(KeepAliveEntry_t *));
+        if (!deadlines)
+        {
+            OIC_LOG(ERROR, TAG, "Adding node to head failed");
+            return NULL;
+        }
+        g_keepAliveDeadlines = deadlines;
+        g_keepAliveCapacity = capacity;
+    }
+
     KeepAliveEntry_t *entry = (KeepAliveEntry_t *) OICCalloc(1, sizeof(KeepAliveEntry_t));
     if (NULL == entry)
     {
@@ -759,6 +929,12 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     if (!entry->intervalInfo)
     {
         entry->intervalInfo = (int64_t*) OICMalloc(entry->intervalSize * sizeof(int64_t));
+        if (!entry->intervalInfo)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to Malloc KeepAlive intervals");
+            OICFree(entry);
+            return NULL;
+        }
         for (size_t i = 0; i < entry->intervalSize; i++)
         {
             entry->intervalInfo[i] = KEEPALIVE_MIN_INTERVAL << i;
@@ -766,14 +942,19 @@ KeepAliveEntry_t *AddKeepAliveEntry(const CAEndpoint_t *endpoint, OCMode mode,
     }
     entry->interval = entry->intervalInfo[0];
 
-    bool result = u_arraylist_add(g_keepAliveConnectionTable, (void *)entry);
-    if (!result)
+    if (g_keepAliveCount >= g_keepAliveBucketCount)
     {
-        OIC_LOG(ERROR, TAG, "Adding node to head failed");
-        OICFree(entry->intervalInfo);
-        OICFree(entry);
-        return NULL;
+        GrowKeepAliveBuckets();
     }
+    entry->hash = HashEndpoint(endpoint);
+    KeepAliveEntry_t **bucket = &g_keepAliveBuckets[entry->hash & (g_keepAliveBucketCount - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+
+    // A new entry goes to the end of the heap and sifts up to its deadline.
+    PlaceKeepAliveEntry(g_keepAliveCount++, entry);
+    entry->deadline = OC_STACK_TIMER_NEVER;
+    UpdateKeepAliveDeadline(entry, GetKeepAliveDeadline(entry));
 
     return entry;
 }
@@ -782,28 +963,36 @@ OCStackResult RemoveKeepAliveEntry(const CAEndpoint_t *endpoint)
 {
     VERIFY_NON_NULL(endpoint, FATAL, OC_STACK_INVALID_PARAM);
 
-    size_t index = 0;
-    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endpoint, &index);
+    KeepAliveEntry_t *entry = GetEntryFromEndpoint(endpoint);
     if (!entry)
     {
         OIC_LOG(ERROR, TAG, "There is no entry in keepalive table.");
         return OC_STACK_ERROR;
     }
 
-    KeepAliveEntry_t *removedEntry = (KeepAliveEntry_t *)
-                                        u_arraylist_remove(g_keepAliveConnectionTable, index);
-    if (NULL == removedEntry)
+    KeepAliveEntry_t **link = &g_keepAliveBuckets[entry->hash & (g_keepAliveBucketCount - 1)];
+    while (*link != entry)
     {
-        OIC_LOG(ERROR, TAG, "Removed Entry is NULL");
-        return OC_STACK_ERROR;
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+
+    // Move the last entry of the heap into the hole, then restore the heap order around it.
+    size_t position = entry->heapIndex;
+    KeepAliveEntry_t *last = g_keepAliveDeadlines[--g_keepAliveCount];
+    if (last != entry)
+    {
+        PlaceKeepAliveEntry(position, last);
+        SiftDownKeepAliveEntry(position);
+        SiftUpKeepAliveEntry(last->heapIndex);
     }
 
     OIC_LOG_V(DEBUG, TAG, "Remove Connection Info from KeepAlive table, "
-             "remote addr=%s port:%d", removedEntry->remoteAddr.addr,
-             removedEntry->remoteAddr.port);
+             "remote addr=%s port:%d", entry->remoteAddr.addr,
+             entry->remoteAddr.port);
 
     OICFree(entry->intervalInfo);
-    OICFree(removedEntry);
+    OICFree(entry);
 
     return OC_STACK_OK;
 }
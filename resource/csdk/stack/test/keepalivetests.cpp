@@ -0,0 +1,146 @@
+//******************************************************************
+//
+// Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "oickeepalive.h"
+    #include "oic_string.h"
+}
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "gtest_helper.h"
+
+class KeepAliveTableTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(OC_STACK_OK, InitializeKeepAlive(OC_CLIENT));
+    }
+
+    virtual void TearDown()
+    {
+        EXPECT_EQ(OC_STACK_OK, TerminateKeepAlive(OC_CLIENT));
+    }
+
+    static CAEndpoint_t MakeEndpoint(const char *addr, uint16_t port)
+    {
+        CAEndpoint_t endpoint;
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_TCP;
+        OICStrcpy(endpoint.addr, sizeof(endpoint.addr), addr);
+        endpoint.port = port;
+        return endpoint;
+    }
+};
+
+TEST_F(KeepAliveTableTest, InsertAndLookup)
+{
+    CAEndpoint_t first = MakeEndpoint("10.0.0.1", 5683);
+    CAEndpoint_t samePort = MakeEndpoint("10.0.0.2", 5683);
+    CAEndpoint_t sameAddr = MakeEndpoint("10.0.0.1", 5684);
+
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&first));
+    KeepAliveEntry_t *firstEntry = AddKeepAliveEntry(&first, OC_CLIENT, NULL);
+    ASSERT_TRUE(NULL != firstEntry);
+    KeepAliveEntry_t *samePortEntry = AddKeepAliveEntry(&samePort, OC_CLIENT, NULL);
+    ASSERT_TRUE(NULL != samePortEntry);
+
+    EXPECT_EQ(firstEntry, GetEntryFromEndpoint(&first));
+    EXPECT_EQ(samePortEntry, GetEntryFromEndpoint(&samePort));
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&sameAddr));
+}
+
+TEST_F(KeepAliveTableTest, LookupAfterTableGrows)
+{
+    // Enough entries for the table to be rehashed a few times.
+    const size_t count = 300;
+    KeepAliveEntry_t *entries[count];
+    for (size_t i = 0; i < count; i++)
+    {
+        CAEndpoint_t endpoint = MakeEndpoint("192.168.1.1", (uint16_t)(1000 + i));
+        entries[i] = AddKeepAliveEntry(&endpoint, OC_CLIENT, NULL);
+        ASSERT_TRUE(NULL != entries[i]);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CAEndpoint_t endpoint = MakeEndpoint("192.168.1.1", (uint16_t)(1000 + i));
+        EXPECT_EQ(entries[i], GetEntryFromEndpoint(&endpoint));
+    }
+}
+
+TEST_F(KeepAliveTableTest, Removal)
+{
+    CAEndpoint_t first = MakeEndpoint("10.0.0.1", 5683);
+    CAEndpoint_t second = MakeEndpoint("10.0.0.2", 5683);
+    ASSERT_TRUE(NULL != AddKeepAliveEntry(&first, OC_CLIENT, NULL));
+    KeepAliveEntry_t *secondEntry = AddKeepAliveEntry(&second, OC_CLIENT, NULL);
+    ASSERT_TRUE(NULL != secondEntry);
+
+    EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&first));
+    EXPECT_TRUE(NULL == GetEntryFromEndpoint(&first));
+    EXPECT_EQ(secondEntry, GetEntryFromEndpoint(&second));
+    EXPECT_EQ(secondEntry, GetNextKeepAliveEntry());
+
+    // An entry is removed only once.
+    EXPECT_EQ(OC_STACK_ERROR, RemoveKeepAliveEntry(&first));
+    EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&second));
+    EXPECT_TRUE(NULL == GetNextKeepAliveEntry());
+}
+
+TEST_F(KeepAliveTableTest, ExpiryOrder)
+{
+    // Deadlines are given out of order.
+    const uint64_t deadlines[] = { 700, 300, 900, 100, 500, 800, 200, 600, 400 };
+    const size_t count = sizeof(deadlines) / sizeof(deadlines[0]);
+    KeepAliveEntry_t *entries[count];
+    CAEndpoint_t endpoints[count];
+    for (size_t i = 0; i < count; i++)
+    {
+        endpoints[i] = MakeEndpoint("10.0.0.1", (uint16_t)(2000 + i));
+        entries[i] = AddKeepAliveEntry(&endpoints[i], OC_CLIENT, NULL);
+        ASSERT_TRUE(NULL != entries[i]);
+        UpdateKeepAliveDeadline(entries[i], deadlines[i]);
+    }
+    EXPECT_EQ(entries[3], GetNextKeepAliveEntry());
+
+    // Entries removed from the middle or the top of the heap keep it ordered.
+    EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&endpoints[4]));    // 500
+    EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&endpoints[3]));    // 100
+
+    // So do deadlines moved later or earlier.
+    UpdateKeepAliveDeadline(entries[6], 1000);                      // 200 -> 1000
+    UpdateKeepAliveDeadline(entries[2], 50);                        // 900 -> 50
+
+    const size_t expected[] = { 2, 1, 8, 7, 0, 5, 6 };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        EXPECT_EQ(entries[expected[i]], GetNextKeepAliveEntry());
+        EXPECT_EQ(OC_STACK_OK, RemoveKeepAliveEntry(&endpoints[expected[i]]));
+    }
+    EXPECT_TRUE(NULL == GetNextKeepAliveEntry());
+}
@@ -26,10 +26,15 @@ extern "C"
     #include "ocstackinternal.h"
     #include "experimental/logger.h"
     #include "oic_malloc.h"
+    #include "oic_arena.h"
     #include "oic_string.h"
     #include "oic_time.h"
     #include "ocresourcehandler.h"
     #include "occollection.h"
+    #include "ocstacktimer.h"
+    #include "ocresponsecache.h"
+    #include "ocpayloadcbor.h"
+    #include "ocevent.h"
     #include "mbedtls/ssl_ciphersuites.h"
     #include "octypes.h"
 #if defined (WITH_POSIX) && (defined (__WITH_DTLS__) || defined(__WITH_TLS__))
@@ -55,6 +60,7 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <time.h>
 
 #include "gtest_helper.h"
 
@@ -3444,3 +3450,784 @@ TEST(SelectCipherSuite,SelectPositiveAdapter)
 
 }
 #endif
+
+TEST(StackTimer, EarliestDeadlineExpiresFirst)
+{
+    OCResetStackTimers();
+    EXPECT_EQ(OC_STACK_TIMER_NEVER, OCGetStackTimerDeadline());
+
+    OCSetStackTimer(OC_STACK_TIMER_KEEPALIVE, 400);
+    OCSetStackTimer(OC_STACK_TIMER_CLIENT_CB, 200);
+    OCSetStackTimer(OC_STACK_TIMER_OBSERVER, 300);
+    OCSetStackTimer(OC_STACK_TIMER_PRESENCE, 100);
+    EXPECT_EQ(100u, OCGetStackTimerDeadline());
+
+    OCStackTimerKind kind = OC_STACK_TIMER_COUNT;
+    EXPECT_FALSE(OCPopExpiredStackTimer(99, &kind));
+    EXPECT_TRUE(OCPopExpiredStackTimer(250, &kind));
+    EXPECT_EQ(OC_STACK_TIMER_PRESENCE, kind);
+    EXPECT_TRUE(OCPopExpiredStackTimer(250, &kind));
+    EXPECT_EQ(OC_STACK_TIMER_CLIENT_CB, kind);
+    EXPECT_FALSE(OCPopExpiredStackTimer(250, &kind));
+    EXPECT_EQ(300u, OCGetStackTimerDeadline());
+
+    OCResetStackTimers();
+}
+
+TEST(StackTimer, RescheduleAndCancel)
+{
+    OCResetStackTimers();
+
+    // Scheduling keeps the earliest deadline, setting replaces it.
+    OCScheduleStackTimer(OC_STACK_TIMER_OBSERVER, 500);
+    OCScheduleStackTimer(OC_STACK_TIMER_OBSERVER, 700);
+    EXPECT_EQ(500u, OCGetStackTimerDeadline());
+    OCSetStackTimer(OC_STACK_TIMER_OBSERVER, 900);
+    EXPECT_EQ(900u, OCGetStackTimerDeadline());
+
+    OCSetStackTimer(OC_STACK_TIMER_CLIENT_CB, 600);
+    EXPECT_EQ(600u, OCGetStackTimerDeadline());
+    OCSetStackTimer(OC_STACK_TIMER_CLIENT_CB, OC_STACK_TIMER_NEVER);
+    EXPECT_EQ(900u, OCGetStackTimerDeadline());
+    OCSetStackTimer(OC_STACK_TIMER_OBSERVER, OC_STACK_TIMER_NEVER);
+    EXPECT_EQ(OC_STACK_TIMER_NEVER, OCGetStackTimerDeadline());
+}
+
+TEST(StackTimer, NextTimeoutWithoutStack)
+{
+    EXPECT_EQ(UINT32_MAX, OCGetNextTimeout());
+}
+
+TEST(StackTimer, NextTimeoutOfClientCallback)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT);
+
+    OCCallbackData cbData;
+    cbData.cb = asyncDoResourcesCallback;
+    cbData.context = (void*)DEFAULT_CONTEXT_VALUE;
+    cbData.cd = NULL;
+
+    OCDoHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(&handle, OC_REST_GET, "127.0.0.1:5683/a/light", NULL,
+                                        0, CT_DEFAULT, OC_LOW_QOS, &cbData, NULL, 0));
+    EXPECT_GE((uint32_t)(MAX_CB_TIMEOUT_SECONDS * 1000), OCGetNextTimeout());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static void wakeupHandler(void *context)
+{
+    oc_event_signal((oc_event)context);
+}
+
+TEST(StackTimer, IdleProcessLoopSleeps)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline", "/a/light",
+                                            entityHandler, NULL, OC_DISCOVERABLE));
+
+    oc_event wakeup = oc_event_new();
+    ASSERT_TRUE(NULL != wakeup);
+    EXPECT_EQ(OC_STACK_OK, OCRegisterProcessWakeupHandler(wakeupHandler, wakeup));
+
+    // An idle stack lets the main loop block, and does not wake it up.
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    EXPECT_LT(0u, OCGetNextTimeout());
+    EXPECT_EQ(OC_WAIT_TIMEDOUT, oc_event_wait_for(wakeup, 100));
+
+    // A message received by the stack wakes the main loop up.
+    uint16_t port = 0;
+#ifdef IP_ADAPTER
+    CAEndpoint_t *info = NULL;
+    size_t size = 0;
+    CAGetNetworkInformation(&info, &size);
+    for (size_t i = 0; i < size; i++)
+    {
+        if ((CA_ADAPTER_IP == info[i].adapter) && (info[i].flags & CA_IPV4))
+        {
+            port = info[i].port;
+        }
+    }
+    OICFree(info);
+#endif
+    if (port)
+    {
+        char uri[MAX_URI_LENGTH];
+        snprintf(uri, sizeof(uri), "127.0.0.1:%u/a/light", port);
+        OCCallbackData cbData;
+        cbData.cb = asyncDoResourcesCallback;
+        cbData.context = (void*)DEFAULT_CONTEXT_VALUE;
+        cbData.cd = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_GET, uri, NULL, 0,
+                                            (OCConnectivityType)(CT_ADAPTER_IP | CT_IP_USE_V4),
+                                            OC_LOW_QOS, &cbData, NULL, 0));
+        EXPECT_EQ(OC_WAIT_SUCCESS, oc_event_wait_for(wakeup, 1000));
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+    }
+
+    // The handler is unregistered by OCStop(), so that the event can be released.
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    oc_event_free(wakeup);
+}
+
+TEST(StackBatch, PartialResponseAtDeadline)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+    EXPECT_EQ(OC_STACK_OK, OCSetBatchResponseTimeout(100));
+
+    OCResourceHandle fastHandle;
+    OCResourceHandle slowHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&fastHandle, "core.light", "oic.if.baseline",
+                                            "/a/fast", entityHandler, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&slowHandle, "core.light", "oic.if.baseline",
+                                            "/a/slow", entityHandler, NULL, OC_DISCOVERABLE));
+
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+    uint8_t token[] = { 1, 2, 3, 4 };
+    OCServerRequest *request = NULL;
+    ASSERT_EQ(OC_STACK_OK, AddServerRequest(&request, 0, 0, 0, OC_REST_GET, 0, 0, OC_LOW_QOS,
+                                            NULL, NULL, OC_FORMAT_CBOR, NULL, (CAToken_t)token,
+                                            sizeof(token), (char *)"/a/room", 0, OC_FORMAT_CBOR,
+                                            OC_SPEC_VERSION_VALUE, &devAddr));
+    request->ehResponseHandler = HandleAggregateResponse;
+    EXPECT_EQ(OC_STACK_OK, StartBatchRequest(request, 2));
+    EXPECT_EQ(OC_STACK_OK, AddBatchChild(request, fastHandle, "/a/fast"));
+    EXPECT_EQ(OC_STACK_OK, AddBatchChild(request, slowHandle, "/a/slow"));
+    EXPECT_NE(OC_STACK_TIMER_NEVER, OCGetStackTimerDeadline());
+
+    // The fast child responds at once.
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(NULL != payload);
+    OCRepPayloadSetUri(payload, "/a/fast");
+    OCRepPayloadSetPropBool(payload, "state", true);
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request;
+    response.resourceHandle = fastHandle;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    EXPECT_EQ(OC_STACK_OK, HandleAggregateResponse(&response));
+    EXPECT_EQ(1, request->numBatchChildren);
+
+    // The partial response is sent at the deadline, the request waits for the slow child.
+    request->batchDeadline = 0;
+    CheckTimedOutBatchRequests();
+    EXPECT_EQ(request, GetServerRequestUsingToken((CAToken_t)token, sizeof(token)));
+    EXPECT_EQ(1, request->batchClosed);
+    EXPECT_EQ(1, request->numResponses);
+
+    // The late response of the slow child is discarded and releases the request.
+    OCRepPayloadSetUri(payload, "/a/slow");
+    response.resourceHandle = slowHandle;
+    response.payload = (OCPayload *)payload;
+    EXPECT_EQ(OC_STACK_OK, HandleAggregateResponse(&response));
+    EXPECT_TRUE(NULL == GetServerRequestUsingToken((CAToken_t)token, sizeof(token)));
+
+    OCRepPayloadDestroy(payload);
+    EXPECT_EQ(OC_STACK_OK, OCSetBatchResponseTimeout(0));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBatch, RequestDeletedWhenChildNeverResponds)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+    EXPECT_EQ(OC_STACK_OK, OCSetBatchResponseTimeout(100));
+
+    OCResourceHandle slowHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&slowHandle, "core.light", "oic.if.baseline",
+                                            "/a/slow", entityHandler, NULL, OC_DISCOVERABLE));
+
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+    uint8_t token[] = { 5, 6, 7, 8 };
+    OCServerRequest *request = NULL;
+    ASSERT_EQ(OC_STACK_OK, AddServerRequest(&request, 0, 0, 0, OC_REST_GET, 0, 0, OC_LOW_QOS,
+                                            NULL, NULL, OC_FORMAT_CBOR, NULL, (CAToken_t)token,
+                                            sizeof(token), (char *)"/a/room", 0, OC_FORMAT_CBOR,
+                                            OC_SPEC_VERSION_VALUE, &devAddr));
+    request->ehResponseHandler = HandleAggregateResponse;
+    EXPECT_EQ(OC_STACK_OK, StartBatchRequest(request, 1));
+    EXPECT_EQ(OC_STACK_OK, AddBatchChild(request, slowHandle, "/a/slow"));
+
+    // The partial response is sent at the deadline, the request waits a while longer.
+    request->batchDeadline = 0;
+    CheckTimedOutBatchRequests();
+    EXPECT_EQ(request, GetServerRequestUsingToken((CAToken_t)token, sizeof(token)));
+    EXPECT_EQ(1, request->batchClosed);
+    EXPECT_LT(OICGetCurrentTime(TIME_IN_MS), request->batchDeadline);
+    EXPECT_GE(request->batchDeadline, OCGetStackTimerDeadline());
+
+    // The slow child never responds, the request is deleted at its final deadline.
+    request->batchDeadline = 0;
+    CheckTimedOutBatchRequests();
+    EXPECT_TRUE(NULL == GetServerRequestUsingToken((CAToken_t)token, sizeof(token)));
+
+    EXPECT_EQ(OC_STACK_OK, OCSetBatchResponseTimeout(0));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBatch, DuplicateChildResponseCountedOnce)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+    EXPECT_EQ(OC_STACK_OK, OCSetBatchResponseTimeout(100));
+
+    OCResourceHandle fastHandle;
+    OCResourceHandle slowHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&fastHandle, "core.light", "oic.if.baseline",
+                                            "/a/fast", entityHandler, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&slowHandle, "core.light", "oic.if.baseline",
+                                            "/a/slow", entityHandler, NULL, OC_DISCOVERABLE));
+
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+    uint8_t token[] = { 9, 10, 11, 12 };
+    OCServerRequest *request = NULL;
+    ASSERT_EQ(OC_STACK_OK, AddServerRequest(&request, 0, 0, 0, OC_REST_GET, 0, 0, OC_LOW_QOS,
+                                            NULL, NULL, OC_FORMAT_CBOR, NULL, (CAToken_t)token,
+                                            sizeof(token), (char *)"/a/room", 0, OC_FORMAT_CBOR,
+                                            OC_SPEC_VERSION_VALUE, &devAddr));
+    request->ehResponseHandler = HandleAggregateResponse;
+    EXPECT_EQ(OC_STACK_OK, StartBatchRequest(request, 2));
+    EXPECT_EQ(OC_STACK_OK, AddBatchChild(request, fastHandle, "/a/fast"));
+    EXPECT_EQ(OC_STACK_OK, AddBatchChild(request, slowHandle, "/a/slow"));
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(NULL != payload);
+    OCRepPayloadSetUri(payload, "/a/fast");
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request;
+    response.resourceHandle = fastHandle;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+
+    // A second response of the same child does not complete the batch.
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoResponse(&response));
+    EXPECT_EQ(request, GetServerRequestUsingHandle(request));
+    EXPECT_EQ(1, request->numResponses);
+
+    // The partial response is sent at the deadline, a duplicate is still not counted.
+    request->batchDeadline = 0;
+    CheckTimedOutBatchRequests();
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoResponse(&response));
+    EXPECT_EQ(1, request->numResponses);
+
+    // The slow child releases the request, whose handle is then rejected.
+    OCRepPayloadSetUri(payload, "/a/slow");
+    response.resourceHandle = slowHandle;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    EXPECT_TRUE(NULL == GetServerRequestUsingHandle(request));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoResponse(&response));
+
+    OCRepPayloadDestroy(payload);
+    EXPECT_EQ(OC_STACK_OK, OCSetBatchResponseTimeout(0));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+typedef struct
+{
+    size_t producedBytes;
+    int deleted;
+} StreamTestContext;
+
+static OCStackResult StreamTestProducer(void *context, size_t offset, uint8_t *buffer,
+                                        size_t size)
+{
+    StreamTestContext *streamContext = (StreamTestContext *) context;
+    for (size_t i = 0; i < size; i++)
+    {
+        buffer[i] = (uint8_t)(offset + i);
+    }
+    streamContext->producedBytes += size;
+    return OC_STACK_OK;
+}
+
+static void StreamTestDeleter(void *context)
+{
+    ((StreamTestContext *) context)->deleted++;
+}
+
+TEST(StackStreaming, StreamingResponseProducesPayload)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline",
+                                            "/a/stream", entityHandler, NULL, OC_DISCOVERABLE));
+
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+    uint8_t token[] = { 13, 14, 15, 16 };
+    OCServerRequest *request = NULL;
+    ASSERT_EQ(OC_STACK_OK, AddServerRequest(&request, 0, 0, 0, OC_REST_GET, 0, 0, OC_LOW_QOS,
+                                            NULL, NULL, OC_FORMAT_CBOR, NULL, (CAToken_t)token,
+                                            sizeof(token), (char *)"/a/stream", 0, OC_FORMAT_CBOR,
+                                            OC_SPEC_VERSION_VALUE, &devAddr));
+    request->ehResponseHandler = HandleSingleResponse;
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request;
+    response.resourceHandle = handle;
+    response.ehResult = OC_EH_OK;
+
+    // A payload which fits in a single message is produced at once, then the
+    // context is released with the request.
+    StreamTestContext streamContext = { 0, 0 };
+    EXPECT_EQ(OC_STACK_OK, OCDoStreamingResponse(&response, OC_FORMAT_CBOR, 64,
+                                                 StreamTestProducer, &streamContext,
+                                                 StreamTestDeleter));
+    EXPECT_EQ(64u, streamContext.producedBytes);
+    EXPECT_EQ(1, streamContext.deleted);
+    EXPECT_TRUE(NULL == GetServerRequestUsingHandle(request));
+
+    // The handle of the completed request is rejected and the context still released.
+    StreamTestContext lateContext = { 0, 0 };
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoStreamingResponse(&response, OC_FORMAT_CBOR, 64,
+                                                            StreamTestProducer, &lateContext,
+                                                            StreamTestDeleter));
+    EXPECT_EQ(0u, lateContext.producedBytes);
+    EXPECT_EQ(1, lateContext.deleted);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackRequestArena, FiltersFromRequestArena)
+{
+    OICRequestArenaResetStats();
+    OICRequestArenaBegin();
+    char *interfaceFilter = NULL;
+    char *typeFilter = NULL;
+    EXPECT_EQ(OC_STACK_OK, ExtractFiltersFromQuery("if=oic.if.ll&rt=core.light",
+                                                   &interfaceFilter, &typeFilter));
+    EXPECT_STREQ("oic.if.ll", interfaceFilter);
+    EXPECT_STREQ("core.light", typeFilter);
+    OICRequestFree(interfaceFilter);
+    OICRequestFree(typeFilter);
+    OICRequestArenaEnd();
+
+    // The query and both filters were copied into the arena.
+    OICRequestArenaStats stats;
+    OICRequestArenaGetStats(&stats);
+    EXPECT_EQ(1u, stats.requests);
+    EXPECT_EQ(3u, stats.arenaAllocations);
+    EXPECT_EQ(0u, stats.heapAllocations);
+    OICRequestArenaRelease();
+}
+
+#define CACHE_NUM_OF_REQUESTS 20
+
+/* CoAP ETag option (RFC 7252, 5.10.6). */
+static const uint16_t ETAG_OPTION_ID = 4;
+
+/* CoAP Max-Age option (RFC 7252, 5.10.5). */
+static const uint16_t MAX_AGE_OPTION_ID = 14;
+
+static uint32_t g_cachedHandlerCalls = 0;
+
+static OCRepPayload *CreateDeviceInfoPayload()
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (payload)
+    {
+        OCRepPayloadSetUri(payload, "/a/info");
+        OCRepPayloadSetPropString(payload, "n", "Light bridge");
+        OCRepPayloadSetPropString(payload, "mnmn", "myName");
+        OCRepPayloadSetPropString(payload, "mnml", "http://www.example.com/bridge");
+        OCRepPayloadSetPropString(payload, "mnfv", "1.2.3");
+        OCRepPayloadSetPropInt(payload, "uptime", 86400);
+        OCRepPayloadSetPropBool(payload, "online", true);
+    }
+    return payload;
+}
+
+static bool HasCacheOption(const OCHeaderOption *options, uint8_t numOptions)
+{
+    for (uint8_t i = 0; i < numOptions; i++)
+    {
+        if ((ETAG_OPTION_ID == options[i].optionID) || (MAX_AGE_OPTION_ID == options[i].optionID))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static OCEntityHandlerResult cachedEntityHandler(OCEntityHandlerFlag /*flag*/,
+                                                 OCEntityHandlerRequest *ehRequest,
+                                                 void * /*callbackParam*/)
+{
+    g_cachedHandlerCalls++;
+    EXPECT_FALSE(HasCacheOption(ehRequest->rcvdVendorSpecificHeaderOptions,
+                                ehRequest->numRcvdVendorSpecificHeaderOptions));
+    OCRepPayload *payload = CreateDeviceInfoPayload();
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = ehRequest->requestHandle;
+    response.resourceHandle = ehRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+    return OC_EH_OK;
+}
+
+static OCStackResult DoCachedGet(OCResourceHandle handle, const char *query, const uint8_t *etag)
+{
+    static uint16_t messageId = 0;
+    messageId++;
+
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+    uint8_t token[] = { 5, 6, (uint8_t)(messageId >> 8), (uint8_t)messageId };
+
+    OCHeaderOption option;
+    memset(&option, 0, sizeof(option));
+    if (etag)
+    {
+        option.protocolID = OC_COAP_ID;
+        option.optionID = ETAG_OPTION_ID;
+        option.optionLength = OC_ETAG_LENGTH;
+        memcpy(option.optionData, etag, OC_ETAG_LENGTH);
+    }
+
+    OCServerRequest *request = NULL;
+    OCStackResult result = AddServerRequest(&request, messageId, 0, 0, OC_REST_GET,
+                                            etag ? 1 : 0, OC_OBSERVE_NO_OPTION, OC_LOW_QOS,
+                                            (char *)query, etag ? &option : NULL,
+                                            OC_FORMAT_CBOR, NULL, (CAToken_t)token,
+                                            sizeof(token), (char *)"/a/info", 0,
+                                            OC_FORMAT_CBOR, OC_SPEC_VERSION_VALUE, &devAddr);
+    if (OC_STACK_OK != result)
+    {
+        return result;
+    }
+    return ProcessRequest(OC_RESOURCE_NOT_COLLECTION_WITH_ENTITYHANDLER,
+                          (OCResource *)handle, request);
+}
+
+TEST(StackResponseCache, CacheRepresentations)
+{
+    OCResourceCache cache;
+    memset(&cache, 0, sizeof(cache));
+    uint8_t first[] = { 0xA1, 0x61, 0x6E, 0x01 };
+    uint8_t second[] = { 0xA1, 0x61, 0x6E, 0x02 };
+    CAInfo_t info;
+    memset(&info, 0, sizeof(info));
+    info.payload = first;
+    info.payloadSize = sizeof(first);
+    info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+
+    const OCCachedRepresentation *representation = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCCacheRepresentation(&cache, "if=oic.if.baseline", OC_FORMAT_CBOR,
+                                                 0, &info, &representation));
+    ASSERT_TRUE(NULL != representation);
+    EXPECT_EQ(representation, OCGetCachedRepresentation(&cache, "if=oic.if.baseline",
+                                                        OC_FORMAT_CBOR, 0));
+    EXPECT_TRUE(NULL == OCGetCachedRepresentation(&cache, "", OC_FORMAT_CBOR, 0));
+    EXPECT_TRUE(NULL == OCGetCachedRepresentation(&cache, "if=oic.if.baseline",
+                                                  OC_FORMAT_VND_OCF_CBOR, 0));
+    uint8_t firstETag[OC_ETAG_LENGTH];
+    memcpy(firstETag, representation->etag, sizeof(firstETag));
+
+    // Another representation of the same request replaces the first one, with another ETag.
+    info.payload = second;
+    EXPECT_EQ(OC_STACK_OK, OCCacheRepresentation(&cache, "if=oic.if.baseline", OC_FORMAT_CBOR,
+                                                 0, &info, &representation));
+    EXPECT_NE(0, memcmp(firstETag, representation->etag, OC_ETAG_LENGTH));
+    EXPECT_TRUE(NULL == representation->next);
+
+    OCHeaderOption options[2];
+    memset(options, 0, sizeof(options));
+    options[1].optionID = ETAG_OPTION_ID;
+    options[1].optionLength = OC_ETAG_LENGTH;
+    memcpy(options[1].optionData, firstETag, OC_ETAG_LENGTH);
+    EXPECT_FALSE(OCHasETagOption(options, 2, representation->etag));
+    memcpy(options[1].optionData, representation->etag, OC_ETAG_LENGTH);
+    EXPECT_TRUE(OCHasETagOption(options, 2, representation->etag));
+
+    // The oldest representations are dropped.
+    char query[32];
+    for (int i = 0; i < OC_RESOURCE_CACHE_MAX_REPRESENTATIONS; i++)
+    {
+        snprintf(query, sizeof(query), "page=%d", i);
+        EXPECT_EQ(OC_STACK_OK, OCCacheRepresentation(&cache, query, OC_FORMAT_CBOR, 0, &info,
+                                                     NULL));
+    }
+    EXPECT_TRUE(NULL == OCGetCachedRepresentation(&cache, "if=oic.if.baseline",
+                                                  OC_FORMAT_CBOR, 0));
+    EXPECT_TRUE(NULL != OCGetCachedRepresentation(&cache, "page=0", OC_FORMAT_CBOR, 0));
+
+    OCClearResourceCache(&cache);
+    EXPECT_TRUE(NULL == cache.representations);
+}
+
+TEST(StackResponseCache, ServerAnswersFromCache)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "oic.wk.d", "oic.if.baseline", "/a/info",
+                                            cachedEntityHandler, NULL, OC_DISCOVERABLE));
+    g_cachedHandlerCalls = 0;
+
+    // Without caching, each request calls the entity handler, which does not see the ETag.
+    uint8_t etag[OC_ETAG_LENGTH] = { 0 };
+    EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "", NULL));
+    EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "", etag));
+    EXPECT_EQ(2u, g_cachedHandlerCalls);
+
+    OCResponseCacheStats before;
+    OCGetResponseCacheStats(&before, NULL);
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceCaching(handle, true, 30));
+    EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "", NULL));
+    EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "", NULL));
+    EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "if=oic.if.baseline", NULL));
+    EXPECT_EQ(4u, g_cachedHandlerCalls);
+
+    OCResourceCache *cache = ((OCResource *)handle)->cache;
+    const OCCachedRepresentation *representation =
+            OCGetCachedRepresentation(cache, "", OC_FORMAT_CBOR, OC_SPEC_VERSION_VALUE);
+    ASSERT_TRUE(NULL != representation);
+    EXPECT_EQ(30u, cache->maxAge);
+
+    // The client presents the ETag of the current representation.
+    EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "", representation->etag));
+    EXPECT_EQ(4u, g_cachedHandlerCalls);
+
+    OCResponseCacheStats after;
+    OCGetResponseCacheStats(&after, NULL);
+    EXPECT_EQ(before.hits + 2, after.hits);
+    EXPECT_EQ(before.misses + 2, after.misses);
+    EXPECT_EQ(before.validated + 1, after.validated);
+
+    // A notification of a change drops the cached representations.
+    OCNotifyAllObservers(handle, OC_LOW_QOS);
+    EXPECT_TRUE(NULL == cache->representations);
+    EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "", NULL));
+    EXPECT_EQ(5u, g_cachedHandlerCalls);
+    EXPECT_EQ(OC_STACK_OK, OCInvalidateResourceCache(handle));
+    EXPECT_TRUE(NULL == cache->representations);
+
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceCaching(handle, false, 0));
+    EXPECT_TRUE(NULL == ((OCResource *)handle)->cache);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static uint32_t g_cachedResponses = 0;
+
+static OCStackApplicationResult cachedResponseCallback(void * /*ctx*/, OCDoHandle /*handle*/,
+                                                       OCClientResponse *clientResponse)
+{
+    g_cachedResponses++;
+    EXPECT_EQ(OC_STACK_OK, clientResponse->result);
+    EXPECT_FALSE(HasCacheOption(clientResponse->rcvdVendorSpecificHeaderOptions,
+                                clientResponse->numRcvdVendorSpecificHeaderOptions));
+    EXPECT_TRUE(NULL != clientResponse->payload);
+    if (clientResponse->payload)
+    {
+        char *name = NULL;
+        EXPECT_TRUE(OCRepPayloadGetPropString((OCRepPayload *)clientResponse->payload, "n",
+                                              &name));
+        EXPECT_STREQ("Light bridge", name);
+        OICFree(name);
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+static void InitCacheResponse(CAResponseInfo_t *responseInfo, CAHeaderOption_t *options,
+                              uint8_t *payload, size_t payloadSize, uint8_t maxAge)
+{
+    memset(responseInfo, 0, sizeof(*responseInfo));
+    memset(options, 0, 2 * sizeof(CAHeaderOption_t));
+    options[0].optionID = ETAG_OPTION_ID;
+    options[0].optionLength = 4;
+    memcpy(options[0].optionData, "\x01\x02\x03\x04", 4);
+    options[1].optionID = MAX_AGE_OPTION_ID;
+    options[1].optionLength = maxAge ? 1 : 0;
+    options[1].optionData[0] = (char)maxAge;
+    responseInfo->result = CA_CONTENT;
+    responseInfo->info.options = options;
+    responseInfo->info.numOptions = 2;
+    responseInfo->info.payload = payload;
+    responseInfo->info.payloadSize = payloadSize;
+    responseInfo->info.payloadFormat = CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    responseInfo->info.payloadVersion = OC_SPEC_VERSION_VALUE;
+}
+
+TEST(StackResponseCache, ClientAnswersFromCache)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT);
+    EXPECT_EQ(OC_STACK_OK, OCSetClientCacheCapacity(4));
+
+    OCRepPayload *representation = CreateDeviceInfoPayload();
+    ASSERT_TRUE(NULL != representation);
+    uint8_t *payload = NULL;
+    size_t payloadSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)representation, OC_FORMAT_VND_OCF_CBOR,
+                                            &payload, &payloadSize));
+    OCRepPayloadDestroy(representation);
+
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.flags = OC_IP_USE_V4;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+
+    // The response to an earlier GET, fresh for 30 seconds.
+    CAResponseInfo_t responseInfo;
+    CAHeaderOption_t options[2];
+    CAResponseInfo_t validated;
+    InitCacheResponse(&responseInfo, options, payload, payloadSize, 30);
+    EXPECT_EQ(&responseInfo, OCHandleClientCacheResponse(&devAddr, "/a/info", &responseInfo,
+                                                         &validated));
+
+    OCResponseCacheStats before;
+    OCGetResponseCacheStats(NULL, &before);
+    OCCallbackData cbData;
+    cbData.cb = cachedResponseCallback;
+    cbData.context = NULL;
+    cbData.cd = NULL;
+    g_cachedResponses = 0;
+    OCDoHandle handle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(&handle, OC_REST_GET, "/a/info", &devAddr, NULL,
+                                        CT_ADAPTER_IP, OC_LOW_QOS, &cbData, NULL, 0));
+    EXPECT_TRUE(NULL != handle);
+
+    // The response is delivered by the next OCProcess(), not by OCDoResource().
+    EXPECT_EQ(0u, g_cachedResponses);
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    EXPECT_EQ(1u, g_cachedResponses);
+
+    OCResponseCacheStats after;
+    OCGetResponseCacheStats(NULL, &after);
+    EXPECT_EQ(before.hits + 1, after.hits);
+    EXPECT_EQ(before.misses, after.misses);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    OICFree(payload);
+}
+
+TEST(StackResponseCache, ClientRevalidatesStaleResponse)
+{
+    EXPECT_EQ(OC_STACK_OK, OCSetClientCacheCapacity(4));
+    uint8_t payload[] = { 0xA1, 0x61, 0x6E, 0x01 };
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.port = 5683;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "192.168.1.10");
+
+    // Without a Max-Age, a response is not kept.
+    CAResponseInfo_t responseInfo;
+    CAHeaderOption_t options[2];
+    CAResponseInfo_t validated;
+    InitCacheResponse(&responseInfo, options, payload, sizeof(payload), 0);
+    responseInfo.info.numOptions = 1;
+    OCHandleClientCacheResponse(&devAddr, "/a/stale", &responseInfo, &validated);
+    CAHeaderOption_t etagOption;
+    EXPECT_EQ(OC_CLIENT_CACHE_MISS, OCLookupClientCache(&devAddr, "/a/stale", &etagOption));
+
+    // A Max-Age of 0 keeps the response to revalidate it at once.
+    responseInfo.info.numOptions = 2;
+    OCHandleClientCacheResponse(&devAddr, "/a/stale", &responseInfo, &validated);
+    EXPECT_EQ(OC_CLIENT_CACHE_STALE, OCLookupClientCache(&devAddr, "/a/stale", &etagOption));
+    EXPECT_EQ(ETAG_OPTION_ID, etagOption.optionID);
+    EXPECT_EQ(4, etagOption.optionLength);
+    EXPECT_EQ(0, memcmp(etagOption.optionData, "\x01\x02\x03\x04", 4));
+
+    // The server answers 2.03 Valid, the kept representation completes the response.
+    OCResponseCacheStats before;
+    OCGetResponseCacheStats(NULL, &before);
+    CAResponseInfo_t valid;
+    InitCacheResponse(&valid, options, NULL, 0, 30);
+    valid.result = CA_VALID;
+    const CAResponseInfo_t *handled = OCHandleClientCacheResponse(&devAddr, "/a/stale", &valid,
+                                                                  &validated);
+    ASSERT_EQ(&validated, handled);
+    EXPECT_EQ(CA_CONTENT, handled->result);
+    ASSERT_EQ(sizeof(payload), handled->info.payloadSize);
+    EXPECT_EQ(0, memcmp(payload, handled->info.payload, sizeof(payload)));
+    EXPECT_EQ(OC_CLIENT_CACHE_FRESH, OCLookupClientCache(&devAddr, "/a/stale", &etagOption));
+
+    OCResponseCacheStats after;
+    OCGetResponseCacheStats(NULL, &after);
+    EXPECT_EQ(before.validated + 1, after.validated);
+
+    // The responses to a multicast request are not kept.
+    OCDevAddr groupAddr = devAddr;
+    OICStrcpy(groupAddr.addr, sizeof(groupAddr.addr), "224.0.1.187");
+    InitCacheResponse(&responseInfo, options, payload, sizeof(payload), 30);
+    EXPECT_EQ(&responseInfo, OCHandleClientCacheResponse(&groupAddr, "/a/stale", &responseInfo,
+                                                         &validated));
+    EXPECT_EQ(OC_CLIENT_CACHE_MISS, OCLookupClientCache(&groupAddr, "/a/stale", &etagOption));
+    groupAddr = devAddr;
+    groupAddr.flags = (OCTransportFlags)(groupAddr.flags | OC_MULTICAST);
+    EXPECT_EQ(OC_CLIENT_CACHE_MISS, OCLookupClientCache(&groupAddr, "/a/stale", &etagOption));
+    OICStrcpy(groupAddr.addr, sizeof(groupAddr.addr), "ff02::158");
+    groupAddr.flags = OC_IP_USE_V6;
+    OCHandleClientCacheResponse(&groupAddr, "/a/stale", &responseInfo, &validated);
+    EXPECT_EQ(OC_CLIENT_CACHE_MISS, OCLookupClientCache(&groupAddr, "/a/stale", &etagOption));
+
+    // Another endpoint has nothing cached.
+    devAddr.port = 5684;
+    EXPECT_EQ(OC_CLIENT_CACHE_MISS, OCLookupClientCache(&devAddr, "/a/stale", &etagOption));
+    EXPECT_EQ(OC_STACK_OK, OCSetClientCacheCapacity(0));
+    devAddr.port = 5683;
+    EXPECT_EQ(OC_CLIENT_CACHE_MISS, OCLookupClientCache(&devAddr, "/a/stale", &etagOption));
+    OCTerminateClientCache();
+}
+
+static void RunCachedGets(OCResourceHandle handle)
+{
+    for (int i = 0; i < CACHE_NUM_OF_REQUESTS; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, DoCachedGet(handle, "if=oic.if.baseline", NULL));
+    }
+}
+
+TEST(StackResponseCache, RepeatedGetsReachHandlerOnce)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "oic.wk.d", "oic.if.baseline", "/a/info",
+                                            cachedEntityHandler, NULL, OC_DISCOVERABLE));
+
+    g_cachedHandlerCalls = 0;
+    RunCachedGets(handle);
+    EXPECT_EQ((uint32_t)CACHE_NUM_OF_REQUESTS, g_cachedHandlerCalls);
+
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceCaching(handle, true, 60));
+    g_cachedHandlerCalls = 0;
+    RunCachedGets(handle);
+    EXPECT_EQ(1u, g_cachedHandlerCalls);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
@@ -54,6 +54,23 @@ namespace OC
         const uint16_t ACCEPT_OPTION_ID = 17;
         const uint16_t CONTENT_TYPE_OPTION_ID = 12;
 
+        /**
+        *     Check whether an option ID can be used in an OCHeaderOption.
+        *
+        *     @param optionID ID of the option.
+        *     @return true if an OCHeaderOption with this ID can be created.
+        */
+        inline bool isValidOptionID(uint16_t optionID)
+        {
+            return (optionID >= MIN_HEADER_OPTIONID && optionID <= MAX_HEADER_OPTIONID)
+                    || optionID == IF_MATCH_OPTION_ID
+                    || optionID == IF_NONE_MATCH_OPTION_ID
+                    || optionID == LOCATION_PATH_OPTION_ID
+                    || optionID == LOCATION_QUERY_OPTION_ID
+                    || optionID == ACCEPT_OPTION_ID
+                    || optionID == CONTENT_TYPE_OPTION_ID;
+        }
+
         class OCHeaderOption
         {
         private:
@@ -68,13 +85,7 @@ namespace OC
                 m_optionID(optionID),
                 m_optionData(optionData)
             {
-                if (!(optionID >= MIN_HEADER_OPTIONID && optionID <= MAX_HEADER_OPTIONID)
-                        && optionID != IF_MATCH_OPTION_ID
-                        && optionID != IF_NONE_MATCH_OPTION_ID
-                        && optionID != LOCATION_PATH_OPTION_ID
-                        && optionID != LOCATION_QUERY_OPTION_ID
-                        && optionID != ACCEPT_OPTION_ID
-                        && optionID != CONTENT_TYPE_OPTION_ID)
+                if (!isValidOptionID(optionID))
                 {
                     throw OCException(OC::Exception::OPTION_ID_RANGE_INVALID);
                 }
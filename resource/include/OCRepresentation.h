@@ -69,6 +69,8 @@ namespace OC
 
             void addRepresentation(const OCRepresentation& rep);
 
+            void addRepresentation(OCRepresentation&& rep);
+
             const OCRepresentation& operator[](int index) const
             {
                 return m_reps[index];
@@ -94,6 +96,16 @@ namespace OC
             // this fix will work in the meantime.
             OCRepresentation(): m_interfaceType(InterfaceType::None){}
 
+            // The virtual destructor suppresses the implicit move operations, without
+            // which nested representations and arrays of them are deep copied instead.
+            OCRepresentation(const OCRepresentation&) = default;
+
+            OCRepresentation(OCRepresentation&&) = default;
+
+            OCRepresentation& operator=(const OCRepresentation&) = default;
+
+            OCRepresentation& operator=(OCRepresentation&&) = default;
+
             virtual ~OCRepresentation(){}
 
             void setDevAddr(const OCDevAddr&);
@@ -442,8 +454,7 @@ namespace OC
             T payload_array_helper_copy(size_t index, const OCRepPayloadValue* pl);
             void setPayload(const OCRepPayload* payload);
             void setPayloadArray(const OCRepPayloadValue* pl);
-            void getPayloadArray(OCRepPayload* payload,
-                    const OCRepresentation::AttributeItem& item) const;
+            void setPayloadValue(const char* name, AttributeValue&& val);
             // the root node has a slightly different JSON version
             // based on the interface type configured in ResourceResponse.
             // This allows ResourceResponse to set it, so that the save function
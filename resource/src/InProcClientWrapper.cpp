@@ -154,6 +154,12 @@ namespace OC
             for(size_t i = 0; i < clientResponse->numRcvdVendorSpecificHeaderOptions; i++)
             {
                 optionID = clientResponse->rcvdVendorSpecificHeaderOptions[i].optionID;
+                if (!HeaderOption::isValidOptionID(optionID))
+                {
+                    // Options handled by the stack can not reach the application.
+                    OIC_LOG_V(DEBUG, TAG, "Skipping header option %u", optionID);
+                    continue;
+                }
                 optionData = reinterpret_cast<const char*>
                                 (clientResponse->rcvdVendorSpecificHeaderOptions[i].optionData);
                 HeaderOption::OCHeaderOption headerOption(optionID, optionData);
@@ -98,6 +98,12 @@ void formResourceRequest(OCEntityHandlerFlag flag,
                     i++)
                 {
                     optionID = entityHandlerRequest->rcvdVendorSpecificHeaderOptions[i].optionID;
+                    if (!HeaderOption::isValidOptionID(optionID))
+                    {
+                        // Options handled by the stack can not reach the application.
+                        OIC_LOG_V(DEBUG, TAG, "Skipping header option %u", optionID);
+                        continue;
+                    }
                     optionData = reinterpret_cast<const char*>
                              (entityHandlerRequest->rcvdVendorSpecificHeaderOptions[i].optionData);
                     HeaderOption::OCHeaderOption headerOption(optionID, optionData);
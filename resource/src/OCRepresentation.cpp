@@ -71,7 +71,7 @@ namespace OC
             cur.setPayload(pl);
 
             pl = pl->next;
-            this->addRepresentation(cur);
+            this->addRepresentation(std::move(cur));
         }
     }
 
@@ -102,6 +102,11 @@ namespace OC
     {
         m_reps.push_back(rep);
     }
+
+    void MessageContainer::addRepresentation(OCRepresentation&& rep)
+    {
+        m_reps.push_back(std::move(rep));
+    }
 }
 
 namespace OC
@@ -109,13 +114,13 @@ namespace OC
     struct get_payload_array: boost::static_visitor<>
     {
         template<typename T>
-        void operator()(T& /*arr*/)
+        void operator()(const T& /*arr*/)
         {
             throw std::logic_error("Invalid calc_dimensions_visitor type");
         }
 
         template<typename T>
-        void operator()(std::vector<T>& arr)
+        void operator()(const std::vector<T>& arr)
         {
             root_size_calc<T>();
             dimensions[0] = arr.size();
@@ -132,7 +137,7 @@ namespace OC
 
         }
         template<typename T>
-        void operator()(std::vector<std::vector<T>>& arr)
+        void operator()(const std::vector<std::vector<T>>& arr)
         {
             root_size_calc<T>();
             dimensions[0] = arr.size();
@@ -154,7 +159,7 @@ namespace OC
             }
         }
         template<typename T>
-        void operator()(std::vector<std::vector<std::vector<T>>>& arr)
+        void operator()(const std::vector<std::vector<std::vector<T>>>& arr)
         {
             root_size_calc<T>();
             dimensions[0] = arr.size();
@@ -194,8 +199,10 @@ namespace OC
             root_size = sizeof(T);
         }
 
+        // Items are taken by reference so that strings and representations are
+        // serialized in place rather than copied first
         template<typename T>
-        void copy_to_array(T item, void* array, size_t pos)
+        void copy_to_array(const T& item, void* array, size_t pos)
         {
             ((T*)array)[pos] = item;
         }
@@ -204,50 +211,55 @@ namespace OC
         size_t root_size;
         size_t dimTotal;
         void* m_array;
+        OCRepPayloadPropType base_type;
     };
 
     template<>
     void get_payload_array::root_size_calc<int>()
     {
         root_size = sizeof(int64_t);
+        base_type = OCREP_PROP_INT;
     }
 
     template<>
-    void get_payload_array::root_size_calc<std::string>()
+    void get_payload_array::root_size_calc<double>()
     {
-        root_size = sizeof(char*);
+        root_size = sizeof(double);
+        base_type = OCREP_PROP_DOUBLE;
     }
 
     template<>
-    void get_payload_array::root_size_calc<OC::OCRepresentation>()
+    void get_payload_array::root_size_calc<bool>()
     {
-        root_size = sizeof(OCRepPayload*);
+        root_size = sizeof(bool);
+        base_type = OCREP_PROP_BOOL;
     }
 
     template<>
-    void get_payload_array::copy_to_array(int item, void* array, size_t pos)
+    void get_payload_array::root_size_calc<std::string>()
     {
-        ((int64_t*)array)[pos] = item;
+        root_size = sizeof(char*);
+        base_type = OCREP_PROP_STRING;
     }
 
-#if !(defined(_MSC_VER) || defined(__APPLE__))
     template<>
-    void get_payload_array::copy_to_array(std::_Bit_reference br, void* array, size_t pos)
+    void get_payload_array::root_size_calc<OCByteString>()
     {
-        ((bool*)array)[pos] = static_cast<bool>(br);
+        root_size = sizeof(OCByteString);
+        base_type = OCREP_PROP_BYTE_STRING;
     }
-#endif
 
     template<>
-    void get_payload_array::copy_to_array(std::string item, void* array, size_t pos)
+    void get_payload_array::root_size_calc<OC::OCRepresentation>()
     {
-        ((char**)array)[pos] = OICStrdup(item.c_str());
+        root_size = sizeof(OCRepPayload*);
+        base_type = OCREP_PROP_OBJECT;
     }
 
     template<>
-    void get_payload_array::copy_to_array(std::string& item, void* array, size_t pos)
+    void get_payload_array::copy_to_array(const int& item, void* array, size_t pos)
     {
-        ((char**)array)[pos] = OICStrdup(item.c_str());
+        ((int64_t*)array)[pos] = item;
     }
 
     template<>
@@ -256,18 +268,6 @@ namespace OC
         ((char**)array)[pos] = OICStrdup(item.c_str());
     }
 
-    template<>
-    void get_payload_array::copy_to_array(OCByteString item, void *array, size_t pos)
-    {
-        ((OCByteString *)array)[pos] = item;
-    }
-
-    template<>
-    void get_payload_array::copy_to_array(OCByteString &item, void *array, size_t pos)
-    {
-        ((OCByteString *)array)[pos] = item;
-    }
-
     template<>
     void get_payload_array::copy_to_array(const OCByteString &item, void *array, size_t pos)
     {
@@ -275,53 +275,105 @@ namespace OC
     }
 
     template<>
-    void get_payload_array::copy_to_array(OC::OCRepresentation item, void* array, size_t pos)
+    void get_payload_array::copy_to_array(const OC::OCRepresentation& item, void* array, size_t pos)
     {
         ((OCRepPayload**)array)[pos] = item.getPayload();
     }
 
-    void OCRepresentation::getPayloadArray(OCRepPayload* payload,
-                    const OCRepresentation::AttributeItem& item) const
+    // Sets each attribute of the representation in the payload, straight from the
+    // stored value so that no value is copied or looked up again on the way
+    struct set_payload_visitor: boost::static_visitor<>
     {
-        get_payload_array vis{};
-        boost::apply_visitor(vis, m_values[item.attrname()]);
+        set_payload_visitor(OCRepPayload* payload, const std::string& name)
+            : m_payload(payload), m_name(name.c_str()) {}
 
+        void operator()(const NullType& /*item*/)
+        {
+            OCRepPayloadSetNull(m_payload, m_name);
+        }
 
-        switch(item.base_type())
+        void operator()(int item)
         {
-            case AttributeType::Integer:
-                OCRepPayloadSetIntArrayAsOwner(payload, item.attrname().c_str(),
-                        (int64_t*)vis.m_array,
-                        vis.dimensions);
-                break;
-            case AttributeType::Double:
-                OCRepPayloadSetDoubleArrayAsOwner(payload, item.attrname().c_str(),
-                        (double*)vis.m_array,
-                        vis.dimensions);
-                break;
-            case AttributeType::Boolean:
-                OCRepPayloadSetBoolArrayAsOwner(payload, item.attrname().c_str(),
-                        (bool*)vis.m_array,
-                        vis.dimensions);
-                break;
-            case AttributeType::String:
-                OCRepPayloadSetStringArrayAsOwner(payload, item.attrname().c_str(),
-                        (char**)vis.m_array,
-                        vis.dimensions);
-                break;
-            case AttributeType::OCByteString:
-                OCRepPayloadSetByteStringArrayAsOwner(payload, item.attrname().c_str(),
-                                                      (OCByteString *)vis.m_array, vis.dimensions);
-                break;
-            case AttributeType::OCRepresentation:
-                OCRepPayloadSetPropObjectArrayAsOwner(payload, item.attrname().c_str(),
-                        (OCRepPayload**)vis.m_array, vis.dimensions);
-                break;
-            default:
-                throw std::logic_error(std::string("GetPayloadArray: Not Implemented") +
-                        std::to_string((int)item.base_type()));
+            OCRepPayloadSetPropInt(m_payload, m_name, item);
         }
-    }
+
+        void operator()(double item)
+        {
+            OCRepPayloadSetPropDouble(m_payload, m_name, item);
+        }
+
+        void operator()(bool item)
+        {
+            OCRepPayloadSetPropBool(m_payload, m_name, item);
+        }
+
+        void operator()(const std::string& item)
+        {
+            OCRepPayloadSetPropString(m_payload, m_name, item.c_str());
+        }
+
+        void operator()(const OCByteString& item)
+        {
+            OCRepPayloadSetPropByteString(m_payload, m_name, item);
+        }
+
+        void operator()(const OCRepresentation& item)
+        {
+            OCRepPayloadSetPropObjectAsOwner(m_payload, m_name, item.getPayload());
+        }
+
+        void operator()(const std::vector<uint8_t>& item)
+        {
+            OCRepPayloadSetPropByteString(m_payload, m_name,
+                    OCByteString{const_cast<uint8_t*>(item.data()), item.size()});
+        }
+
+        template<typename T>
+        void operator()(const std::vector<T>& arr)
+        {
+            get_payload_array vis{};
+            vis(arr);
+
+            switch(vis.base_type)
+            {
+                case OCREP_PROP_INT:
+                    OCRepPayloadSetIntArrayAsOwner(m_payload, m_name,
+                            (int64_t*)vis.m_array,
+                            vis.dimensions);
+                    break;
+                case OCREP_PROP_DOUBLE:
+                    OCRepPayloadSetDoubleArrayAsOwner(m_payload, m_name,
+                            (double*)vis.m_array,
+                            vis.dimensions);
+                    break;
+                case OCREP_PROP_BOOL:
+                    OCRepPayloadSetBoolArrayAsOwner(m_payload, m_name,
+                            (bool*)vis.m_array,
+                            vis.dimensions);
+                    break;
+                case OCREP_PROP_STRING:
+                    OCRepPayloadSetStringArrayAsOwner(m_payload, m_name,
+                            (char**)vis.m_array,
+                            vis.dimensions);
+                    break;
+                case OCREP_PROP_BYTE_STRING:
+                    OCRepPayloadSetByteStringArrayAsOwner(m_payload, m_name,
+                            (OCByteString *)vis.m_array, vis.dimensions);
+                    break;
+                case OCREP_PROP_OBJECT:
+                    OCRepPayloadSetPropObjectArrayAsOwner(m_payload, m_name,
+                            (OCRepPayload**)vis.m_array, vis.dimensions);
+                    break;
+                default:
+                    OICFree(vis.m_array);
+                    throw std::logic_error(std::string("GetPayloadArray: Not Implemented") +
+                            std::to_string((int)vis.base_type));
+            }
+        }
+
+        OCRepPayload* m_payload;
+        const char* m_name;
+    };
 
     OCRepPayload* OCRepresentation::getPayload() const
     {
@@ -343,47 +395,10 @@ namespace OC
             OCRepPayloadAddInterface(root, iface.c_str());
         }
 
-        for(auto& val : *this)
+        for(const auto& val : m_values)
         {
-            switch(val.type())
-            {
-                case AttributeType::Null:
-                    OCRepPayloadSetNull(root, val.attrname().c_str());
-                    break;
-                case AttributeType::Integer:
-                    OCRepPayloadSetPropInt(root, val.attrname().c_str(), static_cast<int>(val));
-                    break;
-                case AttributeType::Double:
-                    OCRepPayloadSetPropDouble(root, val.attrname().c_str(),
-                            val.getValue<double>());
-                    break;
-                case AttributeType::Boolean:
-                    OCRepPayloadSetPropBool(root, val.attrname().c_str(), val.getValue<bool>());
-                    break;
-                case AttributeType::String:
-                    OCRepPayloadSetPropString(root, val.attrname().c_str(),
-                            static_cast<std::string>(val).c_str());
-                    break;
-                case AttributeType::OCByteString:
-                    OCRepPayloadSetPropByteString(root, val.attrname().c_str(), val.getValue<OCByteString>());
-                    break;
-                case AttributeType::OCRepresentation:
-                    OCRepPayloadSetPropObjectAsOwner(root, val.attrname().c_str(),
-                            static_cast<OCRepresentation>(val).getPayload());
-                    break;
-                case AttributeType::Vector:
-                    getPayloadArray(root, val);
-                    break;
-                case AttributeType::Binary:
-                    OCRepPayloadSetPropByteString(root, val.attrname().c_str(),
-                            OCByteString{const_cast<uint8_t*>(val.getValue<std::vector<uint8_t>>().data()),
-                            val.getValue<std::vector<uint8_t>>().size()});
-                    break;
-                default:
-                    throw std::logic_error(std::string("Getpayload: Not Implemented") +
-                            std::to_string((int)val.type()));
-                    break;
-            }
+            set_payload_visitor vis(root, val.first);
+            boost::apply_visitor(vis, val.second);
         }
 
         return root;
@@ -484,7 +499,7 @@ namespace OC
             {
                 val[i] = payload_array_helper_copy<T>(i, pl);
             }
-            this->setValue(std::string(pl->name), val);
+            setPayloadValue(pl->name, std::move(val));
         }
         else if (depth == 2)
         {
@@ -498,7 +513,7 @@ namespace OC
                             i * pl->arr.dimensions[1] + j, pl);
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            setPayloadValue(pl->name, std::move(val));
         }
         else if (depth == 3)
         {
@@ -519,7 +534,7 @@ namespace OC
                     }
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            setPayloadValue(pl->name, std::move(val));
         }
         else
         {
@@ -581,38 +596,38 @@ namespace OC
             switch(val->type)
             {
                 case OCREP_PROP_NULL:
-                    setNULL(val->name);
+                    setPayloadValue(val->name, OC::NullType());
                     break;
                 case OCREP_PROP_INT:
                     // Needs to be removed as part of IOT-1726 fix.
 #ifdef _MSC_VER
 #pragma warning(suppress : 4244)
-                    setValue<int>(val->name, val->i);
+                    setPayloadValue(val->name, static_cast<int>(val->i));
 #else
-                    setValue<int>(val->name, val->i);
+                    setPayloadValue(val->name, static_cast<int>(val->i));
 #endif
                     break;
                 case OCREP_PROP_DOUBLE:
-                    setValue<double>(val->name, val->d);
+                    setPayloadValue(val->name, val->d);
                     break;
                 case OCREP_PROP_BOOL:
-                    setValue<bool>(val->name, val->b);
+                    setPayloadValue(val->name, val->b);
                     break;
                 case OCREP_PROP_STRING:
-                    setValue<std::string>(val->name, val->str);
+                    setPayloadValue(val->name, std::string(val->str));
                     break;
                 case OCREP_PROP_OBJECT:
                     {
                         OCRepresentation cur;
                         cur.setPayload(val->obj);
-                        setValue<OCRepresentation>(val->name, cur);
+                        setPayloadValue(val->name, std::move(cur));
                     }
                     break;
                 case OCREP_PROP_ARRAY:
                     setPayloadArray(val);
                     break;
                 case OCREP_PROP_BYTE_STRING:
-                    setValue(val->name,
+                    setPayloadValue(val->name,
                             std::vector<uint8_t>
                             (val->ocByteStr.bytes, val->ocByteStr.bytes + val->ocByteStr.len)
                             );
@@ -626,6 +641,22 @@ namespace OC
         }
     }
 
+    void OCRepresentation::setPayloadValue(const char* name, AttributeValue&& val)
+    {
+        std::string key(name);
+
+        // Payloads made from a representation list their values in key order, in which
+        // case each value is appended without searching the map
+        if (m_values.empty() || m_values.rbegin()->first < key)
+        {
+            m_values.emplace_hint(m_values.end(), std::move(key), std::move(val));
+        }
+        else
+        {
+            m_values[std::move(key)] = std::move(val);
+        }
+    }
+
     void OCRepresentation::addChild(const OCRepresentation& rep)
     {
         m_children.push_back(rep);
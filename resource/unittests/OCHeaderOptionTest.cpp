@@ -72,6 +72,33 @@ namespace OC
                 }
             }
 
+            TEST(OCHeaderOptionTest, CacheOptionsAreNotValid)
+            {
+                // The ETag and Max-Age options stay within the stack.
+                const uint16_t etagOptionID = 4;
+                const uint16_t maxAgeOptionID = 14;
+                EXPECT_FALSE(HeaderOption::isValidOptionID(etagOptionID));
+                EXPECT_FALSE(HeaderOption::isValidOptionID(maxAgeOptionID));
+                EXPECT_THROW(HeaderOption::OCHeaderOption(etagOptionID, ""), OCException);
+                EXPECT_THROW(HeaderOption::OCHeaderOption(maxAgeOptionID, ""), OCException);
+            }
+
+            TEST(OCHeaderOptionTest, IsValidOptionIDMatchesConstructor)
+            {
+                for (uint32_t i = 0; i <= UINT16_MAX; ++i)
+                {
+                    uint16_t optionID = static_cast<uint16_t>(i);
+                    if (HeaderOption::isValidOptionID(optionID))
+                    {
+                        EXPECT_NO_THROW(HeaderOption::OCHeaderOption(optionID, ""));
+                    }
+                    else
+                    {
+                        EXPECT_THROW(HeaderOption::OCHeaderOption(optionID, ""), OCException);
+                    }
+                }
+            }
+
             TEST(OCHeaderOptionTest, OptionIDTest)
             {
                 HeaderOption::OCHeaderOption opt {HeaderOption::MIN_HEADER_OPTIONID + 5, ""};
@@ -20,6 +20,7 @@
 
 #include <gtest/gtest.h>
 #include <OCApi.h>
+#include <ocpayload.h>
 #include <string>
 #include <limits>
 #include <boost/lexical_cast.hpp>
@@ -1448,6 +1449,115 @@ namespace OCRepresentationTest
         }
     }
 
+    OCRepresentation payloadRoundTrip(const OCRepresentation& rep)
+    {
+        OCRepPayload* payload = rep.getPayload();
+        MessageContainer mc;
+        mc.setPayload(payload);
+        OCPayloadDestroy((OCPayload*)payload);
+
+        EXPECT_EQ(1u, mc.representations().size());
+        return mc.representations()[0];
+    }
+
+    TEST(OCRepresentationPayload, RoundTrip)
+    {
+        OCRepresentation sub;
+        sub.setUri("/sub");
+        sub.setValue("int", 3);
+
+        OCRepresentation rep;
+        rep.setUri("/rep");
+        rep.setNULL("null");
+        rep.setValue("int", 8);
+        rep.setValue("double", 8.8);
+        rep.setValue("bool", true);
+        rep.setValue("string", std::string("this is a string"));
+        rep.setValue("sub", sub);
+        rep.setValue("intv", vector<int>{1, 2, 3});
+        rep.setValue("boolvv", vector<vector<bool>>{{true, false}, {false, true}});
+        rep.setValue("stringv", vector<string>{"s1", "s2"});
+        rep.setValue("subv", vector<OCRepresentation>{sub, sub});
+        rep.setValue("binary", vector<uint8_t>{0x1, 0x2, 0x3});
+
+        OCRepresentation parsed = payloadRoundTrip(rep);
+
+        EXPECT_EQ(rep.size(), parsed.size());
+        EXPECT_EQ("/rep", parsed.getUri());
+        EXPECT_TRUE(parsed.isNULL("null"));
+        EXPECT_EQ(8, parsed.getValue<int>("int"));
+        EXPECT_EQ(8.8, parsed.getValue<double>("double"));
+        EXPECT_TRUE(parsed.getValue<bool>("bool"));
+        EXPECT_EQ("this is a string", parsed.getValue<string>("string"));
+        EXPECT_EQ(3, parsed.getValue<OCRepresentation>("sub").getValue<int>("int"));
+        EXPECT_EQ((vector<int>{1, 2, 3}), parsed.getValue<vector<int>>("intv"));
+        EXPECT_EQ((vector<vector<bool>>{{true, false}, {false, true}}),
+                parsed.getValue<vector<vector<bool>>>("boolvv"));
+        EXPECT_EQ((vector<string>{"s1", "s2"}), parsed.getValue<vector<string>>("stringv"));
+        vector<OCRepresentation> subv = parsed.getValue<vector<OCRepresentation>>("subv");
+        EXPECT_EQ(2u, subv.size());
+        EXPECT_EQ("/sub", subv[1].getUri());
+        EXPECT_EQ((vector<uint8_t>{0x1, 0x2, 0x3}), parsed.getValue<vector<uint8_t>>("binary"));
+    }
+
+    TEST(OCRepresentationPayload, UnorderedValues)
+    {
+        OCRepPayload* payload = OCRepPayloadCreate();
+        OCRepPayloadSetPropInt(payload, "c", 3);
+        OCRepPayloadSetPropInt(payload, "a", 1);
+        OCRepPayloadSetPropInt(payload, "b", 2);
+
+        MessageContainer mc;
+        mc.setPayload(payload);
+        OCPayloadDestroy((OCPayload*)payload);
+
+        const OCRepresentation& rep = mc.representations()[0];
+        EXPECT_EQ(3u, rep.size());
+        EXPECT_EQ(1, rep.getValue<int>("a"));
+        EXPECT_EQ(2, rep.getValue<int>("b"));
+        EXPECT_EQ(3, rep.getValue<int>("c"));
+        EXPECT_EQ("a", rep.begin()->attrname());
+    }
+
+    TEST(OCRepresentationPayload, ConstructCopySerialize)
+    {
+        constexpr int NUM_OF_ATTRIBUTE = 20;
+        const std::string longString("a string longer than the small string buffer");
+
+        OCRepresentation sub;
+        sub.setValue("value", longString);
+        sub.setValue("names", vector<string>(8, longString));
+
+        OCRepresentation rep;
+        for (int j = 0; j < NUM_OF_ATTRIBUTE; ++j)
+        {
+            std::string name = "attribute" + std::to_string(j);
+            rep.setValue(name + "int", j);
+            rep.setValue(name + "string", longString);
+            rep.setValue(name + "sub", sub);
+        }
+        rep.setValue("subv", vector<OCRepresentation>(NUM_OF_ATTRIBUTE, sub));
+
+        OCRepresentation repCopy(rep);
+        rep.setValue("attribute0string", std::string("changed after the copy"));
+        EXPECT_EQ(longString, repCopy.getValue<string>("attribute0string"));
+
+        OCRepPayload* payload = repCopy.getPayload();
+        MessageContainer mc;
+        mc.setPayload(payload);
+        OCPayloadDestroy((OCPayload*)payload);
+
+        const OCRepresentation& parsed = mc.representations()[0];
+        EXPECT_EQ(repCopy.size(), parsed.size());
+        EXPECT_EQ(NUM_OF_ATTRIBUTE - 1, parsed.getValue<int>("attribute19int"));
+        EXPECT_EQ(longString, parsed.getValue<string>("attribute19string"));
+        OCRepresentation parsedSub = parsed.getValue<OCRepresentation>("attribute19sub");
+        EXPECT_EQ(longString, parsedSub.getValue<string>("value"));
+        EXPECT_EQ(vector<string>(8, longString), parsedSub.getValue<vector<string>>("names"));
+        EXPECT_EQ((size_t)NUM_OF_ATTRIBUTE,
+                parsed.getValue<vector<OCRepresentation>>("subv").size());
+    }
+
     TEST(OCRepresentationHostTest, ValidHost)
     {
         OCDevAddr addr = {OC_DEFAULT_ADAPTER, OC_IP_USE_V6, 5000, "fe80::1%eth0", 0, "", ""};
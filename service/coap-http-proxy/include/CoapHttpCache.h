@@ -0,0 +1,143 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the cache of the HTTP responses to proxied GET requests.
+ *
+ * Responses are kept according to their Cache-Control, Expires, Date and Age header
+ * fields (RFC 7234) as a shared cache would: responses marked no-store or private are
+ * never kept. A stale response with an ETag is revalidated with If-None-Match.
+ */
+
+#ifndef COAP_HTTP_CACHE_H_
+#define COAP_HTTP_CACHE_H_
+
+#include <time.h>
+#include "CoapHttpParser.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Default number of responses kept by the cache. */
+#define CHP_CACHE_CAPACITY 64
+
+/** Largest payload of a kept response. */
+#define CHP_CACHE_MAX_PAYLOAD_SIZE (65536U)
+
+/**
+ * @enum CHPCacheState_t
+ * State of the response kept for a request.
+ */
+typedef enum
+{
+    CHP_CACHE_MISS = 0,     /**< No response is kept. */
+    CHP_CACHE_FRESH,        /**< The kept response can be returned. */
+    CHP_CACHE_STALE         /**< The kept response has to be revalidated. */
+} CHPCacheState_t;
+
+/**
+ * Counters of the cache.
+ */
+typedef struct
+{
+    uint32_t hits;          /**< Requests answered with a fresh response. */
+    uint32_t misses;        /**< Requests sent to the HTTP server. */
+    uint32_t revalidated;   /**< Stale responses validated by a 304 response. */
+} CHPCacheStats_t;
+
+/**
+ * Function to initialize the cache.
+ * @param[in]   capacity    Number of responses kept, 0 disables the cache.
+ * @return ::OC_STACK_OK or appropriate error code.
+ */
+OCStackResult CHPCacheInitialize(size_t capacity);
+
+/**
+ * Function to drop the kept responses and terminate the cache.
+ */
+void CHPCacheTerminate(void);
+
+/**
+ * Function to get the freshness lifetime of an HTTP response.
+ * @param[in]   response    HTTP response.
+ * @param[in]   now         Current time.
+ * @param[out]  lifetime    Seconds the response stays fresh, 0 if it has to be revalidated.
+ * @return true if a shared cache may keep the response.
+ */
+bool CHPCacheGetLifetime(const HttpResponse_t *response, time_t now, uint32_t *lifetime);
+
+/**
+ * Function to look up the response kept for a GET request.
+ * @param[in]   uri             URI of the request.
+ * @param[in]   acceptFormat    Accept header field of the request.
+ * @param[in]   now             Current time.
+ * @param[out]  response        Copy of a fresh response, released with CHPCacheFreeResponse().
+ * @param[out]  validator       ETag of a stale response.
+ * @param[in]   validatorSize   Size of @p validator.
+ * @return state of the kept response.
+ */
+CHPCacheState_t CHPCacheLookup(const char *uri, const char *acceptFormat, time_t now,
+                               HttpResponse_t *response, char *validator,
+                               size_t validatorSize);
+
+/**
+ * Function to keep the response to a GET request, if it may be kept.
+ * @param[in]   uri             URI of the request.
+ * @param[in]   acceptFormat    Accept header field of the request.
+ * @param[in]   response        HTTP response.
+ * @param[in]   now             Current time.
+ * @return ::OC_STACK_OK if the response is kept, appropriate error code otherwise.
+ */
+OCStackResult CHPCacheStore(const char *uri, const char *acceptFormat,
+                            const HttpResponse_t *response, time_t now);
+
+/**
+ * Function to refresh a stale response validated by a 304 response.
+ * @param[in]   uri             URI of the request.
+ * @param[in]   acceptFormat    Accept header field of the request.
+ * @param[in]   notModified     304 response.
+ * @param[in]   now             Current time.
+ * @param[out]  response        Copy of the refreshed response, released with
+ *                              CHPCacheFreeResponse().
+ * @return ::OC_STACK_OK or appropriate error code.
+ */
+OCStackResult CHPCacheRevalidate(const char *uri, const char *acceptFormat,
+                                 const HttpResponse_t *notModified, time_t now,
+                                 HttpResponse_t *response);
+
+/**
+ * Function to release the header options and the payload of a response.
+ * @param[in]   response        HTTP response.
+ */
+void CHPCacheFreeResponse(HttpResponse_t *response);
+
+/**
+ * Function to get the counters of the cache.
+ * @param[out]  stats           Counters.
+ */
+void CHPCacheGetStats(CHPCacheStats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
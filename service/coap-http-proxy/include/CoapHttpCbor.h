@@ -0,0 +1,72 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the translation between JSON and CBOR documents.
+ *
+ * Both directions translate token by token into the output buffer, without building a
+ * tree of the document. Integers without fraction or exponent are translated to CBOR
+ * integers, other numbers to double precision floats. CBOR byte strings are translated
+ * to base64url strings (RFC 7049, 4.1) and integer map keys to strings.
+ */
+
+#ifndef COAP_HTTP_CBOR_H_
+#define COAP_HTTP_CBOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Deepest nesting of arrays and objects translated. */
+#define CHP_MAX_NESTING_DEPTH 64
+
+/**
+ * Function to translate a JSON document to CBOR.
+ * @param[in]   json            JSON document, not necessarily NUL terminated.
+ * @param[in]   jsonLength      Length of the JSON document.
+ * @param[out]  cbor            CBOR document, released with OICFree().
+ * @param[out]  cborLength      Length of the CBOR document.
+ * @return ::OC_STACK_OK, or ::OC_STACK_MALFORMED_RESPONSE if the JSON document is not valid.
+ */
+OCStackResult CHPJsonToCbor(const char *json, size_t jsonLength,
+                            uint8_t **cbor, size_t *cborLength);
+
+/**
+ * Function to translate a CBOR document to JSON.
+ * @param[in]   cbor            CBOR document.
+ * @param[in]   cborLength      Length of the CBOR document.
+ * @param[out]  json            NUL terminated JSON document, released with OICFree().
+ * @param[out]  jsonLength      Length of the JSON document.
+ * @return ::OC_STACK_OK, or ::OC_STACK_MALFORMED_RESPONSE if the CBOR document is not valid
+ *         or cannot be represented in JSON.
+ */
+OCStackResult CHPCborToJson(const uint8_t *cbor, size_t cborLength,
+                            char **json, size_t *jsonLength);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -41,6 +41,13 @@ extern "C"
 #define CBOR_CONTENT_TYPE "application/cbor"
 #define ACCEPT_MEDIA_TYPE (CBOR_CONTENT_TYPE "; q=1.0, " JSON_CONTENT_TYPE "; q=0.5")
 
+/* Number of idle easy handles kept for the next requests */
+#define CHP_EASY_HANDLE_POOL_SIZE 16
+/* Connections kept open to one HTTP server */
+#define CHP_MAX_HOST_CONNECTIONS 4L
+/* Connections kept open to all HTTP servers */
+#define CHP_MAX_CONNECTIONS 32L
+
 // HTTP Option types
 #define HTTP_OPTION_CACHE_CONTROL   "cache-control"
 #define HTTP_OPTION_ACCEPT          "accept"
@@ -50,6 +57,7 @@ extern "C"
 #define HTTP_OPTION_CONTENT_TYPE    "content-type"
 #define HTTP_OPTION_CONTENT_LENGTH  "content-length"
 #define HTTP_OPTION_EXPIRES         "expires"
+#define HTTP_OPTION_AUTHORIZATION   "authorization"
 
 /**
  * @enum HttpResponseResult_t
@@ -126,6 +134,7 @@ typedef struct HttpResponse_t
     char dataFormat[CHP_MAX_HF_DATA_LENGTH];
     void *payload;
     size_t payloadLength;
+    uint32_t maxAge;    /**< Freshness left, in seconds, 0 if it shall not be reused. **/
 }HttpResponse_t;
 
 typedef void (*CHPResponseCallback)(const HttpResponse_t *response, void *context);
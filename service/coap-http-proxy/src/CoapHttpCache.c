@@ -0,0 +1,573 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iotivity_config.h"
+#include "CoapHttpCache.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "uarraylist.h"
+#include "experimental/logger.h"
+
+#include <curl/curl.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#define TAG "CHP_CACHE"
+
+#define HTTP_OPTION_AGE     "age"
+#define HTTP_OPTION_DATE    "date"
+#define HTTP_OPTION_VARY    "vary"
+
+/**
+ * A kept response.
+ */
+typedef struct CHPCacheEntry_t
+{
+    /* Next entry, most recently used first */
+    struct CHPCacheEntry_t *next;
+    char *uri;
+    char *acceptFormat;
+    HttpResponse_t response;
+    /* ETag of the response, NULL if it cannot be revalidated */
+    char *etag;
+    time_t expiry;
+} CHPCacheEntry_t;
+
+static pthread_mutex_t g_cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static CHPCacheEntry_t *g_cacheEntries;
+static size_t g_cacheCount;
+static size_t g_cacheCapacity;
+static CHPCacheStats_t g_cacheStats;
+
+static bool CHPCacheNameEquals(const char *name, const char *expected)
+{
+    while (*name && *expected)
+    {
+        if (tolower((unsigned char)*name) != *expected)
+        {
+            return false;
+        }
+        name++;
+        expected++;
+    }
+    return *name == *expected;
+}
+
+static const char *CHPCacheGetHeader(const HttpResponse_t *response, const char *name)
+{
+    size_t count = u_arraylist_length(response->headerOptions);
+    for (size_t i = 0; i < count; i++)
+    {
+        HttpHeaderOption_t *option = u_arraylist_get(response->headerOptions, i);
+        if (option && CHPCacheNameEquals(option->optionName, name))
+        {
+            return option->optionData;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Match a Cache-Control directive at the start of @p directive, and return its
+ * argument if it has one.
+ */
+static bool CHPCacheMatchDirective(const char *directive, const char *name,
+                                   const char **argument)
+{
+    size_t length = strlen(name);
+    for (size_t i = 0; i < length; i++)
+    {
+        if (tolower((unsigned char)directive[i]) != name[i])
+        {
+            return false;
+        }
+    }
+
+    const char *end = directive + length;
+    while (*end == ' ')
+    {
+        end++;
+    }
+    if (*end == '=')
+    {
+        end++;
+        while (*end == ' ' || *end == '"')
+        {
+            end++;
+        }
+        *argument = end;
+        return true;
+    }
+    *argument = NULL;
+    return (*end == ',' || *end == '\0');
+}
+
+static bool CHPCacheTokenEquals(const char *token, size_t length, const char *expected)
+{
+    if (length != strlen(expected))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (tolower((unsigned char)token[i]) != expected[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Check that the request headers named by a Vary header are all part of the key of
+ * an entry, which only keeps the Accept header of the request.
+ */
+static bool CHPCacheVaryMatchesKey(const char *vary)
+{
+    for (const char *field = vary; *field; )
+    {
+        while (*field == ' ' || *field == ',')
+        {
+            field++;
+        }
+        size_t length = strcspn(field, " ,");
+        if (length && !CHPCacheTokenEquals(field, length, HTTP_OPTION_ACCEPT))
+        {
+            return false;
+        }
+        field += length;
+    }
+    return true;
+}
+
+bool CHPCacheGetLifetime(const HttpResponse_t *response, time_t now, uint32_t *lifetime)
+{
+    VERIFY_NON_NULL_RET(response, TAG, "response", false);
+    VERIFY_NON_NULL_RET(lifetime, TAG, "lifetime", false);
+    *lifetime = 0;
+
+    if (CHP_SUCCESS != response->status)
+    {
+        return false;
+    }
+
+    long maxAge = -1;
+    long sharedMaxAge = -1;
+    bool noCache = false;
+    size_t count = u_arraylist_length(response->headerOptions);
+    for (size_t i = 0; i < count; i++)
+    {
+        HttpHeaderOption_t *option = u_arraylist_get(response->headerOptions, i);
+        if (!option || !CHPCacheNameEquals(option->optionName, HTTP_OPTION_CACHE_CONTROL))
+        {
+            continue;
+        }
+
+        for (const char *directive = option->optionData; directive && *directive; )
+        {
+            while (*directive == ' ' || *directive == ',')
+            {
+                directive++;
+            }
+
+            const char *argument = NULL;
+            if (CHPCacheMatchDirective(directive, "no-store", &argument) ||
+                CHPCacheMatchDirective(directive, "private", &argument))
+            {
+                return false;
+            }
+            else if (CHPCacheMatchDirective(directive, "no-cache", &argument))
+            {
+                noCache = true;
+            }
+            else if (CHPCacheMatchDirective(directive, "s-maxage", &argument) && argument)
+            {
+                sharedMaxAge = strtol(argument, NULL, 10);
+            }
+            else if (CHPCacheMatchDirective(directive, "max-age", &argument) && argument)
+            {
+                maxAge = strtol(argument, NULL, 10);
+            }
+            directive = strchr(directive, ',');
+        }
+    }
+
+    // A response which varies on other request headers, or on "*", cannot be told apart
+    const char *vary = CHPCacheGetHeader(response, HTTP_OPTION_VARY);
+    if (vary && !CHPCacheVaryMatchesKey(vary))
+    {
+        return false;
+    }
+
+    // The freshness lifetime, in order of precedence (RFC 7234, 4.2.1)
+    long freshness = -1;
+    if (sharedMaxAge >= 0)
+    {
+        freshness = sharedMaxAge;
+    }
+    else if (maxAge >= 0)
+    {
+        freshness = maxAge;
+    }
+    else
+    {
+        const char *expires = CHPCacheGetHeader(response, HTTP_OPTION_EXPIRES);
+        if (expires)
+        {
+            // An invalid Expires means already expired
+            time_t expiry = curl_getdate(expires, NULL);
+            const char *date = CHPCacheGetHeader(response, HTTP_OPTION_DATE);
+            time_t origin = date ? curl_getdate(date, NULL) : -1;
+            if (origin < 0)
+            {
+                origin = now;
+            }
+            freshness = (expiry > origin) ? (long)(expiry - origin) : 0;
+        }
+    }
+
+    if (freshness < 0)
+    {
+        // Without an explicit lifetime, keep only a response which can be revalidated
+        return (NULL != CHPCacheGetHeader(response, HTTP_OPTION_ETAG));
+    }
+
+    const char *age = CHPCacheGetHeader(response, HTTP_OPTION_AGE);
+    if (age)
+    {
+        freshness -= strtol(age, NULL, 10);
+    }
+
+    if (!noCache && freshness > 0)
+    {
+        *lifetime = (freshness > (long)UINT32_MAX) ? UINT32_MAX : (uint32_t)freshness;
+    }
+    return true;
+}
+
+static bool CHPCacheCopyResponse(HttpResponse_t *dst, const HttpResponse_t *src)
+{
+    memcpy(dst, src, sizeof(HttpResponse_t));
+    dst->headerOptions = NULL;
+    dst->payload = NULL;
+
+    if (src->payloadLength)
+    {
+        dst->payload = OICMalloc(src->payloadLength);
+        if (!dst->payload)
+        {
+            return false;
+        }
+        memcpy(dst->payload, src->payload, src->payloadLength);
+    }
+
+    size_t count = u_arraylist_length(src->headerOptions);
+    if (count)
+    {
+        dst->headerOptions = u_arraylist_create();
+        if (!dst->headerOptions)
+        {
+            CHPCacheFreeResponse(dst);
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        HttpHeaderOption_t *option = u_arraylist_get(src->headerOptions, i);
+        HttpHeaderOption_t *copy = OICMalloc(sizeof(HttpHeaderOption_t));
+        if (!copy)
+        {
+            CHPCacheFreeResponse(dst);
+            return false;
+        }
+        memcpy(copy, option, sizeof(HttpHeaderOption_t));
+        if (!u_arraylist_add(dst->headerOptions, copy))
+        {
+            OICFree(copy);
+            CHPCacheFreeResponse(dst);
+            return false;
+        }
+    }
+    return true;
+}
+
+void CHPCacheFreeResponse(HttpResponse_t *response)
+{
+    VERIFY_NON_NULL_VOID(response, TAG, "response");
+
+    HttpHeaderOption_t *option = NULL;
+    while (NULL != (option = u_arraylist_remove(response->headerOptions, 0)))
+    {
+        OICFree(option);
+    }
+    u_arraylist_free(&response->headerOptions);
+    OICFree(response->payload);
+    response->payload = NULL;
+    response->payloadLength = 0;
+}
+
+static void CHPCacheFreeEntry(CHPCacheEntry_t *entry)
+{
+    CHPCacheFreeResponse(&entry->response);
+    OICFree(entry->uri);
+    OICFree(entry->acceptFormat);
+    OICFree(entry->etag);
+    OICFree(entry);
+}
+
+/*
+ * Find the entry of a request and move it first. Called with the mutex held.
+ */
+static CHPCacheEntry_t *CHPCacheFindEntry(const char *uri, const char *acceptFormat)
+{
+    CHPCacheEntry_t *previous = NULL;
+    for (CHPCacheEntry_t *entry = g_cacheEntries; entry; previous = entry, entry = entry->next)
+    {
+        if (0 == strcmp(entry->uri, uri) && 0 == strcmp(entry->acceptFormat, acceptFormat))
+        {
+            if (previous)
+            {
+                previous->next = entry->next;
+                entry->next = g_cacheEntries;
+                g_cacheEntries = entry;
+            }
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void CHPCacheRemoveEntry(CHPCacheEntry_t *removed)
+{
+    for (CHPCacheEntry_t **entry = &g_cacheEntries; *entry; entry = &(*entry)->next)
+    {
+        if (*entry == removed)
+        {
+            *entry = removed->next;
+            g_cacheCount--;
+            CHPCacheFreeEntry(removed);
+            return;
+        }
+    }
+}
+
+static void CHPCacheClear(void)
+{
+    while (g_cacheEntries)
+    {
+        CHPCacheEntry_t *entry = g_cacheEntries;
+        g_cacheEntries = entry->next;
+        CHPCacheFreeEntry(entry);
+    }
+    g_cacheCount = 0;
+}
+
+OCStackResult CHPCacheInitialize(size_t capacity)
+{
+    pthread_mutex_lock(&g_cacheMutex);
+    CHPCacheClear();
+    g_cacheCapacity = capacity;
+    memset(&g_cacheStats, 0, sizeof(g_cacheStats));
+    pthread_mutex_unlock(&g_cacheMutex);
+    return OC_STACK_OK;
+}
+
+void CHPCacheTerminate(void)
+{
+    pthread_mutex_lock(&g_cacheMutex);
+    CHPCacheClear();
+    g_cacheCapacity = 0;
+    pthread_mutex_unlock(&g_cacheMutex);
+}
+
+CHPCacheState_t CHPCacheLookup(const char *uri, const char *acceptFormat, time_t now,
+                               HttpResponse_t *response, char *validator,
+                               size_t validatorSize)
+{
+    VERIFY_NON_NULL_RET(uri, TAG, "uri", CHP_CACHE_MISS);
+    VERIFY_NON_NULL_RET(acceptFormat, TAG, "acceptFormat", CHP_CACHE_MISS);
+    VERIFY_NON_NULL_RET(response, TAG, "response", CHP_CACHE_MISS);
+
+    CHPCacheState_t state = CHP_CACHE_MISS;
+    pthread_mutex_lock(&g_cacheMutex);
+    if (!g_cacheCapacity)
+    {
+        pthread_mutex_unlock(&g_cacheMutex);
+        return CHP_CACHE_MISS;
+    }
+
+    CHPCacheEntry_t *entry = CHPCacheFindEntry(uri, acceptFormat);
+    if (entry && now < entry->expiry)
+    {
+        if (CHPCacheCopyResponse(response, &entry->response))
+        {
+            response->maxAge = (uint32_t)(entry->expiry - now);
+            state = CHP_CACHE_FRESH;
+        }
+    }
+    else if (entry && entry->etag && validator)
+    {
+        OICStrcpy(validator, validatorSize, entry->etag);
+        state = CHP_CACHE_STALE;
+    }
+    else if (entry)
+    {
+        CHPCacheRemoveEntry(entry);
+    }
+
+    if (CHP_CACHE_FRESH == state)
+    {
+        g_cacheStats.hits++;
+    }
+    else
+    {
+        g_cacheStats.misses++;
+    }
+    pthread_mutex_unlock(&g_cacheMutex);
+
+    OIC_LOG_V(DEBUG, TAG, "%s %s: %d", __func__, uri, state);
+    return state;
+}
+
+OCStackResult CHPCacheStore(const char *uri, const char *acceptFormat,
+                            const HttpResponse_t *response, time_t now)
+{
+    VERIFY_NON_NULL_RET(uri, TAG, "uri", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(acceptFormat, TAG, "acceptFormat", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(response, TAG, "response", OC_STACK_INVALID_PARAM);
+
+    uint32_t lifetime = 0;
+    bool storable = CHPCacheGetLifetime(response, now, &lifetime);
+
+    pthread_mutex_lock(&g_cacheMutex);
+    if (!g_cacheCapacity)
+    {
+        pthread_mutex_unlock(&g_cacheMutex);
+        return OC_STACK_NOTIMPL;
+    }
+
+    // A new response replaces the kept one, even if it may not be kept itself
+    CHPCacheEntry_t *entry = CHPCacheFindEntry(uri, acceptFormat);
+    if (entry)
+    {
+        CHPCacheRemoveEntry(entry);
+    }
+    if (!storable || response->payloadLength > CHP_CACHE_MAX_PAYLOAD_SIZE)
+    {
+        pthread_mutex_unlock(&g_cacheMutex);
+        return OC_STACK_NOTIMPL;
+    }
+
+    entry = OICCalloc(1, sizeof(CHPCacheEntry_t));
+    const char *etag = CHPCacheGetHeader(response, HTTP_OPTION_ETAG);
+    if (!entry || !(entry->uri = OICStrdup(uri)) ||
+        !(entry->acceptFormat = OICStrdup(acceptFormat)) ||
+        (etag && !(entry->etag = OICStrdup(etag))) ||
+        !CHPCacheCopyResponse(&entry->response, response))
+    {
+        OIC_LOG(ERROR, TAG, "Memory failed!");
+        if (entry)
+        {
+            OICFree(entry->uri);
+            OICFree(entry->acceptFormat);
+            OICFree(entry->etag);
+            OICFree(entry);
+        }
+        pthread_mutex_unlock(&g_cacheMutex);
+        return OC_STACK_NO_MEMORY;
+    }
+    entry->expiry = now + lifetime;
+    entry->next = g_cacheEntries;
+    g_cacheEntries = entry;
+    g_cacheCount++;
+
+    // Drop the least recently used response
+    if (g_cacheCount > g_cacheCapacity)
+    {
+        CHPCacheEntry_t *last = g_cacheEntries;
+        while (last->next)
+        {
+            last = last->next;
+        }
+        CHPCacheRemoveEntry(last);
+    }
+    pthread_mutex_unlock(&g_cacheMutex);
+
+    OIC_LOG_V(DEBUG, TAG, "%s %s for %u seconds", __func__, uri, lifetime);
+    return OC_STACK_OK;
+}
+
+OCStackResult CHPCacheRevalidate(const char *uri, const char *acceptFormat,
+                                 const HttpResponse_t *notModified, time_t now,
+                                 HttpResponse_t *response)
+{
+    VERIFY_NON_NULL_RET(uri, TAG, "uri", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(acceptFormat, TAG, "acceptFormat", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(notModified, TAG, "notModified", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(response, TAG, "response", OC_STACK_INVALID_PARAM);
+
+    pthread_mutex_lock(&g_cacheMutex);
+    CHPCacheEntry_t *entry = CHPCacheFindEntry(uri, acceptFormat);
+    if (!entry)
+    {
+        // The response was dropped while it was revalidated
+        pthread_mutex_unlock(&g_cacheMutex);
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    // The freshness of the 304 response applies to the kept one (RFC 7234, 4.3.4), or
+    // the kept one gets its lifetime again
+    HttpResponse_t validated = *notModified;
+    validated.status = CHP_SUCCESS;
+    if (!CHPCacheGetHeader(notModified, HTTP_OPTION_CACHE_CONTROL) &&
+        !CHPCacheGetHeader(notModified, HTTP_OPTION_EXPIRES))
+    {
+        validated = entry->response;
+    }
+    uint32_t lifetime = 0;
+    if (!CHPCacheGetLifetime(&validated, now, &lifetime))
+    {
+        lifetime = 0;
+    }
+    entry->expiry = now + lifetime;
+
+    OCStackResult result = OC_STACK_NO_MEMORY;
+    if (CHPCacheCopyResponse(response, &entry->response))
+    {
+        response->maxAge = lifetime;
+        g_cacheStats.revalidated++;
+        result = OC_STACK_OK;
+    }
+    pthread_mutex_unlock(&g_cacheMutex);
+    return result;
+}
+
+void CHPCacheGetStats(CHPCacheStats_t *stats)
+{
+    VERIFY_NON_NULL_VOID(stats, TAG, "stats");
+    pthread_mutex_lock(&g_cacheMutex);
+    *stats = g_cacheStats;
+    pthread_mutex_unlock(&g_cacheMutex);
+}
@@ -0,0 +1,1118 @@
+/* ****************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CoapHttpCbor.h"
+#include "CoapHttpParser.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "experimental/logger.h"
+
+#define TAG "CHP_CBOR"
+
+/* CBOR major types (RFC 7049, 2.1) */
+#define CBOR_UNSIGNED_INTEGER   0
+#define CBOR_NEGATIVE_INTEGER   1
+#define CBOR_BYTE_STRING        2
+#define CBOR_TEXT_STRING        3
+#define CBOR_ARRAY              4
+#define CBOR_MAP                5
+#define CBOR_TAG                6
+#define CBOR_SIMPLE             7
+
+#define CBOR_FALSE              0xF4
+#define CBOR_TRUE               0xF5
+#define CBOR_NULL               0xF6
+#define CBOR_DOUBLE             0xFB
+#define CBOR_INDEFINITE         31
+
+/* Longest JSON number translated without allocation */
+#define MAX_NUMBER_LENGTH       64
+
+/**
+ * Growing output buffer.
+ */
+typedef struct
+{
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+} CHPBuffer_t;
+
+static bool CHPBufferReserve(CHPBuffer_t *buffer, size_t extra)
+{
+    if (buffer->length + extra <= buffer->capacity)
+    {
+        return true;
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (capacity < buffer->length + extra)
+    {
+        capacity *= 2;
+    }
+    uint8_t *data = OICRealloc(buffer->data, capacity);
+    if (!data)
+    {
+        OIC_LOG(ERROR, TAG, "Memory failed!");
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static bool CHPBufferAppend(CHPBuffer_t *buffer, const void *data, size_t length)
+{
+    if (!CHPBufferReserve(buffer, length))
+    {
+        return false;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return true;
+}
+
+static bool CHPBufferAppendByte(CHPBuffer_t *buffer, uint8_t byte)
+{
+    if (!CHPBufferReserve(buffer, 1))
+    {
+        return false;
+    }
+    buffer->data[buffer->length++] = byte;
+    return true;
+}
+
+/*
+ * JSON to CBOR
+ */
+
+static size_t CHPCborHeadSize(uint64_t value)
+{
+    if (value < 24)
+    {
+        return 1;
+    }
+    else if (value <= UINT8_MAX)
+    {
+        return 2;
+    }
+    else if (value <= UINT16_MAX)
+    {
+        return 3;
+    }
+    else if (value <= UINT32_MAX)
+    {
+        return 5;
+    }
+    return 9;
+}
+
+static void CHPCborWriteHeadAt(uint8_t *out, uint8_t major, uint64_t value, size_t size)
+{
+    static const uint8_t additional[] = { 0, 0, 24, 25, 0, 26, 0, 0, 0, 27 };
+    if (1 == size)
+    {
+        out[0] = (uint8_t)((major << 5) | value);
+        return;
+    }
+    out[0] = (uint8_t)((major << 5) | additional[size]);
+    for (size_t i = size - 1; i > 0; i--)
+    {
+        out[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+static bool CHPCborWriteHead(CHPBuffer_t *out, uint8_t major, uint64_t value)
+{
+    size_t size = CHPCborHeadSize(value);
+    if (!CHPBufferReserve(out, size))
+    {
+        return false;
+    }
+    CHPCborWriteHeadAt(out->data + out->length, major, value, size);
+    out->length += size;
+    return true;
+}
+
+static int CHPHexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool CHPJsonReadHex4(const char *p, const char *end, uint32_t *value)
+{
+    if (end - p < 4)
+    {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int digit = CHPHexValue(p[i]);
+        if (digit < 0)
+        {
+            return false;
+        }
+        *value = (*value << 4) | (uint32_t)digit;
+    }
+    return true;
+}
+
+static size_t CHPUtf8Encode(uint32_t codePoint, uint8_t *out)
+{
+    if (codePoint < 0x80)
+    {
+        out[0] = (uint8_t)codePoint;
+        return 1;
+    }
+    else if (codePoint < 0x800)
+    {
+        out[0] = (uint8_t)(0xC0 | (codePoint >> 6));
+        out[1] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    else if (codePoint < 0x10000)
+    {
+        out[0] = (uint8_t)(0xE0 | (codePoint >> 12));
+        out[1] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    out[0] = (uint8_t)(0xF0 | (codePoint >> 18));
+    out[1] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+    out[2] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+    out[3] = (uint8_t)(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+/*
+ * Translate the JSON string at *p to a CBOR text string. The decoded string is never
+ * longer than the escaped one, so it is decoded in place after a head sized for the
+ * escaped length, and moved back if its head is shorter.
+ */
+static bool CHPJsonTranslateString(const char **p, const char *end, CHPBuffer_t *out)
+{
+    const char *start = *p + 1;
+    const char *q = start;
+    bool escaped = false;
+    while (q < end && *q != '"')
+    {
+        if (*q == '\\')
+        {
+            escaped = true;
+            q++;
+        }
+        else if ((uint8_t)*q < 0x20)
+        {
+            return false;
+        }
+        q++;
+    }
+    if (q >= end)
+    {
+        return false;
+    }
+    size_t rawLength = (size_t)(q - start);
+    *p = q + 1;
+
+    if (!escaped)
+    {
+        return CHPCborWriteHead(out, CBOR_TEXT_STRING, rawLength) &&
+               CHPBufferAppend(out, start, rawLength);
+    }
+
+    size_t reserved = CHPCborHeadSize(rawLength);
+    if (!CHPBufferReserve(out, reserved + rawLength))
+    {
+        return false;
+    }
+    size_t headOffset = out->length;
+    uint8_t *decoded = out->data + headOffset + reserved;
+    size_t length = 0;
+    for (const char *c = start; c < q; c++)
+    {
+        if (*c != '\\')
+        {
+            decoded[length++] = (uint8_t)*c;
+            continue;
+        }
+
+        c++;
+        switch (*c)
+        {
+            case '"':  decoded[length++] = '"';  break;
+            case '\\': decoded[length++] = '\\'; break;
+            case '/':  decoded[length++] = '/';  break;
+            case 'b':  decoded[length++] = '\b'; break;
+            case 'f':  decoded[length++] = '\f'; break;
+            case 'n':  decoded[length++] = '\n'; break;
+            case 'r':  decoded[length++] = '\r'; break;
+            case 't':  decoded[length++] = '\t'; break;
+            case 'u':
+            {
+                uint32_t codePoint = 0;
+                if (!CHPJsonReadHex4(c + 1, q, &codePoint))
+                {
+                    return false;
+                }
+                c += 4;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+                {
+                    // A high surrogate is followed by the low one
+                    uint32_t low = 0;
+                    if (q - c < 7 || c[1] != '\\' || c[2] != 'u' ||
+                        !CHPJsonReadHex4(c + 3, q, &low) || low < 0xDC00 || low > 0xDFFF)
+                    {
+                        return false;
+                    }
+                    c += 6;
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+                {
+                    return false;
+                }
+                length += CHPUtf8Encode(codePoint, decoded + length);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    size_t size = CHPCborHeadSize(length);
+    if (size < reserved)
+    {
+        memmove(out->data + headOffset + size, decoded, length);
+    }
+    CHPCborWriteHeadAt(out->data + headOffset, CBOR_TEXT_STRING, length, size);
+    out->length = headOffset + size + length;
+    return true;
+}
+
+static bool CHPJsonTranslateNumber(const char **p, const char *end, CHPBuffer_t *out)
+{
+    const char *start = *p;
+    const char *q = start;
+    bool negative = false;
+    if (q < end && *q == '-')
+    {
+        negative = true;
+        q++;
+    }
+
+    // Integer part, without leading zeros
+    if (q >= end || *q < '0' || *q > '9')
+    {
+        return false;
+    }
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    if (*q == '0')
+    {
+        q++;
+    }
+    else
+    {
+        for (; q < end && *q >= '0' && *q <= '9'; q++)
+        {
+            uint64_t digit = (uint64_t)(*q - '0');
+            if (magnitude > (UINT64_MAX - digit) / 10)
+            {
+                overflow = true;
+            }
+            magnitude = magnitude * 10 + digit;
+        }
+    }
+
+    bool integer = true;
+    if (q < end && *q == '.')
+    {
+        integer = false;
+        q++;
+        if (q >= end || *q < '0' || *q > '9')
+        {
+            return false;
+        }
+        while (q < end && *q >= '0' && *q <= '9')
+        {
+            q++;
+        }
+    }
+    if (q < end && (*q == 'e' || *q == 'E'))
+    {
+        integer = false;
+        q++;
+        if (q < end && (*q == '+' || *q == '-'))
+        {
+            q++;
+        }
+        if (q >= end || *q < '0' || *q > '9')
+        {
+            return false;
+        }
+        while (q < end && *q >= '0' && *q <= '9')
+        {
+            q++;
+        }
+    }
+    *p = q;
+
+    if (integer && !overflow)
+    {
+        if (!negative)
+        {
+            return CHPCborWriteHead(out, CBOR_UNSIGNED_INTEGER, magnitude);
+        }
+        else if (magnitude == 0)
+        {
+            // -0
+            return CHPCborWriteHead(out, CBOR_UNSIGNED_INTEGER, 0);
+        }
+        return CHPCborWriteHead(out, CBOR_NEGATIVE_INTEGER, magnitude - 1);
+    }
+
+    // strtod() needs a NUL terminated number
+    size_t length = (size_t)(q - start);
+    char number[MAX_NUMBER_LENGTH];
+    char *copy = (length < sizeof(number)) ? number : OICMalloc(length + 1);
+    if (!copy)
+    {
+        return false;
+    }
+    memcpy(copy, start, length);
+    copy[length] = '\0';
+    double value = strtod(copy, NULL);
+    if (copy != number)
+    {
+        OICFree(copy);
+    }
+
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    if (!CHPBufferReserve(out, 9))
+    {
+        return false;
+    }
+    CHPCborWriteHeadAt(out->data + out->length, CBOR_SIMPLE, bits, 9);
+    out->length += 9;
+    return true;
+}
+
+static bool CHPJsonMatchLiteral(const char **p, const char *end, const char *literal)
+{
+    size_t length = strlen(literal);
+    if ((size_t)(end - *p) < length || 0 != memcmp(*p, literal, length))
+    {
+        return false;
+    }
+    *p += length;
+    return true;
+}
+
+/**
+ * Open JSON array or object.
+ */
+typedef struct
+{
+    /* Offset of the one byte head, patched when the container is closed */
+    size_t headOffset;
+    uint64_t count;
+    bool isMap;
+} CHPJsonContainer_t;
+
+typedef enum
+{
+    JSON_EXPECT_VALUE = 0,
+    JSON_EXPECT_VALUE_OR_END,
+    JSON_EXPECT_KEY,
+    JSON_EXPECT_KEY_OR_END,
+    JSON_EXPECT_COLON,
+    JSON_EXPECT_SEPARATOR,
+    JSON_DONE
+} CHPJsonState_t;
+
+/*
+ * Close a container: its head gets the number of items, and the items are moved if
+ * the head is longer than the one byte reserved.
+ */
+static bool CHPJsonCloseContainer(const CHPJsonContainer_t *container, CHPBuffer_t *out)
+{
+    size_t size = CHPCborHeadSize(container->count);
+    if (size > 1)
+    {
+        if (!CHPBufferReserve(out, size - 1))
+        {
+            return false;
+        }
+        memmove(out->data + container->headOffset + size,
+                out->data + container->headOffset + 1,
+                out->length - container->headOffset - 1);
+        out->length += size - 1;
+    }
+    CHPCborWriteHeadAt(out->data + container->headOffset,
+                       container->isMap ? CBOR_MAP : CBOR_ARRAY, container->count, size);
+    return true;
+}
+
+OCStackResult CHPJsonToCbor(const char *json, size_t jsonLength,
+                            uint8_t **cbor, size_t *cborLength)
+{
+    VERIFY_NON_NULL_RET(json, TAG, "json", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(cbor, TAG, "cbor", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(cborLength, TAG, "cborLength", OC_STACK_INVALID_PARAM);
+
+    // A CBOR document is seldom longer than its JSON text
+    CHPBuffer_t out = { NULL, 0, 0 };
+    if (!CHPBufferReserve(&out, jsonLength + 16))
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    CHPJsonContainer_t stack[CHP_MAX_NESTING_DEPTH];
+    size_t depth = 0;
+    CHPJsonState_t state = JSON_EXPECT_VALUE;
+    const char *p = json;
+    const char *end = json + jsonLength;
+    bool ok = true;
+
+    while (ok)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        {
+            p++;
+        }
+        if (p >= end)
+        {
+            break;
+        }
+
+        bool valueDone = false;
+        bool close = false;
+        switch (state)
+        {
+            case JSON_EXPECT_VALUE_OR_END:
+                if (*p == ']')
+                {
+                    close = true;
+                    break;
+                }
+                // fall through
+            case JSON_EXPECT_VALUE:
+                if (*p == '{' || *p == '[')
+                {
+                    if (depth >= CHP_MAX_NESTING_DEPTH)
+                    {
+                        OIC_LOG(ERROR, TAG, "JSON document nested too deeply");
+                        ok = false;
+                        break;
+                    }
+                    stack[depth].headOffset = out.length;
+                    stack[depth].count = 0;
+                    stack[depth].isMap = (*p == '{');
+                    state = stack[depth].isMap ? JSON_EXPECT_KEY_OR_END : JSON_EXPECT_VALUE_OR_END;
+                    depth++;
+                    p++;
+                    // One byte head, patched on close
+                    ok = CHPBufferAppendByte(&out, 0);
+                }
+                else if (*p == '"')
+                {
+                    ok = valueDone = CHPJsonTranslateString(&p, end, &out);
+                }
+                else if (*p == '-' || (*p >= '0' && *p <= '9'))
+                {
+                    ok = valueDone = CHPJsonTranslateNumber(&p, end, &out);
+                }
+                else if (CHPJsonMatchLiteral(&p, end, "true"))
+                {
+                    ok = valueDone = CHPBufferAppendByte(&out, CBOR_TRUE);
+                }
+                else if (CHPJsonMatchLiteral(&p, end, "false"))
+                {
+                    ok = valueDone = CHPBufferAppendByte(&out, CBOR_FALSE);
+                }
+                else if (CHPJsonMatchLiteral(&p, end, "null"))
+                {
+                    ok = valueDone = CHPBufferAppendByte(&out, CBOR_NULL);
+                }
+                else
+                {
+                    ok = false;
+                }
+                break;
+            case JSON_EXPECT_KEY_OR_END:
+                if (*p == '}')
+                {
+                    close = true;
+                    break;
+                }
+                // fall through
+            case JSON_EXPECT_KEY:
+                ok = (*p == '"') && CHPJsonTranslateString(&p, end, &out);
+                state = JSON_EXPECT_COLON;
+                break;
+            case JSON_EXPECT_COLON:
+                ok = (*p == ':');
+                p++;
+                state = JSON_EXPECT_VALUE;
+                break;
+            case JSON_EXPECT_SEPARATOR:
+                if (*p == ',')
+                {
+                    p++;
+                    state = stack[depth - 1].isMap ? JSON_EXPECT_KEY : JSON_EXPECT_VALUE;
+                }
+                else if (*p == (stack[depth - 1].isMap ? '}' : ']'))
+                {
+                    close = true;
+                }
+                else
+                {
+                    ok = false;
+                }
+                break;
+            case JSON_DONE:
+                // Trailing characters
+                ok = false;
+                break;
+        }
+
+        if (ok && close)
+        {
+            p++;
+            depth--;
+            ok = valueDone = CHPJsonCloseContainer(&stack[depth], &out);
+        }
+        if (ok && valueDone)
+        {
+            if (depth)
+            {
+                stack[depth - 1].count++;
+                state = JSON_EXPECT_SEPARATOR;
+            }
+            else
+            {
+                state = JSON_DONE;
+            }
+        }
+    }
+
+    if (!ok || JSON_DONE != state)
+    {
+        OIC_LOG_V(ERROR, TAG, "Invalid JSON document at offset %" PRIuPTR,
+                  (size_t)(p - json));
+        OICFree(out.data);
+        return OC_STACK_MALFORMED_RESPONSE;
+    }
+
+    *cbor = out.data;
+    *cborLength = out.length;
+    return OC_STACK_OK;
+}
+
+/*
+ * CBOR to JSON
+ */
+
+static bool CHPCborReadHead(const uint8_t **p, const uint8_t *end, uint8_t *major,
+                            uint8_t *info, uint64_t *value)
+{
+    if (*p >= end)
+    {
+        return false;
+    }
+    *major = (uint8_t)(**p >> 5);
+    *info = (uint8_t)(**p & 0x1F);
+    (*p)++;
+
+    size_t size = 0;
+    if (*info < 24)
+    {
+        *value = *info;
+        return true;
+    }
+    switch (*info)
+    {
+        case 24: size = 1; break;
+        case 25: size = 2; break;
+        case 26: size = 4; break;
+        case 27: size = 8; break;
+        case CBOR_INDEFINITE:
+            *value = 0;
+            return (*major >= CBOR_BYTE_STRING && *major <= CBOR_MAP) || *major == CBOR_SIMPLE;
+        default:
+            return false;
+    }
+    if ((size_t)(end - *p) < size)
+    {
+        return false;
+    }
+    *value = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        *value = (*value << 8) | (*p)[i];
+    }
+    *p += size;
+    return true;
+}
+
+static bool CHPJsonAppendText(CHPBuffer_t *out, const char *text)
+{
+    return CHPBufferAppend(out, text, strlen(text));
+}
+
+/* Append the characters of a string, escaped */
+static bool CHPJsonAppendEscaped(CHPBuffer_t *out, const uint8_t *text, size_t length)
+{
+    // Most strings have nothing to escape
+    if (!CHPBufferReserve(out, length))
+    {
+        return false;
+    }
+
+    const uint8_t *run = text;
+    for (size_t i = 0; i < length; i++)
+    {
+        uint8_t c = text[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        if (!CHPBufferAppend(out, run, (size_t)(text + i - run)))
+        {
+            return false;
+        }
+        run = text + i + 1;
+
+        char escape[8];
+        switch (c)
+        {
+            case '"':  OICStrcpy(escape, sizeof(escape), "\\\""); break;
+            case '\\': OICStrcpy(escape, sizeof(escape), "\\\\"); break;
+            case '\b': OICStrcpy(escape, sizeof(escape), "\\b");  break;
+            case '\f': OICStrcpy(escape, sizeof(escape), "\\f");  break;
+            case '\n': OICStrcpy(escape, sizeof(escape), "\\n");  break;
+            case '\r': OICStrcpy(escape, sizeof(escape), "\\r");  break;
+            case '\t': OICStrcpy(escape, sizeof(escape), "\\t");  break;
+            default:
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                break;
+        }
+        if (!CHPJsonAppendText(out, escape))
+        {
+            return false;
+        }
+    }
+    return CHPBufferAppend(out, run, (size_t)(text + length - run));
+}
+
+static bool CHPJsonAppendBase64Url(CHPBuffer_t *out, const uint8_t *data, size_t length)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    if (!CHPBufferReserve(out, (length + 2) / 3 * 4 + 2))
+    {
+        return false;
+    }
+
+    uint8_t *o = out->data + out->length;
+    *o++ = '"';
+    size_t i = 0;
+    for (; i + 2 < length; i += 3)
+    {
+        uint32_t triple = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        *o++ = alphabet[(triple >> 18) & 0x3F];
+        *o++ = alphabet[(triple >> 12) & 0x3F];
+        *o++ = alphabet[(triple >> 6) & 0x3F];
+        *o++ = alphabet[triple & 0x3F];
+    }
+    if (i < length)
+    {
+        uint32_t triple = (uint32_t)data[i] << 16;
+        if (i + 1 < length)
+        {
+            triple |= (uint32_t)data[i + 1] << 8;
+        }
+        *o++ = alphabet[(triple >> 18) & 0x3F];
+        *o++ = alphabet[(triple >> 12) & 0x3F];
+        if (i + 1 < length)
+        {
+            *o++ = alphabet[(triple >> 6) & 0x3F];
+        }
+    }
+    *o++ = '"';
+    out->length = (size_t)(o - out->data);
+    return true;
+}
+
+static bool CHPJsonAppendDouble(CHPBuffer_t *out, double value)
+{
+    if (isnan(value) || isinf(value))
+    {
+        return CHPJsonAppendText(out, "null");
+    }
+
+    // The shortest form which reads back as the same value
+    char number[32];
+    snprintf(number, sizeof(number), "%.15g", value);
+    if (strtod(number, NULL) != value)
+    {
+        snprintf(number, sizeof(number), "%.17g", value);
+    }
+    return CHPJsonAppendText(out, number);
+}
+
+static double CHPHalfToDouble(uint16_t half)
+{
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0)
+    {
+        value = ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        value = (mantissa == 0) ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+/*
+ * Append a string item, definite or made of definite chunks. Byte strings are
+ * gathered before they are encoded.
+ */
+static bool CHPCborTranslateString(const uint8_t **p, const uint8_t *end, uint8_t major,
+                                   uint8_t info, uint64_t length, CHPBuffer_t *out)
+{
+    if (CBOR_INDEFINITE != info)
+    {
+        if ((uint64_t)(end - *p) < length)
+        {
+            return false;
+        }
+        const uint8_t *data = *p;
+        *p += length;
+        if (CBOR_BYTE_STRING == major)
+        {
+            return CHPJsonAppendBase64Url(out, data, (size_t)length);
+        }
+        return CHPBufferAppendByte(out, '"') &&
+               CHPJsonAppendEscaped(out, data, (size_t)length) &&
+               CHPBufferAppendByte(out, '"');
+    }
+
+    CHPBuffer_t bytes = { NULL, 0, 0 };
+    bool ok = (CBOR_BYTE_STRING == major) || CHPBufferAppendByte(out, '"');
+    while (ok)
+    {
+        uint8_t chunkMajor = 0;
+        uint8_t chunkInfo = 0;
+        uint64_t chunkLength = 0;
+        ok = CHPCborReadHead(p, end, &chunkMajor, &chunkInfo, &chunkLength);
+        if (ok && CBOR_SIMPLE == chunkMajor && CBOR_INDEFINITE == chunkInfo)
+        {
+            break;
+        }
+        ok = ok && chunkMajor == major && chunkInfo != CBOR_INDEFINITE &&
+             (uint64_t)(end - *p) >= chunkLength;
+        if (ok)
+        {
+            ok = (CBOR_BYTE_STRING == major) ?
+                 CHPBufferAppend(&bytes, *p, (size_t)chunkLength) :
+                 CHPJsonAppendEscaped(out, *p, (size_t)chunkLength);
+            *p += chunkLength;
+        }
+    }
+
+    if (ok)
+    {
+        ok = (CBOR_BYTE_STRING == major) ? CHPJsonAppendBase64Url(out, bytes.data, bytes.length)
+                                         : CHPBufferAppendByte(out, '"');
+    }
+    OICFree(bytes.data);
+    return ok;
+}
+
+/**
+ * Open CBOR array or map.
+ */
+typedef struct
+{
+    /* Items, or pairs, left in a definite container */
+    uint64_t remaining;
+    bool indefinite;
+    bool isMap;
+    /* The next item of a map is a key */
+    bool key;
+    bool first;
+} CHPCborContainer_t;
+
+OCStackResult CHPCborToJson(const uint8_t *cbor, size_t cborLength,
+                            char **json, size_t *jsonLength)
+{
+    VERIFY_NON_NULL_RET(cbor, TAG, "cbor", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(json, TAG, "json", OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL_RET(jsonLength, TAG, "jsonLength", OC_STACK_INVALID_PARAM);
+
+    // A JSON text is usually somewhat longer than its CBOR document
+    CHPBuffer_t out = { NULL, 0, 0 };
+    if (!CHPBufferReserve(&out, cborLength + cborLength / 2 + 16))
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    CHPCborContainer_t stack[CHP_MAX_NESTING_DEPTH];
+    size_t depth = 0;
+    const uint8_t *p = cbor;
+    const uint8_t *end = cbor + cborLength;
+    bool ok = true;
+    bool done = false;
+
+    while (ok && !done)
+    {
+        CHPCborContainer_t *container = depth ? &stack[depth - 1] : NULL;
+        if (container && !container->indefinite && 0 == container->remaining)
+        {
+            ok = CHPBufferAppendByte(&out, container->isMap ? '}' : ']');
+            depth--;
+        }
+        else
+        {
+            uint8_t major = 0;
+            uint8_t info = 0;
+            uint64_t value = 0;
+            ok = CHPCborReadHead(&p, end, &major, &info, &value);
+            // Tags are dropped, the tagged item is translated
+            while (ok && CBOR_TAG == major)
+            {
+                ok = CHPCborReadHead(&p, end, &major, &info, &value);
+            }
+            if (!ok)
+            {
+                break;
+            }
+
+            if (CBOR_SIMPLE == major && CBOR_INDEFINITE == info)
+            {
+                // End of an indefinite container, not between a key and its value
+                ok = container && container->indefinite && (!container->isMap || container->key);
+                if (ok)
+                {
+                    ok = CHPBufferAppendByte(&out, container->isMap ? '}' : ']');
+                    depth--;
+                }
+            }
+            else if (container && container->isMap && container->key)
+            {
+                if (!container->first)
+                {
+                    ok = CHPBufferAppendByte(&out, ',');
+                }
+                container->first = false;
+                container->key = false;
+
+                char number[32];
+                if (CBOR_TEXT_STRING == major)
+                {
+                    ok = ok && CHPCborTranslateString(&p, end, major, info, value, &out);
+                }
+                else if (CBOR_UNSIGNED_INTEGER == major)
+                {
+                    snprintf(number, sizeof(number), "\"%" PRIu64 "\"", value);
+                    ok = ok && CHPJsonAppendText(&out, number);
+                }
+                else if (CBOR_NEGATIVE_INTEGER == major && value < INT64_MAX)
+                {
+                    snprintf(number, sizeof(number), "\"%" PRId64 "\"", -(int64_t)value - 1);
+                    ok = ok && CHPJsonAppendText(&out, number);
+                }
+                else
+                {
+                    OIC_LOG_V(ERROR, TAG, "Unsupported map key of type %d", major);
+                    ok = false;
+                }
+                ok = ok && CHPBufferAppendByte(&out, ':');
+                // The value completes the pair
+                continue;
+            }
+            else
+            {
+                if (container && !container->isMap)
+                {
+                    if (!container->first)
+                    {
+                        ok = CHPBufferAppendByte(&out, ',');
+                    }
+                    container->first = false;
+                }
+
+                char number[32];
+                bool item = true;
+                switch (major)
+                {
+                    case CBOR_UNSIGNED_INTEGER:
+                        snprintf(number, sizeof(number), "%" PRIu64, value);
+                        ok = ok && CHPJsonAppendText(&out, number);
+                        break;
+                    case CBOR_NEGATIVE_INTEGER:
+                        if (value < INT64_MAX)
+                        {
+                            snprintf(number, sizeof(number), "%" PRId64, -(int64_t)value - 1);
+                        }
+                        else if (value < UINT64_MAX)
+                        {
+                            snprintf(number, sizeof(number), "-%" PRIu64, value + 1);
+                        }
+                        else
+                        {
+                            OICStrcpy(number, sizeof(number), "-18446744073709551616");
+                        }
+                        ok = ok && CHPJsonAppendText(&out, number);
+                        break;
+                    case CBOR_BYTE_STRING:
+                    case CBOR_TEXT_STRING:
+                        ok = ok && CHPCborTranslateString(&p, end, major, info, value, &out);
+                        break;
+                    case CBOR_ARRAY:
+                    case CBOR_MAP:
+                        if (depth >= CHP_MAX_NESTING_DEPTH)
+                        {
+                            OIC_LOG(ERROR, TAG, "CBOR document nested too deeply");
+                            ok = false;
+                            break;
+                        }
+                        stack[depth].remaining = value;
+                        stack[depth].indefinite = (CBOR_INDEFINITE == info);
+                        stack[depth].isMap = (CBOR_MAP == major);
+                        stack[depth].key = true;
+                        stack[depth].first = true;
+                        depth++;
+                        ok = ok && CHPBufferAppendByte(&out, (CBOR_MAP == major) ? '{' : '[');
+                        // The container is an item of its parent once it is closed
+                        item = false;
+                        break;
+                    case CBOR_SIMPLE:
+                        if (20 == info)
+                        {
+                            ok = ok && CHPJsonAppendText(&out, "false");
+                        }
+                        else if (21 == info)
+                        {
+                            ok = ok && CHPJsonAppendText(&out, "true");
+                        }
+                        else if (25 == info)
+                        {
+                            ok = ok && CHPJsonAppendDouble(&out, CHPHalfToDouble((uint16_t)value));
+                        }
+                        else if (26 == info)
+                        {
+                            uint32_t bits = (uint32_t)value;
+                            float single = 0;
+                            memcpy(&single, &bits, sizeof(single));
+                            ok = ok && CHPJsonAppendDouble(&out, single);
+                        }
+                        else if (27 == info)
+                        {
+                            double number = 0;
+                            memcpy(&number, &value, sizeof(number));
+                            ok = ok && CHPJsonAppendDouble(&out, number);
+                        }
+                        else
+                        {
+                            // null, undefined and the other simple values
+                            ok = ok && CHPJsonAppendText(&out, "null");
+                        }
+                        break;
+                    default:
+                        ok = false;
+                        break;
+                }
+
+                if (!item)
+                {
+                    continue;
+                }
+            }
+        }
+
+        // An item, or a container, has been completed
+        if (ok)
+        {
+            if (depth)
+            {
+                CHPCborContainer_t *parent = &stack[depth - 1];
+                if (parent->isMap)
+                {
+                    parent->key = true;
+                }
+                if (!parent->indefinite)
+                {
+                    parent->remaining--;
+                }
+                if (!parent->isMap)
+                {
+                    parent->first = false;
+                }
+            }
+            else
+            {
+                done = true;
+            }
+        }
+    }
+
+    if (!ok || p != end || !CHPBufferAppendByte(&out, '\0'))
+    {
+        OIC_LOG_V(ERROR, TAG, "Invalid CBOR document at offset %" PRIuPTR,
+                  (size_t)(p - cbor));
+        OICFree(out.data);
+        return OC_STACK_MALFORMED_RESPONSE;
+    }
+
+    *json = (char *)out.data;
+    *jsonLength = out.length - 1;
+    return OC_STACK_OK;
+}
@@ -29,7 +29,7 @@
 #include "uarraylist.h"
 #include "CoapHttpParser.h"
 #include "CoapHttpMap.h"
-#include "cJSON.h"
+#include "CoapHttpCbor.h"
 
 #define TAG "CHPHandler"
 
@@ -313,6 +313,7 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
     }
 
     // ctxt not required now.
+    OCMethod method = ctxt->method;
     OICFree(ctxt);
 
     if (httpResponse->dataFormat[0] != '\0')
@@ -336,34 +337,31 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
                 }
                 break;
             case OC_FORMAT_JSON:
+            {
                 OIC_LOG(DEBUG, TAG, "Payload format is JSON");
-                cJSON *payloadJson = cJSON_Parse((char *)httpResponse->payload);
-                if (!payloadJson)
+                // Translated to CBOR token by token, then parsed as a CBOR payload
+                uint8_t *cbor = NULL;
+                size_t cborLength = 0;
+                result = CHPJsonToCbor((const char *)httpResponse->payload,
+                                       httpResponse->payloadLength, &cbor, &cborLength);
+                if (result == OC_STACK_OK)
                 {
-                    OIC_LOG(ERROR, TAG, "Unable to parse json response");
-                    response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
-                    if (OCDoResponse(&response) != OC_STACK_OK)
-                    {
-                        OIC_LOG(ERROR, TAG, "Error sending response");
-                    }
-                    return;
+                    result = OCParsePayload(&response.payload, OC_FORMAT_CBOR,
+                                            PAYLOAD_TYPE_REPRESENTATION, cbor, cborLength);
                 }
-                OCRepPayload* payloadCbor = OCRepPayloadCreate();
-                if (!payloadCbor)
+                OICFree(cbor);
+                if (result != OC_STACK_OK)
                 {
+                    OIC_LOG(ERROR, TAG, "Unable to parse json response");
                     response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
                     if (OCDoResponse(&response) != OC_STACK_OK)
                     {
                         OIC_LOG(ERROR, TAG, "Error sending response");
                     }
-                    cJSON_Delete(payloadJson);
                     return;
                 }
-
-                CHPJsonToRepPayload(payloadJson, payloadCbor);
-                response.payload = (OCPayload *)payloadCbor;
-                cJSON_Delete(payloadJson);
                 break;
+            }
             default:
                 OIC_LOG(ERROR, TAG, "Payload format is not supported");
                 response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
@@ -391,11 +389,35 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
                                                 response.numSendVendorSpecificHeaderOptions);
             continue;
         }
+        if (COAP_OPTION_MAXAGE == optionsPointer->optionID)
+        {
+            // Cache-Control and Expires are translated below
+            continue;
+        }
 
         response.numSendVendorSpecificHeaderOptions++;
         optionsPointer += 1;
     }
 
+    // Max-Age of the response: the freshness left of the HTTP response, in seconds.
+    // Without the option, a CoAP client would reuse the response for 60 seconds.
+    if (OC_REST_GET == method && response.numSendVendorSpecificHeaderOptions < MAX_HEADER_OPTIONS)
+    {
+        memset(optionsPointer, 0, sizeof(OCHeaderOption));
+        optionsPointer->protocolID = OC_COAP_ID;
+        optionsPointer->optionID = COAP_OPTION_MAXAGE;
+        for (uint32_t maxAge = httpResponse->maxAge; maxAge; maxAge >>= 8)
+        {
+            optionsPointer->optionLength++;
+        }
+        for (uint16_t i = 0; i < optionsPointer->optionLength; i++)
+        {
+            optionsPointer->optionData[i] = (uint8_t)(httpResponse->maxAge >>
+                                            (8 * (optionsPointer->optionLength - i - 1)));
+        }
+        response.numSendVendorSpecificHeaderOptions++;
+    }
+
     if (OCDoResponse(&response) != OC_STACK_OK)
     {
         OIC_LOG(ERROR, TAG, "Error sending response");
@@ -449,9 +471,18 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
 
     if (requestInfo->payload && requestInfo->payload->type == PAYLOAD_TYPE_REPRESENTATION)
     {
-        // Conversion from cbor to json.
-        cJSON *payloadJson = CHPRepPayloadToJson((OCRepPayload *)requestInfo->payload);
-        if (!payloadJson)
+        // Conversion from cbor to json, token by token.
+        uint8_t *cbor = NULL;
+        size_t cborLength = 0;
+        char *json = NULL;
+        size_t jsonLength = 0;
+        result = OCConvertPayload(requestInfo->payload, OC_FORMAT_CBOR, &cbor, &cborLength);
+        if (OC_STACK_OK == result)
+        {
+            result = CHPCborToJson(cbor, cborLength, &json, &jsonLength);
+        }
+        OICFree(cbor);
+        if (OC_STACK_OK != result)
         {
             response.ehResult = OC_EH_BAD_REQ;
             if (OCDoResponse(&response) != OC_STACK_OK)
@@ -459,14 +490,14 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
                 OIC_LOG(ERROR, TAG, "Error sending response");
             }
 
+            u_arraylist_destroy(httpRequest.headerOptions);
             return OC_STACK_ERROR;
 
         }
-        httpRequest.payload = (void *)cJSON_Print(payloadJson);
-        httpRequest.payloadLength = strlen(httpRequest.payload);
+        httpRequest.payload = json;
+        httpRequest.payloadLength = jsonLength;
         OICStrcpy(httpRequest.payloadFormat, sizeof(httpRequest.payloadFormat),
-                  CBOR_CONTENT_TYPE);
-        cJSON_Delete(payloadJson);
+                  JSON_CONTENT_TYPE);
     }
 
     OICStrcpy(httpRequest.acceptFormat, sizeof(httpRequest.acceptFormat),
@@ -24,7 +24,9 @@
 #include <inttypes.h>
 
 #include "iotivity_config.h"
+#include "platform_features.h"
 #include "CoapHttpParser.h"
+#include "CoapHttpCache.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "uarraylist.h"
@@ -44,14 +46,18 @@
 #include <sys/select.h>
 #endif //!defined(_WIN32)
 #include <errno.h>
+#include <time.h>
 
 #define TAG "CHP_PARSER"
 
 #define DEFAULT_USER_AGENT "IoTivity"
 #define MAX_PAYLOAD_SIZE (1048576U) // 1 MB
+#define CHP_MIN_PAYLOAD_CAPACITY (4096U)
 
-typedef struct
+typedef struct CHPContext_t
 {
+    /* Next context completed from the response cache */
+    struct CHPContext_t *next;
     void* context;
     CHPResponseCallback cb;
     HttpResponse_t resp;
@@ -62,10 +68,17 @@ typedef struct
     size_t readOffset;
     /* To track multiple write_callbacks from curl */
     size_t writeOffset;
+    /* Allocated size of the response payload, grown geometrically */
+    size_t writeCapacity;
     /* libcurl related */
     CURL* easyHandle;
     /* libcurl does not copy header options passed to a request */
     struct curl_slist *list;
+    /* Cache key of a GET request, NULL if the response is not cached */
+    char *cacheUri;
+    char *cacheAccept;
+    /* ETag of the stale cached response revalidated by the request */
+    char validator[CHP_MAX_HF_DATA_LENGTH];
 } CHPContext_t;
 
 /* A curl mutihandle is not threadsafe so we require mutexes to add new easy
@@ -74,6 +87,14 @@ typedef struct
 static CURLM *g_multiHandle;
 static int g_activeConnections;
 
+/* Idle easy handles, reused to keep their DNS and TLS session caches */
+static CURL *g_easyHandlePool[CHP_EASY_HANDLE_POOL_SIZE];
+static size_t g_easyHandlePoolCount;
+
+/* Contexts completed from the response cache, to be delivered by the multi handle thread */
+static CHPContext_t *g_completedHead;
+static CHPContext_t *g_completedTail;
+
 /*  Mutex code is taken from CA.
  *  General utility functions shall be placed in common location
  *  so that all modules can use them.
@@ -112,6 +133,29 @@ static void CHPParserResetHeaderOptions(u_arraylist_t** headerOptions)
     u_arraylist_free(headerOptions);
 }
 
+/* Called with g_multiHandleMutex held */
+static CURL *CHPAcquireEasyHandle(void)
+{
+    if (g_easyHandlePoolCount)
+    {
+        return g_easyHandlePool[--g_easyHandlePoolCount];
+    }
+    return curl_easy_init();
+}
+
+/* Called with g_multiHandleMutex held */
+static void CHPReleaseEasyHandle(CURL *easyHandle)
+{
+    if (g_easyHandlePoolCount < CHP_EASY_HANDLE_POOL_SIZE && !g_terminateParser)
+    {
+        curl_easy_reset(easyHandle);
+        g_easyHandlePool[g_easyHandlePoolCount++] = easyHandle;
+        return;
+    }
+    curl_easy_cleanup(easyHandle);
+}
+
+/* Called with g_multiHandleMutex held */
 static void CHPFreeContext(CHPContext_t *ctxt)
 {
     VERIFY_NON_NULL_VOID(ctxt, TAG, "ctxt is NULL");
@@ -122,15 +166,68 @@ static void CHPFreeContext(CHPContext_t *ctxt)
 
     if(ctxt->easyHandle)
     {
-        curl_easy_cleanup(ctxt->easyHandle);
+        CHPReleaseEasyHandle(ctxt->easyHandle);
     }
 
     CHPParserResetHeaderOptions(&(ctxt->resp.headerOptions));
     OICFree(ctxt->resp.payload);
     OICFree(ctxt->payload);
+    OICFree(ctxt->cacheUri);
+    OICFree(ctxt->cacheAccept);
     OICFree(ctxt);
 }
 
+/*
+ * Keep the response to a GET request, or replace a 304 response to a revalidation with the
+ * cached response, and translate its freshness for the CoAP Max-Age.
+ */
+static void CHPUpdateResponseCache(CHPContext_t *ctxt)
+{
+    time_t now = time(NULL);
+    uint32_t lifetime = 0;
+    if (!CHPCacheGetLifetime(&ctxt->resp, now, &lifetime))
+    {
+        lifetime = 0;
+    }
+    ctxt->resp.maxAge = lifetime;
+
+    if (!ctxt->cacheUri)
+    {
+        return;
+    }
+
+    if (CHP_NOT_MODIFIED == ctxt->resp.status && ctxt->validator[0] != '\0')
+    {
+        HttpResponse_t cached;
+        if (OC_STACK_OK == CHPCacheRevalidate(ctxt->cacheUri, ctxt->cacheAccept, &ctxt->resp,
+                                              now, &cached))
+        {
+            OIC_LOG_V(DEBUG, TAG, "Cached response to %s revalidated", ctxt->cacheUri);
+            CHPCacheFreeResponse(&ctxt->resp);
+            ctxt->resp = cached;
+        }
+        return;
+    }
+
+    CHPCacheStore(ctxt->cacheUri, ctxt->cacheAccept, &ctxt->resp, now);
+}
+
+/* Called with g_multiHandleMutex held */
+static void CHPDeliverCompletedContexts(void)
+{
+    while (g_completedHead && !g_terminateParser)
+    {
+        CHPContext_t *ctxt = g_completedHead;
+        g_completedHead = ctxt->next;
+        if (!g_completedHead)
+        {
+            g_completedTail = NULL;
+        }
+        ctxt->cb(&(ctxt->resp), ctxt->context);
+        CHPFreeContext(ctxt);
+    }
+}
+
 static void *CHPParserExecuteMultiHandle(void* data)
 {
     OIC_LOG_V(DEBUG, TAG, "%s IN", __func__);
@@ -279,7 +376,12 @@ static void *CHPParserExecuteMultiHandle(void* data)
                     curl_easy_getinfo(easyHandle, CURLINFO_CONTENT_TYPE, &contentType);
 
                     ptr->resp.status = responseCode;
-                    OICStrcpy(ptr->resp.dataFormat, sizeof(ptr->resp.dataFormat), contentType);
+                    if (contentType)
+                    {
+                        OICStrcpy(ptr->resp.dataFormat, sizeof(ptr->resp.dataFormat),
+                                  contentType);
+                    }
+                    CHPUpdateResponseCache(ptr);
                     OIC_LOG_V(DEBUG, TAG, "Transfer completed %d uri: %s, %s", g_activeConnections,
                                                                            uri, contentType);
                     ptr->cb(&(ptr->resp), ptr->context);
@@ -287,6 +389,7 @@ static void *CHPParserExecuteMultiHandle(void* data)
                 }
             } while(cmsg && !g_terminateParser);
         }while (ret == CURLM_CALL_MULTI_PERFORM && !g_terminateParser);
+        CHPDeliverCompletedContexts();
         CHPParserUnlockMutex();
     }
 
@@ -409,6 +512,22 @@ static OCStackResult CHPParserInitializeMultiHandle(void)
         return OC_STACK_ERROR;
     }
 
+    /* Connections to HTTP servers are kept open in the cache of the multi handle and
+     * shared by the requests, multiplexed over HTTP/2 when the server supports it.
+     */
+#if LIBCURL_VERSION_NUM >= 0x072b00
+#if LIBCURL_VERSION_NUM < 0x073e00
+    curl_multi_setopt(g_multiHandle, CURLMOPT_PIPELINING, CURLPIPE_HTTP1 | CURLPIPE_MULTIPLEX);
+#else
+    curl_multi_setopt(g_multiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+#endif
+#if LIBCURL_VERSION_NUM >= 0x071e00
+    curl_multi_setopt(g_multiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, CHP_MAX_HOST_CONNECTIONS);
+    curl_multi_setopt(g_multiHandle, CURLMOPT_MAX_TOTAL_CONNECTIONS, CHP_MAX_CONNECTIONS);
+#endif
+    curl_multi_setopt(g_multiHandle, CURLMOPT_MAXCONNECTS, CHP_MAX_CONNECTIONS);
+
     CHPParserUnlockMutex();
     return OC_STACK_OK;
 }
@@ -423,8 +542,22 @@ static OCStackResult CHPParserTerminateMultiHandle(void)
         return OC_STACK_OK;
     }
 
+    // Contexts not delivered are dropped
+    while (g_completedHead)
+    {
+        CHPContext_t *ctxt = g_completedHead;
+        g_completedHead = ctxt->next;
+        CHPFreeContext(ctxt);
+    }
+    g_completedTail = NULL;
+
     curl_multi_cleanup(g_multiHandle);
     g_multiHandle = NULL;
+
+    while (g_easyHandlePoolCount)
+    {
+        curl_easy_cleanup(g_easyHandlePool[--g_easyHandlePoolCount]);
+    }
     CHPParserUnlockMutex();
     return OC_STACK_OK;
 }
@@ -447,6 +580,14 @@ OCStackResult CHPParserInitialize(void)
         return ret;
     }
 
+    ret = CHPCacheInitialize(CHP_CACHE_CAPACITY);
+    if(ret != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to intialize response cache: %d", ret);
+        CHPParserTerminate();
+        return ret;
+    }
+
     ret = CHPParserInitializePipe(g_shutdownFds);
     if(ret != OC_STACK_OK)
     {
@@ -496,6 +637,7 @@ OCStackResult CHPParserTerminate(void)
     {
         OIC_LOG_V(ERROR, TAG, "Multi handle termination failed: %d", ret);
     }
+    CHPCacheTerminate();
 
     CHPParserLockMutex();
     g_activeConnections = 0;
@@ -533,35 +675,39 @@ static size_t CHPEasyHandleWriteCb(char *buffer, size_t size, size_t num, void *
         OIC_LOG_V(ERROR, TAG, "%s Payload limit exceeded", __func__);
         resp->payloadLength = 0;
         ctx->writeOffset = 0;
+        ctx->writeCapacity = 0;
         OICFree(resp->payload);
         resp->payload = NULL;
         return 0;
     }
 
-    if (!resp->payload)
+    if (!resp->payload || ctx->writeOffset + dataToWrite > ctx->writeCapacity)
     {
-        resp->payload = OICMalloc(dataToWrite);
-        if (!resp->payload)
+        // Grow the buffer geometrically so that a large payload is not copied per chunk
+        size_t capacity = resp->payload ? ctx->writeCapacity * 2 : CHP_MIN_PAYLOAD_CAPACITY;
+        while (capacity < ctx->writeOffset + dataToWrite)
         {
-            OIC_LOG_V(ERROR, TAG, "%s Out of memory!", __func__);
-            return 0;
+            capacity *= 2;
         }
-    }
-    else
-    {
-        // Realloc buffer
-        void *newPayload = OICRealloc(resp->payload, ctx->writeOffset + dataToWrite);
+        if (capacity > MAX_PAYLOAD_SIZE)
+        {
+            capacity = MAX_PAYLOAD_SIZE;
+        }
+
+        void *newPayload = OICRealloc(resp->payload, capacity);
         if (!newPayload)
         {
             OIC_LOG_V(ERROR, TAG, "Realloc failed! Current: %" PRIuPTR " Extra: %" PRIuPTR, ctx->writeOffset,
                                                                            dataToWrite);
             resp->payloadLength = 0;
             ctx->writeOffset = 0;
+            ctx->writeCapacity = 0;
             OICFree(resp->payload);
             resp->payload = NULL;
             return 0;
         }
         resp->payload = newPayload;
+        ctx->writeCapacity = capacity;
     }
 
     memcpy(resp->payload + ctx->writeOffset, buffer, dataToWrite);
@@ -619,6 +765,7 @@ static size_t CHPEasyHandleHeaderCb(char *buffer, size_t size, size_t num, void
             OIC_LOG(ERROR, TAG, "New header received");
             resp->payloadLength = 0;
             ctx->writeOffset = 0;
+            ctx->writeCapacity = 0;
             OICFree(resp->payload);
             resp->payload = NULL;
             CHPParserResetHeaderOptions(&(resp->headerOptions));
@@ -695,6 +842,7 @@ static size_t CHPEasyHandleHeaderCb(char *buffer, size_t size, size_t num, void
                               (sizeof(option->optionData) - 1): headerValueLen;
             memcpy(option->optionData, headerValuePtr, headerValueLen);
             option->optionData[headerValueLen] = '\0';
+            option->optionLength = (uint16_t)headerValueLen;
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s:: %s: %s", __func__, option->optionName, option->optionData);
@@ -719,7 +867,9 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     VERIFY_NON_NULL_RET(easyHandle, TAG, "easyHandle", OC_STACK_INVALID_PARAM);
     VERIFY_NON_NULL_RET(handleContext, TAG, "handleContext", OC_STACK_INVALID_PARAM);
 
-    CURL *e = curl_easy_init();
+    CHPParserLockMutex();
+    CURL *e = CHPAcquireEasyHandle();
+    CHPParserUnlockMutex();
     if(!e)
     {
         OIC_LOG(ERROR, TAG, "easy init failed!");
@@ -749,8 +899,17 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     curl_easy_setopt(e, CURLOPT_LOW_SPEED_LIMIT, 1024L);
     curl_easy_setopt(e, CURLOPT_LOW_SPEED_TIME, 60L);
     curl_easy_setopt(e, CURLOPT_USERAGENT, DEFAULT_USER_AGENT);
-    /* Close connection once done with transaction */
-    curl_easy_setopt(e, CURLOPT_FORBID_REUSE, 1L);
+    /* Keep the connection open for the next requests to the same server */
+#if LIBCURL_VERSION_NUM >= 0x071900
+    curl_easy_setopt(e, CURLOPT_TCP_KEEPALIVE, 1L);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+    /* Rather wait for a connection to multiplex on than open another one */
+    curl_easy_setopt(e, CURLOPT_PIPEWAIT, 1L);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    curl_easy_setopt(e, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+#endif
     /* Allow redirect */
     curl_easy_setopt(e, CURLOPT_FOLLOWLOCATION, 1L);
     /* Only redirect to http servers */
@@ -790,6 +949,9 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
             curl_easy_setopt(e, CURLOPT_CUSTOMREQUEST, "DELETE");
             break;
         default:
+            CHPParserLockMutex();
+            CHPReleaseEasyHandle(e);
+            CHPParserUnlockMutex();
             return OC_STACK_INVALID_METHOD;
     }
 
@@ -813,17 +975,70 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
         }
     }
 
+    /* Revalidate the stale cached response */
+    if (handleContext->validator[0] != '\0')
+    {
+        snprintf(buffer, sizeof(buffer), "If-None-Match: %s", handleContext->validator);
+        list = curl_slist_append(list, buffer);
+    }
+
     /* Add content-type and accept header */
     snprintf(buffer, sizeof(buffer), "Accept: %s", req->acceptFormat);
     list = curl_slist_append(list, buffer);
     snprintf(buffer, sizeof(buffer), "Content-Type: %s", req->payloadFormat);
     curl_easy_setopt(e, CURLOPT_HTTPHEADER, list);
+    handleContext->list = list;
 
     *easyHandle = e;
     OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
     return OC_STACK_OK;
 }
 
+static void CHPParserRefresh(void)
+{
+    // Notify refreshfd
+    ssize_t len = 0;
+    do
+    {
+        len = write(g_refreshFds[1], "w", 1);
+    } while ((len == -1) && (errno == EINTR));
+
+    if ((len == -1) && (errno != EINTR) && (errno != EPIPE))
+    {
+        OIC_LOG_V(DEBUG, TAG, "refresh failed: %s", strerror(errno));
+    }
+}
+
+/* HTTP header field names are case-insensitive (RFC 7230, 3.2). */
+#define CHP_IS_HEADER(option, name) (0 == strncasecmp((option)->optionName, (name), sizeof(name)))
+
+/*
+ * Only unconditional GET requests use the response cache, conditional requests are
+ * validated by the HTTP server itself. Responses to authorized requests are not
+ * shared with other clients (RFC 7234, 3.2).
+ */
+static bool CHPIsCacheableRequest(const HttpRequest_t *req)
+{
+    if (CHP_GET != req->method)
+    {
+        return false;
+    }
+
+    size_t headerCount = u_arraylist_length(req->headerOptions);
+    for (size_t i = 0; i < headerCount; i++)
+    {
+        HttpHeaderOption_t *option = u_arraylist_get(req->headerOptions, i);
+        if (option && (CHP_IS_HEADER(option, HTTP_OPTION_IF_MATCH) ||
+                       CHP_IS_HEADER(option, HTTP_OPTION_IF_NONE_MATCH) ||
+                       CHP_IS_HEADER(option, HTTP_OPTION_ETAG) ||
+                       CHP_IS_HEADER(option, HTTP_OPTION_AUTHORIZATION)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 OCStackResult CHPPostHttpRequest(HttpRequest_t *req, CHPResponseCallback httpcb,
                                  void *context)
 {
@@ -840,10 +1055,49 @@ OCStackResult CHPPostHttpRequest(HttpRequest_t *req, CHPResponseCallback httpcb,
 
     ctxt->cb = httpcb;
     ctxt->context = context;
+
+    if (CHPIsCacheableRequest(req))
+    {
+        ctxt->cacheUri = OICStrdup(req->resourceUri);
+        ctxt->cacheAccept = OICStrdup(req->acceptFormat);
+        if (!ctxt->cacheUri || !ctxt->cacheAccept)
+        {
+            OIC_LOG(ERROR, TAG, "Memory failed!");
+            OICFree(ctxt->cacheUri);
+            OICFree(ctxt->cacheAccept);
+            OICFree(ctxt);
+            return OC_STACK_NO_MEMORY;
+        }
+
+        CHPCacheState_t state = CHPCacheLookup(ctxt->cacheUri, ctxt->cacheAccept, time(NULL),
+                                               &ctxt->resp, ctxt->validator,
+                                               sizeof(ctxt->validator));
+        if (CHP_CACHE_FRESH == state)
+        {
+            // Deliver the cached response from the multi handle thread, as any response
+            OIC_LOG_V(DEBUG, TAG, "Response to %s found in cache", ctxt->cacheUri);
+            CHPParserLockMutex();
+            if (g_completedTail)
+            {
+                g_completedTail->next = ctxt;
+            }
+            else
+            {
+                g_completedHead = ctxt;
+            }
+            g_completedTail = ctxt;
+            CHPParserUnlockMutex();
+            CHPParserRefresh();
+            return OC_STACK_OK;
+        }
+    }
+
     OCStackResult ret = CHPInitializeEasyHandle(&ctxt->easyHandle, req, ctxt);
     if(ret != OC_STACK_OK)
     {
         OIC_LOG_V(ERROR, TAG, "Failed to initialize easy handle [%d]", ret);
+        OICFree(ctxt->cacheUri);
+        OICFree(ctxt->cacheAccept);
         OICFree(ctxt);
         return ret;
     }
@@ -853,17 +1107,7 @@ OCStackResult CHPPostHttpRequest(HttpRequest_t *req, CHPResponseCallback httpcb,
     curl_multi_add_handle(g_multiHandle, ctxt->easyHandle);
     g_activeConnections++;
     CHPParserUnlockMutex();
-    // Notify refreshfd
-    ssize_t len = 0;
-    do
-    {
-        len = write(g_refreshFds[1], "w", 1);
-    } while ((len == -1) && (errno == EINTR));
-
-    if ((len == -1) && (errno != EINTR) && (errno != EPIPE))
-    {
-        OIC_LOG_V(DEBUG, TAG, "refresh failed: %s", strerror(errno));
-    }
+    CHPParserRefresh();
 
     OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
     return OC_STACK_OK;
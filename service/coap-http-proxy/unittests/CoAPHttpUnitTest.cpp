@@ -37,7 +37,20 @@
 #include "uarraylist.h"
 #include "CoapHttpParser.h"
 #include "CoapHttpMap.h"
+#include "CoapHttpCache.h"
+#include "CoapHttpCbor.h"
 #include "ocpayload.h"
+#include "internal/ocpayloadcbor.h"
+
+#include <curl/curl.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
 
 static std::chrono::milliseconds g_waitForResponse(10000);
 static std::condition_variable responseCon;
@@ -424,3 +437,588 @@ TEST_F(CoApHttpTest, CHPParserTerminate)
     EXPECT_EQ(OC_STACK_OK, (CHPParserTerminate()));
 }
 
+
+#define STUB_NUM_OF_REQUESTS 20
+
+static HttpHeaderOption_t *CreateHeader(const char *name, const char *value)
+{
+    HttpHeaderOption_t *option = (HttpHeaderOption_t *)OICCalloc(1, sizeof(HttpHeaderOption_t));
+    OICStrcpy(option->optionName, sizeof(option->optionName), name);
+    OICStrcpy(option->optionData, sizeof(option->optionData), value);
+    option->optionLength = strlen(value);
+    return option;
+}
+
+static void AddHeader(HttpResponse_t *response, const char *name, const char *value)
+{
+    if (!response->headerOptions)
+    {
+        response->headerOptions = u_arraylist_create();
+    }
+    u_arraylist_add(response->headerOptions, CreateHeader(name, value));
+}
+
+TEST_F(CoApHttpTest, CHPCacheGetLifetime)
+{
+    time_t now = curl_getdate("Thu, 20 Oct 2025 11:45:00 GMT", NULL);
+    uint32_t lifetime = 0;
+    HttpResponse_t response;
+    memset(&response, 0, sizeof(response));
+    response.status = CHP_SUCCESS;
+
+    // Neither a lifetime nor a validator
+    EXPECT_FALSE(CHPCacheGetLifetime(&response, now, &lifetime));
+
+    AddHeader(&response, "ETag", "\"v1\"");
+    EXPECT_TRUE(CHPCacheGetLifetime(&response, now, &lifetime));
+    EXPECT_EQ(0u, lifetime);
+
+    AddHeader(&response, "Expires", "Thu, 20 Oct 2025 11:46:00 GMT");
+    EXPECT_TRUE(CHPCacheGetLifetime(&response, now, &lifetime));
+    EXPECT_EQ(60u, lifetime);
+
+    AddHeader(&response, "Cache-Control", "public, max-age=30");
+    EXPECT_TRUE(CHPCacheGetLifetime(&response, now, &lifetime));
+    EXPECT_EQ(30u, lifetime);
+
+    AddHeader(&response, "Age", "10");
+    EXPECT_TRUE(CHPCacheGetLifetime(&response, now, &lifetime));
+    EXPECT_EQ(20u, lifetime);
+
+    AddHeader(&response, "cache-control", "S-MAXAGE=100");
+    EXPECT_TRUE(CHPCacheGetLifetime(&response, now, &lifetime));
+    EXPECT_EQ(90u, lifetime);
+
+    AddHeader(&response, "Cache-Control", "no-cache");
+    EXPECT_TRUE(CHPCacheGetLifetime(&response, now, &lifetime));
+    EXPECT_EQ(0u, lifetime);
+
+    // A shared cache never keeps a private response
+    AddHeader(&response, "Cache-Control", "private");
+    EXPECT_FALSE(CHPCacheGetLifetime(&response, now, &lifetime));
+    CHPCacheFreeResponse(&response);
+
+    AddHeader(&response, "Cache-Control", "max-age=30, no-store");
+    EXPECT_FALSE(CHPCacheGetLifetime(&response, now, &lifetime));
+    CHPCacheFreeResponse(&response);
+
+    AddHeader(&response, "Cache-Control", "max-age=30");
+    response.status = CHP_NOT_FOUND;
+    EXPECT_FALSE(CHPCacheGetLifetime(&response, now, &lifetime));
+    CHPCacheFreeResponse(&response);
+}
+
+TEST_F(CoApHttpTest, CHPCacheGetLifetimeVary)
+{
+    time_t now = curl_getdate("Thu, 20 Oct 2025 11:45:00 GMT", NULL);
+    uint32_t lifetime = 0;
+    HttpResponse_t response;
+    memset(&response, 0, sizeof(response));
+    response.status = CHP_SUCCESS;
+
+    // Entries are keyed by the Accept header of the request
+    AddHeader(&response, "Cache-Control", "max-age=30");
+    AddHeader(&response, "Vary", "accept");
+    EXPECT_TRUE(CHPCacheGetLifetime(&response, now, &lifetime));
+    EXPECT_EQ(30u, lifetime);
+    CHPCacheFreeResponse(&response);
+
+    // but not by any other request header
+    AddHeader(&response, "Cache-Control", "max-age=30");
+    AddHeader(&response, "Vary", "Accept, Accept-Language");
+    EXPECT_FALSE(CHPCacheGetLifetime(&response, now, &lifetime));
+    CHPCacheFreeResponse(&response);
+
+    AddHeader(&response, "Cache-Control", "max-age=30");
+    AddHeader(&response, "Vary", "*");
+    EXPECT_FALSE(CHPCacheGetLifetime(&response, now, &lifetime));
+    CHPCacheFreeResponse(&response);
+}
+
+TEST_F(CoApHttpTest, CHPCacheStoreAndRevalidate)
+{
+    const char *uri = "http://192.168.1.10/a/light";
+    time_t now = 1000;
+    char validator[CHP_MAX_HF_DATA_LENGTH] = "";
+    HttpResponse_t cached;
+    CHPCacheStats_t stats;
+    ASSERT_EQ(OC_STACK_OK, CHPCacheInitialize(2));
+
+    char body[] = "{\"on\": true}";
+    HttpResponse_t response;
+    memset(&response, 0, sizeof(response));
+    response.status = CHP_SUCCESS;
+    response.payload = body;
+    response.payloadLength = sizeof(body);
+    AddHeader(&response, "Cache-Control", "max-age=10");
+    AddHeader(&response, "ETag", "\"v1\"");
+    EXPECT_EQ(OC_STACK_OK, CHPCacheStore(uri, JSON_CONTENT_TYPE, &response, now));
+
+    // Another accept format is another response
+    EXPECT_EQ(CHP_CACHE_MISS, CHPCacheLookup(uri, CBOR_CONTENT_TYPE, now, &cached, validator,
+                                             sizeof(validator)));
+    EXPECT_EQ(CHP_CACHE_FRESH, CHPCacheLookup(uri, JSON_CONTENT_TYPE, now + 4, &cached,
+                                              validator, sizeof(validator)));
+    EXPECT_EQ(6u, cached.maxAge);
+    ASSERT_EQ(sizeof(body), cached.payloadLength);
+    EXPECT_EQ(0, memcmp(body, cached.payload, sizeof(body)));
+    EXPECT_EQ(2u, u_arraylist_length(cached.headerOptions));
+    CHPCacheFreeResponse(&cached);
+
+    // Stale, revalidated with its ETag
+    EXPECT_EQ(CHP_CACHE_STALE, CHPCacheLookup(uri, JSON_CONTENT_TYPE, now + 10, &cached,
+                                              validator, sizeof(validator)));
+    EXPECT_STREQ("\"v1\"", validator);
+    HttpResponse_t notModified;
+    memset(&notModified, 0, sizeof(notModified));
+    notModified.status = CHP_NOT_MODIFIED;
+    EXPECT_EQ(OC_STACK_OK, CHPCacheRevalidate(uri, JSON_CONTENT_TYPE, &notModified, now + 10,
+                                              &cached));
+    EXPECT_EQ(CHP_SUCCESS, cached.status);
+    EXPECT_EQ(10u, cached.maxAge);
+    CHPCacheFreeResponse(&cached);
+    EXPECT_EQ(CHP_CACHE_FRESH, CHPCacheLookup(uri, JSON_CONTENT_TYPE, now + 15, &cached,
+                                              validator, sizeof(validator)));
+    CHPCacheFreeResponse(&cached);
+
+    // The least recently used response is dropped
+    EXPECT_EQ(OC_STACK_OK, CHPCacheStore("http://192.168.1.10/a/fan", JSON_CONTENT_TYPE,
+                                         &response, now));
+    EXPECT_EQ(OC_STACK_OK, CHPCacheStore("http://192.168.1.10/a/door", JSON_CONTENT_TYPE,
+                                         &response, now));
+    EXPECT_EQ(CHP_CACHE_MISS, CHPCacheLookup(uri, JSON_CONTENT_TYPE, now, &cached, validator,
+                                             sizeof(validator)));
+
+    // A response which may not be kept replaces the kept one
+    AddHeader(&response, "Cache-Control", "no-store");
+    EXPECT_NE(OC_STACK_OK, CHPCacheStore("http://192.168.1.10/a/fan", JSON_CONTENT_TYPE,
+                                         &response, now));
+    EXPECT_EQ(CHP_CACHE_MISS, CHPCacheLookup("http://192.168.1.10/a/fan", JSON_CONTENT_TYPE,
+                                             now, &cached, validator, sizeof(validator)));
+
+    CHPCacheGetStats(&stats);
+    EXPECT_EQ(2u, stats.hits);
+    EXPECT_EQ(4u, stats.misses);
+    EXPECT_EQ(1u, stats.revalidated);
+
+    response.payload = NULL;
+    response.payloadLength = 0;
+    CHPCacheFreeResponse(&response);
+    CHPCacheTerminate();
+}
+
+/*
+ * A local HTTP/1.1 server with persistent connections, counting the connections and the
+ * requests it receives.
+ */
+class HttpStubServer
+{
+public:
+    HttpStubServer(const std::string &headers) : m_headers(headers), m_listenFd(-1),
+        m_port(0), m_stop(false), m_connections(0), m_requests(0), m_notModified(0)
+    {
+    }
+
+    ~HttpStubServer()
+    {
+        stop();
+    }
+
+    bool start()
+    {
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        if (m_listenFd < 0 || bind(m_listenFd, (struct sockaddr *)&addr, sizeof(addr)) ||
+            listen(m_listenFd, 16) || getsockname(m_listenFd, (struct sockaddr *)&addr, &length))
+        {
+            return false;
+        }
+        m_port = ntohs(addr.sin_port);
+        m_acceptThread = std::thread(&HttpStubServer::acceptConnections, this);
+        return true;
+    }
+
+    void stop()
+    {
+        if (m_stop.exchange(true))
+        {
+            return;
+        }
+        if (m_acceptThread.joinable())
+        {
+            m_acceptThread.join();
+        }
+        for (size_t i = 0; i < m_threads.size(); i++)
+        {
+            m_threads[i].join();
+        }
+        close(m_listenFd);
+    }
+
+    std::string uri() const
+    {
+        return "http://127.0.0.1:" + std::to_string(m_port) + "/a/light";
+    }
+
+    std::string m_headers;
+    int m_listenFd;
+    uint16_t m_port;
+    std::atomic<bool> m_stop;
+    std::atomic<uint32_t> m_connections;
+    std::atomic<uint32_t> m_requests;
+    std::atomic<uint32_t> m_notModified;
+
+private:
+    void acceptConnections()
+    {
+        struct pollfd pfd = { m_listenFd, POLLIN, 0 };
+        while (!m_stop)
+        {
+            if (poll(&pfd, 1, 100) > 0)
+            {
+                int fd = accept(m_listenFd, NULL, NULL);
+                if (fd >= 0)
+                {
+                    m_connections++;
+                    m_threads.push_back(std::thread(&HttpStubServer::serve, this, fd));
+                }
+            }
+        }
+    }
+
+    void serve(int fd)
+    {
+        std::string received;
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        while (!m_stop)
+        {
+            size_t end = received.find("\r\n\r\n");
+            if (end != std::string::npos)
+            {
+                std::string request = received.substr(0, end);
+                received.erase(0, end + 4);
+                respond(fd, request);
+                continue;
+            }
+            if (poll(&pfd, 1, 100) <= 0)
+            {
+                continue;
+            }
+            char buffer[1024];
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                break;
+            }
+            received.append(buffer, length);
+        }
+        close(fd);
+    }
+
+    void respond(int fd, const std::string &request)
+    {
+        m_requests++;
+        std::string response;
+        if (request.find("If-None-Match: \"v1\"") != std::string::npos)
+        {
+            m_notModified++;
+            response = "HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\n" + m_headers + "\r\n";
+        }
+        else
+        {
+            const std::string body = "{\"on\": true, \"brightness\": 42}";
+            response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                       m_headers + "\r\n" + body;
+        }
+        ssize_t written = write(fd, response.data(), response.size());
+        OC_UNUSED(written);
+    }
+
+    std::thread m_acceptThread;
+    std::vector<std::thread> m_threads;
+};
+
+static std::mutex g_stubMutex;
+static std::condition_variable g_stubCondition;
+static uint32_t g_stubResponses;
+static uint32_t g_stubMaxAge;
+static bool g_stubPayloadMatches;
+
+static void stubCallback(const HttpResponse_t *response, void *context)
+{
+    OC_UNUSED(context);
+    std::lock_guard<std::mutex> lock(g_stubMutex);
+    const char body[] = "{\"on\": true, \"brightness\": 42}";
+    g_stubPayloadMatches = (CHP_SUCCESS == response->status) &&
+                           (sizeof(body) - 1 == response->payloadLength) &&
+                           (0 == memcmp(body, response->payload, sizeof(body) - 1));
+    g_stubMaxAge = response->maxAge;
+    g_stubResponses++;
+    g_stubCondition.notify_all();
+}
+
+static bool WaitStubResponses(uint32_t count)
+{
+    std::unique_lock<std::mutex> lock(g_stubMutex);
+    return g_stubCondition.wait_for(lock, g_waitForResponse,
+                                    [count] { return g_stubResponses >= count; });
+}
+
+/* Send GET requests to the stub server, one after the other */
+static void SendStubRequests(const HttpStubServer &server, uint32_t count)
+{
+    HttpRequest_t hreq = {1, 1, CHP_GET, NULL, "", NULL, 0, false,
+                          JSON_CONTENT_TYPE, JSON_CONTENT_TYPE};
+    OICStrcpy(hreq.resourceUri, sizeof(hreq.resourceUri), server.uri().c_str());
+    g_stubResponses = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, CHPPostHttpRequest(&hreq, stubCallback, NULL));
+        EXPECT_TRUE(WaitStubResponses(i + 1));
+        EXPECT_TRUE(g_stubPayloadMatches);
+    }
+}
+
+TEST_F(CoApHttpTest, CHPParserReusesConnections)
+{
+    HttpStubServer server("");
+    ASSERT_TRUE(server.start());
+    ASSERT_EQ(OC_STACK_OK, CHPParserInitialize());
+
+    SendStubRequests(server, STUB_NUM_OF_REQUESTS);
+    EXPECT_EQ((uint32_t)STUB_NUM_OF_REQUESTS, server.m_requests.load());
+    EXPECT_EQ(1u, server.m_connections.load());
+    // Without a lifetime, the CoAP response shall not be reused
+    EXPECT_EQ(0u, g_stubMaxAge);
+
+    // Concurrent requests share a bounded number of connections
+    HttpRequest_t hreq = {1, 1, CHP_GET, NULL, "", NULL, 0, false,
+                          JSON_CONTENT_TYPE, JSON_CONTENT_TYPE};
+    OICStrcpy(hreq.resourceUri, sizeof(hreq.resourceUri), server.uri().c_str());
+    g_stubResponses = 0;
+    for (int i = 0; i < STUB_NUM_OF_REQUESTS; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, CHPPostHttpRequest(&hreq, stubCallback, NULL));
+    }
+    EXPECT_TRUE(WaitStubResponses(STUB_NUM_OF_REQUESTS));
+    EXPECT_GE((uint32_t)CHP_MAX_HOST_CONNECTIONS, server.m_connections.load());
+
+    EXPECT_EQ(OC_STACK_OK, CHPParserTerminate());
+    server.stop();
+}
+
+TEST_F(CoApHttpTest, CHPParserCachesResponses)
+{
+    HttpStubServer server("Cache-Control: max-age=60\r\nETag: \"v1\"\r\n");
+    ASSERT_TRUE(server.start());
+    ASSERT_EQ(OC_STACK_OK, CHPParserInitialize());
+
+    SendStubRequests(server, STUB_NUM_OF_REQUESTS);
+    EXPECT_EQ(1u, server.m_requests.load());
+    EXPECT_LT(0u, g_stubMaxAge);
+    EXPECT_GE(60u, g_stubMaxAge);
+
+    CHPCacheStats_t stats;
+    CHPCacheGetStats(&stats);
+    EXPECT_EQ((uint32_t)STUB_NUM_OF_REQUESTS - 1, stats.hits);
+
+    EXPECT_EQ(OC_STACK_OK, CHPParserTerminate());
+    server.stop();
+}
+
+TEST_F(CoApHttpTest, CHPParserDoesNotCacheAuthorizedRequests)
+{
+    HttpStubServer server("Cache-Control: max-age=60\r\nETag: \"v1\"\r\n");
+    ASSERT_TRUE(server.start());
+    ASSERT_EQ(OC_STACK_OK, CHPParserInitialize());
+
+    HttpHeaderOption_t authorization;
+    memset(&authorization, 0, sizeof(authorization));
+    OICStrcpy(authorization.optionName, sizeof(authorization.optionName), "Authorization");
+    OICStrcpy(authorization.optionData, sizeof(authorization.optionData), "Bearer token");
+    authorization.optionLength = (uint16_t)strlen(authorization.optionData);
+    u_arraylist_t *headers = u_arraylist_create();
+    ASSERT_TRUE(NULL != headers);
+    ASSERT_TRUE(u_arraylist_add(headers, &authorization));
+
+    HttpRequest_t hreq = {1, 1, CHP_GET, headers, "", NULL, 0, false,
+                          JSON_CONTENT_TYPE, JSON_CONTENT_TYPE};
+    OICStrcpy(hreq.resourceUri, sizeof(hreq.resourceUri), server.uri().c_str());
+    g_stubResponses = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, CHPPostHttpRequest(&hreq, stubCallback, NULL));
+        EXPECT_TRUE(WaitStubResponses(i + 1));
+        EXPECT_TRUE(g_stubPayloadMatches);
+    }
+    EXPECT_EQ(3u, server.m_requests.load());
+
+    // Nor is a response to an authorized request given to another client
+    SendStubRequests(server, 1);
+    EXPECT_EQ(4u, server.m_requests.load());
+
+    CHPCacheStats_t stats;
+    CHPCacheGetStats(&stats);
+    EXPECT_EQ(0u, stats.hits);
+
+    EXPECT_EQ(OC_STACK_OK, CHPParserTerminate());
+    server.stop();
+    u_arraylist_free(&headers);
+}
+
+TEST_F(CoApHttpTest, CHPParserRevalidatesResponses)
+{
+    HttpStubServer server("Cache-Control: no-cache\r\nETag: \"v1\"\r\n");
+    ASSERT_TRUE(server.start());
+    ASSERT_EQ(OC_STACK_OK, CHPParserInitialize());
+
+    // Each request is revalidated, and answered with the kept payload
+    SendStubRequests(server, 3);
+    EXPECT_EQ(3u, server.m_requests.load());
+    EXPECT_EQ(2u, server.m_notModified.load());
+    EXPECT_EQ(0u, g_stubMaxAge);
+
+    CHPCacheStats_t stats;
+    CHPCacheGetStats(&stats);
+    EXPECT_EQ(2u, stats.revalidated);
+
+    EXPECT_EQ(OC_STACK_OK, CHPParserTerminate());
+    server.stop();
+}
+
+static std::string JsonToCborHex(const char *json)
+{
+    uint8_t *cbor = NULL;
+    size_t cborLength = 0;
+    if (OC_STACK_OK != CHPJsonToCbor(json, strlen(json), &cbor, &cborLength))
+    {
+        return "invalid";
+    }
+    std::string hex;
+    char digits[3];
+    for (size_t i = 0; i < cborLength; i++)
+    {
+        snprintf(digits, sizeof(digits), "%02x", cbor[i]);
+        hex += digits;
+    }
+    OICFree(cbor);
+    return hex;
+}
+
+static std::string CborHexToJson(const char *hex)
+{
+    std::vector<uint8_t> cbor;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2)
+    {
+        cbor.push_back((uint8_t)std::stoul(std::string(hex + i, 2), NULL, 16));
+    }
+    char *json = NULL;
+    size_t jsonLength = 0;
+    if (OC_STACK_OK != CHPCborToJson(cbor.data(), cbor.size(), &json, &jsonLength))
+    {
+        return "invalid";
+    }
+    std::string result(json, jsonLength);
+    OICFree(json);
+    return result;
+}
+
+TEST_F(CoApHttpTest, CHPJsonToCbor)
+{
+    // Examples of RFC 7049, appendix A
+    EXPECT_EQ("00", JsonToCborHex("0"));
+    EXPECT_EQ("1818", JsonToCborHex("24"));
+    EXPECT_EQ("1a000f4240", JsonToCborHex("1000000"));
+    EXPECT_EQ("1bffffffffffffffff", JsonToCborHex("18446744073709551615"));
+    EXPECT_EQ("3903e7", JsonToCborHex("-1000"));
+    EXPECT_EQ("fb3ff8000000000000", JsonToCborHex("1.5"));
+    EXPECT_EQ("f4f5f6", JsonToCborHex("false").append(JsonToCborHex("true"))
+                                              .append(JsonToCborHex("null")));
+    EXPECT_EQ("62c3bc", JsonToCborHex("\"\\u00fc\""));
+    EXPECT_EQ("64f0908591", JsonToCborHex("\"\\ud800\\udd51\""));
+    EXPECT_EQ("8301820203820405", JsonToCborHex("[1,[2,3],[4,5]]"));
+    EXPECT_EQ("98190102030405060708090a0b0c0d0e0f101112131415161718181819",
+              JsonToCborHex("[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,"
+                            "21,22,23,24,25]"));
+    EXPECT_EQ("a26161016162820203", JsonToCborHex(" {\"a\": 1, \"b\": [2, 3]} "));
+
+    const char *invalid[] = {"", "{", "[1,]", "{\"a\"}", "{\"a\":1,}", "01", "1.", "tru",
+                             "[1] 2", "\"\\ud800\"", "\"a\nb\"", "{1:2}", "[1}", "\"\\x\""};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        EXPECT_EQ("invalid", JsonToCborHex(invalid[i])) << invalid[i];
+    }
+
+    std::string deep(CHP_MAX_NESTING_DEPTH + 1, '[');
+    deep.append(CHP_MAX_NESTING_DEPTH + 1, ']');
+    EXPECT_EQ("invalid", JsonToCborHex(deep.c_str()));
+}
+
+TEST_F(CoApHttpTest, CHPCborToJson)
+{
+    EXPECT_EQ("null", CborHexToJson("f97e00"));
+    EXPECT_EQ("100000", CborHexToJson("fa47c35000"));
+    EXPECT_EQ("1363896240", CborHexToJson("c11a514b67b0"));
+    EXPECT_EQ("-18446744073709551616", CborHexToJson("3bffffffffffffffff"));
+    EXPECT_EQ("\"AQIDBA\"", CborHexToJson("4401020304"));
+    EXPECT_EQ("\"AQIDBAU\"", CborHexToJson("5f42010243030405ff"));
+    EXPECT_EQ("\"streaming\"", CborHexToJson("7f657374726561646d696e67ff"));
+    EXPECT_EQ("[1,[2,3],[4,5]]", CborHexToJson("9f018202039f0405ffff"));
+    EXPECT_EQ("{\"a\":1,\"b\":[2,3]}", CborHexToJson("bf61610161629f0203ffff"));
+    EXPECT_EQ("{\"1\":2,\"3\":4}", CborHexToJson("a201020304"));
+
+    const char *invalid[] = {"", "8201", "0000", "a1f5f5", "bf01ff", "ff", "1c", "6261"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        EXPECT_EQ("invalid", CborHexToJson(invalid[i])) << invalid[i];
+    }
+}
+
+TEST_F(CoApHttpTest, CHPJsonCborRoundTrip)
+{
+    // A document as returned by a collection of resources
+    std::string json = "{\"items\":[";
+    char item[160];
+    for (int i = 0; json.size() < (64u << 10); i++)
+    {
+        snprintf(item, sizeof(item), "%s{\"id\":%d,\"name\":\"light %d\",\"on\":%s,"
+                 "\"level\":%d.5,\"tags\":[\"a\",\"b\\n\"]}", i ? "," : "", i, i,
+                 (i % 2) ? "true" : "false", i % 100);
+        json += item;
+    }
+    json += "]}";
+
+    uint8_t *cbor = NULL;
+    size_t cborLength = 0;
+    char *back = NULL;
+    size_t backLength = 0;
+    ASSERT_EQ(OC_STACK_OK, CHPJsonToCbor(json.c_str(), json.size(), &cbor, &cborLength));
+    ASSERT_EQ(OC_STACK_OK, CHPCborToJson(cbor, cborLength, &back, &backLength));
+    EXPECT_EQ(json, std::string(back, backLength));
+
+    // The translation parses back into the representation of the document
+    OCPayload *parsed = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&parsed, OC_FORMAT_CBOR,
+                                          PAYLOAD_TYPE_REPRESENTATION, cbor, cborLength));
+    int64_t id = -1;
+    OCRepPayload **items = NULL;
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {0};
+    ASSERT_TRUE(OCRepPayloadGetPropObjectArray((OCRepPayload *)parsed, "items", &items,
+                                               dimensions));
+    EXPECT_LT(0u, dimensions[0]);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(items[1], "id", &id));
+    EXPECT_EQ(1, id);
+    for (size_t i = 0; i < dimensions[0]; i++)
+    {
+        OCRepPayloadDestroy(items[i]);
+    }
+    OICFree(items);
+    OCPayloadDestroy(parsed);
+    OICFree(cbor);
+    OICFree(back);
+}
@@ -22,6 +22,8 @@
 
 #include "RCSException.h"
 
+#include <deque>
+
 namespace OIC
 {
     namespace Service
@@ -30,8 +32,20 @@ namespace OIC
         namespace
         {
             constexpr ExpiryTimerImpl::Id INVALID_ID{ 0U };
+
+            // Time an idle worker waits for a callback before it exits
+            constexpr std::chrono::seconds WORKER_IDLE_TIMEOUT{ 10 };
         }
 
+        struct ExpiryTimerImpl::Dispatcher
+        {
+            std::mutex mutex;
+            std::condition_variable cond;
+            std::deque< std::pair< Callback, Id > > callbacks;
+            size_t idleWorkers{ 0 };
+            bool stop{ false };
+        };
+
         ExpiryTimerImpl::ExpiryTimerImpl() :
                 m_tasks{ },
                 m_thread{ },
@@ -39,7 +53,8 @@ namespace OIC
                 m_cond{ },
                 m_stop{ false },
                 m_mt{ std::random_device{ }() },
-                m_dist{ }
+                m_dist{ },
+                m_dispatcher{ std::make_shared< Dispatcher >() }
         {
             m_thread = std::thread(&ExpiryTimerImpl::run, this);
         }
@@ -49,10 +64,19 @@ namespace OIC
             {
                 std::lock_guard< std::mutex > lock{ m_mutex };
                 m_tasks.clear();
+                m_taskIndex.clear();
                 m_stop = true;
             }
             m_cond.notify_all();
             m_thread.join();
+
+            // The workers are detached, each of them exits once its callback returns
+            {
+                std::lock_guard< std::mutex > lock{ m_dispatcher->mutex };
+                m_dispatcher->callbacks.clear();
+                m_dispatcher->stop = true;
+            }
+            m_dispatcher->cond.notify_all();
         }
 
         ExpiryTimerImpl* ExpiryTimerImpl::getInstance()
@@ -73,7 +97,7 @@ namespace OIC
                 throw RCSInvalidParameterException{ "callback is empty." };
             }
 
-            return addTask(convertToTime(Milliseconds{ delay }), std::move(cb), generateId());
+            return addTask(convertToTime(Milliseconds{ delay }), std::move(cb));
         }
 
         bool ExpiryTimerImpl::cancel(Id id)
@@ -85,15 +109,15 @@ namespace OIC
 
             std::lock_guard< std::mutex > lock{ m_mutex };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
+            auto found = m_taskIndex.find(id);
+            if (found == m_taskIndex.end())
             {
-                if(it->second->getId() == id)
-                {
-                    m_tasks.erase(it);
-                    return true;
-                }
+                return false;
             }
-            return false;
+
+            m_tasks.erase(found->second);
+            m_taskIndex.erase(found);
+            return true;
         }
 
         size_t ExpiryTimerImpl::cancelAll(
@@ -102,17 +126,15 @@ namespace OIC
             std::lock_guard< std::mutex > lock{ m_mutex };
             size_t erased { 0 };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end();)
+            for (const auto& task : tasks)
             {
-                if(tasks.count(it->second))
+                auto found = m_taskIndex.find(task->getId());
+                if (found != m_taskIndex.end() && found->second->second == task)
                 {
-                    it = m_tasks.erase(it);
+                    m_tasks.erase(found->second);
+                    m_taskIndex.erase(found);
                     ++erased;
                 }
-                else
-                {
-                    ++it;
-                }
             }
             return erased;
         }
@@ -123,36 +145,32 @@ namespace OIC
             return std::chrono::duration_cast< Milliseconds >(now.time_since_epoch()) + delay;
         }
 
-        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(
-                Milliseconds delay, Callback cb, Id id)
+        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(Milliseconds delay, Callback cb)
         {
             std::lock_guard< std::mutex > lock{ m_mutex };
 
-            auto newTask = std::make_shared< TimerTask >(id, std::move(cb));
-            m_tasks.insert({ delay, newTask });
-            m_cond.notify_all();
+            auto newTask = std::make_shared< TimerTask >(generateId(), std::move(cb));
+            auto it = m_tasks.insert({ delay, newTask });
+            m_taskIndex[newTask->getId()] = it;
+
+            // The timer thread only needs to wake up earlier for a new first task
+            if (it == m_tasks.begin())
+            {
+                m_cond.notify_all();
+            }
 
             return newTask;
         }
 
         bool ExpiryTimerImpl::containsId(Id id) const
         {
-            for (const auto& info : m_tasks)
-            {
-                if (info.second->getId() == id)
-                {
-                    return true;
-                }
-            }
-            return false;
+            return m_taskIndex.count(id) > 0;
         }
 
         ExpiryTimerImpl::Id ExpiryTimerImpl::generateId()
         {
             Id newId = m_dist(m_mt);
 
-            std::lock_guard< std::mutex > lock{ m_mutex };
-
             while (newId == INVALID_ID || containsId(newId))
             {
                 newId = m_dist(m_mt);
@@ -172,7 +190,8 @@ namespace OIC
             auto it = m_tasks.begin();
             for (; it != m_tasks.end() && it->first <= now; ++it)
             {
-                it->second->execute();
+                m_taskIndex.erase(it->second->getId());
+                it->second->execute(*this);
             }
 
             m_tasks.erase(m_tasks.begin(), it);
@@ -210,6 +229,58 @@ namespace OIC
             }
         }
 
+        void ExpiryTimerImpl::dispatch(Callback cb, Id id)
+        {
+            std::lock_guard< std::mutex > lock{ m_dispatcher->mutex };
+            m_dispatcher->callbacks.emplace_back(std::move(cb), id);
+
+            if (m_dispatcher->idleWorkers < m_dispatcher->callbacks.size())
+            {
+                std::thread(&ExpiryTimerImpl::runWorker, m_dispatcher).detach();
+            }
+            else
+            {
+                m_dispatcher->cond.notify_one();
+            }
+        }
+
+        void ExpiryTimerImpl::runWorker(std::shared_ptr< Dispatcher > dispatcher)
+        {
+            auto hasCallbackOrStop = [&dispatcher]()
+            {
+                return !dispatcher->callbacks.empty() || dispatcher->stop;
+            };
+
+            std::unique_lock< std::mutex > lock{ dispatcher->mutex };
+
+            while (!dispatcher->stop)
+            {
+                if (dispatcher->callbacks.empty())
+                {
+                    ++dispatcher->idleWorkers;
+                    bool woken = dispatcher->cond.wait_for(lock, WORKER_IDLE_TIMEOUT,
+                            hasCallbackOrStop);
+                    --dispatcher->idleWorkers;
+
+                    if (!woken)
+                    {
+                        break;
+                    }
+                    continue;
+                }
+
+                auto callback = std::move(dispatcher->callbacks.front());
+                dispatcher->callbacks.pop_front();
+
+                lock.unlock();
+                callback.first(callback.second);
+
+                // What the callback captured is released out of the lock
+                callback.first = Callback{ };
+                lock.lock();
+            }
+        }
+
 
         TimerTask::TimerTask(ExpiryTimerImpl::Id id, ExpiryTimerImpl::Callback cb) :
             m_id{ id },
@@ -217,7 +288,7 @@ namespace OIC
         {
         }
 
-        void TimerTask::execute()
+        void TimerTask::execute(ExpiryTimerImpl& timer)
         {
             if (isExecuted())
             {
@@ -227,7 +298,7 @@ namespace OIC
             ExpiryTimerImpl::Id id { m_id };
             m_id = INVALID_ID;
 
-            std::thread(std::move(m_callback), id).detach();
+            timer.dispatch(std::move(m_callback), id);
 
             m_callback = ExpiryTimerImpl::Callback{ };
         }
@@ -23,6 +23,7 @@
 
 #include <functional>
 #include <map>
+#include <unordered_map>
 #include <mutex>
 #include <thread>
 #include <chrono>
@@ -47,6 +48,9 @@ namespace OIC
 
         private:
             typedef std::chrono::milliseconds Milliseconds;
+            typedef std::multimap< Milliseconds, std::shared_ptr< TimerTask > > TaskMap;
+
+            struct Dispatcher;
 
         private:
             ExpiryTimerImpl();
@@ -66,12 +70,16 @@ namespace OIC
         private:
             static Milliseconds convertToTime(Milliseconds);
 
-            std::shared_ptr< TimerTask > addTask(Milliseconds, Callback, Id);
+            std::shared_ptr< TimerTask > addTask(Milliseconds, Callback);
 
             /**
              * @pre The lock must be acquired with m_mutex.
              */
             bool containsId(Id) const;
+
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
             Id generateId();
 
             /**
@@ -86,8 +94,16 @@ namespace OIC
 
             void run();
 
+            /**
+             * Runs the callback on an idle worker thread, or on a new one if all of them
+             * are busy, so a slow callback never holds back the others.
+             */
+            void dispatch(Callback, Id);
+            static void runWorker(std::shared_ptr< Dispatcher >);
+
         private:
-            std::multimap< Milliseconds, std::shared_ptr< TimerTask > > m_tasks;
+            TaskMap m_tasks;
+            std::unordered_map< Id, TaskMap::iterator > m_taskIndex;
 
             std::thread m_thread;
             std::mutex m_mutex;
@@ -97,6 +113,9 @@ namespace OIC
             std::mt19937 m_mt;
             std::uniform_int_distribution< Id > m_dist;
 
+            std::shared_ptr< Dispatcher > m_dispatcher;
+
+            friend class TimerTask;
         };
 
         class TimerTask
@@ -114,7 +133,7 @@ namespace OIC
             ExpiryTimerImpl::Id getId() const;
 
         private:
-            void execute();
+            void execute(ExpiryTimerImpl&);
 
         private:
             std::atomic< ExpiryTimerImpl::Id > m_id;
@@ -22,6 +22,9 @@
 
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include "RCSException.h"
 #include "ExpiryTimer.h"
@@ -186,6 +189,55 @@ TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithinToleranceWithMultiplePost)
     ASSERT_EQ(NUM_OF_POST, called);
 }
 
+TEST_F(ExpiryTimerImplTest, SlowCallbackDoesNotDelayOthers)
+{
+    FunctionObject* functor = mocks.Mock< FunctionObject >();
+
+    mocks.ExpectCall(functor, FunctionObject::execute).Do(
+            [this](ExpiryTimerImpl::Id)
+            {
+                Proceed();
+            }
+    );
+
+    ExpiryTimerImpl::getInstance()->post(1,
+            [](ExpiryTimerImpl::Id)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds{ TOLERANCE_IN_MILLIS * 4 });
+            });
+    ExpiryTimerImpl::getInstance()->post(10,
+            std::bind(&FunctionObject::execute, functor, std::placeholders::_1));
+
+    Wait(TOLERANCE_IN_MILLIS * 2);
+}
+
+TEST_F(ExpiryTimerImplTest, CancelWithManyPending)
+{
+    constexpr int NUM_OF_POST{ 1000 };
+    std::vector< ExpiryTimerImpl::Id > ids;
+    ids.reserve(NUM_OF_POST);
+
+    for (int i=0; i<NUM_OF_POST; ++i)
+    {
+        ids.push_back(ExpiryTimerImpl::getInstance()->post(60000 + i % 1000,
+                [](ExpiryTimerImpl::Id)
+                {
+                })->getId());
+    }
+
+    int canceled{ 0 };
+    for (auto id : ids)
+    {
+        canceled += ExpiryTimerImpl::getInstance()->cancel(id) ? 1 : 0;
+    }
+    ASSERT_EQ(NUM_OF_POST, canceled);
+
+    for (auto id : ids)
+    {
+        ASSERT_FALSE(ExpiryTimerImpl::getInstance()->cancel(id));
+    }
+}
+
 class ExpiryTimerTest: public TestWithMock
 {
 public:
@@ -36,6 +36,7 @@ namespace OIC
         #define BROKER_DEVICE_PRESENCE_TIMEROUT (15000l)
         #define BROKER_SAFE_SECOND (5l)
         #define BROKER_SAFE_MILLISECOND (BROKER_SAFE_SECOND * (1000))
+        #define BROKER_POLLING_JITTER_MILLISECOND (BROKER_SAFE_MILLISECOND / 5)
         #define BROKER_TRANSPORT OCConnectivityType::CT_ADAPTER_IP
 
         /*
@@ -24,6 +24,9 @@
 #include <list>
 #include <string>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
 
 #include "BrokerTypes.h"
 #include "ResourcePresence.h"
@@ -34,6 +37,13 @@ namespace OIC
 {
     namespace Service
     {
+       /**
+        * This is internal class used by ResourcePresence, tracks the presence of the
+        * device hosting the monitored resources.
+        *
+        * While the device has no presence, it is polled with a single GET request to
+        * one of its resources, and the response is shared with all of them.
+        */
         class DevicePresence
         {
         public:
@@ -50,15 +60,24 @@ namespace OIC
 
             void initializeDevicePresence(PrimitiveResourcePtr pResource);
 
-            void addPresenceResource(ResourcePresence * rPresence);
+            void addPresenceResource(ResourcePresencePtr rPresence);
             void removePresenceResource(ResourcePresence * rPresence);
 
+           /**
+            * Receives the response to a GET request of one of the resources of the device.
+            *
+            * @param rPresence Resource which received the response.
+            * @param eCode Result of the request.
+            */
+            void receivedResourceResponse(ResourcePresence * rPresence, int eCode);
+
             bool isEmptyResourcePresence() const;
             const std::string getAddress() const;
             DEVICE_STATE getDeviceState() const noexcept;
 
         private:
-            std::list<ResourcePresence * > resourcePresenceList;
+            std::list<std::weak_ptr<ResourcePresence>> resourcePresenceList;
+            mutable std::mutex resourceListMutex;
 
             std::string address;
             std::atomic_int state;
@@ -73,10 +92,28 @@ namespace OIC
             SubscribeCB pSubscribeRequestCB;
             PresenceSubscriber presenceSubscriber;
 
+            std::mutex pollingMutex;
+            ExpiryTimer pollingTimer;
+            TimerID pollingTimerHandle;
+            TimerID probeTimeoutHandle;
+            bool isPolling;
+            ResourcePresence * probingResource;
+            size_t nextProbeIndex;
+            std::minstd_rand pollingJitter;
+            TimerCB pPollingCB;
+            TimerCB pProbeTimeoutCB;
+
             void changeAllPresenceMode(BROKER_MODE mode);
             void subscribeCB(OCStackResult ret,const unsigned int seq, const std::string& Hostaddress);
             void timeOutCB(TimerID id);
 
+            std::list<ResourcePresencePtr> getResourcePresences();
+            void startPolling(bool isImmediate);
+            void stopPolling();
+            void pollingCB(TimerID id);
+            void probeTimeoutCB(TimerID id);
+            long long nextPollingDelay();
+
             void setDeviceState(DEVICE_STATE);
         };
     } // namespace Service
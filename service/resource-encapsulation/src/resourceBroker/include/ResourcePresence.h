@@ -140,9 +140,18 @@ namespace OIC
              */
             BROKER_STATE getResourceState() const;
 
+           /**
+            * Updates the state of resource with the response received by its device
+            * to a request of another resource.
+            *
+            * @param eCode Result of the request.
+            */
+            void receivedDeviceResponse(int eCode);
+
         private:
             std::unique_ptr<std::list<BrokerRequesterInfoPtr>> requesterList;
             PrimitiveResourcePtr primitiveResource;
+            std::weak_ptr<DevicePresence> devicePresence;
             ExpiryTimer expiryTimer;
 
             BROKER_STATE state;
@@ -155,7 +164,6 @@ namespace OIC
 
             RequestGetCB pGetCB;
             TimerCB pTimeoutCB;
-            TimerCB pPollingCB;
 
             void registerDevicePresence();
         public:
@@ -164,8 +172,6 @@ namespace OIC
         private:
             void verifiedGetResponse(int eCode);
 
-            void pollingCB(unsigned int msg = 0);
-
             void executeAllBrokerCB(BROKER_STATE changedState);
             void setResourcestate(BROKER_STATE _state);
         };
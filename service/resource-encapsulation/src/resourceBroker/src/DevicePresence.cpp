@@ -32,9 +32,19 @@ namespace OIC
             presenceTimerHandle = 0;
             isRunningTimeOut = false;
 
+            pollingTimerHandle = 0;
+            probeTimeoutHandle = 0;
+            isPolling = false;
+            probingResource = nullptr;
+            nextProbeIndex = 0;
+            pollingJitter.seed(std::random_device{ }());
+
             pSubscribeRequestCB = std::bind(&DevicePresence::subscribeCB, this,
                         std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
             pTimeoutCB = std::bind(&DevicePresence::timeOutCB, this, std::placeholders::_1);
+            pPollingCB = std::bind(&DevicePresence::pollingCB, this, std::placeholders::_1);
+            pProbeTimeoutCB = std::bind(&DevicePresence::probeTimeoutCB, this,
+                        std::placeholders::_1);
         }
 
         DevicePresence::~DevicePresence()
@@ -51,6 +61,7 @@ namespace OIC
                     OIC_LOG_V(DEBUG,BROKER_TAG,"unsubscribed presence : %s", e.what());
                 }
             }
+            stopPolling();
             resourcePresenceList.clear();
             OIC_LOG_V(DEBUG,BROKER_TAG,"destroy Timer.");
         }
@@ -76,6 +87,9 @@ namespace OIC
             }
             presenceTimerHandle
             = presenceTimer.post(BROKER_DEVICE_PRESENCE_TIMEROUT, pTimeoutCB);
+
+            // Until the presence of the device is received, it is polled
+            startPolling(false);
         }
 
         DEVICE_STATE DevicePresence::getDeviceState() const noexcept
@@ -94,33 +108,79 @@ namespace OIC
             return address;
         }
 
-        void DevicePresence::addPresenceResource(ResourcePresence * rPresence)
+        void DevicePresence::addPresenceResource(ResourcePresencePtr rPresence)
         {
             OIC_LOG_V(DEBUG, BROKER_TAG, "addPresenceResource()");
+            std::lock_guard<std::mutex> lock(resourceListMutex);
             resourcePresenceList.push_back(rPresence);
         }
 
         void DevicePresence::removePresenceResource(ResourcePresence * rPresence)
         {
             OIC_LOG_V(DEBUG, BROKER_TAG, "removePresenceResource()");
-            resourcePresenceList.remove(rPresence);
+            {
+                // The resource is removed while it is destroyed, so it has already expired
+                std::lock_guard<std::mutex> lock(resourceListMutex);
+                resourcePresenceList.remove_if(
+                        [](const std::weak_ptr<ResourcePresence> & item)
+                        {
+                            return item.expired();
+                        });
+            }
+
+            // A probe left without its resource is sent again through another one
+            std::lock_guard<std::mutex> lock(pollingMutex);
+            if(isPolling && probingResource == rPresence)
+            {
+                probingResource = nullptr;
+                pollingTimer.cancel(probeTimeoutHandle);
+                pollingTimerHandle = pollingTimer.post(nextPollingDelay(), pPollingCB);
+            }
         }
 
-        void DevicePresence::changeAllPresenceMode(BROKER_MODE mode)
+        std::list<ResourcePresencePtr> DevicePresence::getResourcePresences()
         {
-            OIC_LOG_V(DEBUG, BROKER_TAG, "changeAllPresenceMode()");
-            if(!resourcePresenceList.empty())
+            std::list<std::weak_ptr<ResourcePresence>> list;
+            {
+                std::lock_guard<std::mutex> lock(resourceListMutex);
+                list = resourcePresenceList;
+            }
+
+            // The resources are locked out of the mutex, as the last reference may destroy one
+            std::list<ResourcePresencePtr> resources;
+            for(auto & item : list)
             {
-                for(auto it : resourcePresenceList)
+                ResourcePresencePtr resource = item.lock();
+                if(resource)
                 {
-                    it->changePresenceMode(mode);
+                    resources.push_back(resource);
                 }
             }
+            return resources;
+        }
+
+        void DevicePresence::changeAllPresenceMode(BROKER_MODE mode)
+        {
+            OIC_LOG_V(DEBUG, BROKER_TAG, "changeAllPresenceMode()");
+            for(auto & it : getResourcePresences())
+            {
+                it->changePresenceMode(mode);
+            }
+
+            if(mode == BROKER_MODE::NON_PRESENCE_MODE)
+            {
+                startPolling(true);
+            }
+            else
+            {
+                stopPolling();
+            }
         }
 
         bool DevicePresence::isEmptyResourcePresence() const
         {
             OIC_LOG_V(DEBUG, BROKER_TAG, "isEmptyResourcePresence()");
+            std::lock_guard<std::mutex> lock(resourceListMutex);
             return resourcePresenceList.empty();
         }
 
@@ -192,5 +252,125 @@ namespace OIC
             isRunningTimeOut = false;
             condition.notify_all();
         }
+
+        void DevicePresence::startPolling(bool isImmediate)
+        {
+            std::lock_guard<std::mutex> lock(pollingMutex);
+            if(isPolling)
+            {
+                return;
+            }
+            OIC_LOG_V(DEBUG, BROKER_TAG, "startPolling()");
+            isPolling = true;
+
+            long long delay = nextPollingDelay();
+            if(isImmediate)
+            {
+                // Devices losing their presence together are not probed all at once
+                delay = std::uniform_int_distribution<long long>(
+                        0, BROKER_POLLING_JITTER_MILLISECOND)(pollingJitter);
+            }
+            pollingTimerHandle = pollingTimer.post(delay, pPollingCB);
+        }
+
+        void DevicePresence::stopPolling()
+        {
+            std::lock_guard<std::mutex> lock(pollingMutex);
+            if(!isPolling)
+            {
+                return;
+            }
+            OIC_LOG_V(DEBUG, BROKER_TAG, "stopPolling()");
+            isPolling = false;
+            probingResource = nullptr;
+            pollingTimer.cancel(pollingTimerHandle);
+            pollingTimer.cancel(probeTimeoutHandle);
+        }
+
+        long long DevicePresence::nextPollingDelay()
+        {
+            return std::uniform_int_distribution<long long>(
+                    BROKER_SAFE_MILLISECOND - BROKER_POLLING_JITTER_MILLISECOND,
+                    BROKER_SAFE_MILLISECOND + BROKER_POLLING_JITTER_MILLISECOND)(pollingJitter);
+        }
+
+        void DevicePresence::pollingCB(TimerID /*id*/)
+        {
+            OIC_LOG_V(DEBUG, BROKER_TAG, "pollingCB()");
+            std::list<ResourcePresencePtr> resources = getResourcePresences();
+            ResourcePresencePtr probe = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(pollingMutex);
+                if(!isPolling || probingResource != nullptr)
+                {
+                    return;
+                }
+                if(resources.empty())
+                {
+                    isPolling = false;
+                    return;
+                }
+
+                // The resources are probed in turn, so a deleted one is found in time
+                auto it = resources.begin();
+                std::advance(it, nextProbeIndex++ % resources.size());
+                probe = *it;
+                probingResource = probe.get();
+                probeTimeoutHandle = pollingTimer.post(BROKER_SAFE_MILLISECOND, pProbeTimeoutCB);
+            }
+
+            OIC_LOG_V(DEBUG, BROKER_TAG, "probe device : %s", address.c_str());
+            probe->requestResourceState();
+        }
+
+        void DevicePresence::receivedResourceResponse(ResourcePresence * rPresence, int eCode)
+        {
+            {
+                std::lock_guard<std::mutex> lock(pollingMutex);
+                if(!isPolling || probingResource == nullptr || probingResource != rPresence)
+                {
+                    return;
+                }
+                OIC_LOG_V(DEBUG, BROKER_TAG, "receivedResourceResponse() : %d", eCode);
+                probingResource = nullptr;
+                pollingTimer.cancel(probeTimeoutHandle);
+                pollingTimerHandle = pollingTimer.post(nextPollingDelay(), pPollingCB);
+            }
+
+            // A deleted resource tells nothing about the other resources of the device
+            if(eCode == OC_STACK_RESOURCE_DELETED)
+            {
+                return;
+            }
+
+            for(auto & it : getResourcePresences())
+            {
+                if(it.get() != rPresence)
+                {
+                    it->receivedDeviceResponse(eCode);
+                }
+            }
+        }
+
+        void DevicePresence::probeTimeoutCB(TimerID /*id*/)
+        {
+            {
+                std::lock_guard<std::mutex> lock(pollingMutex);
+                if(!isPolling || probingResource == nullptr)
+                {
+                    return;
+                }
+                OIC_LOG_V(DEBUG, BROKER_TAG, "probeTimeoutCB()");
+                probingResource = nullptr;
+            }
+
+            for(auto & it : getResourcePresences())
+            {
+                it->receivedDeviceResponse(OC_STACK_TIMEOUT);
+            }
+
+            // The device is probed again right away, through its next resource
+            pollingCB(0);
+        }
     } // namespace Service
 } // namespace OIC
@@ -84,7 +84,6 @@ namespace OIC
                     std::placeholders::_3, std::weak_ptr<ResourcePresence>(shared_from_this()));
             pTimeoutCB = std::bind(timeOutCallback, std::placeholders::_1,
                     std::weak_ptr<ResourcePresence>(shared_from_this()));
-            pPollingCB = std::bind(&ResourcePresence::pollingCB, this, std::placeholders::_1);
 
             primitiveResource = pResource;
             requesterList
@@ -191,7 +190,8 @@ namespace OIC
                 }
                 DeviceAssociation::getInstance()->addDevice(foundDevice);
             }
-            foundDevice->addPresenceResource(this);
+            devicePresence = foundDevice;
+            foundDevice->addPresenceResource(shared_from_this());
         }
 
         void ResourcePresence::executeAllBrokerCB(BROKER_STATE changedState)
@@ -237,17 +237,6 @@ namespace OIC
                     "Timeout execution. will be discard after receiving cb message.\n");
 
             executeAllBrokerCB(BROKER_STATE::LOST_SIGNAL);
-            pollingCB();
-        }
-
-        void ResourcePresence::pollingCB(unsigned int /*msg*/)
-        {
-            OIC_LOG_V(DEBUG, BROKER_TAG, "pollingCB().\n");
-            if(this->requesterList->size() != 0)
-            {
-                this->requestResourceState();
-                timeoutHandle = expiryTimer.post(BROKER_SAFE_MILLISECOND,pTimeoutCB);
-            }
         }
 
         void ResourcePresence::getCB(const HeaderOptions & /*hos*/,
@@ -255,25 +244,53 @@ namespace OIC
         {
             OIC_LOG_V(DEBUG, BROKER_TAG, "getCB().\n");
             OIC_LOG_V(DEBUG, BROKER_TAG, "waiting for terminate TimeoutCB.\n");
-            std::unique_lock<std::mutex> lock(cbMutex);
+            {
+                std::unique_lock<std::mutex> lock(cbMutex);
 
-            time_t currentTime;
-            time(&currentTime);
-            receivedTime = currentTime;
+                time_t currentTime;
+                time(&currentTime);
+                receivedTime = currentTime;
+
+                verifiedGetResponse(eCode);
 
-            verifiedGetResponse(eCode);
+                if(isWithinTime)
+                {
+                    expiryTimer.cancel(timeoutHandle);
+                    isWithinTime = true;
+                }
+            }
 
-            if(isWithinTime)
+            // The device polls through one of its resources and shares the response
+            DevicePresencePtr device = devicePresence.lock();
+            if(device != nullptr)
             {
-                expiryTimer.cancel(timeoutHandle);
-                isWithinTime = true;
+                device->receivedResourceResponse(this, eCode);
             }
+        }
 
-            if(mode == BROKER_MODE::NON_PRESENCE_MODE)
+        void ResourcePresence::receivedDeviceResponse(int eCode)
+        {
+            OIC_LOG_V(DEBUG, BROKER_TAG, "receivedDeviceResponse().\n");
+            std::unique_lock<std::mutex> lock(cbMutex);
+
+            // Only a response of its own revives a deleted resource
+            if(state == BROKER_STATE::DESTROYED)
             {
-                expiryTimer.post(BROKER_SAFE_MILLISECOND,pPollingCB);
+                return;
             }
 
+            if(eCode == OC_STACK_OK || eCode == OC_STACK_CONTINUE)
+            {
+                time_t currentTime;
+                time(&currentTime);
+                receivedTime = currentTime;
+
+                executeAllBrokerCB(BROKER_STATE::ALIVE);
+            }
+            else if(receivedTime != 0)
+            {
+                executeAllBrokerCB(BROKER_STATE::LOST_SIGNAL);
+            }
         }
 
         void ResourcePresence::verifiedGetResponse(int eCode)
@@ -322,12 +339,8 @@ namespace OIC
             OIC_LOG_V(DEBUG, BROKER_TAG, "changePresenceMode()\n");
             if(newMode != mode)
             {
+                // Without presence, the resource is polled by its device
                 expiryTimer.cancel(timeoutHandle);
-                if(newMode == BROKER_MODE::NON_PRESENCE_MODE)
-                {
-                    timeoutHandle = expiryTimer.post(BROKER_SAFE_MILLISECOND,pTimeoutCB);
-                    requestResourceState();
-                }
                 mode = newMode;
             }
         }
@@ -18,6 +18,9 @@
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 #include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "HippoMocks/hippomocks.h"
@@ -25,6 +28,7 @@
 #include "BrokerTypes.h"
 #include "PrimitiveResource.h"
 #include "ResponseStatement.h"
+#include "RCSResourceAttributes.h"
 #include "OCPlatform.h"
 #include "DevicePresence.h"
 #include "ResourcePresence.h"
@@ -41,6 +45,7 @@ class DevicePresenceTest : public TestWithMock
 {
 public:
     typedef std::function<void(OCStackResult,const unsigned int, const std::string&)> subscribeCallback;
+    typedef std::function<void(const HeaderOptions&, const ResponseStatement&, int)> GetCallback;
     DevicePresence * instance;
     PrimitiveResource::Ptr pResource;
     BrokerCB cb;
@@ -125,7 +130,10 @@ TEST_F(DevicePresenceTest,initializeDevicePresence_ErrorHandlingIfAbnormalResour
 TEST_F(DevicePresenceTest,addPresenceResource_NormalHandlingIfNormalResource)
 {
 
-    ResourcePresence * resource = (ResourcePresence *)new ResourcePresence();
+    ResourcePresencePtr resource(new ResourcePresence(), [](ResourcePresence*)
+                                 {
+
+                                 });
     instance->addPresenceResource(resource);
 
     ASSERT_FALSE(instance->isEmptyResourcePresence());
@@ -157,3 +165,48 @@ TEST_F(DevicePresenceTest,NormalHandlingWhenReceivedCallbackMessage)
     MockingFunc();
 
 }
+
+TEST_F(DevicePresenceTest,pollingCB_PollsDeviceOnceForAllResources)
+{
+    const int resourceCount = 10;
+    std::atomic_int requestCount(0);
+    std::vector<PrimitiveResource::Ptr> resources;
+    std::vector<ResourcePresencePtr> presences;
+
+    mocks.OnCallFuncOverload(static_cast< subscribePresenceSig1 >(OC::OCPlatform::subscribePresence)).Return(OC_STACK_OK);
+    for(int i = 0; i < resourceCount; ++i)
+    {
+        PrimitiveResource::Ptr resource(mocks.Mock< PrimitiveResource >(),
+                                        [](PrimitiveResource*)
+                                        {
+
+                                        });
+        mocks.OnCall(resource.get(), PrimitiveResource::getHost).Return("polledDevice");
+        mocks.OnCall(resource.get(), PrimitiveResource::requestGet).Do(
+                [&requestCount](GetCallback callback)
+                {
+                    ++requestCount;
+                    OIC::Service::HeaderOptions op;
+                    RCSResourceAttributes attr;
+                    OIC::Service::ResponseStatement res(attr);
+
+                    callback(op,res,OC_STACK_OK);
+                });
+
+        ResourcePresencePtr presence = std::make_shared<ResourcePresence>();
+        presence->initializeResourcePresence(resource);
+        resources.push_back(resource);
+        presences.push_back(presence);
+    }
+
+    std::cout<<"wait while polling device without presence\n";
+    sleep(BROKER_SAFE_SECOND * 2 + 1);
+
+    // Past the first request of each resource, a single request polls the whole device
+    ASSERT_LE(requestCount, resourceCount + 3);
+    for(auto & presence : presences)
+    {
+        ASSERT_EQ(BROKER_STATE::ALIVE, presence->getResourceState());
+    }
+    presences.clear();
+}
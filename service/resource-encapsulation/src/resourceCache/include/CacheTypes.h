@@ -55,6 +55,27 @@ namespace OIC
             int reportID;
             long repeatTime;
             unsigned int timerID;
+            unsigned long long reportedVersion;
+        };
+
+        /*
+         * @CacheStatistics
+         * brief : counters of a data cache, shared by all of its subscribers
+         * hits          - Reads answered with up-to-date data
+         * misses        - Reads which found no data or out-of-date data
+         * getRequests   - GET requests sent to the remote resource
+         * notifications - Observe notifications received from the remote resource
+         * changes       - Received updates which changed the cached data
+         * staleness     - Milliseconds since the last update, -1 before the first one
+         */
+        struct CacheStatistics
+        {
+            unsigned long long hits;
+            unsigned long long misses;
+            unsigned long long getRequests;
+            unsigned long long notifications;
+            unsigned long long changes;
+            long long staleness;
         };
 
         enum class CACHE_STATE
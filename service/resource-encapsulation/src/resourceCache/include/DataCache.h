@@ -21,6 +21,7 @@
 #ifndef RCM_DATACACHE_H_
 #define RCM_DATACACHE_H_
 
+#include <atomic>
 #include <list>
 #include <string>
 #include <memory>
@@ -61,6 +62,8 @@ namespace OIC
                 bool isEmptySubscriber() const;
                 bool isCachedData() const;
 
+                CacheStatistics getStatistics() const;
+
             private:
                 // resource instance
                 PrimitiveResourcePtr sResource;
@@ -81,6 +84,20 @@ namespace OIC
                 TimerID networkTimeOutHandle;
                 TimerID pollingHandle;
 
+                // periodic reports, guarded by m_mutex
+                ExpiryTimer reportTimer;
+
+                // version of the cached data, guarded by att_mutex
+                unsigned long long dataVersion;
+
+                // statistics
+                mutable std::atomic<unsigned long long> hitCount;
+                mutable std::atomic<unsigned long long> missCount;
+                std::atomic<unsigned long long> getRequestCount;
+                std::atomic<unsigned long long> notificationCount;
+                std::atomic<unsigned long long> changeCount;
+                std::atomic<long long> lastUpdateTime;
+
                 ObserveCB pObserveCB;
                 GetCB pGetCB;
                 TimerCB pTimerCB;
@@ -92,10 +109,14 @@ namespace OIC
                 void onObserve(const HeaderOptions &_hos,
                                const ResponseStatement &_rep, int _result, unsigned int _seq);
                 void onGet(const HeaderOptions &_hos, const ResponseStatement &_rep, int _result);
+                void onReportOut(const unsigned int timerID, CacheID id);
             private:
                 void onTimeOut(const unsigned int timerID);
                 void onPollingOut(const unsigned int timerID);
 
+                void sendGet();
+                void markUpdated();
+
                 CacheID generateCacheID();
                 SubscriberInfoPair findSubscriber(CacheID id);
                 void notifyObservers(const RCSResourceAttributes Att, int eCode);
@@ -31,6 +31,7 @@
 #include <string>
 #include <mutex>
 #include <map>
+#include <unordered_map>
 
 #include "CacheTypes.h"
 #include "DataCache.h"
@@ -166,6 +167,20 @@ namespace OIC
                  */
                 bool isCachedData(CacheID id) const;
 
+                /**
+                 * Gets the statistics of the data cache shared by the given cache id.
+                 *
+                 * @param id Cache Id.
+                 *
+                 * @return Statistics of the data cache.
+                 *
+                 * @throw InvalidParameterException In case of invalid Cache id.
+                 *
+                 * @see requestResourceCache
+                 * @see CacheStatistics
+                 */
+                CacheStatistics getCacheStatistics(CacheID id) const;
+
                 /**
                  * Stops resource cache manager.
                  *
@@ -176,7 +191,9 @@ namespace OIC
                 static ResourceCacheManager *s_instance;
                 static std::mutex s_mutex;
                 static std::mutex s_mutexForCreation;
-                static std::unique_ptr<std::list<DataCachePtr>> s_cacheDataList;
+                // data caches keyed by the host and the uri of their resource
+                static std::unique_ptr<std::unordered_map<std::string, DataCachePtr>>
+                s_cacheDataList;
                 std::map<CacheID, DataCachePtr> cacheIDmap;
 
                 std::list<ObserveCache::Ptr> m_observeCacheList;
@@ -191,7 +208,7 @@ namespace OIC
                 ResourceCacheManager &operator=(ResourceCacheManager && ) const = delete;
 
                 static void initializeResourceCacheManager();
-                DataCachePtr findDataCache(PrimitiveResourcePtr pResource) const;
+                static std::string getCacheKey(PrimitiveResourcePtr pResource);
                 DataCachePtr findDataCache(CacheID id) const;
         };
     } // namespace Service
@@ -24,6 +24,7 @@
 #include <map>
 #include <utility>
 #include <ctime>
+#include <chrono>
 
 #include "DataCache.h"
 
@@ -75,6 +76,27 @@ namespace OIC
                                  std::placeholders::_1, std::placeholders::_2,
                                  std::placeholders::_3, rpPtr);
             }
+
+            void verifyReportCB(
+                const unsigned int timerID, CacheID id, std::weak_ptr<DataCache> rpPtr)
+            {
+                std::shared_ptr<DataCache> Ptr = rpPtr.lock();
+                if (Ptr)
+                {
+                    Ptr->onReportOut(timerID, id);
+                }
+            }
+
+            DataCache::TimerCB verifiedReportCB(CacheID id, std::weak_ptr<DataCache> rpPtr)
+            {
+                return std::bind(verifyReportCB, std::placeholders::_1, id, rpPtr);
+            }
+
+            long long currentMilliTime()
+            {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
         }
 
         DataCache::DataCache()
@@ -90,6 +112,14 @@ namespace OIC
             pollingHandle = 0;
             lastSequenceNum = 0;
             isReady = false;
+
+            dataVersion = 0;
+            hitCount = 0;
+            missCount = 0;
+            getRequestCount = 0;
+            notificationCount = 0;
+            changeCount = 0;
+            lastUpdateTime = -1;
         }
 
         DataCache::~DataCache()
@@ -123,7 +153,7 @@ namespace OIC
             pTimerCB = (TimerCB)(std::bind(&DataCache::onTimeOut, this, std::placeholders::_1));
             pPollingCB = (TimerCB)(std::bind(&DataCache::onPollingOut, this, std::placeholders::_1));
 
-            sResource->requestGet(pGetCB);
+            sendGet();
             if (sResource->isObservable())
             {
                 sResource->requestObserve(pObserveCB);
@@ -137,12 +167,19 @@ namespace OIC
             newItem.rf = rf;
             newItem.repeatTime = repeatTime;
             newItem.timerID = 0;
+            newItem.reportedVersion = 0;
 
             newItem.reportID = generateCacheID();
 
             std::lock_guard<std::mutex> lock(m_mutex);
             if (subscriberList != nullptr)
             {
+                if (rf == REPORT_FREQUENCY::PERIODICTY)
+                {
+                    newItem.timerID = reportTimer.post(repeatTime,
+                            verifiedReportCB(newItem.reportID,
+                                             std::weak_ptr<DataCache>(shared_from_this())));
+                }
                 subscriberList->insert(
                     std::make_pair(newItem.reportID, std::make_pair(newItem, func)));
             }
@@ -160,6 +197,10 @@ namespace OIC
             if (pair.first != 0)
             {
                 ret = pair.first;
+                if (pair.second.first.rf == REPORT_FREQUENCY::PERIODICTY)
+                {
+                    reportTimer.cancel(pair.second.first.timerID);
+                }
                 subscriberList->erase(pair.first);
             }
 
@@ -194,8 +235,10 @@ namespace OIC
             std::lock_guard<std::mutex> lock(att_mutex);
             if (state != CACHE_STATE::READY)
             {
+                missCount++;
                 return RCSResourceAttributes();
             }
+            hitCount++;
             return attributes;
         }
 
@@ -204,11 +247,32 @@ namespace OIC
             return isReady;
         }
 
+        CacheStatistics DataCache::getStatistics() const
+        {
+            CacheStatistics statistics;
+            statistics.hits = hitCount;
+            statistics.misses = missCount;
+            statistics.getRequests = getRequestCount;
+            statistics.notifications = notificationCount;
+            statistics.changes = changeCount;
+
+            long long updateTime = lastUpdateTime;
+            statistics.staleness = (updateTime < 0) ? -1 : currentMilliTime() - updateTime;
+            return statistics;
+        }
+
+        void DataCache::markUpdated()
+        {
+            lastUpdateTime = currentMilliTime();
+        }
+
         void DataCache::onObserve(const HeaderOptions & /*_hos*/,
                                   const ResponseStatement &_rep, int _result, unsigned int _seq)
         {
 
             lastSequenceNum = _seq;
+            notificationCount++;
+            markUpdated();
 
             if (state != CACHE_STATE::READY)
             {
@@ -216,9 +280,11 @@ namespace OIC
                 isReady = true;
             }
 
+            // Notifications keep the cache up to date, polling is no longer needed
             if (mode != CACHE_MODE::OBSERVE)
             {
                 mode = CACHE_MODE::OBSERVE;
+                pollingTimer.cancel(pollingHandle);
             }
 
             networkTimer.cancel(networkTimeOutHandle);
@@ -234,6 +300,7 @@ namespace OIC
             {
                 return;
             }
+            markUpdated();
 
             if (state != CACHE_STATE::READY)
             {
@@ -262,16 +329,61 @@ namespace OIC
                     return;
                 }
                 attributes = Att;
+                dataVersion++;
             }
+            changeCount++;
 
-            std::lock_guard<std::mutex> lock(m_mutex);
-            for (auto &i : * subscriberList)
+            // Periodic subscribers receive the change with their next report
+            std::list<CacheCB> callbacks;
             {
-                if (i.second.first.rf == REPORT_FREQUENCY::UPTODATE)
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto &i : * subscriberList)
                 {
-                    i.second.second(this->sResource, Att, eCode);
+                    if (i.second.first.rf == REPORT_FREQUENCY::UPTODATE)
+                    {
+                        callbacks.push_back(i.second.second);
+                    }
                 }
             }
+
+            for (auto &callback : callbacks)
+            {
+                callback(this->sResource, Att, eCode);
+            }
+        }
+
+        void DataCache::onReportOut(const unsigned int /*timerID*/, CacheID id)
+        {
+            CacheCB callback = nullptr;
+            RCSResourceAttributes reportedAttributes;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto found = subscriberList->find(id);
+                if (found == subscriberList->end())
+                {
+                    return;
+                }
+
+                // Only a change since the last report is reported
+                Report_Info &info = found->second.first;
+                {
+                    std::lock_guard<std::mutex> attLock(att_mutex);
+                    if (isReady && info.reportedVersion != dataVersion)
+                    {
+                        callback = found->second.second;
+                        reportedAttributes = attributes;
+                        info.reportedVersion = dataVersion;
+                    }
+                }
+
+                info.timerID = reportTimer.post(info.repeatTime,
+                        verifiedReportCB(id, std::weak_ptr<DataCache>(shared_from_this())));
+            }
+
+            if (callback)
+            {
+                callback(this->sResource, reportedAttributes, OC_STACK_OK);
+            }
         }
 
         CACHE_STATE DataCache::getCacheState() const
@@ -297,13 +409,22 @@ namespace OIC
             state = CACHE_STATE::LOST_SIGNAL;
         }
         void DataCache::onPollingOut(const unsigned int /*timerID*/)
+        {
+            // A notification received since the poll was scheduled makes it needless
+            if (mode == CACHE_MODE::OBSERVE)
+            {
+                return;
+            }
+            sendGet();
+        }
+
+        void DataCache::sendGet()
         {
             if (sResource != nullptr)
             {
-                mode = CACHE_MODE::FREQUENCY;
+                getRequestCount++;
                 sResource->requestGet(pGetCB);
             }
-            return;
         }
 
         CacheID DataCache::generateCacheID()
@@ -324,10 +445,7 @@ namespace OIC
         void DataCache::requestGet()
         {
             state = CACHE_STATE::UPDATING;
-            if (sResource != nullptr)
-            {
-                sResource->requestGet(pGetCB);
-            }
+            sendGet();
         }
 
         bool DataCache::isEmptySubscriber() const
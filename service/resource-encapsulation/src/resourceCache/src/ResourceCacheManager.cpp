@@ -29,7 +29,8 @@ namespace OIC
         ResourceCacheManager *ResourceCacheManager::s_instance = nullptr;
         std::mutex ResourceCacheManager::s_mutexForCreation;
         std::mutex ResourceCacheManager::s_mutex;
-        std::unique_ptr<std::list<DataCachePtr>> ResourceCacheManager::s_cacheDataList(nullptr);
+        std::unique_ptr<std::unordered_map<std::string, DataCachePtr>>
+        ResourceCacheManager::s_cacheDataList(nullptr);
 
         void ResourceCacheManager::stopResourceCacheManager()
         {
@@ -108,17 +109,24 @@ namespace OIC
                 }
             }
 
-            DataCachePtr newHandler = findDataCache(pResource);
-            if (newHandler == nullptr)
+            // All the subscribers of a resource share a single data cache
+            std::string key = getCacheKey(pResource);
+            std::lock_guard<std::mutex> lock(s_mutex);
+            DataCachePtr handler;
+            auto found = s_cacheDataList->find(key);
+            if (found != s_cacheDataList->end())
             {
-                std::lock_guard<std::mutex> lock(s_mutex);
-                newHandler.reset(new DataCache());
-                newHandler->initializeDataCache(pResource);
-                s_cacheDataList->push_back(newHandler);
+                handler = found->second;
+            }
+            else
+            {
+                handler.reset(new DataCache());
+                handler->initializeDataCache(pResource);
+                s_cacheDataList->insert(std::make_pair(key, handler));
             }
-            retID = newHandler->addSubscriber(func, rf, reportTime);
+            retID = handler->addSubscriber(func, rf, reportTime);
 
-            cacheIDmap.insert(std::make_pair(retID, newHandler));
+            cacheIDmap.insert(std::make_pair(retID, handler));
 
             return retID;
         }
@@ -126,8 +134,8 @@ namespace OIC
         void ResourceCacheManager::cancelResourceCache(CacheID id)
         {
             auto observeIns = observeCacheIDmap.find(id);
-            auto dataCacheIns = cacheIDmap.find(id);
-            if ((dataCacheIns == cacheIDmap.end() && observeIns == observeCacheIDmap.end())
+            DataCachePtr foundCacheHandler = findDataCache(id);
+            if ((foundCacheHandler == nullptr && observeIns == observeCacheIDmap.end())
                 || id == 0)
             {
                 throw RCSInvalidParameterException {"[cancelResourceCache] CacheID is invaild"};
@@ -150,18 +158,22 @@ namespace OIC
                 return;
             }
 
-            DataCachePtr foundCacheHandler = findDataCache(id);
             if (foundCacheHandler != nullptr)
             {
                 CacheID retID = foundCacheHandler->deleteSubscriber(id);
+                std::lock_guard<std::mutex> lock(s_mutex);
                 if (retID == id)
                 {
                     cacheIDmap.erase(id);
                 }
-                std::lock_guard<std::mutex> lock(s_mutex);
                 if (foundCacheHandler->isEmptySubscriber())
                 {
-                    s_cacheDataList->remove(foundCacheHandler);
+                    auto found = s_cacheDataList->find(
+                            getCacheKey(foundCacheHandler->getPrimitiveResource()));
+                    if (found != s_cacheDataList->end() && found->second == foundCacheHandler)
+                    {
+                        s_cacheDataList->erase(found);
+                    }
                 }
             }
         }
@@ -200,12 +212,14 @@ namespace OIC
                 throw RCSInvalidParameterException {"[getCachedData] CacheID is invaild"};
             }
 
+            // Read first so that a read without cached data is counted as a miss
+            RCSResourceAttributes attributes = handler->getCachedData();
             if (handler->isCachedData() == false)
             {
                 throw HasNoCachedDataException {"[getCachedData] Cached Data is not stored"};
             }
 
-            return handler->getCachedData();
+            return attributes;
         }
 
         CACHE_STATE ResourceCacheManager::getResourceCacheState(CacheID id) const
@@ -250,45 +264,45 @@ namespace OIC
             return handler->isCachedData();
         }
 
-        void ResourceCacheManager::initializeResourceCacheManager()
+        CacheStatistics ResourceCacheManager::getCacheStatistics(CacheID id) const
         {
-            std::lock_guard<std::mutex> lock(s_mutex);
-            if (s_cacheDataList == nullptr)
+            if (id == 0)
+            {
+                throw RCSInvalidParameterException {"[getCacheStatistics] CacheID is NULL"};
+            }
+
+            DataCachePtr handler = findDataCache(id);
+            if (handler == nullptr)
             {
-                s_cacheDataList
-                    = std::unique_ptr<std::list<DataCachePtr>>(new std::list<DataCachePtr>);
+                throw RCSInvalidParameterException {"[getCacheStatistics] CacheID is invaild"};
             }
+            return handler->getStatistics();
         }
 
-        DataCachePtr ResourceCacheManager::findDataCache(PrimitiveResourcePtr pResource) const
+        void ResourceCacheManager::initializeResourceCacheManager()
         {
-            DataCachePtr retHandler = nullptr;
             std::lock_guard<std::mutex> lock(s_mutex);
-            for (auto &i : * s_cacheDataList)
+            if (s_cacheDataList == nullptr)
             {
-                if (i->getPrimitiveResource()->getUri() == pResource->getUri() &&
-                    i->getPrimitiveResource()->getHost() == pResource->getHost())
-                {
-                    retHandler = i;
-                    break;
-                }
+                s_cacheDataList = std::unique_ptr<std::unordered_map<std::string, DataCachePtr>>(
+                                      new std::unordered_map<std::string, DataCachePtr>);
             }
-            return retHandler;
+        }
+
+        std::string ResourceCacheManager::getCacheKey(PrimitiveResourcePtr pResource)
+        {
+            return pResource->getHost() + pResource->getUri();
         }
 
         DataCachePtr ResourceCacheManager::findDataCache(CacheID id) const
         {
-            DataCachePtr retHandler = nullptr;
-            for (auto it : cacheIDmap)
+            std::lock_guard<std::mutex> lock(s_mutex);
+            auto found = cacheIDmap.find(id);
+            if (found == cacheIDmap.end())
             {
-                if (it.first == id)
-                {
-                    retHandler = it.second;
-                    break;
-                }
+                return nullptr;
             }
-
-            return retHandler;
+            return found->second;
         }
     } // namespace Service
 } // namespace OIC
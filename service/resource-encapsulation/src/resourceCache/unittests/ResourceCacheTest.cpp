@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <mutex>
+#include <vector>
 
 #include "ResourceCacheManager.h"
 #include "UnitTestHelper.h"
@@ -51,6 +52,8 @@ class ResourceCacheManagerTest : public TestWithMock
                 pResource = PrimitiveResource::Ptr(mocks.Mock< PrimitiveResource >(), deleter);
             });
             mocks.OnCall(pResource.get(), PrimitiveResource::isObservable).Return(false);
+            mocks.OnCall(pResource.get(), PrimitiveResource::getUri).Return("testUri");
+            mocks.OnCall(pResource.get(), PrimitiveResource::getHost).Return("testHost");
             cb = ([](std::shared_ptr<PrimitiveResource >,
                     const RCSResourceAttributes &, int) -> OCStackResult
                     {
@@ -217,6 +220,74 @@ TEST_F(ResourceCacheManagerTest, getResourceCacheStateCacheID_handlerIsNULL)
     ASSERT_EQ(cacheInstance->getResourceCacheState(id), CACHE_STATE::NONE);
 }
 
+TEST_F(ResourceCacheManagerTest, getCacheStatistics_cacheIDIsZero)
+{
+
+    ASSERT_THROW(cacheInstance->getCacheStatistics(0), RCSInvalidParameterException);
+}
+
+TEST_F(ResourceCacheManagerTest, getCacheStatistics_countsMissesAndGetRequests)
+{
+    mocks.OnCall(pResource.get(), PrimitiveResource::requestGet);
+    mocks.OnCall(pResource.get(), PrimitiveResource::isObservable).Return(false);
+
+    id = cacheInstance->requestResourceCache(pResource, cb, CACHE_METHOD::ITERATED_GET,
+                                             REPORT_FREQUENCY::UPTODATE, 0l);
+
+    ASSERT_THROW(cacheInstance->getCachedData(id), ResourceCacheManager::HasNoCachedDataException);
+    CacheStatistics statistics = cacheInstance->getCacheStatistics(id);
+
+    cacheInstance->cancelResourceCache(id);
+
+    ASSERT_EQ(1u, statistics.getRequests);
+    ASSERT_EQ(0u, statistics.hits);
+    ASSERT_EQ(1u, statistics.misses);
+    ASSERT_EQ(-1, statistics.staleness);
+}
+
+TEST_F(ResourceCacheManagerTest, RequestCacheSharedBySubscribers)
+{
+    constexpr int NUM_OF_RESOURCE = 10;
+
+    MockRepository resourceMocks;
+    int getCount = 0;
+    int observeCount = 0;
+
+    std::vector< PrimitiveResource::Ptr > resources;
+    for (int i = 0; i < NUM_OF_RESOURCE; ++i)
+    {
+        PrimitiveResource *resource = resourceMocks.Mock< PrimitiveResource >();
+        resourceMocks.OnCall(resource, PrimitiveResource::requestGet).Do(
+            [&getCount](PrimitiveResource::GetCallback) { ++getCount; });
+        resourceMocks.OnCall(resource, PrimitiveResource::requestObserve).Do(
+            [&observeCount](PrimitiveResource::ObserveCallback) { ++observeCount; });
+        resourceMocks.OnCall(resource, PrimitiveResource::isObservable).Return(true);
+        resourceMocks.OnCall(resource, PrimitiveResource::cancelObserve);
+        resourceMocks.OnCall(resource, PrimitiveResource::getUri).Return(
+            "/a/light/" + std::to_string(i));
+        resourceMocks.OnCall(resource, PrimitiveResource::getHost).Return("coap://10.0.0.1");
+        resources.push_back(PrimitiveResource::Ptr(resource, [](PrimitiveResource *) { }));
+    }
+
+    std::vector< CacheID > ids;
+    for (int subscriber = 0; subscriber < 2; ++subscriber)
+    {
+        for (auto &resource : resources)
+        {
+            ids.push_back(cacheInstance->requestResourceCache(resource, cb,
+                    CACHE_METHOD::ITERATED_GET, REPORT_FREQUENCY::UPTODATE, 0l));
+        }
+    }
+
+    for (auto &cacheID : ids)
+    {
+        cacheInstance->cancelResourceCache(cacheID);
+    }
+
+    ASSERT_EQ(NUM_OF_RESOURCE, getCount);
+    ASSERT_EQ(NUM_OF_RESOURCE, observeCount);
+}
+
 TEST_F(ResourceCacheManagerTest, getResourceCacheStateCacheID_normalCase)
 {
     mocks.OnCall(pResource.get(), PrimitiveResource::requestGet);
@@ -56,7 +56,7 @@ class ClientController
                 int choice = -1;
                 std::cout << "Enter your choice: ";
                 std::cin >> choice;
-                if (choice < 0 || choice > 14)
+                if (choice < 0 || choice > 15)
                 {
                     std::cout << "Invaild choice !" << std::endl; continue;
                 }
@@ -76,7 +76,8 @@ class ClientController
                     case 11: configure(); break;
                     case 12: getDeviceInfo(); break;
                     case 13: getPlatformInfo(); break;
-                    case 14: printMenu(); break;
+                    case 14: generateLoad(); break;
+                    case 15: printMenu(); break;
                     case 0: cont = false;
                 }
             }
@@ -99,7 +100,8 @@ class ClientController
             std::cout << "11. Configure (using RAML file)" << std::endl;
             std::cout << "12. Get Device Information" << std::endl;
             std::cout << "13. Get Platform Information" << std::endl;
-            std::cout << "14: Help" << std::endl;
+            std::cout << "14. Generate load" << std::endl;
+            std::cout << "15: Help" << std::endl;
             std::cout << "0. Exit" << std::endl;
             std::cout << "###################################################" << std::endl;
         }
@@ -500,6 +502,68 @@ class ClientController
             }
         }
 
+        void generateLoad()
+        {
+            SimulatorRemoteResourceSP resource = selectResource();
+            if (!resource)
+            {
+                return;
+            }
+
+            LoadGenerationConfig config;
+            int openLoop = 0;
+            std::cout << "Open loop (0: No, 1: Yes): ";
+            std::cin >> openLoop;
+            config.mode = openLoop ? LOAD_OPEN_LOOP : LOAD_CLOSED_LOOP;
+            std::cout << "Weights of GET, PUT and POST requests: ";
+            std::cin >> config.getWeight >> config.putWeight >> config.postWeight;
+            std::cout << "Concurrency: ";
+            std::cin >> config.concurrency;
+            if (openLoop)
+            {
+                std::cout << "Requests per second: ";
+                std::cin >> config.rate;
+            }
+            std::cout << "Duration in seconds: ";
+            std::cin >> config.duration;
+
+            SimulatorRemoteResource::AutoRequestGenerationCallback callback =
+                [] (const std::string & uid, int sessionId, OperationState state)
+            {
+                std::cout << "\nLoad generation status received ![id:  " << sessionId <<
+                          "  State: " << getOperationStateString(state) << " UID: " << uid << "]" <<
+                          std::endl;
+            };
+
+            SimulatorRemoteResource::LoadGenerationReportCallback reportCallback =
+                [] (const std::string & uid, int sessionId, const std::string & report)
+            {
+                std::cout << "\nLoad generation report ![id:  " << sessionId << " UID: " << uid
+                          << "]" << std::endl << report << std::endl;
+            };
+
+            try
+            {
+                int id = resource->startLoadGeneration(config, callback, reportCallback);
+                std::cout << "startLoadGeneration is successful!id: " << id << std::endl;
+            }
+            catch (InvalidArgsException &e)
+            {
+                std::cout << "InvalidArgsException occured [code : " << e.code() << " Detail: "
+                          << e.what() << "]" << std::endl;
+            }
+            catch (NoSupportException &e)
+            {
+                std::cout << "NoSupportException occured [code : " << e.code() << " Detail: " <<
+                          e.what() << "]" << std::endl;
+            }
+            catch (SimulatorException &e)
+            {
+                std::cout << "SimulatorException occured [code : " << e.code() << " Detail: " <<
+                          e.what() << "]" << std::endl;
+            }
+        }
+
         void configure()
         {
             SimulatorRemoteResourceSP resource = selectResource();
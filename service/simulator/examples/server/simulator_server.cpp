@@ -374,7 +374,8 @@ void printMainMenu()
     std::cout << "10. Set Device Info" << std::endl;
     std::cout << "11. Set Platform Info" << std::endl;
     std::cout << "12. Add Interface" << std::endl;
-    std::cout << "13. Help" << std::endl;
+    std::cout << "13. Simulate resources in bulk" << std::endl;
+    std::cout << "14. Help" << std::endl;
     std::cout << "0. Exit" << std::endl;
     std::cout << "######################################" << std::endl;
 }
@@ -477,6 +478,62 @@ void addInterface()
     resource->addInterface(OC_RSRVD_INTERFACE_ACTUATOR);
 }
 
+void simulateResourcesInBulk()
+{
+    std::string configPath;
+    std::cout << "Enter RAML path: ";
+    std::cin >> configPath;
+
+    unsigned int count = 0;
+    std::cout << "Number of resources: ";
+    std::cin >> count;
+
+    int interval = 0;
+    std::cout << "Update interval of each resource (ms): ";
+    std::cin >> interval;
+
+    double rate = 0;
+    std::cout << "Updates per second of all the resources (0 for no limit): ";
+    std::cin >> rate;
+
+    SimulatorSingleResource::AutoUpdateCompleteCallback callback =
+        [](const std::string &, const int) {};
+
+    try
+    {
+        SimulatorManager::getInstance()->setAutoUpdateRate(rate);
+
+        std::vector<SimulatorResourceSP> resources =
+            SimulatorManager::getInstance()->createResource(configPath, count);
+        for (auto &resource : resources)
+        {
+            SimulatorSingleResourceSP singleRes =
+                std::dynamic_pointer_cast<SimulatorSingleResource>(resource);
+            if (!singleRes)
+            {
+                std::cout << "Only single type resources are automated!" << std::endl;
+                return;
+            }
+
+            singleRes->start();
+            singleRes->startResourceUpdation(AutoUpdateType::REPEAT, interval, callback);
+            g_singleResources.push_back(singleRes);
+        }
+
+        std::cout << resources.size() << " resources created and started" << std::endl;
+    }
+    catch (InvalidArgsException &e)
+    {
+        std::cout << "InvalidArgsException occured [code : " << e.code() << " Details: "
+                  << e.what() << "]" << std::endl;
+    }
+    catch (SimulatorException &e)
+    {
+        std::cout << "SimulatorException occured [code : " << e.code() << " Details: "
+                  << e.what() << "]" << std::endl;
+    }
+}
+
 int main()
 {
     printMainMenu();
@@ -486,7 +543,7 @@ int main()
         int choice = -1;
         std::cout << "Enter your choice: ";
         std::cin >> choice;
-        if (choice < 0 || choice > 14)
+        if (choice < 0 || choice > 15)
         {
             std::cout << "Invaild choice !" << std::endl; continue;
         }
@@ -505,7 +562,8 @@ int main()
             case 10: setDeviceInfo(); break;
             case 11: setPlatformInfo(); break;
             case 12: addInterface(); break;
-            case 13: printMainMenu(); break;
+            case 13: simulateResourcesInBulk(); break;
+            case 14: printMainMenu(); break;
             case 0: cont = false;
         }
     }
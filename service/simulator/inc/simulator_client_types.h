@@ -54,6 +54,47 @@ typedef enum
     OP_ABORT
 } OperationState;
 
+typedef enum
+{
+    /** A fixed number of requests is kept outstanding, each response sends the next one. */
+    LOAD_CLOSED_LOOP,
+
+    /** Requests are sent at a fixed rate, whether responses come back or not. */
+    LOAD_OPEN_LOOP
+} LoadGenerationMode;
+
+/**
+ * Configuration of a load generation session.
+ */
+struct LoadGenerationConfig
+{
+    LoadGenerationConfig()
+        :   mode(LOAD_CLOSED_LOOP),
+            getWeight(1),
+            putWeight(0),
+            postWeight(0),
+            concurrency(1),
+            rate(0),
+            duration(10) {}
+
+    /** Rate control of the session. */
+    LoadGenerationMode mode;
+
+    /** Relative weights of the GET, PUT and POST requests in the mix. */
+    unsigned int getWeight;
+    unsigned int putWeight;
+    unsigned int postWeight;
+
+    /** Requests kept outstanding in closed loop, most requests outstanding in open loop. */
+    unsigned int concurrency;
+
+    /** Requests sent per second in open loop. */
+    double rate;
+
+    /** Duration of the session, in seconds. */
+    unsigned int duration;
+};
+
 typedef enum
 {
     /** use when defaults are ok. */
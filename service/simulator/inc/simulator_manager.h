@@ -192,6 +192,18 @@ class SimulatorManager
          */
         void setPlatformInfo(PlatformInfo &platformInfo);
 
+        /**
+         * API for limiting the rate of the automatic updates of all the simulated
+         * resources together, and so the rate of their notifications. Updates due
+         * beyond the rate are delayed and spread evenly, which lets thousands of
+         * resources created with the same RAML file be updated at an aggregate rate.
+         *
+         * @param updatesPerSecond - Highest rate of the updates, 0 for no limit.
+         *
+         * NOTE: API throws @InvalidArgsException on error.
+         */
+        void setAutoUpdateRate(double updatesPerSecond);
+
         /**
          * API for setting logger target for receiving the log messages.
          *
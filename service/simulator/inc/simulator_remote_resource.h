@@ -82,6 +82,17 @@ class SimulatorRemoteResource : private UnCopyable
         typedef std::function<void(const std::string &uid, int id, OperationState state)>
         AutoRequestGenerationCallback;
 
+        /**
+         * Callback method for receiving the report of a load generation session.
+         *
+         * @param uid - Identifier of remote resource.
+         * @param id - Load generation id.
+         * @param report - Throughput, error counts and latency percentiles of the
+         * session, as a JSON document.
+         */
+        typedef std::function<void(const std::string &uid, int id, const std::string &report)>
+        LoadGenerationReportCallback;
+
         /**
          * API for getting URI of resource.
          *
@@ -291,6 +302,24 @@ class SimulatorRemoteResource : private UnCopyable
          * @param id - Identifier of auto request generating session.
          */
         virtual void stopAutoRequesting(int id) = 0;
+
+        /**
+         * API to start sending a mix of requests to remote resource for measuring
+         * the throughput and latency it sustains. GET requests are sent without query
+         * parameters, PUT and POST requests with the representation built from the
+         * request models set with configure().
+         *
+         * @param config - Request mix, rate control and duration of the session.
+         * @param callback - callback for receiving progress state of the session.
+         * @param reportCallback - callback for receiving the report of the session,
+         * called before its completion is notified.
+         *
+         * @return Identifier of load generation session. This id should be used
+         * for stopping the same with stopAutoRequesting().
+         */
+        virtual int startLoadGeneration(const LoadGenerationConfig &config,
+                                        AutoRequestGenerationCallback callback,
+                                        LoadGenerationReportCallback reportCallback) = 0;
 };
 
 typedef std::shared_ptr<SimulatorRemoteResource> SimulatorRemoteResourceSP;
@@ -0,0 +1,153 @@
+/******************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "latency_histogram.h"
+
+#include <cmath>
+#include <sstream>
+
+// Values below 2 * SUB_BUCKET_COUNT are kept exactly
+#define SUB_BUCKET_BITS 6
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+
+// Largest value kept, about 19 hours in microseconds
+#define MAX_VALUE_BITS 36
+#define MAX_VALUE ((UINT64_C(1) << MAX_VALUE_BITS) - 1)
+
+#define BUCKET_COUNT ((MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT)
+
+LatencyHistogram::LatencyHistogram()
+    :   m_counts(BUCKET_COUNT, 0),
+        m_count(0),
+        m_min(UINT64_MAX),
+        m_max(0),
+        m_sum(0) {}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < 2 * SUB_BUCKET_COUNT)
+    {
+        return (size_t)value;
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BUCKET_BITS;
+    return (size_t)shift * SUB_BUCKET_COUNT + (size_t)(value >> shift);
+}
+
+uint64_t LatencyHistogram::highestEquivalentValue(size_t index)
+{
+    if (index < 2 * SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+
+    int shift = (int)(index / SUB_BUCKET_COUNT) - 1;
+    uint64_t subBucket = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    if (value > MAX_VALUE)
+    {
+        value = MAX_VALUE;
+    }
+
+    m_counts[bucketIndex(value)]++;
+    m_count++;
+    m_sum += value;
+    if (value < m_min)
+    {
+        m_min = value;
+    }
+    if (value > m_max)
+    {
+        m_max = value;
+    }
+}
+
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    for (size_t i = 0; i < m_counts.size(); i++)
+    {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    if (other.m_min < m_min)
+    {
+        m_min = other.m_min;
+    }
+    if (other.m_max > m_max)
+    {
+        m_max = other.m_max;
+    }
+}
+
+uint64_t LatencyHistogram::min() const
+{
+    return m_count ? m_min : 0;
+}
+
+double LatencyHistogram::mean() const
+{
+    return m_count ? m_sum / m_count : 0;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const
+{
+    if (!m_count)
+    {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)std::ceil(percentile / 100 * m_count);
+    if (target < 1)
+    {
+        target = 1;
+    }
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < m_counts.size(); i++)
+    {
+        cumulative += m_counts[i];
+        if (cumulative >= target)
+        {
+            uint64_t value = highestEquivalentValue(i);
+            return (value < m_max) ? value : m_max;
+        }
+    }
+    return m_max;
+}
+
+std::string LatencyHistogram::toJSON() const
+{
+    std::ostringstream json;
+    json << "{\"count\":" << m_count
+         << ",\"min\":" << min()
+         << ",\"mean\":" << (uint64_t)std::llround(mean())
+         << ",\"p50\":" << percentile(50)
+         << ",\"p90\":" << percentile(90)
+         << ",\"p99\":" << percentile(99)
+         << ",\"p999\":" << percentile(99.9)
+         << ",\"max\":" << m_max << "}";
+    return json.str();
+}
@@ -0,0 +1,79 @@
+/******************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file latency_histogram.h
+ *
+ * @brief This file provides a histogram of request latencies.
+ *
+ */
+
+#ifndef SIMULATOR_LATENCY_HISTOGRAM_H_
+#define SIMULATOR_LATENCY_HISTOGRAM_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Histogram of latencies in microseconds, in the manner of HdrHistogram: each power
+ * of two is split in 64 linear buckets, so that every recorded value is kept with a
+ * relative error below 1/64 whatever its magnitude, in a fixed amount of memory.
+ */
+class LatencyHistogram
+{
+    public:
+        LatencyHistogram();
+
+        void record(uint64_t value);
+        void add(const LatencyHistogram &other);
+
+        uint64_t count() const
+        {
+            return m_count;
+        }
+        uint64_t min() const;
+        uint64_t max() const
+        {
+            return m_max;
+        }
+        double mean() const;
+
+        /**
+         * Returns the value below which @p percentile percent of the recorded values
+         * fall, within the precision of the buckets.
+         */
+        uint64_t percentile(double percentile) const;
+
+        /** Returns the count, min, mean, max and usual percentiles as a JSON object. */
+        std::string toJSON() const;
+
+    private:
+        static size_t bucketIndex(uint64_t value);
+        static uint64_t highestEquivalentValue(size_t index);
+
+        std::vector<uint64_t> m_counts;
+        uint64_t m_count;
+        uint64_t m_min;
+        uint64_t m_max;
+        double m_sum;
+};
+
+#endif
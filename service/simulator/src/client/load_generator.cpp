@@ -0,0 +1,297 @@
+/******************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "load_generator.h"
+#include "simulator_error_codes.h"
+#include "OCPlatform.h"
+#include "experimental/logger.h"
+
+#include <sstream>
+#include <thread>
+
+#define TAG "LOAD_GEN"
+
+// Time given to the outstanding requests to complete once the session ends
+#define LOAD_DRAIN_TIMEOUT_SECONDS 5
+
+static const char *requestTypeName(RequestType type)
+{
+    switch (type)
+    {
+        case RequestType::RQ_TYPE_GET: return "GET";
+        case RequestType::RQ_TYPE_PUT: return "PUT";
+        case RequestType::RQ_TYPE_POST: return "POST";
+        case RequestType::RQ_TYPE_DELETE: return "DELETE";
+        default: return "UNKNOWN";
+    }
+}
+
+LoadGenerator::LoadGenerator(int id, const std::shared_ptr<OC::OCResource> &ocResource,
+                             const LoadGenerationConfig &config,
+                             const OC::OCRepresentation &putRep,
+                             const OC::OCRepresentation &postRep,
+                             ProgressStateCallback callback, ReportCallback reportCallback)
+    :   RequestGeneration(RequestType::RQ_TYPE_UNKNOWN, id, callback),
+        m_config(config),
+        m_ocResource(ocResource),
+        m_putRep(putRep),
+        m_postRep(postRep),
+        m_reportCallback(reportCallback),
+        m_stopRequested(false),
+        m_random(id + 1),
+        m_outstanding(0),
+        m_dropped(0),
+        m_sendFailures(0) {}
+
+void LoadGenerator::startSending()
+{
+    // The sending thread and the response callbacks keep the session alive
+    std::thread(&LoadGenerator::sendRequests, shared_from_this()).detach();
+}
+
+void LoadGenerator::stopSending()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stopRequested = true;
+    m_cond.notify_all();
+}
+
+void LoadGenerator::sendRequests()
+{
+    OIC_LOG(DEBUG, TAG, "Sending OP_START event");
+    m_callback(m_id, OP_START);
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::seconds(m_config.duration);
+    Clock::duration interval = Clock::duration::zero();
+    if (LOAD_OPEN_LOOP == m_config.mode)
+    {
+        interval = std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double>(1.0 / m_config.rate));
+    }
+
+    Clock::time_point next = start;
+    while (!m_stopRequested)
+    {
+        Clock::time_point scheduled;
+        if (LOAD_OPEN_LOOP == m_config.mode)
+        {
+            if (next >= deadline)
+            {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(m_lock);
+            if (m_cond.wait_until(lock, next, [this] { return m_stopRequested.load(); }))
+            {
+                break;
+            }
+
+            // Latency is measured from the time the request was due, so that a slow
+            // server is not hidden by the requests it delayed
+            scheduled = next;
+            next += interval;
+            if (m_outstanding >= m_config.concurrency)
+            {
+                m_dropped++;
+                continue;
+            }
+        }
+        else
+        {
+            if (!waitForSlot(deadline))
+            {
+                break;
+            }
+            scheduled = Clock::now();
+        }
+
+        if (!send(nextRequestType(), scheduled) && LOAD_CLOSED_LOOP == m_config.mode)
+        {
+            // Do not spin on a stack refusing the requests
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    Clock::time_point end = Clock::now();
+    std::string result;
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_cond.wait_until(lock, end + std::chrono::seconds(LOAD_DRAIN_TIMEOUT_SECONDS),
+                          [this] { return 0 == m_outstanding; });
+        if (0 == m_outstanding)
+        {
+            end = Clock::now();
+        }
+        result = report(std::chrono::duration<double>(end - start).count());
+    }
+
+    m_reportCallback(m_id, result);
+    if (m_stopRequested)
+    {
+        OIC_LOG(DEBUG, TAG, "Sending OP_ABORT event");
+        m_callback(m_id, OP_ABORT);
+    }
+    else
+    {
+        OIC_LOG(DEBUG, TAG, "Sending OP_COMPLETE event");
+        m_callback(m_id, OP_COMPLETE);
+    }
+}
+
+bool LoadGenerator::waitForSlot(Clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    bool ready = m_cond.wait_until(lock, deadline, [this]
+    {
+        return m_stopRequested || m_outstanding < m_config.concurrency;
+    });
+    return ready && !m_stopRequested && Clock::now() < deadline;
+}
+
+RequestType LoadGenerator::nextRequestType()
+{
+    unsigned int total = m_config.getWeight + m_config.putWeight + m_config.postWeight;
+    unsigned int pick = m_random() % total;
+    if (pick < m_config.getWeight)
+    {
+        return RequestType::RQ_TYPE_GET;
+    }
+    if (pick < m_config.getWeight + m_config.putWeight)
+    {
+        return RequestType::RQ_TYPE_PUT;
+    }
+    return RequestType::RQ_TYPE_POST;
+}
+
+bool LoadGenerator::send(RequestType type, Clock::time_point scheduled)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_outstanding++;
+        m_stats[type].requests++;
+    }
+
+    std::shared_ptr<LoadGenerator> self = shared_from_this();
+    auto callback = [self, type, scheduled](const OC::HeaderOptions &,
+                                            const OC::OCRepresentation &, const int errorCode)
+    {
+        self->onResponseReceived(errorCode, type, scheduled);
+    };
+
+    OC::QueryParamsMap queryParams;
+    OCStackResult result = OC_STACK_ERROR;
+    switch (type)
+    {
+        case RequestType::RQ_TYPE_GET:
+            result = m_ocResource->get(queryParams, callback);
+            break;
+
+        case RequestType::RQ_TYPE_PUT:
+            result = m_ocResource->put(m_putRep, queryParams, callback);
+            break;
+
+        case RequestType::RQ_TYPE_POST:
+            result = m_ocResource->post(m_postRep, queryParams, callback);
+            break;
+
+        default:
+            break;
+    }
+
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Sending %s request failed [%d]", requestTypeName(type), result);
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_outstanding--;
+        m_stats[type].requests--;
+        m_sendFailures++;
+        m_cond.notify_all();
+        return false;
+    }
+    return true;
+}
+
+void LoadGenerator::onResponseReceived(const int errorCode, RequestType type,
+                                       Clock::time_point scheduled)
+{
+    uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                           Clock::now() - scheduled).count();
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    RequestStats &stats = m_stats[type];
+    stats.responses++;
+    stats.latency.record(latency);
+    if (errorCode > SIMULATOR_RESOURCE_CHANGED)
+    {
+        stats.errors++;
+        m_errorCodes[errorCode]++;
+    }
+    m_outstanding--;
+    m_cond.notify_all();
+}
+
+std::string LoadGenerator::report(double elapsed)
+{
+    RequestStats total;
+    std::ostringstream types;
+    for (auto &entry : m_stats)
+    {
+        const RequestStats &stats = entry.second;
+        total.requests += stats.requests;
+        total.responses += stats.responses;
+        total.errors += stats.errors;
+        total.latency.add(stats.latency);
+
+        types << ",\"" << requestTypeName(entry.first) << "\":{"
+              << "\"requests\":" << stats.requests
+              << ",\"responses\":" << stats.responses
+              << ",\"errors\":" << stats.errors
+              << ",\"latency_us\":" << stats.latency.toJSON() << "}";
+    }
+
+    std::ostringstream json;
+    json << "{\"mode\":\"" << ((LOAD_OPEN_LOOP == m_config.mode) ? "open" : "closed") << "\""
+         << ",\"concurrency\":" << m_config.concurrency;
+    if (LOAD_OPEN_LOOP == m_config.mode)
+    {
+        json << ",\"rate\":" << m_config.rate;
+    }
+    json << ",\"elapsed\":" << elapsed
+         << ",\"requests\":" << total.requests
+         << ",\"responses\":" << total.responses
+         << ",\"errors\":" << total.errors
+         << ",\"unanswered\":" << m_outstanding
+         << ",\"dropped\":" << m_dropped
+         << ",\"send_failures\":" << m_sendFailures
+         << ",\"throughput\":" << ((elapsed > 0) ? total.responses / elapsed : 0)
+         << ",\"latency_us\":" << total.latency.toJSON()
+         << types.str()
+         << ",\"error_codes\":{";
+
+    const char *separator = "";
+    for (auto &entry : m_errorCodes)
+    {
+        json << separator << "\"" << entry.first << "\":" << entry.second;
+        separator = ",";
+    }
+    json << "}}";
+    return json.str();
+}
@@ -0,0 +1,104 @@
+/******************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file load_generator.h
+ *
+ * @brief This file provides class for sending a request mix to a remote resource
+ * and measuring its throughput and latency.
+ *
+ */
+
+#ifndef SIMULATOR_LOAD_GENERATOR_H_
+#define SIMULATOR_LOAD_GENERATOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <random>
+
+#include "request_generation.h"
+#include "latency_histogram.h"
+#include "OCApi.h"
+
+namespace OC
+{
+    class OCResource;
+}
+
+class LoadGenerator : public RequestGeneration,
+    public std::enable_shared_from_this<LoadGenerator>
+{
+    public:
+        typedef std::function<void (int, const std::string &)> ReportCallback;
+
+        /**
+         * @param putRep - Representation of the PUT requests, used if the mix has any.
+         * @param postRep - Representation of the POST requests, used if the mix has any.
+         */
+        LoadGenerator(int id, const std::shared_ptr<OC::OCResource> &ocResource,
+                      const LoadGenerationConfig &config, const OC::OCRepresentation &putRep,
+                      const OC::OCRepresentation &postRep, ProgressStateCallback callback,
+                      ReportCallback reportCallback);
+
+        void startSending();
+        void stopSending();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct RequestStats
+        {
+            RequestStats() : requests(0), responses(0), errors(0) {}
+
+            uint64_t requests;
+            uint64_t responses;
+            uint64_t errors;
+            LatencyHistogram latency;
+        };
+
+        void sendRequests();
+        bool waitForSlot(Clock::time_point deadline);
+        RequestType nextRequestType();
+        bool send(RequestType type, Clock::time_point scheduled);
+        void onResponseReceived(const int errorCode, RequestType type,
+                                Clock::time_point scheduled);
+        std::string report(double elapsed);
+
+        LoadGenerationConfig m_config;
+        std::shared_ptr<OC::OCResource> m_ocResource;
+        OC::OCRepresentation m_putRep;
+        OC::OCRepresentation m_postRep;
+        ReportCallback m_reportCallback;
+        std::atomic<bool> m_stopRequested;
+        std::minstd_rand m_random;
+
+        std::mutex m_lock;
+        std::condition_variable m_cond;
+        unsigned int m_outstanding;
+        uint64_t m_dropped;
+        uint64_t m_sendFailures;
+        std::map<RequestType, RequestStats> m_stats;
+        std::map<int, uint64_t> m_errorCodes;
+};
+
+#endif
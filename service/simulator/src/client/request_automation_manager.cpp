@@ -173,6 +173,47 @@ int RequestAutomationMngr::startOnPOST(const std::shared_ptr<RequestModel> &requ
     return m_id++;
 }
 
+int RequestAutomationMngr::startLoadGeneration(const LoadGenerationConfig &config,
+        const OC::OCRepresentation &putRep, const OC::OCRepresentation &postRep,
+        RequestGeneration::ProgressStateCallback callback,
+        LoadGenerator::ReportCallback reportCallback)
+{
+    if (!callback || !reportCallback)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid callback!");
+        throw InvalidArgsException(SIMULATOR_INVALID_CALLBACK, "Invalid callback!");
+    }
+
+    if (0 == config.getWeight + config.putWeight + config.postWeight)
+    {
+        OIC_LOG(ERROR, TAG, "Request mix is empty!");
+        throw InvalidArgsException(SIMULATOR_INVALID_PARAM, "Request mix is empty!");
+    }
+
+    if (0 == config.concurrency || 0 == config.duration
+        || (LOAD_OPEN_LOOP == config.mode && !(config.rate > 0)))
+    {
+        OIC_LOG(ERROR, TAG, "Invalid load generation config!");
+        throw InvalidArgsException(SIMULATOR_INVALID_PARAM,
+                                   "Concurrency, duration and rate should be positive!");
+    }
+
+    // Create load generation session
+    RequestGeneration::ProgressStateCallback localCallback = std::bind(
+                &RequestAutomationMngr::onProgressChange, this,
+                std::placeholders::_1, std::placeholders::_2, callback);
+
+    // Create and make the entry in list
+    std::lock_guard<std::mutex> lock(m_lock);
+    std::shared_ptr<RequestGeneration> requestGen(
+        new LoadGenerator(m_id, m_ocResource, config, putRep, postRep, localCallback,
+                          reportCallback));
+    m_requestGenList[m_id] = requestGen;
+    requestGen->start();
+
+    return m_id++;
+}
+
 void RequestAutomationMngr::stop(int id)
 {
     std::lock_guard<std::mutex> lock(m_lock);
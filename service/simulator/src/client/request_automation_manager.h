@@ -32,6 +32,7 @@
 #include <unordered_map>
 
 #include "request_generation.h"
+#include "load_generator.h"
 
 namespace OC
 {
@@ -53,6 +54,12 @@ class RequestAutomationMngr
         int startOnPOST(const std::shared_ptr<RequestModel> &requestSchema,
                         RequestGeneration::ProgressStateCallback callback);
 
+        int startLoadGeneration(const LoadGenerationConfig &config,
+                                const OC::OCRepresentation &putRep,
+                                const OC::OCRepresentation &postRep,
+                                RequestGeneration::ProgressStateCallback callback,
+                                LoadGenerator::ReportCallback reportCallback);
+
         void stop(int id);
 
     private:
@@ -459,6 +459,51 @@ void SimulatorRemoteResourceImpl::stopAutoRequesting(int id)
     m_requestAutomationMngr.stop(id);
 }
 
+int SimulatorRemoteResourceImpl::startLoadGeneration(const LoadGenerationConfig &config,
+        AutoRequestGenerationCallback callback, LoadGenerationReportCallback reportCallback)
+{
+    VALIDATE_CALLBACK(callback)
+    VALIDATE_CALLBACK(reportCallback)
+
+    OC::OCRepresentation putRep;
+    OC::OCRepresentation postRep;
+    if (config.putWeight)
+    {
+        putRep = buildRequestRep(RequestType::RQ_TYPE_PUT);
+    }
+    if (config.postWeight)
+    {
+        postRep = buildRequestRep(RequestType::RQ_TYPE_POST);
+    }
+
+    return m_requestAutomationMngr.startLoadGeneration(config, putRep, postRep,
+            std::bind(&SimulatorRemoteResourceImpl::onAutoRequestingState, this,
+                      std::placeholders::_1, std::placeholders::_2, callback),
+            std::bind(&SimulatorRemoteResourceImpl::onLoadGenerationReport, this,
+                      std::placeholders::_1, std::placeholders::_2, reportCallback));
+}
+
+OC::OCRepresentation SimulatorRemoteResourceImpl::buildRequestRep(RequestType type)
+{
+    // Check if resource supports request type
+    std::string requestType = requestTypeToString(type);
+    if (m_requestModels.end() == m_requestModels.find(requestType))
+    {
+        OIC_LOG(ERROR, TAG, "Resource is not configured for this request type!");
+        throw NoSupportException("Resource is not configured for this request type!");
+    }
+
+    std::shared_ptr<SimulatorResourceModelSchema> repSchema =
+        m_requestModels[requestType]->getRequestRepSchema();
+    if (!repSchema)
+    {
+        OIC_LOG(ERROR, TAG, "Request representation model is null!");
+        throw NoSupportException("Request representation model is null!");
+    }
+
+    return repSchema->buildResourceModel().asOCRepresentation();
+}
+
 void SimulatorRemoteResourceImpl::onResponseReceived(SimulatorResult result,
         const SimulatorResourceModel &resourceModel, const RequestInfo &reqInfo,
         ResponseCallback callback)
@@ -473,6 +518,12 @@ void SimulatorRemoteResourceImpl::onAutoRequestingState(int sessionId, Operation
     callback(m_id, sessionId, state);
 }
 
+void SimulatorRemoteResourceImpl::onLoadGenerationReport(int sessionId,
+        const std::string &report, LoadGenerationReportCallback callback)
+{
+    callback(m_id, sessionId, report);
+}
+
 SimulatorConnectivityType SimulatorRemoteResourceImpl::convertConnectivityType(
     OCConnectivityType type) const
 {
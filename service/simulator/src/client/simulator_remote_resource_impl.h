@@ -84,6 +84,9 @@ class SimulatorRemoteResourceImpl : public SimulatorRemoteResource
             const std::string &path);
         int startAutoRequesting(RequestType type, AutoRequestGenerationCallback callback);
         void stopAutoRequesting(int id);
+        int startLoadGeneration(const LoadGenerationConfig &config,
+                                AutoRequestGenerationCallback callback,
+                                LoadGenerationReportCallback reportCallback);
 
     private:
         void configure(const std::shared_ptr<RAML::Raml> &raml);
@@ -91,6 +94,9 @@ class SimulatorRemoteResourceImpl : public SimulatorRemoteResource
                                 const RequestInfo &reqInfo, ResponseCallback callback);
         void onAutoRequestingState(int sessionId, OperationState state,
                                    AutoRequestGenerationCallback callback);
+        void onLoadGenerationReport(int sessionId, const std::string &report,
+                                    LoadGenerationReportCallback callback);
+        OC::OCRepresentation buildRequestRep(RequestType type);
         SimulatorConnectivityType convertConnectivityType(OCConnectivityType type) const;
 
         std::string m_id;
@@ -38,10 +38,11 @@ AttributeUpdateAutomation::AttributeUpdateAutomation(
         m_type(type),
         m_updateInterval(interval),
         m_stopRequested(false),
+        m_finished(false),
+        m_roundUpdated(false),
         m_resource(resource),
         m_callback(callback),
-        m_finishedCallback(finishedCallback),
-        m_thread(nullptr)
+        m_finishedCallback(finishedCallback)
 {
     if (m_updateInterval < 0)
     {
@@ -49,14 +50,6 @@ AttributeUpdateAutomation::AttributeUpdateAutomation(
     }
 }
 
-AttributeUpdateAutomation::~AttributeUpdateAutomation()
-{
-    if (!m_stopRequested)
-    {
-        m_thread->detach();
-    }
-}
-
 void AttributeUpdateAutomation::start()
 {
     SimulatorResourceAttribute attribute;
@@ -66,75 +59,94 @@ void AttributeUpdateAutomation::start()
         throw SimulatorException(SIMULATOR_ERROR, "Attribute is not present in resource!");
     }
 
-    m_thread.reset(new std::thread(&AttributeUpdateAutomation::updateAttribute, this, attribute));
+    m_attributeGen.reset(new AttributeGenerator(attribute));
+    UpdateScheduler::getInstance()->schedule(shared_from_this());
 }
 
 void AttributeUpdateAutomation::stop()
 {
+    // Waits for an update in progress, so that none follows
     {
         std::lock_guard<std::mutex> lock(m_lock);
+        if (m_stopRequested || m_finished)
+        {
+            return;
+        }
         m_stopRequested = true;
     }
 
-    m_condVariable.notify_one();
-    if (m_thread)
+    SIM_LOG(ILogger::INFO, "Attribute automation stopped [Name: \"" << m_attrName
+                << "\", id: " << m_id <<"].");
+
+    // Notify application through callback
+    if (m_callback)
     {
-        m_thread->join();
+        m_callback(m_resource->getURI(), m_id);
     }
 }
 
-void AttributeUpdateAutomation::updateAttribute(SimulatorResourceAttribute attribute)
+bool AttributeUpdateAutomation::update()
 {
     std::unique_lock<std::mutex> lock(m_lock);
-    std::chrono::system_clock::time_point now;
+    if (m_stopRequested)
+    {
+        return false;
+    }
 
-    AttributeGenerator attributeGen(attribute);
-    do
+    try
     {
-        try
+        if (updateNext())
         {
-            SimulatorResourceAttribute attribute;
-            while (!m_stopRequested && true == attributeGen.next(attribute))
-            {
-                if (false == m_resource->updateAttributeValue(attribute))
-                {
-                    break;
-                }
-
-                // Wait for interval
-                now = std::chrono::system_clock::now();
-                m_condVariable.wait_until(lock, now + std::chrono::milliseconds(m_updateInterval),
-                                          [this] { return m_stopRequested; });
-            }
-
-            attributeGen.reset();
+            return true;
         }
-        catch (SimulatorException &e)
+
+        // Start over with the first value, unless no value could be set
+        if (AutoUpdateType::REPEAT == m_type && m_roundUpdated)
         {
-            break;
+            m_roundUpdated = false;
+            m_attributeGen->reset();
+            if (updateNext())
+            {
+                return true;
+            }
         }
     }
-    while (!m_stopRequested && AutoUpdateType::REPEAT == m_type);
-
-    if (!m_stopRequested)
+    catch (SimulatorException &e)
     {
-        OIC_LOG_V(DEBUG, ATAG, "Attribute:%s automation is completed!", m_attrName.c_str());
-        SIM_LOG(ILogger::INFO, "Attribute automation completed [Name: \"" << m_attrName
-                    << "\", id: " << m_id <<"].");
     }
-    else
+
+    m_finished = true;
+    lock.unlock();
+    completed();
+    return false;
+}
+
+bool AttributeUpdateAutomation::updateNext()
+{
+    SimulatorResourceAttribute attribute;
+    if (!m_attributeGen->next(attribute)
+        || false == m_resource->updateAttributeValue(attribute))
     {
-        SIM_LOG(ILogger::INFO, "Attribute automation stopped [Name: \"" << m_attrName
-                    << "\", id: " << m_id <<"].");
+        return false;
     }
 
+    m_roundUpdated = true;
+    return true;
+}
+
+void AttributeUpdateAutomation::completed()
+{
+    OIC_LOG_V(DEBUG, ATAG, "Attribute:%s automation is completed!", m_attrName.c_str());
+    SIM_LOG(ILogger::INFO, "Attribute automation completed [Name: \"" << m_attrName
+                << "\", id: " << m_id <<"].");
+
     // Notify application through callback
     if (m_callback)
     {
         m_callback(m_resource->getURI(), m_id);
     }
 
-    if (m_finishedCallback && !m_stopRequested)
+    if (m_finishedCallback)
     {
         std::thread notifyManager(m_finishedCallback, m_id);
         notifyManager.detach();
@@ -149,10 +161,11 @@ ResourceUpdateAutomation::ResourceUpdateAutomation(
         m_type(type),
         m_updateInterval(interval),
         m_stopRequested(false),
+        m_finished(false),
+        m_roundUpdated(false),
         m_resource(resource),
         m_callback(callback),
-        m_finishedCallback(finishedCallback),
-        m_thread(nullptr)
+        m_finishedCallback(finishedCallback)
 {
     if (m_updateInterval < 0)
     {
@@ -160,80 +173,95 @@ ResourceUpdateAutomation::ResourceUpdateAutomation(
     }
 }
 
-ResourceUpdateAutomation::~ResourceUpdateAutomation()
-{
-    if (!m_stopRequested)
-    {
-        m_thread->detach();
-    }
-}
-
 void ResourceUpdateAutomation::start()
 {
-    std::vector<SimulatorResourceAttribute> attributes;
     for (auto &attributeEntry : m_resource->getAttributes())
     {
-        attributes.push_back(attributeEntry.second);
+        m_attributes.push_back(attributeEntry.second);
     }
 
-    if (0 == attributes.size())
+    if (0 == m_attributes.size())
     {
         OIC_LOG(ERROR, RTAG, "Resource has zero attributes!");
         throw SimulatorException(SIMULATOR_ERROR, "Resource has zero attributes!");
     }
 
-    m_thread.reset(new std::thread(&ResourceUpdateAutomation::updateAttributes, this, attributes));
+    m_combinationGen.reset(new AttributeCombinationGen(m_attributes));
+    UpdateScheduler::getInstance()->schedule(shared_from_this());
 }
 
 void ResourceUpdateAutomation::stop()
 {
+    // Waits for an update in progress, so that none follows
     {
         std::lock_guard<std::mutex> lock(m_lock);
+        if (m_stopRequested || m_finished)
+        {
+            return;
+        }
         m_stopRequested = true;
     }
 
-    m_condVariable.notify_one();
-    if (m_thread)
+    SIM_LOG(ILogger::INFO, "Resource automation stopped [URI: \"" << m_resource->getURI()
+            << "\", id: " << m_id <<"].");
+
+    // Notify application
+    if (m_callback)
     {
-        m_thread->join();
+        m_callback(m_resource->getURI(), m_id);
     }
 }
 
-void ResourceUpdateAutomation::updateAttributes(
-    std::vector<SimulatorResourceAttribute> attributes)
+bool ResourceUpdateAutomation::update()
 {
     std::unique_lock<std::mutex> lock(m_lock);
-    std::chrono::system_clock::time_point now;
-
-    do
+    if (m_stopRequested)
     {
-        AttributeCombinationGen attrCombGen(attributes);
-        SimulatorResourceModel newResModel;
-        while (!m_stopRequested && attrCombGen.next(newResModel))
-        {
-            SimulatorResourceModel updatedResModel;
-            m_resource->updateResourceModel(newResModel, updatedResModel);
+        return false;
+    }
 
-            // Wait for interval
-            now = std::chrono::system_clock::now();
-            m_condVariable.wait_until(lock, now + std::chrono::milliseconds(m_updateInterval),
-                                      [this] { return m_stopRequested; });
-        }
+    if (updateNext())
+    {
+        return true;
     }
-    while (!m_stopRequested && AutoUpdateType::REPEAT == m_type);
 
-    if (!m_stopRequested)
+    // Start over with the first combination, unless there was none
+    if (AutoUpdateType::REPEAT == m_type && m_roundUpdated)
     {
-        OIC_LOG_V(DEBUG, RTAG, "Resource update automation complete [id: %d]!", m_id);
-        SIM_LOG(ILogger::INFO, "Resource automation completed [URI: \"" << m_resource->getURI()
-                << "\", id: " << m_id << "].");
+        m_roundUpdated = false;
+        m_combinationGen.reset(new AttributeCombinationGen(m_attributes));
+        if (updateNext())
+        {
+            return true;
+        }
     }
-    else
+
+    m_finished = true;
+    lock.unlock();
+    completed();
+    return false;
+}
+
+bool ResourceUpdateAutomation::updateNext()
+{
+    SimulatorResourceModel newResModel;
+    if (!m_combinationGen->next(newResModel))
     {
-        SIM_LOG(ILogger::INFO, "Resource automation stopped [URI: \"" << m_resource->getURI()
-                << "\", id: " << m_id <<"].");
+        return false;
     }
 
+    SimulatorResourceModel updatedResModel;
+    m_resource->updateResourceModel(newResModel, updatedResModel);
+    m_roundUpdated = true;
+    return true;
+}
+
+void ResourceUpdateAutomation::completed()
+{
+    OIC_LOG_V(DEBUG, RTAG, "Resource update automation complete [id: %d]!", m_id);
+    SIM_LOG(ILogger::INFO, "Resource automation completed [URI: \"" << m_resource->getURI()
+            << "\", id: " << m_id << "].");
+
     // Notify application
     if (m_callback)
     {
@@ -245,6 +273,4 @@ void ResourceUpdateAutomation::updateAttributes(
         std::thread notifyManager(m_finishedCallback, m_id);
         notifyManager.detach();
     }
-
 }
-
@@ -21,15 +21,15 @@
 #ifndef RESOURCE_UPDATE_AUTOMATION_H_
 #define RESOURCE_UPDATE_AUTOMATION_H_
 
-#include <thread>
-#include <condition_variable>
-#include <atomic>
+#include <mutex>
 
 #include "attribute_generator.h"
 #include "simulator_single_resource.h"
+#include "update_scheduler.h"
 
 class SimulatorSingleResourceImpl;
-class AttributeUpdateAutomation
+class AttributeUpdateAutomation : public ScheduledUpdate,
+    public std::enable_shared_from_this<AttributeUpdateAutomation>
 {
     public:
         AttributeUpdateAutomation(int id, std::shared_ptr<SimulatorSingleResourceImpl> resource,
@@ -37,30 +37,38 @@ class AttributeUpdateAutomation
                                   const SimulatorSingleResource::AutoUpdateCompleteCallback &callback,
                                   std::function<void (const int)> finishedCallback);
 
-        ~AttributeUpdateAutomation();
         void start();
         void stop();
 
+        bool update();
+        int interval() const
+        {
+            return m_updateInterval;
+        }
+
     private:
-        void updateAttribute(SimulatorResourceAttribute attribute);
+        bool updateNext();
+        void completed();
 
         int m_id;
         std::string m_attrName;
         AutoUpdateType m_type;
         int m_updateInterval;
         bool m_stopRequested;
+        bool m_finished;
+        bool m_roundUpdated;
         std::shared_ptr<SimulatorSingleResourceImpl> m_resource;
         SimulatorSingleResource::AutoUpdateCompleteCallback m_callback;
         std::function<void (const int)> m_finishedCallback;
-        std::unique_ptr<std::thread> m_thread;
+        std::unique_ptr<AttributeGenerator> m_attributeGen;
 
         std::mutex m_lock;
-        std::condition_variable m_condVariable;
 };
 
 typedef std::shared_ptr<AttributeUpdateAutomation> AttributeUpdateAutomationSP;
 
-class ResourceUpdateAutomation
+class ResourceUpdateAutomation : public ScheduledUpdate,
+    public std::enable_shared_from_this<ResourceUpdateAutomation>
 {
     public:
         ResourceUpdateAutomation(int id, std::shared_ptr<SimulatorSingleResourceImpl> resource,
@@ -68,24 +76,32 @@ class ResourceUpdateAutomation
                                  const SimulatorSingleResource::AutoUpdateCompleteCallback &callback,
                                  std::function<void (const int)> finishedCallback);
 
-        ~ResourceUpdateAutomation();
         void start();
         void stop();
 
+        bool update();
+        int interval() const
+        {
+            return m_updateInterval;
+        }
+
     private:
-        void updateAttributes(std::vector<SimulatorResourceAttribute> attributes);
+        bool updateNext();
+        void completed();
 
         int m_id;
         AutoUpdateType m_type;
         int m_updateInterval;
         bool m_stopRequested;
+        bool m_finished;
+        bool m_roundUpdated;
         std::shared_ptr<SimulatorSingleResourceImpl> m_resource;
         SimulatorSingleResource::AutoUpdateCompleteCallback m_callback;
         std::function<void (const int)> m_finishedCallback;
-        std::unique_ptr<std::thread> m_thread;
+        std::vector<SimulatorResourceAttribute> m_attributes;
+        std::unique_ptr<AttributeCombinationGen> m_combinationGen;
 
         std::mutex m_lock;
-        std::condition_variable m_condVariable;
 };
 
 typedef std::shared_ptr<ResourceUpdateAutomation> ResourceUpdateAutomationSP;
@@ -0,0 +1,131 @@
+/******************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "update_scheduler.h"
+
+UpdateScheduler *UpdateScheduler::getInstance()
+{
+    static UpdateScheduler s_instance;
+    return &s_instance;
+}
+
+UpdateScheduler::UpdateScheduler()
+    :   m_sequence(0),
+        m_minSpacing(Clock::duration::zero()),
+        m_stopRequested(false) {}
+
+UpdateScheduler::~UpdateScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stopRequested = true;
+    }
+
+    m_condVariable.notify_one();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void UpdateScheduler::schedule(const std::shared_ptr<ScheduledUpdate> &update)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (!m_thread.joinable())
+    {
+        m_thread = std::thread(&UpdateScheduler::run, this);
+    }
+
+    Entry entry = { Clock::now(), m_sequence++, update };
+    m_queue.push(entry);
+    m_condVariable.notify_one();
+}
+
+void UpdateScheduler::setMaxUpdateRate(double updatesPerSecond)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (updatesPerSecond > 0)
+    {
+        m_minSpacing = std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<double>(1.0 / updatesPerSecond));
+    }
+    else
+    {
+        m_minSpacing = Clock::duration::zero();
+    }
+    m_nextSlot = Clock::now();
+    m_condVariable.notify_one();
+}
+
+void UpdateScheduler::run()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (!m_stopRequested)
+    {
+        if (m_queue.empty())
+        {
+            m_condVariable.wait(lock);
+            continue;
+        }
+
+        // The earliest update waits for its due time and for its slot in the rate limit
+        Clock::time_point due = m_queue.top().due;
+        if (m_minSpacing != Clock::duration::zero() && m_nextSlot > due)
+        {
+            due = m_nextSlot;
+        }
+
+        Clock::time_point now = Clock::now();
+        if (now < due)
+        {
+            m_condVariable.wait_until(lock, due);
+            continue;
+        }
+
+        Entry entry = m_queue.top();
+        m_queue.pop();
+        if (m_minSpacing != Clock::duration::zero())
+        {
+            // Slots missed by the wake up latency are kept, idle ones are not
+            if (now - m_nextSlot > m_minSpacing)
+            {
+                m_nextSlot = now;
+            }
+            m_nextSlot += m_minSpacing;
+        }
+
+        lock.unlock();
+        bool again = entry.update->update();
+        int interval = entry.update->interval();
+        if (!again)
+        {
+            // A completed automation is released outside of the lock
+            entry.update.reset();
+        }
+        lock.lock();
+
+        if (again)
+        {
+            entry.due = Clock::now() + std::chrono::milliseconds(interval);
+            entry.sequence = m_sequence++;
+            m_queue.push(entry);
+        }
+    }
+}
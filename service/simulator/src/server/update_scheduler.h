@@ -0,0 +1,111 @@
+/******************************************************************
+ *
+ * Copyright 2018 Hewlett Packard Enterprise Development LP All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file update_scheduler.h
+ *
+ * @brief This file provides the scheduler running the update automations of all the
+ * simulated resources.
+ *
+ */
+
+#ifndef SIMULATOR_UPDATE_SCHEDULER_H_
+#define SIMULATOR_UPDATE_SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * An automation run by the scheduler, one update at a time.
+ */
+class ScheduledUpdate
+{
+    public:
+        virtual ~ScheduledUpdate() {}
+
+        /**
+         * Performs the next update.
+         *
+         * @return false once the automation is completed or stopped.
+         */
+        virtual bool update() = 0;
+
+        /** Time to wait after an update before the next one, in milliseconds. */
+        virtual int interval() const = 0;
+};
+
+/**
+ * Runs the updates of all the automations from a single thread, in the order they are
+ * due, so that simulating thousands of resources does not take thousands of threads.
+ * The rate of the updates of all the automations together can be limited, in which
+ * case due updates are delayed and spread evenly.
+ */
+class UpdateScheduler
+{
+    public:
+        static UpdateScheduler *getInstance();
+
+        void schedule(const std::shared_ptr<ScheduledUpdate> &update);
+
+        /**
+         * Limits the updates of all the automations together.
+         *
+         * @param updatesPerSecond - Highest rate of the updates, 0 for no limit.
+         */
+        void setMaxUpdateRate(double updatesPerSecond);
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Entry
+        {
+            Clock::time_point due;
+            unsigned long long sequence;
+            std::shared_ptr<ScheduledUpdate> update;
+
+            bool operator>(const Entry &other) const
+            {
+                return (due != other.due) ? due > other.due : sequence > other.sequence;
+            }
+        };
+
+        UpdateScheduler();
+        ~UpdateScheduler();
+        UpdateScheduler(const UpdateScheduler &) = delete;
+        UpdateScheduler &operator=(const UpdateScheduler &) = delete;
+
+        void run();
+
+        std::mutex m_lock;
+        std::condition_variable m_condVariable;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_queue;
+        unsigned long long m_sequence;
+        Clock::duration m_minSpacing;
+        Clock::time_point m_nextSlot;
+        bool m_stopRequested;
+        std::thread m_thread;
+};
+
+#endif
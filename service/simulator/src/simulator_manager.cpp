@@ -20,6 +20,7 @@
 
 #include "simulator_manager.h"
 #include "simulator_resource_factory.h"
+#include "update_scheduler.h"
 #include "simulator_remote_resource_impl.h"
 #include "simulator_utils.h"
 
@@ -255,6 +256,13 @@ void SimulatorManager::setPlatformInfo(PlatformInfo &platformInfo)
                      ocPlatformInfo);
 }
 
+void SimulatorManager::setAutoUpdateRate(double updatesPerSecond)
+{
+    VALIDATE_INPUT(updatesPerSecond < 0, "Negative update rate!")
+
+    UpdateScheduler::getInstance()->setMaxUpdateRate(updatesPerSecond);
+}
+
 void SimulatorManager::setLogger(const std::shared_ptr<ILogger> &logger)
 {
     simLogger().setCustomTarget(logger);